@@ -24,8 +24,10 @@
 #include <linux/types.h>
 #include <linux/uio.h>
 #include <linux/uaccess.h>
+#include <linux/vmalloc.h>
 #include <linux/module.h>
 #include <linux/compat.h>
+#include <linux/dma-mapping.h>
 #include <dkms/sound/core.h>
 #include <dkms/sound/initval.h>
 #include <dkms/sound/info.h>
@@ -83,7 +85,9 @@ static int snd_compr_open(struct inode *inode, struct file *f)
 	int maj = imajor(inode);
 	int ret;
 
-	if ((f->f_flags & O_ACCMODE) == O_WRONLY)
+	/* O_RDWR is for playback with a shared, writable mmap */
+	if ((f->f_flags & O_ACCMODE) == O_WRONLY ||
+	    (f->f_flags & O_ACCMODE) == O_RDWR)
 		dirn = SND_COMPRESS_PLAYBACK;
 	else if ((f->f_flags & O_ACCMODE) == O_RDONLY)
 		dirn = SND_COMPRESS_CAPTURE;
@@ -125,6 +129,13 @@ static int snd_compr_open(struct inode *inode, struct file *f)
 		snd_card_unref(compr->card);
 		return -ENOMEM;
 	}
+	runtime->control = (void *)get_zeroed_page(GFP_KERNEL);
+	if (!runtime->control) {
+		kfree(runtime);
+		kfree(data);
+		snd_card_unref(compr->card);
+		return -ENOMEM;
+	}
 	runtime->state = SNDRV_PCM_STATE_OPEN;
 	init_waitqueue_head(&runtime->sleep);
 	data->stream.runtime = runtime;
@@ -133,6 +144,7 @@ static int snd_compr_open(struct inode *inode, struct file *f)
 	ret = compr->ops->open(&data->stream);
 	mutex_unlock(&compr->lock);
 	if (ret) {
+		free_page((unsigned long)runtime->control);
 		kfree(runtime);
 		kfree(data);
 	}
@@ -159,12 +171,34 @@ static int snd_compr_free(struct inode *inode, struct file *f)
 
 	data->stream.ops->free(&data->stream);
 	if (!data->stream.runtime->dma_buffer_p)
-		kfree(data->stream.runtime->buffer);
+		vfree(data->stream.runtime->buffer);
+	free_page((unsigned long)data->stream.runtime->control);
 	kfree(data->stream.runtime);
 	kfree(data);
 	return 0;
 }
 
+/* publish the positions to the mmapped control page */
+static void snd_compr_update_mmap_control(struct snd_compr_stream *stream)
+{
+	struct snd_compr_runtime *runtime = stream->runtime;
+	struct snd_compr_mmap_control *control = runtime->control;
+
+	WRITE_ONCE(control->seq, control->seq + 1);
+	smp_wmb();
+	control->state = runtime->state;
+	control->buffer_size = runtime->buffer_size;
+	if (stream->direction == SND_COMPRESS_PLAYBACK) {
+		control->appl_ptr = runtime->total_bytes_available;
+		control->hw_ptr = runtime->total_bytes_transferred;
+	} else {
+		control->appl_ptr = runtime->total_bytes_transferred;
+		control->hw_ptr = runtime->total_bytes_available;
+	}
+	smp_wmb();
+	WRITE_ONCE(control->seq, control->seq + 1);
+}
+
 static int snd_compr_update_tstamp(struct snd_compr_stream *stream,
 		struct snd_compr_tstamp *tstamp)
 {
@@ -177,6 +211,7 @@ static int snd_compr_update_tstamp(struct snd_compr_stream *stream,
 		stream->runtime->total_bytes_transferred = tstamp->copied_total;
 	else
 		stream->runtime->total_bytes_available = tstamp->copied_total;
+	snd_compr_update_mmap_control(stream);
 	return 0;
 }
 
@@ -323,6 +358,7 @@ static ssize_t snd_compr_write(struct file *f, const char __user *buf,
 		stream->runtime->state = SNDRV_PCM_STATE_PREPARED;
 		pr_debug("stream prepared, Houston we are good to go\n");
 	}
+	snd_compr_update_mmap_control(stream);
 
 	mutex_unlock(&stream->device->lock);
 	return retval;
@@ -373,15 +409,131 @@ static ssize_t snd_compr_read(struct file *f, char __user *buf,
 	}
 	if (retval > 0)
 		stream->runtime->total_bytes_transferred += retval;
+	snd_compr_update_mmap_control(stream);
 
 out:
 	mutex_unlock(&stream->device->lock);
 	return retval;
 }
 
+static int snd_compr_mmap_control(struct snd_compr_stream *stream,
+				  struct vm_area_struct *vma)
+{
+	if (vma->vm_flags & VM_WRITE)
+		return -EINVAL;
+	if (vma->vm_end - vma->vm_start != PAGE_SIZE)
+		return -EINVAL;
+	vma->vm_flags &= ~VM_MAYWRITE;
+	vma->vm_flags |= VM_DONTEXPAND | VM_DONTDUMP;
+	return vm_insert_page(vma, vma->vm_start,
+			      virt_to_page(stream->runtime->control));
+}
+
+static int snd_compr_mmap_data(struct snd_compr_stream *stream,
+			       struct vm_area_struct *vma)
+{
+	struct snd_compr_runtime *runtime = stream->runtime;
+	struct snd_dma_buffer *dmab = runtime->dma_buffer_p;
+	unsigned long size = vma->vm_end - vma->vm_start;
+
+	/* the drivers with a copy callback have no buffer in the core */
+	if (!runtime->buffer || runtime->state == SNDRV_PCM_STATE_OPEN)
+		return -ENXIO;
+	if (size > PAGE_ALIGN(runtime->buffer_size))
+		return -EINVAL;
+	/* the capture data is only produced by the DSP */
+	if (stream->direction == SND_COMPRESS_CAPTURE) {
+		if (vma->vm_flags & VM_WRITE)
+			return -EINVAL;
+		vma->vm_flags &= ~VM_MAYWRITE;
+	}
+	vma->vm_flags |= VM_DONTEXPAND | VM_DONTDUMP;
+
+	if (!dmab)
+		return remap_vmalloc_range(vma, runtime->buffer, 0);
+
+	switch (dmab->dev.type) {
+	case SNDRV_DMA_TYPE_CONTINUOUS:
+		return remap_pfn_range(vma, vma->vm_start,
+				       virt_to_phys(dmab->area) >> PAGE_SHIFT,
+				       size, vma->vm_page_prot);
+#ifdef CONFIG_HAS_DMA
+	case SNDRV_DMA_TYPE_DEV:
+		return dma_mmap_coherent(dmab->dev.dev, vma, dmab->area,
+					 dmab->addr, dmab->bytes);
+#endif
+	default:
+		return -ENXIO;
+	}
+}
+
 static int snd_compr_mmap(struct file *f, struct vm_area_struct *vma)
 {
-	return -ENXIO;
+	struct snd_compr_file *data = f->private_data;
+	struct snd_compr_stream *stream;
+	unsigned long offset;
+	int retval;
+
+	if (snd_BUG_ON(!data))
+		return -EFAULT;
+	stream = &data->stream;
+
+	offset = vma->vm_pgoff << PAGE_SHIFT;
+	mutex_lock(&stream->device->lock);
+	switch (offset) {
+	case SNDRV_COMPRESS_MMAP_OFFSET_DATA:
+		retval = snd_compr_mmap_data(stream, vma);
+		break;
+	case SNDRV_COMPRESS_MMAP_OFFSET_CONTROL:
+		retval = snd_compr_mmap_control(stream, vma);
+		break;
+	default:
+		retval = -ENXIO;
+		break;
+	}
+	mutex_unlock(&stream->device->lock);
+	return retval;
+}
+
+/* account the bytes written or read in place through the mmapped buffer */
+static int
+snd_compr_commit(struct snd_compr_stream *stream, unsigned long arg)
+{
+	struct snd_compr_runtime *runtime = stream->runtime;
+	size_t avail;
+	u32 count;
+
+	if (get_user(count, (__u32 __user *)arg))
+		return -EFAULT;
+	if (!runtime->buffer)
+		return -ENXIO;
+
+	switch (runtime->state) {
+	case SNDRV_PCM_STATE_OPEN:
+	case SNDRV_PCM_STATE_SUSPENDED:
+	case SNDRV_PCM_STATE_DISCONNECTED:
+		return -EBADFD;
+	case SNDRV_PCM_STATE_XRUN:
+		return -EPIPE;
+	default:
+		break;
+	}
+
+	avail = snd_compr_get_avail(stream);
+	if (count > avail)
+		return -EINVAL;
+
+	if (stream->direction == SND_COMPRESS_PLAYBACK) {
+		/* if DSP cares, let it know data has been written */
+		if (stream->ops->ack)
+			stream->ops->ack(stream, count);
+		runtime->total_bytes_available += count;
+		if (runtime->state == SNDRV_PCM_STATE_SETUP)
+			runtime->state = SNDRV_PCM_STATE_PREPARED;
+	} else {
+		runtime->total_bytes_transferred += count;
+	}
+	return 0;
 }
 
 static __poll_t snd_compr_get_poll(struct snd_compr_stream *stream)
@@ -553,7 +705,8 @@ static int snd_compr_allocate_buffer(struct snd_compr_stream *stream,
 				buffer = stream->runtime->dma_buffer_p->area;
 
 		} else {
-			buffer = kmalloc(buffer_size, GFP_KERNEL);
+			/* vmalloc_user() so that the buffer can be mmapped */
+			buffer = vmalloc_user(buffer_size);
 		}
 
 		if (!buffer)
@@ -996,8 +1149,13 @@ static long snd_compr_ioctl(struct file *f, unsigned int cmd, unsigned long arg)
 	case _IOC_NR(SNDRV_COMPRESS_NEXT_TRACK):
 		retval = snd_compr_next_track(stream);
 		break;
+	case _IOC_NR(SNDRV_COMPRESS_COMMIT):
+		retval = snd_compr_commit(stream, arg);
+		break;
 
 	}
+	/* the state or the positions may have changed */
+	snd_compr_update_mmap_control(stream);
 	mutex_unlock(&stream->device->lock);
 	return retval;
 }
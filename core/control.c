@@ -63,7 +63,14 @@ static int snd_ctl_open(struct inode *inode, struct file *file)
 		err = -ENOMEM;
 		goto __error;
 	}
-	INIT_LIST_HEAD(&ctl->events);
+	ctl->events = kvcalloc(SND_CTL_EVENT_RING, sizeof(*ctl->events),
+			       GFP_KERNEL);
+	if (!ctl->events) {
+		kfree(ctl);
+		err = -ENOMEM;
+		goto __error;
+	}
+	hash_init(ctl->event_hash);
 	init_waitqueue_head(&ctl->change_sleep);
 	spin_lock_init(&ctl->read_lock);
 	ctl->card = card;
@@ -87,17 +94,28 @@ static int snd_ctl_open(struct inode *inode, struct file *file)
       	return err;
 }
 
+/* take the oldest event out of the ring; call with read_lock held */
+static void snd_ctl_pop_event(struct snd_ctl_file *ctl,
+			      struct snd_kctl_event *kev)
+{
+	struct snd_kctl_event *head = &ctl->events[ctl->event_head];
+
+	hash_del(&head->node);
+	kev->id = head->id;
+	kev->mask = head->mask;
+	ctl->event_head = (ctl->event_head + 1) % SND_CTL_EVENT_RING;
+	ctl->event_count--;
+}
+
 static void snd_ctl_empty_read_queue(struct snd_ctl_file * ctl)
 {
 	unsigned long flags;
-	struct snd_kctl_event *cread;
+	struct snd_kctl_event kev;
 
 	spin_lock_irqsave(&ctl->read_lock, flags);
-	while (!list_empty(&ctl->events)) {
-		cread = snd_kctl_event(ctl->events.next);
-		list_del(&cread->list);
-		kfree(cread);
-	}
+	while (ctl->event_count)
+		snd_ctl_pop_event(ctl, &kev);
+	ctl->event_overflow = false;
 	spin_unlock_irqrestore(&ctl->read_lock, flags);
 }
 
@@ -123,6 +141,7 @@ static int snd_ctl_release(struct inode *inode, struct file *file)
 	up_write(&card->controls_rwsem);
 	snd_ctl_empty_read_queue(ctl);
 	put_pid(ctl->pid);
+	kvfree(ctl->events);
 	kfree(ctl);
 	module_put(card->module);
 	snd_card_file_remove(card, file);
@@ -138,6 +157,10 @@ static int snd_ctl_release(struct inode *inode, struct file *file)
  * This function adds an event record with the given id and mask, appends
  * to the list and wakes up the user-space for notification.  This can be
  * called in the atomic context.
+ *
+ * A pending event for the same element is merged with the new one.  When
+ * the event ring of a file is full the event is dropped and the reader is
+ * told with a %SNDRV_CTL_EVENT_OVERFLOW event.
  */
 void snd_ctl_notify(struct snd_card *card, unsigned int mask,
 		    struct snd_ctl_elem_id *id)
@@ -158,19 +181,21 @@ void snd_ctl_notify(struct snd_card *card, unsigned int mask,
 		if (!ctl->subscribed)
 			continue;
 		spin_lock_irqsave(&ctl->read_lock, flags);
-		list_for_each_entry(ev, &ctl->events, list) {
+		hash_for_each_possible(ctl->event_hash, ev, node, id->numid) {
 			if (ev->id.numid == id->numid) {
 				ev->mask |= mask;
 				goto _found;
 			}
 		}
-		ev = kzalloc(sizeof(*ev), GFP_ATOMIC);
-		if (ev) {
+		if (ctl->event_count < SND_CTL_EVENT_RING) {
+			ev = &ctl->events[(ctl->event_head + ctl->event_count) %
+					  SND_CTL_EVENT_RING];
 			ev->id = *id;
 			ev->mask = mask;
-			list_add_tail(&ev->list, &ctl->events);
+			hash_add(ctl->event_hash, &ev->node, id->numid);
+			ctl->event_count++;
 		} else {
-			dev_err(card->dev, "No memory available to allocate event\n");
+			ctl->event_overflow = true;
 		}
 	_found:
 		wake_up(&ctl->change_sleep);
@@ -298,15 +323,114 @@ void snd_ctl_free_one(struct snd_kcontrol *kcontrol)
 }
 EXPORT_SYMBOL(snd_ctl_free_one);
 
+static bool elem_id_matches(const struct snd_kcontrol *kctl,
+			    const struct snd_ctl_elem_id *id)
+{
+	return kctl->id.iface == id->iface &&
+		kctl->id.device == id->device &&
+		kctl->id.subdevice == id->subdevice &&
+		!strncmp(kctl->id.name, id->name, sizeof(kctl->id.name)) &&
+		kctl->id.index <= id->index &&
+		kctl->id.index + kctl->count > id->index;
+}
+
+#ifdef CONFIG_SND_CTL_FAST_LOOKUP
+/* Compute a hash key for the corresponding ctl id
+ * It's for the name lookup, hence the numid is excluded.
+ * The hash key is bound in LONG_MAX to be used for Xarray key.
+ */
+#define MULTIPLIER	37
+static unsigned long get_ctl_id_hash(const struct snd_ctl_elem_id *id)
+{
+	int i;
+	unsigned long h;
+
+	h = id->iface;
+	h = MULTIPLIER * h + id->device;
+	h = MULTIPLIER * h + id->subdevice;
+	for (i = 0; i < SNDRV_CTL_ELEM_ID_NAME_MAXLEN && id->name[i]; i++)
+		h = MULTIPLIER * h + id->name[i];
+	h = MULTIPLIER * h + id->index;
+	h &= LONG_MAX;
+	return h;
+}
+
+/* add hash entries to numid and ctl xarray tables */
+static void add_hash_entries(struct snd_card *card,
+			     struct snd_kcontrol *kcontrol)
+{
+	struct snd_ctl_elem_id id = kcontrol->id;
+	int i;
+
+	xa_store_range(&card->ctl_numids, kcontrol->id.numid,
+		       kcontrol->id.numid + kcontrol->count - 1,
+		       kcontrol, GFP_KERNEL);
+
+	for (i = 0; i < kcontrol->count; i++) {
+		id.index = kcontrol->id.index + i;
+		if (xa_insert(&card->ctl_hash, get_ctl_id_hash(&id),
+			      kcontrol, GFP_KERNEL)) {
+			/* skip hash for this entry, noting we had collision */
+			card->ctl_hash_collision = true;
+			dev_dbg(card->dev, "ctl_hash collision %d:%s:%d\n",
+				id.iface, id.name, id.index);
+		}
+	}
+}
+
+/* remove hash entries that have been added */
+static void remove_hash_entries(struct snd_card *card,
+				struct snd_kcontrol *kcontrol)
+{
+	struct snd_ctl_elem_id id = kcontrol->id;
+	struct snd_kcontrol *matched;
+	unsigned long h;
+	int i;
+
+	for (i = 0; i < kcontrol->count; i++) {
+		xa_erase(&card->ctl_numids, id.numid);
+		h = get_ctl_id_hash(&id);
+		matched = xa_load(&card->ctl_hash, h);
+		if (matched && (matched == kcontrol ||
+				elem_id_matches(matched, &id)))
+			xa_erase(&card->ctl_hash, h);
+		id.index++;
+		id.numid++;
+	}
+}
+#else /* CONFIG_SND_CTL_FAST_LOOKUP */
+static inline void add_hash_entries(struct snd_card *card,
+				    struct snd_kcontrol *kcontrol)
+{
+}
+static inline void remove_hash_entries(struct snd_card *card,
+				       struct snd_kcontrol *kcontrol)
+{
+}
+#endif /* CONFIG_SND_CTL_FAST_LOOKUP */
+
 static bool snd_ctl_remove_numid_conflict(struct snd_card *card,
 					  unsigned int count)
 {
 	struct snd_kcontrol *kctl;
+#ifdef CONFIG_SND_CTL_FAST_LOOKUP
+	unsigned long numid;
+#endif
 
 	/* Make sure that the ids assigned to the control do not wrap around */
 	if (card->last_numid >= UINT_MAX - count)
 		card->last_numid = 0;
 
+#ifdef CONFIG_SND_CTL_FAST_LOOKUP
+	/* look for a control already holding one of the numids to assign */
+	numid = card->last_numid + 1;
+	kctl = xa_find(&card->ctl_numids, &numid, card->last_numid + count,
+		       XA_PRESENT);
+	if (kctl) {
+		card->last_numid = kctl->id.numid + kctl->count - 1;
+		return true;
+	}
+#else
 	list_for_each_entry(kctl, &card->controls, list) {
 		if (kctl->id.numid < card->last_numid + 1 + count &&
 		    kctl->id.numid + kctl->count > card->last_numid + 1) {
@@ -314,6 +438,7 @@ static bool snd_ctl_remove_numid_conflict(struct snd_card *card,
 			return true;
 		}
 	}
+#endif
 	return false;
 }
 
@@ -376,6 +501,8 @@ static int __snd_ctl_add_replace(struct snd_card *card,
 	kcontrol->id.numid = card->last_numid + 1;
 	card->last_numid += kcontrol->count;
 
+	add_hash_entries(card, kcontrol);
+
 	id = kcontrol->id;
 	count = kcontrol->count;
 	for (idx = 0; idx < count; idx++, id.index++, id.numid++)
@@ -467,6 +594,7 @@ int snd_ctl_remove(struct snd_card *card, struct snd_kcontrol *kcontrol)
 
 	if (snd_BUG_ON(!card || !kcontrol))
 		return -EINVAL;
+	remove_hash_entries(card, kcontrol);
 	list_del(&kcontrol->list);
 	card->controls_count -= kcontrol->count;
 	id = kcontrol->id;
@@ -615,9 +743,11 @@ int snd_ctl_rename_id(struct snd_card *card, struct snd_ctl_elem_id *src_id,
 		up_write(&card->controls_rwsem);
 		return -ENOENT;
 	}
+	remove_hash_entries(card, kctl);
 	kctl->id = *dst_id;
 	kctl->id.numid = card->last_numid + 1;
 	card->last_numid += kctl->count;
+	add_hash_entries(card, kctl);
 	up_write(&card->controls_rwsem);
 	return 0;
 }
@@ -638,15 +768,21 @@ EXPORT_SYMBOL(snd_ctl_rename_id);
  */
 struct snd_kcontrol *snd_ctl_find_numid(struct snd_card *card, unsigned int numid)
 {
+#ifndef CONFIG_SND_CTL_FAST_LOOKUP
 	struct snd_kcontrol *kctl;
+#endif
 
 	if (snd_BUG_ON(!card || !numid))
 		return NULL;
+#ifdef CONFIG_SND_CTL_FAST_LOOKUP
+	return xa_load(&card->ctl_numids, numid);
+#else
 	list_for_each_entry(kctl, &card->controls, list) {
 		if (kctl->id.numid <= numid && kctl->id.numid + kctl->count > numid)
 			return kctl;
 	}
 	return NULL;
+#endif
 }
 EXPORT_SYMBOL(snd_ctl_find_numid);
 
@@ -672,21 +808,18 @@ struct snd_kcontrol *snd_ctl_find_id(struct snd_card *card,
 		return NULL;
 	if (id->numid != 0)
 		return snd_ctl_find_numid(card, id->numid);
-	list_for_each_entry(kctl, &card->controls, list) {
-		if (kctl->id.iface != id->iface)
-			continue;
-		if (kctl->id.device != id->device)
-			continue;
-		if (kctl->id.subdevice != id->subdevice)
-			continue;
-		if (strncmp(kctl->id.name, id->name, sizeof(kctl->id.name)))
-			continue;
-		if (kctl->id.index > id->index)
-			continue;
-		if (kctl->id.index + kctl->count <= id->index)
-			continue;
+#ifdef CONFIG_SND_CTL_FAST_LOOKUP
+	kctl = xa_load(&card->ctl_hash, get_ctl_id_hash(id));
+	if (kctl && elem_id_matches(kctl, id))
 		return kctl;
-	}
+	if (!card->ctl_hash_collision)
+		return NULL; /* we can rely on only hash table */
+#endif
+	/* no matching in hash table - try all as the last resort */
+	list_for_each_entry(kctl, &card->controls, list)
+		if (elem_id_matches(kctl, id))
+			return kctl;
+
 	return NULL;
 }
 EXPORT_SYMBOL(snd_ctl_find_id);
@@ -1151,6 +1284,71 @@ static int snd_ctl_elem_write_user(struct snd_ctl_file *file,
 	return result;
 }
 
+/* max. number of element values accessed by one batch ioctl */
+#define SND_CTL_BATCH_MAX	1024
+
+/*
+ * Read or write a vector of element values with a single acquisition of
+ * controls_rwsem; the result of each element access is returned in the
+ * errors array, and the ioctl itself only fails if the batch can't be
+ * processed at all.
+ */
+static int snd_ctl_elem_batch_user(struct snd_ctl_file *file,
+				   struct snd_ctl_elem_batch __user *_batch,
+				   bool write)
+{
+	struct snd_card *card = file->card;
+	struct snd_ctl_elem_batch batch;
+	struct snd_ctl_elem_value __user *uvalues;
+	struct snd_ctl_elem_value *values;
+	int *errors;
+	unsigned int i;
+	int result;
+
+	if (copy_from_user(&batch, _batch, sizeof(batch)))
+		return -EFAULT;
+	if (batch.flags || !batch.count || batch.count > SND_CTL_BATCH_MAX)
+		return -EINVAL;
+
+	uvalues = u64_to_user_ptr(batch.values);
+	values = vmemdup_user(uvalues,
+			      array_size(batch.count, sizeof(*values)));
+	if (IS_ERR(values))
+		return PTR_ERR(values);
+
+	errors = kcalloc(batch.count, sizeof(*errors), GFP_KERNEL);
+	if (!errors) {
+		result = -ENOMEM;
+		goto error;
+	}
+
+	result = snd_power_wait(card, SNDRV_CTL_POWER_D0);
+	if (result < 0)
+		goto error;
+
+	if (write) {
+		down_write(&card->controls_rwsem);
+		for (i = 0; i < batch.count; i++)
+			errors[i] = snd_ctl_elem_write(card, file, &values[i]);
+		up_write(&card->controls_rwsem);
+	} else {
+		down_read(&card->controls_rwsem);
+		for (i = 0; i < batch.count; i++)
+			errors[i] = snd_ctl_elem_read(card, &values[i]);
+		up_read(&card->controls_rwsem);
+	}
+
+	if (copy_to_user(uvalues, values,
+			 array_size(batch.count, sizeof(*values))) ||
+	    copy_to_user(u64_to_user_ptr(batch.errors), errors,
+			 array_size(batch.count, sizeof(*errors))))
+		result = -EFAULT;
+ error:
+	kfree(errors);
+	kvfree(values);
+	return result;
+}
+
 static int snd_ctl_elem_lock(struct snd_ctl_file *file,
 			     struct snd_ctl_elem_id __user *_id)
 {
@@ -1710,6 +1908,10 @@ static long snd_ctl_ioctl(struct file *file, unsigned int cmd, unsigned long arg
 		return snd_ctl_elem_read_user(card, argp);
 	case SNDRV_CTL_IOCTL_ELEM_WRITE:
 		return snd_ctl_elem_write_user(ctl, argp);
+	case SNDRV_CTL_IOCTL_ELEM_READ_BATCH:
+		return snd_ctl_elem_batch_user(ctl, argp, false);
+	case SNDRV_CTL_IOCTL_ELEM_WRITE_BATCH:
+		return snd_ctl_elem_batch_user(ctl, argp, true);
 	case SNDRV_CTL_IOCTL_ELEM_LOCK:
 		return snd_ctl_elem_lock(ctl, argp);
 	case SNDRV_CTL_IOCTL_ELEM_UNLOCK:
@@ -1776,8 +1978,8 @@ static ssize_t snd_ctl_read(struct file *file, char __user *buffer,
 	spin_lock_irq(&ctl->read_lock);
 	while (count >= sizeof(struct snd_ctl_event)) {
 		struct snd_ctl_event ev;
-		struct snd_kctl_event *kev;
-		while (list_empty(&ctl->events)) {
+		struct snd_kctl_event kev;
+		while (!ctl->event_count && !ctl->event_overflow) {
 			wait_queue_entry_t wait;
 			if ((file->f_flags & O_NONBLOCK) != 0 || result > 0) {
 				err = -EAGAIN;
@@ -1795,13 +1997,18 @@ static ssize_t snd_ctl_read(struct file *file, char __user *buffer,
 				return -ERESTARTSYS;
 			spin_lock_irq(&ctl->read_lock);
 		}
-		kev = snd_kctl_event(ctl->events.next);
-		ev.type = SNDRV_CTL_EVENT_ELEM;
-		ev.data.elem.mask = kev->mask;
-		ev.data.elem.id = kev->id;
-		list_del(&kev->list);
+		memset(&ev, 0, sizeof(ev));
+		if (ctl->event_overflow) {
+			/* report the loss before the events left in the ring */
+			ev.type = SNDRV_CTL_EVENT_OVERFLOW;
+			ctl->event_overflow = false;
+		} else {
+			snd_ctl_pop_event(ctl, &kev);
+			ev.type = SNDRV_CTL_EVENT_ELEM;
+			ev.data.elem.mask = kev.mask;
+			ev.data.elem.id = kev.id;
+		}
 		spin_unlock_irq(&ctl->read_lock);
-		kfree(kev);
 		if (copy_to_user(buffer, &ev, sizeof(struct snd_ctl_event))) {
 			err = -EFAULT;
 			goto __end;
@@ -1828,7 +2035,7 @@ static __poll_t snd_ctl_poll(struct file *file, poll_table * wait)
 	poll_wait(file, &ctl->change_sleep, wait);
 
 	mask = 0;
-	if (!list_empty(&ctl->events))
+	if (ctl->event_count || ctl->event_overflow)
 		mask |= EPOLLIN | EPOLLRDNORM;
 
 	return mask;
@@ -2021,6 +2228,10 @@ static int snd_ctl_dev_free(struct snd_device *device)
 		control = snd_kcontrol(card->controls.next);
 		snd_ctl_remove(card, control);
 	}
+#ifdef CONFIG_SND_CTL_FAST_LOOKUP
+	xa_destroy(&card->ctl_numids);
+	xa_destroy(&card->ctl_hash);
+#endif
 	up_write(&card->controls_rwsem);
 	put_device(&card->ctl_dev);
 	return 0;
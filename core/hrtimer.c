@@ -21,6 +21,10 @@ MODULE_ALIAS("snd-timer-" __stringify(SNDRV_TIMER_GLOBAL_HRTIMER));
 #define NANO_SEC	1000000000UL	/* 10^9 in sec */
 static unsigned int resolution;
 
+static unsigned int slack_us;
+module_param(slack_us, uint, 0644);
+MODULE_PARM_DESC(slack_us, "Allowed delay of each expiry in usec, to coalesce wakeups (0 = exact)");
+
 struct snd_hrtimer {
 	struct snd_timer *timer;
 	struct hrtimer hrt;
@@ -95,11 +99,18 @@ static int snd_hrtimer_close(struct snd_timer *t)
 static int snd_hrtimer_start(struct snd_timer *t)
 {
 	struct snd_hrtimer *stime = t->private_data;
+	u64 period = (u64)t->sticks * resolution;
+	u64 slack = (u64)READ_ONCE(slack_us) * NSEC_PER_USEC;
 
 	if (stime->in_callback)
 		return 0;
-	hrtimer_start(&stime->hrt, ns_to_ktime(t->sticks * resolution),
-		      HRTIMER_MODE_REL);
+	/*
+	 * The slack lets the expiry be merged with other timers due in the
+	 * same window; it is kept across restarts by the forward in the
+	 * callback, and never exceeds half a period.
+	 */
+	hrtimer_start_range_ns(&stime->hrt, ns_to_ktime(period),
+			       min(slack, period / 2), HRTIMER_MODE_REL);
 	return 0;
 }
 
@@ -29,7 +29,15 @@
  *  Basic linear conversion plugin
  */
  
+struct linear_priv;
+
+typedef void (*linear_f)(struct linear_priv *data,
+			 char *dst, int dst_step,
+			 const char *src, int src_step,
+			 snd_pcm_uframes_t frames);
+
 struct linear_priv {
+	linear_f func;		/* conversion of one channel */
 	int cvt_endian;		/* need endian conversion? */
 	unsigned int src_ofs;	/* byte offset in source format */
 	unsigned int dst_ofs;	/* byte soffset in destination format */
@@ -37,6 +45,10 @@ struct linear_priv {
 	unsigned int dst_bytes;		/* byte size of destination format */
 	unsigned int copy_bytes;	/* bytes to copy per conversion */
 	unsigned int flip; /* MSB flip for signeness, done after endian conv */
+	/* for the 8 and 16 bit conversions */
+	int swap16;	/* the 16 bit side is not in cpu endian */
+	u16 flip16;	/* MSB flip of a 16 bit destination */
+	u8 flip8;	/* MSB flip of an 8 bit value */
 };
 
 static inline void do_convert(struct linear_priv *data,
@@ -52,6 +64,81 @@ static inline void do_convert(struct linear_priv *data,
 	memcpy(dst, p + data->dst_ofs, data->dst_bytes);
 }
 
+static void convert_generic(struct linear_priv *data,
+			    char *dst, int dst_step,
+			    const char *src, int src_step,
+			    snd_pcm_uframes_t frames)
+{
+	while (frames-- > 0) {
+		do_convert(data, dst, (unsigned char *)src);
+		src += src_step;
+		dst += dst_step;
+	}
+}
+
+/*
+ * The conversions between 8 and 16 bit formats are the most common ones
+ * for OSS applications; they get their own loops, one load and one store
+ * per sample instead of the byte copies of do_convert().
+ */
+
+/* 16 bit to 16 bit: a byte swap and/or a sign flip */
+static void convert_16_16(struct linear_priv *data,
+			  char *dst, int dst_step,
+			  const char *src, int src_step,
+			  snd_pcm_uframes_t frames)
+{
+	u16 flip = data->flip16;
+
+	if (data->cvt_endian) {
+		while (frames-- > 0) {
+			*(u16 *)dst = swab16(*(const u16 *)src) ^ flip;
+			src += src_step;
+			dst += dst_step;
+		}
+	} else {
+		while (frames-- > 0) {
+			*(u16 *)dst = *(const u16 *)src ^ flip;
+			src += src_step;
+			dst += dst_step;
+		}
+	}
+}
+
+static void convert_8_16(struct linear_priv *data,
+			 char *dst, int dst_step,
+			 const char *src, int src_step,
+			 snd_pcm_uframes_t frames)
+{
+	u8 flip = data->flip8;
+	u16 val;
+
+	while (frames-- > 0) {
+		val = (u16)(*(const u8 *)src ^ flip) << 8;
+		*(u16 *)dst = data->swap16 ? swab16(val) : val;
+		src += src_step;
+		dst += dst_step;
+	}
+}
+
+static void convert_16_8(struct linear_priv *data,
+			 char *dst, int dst_step,
+			 const char *src, int src_step,
+			 snd_pcm_uframes_t frames)
+{
+	u8 flip = data->flip8;
+	u16 val;
+
+	while (frames-- > 0) {
+		val = *(const u16 *)src;
+		if (data->swap16)
+			val = swab16(val);
+		*(u8 *)dst = (val >> 8) ^ flip;
+		src += src_step;
+		dst += dst_step;
+	}
+}
+
 static void convert(struct snd_pcm_plugin *plugin,
 		    const struct snd_pcm_plugin_channel *src_channels,
 		    struct snd_pcm_plugin_channel *dst_channels,
@@ -64,7 +151,6 @@ static void convert(struct snd_pcm_plugin *plugin,
 		char *src;
 		char *dst;
 		int src_step, dst_step;
-		snd_pcm_uframes_t frames1;
 		if (!src_channels[channel].enabled) {
 			if (dst_channels[channel].wanted)
 				snd_pcm_area_silence(&dst_channels[channel].area, 0, frames, plugin->dst_format.format);
@@ -76,12 +162,7 @@ static void convert(struct snd_pcm_plugin *plugin,
 		dst = dst_channels[channel].area.addr + dst_channels[channel].area.first / 8;
 		src_step = src_channels[channel].area.step / 8;
 		dst_step = dst_channels[channel].area.step / 8;
-		frames1 = frames;
-		while (frames1-- > 0) {
-			do_convert(data, dst, src);
-			src += src_step;
-			dst += dst_step;
-		}
+		data->func(data, dst, dst_step, src, src_step, frames);
 	}
 }
 
@@ -143,6 +224,30 @@ static void init_data(struct linear_priv *data,
 			data->flip = (__force u32)cpu_to_le32(0x80000000);
 		else
 			data->flip = (__force u32)cpu_to_be32(0x80000000);
+		if (dst_le)
+			data->flip16 = (__force u16)cpu_to_le16(0x8000);
+		else
+			data->flip16 = (__force u16)cpu_to_be16(0x8000);
+		data->flip8 = 0x80;
+	}
+
+	data->func = convert_generic;
+	if (snd_pcm_format_physical_width(src_format) != src_bytes * 8 ||
+	    snd_pcm_format_physical_width(dst_format) != dst_bytes * 8)
+		return;
+#ifdef SNDRV_LITTLE_ENDIAN
+	src_le = !src_le;
+	dst_le = !dst_le;
+#endif
+	/* src_le and dst_le now tell the byte swap against the cpu endian */
+	if (src_bytes == 2 && dst_bytes == 2) {
+		data->func = convert_16_16;
+	} else if (src_bytes == 1 && dst_bytes == 2) {
+		data->swap16 = dst_le;
+		data->func = convert_8_16;
+	} else if (src_bytes == 2 && dst_bytes == 1) {
+		data->swap16 = src_le;
+		data->func = convert_16_8;
 	}
 }
 
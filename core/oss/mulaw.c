@@ -22,6 +22,7 @@
  */
   
 #include <linux/time.h>
+#include <linux/bitops.h>
 #include <dkms/sound/core.h>
 #include <dkms/sound/pcm.h>
 #include "pcm_plugin.h"
@@ -32,21 +33,10 @@
 #define	SEG_SHIFT	(4)		/* Left shift for segment number. */
 #define	SEG_MASK	(0x70)		/* Segment field mask. */
 
+/* the segment is the position of the leading 1 above bit 7, 0 to 7 */
 static inline int val_seg(int val)
 {
-	int r = 0;
-	val >>= 7;
-	if (val & 0xf0) {
-		val >>= 4;
-		r += 4;
-	}
-	if (val & 0x0c) {
-		val >>= 2;
-		r += 2;
-	}
-	if (val & 0x02)
-		r += 1;
-	return r;
+	return fls((val >> 7) | 1) - 1;
 }
 
 #define	BIAS		(0x84)		/* Bias for linear code. */
@@ -151,6 +141,7 @@ struct mulaw_priv {
 	unsigned int native_bytes;	/* byte size of the native format */
 	unsigned int copy_bytes;	/* bytes to copy per conversion */
 	u16 flip; /* MSB flip for signedness, done after endian conversion */
+	s16 decode[256];	/* u-law to linear, for decoding */
 };
 
 static inline void cvt_s16_to_native(struct mulaw_priv *data,
@@ -191,7 +182,7 @@ static void mulaw_decode(struct snd_pcm_plugin *plugin,
 		dst_step = dst_channels[channel].area.step / 8;
 		frames1 = frames;
 		while (frames1-- > 0) {
-			signed short sample = ulaw2linear(*src);
+			signed short sample = data->decode[(unsigned char)*src];
 			cvt_s16_to_native(data, dst, sample);
 			src += src_step;
 			dst += dst_step;
@@ -340,6 +331,12 @@ int snd_pcm_plugin_build_mulaw(struct snd_pcm_substream *plug,
 	data = (struct mulaw_priv *)plugin->extra_data;
 	data->func = func;
 	init_data(data, format->format);
+	if (func == mulaw_decode) {
+		int i;
+
+		for (i = 0; i < 256; i++)
+			data->decode[i] = ulaw2linear(i);
+	}
 	plugin->transfer = mulaw_transfer;
 	*r_plugin = plugin;
 	return 0;
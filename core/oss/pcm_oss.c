@@ -1333,6 +1333,21 @@ snd_pcm_sframes_t snd_pcm_oss_readv3(struct snd_pcm_substream *substream, void *
 }
 #endif /* CONFIG_SND_PCM_OSS_PLUGINS */
 
+/*
+ * Without plugins, user data goes straight into the ring buffer and can
+ * span several periods, with plugins it is bounced through oss.buffer
+ * which holds a single period.
+ */
+static size_t snd_pcm_oss_direct_bytes(struct snd_pcm_runtime *runtime,
+				       size_t bytes)
+{
+#ifdef CONFIG_SND_PCM_OSS_PLUGINS
+	if (runtime->oss.plugin_first)
+		return runtime->oss.period_bytes;
+#endif
+	return bytes - bytes % runtime->oss.period_bytes;
+}
+
 static ssize_t snd_pcm_oss_write2(struct snd_pcm_substream *substream, const char *buf, size_t bytes, int in_kernel)
 {
 	struct snd_pcm_runtime *runtime = substream->runtime;
@@ -1416,9 +1431,11 @@ static ssize_t snd_pcm_oss_write1(struct snd_pcm_substream *substream, const cha
 				}
 			}
 		} else {
+			size_t len = snd_pcm_oss_direct_bytes(runtime, bytes);
+
 			tmp = snd_pcm_oss_write2(substream,
 						 (const char __force *)buf,
-						 runtime->oss.period_bytes, 0);
+						 len, 0);
 			if (tmp <= 0)
 				goto err;
 			runtime->oss.bytes += tmp;
@@ -1426,7 +1443,7 @@ static ssize_t snd_pcm_oss_write1(struct snd_pcm_substream *substream, const cha
 			bytes -= tmp;
 			xfer += tmp;
 			if ((substream->f_flags & O_NONBLOCK) != 0 &&
-			    tmp != runtime->oss.period_bytes)
+			    tmp != len)
 				tmp = -EAGAIN;
 		}
  err:
@@ -1516,7 +1533,8 @@ static ssize_t snd_pcm_oss_read1(struct snd_pcm_substream *substream, char __use
 			runtime->oss.buffer_used -= tmp;
 		} else {
 			tmp = snd_pcm_oss_read2(substream, (char __force *)buf,
-						runtime->oss.period_bytes, 0);
+						snd_pcm_oss_direct_bytes(runtime, bytes),
+						0);
 			if (tmp <= 0)
 				goto err;
 			runtime->oss.bytes += tmp;
@@ -104,11 +104,8 @@ static void resample_expand(struct snd_pcm_plugin *plugin,
 					src += src_step;
 				}
 			}
+			/* pos < BITS, the result lies between S1 and S2 */
 			val = S1 + ((S2 - S1) * (signed int)pos) / BITS;
-			if (val < -32768)
-				val = -32768;
-			else if (val > 32767)
-				val = 32767;
 			*dst = val;
 			dst += dst_step;
 			pos += data->pitch;
@@ -162,11 +159,8 @@ static void resample_shrink(struct snd_pcm_plugin *plugin,
 			}
 			if (pos & ~R_MASK) {
 				pos &= R_MASK;
+				/* pos < BITS, the result lies between S1 and S2 */
 				val = S1 + ((S2 - S1) * (signed int)pos) / BITS;
-				if (val < -32768)
-					val = -32768;
-				else if (val > 32767)
-					val = 32767;
 				*dst = val;
 				dst += dst_step;
 				dst_frames1--;
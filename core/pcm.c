@@ -474,6 +474,71 @@ static void snd_pcm_substream_proc_status_read(struct snd_info_entry *entry,
 	mutex_unlock(&substream->pcm->open_mutex);
 }
 
+static void snd_pcm_stats_hist_read(struct snd_info_buffer *buffer,
+				    const char *name, const unsigned int *hist)
+{
+	unsigned int i;
+
+	snd_iprintf(buffer, "%s:\n", name);
+	for (i = 0; i < SNDRV_PCM_STATS_BUCKETS; i++) {
+		if (!hist[i])
+			continue;
+		if (!i)
+			snd_iprintf(buffer, "  0: %u\n", hist[i]);
+		else if (i == SNDRV_PCM_STATS_BUCKETS - 1)
+			snd_iprintf(buffer, "  %lu-: %u\n", 1UL << (i - 1),
+				    hist[i]);
+		else
+			snd_iprintf(buffer, "  %lu-%lu: %u\n", 1UL << (i - 1),
+				    (1UL << i) - 1, hist[i]);
+	}
+}
+
+static void snd_pcm_substream_proc_stats_read(struct snd_info_entry *entry,
+					      struct snd_info_buffer *buffer)
+{
+	struct snd_pcm_substream *substream = entry->private_data;
+	struct snd_pcm_substream_stats stats;
+
+	/* take a consistent copy, the counters move under the stream lock */
+	mutex_lock(&substream->pcm->open_mutex);
+	if (substream->runtime) {
+		snd_pcm_stream_lock_irq(substream);
+		stats = substream->stats;
+		snd_pcm_stream_unlock_irq(substream);
+	} else {
+		stats = substream->stats;
+	}
+	mutex_unlock(&substream->pcm->open_mutex);
+
+	snd_iprintf(buffer, "xruns: %lu\n", stats.xruns);
+	snd_iprintf(buffer, "periods: %lu\n", stats.periods);
+	snd_pcm_stats_hist_read(buffer, "period_interval_us",
+				stats.period_interval);
+	snd_pcm_stats_hist_read(buffer, "hw_ptr_jitter_frames",
+				stats.hw_ptr_jitter);
+	snd_pcm_stats_hist_read(buffer, "wakeup_latency_us",
+				stats.wakeup_latency);
+	snd_pcm_stats_hist_read(buffer, "appl_lead_frames", stats.appl_lead);
+	snd_iprintf(buffer, "trigger_skew_ns: %llu\n", stats.trigger_skew_ns);
+	snd_pcm_stats_hist_read(buffer, "trigger_skew_us", stats.trigger_skew);
+}
+
+/* any write resets the counters */
+static void snd_pcm_substream_proc_stats_write(struct snd_info_entry *entry,
+					       struct snd_info_buffer *buffer)
+{
+	struct snd_pcm_substream *substream = entry->private_data;
+
+	mutex_lock(&substream->pcm->open_mutex);
+	if (substream->runtime)
+		snd_pcm_stream_lock_irq(substream);
+	memset(&substream->stats, 0, sizeof(substream->stats));
+	if (substream->runtime)
+		snd_pcm_stream_unlock_irq(substream);
+	mutex_unlock(&substream->pcm->open_mutex);
+}
+
 #ifdef CONFIG_SND_PCM_XRUN_DEBUG
 static void snd_pcm_xrun_injection_write(struct snd_info_entry *entry,
 					 struct snd_info_buffer *buffer)
@@ -575,6 +640,12 @@ static int snd_pcm_substream_proc_init(struct snd_pcm_substream *substream)
 				    snd_pcm_substream_proc_sw_params_read);
 	create_substream_info_entry(substream, "status",
 				    snd_pcm_substream_proc_status_read);
+	entry = create_substream_info_entry(substream, "stats",
+					    snd_pcm_substream_proc_stats_read);
+	if (entry) {
+		entry->c.text.write = snd_pcm_substream_proc_stats_write;
+		entry->mode |= 0200;
+	}
 
 #ifdef CONFIG_SND_PCM_XRUN_DEBUG
 	entry = create_substream_info_entry(substream, "xrun_injection", NULL);
@@ -961,10 +1032,26 @@ int snd_pcm_attach_substream(struct snd_pcm *pcm, int stream,
 	}
 	memset(runtime->control, 0, size);
 
+	size = PAGE_ALIGN(sizeof(struct snd_pcm_mmap_timing));
+	runtime->timing = alloc_pages_exact(size, GFP_KERNEL);
+	if (runtime->timing == NULL) {
+		free_pages_exact(runtime->control,
+			       PAGE_ALIGN(sizeof(struct snd_pcm_mmap_control)));
+		free_pages_exact(runtime->status,
+			       PAGE_ALIGN(sizeof(struct snd_pcm_mmap_status)));
+		kfree(runtime);
+		return -ENOMEM;
+	}
+	memset(runtime->timing, 0, size);
+	runtime->timing->version = SNDRV_PCM_MMAP_TIMING_VERSION;
+	seqcount_init(&runtime->hw_snapshot.seq);
+
 	init_waitqueue_head(&runtime->sleep);
 	init_waitqueue_head(&runtime->tsleep);
 
 	runtime->status->state = SNDRV_PCM_STATE_OPEN;
+	runtime->timing->state = SNDRV_PCM_STATE_OPEN;
+	runtime->hw_snapshot.state = SNDRV_PCM_STATE_OPEN;
 
 	substream->runtime = runtime;
 	substream->private_data = pcm->private_data;
@@ -989,7 +1076,11 @@ void snd_pcm_detach_substream(struct snd_pcm_substream *substream)
 		       PAGE_ALIGN(sizeof(struct snd_pcm_mmap_status)));
 	free_pages_exact(runtime->control,
 		       PAGE_ALIGN(sizeof(struct snd_pcm_mmap_control)));
+	free_pages_exact(runtime->timing,
+		       PAGE_ALIGN(sizeof(struct snd_pcm_mmap_timing)));
+	kfree(runtime->refine_cache);
 	kfree(runtime->hw_constraints.rules);
+	kfree(runtime->hw_constraints.rule_deps);
 	/* Avoid concurrent access to runtime via PCM timer interface */
 	if (substream->timer)
 		spin_lock_irq(&substream->timer->lock);
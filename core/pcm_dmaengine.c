@@ -12,6 +12,7 @@
 #include <linux/module.h>
 #include <linux/init.h>
 #include <linux/dmaengine.h>
+#include <linux/scatterlist.h>
 #include <linux/slab.h>
 #include <dkms/sound/pcm.h>
 #include <dkms/sound/pcm_params.h>
@@ -22,8 +23,29 @@
 struct dmaengine_pcm_runtime_data {
 	struct dma_chan *dma_chan;
 	dma_cookie_t cookie;
+	/* how finely the channel reports its residue */
+	enum dma_residue_granularity granularity;
 
 	unsigned int pos;
+	/* period callbacks since the start, and at the last residue read */
+	unsigned int periods;
+	unsigned int cached_periods;
+	unsigned int cached_pos;
+	bool cached;
+	/* frames hw_ptr moved beyond the periods signalled so far */
+	snd_pcm_uframes_t ahead;
+
+	/*
+	 * Non contiguous SG buffer, see snd_dmaengine_pcm_setup_sg(): the
+	 * entries of period i are sgl[period_sg[i]] to sgl[period_sg[i + 1]]
+	 * and each period is queued as its own slave_sg descriptor.
+	 */
+	struct scatterlist *sgl;
+	unsigned int *period_sg;
+	dma_cookie_t *sg_cookies;
+	unsigned int sg_periods;
+	/* oldest queued period, the one the DMA is transferring */
+	unsigned int sg_head;
 };
 
 static inline struct dmaengine_pcm_runtime_data *substream_to_prtd(
@@ -132,12 +154,80 @@ static void dmaengine_pcm_dma_complete(void *arg)
 {
 	struct snd_pcm_substream *substream = arg;
 	struct dmaengine_pcm_runtime_data *prtd = substream_to_prtd(substream);
+	struct snd_pcm_runtime *runtime = substream->runtime;
+	snd_pcm_uframes_t hw_ptr, moved;
 
 	prtd->pos += snd_pcm_lib_period_bytes(substream);
 	if (prtd->pos >= snd_pcm_lib_buffer_bytes(substream))
 		prtd->pos = 0;
 
+	WRITE_ONCE(prtd->periods, prtd->periods + 1);
+
+	/*
+	 * When several periods complete before their callbacks run, the
+	 * first snd_pcm_period_elapsed() reads the residue and already moves
+	 * hw_ptr past all of them: the callbacks behind it have nothing more
+	 * to report. With period counting hw_ptr only moves a period per
+	 * callback and none is skipped.
+	 */
+	if (prtd->ahead >= runtime->period_size) {
+		prtd->ahead -= runtime->period_size;
+		return;
+	}
+
+	hw_ptr = READ_ONCE(runtime->status->hw_ptr);
 	snd_pcm_period_elapsed(substream);
+	moved = READ_ONCE(runtime->status->hw_ptr) - hw_ptr;
+	if ((snd_pcm_sframes_t)moved < 0)
+		moved += runtime->boundary;
+
+	/* a stop or an xrun moves hw_ptr back, start over from there */
+	if (moved > runtime->buffer_size)
+		prtd->ahead = 0;
+	else if (prtd->ahead + moved > runtime->period_size)
+		prtd->ahead += moved - runtime->period_size;
+	else
+		prtd->ahead = 0;
+}
+
+static int dmaengine_pcm_submit_period(struct snd_pcm_substream *substream,
+				       unsigned int period);
+
+static void dmaengine_pcm_sg_complete(void *arg)
+{
+	struct snd_pcm_substream *substream = arg;
+	struct dmaengine_pcm_runtime_data *prtd = substream_to_prtd(substream);
+	unsigned int period = prtd->sg_head;
+
+	/* queue the period again behind the others to keep the ring going */
+	WRITE_ONCE(prtd->sg_head, (period + 1) % prtd->sg_periods);
+	if (!dmaengine_pcm_submit_period(substream, period))
+		dma_async_issue_pending(prtd->dma_chan);
+
+	if (!substream->runtime->no_period_wakeup)
+		dmaengine_pcm_dma_complete(arg);
+}
+
+static int dmaengine_pcm_submit_period(struct snd_pcm_substream *substream,
+				       unsigned int period)
+{
+	struct dmaengine_pcm_runtime_data *prtd = substream_to_prtd(substream);
+	struct dma_async_tx_descriptor *desc;
+	unsigned int first = prtd->period_sg[period];
+
+	/* each period completion requeues it, it always interrupts */
+	desc = dmaengine_prep_slave_sg(prtd->dma_chan, &prtd->sgl[first],
+		prtd->period_sg[period + 1] - first,
+		snd_pcm_substream_to_dma_direction(substream),
+		DMA_CTRL_ACK | DMA_PREP_INTERRUPT);
+	if (!desc)
+		return -ENOMEM;
+
+	desc->callback = dmaengine_pcm_sg_complete;
+	desc->callback_param = substream;
+	prtd->sg_cookies[period] = dmaengine_submit(desc);
+
+	return 0;
 }
 
 static int dmaengine_pcm_prepare_and_submit(struct snd_pcm_substream *substream)
@@ -147,6 +237,8 @@ static int dmaengine_pcm_prepare_and_submit(struct snd_pcm_substream *substream)
 	struct dma_async_tx_descriptor *desc;
 	enum dma_transfer_direction direction;
 	unsigned long flags = DMA_CTRL_ACK;
+	unsigned int i;
+	int ret;
 
 	direction = snd_pcm_substream_to_dma_direction(substream);
 
@@ -154,6 +246,22 @@ static int dmaengine_pcm_prepare_and_submit(struct snd_pcm_substream *substream)
 		flags |= DMA_PREP_INTERRUPT;
 
 	prtd->pos = 0;
+	prtd->periods = 0;
+	prtd->cached = false;
+	prtd->ahead = 0;
+
+	if (prtd->sgl) {
+		prtd->sg_head = 0;
+		for (i = 0; i < prtd->sg_periods; i++) {
+			ret = dmaengine_pcm_submit_period(substream, i);
+			if (ret) {
+				dmaengine_terminate_async(chan);
+				return ret;
+			}
+		}
+		return 0;
+	}
+
 	desc = dmaengine_prep_dma_cyclic(chan,
 		substream->runtime->dma_addr,
 		snd_pcm_lib_buffer_bytes(substream),
@@ -236,6 +344,10 @@ EXPORT_SYMBOL_GPL(snd_dmaengine_pcm_pointer_no_residue);
  *
  * This function can be used as the PCM pointer callback for dmaengine based PCM
  * driver implementations.
+ *
+ * The residue of a channel with segment granularity only changes when a
+ * period completes, so until the next period callback the last position read
+ * is returned without querying the DMA controller again.
  */
 snd_pcm_uframes_t snd_dmaengine_pcm_pointer(struct snd_pcm_substream *substream)
 {
@@ -244,8 +356,30 @@ snd_pcm_uframes_t snd_dmaengine_pcm_pointer(struct snd_pcm_substream *substream)
 	struct dma_tx_state state;
 	enum dma_status status;
 	unsigned int buf_size;
+	unsigned int periods;
+	unsigned int period;
 	unsigned int pos = 0;
 
+	if (prtd->sgl) {
+		period = READ_ONCE(prtd->sg_head);
+		pos = period * snd_pcm_lib_period_bytes(substream);
+		status = dmaengine_tx_status(prtd->dma_chan,
+					     prtd->sg_cookies[period], &state);
+		if ((status == DMA_IN_PROGRESS || status == DMA_PAUSED) &&
+		    state.residue > 0 &&
+		    state.residue <= snd_pcm_lib_period_bytes(substream))
+			pos += snd_pcm_lib_period_bytes(substream) -
+			       state.residue;
+
+		return bytes_to_frames(runtime, pos);
+	}
+
+	periods = READ_ONCE(prtd->periods);
+	if (prtd->granularity == DMA_RESIDUE_GRANULARITY_SEGMENT &&
+	    !runtime->no_period_wakeup && prtd->cached &&
+	    prtd->cached_periods == periods)
+		return bytes_to_frames(runtime, prtd->cached_pos);
+
 	status = dmaengine_tx_status(prtd->dma_chan, prtd->cookie, &state);
 	if (status == DMA_IN_PROGRESS || status == DMA_PAUSED) {
 		buf_size = snd_pcm_lib_buffer_bytes(substream);
@@ -254,12 +388,117 @@ snd_pcm_uframes_t snd_dmaengine_pcm_pointer(struct snd_pcm_substream *substream)
 
 		//		runtime->delay = bytes_to_frames(runtime,
 		//				 state.in_flight_bytes);
+
+		prtd->cached_pos = pos;
+		prtd->cached_periods = periods;
+		prtd->cached = true;
 	}
 
 	return bytes_to_frames(runtime, pos);
 }
 EXPORT_SYMBOL_GPL(snd_dmaengine_pcm_pointer);
 
+static void dmaengine_pcm_free_sg(struct dmaengine_pcm_runtime_data *prtd)
+{
+	kfree(prtd->sgl);
+	kfree(prtd->period_sg);
+	kfree(prtd->sg_cookies);
+	prtd->sgl = NULL;
+	prtd->period_sg = NULL;
+	prtd->sg_cookies = NULL;
+	prtd->sg_periods = 0;
+}
+
+/*
+ * Split each period of the buffer in its DMA contiguous chunks, filling the
+ * scatterlist if it is allocated, and return the number of chunks.
+ */
+static unsigned int dmaengine_pcm_fill_sg(struct snd_pcm_substream *substream)
+{
+	struct dmaengine_pcm_runtime_data *prtd = substream_to_prtd(substream);
+	struct snd_dma_buffer *dmab = snd_pcm_get_dma_buf(substream);
+	unsigned int period_bytes = snd_pcm_lib_period_bytes(substream);
+	unsigned int period, ofs, end, len, nents = 0;
+	struct scatterlist *sg = prtd->sgl;
+
+	for (period = 0; period < substream->runtime->periods; period++) {
+		if (prtd->period_sg)
+			prtd->period_sg[period] = nents;
+
+		end = (period + 1) * period_bytes;
+		for (ofs = period * period_bytes; ofs < end; ofs += len) {
+			len = snd_sgbuf_get_chunk_size(dmab, ofs, end - ofs);
+			if (sg) {
+				sg_dma_address(sg) = snd_sgbuf_get_addr(dmab, ofs);
+				sg_dma_len(sg) = len;
+				sg = sg_next(sg);
+			}
+			nents++;
+		}
+	}
+
+	if (prtd->period_sg)
+		prtd->period_sg[period] = nents;
+
+	return nents;
+}
+
+/**
+ * snd_dmaengine_pcm_setup_sg - Describe a SG buffer for the DMA transfers
+ * @substream: PCM substream
+ *
+ * Returns 0 on success, a negative error code otherwise.
+ *
+ * A SG buffer is generally not contiguous in the DMA address space and can't
+ * be handed to dmaengine_prep_dma_cyclic(). This function splits such a
+ * buffer into per period scatterlists, which the trigger callback then queues
+ * as slave_sg descriptors, each period being queued again as it completes.
+ * Contiguous buffers keep using a single cyclic transfer.
+ *
+ * The function should be called from the hw_params callback, once the buffer
+ * has been allocated.
+ */
+int snd_dmaengine_pcm_setup_sg(struct snd_pcm_substream *substream)
+{
+	struct dmaengine_pcm_runtime_data *prtd = substream_to_prtd(substream);
+	struct snd_dma_buffer *dmab = snd_pcm_get_dma_buf(substream);
+	unsigned int periods = substream->runtime->periods;
+	unsigned int nents;
+
+	dmaengine_pcm_free_sg(prtd);
+
+	if (!dmab || (dmab->dev.type != SNDRV_DMA_TYPE_DEV_SG &&
+		      dmab->dev.type != SNDRV_DMA_TYPE_DEV_UC_SG))
+		return 0;
+
+	if (snd_sgbuf_get_chunk_size(dmab, 0,
+				     snd_pcm_lib_buffer_bytes(substream)) ==
+	    snd_pcm_lib_buffer_bytes(substream)) {
+		/* contiguous after all, the cyclic transfer starts there */
+		substream->runtime->dma_addr = snd_sgbuf_get_addr(dmab, 0);
+		return 0;
+	}
+
+	nents = dmaengine_pcm_fill_sg(substream);
+
+	prtd->sgl = kcalloc(nents, sizeof(*prtd->sgl), GFP_KERNEL);
+	prtd->period_sg = kcalloc(periods + 1, sizeof(*prtd->period_sg),
+				  GFP_KERNEL);
+	prtd->sg_cookies = kcalloc(periods, sizeof(*prtd->sg_cookies),
+				   GFP_KERNEL);
+	if (!prtd->sgl || !prtd->period_sg || !prtd->sg_cookies) {
+		dmaengine_pcm_free_sg(prtd);
+		return -ENOMEM;
+	}
+
+	sg_init_table(prtd->sgl, nents);
+	dmaengine_pcm_fill_sg(substream);
+	prtd->sg_periods = periods;
+
+	return 0;
+}
+EXPORT_SYMBOL_GPL(snd_dmaengine_pcm_setup_sg);
+
 /**
  * snd_dmaengine_pcm_request_channel - Request channel for the dmaengine PCM
  * @filter_fn: Filter function used to request the DMA channel
@@ -297,6 +536,7 @@ int snd_dmaengine_pcm_open(struct snd_pcm_substream *substream,
 	struct dma_chan *chan)
 {
 	struct dmaengine_pcm_runtime_data *prtd;
+	struct dma_slave_caps dma_caps;
 	int ret;
 
 	if (!chan)
@@ -313,6 +553,12 @@ int snd_dmaengine_pcm_open(struct snd_pcm_substream *substream,
 
 	prtd->dma_chan = chan;
 
+	/* without the caps, always query the residue as before */
+	if (dma_get_slave_caps(chan, &dma_caps) == 0)
+		prtd->granularity = dma_caps.residue_granularity;
+	else
+		prtd->granularity = DMA_RESIDUE_GRANULARITY_BURST;
+
 	substream->runtime->private_data = prtd;
 
 	return 0;
@@ -349,6 +595,7 @@ int snd_dmaengine_pcm_close(struct snd_pcm_substream *substream)
 	struct dmaengine_pcm_runtime_data *prtd = substream_to_prtd(substream);
 
 	dmaengine_synchronize(prtd->dma_chan);
+	dmaengine_pcm_free_sg(prtd);
 	kfree(prtd);
 
 	return 0;
@@ -367,6 +614,7 @@ int snd_dmaengine_pcm_close_release_chan(struct snd_pcm_substream *substream)
 
 	dmaengine_synchronize(prtd->dma_chan);
 	dma_release_channel(prtd->dma_chan);
+	dmaengine_pcm_free_sg(prtd);
 	kfree(prtd);
 
 	return 0;
@@ -407,6 +655,9 @@ int snd_dmaengine_pcm_refine_runtime_hwparams(
 			hw->info |= SNDRV_PCM_INFO_PAUSE | SNDRV_PCM_INFO_RESUME;
 		if (dma_caps.residue_granularity <= DMA_RESIDUE_GRANULARITY_SEGMENT)
 			hw->info |= SNDRV_PCM_INFO_BATCH;
+		/* the pointer is exact without period interrupts */
+		else if (!(hw->info & SNDRV_PCM_INFO_BATCH))
+			hw->info |= SNDRV_PCM_INFO_NO_PERIOD_WAKEUP;
 
 		if (substream->stream == SNDRV_PCM_STREAM_PLAYBACK)
 			addr_widths = dma_caps.dst_addr_widths;
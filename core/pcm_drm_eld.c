@@ -17,33 +17,60 @@ static const unsigned int eld_rates[] = {
 	192000,
 };
 
+/* the max channels of the SADs per rate of eld_rates[], 4 bits each */
+#define ELD_RATE_CHANNELS(map, i)	(((map) >> ((i) * 4)) & 0xf)
+
 static unsigned int sad_max_channels(const u8 *sad)
 {
 	return 1 + (sad[0] & 7);
 }
 
+/*
+ * Parse the SADs once when the constraint is added, so that the rules
+ * below, evaluated on every refine iteration, don't need to.
+ */
+static unsigned long eld_rate_channels(const u8 *eld)
+{
+	unsigned long map = 0;
+	unsigned int max_channels, i, r;
+	const u8 *sad;
+
+	sad = drm_eld_sad(eld);
+	if (!sad)
+		return 0;
+
+	for (i = drm_eld_sad_count(eld); i > 0; i--, sad += 3) {
+		max_channels = sad_max_channels(sad);
+		for (r = 0; r < ARRAY_SIZE(eld_rates); r++) {
+			if (!(sad[1] & BIT(r)) ||
+			    ELD_RATE_CHANNELS(map, r) >= max_channels)
+				continue;
+			map &= ~(0xfUL << (r * 4));
+			map |= (unsigned long)max_channels << (r * 4);
+		}
+	}
+
+	return map;
+}
+
 static int eld_limit_rates(struct snd_pcm_hw_params *params,
 			   struct snd_pcm_hw_rule *rule)
 {
 	struct snd_interval *r = hw_param_interval(params, rule->var);
 	const struct snd_interval *c;
-	unsigned int rate_mask = 7, i;
-	const u8 *sad, *eld = rule->private;
-
-	sad = drm_eld_sad(eld);
-	if (sad) {
-		c = hw_param_interval_c(params, SNDRV_PCM_HW_PARAM_CHANNELS);
-
-		for (i = drm_eld_sad_count(eld); i > 0; i--, sad += 3) {
-			unsigned max_channels = sad_max_channels(sad);
-
-			/*
-			 * Exclude SADs which do not include the
-			 * requested number of channels.
-			 */
-			if (c->min <= max_channels)
-				rate_mask |= sad[1];
-		}
+	unsigned long map = (unsigned long)rule->private;
+	unsigned int rate_mask = 7, max_channels, i;
+
+	c = hw_param_interval_c(params, SNDRV_PCM_HW_PARAM_CHANNELS);
+
+	/*
+	 * Exclude the rates of SADs which do not include the requested
+	 * number of channels.
+	 */
+	for (i = 0; i < ARRAY_SIZE(eld_rates); i++) {
+		max_channels = ELD_RATE_CHANNELS(map, i);
+		if (max_channels && c->min <= max_channels)
+			rate_mask |= BIT(i);
 	}
 
 	return snd_interval_list(r, ARRAY_SIZE(eld_rates), eld_rates,
@@ -56,39 +83,30 @@ static int eld_limit_channels(struct snd_pcm_hw_params *params,
 	struct snd_interval *c = hw_param_interval(params, rule->var);
 	const struct snd_interval *r;
 	struct snd_interval t = { .min = 1, .max = 2, .integer = 1, };
+	unsigned long map = (unsigned long)rule->private;
 	unsigned int i;
-	const u8 *sad, *eld = rule->private;
 
-	sad = drm_eld_sad(eld);
-	if (sad) {
-		unsigned int rate_mask = 0;
-
-		/* Convert the rate interval to a mask */
-		r = hw_param_interval_c(params, SNDRV_PCM_HW_PARAM_RATE);
-		for (i = 0; i < ARRAY_SIZE(eld_rates); i++)
-			if (r->min <= eld_rates[i] && r->max >= eld_rates[i])
-				rate_mask |= BIT(i);
-
-		for (i = drm_eld_sad_count(eld); i > 0; i--, sad += 3)
-			if (rate_mask & sad[1])
-				t.max = max(t.max, sad_max_channels(sad));
-	}
+	r = hw_param_interval_c(params, SNDRV_PCM_HW_PARAM_RATE);
+	for (i = 0; i < ARRAY_SIZE(eld_rates); i++)
+		if (r->min <= eld_rates[i] && r->max >= eld_rates[i])
+			t.max = max(t.max, ELD_RATE_CHANNELS(map, i));
 
 	return snd_interval_refine(c, &t);
 }
 
 int snd_pcm_hw_constraint_eld(struct snd_pcm_runtime *runtime, void *eld)
 {
+	void *map = (void *)eld_rate_channels(eld);
 	int ret;
 
 	ret = snd_pcm_hw_rule_add(runtime, 0, SNDRV_PCM_HW_PARAM_RATE,
-				  eld_limit_rates, eld,
+				  eld_limit_rates, map,
 				  SNDRV_PCM_HW_PARAM_CHANNELS, -1);
 	if (ret < 0)
 		return ret;
 
 	ret = snd_pcm_hw_rule_add(runtime, 0, SNDRV_PCM_HW_PARAM_CHANNELS,
-				  eld_limit_channels, eld,
+				  eld_limit_channels, map,
 				  SNDRV_PCM_HW_PARAM_RATE, -1);
 
 	return ret;
@@ -8,7 +8,9 @@
 #include <linux/slab.h>
 #include <linux/sched/signal.h>
 #include <linux/time.h>
+#include <linux/hrtimer.h>
 #include <linux/math64.h>
+#include <linux/log2.h>
 #include <linux/export.h>
 #include <dkms/sound/core.h>
 #include <dkms/sound/control.h>
@@ -143,6 +145,7 @@ void __snd_pcm_xrun(struct snd_pcm_substream *substream)
 {
 	struct snd_pcm_runtime *runtime = substream->runtime;
 
+	substream->stats.xruns++;
 	trace_xrun(substream);
 	if (runtime->tstamp_mode == SNDRV_PCM_TSTAMP_ENABLE) {
 		struct timespec64 tstamp;
@@ -197,8 +200,11 @@ int snd_pcm_update_state(struct snd_pcm_substream *substream,
 		}
 	}
 	if (runtime->twake) {
-		if (avail >= runtime->twake)
+		if (avail >= runtime->twake) {
+			if (!substream->stats.wakeup_ns)
+				substream->stats.wakeup_ns = ktime_get_ns();
 			wake_up(&runtime->tsleep);
+		}
 	} else if (avail >= runtime->control->avail_min)
 		wake_up(&runtime->sleep);
 	return 0;
@@ -254,6 +260,106 @@ static void update_audio_tstamp(struct snd_pcm_substream *substream,
 	runtime->driver_tstamp = driver_tstamp;
 }
 
+/* update the position snapshot read by snd_pcm_delay() without the lock */
+static void snd_pcm_publish_hw_ptr(struct snd_pcm_runtime *runtime)
+{
+	struct snd_pcm_hw_ptr_snapshot *snap = &runtime->hw_snapshot;
+
+	write_seqcount_begin(&snap->seq);
+	snap->state = runtime->status->state;
+	snap->hw_ptr = runtime->status->hw_ptr;
+	snap->hw_ptr_base = runtime->hw_ptr_base;
+	snap->delay = runtime->delay;
+	snap->jiffies = jiffies;
+	snap->tstamp = runtime->status->tstamp;
+	write_seqcount_end(&snap->seq);
+}
+
+/**
+ * snd_pcm_update_mmap_timing - publish the stream position to user-space
+ * @substream: the pcm substream instance
+ *
+ * Copies the pointers, the delay, the timestamps and the state to the
+ * timing record that user-space can mmap, so that it can follow the
+ * stream without any ioctl, and to the snapshot read locklessly by the
+ * kernel.  Call it with the stream lock held.
+ */
+void snd_pcm_update_mmap_timing(struct snd_pcm_substream *substream)
+{
+	struct snd_pcm_runtime *runtime = substream->runtime;
+	struct snd_pcm_mmap_timing *timing = runtime->timing;
+	snd_pcm_sframes_t delay = 0;
+
+	snd_pcm_publish_hw_ptr(runtime);
+
+	if (snd_pcm_running(substream)) {
+		if (substream->stream == SNDRV_PCM_STREAM_PLAYBACK)
+			delay = snd_pcm_playback_hw_avail(runtime);
+		else
+			delay = snd_pcm_capture_avail(runtime);
+		delay += runtime->delay;
+	}
+
+	/* the record is read locklessly, seqcount style */
+	WRITE_ONCE(timing->seq, timing->seq + 1);
+	smp_wmb();
+	timing->state = runtime->status->state;
+	timing->hw_ptr = runtime->status->hw_ptr;
+	timing->appl_ptr = runtime->control->appl_ptr;
+	timing->delay = delay;
+	timing->tstamp_sec = runtime->status->tstamp.tv_sec;
+	timing->tstamp_nsec = runtime->status->tstamp.tv_nsec;
+	timing->audio_tstamp_sec = runtime->status->audio_tstamp.tv_sec;
+	timing->audio_tstamp_nsec = runtime->status->audio_tstamp.tv_nsec;
+	smp_wmb();
+	WRITE_ONCE(timing->seq, timing->seq + 1);
+}
+
+void snd_pcm_stats_add(unsigned int *hist, u64 val)
+{
+	unsigned int bucket = val ? ilog2(val) + 1 : 0;
+
+	hist[min_t(unsigned int, bucket, SNDRV_PCM_STATS_BUCKETS - 1)]++;
+}
+
+/* account a period interrupt moving the position to new_hw_ptr */
+static void snd_pcm_stats_period(struct snd_pcm_substream *substream,
+				 snd_pcm_uframes_t new_hw_ptr)
+{
+	struct snd_pcm_runtime *runtime = substream->runtime;
+	struct snd_pcm_substream_stats *stats = &substream->stats;
+	snd_pcm_sframes_t half = runtime->boundary / 2;
+	snd_pcm_sframes_t jitter, lead;
+	u64 now = ktime_get_ns();
+
+	stats->periods++;
+	if (stats->last_period_ns)
+		snd_pcm_stats_add(stats->period_interval,
+				  div_u64(now - stats->last_period_ns,
+					  NSEC_PER_USEC));
+	stats->last_period_ns = now;
+
+	/* distance to the position expected one period after the last one */
+	jitter = new_hw_ptr - runtime->hw_ptr_interrupt - runtime->period_size;
+	if (jitter > half)
+		jitter -= runtime->boundary;
+	else if (jitter < -half)
+		jitter += runtime->boundary;
+	snd_pcm_stats_add(stats->hw_ptr_jitter, abs(jitter));
+
+	/* how far the application is from an xrun */
+	if (substream->stream == SNDRV_PCM_STREAM_PLAYBACK)
+		lead = runtime->control->appl_ptr - new_hw_ptr;
+	else
+		lead = runtime->buffer_size -
+			(new_hw_ptr - runtime->control->appl_ptr);
+	if (lead > half)
+		lead -= runtime->boundary;
+	else if (lead < -half)
+		lead += runtime->boundary;
+	snd_pcm_stats_add(stats->appl_lead, max_t(snd_pcm_sframes_t, lead, 0));
+}
+
 static int snd_pcm_update_hw_ptr0(struct snd_pcm_substream *substream,
 				  unsigned int in_interrupt)
 {
@@ -266,6 +372,7 @@ static int snd_pcm_update_hw_ptr0(struct snd_pcm_substream *substream,
 	struct timespec64 curr_tstamp;
 	struct timespec64 audio_tstamp;
 	int crossed_boundary = 0;
+	int err;
 
 	old_hw_ptr = runtime->status->hw_ptr;
 
@@ -432,8 +539,13 @@ static int snd_pcm_update_hw_ptr0(struct snd_pcm_substream *substream,
 	}
 
  no_delta_check:
+	if (in_interrupt)
+		snd_pcm_stats_period(substream, new_hw_ptr);
+
 	if (runtime->status->hw_ptr == new_hw_ptr) {
 		update_audio_tstamp(substream, &curr_tstamp, &audio_tstamp);
+		/* the position is still current, refresh its time */
+		snd_pcm_update_mmap_timing(substream);
 		return 0;
 	}
 
@@ -460,7 +572,9 @@ static int snd_pcm_update_hw_ptr0(struct snd_pcm_substream *substream,
 
 	update_audio_tstamp(substream, &curr_tstamp, &audio_tstamp);
 
-	return snd_pcm_update_state(substream, runtime);
+	err = snd_pcm_update_state(substream, runtime);
+	snd_pcm_update_mmap_timing(substream);
+	return err;
 }
 
 /* CAUTION: call it with irq disabled */
@@ -1128,6 +1242,7 @@ int snd_pcm_hw_rule_add(struct snd_pcm_runtime *runtime, unsigned int cond,
 	if (constrs->rules_num >= constrs->rules_all) {
 		struct snd_pcm_hw_rule *new;
 		unsigned int new_rules = constrs->rules_all + 16;
+		unsigned long *new_deps;
 		new = krealloc(constrs->rules, new_rules * sizeof(*c),
 			       GFP_KERNEL);
 		if (!new) {
@@ -1135,6 +1250,21 @@ int snd_pcm_hw_rule_add(struct snd_pcm_runtime *runtime, unsigned int cond,
 			return -ENOMEM;
 		}
 		constrs->rules = new;
+		new_deps = kcalloc(SNDRV_PCM_HW_PARAM_NUM *
+				   BITS_TO_LONGS(new_rules),
+				   sizeof(*new_deps), GFP_KERNEL);
+		if (!new_deps) {
+			va_end(args);
+			return -ENOMEM;
+		}
+		/* move the dependency bitmaps to their wider layout */
+		for (k = 0; k < SNDRV_PCM_HW_PARAM_NUM && constrs->rule_deps;
+		     k++)
+			bitmap_copy(new_deps + k * BITS_TO_LONGS(new_rules),
+				    constrs_rule_deps(constrs, k),
+				    constrs->rules_num);
+		kfree(constrs->rule_deps);
+		constrs->rule_deps = new_deps;
 		constrs->rules_all = new_rules;
 	}
 	c = &constrs->rules[constrs->rules_num];
@@ -1144,7 +1274,8 @@ int snd_pcm_hw_rule_add(struct snd_pcm_runtime *runtime, unsigned int cond,
 	c->private = private;
 	k = 0;
 	while (1) {
-		if (snd_BUG_ON(k >= ARRAY_SIZE(c->deps))) {
+		if (snd_BUG_ON(k >= ARRAY_SIZE(c->deps)) ||
+		    snd_BUG_ON(dep >= SNDRV_PCM_HW_PARAM_NUM)) {
 			va_end(args);
 			return -EINVAL;
 		}
@@ -1153,8 +1284,13 @@ int snd_pcm_hw_rule_add(struct snd_pcm_runtime *runtime, unsigned int cond,
 			break;
 		dep = va_arg(args, int);
 	}
+	/* the rule has to be re-run whenever one of its deps changes */
+	for (k = 0; c->deps[k] >= 0; k++)
+		set_bit(constrs->rules_num,
+			constrs_rule_deps(constrs, c->deps[k]));
 	constrs->rules_num++;
 	va_end(args);
+	snd_pcm_hw_constraints_changed(runtime);
 	return 0;
 }
 EXPORT_SYMBOL(snd_pcm_hw_rule_add);
@@ -1174,6 +1310,7 @@ int snd_pcm_hw_constraint_mask(struct snd_pcm_runtime *runtime, snd_pcm_hw_param
 {
 	struct snd_pcm_hw_constraints *constrs = &runtime->hw_constraints;
 	struct snd_mask *maskp = constrs_mask(constrs, var);
+	snd_pcm_hw_constraints_changed(runtime);
 	*maskp->bits &= mask;
 	memset(maskp->bits + 1, 0, (SNDRV_MASK_MAX-32) / 8); /* clear rest */
 	if (*maskp->bits == 0)
@@ -1196,6 +1333,7 @@ int snd_pcm_hw_constraint_mask64(struct snd_pcm_runtime *runtime, snd_pcm_hw_par
 {
 	struct snd_pcm_hw_constraints *constrs = &runtime->hw_constraints;
 	struct snd_mask *maskp = constrs_mask(constrs, var);
+	snd_pcm_hw_constraints_changed(runtime);
 	maskp->bits[0] &= (u_int32_t)mask;
 	maskp->bits[1] &= (u_int32_t)(mask >> 32);
 	memset(maskp->bits + 2, 0, (SNDRV_MASK_MAX-64) / 8); /* clear rest */
@@ -1218,6 +1356,7 @@ EXPORT_SYMBOL(snd_pcm_hw_constraint_mask64);
 int snd_pcm_hw_constraint_integer(struct snd_pcm_runtime *runtime, snd_pcm_hw_param_t var)
 {
 	struct snd_pcm_hw_constraints *constrs = &runtime->hw_constraints;
+	snd_pcm_hw_constraints_changed(runtime);
 	return snd_interval_setinteger(constrs_interval(constrs, var));
 }
 EXPORT_SYMBOL(snd_pcm_hw_constraint_integer);
@@ -1243,6 +1382,7 @@ int snd_pcm_hw_constraint_minmax(struct snd_pcm_runtime *runtime, snd_pcm_hw_par
 	t.max = max;
 	t.openmin = t.openmax = 0;
 	t.integer = 0;
+	snd_pcm_hw_constraints_changed(runtime);
 	return snd_interval_refine(constrs_interval(constrs, var), &t);
 }
 EXPORT_SYMBOL(snd_pcm_hw_constraint_minmax);
@@ -1706,9 +1846,7 @@ static int snd_pcm_lib_ioctl_channel_info(struct snd_pcm_substream *substream,
 		info->offset = -1;
 		return 0;
 	}
-	width = snd_pcm_format_physical_width(runtime->format);
-	if (width < 0)
-		return width;
+	width = runtime->sample_bits;
 	info->offset = 0;
 	switch (runtime->access) {
 	case SNDRV_PCM_ACCESS_MMAP_INTERLEAVED:
@@ -1776,28 +1914,14 @@ int snd_pcm_lib_ioctl(struct snd_pcm_substream *substream,
 }
 EXPORT_SYMBOL(snd_pcm_lib_ioctl);
 
-/**
- * snd_pcm_period_elapsed - update the pcm status for the next period
- * @substream: the pcm substream instance
- *
- * This function is called from the interrupt handler when the
- * PCM has processed the period size.  It will update the current
- * pointer, wake up sleepers, etc.
- *
- * Even if more than one periods have elapsed since the last call, you
- * have to call this only once.
- */
-void snd_pcm_period_elapsed(struct snd_pcm_substream *substream)
+/* call with the stream lock held */
+static void __snd_pcm_periods_elapsed(struct snd_pcm_substream *substream,
+				      unsigned int periods)
 {
 	struct snd_pcm_runtime *runtime;
-	unsigned long flags;
-
-	if (snd_BUG_ON(!substream))
-		return;
 
-	snd_pcm_stream_lock_irqsave(substream, flags);
 	if (PCM_RUNTIME_CHECK(substream))
-		goto _unlock;
+		return;
 	runtime = substream->runtime;
 
 	if (!snd_pcm_running(substream) ||
@@ -1806,21 +1930,132 @@ void snd_pcm_period_elapsed(struct snd_pcm_substream *substream)
 
 #ifdef CONFIG_SND_PCM_TIMER
 	if (substream->timer_running)
-		snd_timer_interrupt(substream->timer, 1);
+		snd_timer_interrupt(substream->timer, periods);
 #endif
  _end:
 	kill_fasync(&runtime->fasync, SIGIO, POLL_IN);
- _unlock:
+}
+
+/**
+ * snd_pcm_period_elapsed_under_stream_lock - update the pcm status for the next period
+ * @substream: the pcm substream instance
+ *
+ * This is a variant of snd_pcm_period_elapsed() for drivers which call it
+ * with the stream lock already held, e.g. from their own callbacks.
+ */
+void snd_pcm_period_elapsed_under_stream_lock(struct snd_pcm_substream *substream)
+{
+	if (snd_BUG_ON(!substream))
+		return;
+
+	__snd_pcm_periods_elapsed(substream, 1);
+}
+EXPORT_SYMBOL(snd_pcm_period_elapsed_under_stream_lock);
+
+/**
+ * snd_pcm_periods_elapsed - update the pcm status for several periods
+ * @substream: the pcm substream instance
+ * @periods: the number of periods elapsed since the last call
+ *
+ * This is a variant of snd_pcm_period_elapsed() for drivers which are
+ * notified of several periods at once, e.g. from a work or a completion
+ * covering many packets.  The pointer is updated once and the PCM timer
+ * is advanced by @periods ticks.
+ */
+void snd_pcm_periods_elapsed(struct snd_pcm_substream *substream,
+			     unsigned int periods)
+{
+	unsigned long flags;
+
+	if (snd_BUG_ON(!substream))
+		return;
+	if (!periods)
+		return;
+
+	snd_pcm_stream_lock_irqsave(substream, flags);
+	__snd_pcm_periods_elapsed(substream, periods);
 	snd_pcm_stream_unlock_irqrestore(substream, flags);
 }
+EXPORT_SYMBOL(snd_pcm_periods_elapsed);
+
+/**
+ * snd_pcm_period_elapsed - update the pcm status for the next period
+ * @substream: the pcm substream instance
+ *
+ * This function is called from the interrupt handler when the
+ * PCM has processed the period size.  It will update the current
+ * pointer, wake up sleepers, etc.
+ *
+ * Even if more than one periods have elapsed since the last call, you
+ * have to call this only once.
+ */
+void snd_pcm_period_elapsed(struct snd_pcm_substream *substream)
+{
+	snd_pcm_periods_elapsed(substream, 1);
+}
 EXPORT_SYMBOL(snd_pcm_period_elapsed);
 
+/**
+ * snd_pcm_period_elapsed_batch - update the pcm status of several substreams
+ * @substreams: the array of the pcm substream instances
+ * @count: the number of entries in @substreams
+ *
+ * Does the work of snd_pcm_period_elapsed() for each substream, for the
+ * drivers serving many streams from a single interrupt.  The interrupts
+ * are disabled once for the whole batch of atomic substreams rather than
+ * for each of them.  NULL entries are skipped.
+ */
+void snd_pcm_period_elapsed_batch(struct snd_pcm_substream **substreams,
+				  unsigned int count)
+{
+	struct snd_pcm_substream *substream;
+	unsigned long flags;
+	unsigned int i;
+
+	local_irq_save(flags);
+	for (i = 0; i < count; i++) {
+		substream = substreams[i];
+		if (!substream || substream->pcm->nonatomic)
+			continue;
+		snd_pcm_stream_lock(substream);
+		__snd_pcm_periods_elapsed(substream, 1);
+		snd_pcm_stream_unlock(substream);
+	}
+	local_irq_restore(flags);
+
+	/* the nonatomic ones sleep on their mutex */
+	for (i = 0; i < count; i++) {
+		substream = substreams[i];
+		if (substream && substream->pcm->nonatomic)
+			snd_pcm_periods_elapsed(substream, 1);
+	}
+}
+EXPORT_SYMBOL(snd_pcm_period_elapsed_batch);
+
 /*
  * Wait until avail_min data becomes available
  * Returns a negative error code if any error occurs during operation.
  * The available space is stored on availp.  When err = 0 and avail = 0
  * on the capture stream, it indicates the stream is in DRAINING state.
  */
+/*
+ * Sleep until the frames missing to reach twake are predicted to be
+ * available at the current rate, or until a period interrupt wakes the
+ * waiter up.  Call with the stream unlocked and the task state set.
+ */
+static void wait_for_avail_predicted(struct snd_pcm_runtime *runtime,
+				     snd_pcm_uframes_t avail)
+{
+	ktime_t timeout;
+	u64 ns;
+
+	ns = div_u64((u64)(runtime->twake - avail) * NSEC_PER_SEC,
+		     runtime->rate);
+	timeout = ns_to_ktime(ns);
+	/* waking up a little late is fine, waking up early costs a loop */
+	schedule_hrtimeout_range(&timeout, ns >> 3, HRTIMER_MODE_REL);
+}
+
 static int wait_for_avail(struct snd_pcm_substream *substream,
 			      snd_pcm_uframes_t *availp)
 {
@@ -1828,7 +2063,8 @@ static int wait_for_avail(struct snd_pcm_substream *substream,
 	int is_playback = substream->stream == SNDRV_PCM_STREAM_PLAYBACK;
 	wait_queue_entry_t wait;
 	int err = 0;
-	snd_pcm_uframes_t avail = 0;
+	snd_pcm_uframes_t avail = 0, last_avail = 0;
+	unsigned long stall_start = jiffies;
 	long wait_time, tout;
 
 	init_waitqueue_entry(&wait, current);
@@ -1871,10 +2107,35 @@ static int wait_for_avail(struct snd_pcm_substream *substream,
 			break;
 		snd_pcm_stream_unlock_irq(substream);
 
-		tout = schedule_timeout(wait_time);
+		if (runtime->timer_wakeup && runtime->rate) {
+			wait_for_avail_predicted(runtime, avail);
 
-		snd_pcm_stream_lock_irq(substream);
-		set_current_state(TASK_INTERRUPTIBLE);
+			snd_pcm_stream_lock_irq(substream);
+			set_current_state(TASK_INTERRUPTIBLE);
+			/* no interrupt may have updated the pointer meanwhile */
+			if (snd_pcm_running(substream))
+				snd_pcm_update_hw_ptr(substream);
+
+			/* the DMA is stuck if nothing moved for wait_time */
+			if (snd_pcm_avail(substream) != last_avail) {
+				last_avail = snd_pcm_avail(substream);
+				stall_start = jiffies;
+			}
+			tout = wait_time == MAX_SCHEDULE_TIMEOUT ||
+			       time_before(jiffies, stall_start + wait_time);
+		} else {
+			tout = schedule_timeout(wait_time);
+
+			snd_pcm_stream_lock_irq(substream);
+			set_current_state(TASK_INTERRUPTIBLE);
+			if (substream->stats.wakeup_ns) {
+				snd_pcm_stats_add(substream->stats.wakeup_latency,
+						  div_u64(ktime_get_ns() -
+							  substream->stats.wakeup_ns,
+							  NSEC_PER_USEC));
+				substream->stats.wakeup_ns = 0;
+			}
+		}
 		switch (runtime->status->state) {
 		case SNDRV_PCM_STATE_SUSPENDED:
 			err = -ESTRPIPE;
@@ -1905,6 +2166,7 @@ static int wait_for_avail(struct snd_pcm_substream *substream,
 		}
 	}
  _endloop:
+	substream->stats.wakeup_ns = 0;
 	set_current_state(TASK_RUNNING);
 	remove_wait_queue(&runtime->tsleep, &wait);
 	*availp = avail;
@@ -1946,6 +2208,21 @@ static int default_write_copy_kernel(struct snd_pcm_substream *substream,
 	return 0;
 }
 
+/*
+ * fill samples with silence; the common formats whose silence is a repeated
+ * byte are a plain memset without any format lookup
+ */
+static int snd_pcm_runtime_set_silence(struct snd_pcm_runtime *runtime,
+				       void *data, unsigned int samples)
+{
+	if (runtime->silence_byte >= 0) {
+		memset(data, runtime->silence_byte,
+		       samples * runtime->sample_bits / 8);
+		return 0;
+	}
+	return snd_pcm_format_set_silence(runtime->format, data, samples);
+}
+
 /* fill silence instead of copy data; called as a transfer helper
  * from __snd_pcm_lib_write() or directly from noninterleaved_copy() when
  * a NULL buffer is passed
@@ -1961,9 +2238,9 @@ static int fill_silence(struct snd_pcm_substream *substream, int channel,
 		return substream->ops->fill_silence(substream, channel,
 						    hwoff, bytes);
 
-	snd_pcm_format_set_silence(runtime->format,
-				   get_dma_ptr(runtime, channel, hwoff),
-				   bytes_to_samples(runtime, bytes));
+	snd_pcm_runtime_set_silence(runtime,
+				    get_dma_ptr(runtime, channel, hwoff),
+				    bytes_to_samples(runtime, bytes));
 	return 0;
 }
 
@@ -2045,13 +2322,25 @@ static int noninterleaved_copy(struct snd_pcm_substream *substream,
 static int fill_silence_frames(struct snd_pcm_substream *substream,
 			       snd_pcm_uframes_t off, snd_pcm_uframes_t frames)
 {
-	if (substream->runtime->access == SNDRV_PCM_ACCESS_RW_INTERLEAVED ||
-	    substream->runtime->access == SNDRV_PCM_ACCESS_MMAP_INTERLEAVED)
+	struct snd_pcm_runtime *runtime = substream->runtime;
+
+	if (runtime->access == SNDRV_PCM_ACCESS_RW_INTERLEAVED ||
+	    runtime->access == SNDRV_PCM_ACCESS_MMAP_INTERLEAVED)
 		return interleaved_copy(substream, off, NULL, 0, frames,
 					fill_silence);
-	else
-		return noninterleaved_copy(substream, off, NULL, 0, frames,
-					   fill_silence);
+
+	/*
+	 * The channel areas of a non-interleaved buffer follow each other,
+	 * so silencing the whole buffer is a single fill over all channels.
+	 */
+	if (!off && frames == runtime->buffer_size &&
+	    substream->stream == SNDRV_PCM_STREAM_PLAYBACK &&
+	    !substream->ops->fill_silence)
+		return snd_pcm_runtime_set_silence(runtime, runtime->dma_area,
+						   frames * runtime->channels);
+
+	return noninterleaved_copy(substream, off, NULL, 0, frames,
+				   fill_silence);
 }
 
 /* sanity-check for read/write methods */
@@ -2107,6 +2396,7 @@ int pcm_lib_apply_appl_ptr(struct snd_pcm_substream *substream,
 	}
 
 	trace_applptr(substream, old_appl_ptr, appl_ptr);
+	snd_pcm_update_mmap_timing(substream);
 
 	return 0;
 }
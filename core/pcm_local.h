@@ -23,11 +23,23 @@ void snd_interval_mulkdiv(const struct snd_interval *a, unsigned int k,
 int snd_pcm_hw_constraint_mask(struct snd_pcm_runtime *runtime,
 			       snd_pcm_hw_param_t var, u_int32_t mask);
 
+/* number of hw_params variables which rules can depend on */
+#define SNDRV_PCM_HW_PARAM_NUM	(SNDRV_PCM_HW_PARAM_LAST_INTERVAL + 1)
+
+/* bitmap of the rules depending on the given variable */
+static inline unsigned long *
+constrs_rule_deps(struct snd_pcm_hw_constraints *constrs, int var)
+{
+	return constrs->rule_deps + var * BITS_TO_LONGS(constrs->rules_all);
+}
+
 int pcm_lib_apply_appl_ptr(struct snd_pcm_substream *substream,
 			   snd_pcm_uframes_t appl_ptr);
 int snd_pcm_update_state(struct snd_pcm_substream *substream,
 			 struct snd_pcm_runtime *runtime);
 int snd_pcm_update_hw_ptr(struct snd_pcm_substream *substream);
+void snd_pcm_update_mmap_timing(struct snd_pcm_substream *substream);
+void snd_pcm_stats_add(unsigned int *hist, u64 val);
 
 void snd_pcm_playback_silence(struct snd_pcm_substream *substream,
 			      snd_pcm_uframes_t new_hw_ptr);
@@ -67,6 +79,8 @@ void snd_pcm_group_init(struct snd_pcm_group *group);
 #ifdef CONFIG_SND_DMA_SGBUF
 struct page *snd_pcm_sgbuf_ops_page(struct snd_pcm_substream *substream,
 				    unsigned long offset);
+void snd_pcm_sgbuf_mmap(struct snd_pcm_substream *substream,
+			struct vm_area_struct *area);
 #endif
 
 #define PCM_RUNTIME_CHECK(sub) snd_BUG_ON(!(sub) || !(sub)->runtime)
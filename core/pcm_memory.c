@@ -11,6 +11,7 @@
 #include <linux/moduleparam.h>
 #include <linux/vmalloc.h>
 #include <linux/export.h>
+#include <linux/log2.h>
 #include <dkms/sound/core.h>
 #include <dkms/sound/pcm.h>
 #include <dkms/sound/info.h>
@@ -31,8 +32,101 @@ static unsigned long max_alloc_per_card = 32UL * 1024UL * 1024UL;
 module_param(max_alloc_per_card, ulong, 0644);
 MODULE_PARM_DESC(max_alloc_per_card, "Max total allocation bytes per card.");
 
-static int do_alloc_pages(struct snd_card *card, int type, struct device *dev,
-			  size_t size, struct snd_dma_buffer *dmab)
+static unsigned long max_pool_per_card = 4UL * 1024UL * 1024UL;
+module_param(max_pool_per_card, ulong, 0644);
+MODULE_PARM_DESC(max_pool_per_card, "Max bytes of released buffers kept for reuse per card.");
+
+/*
+ * The buffers released at hw_free are kept in a per-card pool and handed
+ * out again at the next hw_params of any substream of the card using the
+ * same device, instead of going through the page allocator each time.
+ * The allocations are rounded up to power-of-two size classes so that a
+ * released buffer fits the next requests of a similar size; the pool is
+ * bounded by max_pool_per_card and emptied when an allocation fails.
+ */
+struct snd_pcm_pool_buf {
+	struct list_head list;
+	struct snd_dma_buffer *dmab;
+};
+
+static size_t pool_size_class(size_t size)
+{
+	if (!max_pool_per_card)
+		return size;
+	return roundup_pow_of_two(PAGE_ALIGN(size));
+}
+
+/* call with memory_mutex held */
+static void pool_release(struct snd_card *card, struct snd_pcm_pool_buf *buf)
+{
+	list_del(&buf->list);
+	card->total_pcm_alloc_bytes -= buf->dmab->bytes;
+	card->pcm_pool_bytes -= buf->dmab->bytes;
+	snd_dma_free_pages(buf->dmab);
+	kfree(buf->dmab);
+	kfree(buf);
+}
+
+/* release all the buffers of the pool; call with memory_mutex held */
+static void pool_flush(struct snd_card *card)
+{
+	struct snd_pcm_pool_buf *buf, *next;
+
+	list_for_each_entry_safe(buf, next, &card->pcm_pool, list)
+		pool_release(card, buf);
+}
+
+/* take a buffer for @size bytes on @dev out of the pool */
+static struct snd_dma_buffer *pool_get(struct snd_card *card,
+				       const struct snd_dma_device *dev,
+				       size_t size)
+{
+	struct snd_pcm_pool_buf *buf;
+	struct snd_dma_buffer *dmab = NULL;
+	size_t class = pool_size_class(size);
+
+	mutex_lock(&card->memory_mutex);
+	list_for_each_entry(buf, &card->pcm_pool, list) {
+		if (buf->dmab->dev.type != dev->type ||
+		    buf->dmab->dev.dev != dev->dev ||
+		    buf->dmab->bytes < size || buf->dmab->bytes > class)
+			continue;
+		list_del(&buf->list);
+		card->pcm_pool_bytes -= buf->dmab->bytes;
+		dmab = buf->dmab;
+		kfree(buf);
+		break;
+	}
+	mutex_unlock(&card->memory_mutex);
+	return dmab;
+}
+
+/* keep @dmab in the pool; returns false if it has to be released */
+static bool pool_put(struct snd_card *card, struct snd_dma_buffer *dmab)
+{
+	struct snd_pcm_pool_buf *buf;
+
+	if (!max_pool_per_card || dmab->bytes > max_pool_per_card)
+		return false;
+	buf = kmalloc(sizeof(*buf), GFP_KERNEL);
+	if (!buf)
+		return false;
+	buf->dmab = dmab;
+
+	mutex_lock(&card->memory_mutex);
+	/* the oldest buffers are dropped to make room */
+	while (card->pcm_pool_bytes + dmab->bytes > max_pool_per_card)
+		pool_release(card, list_last_entry(&card->pcm_pool,
+						   struct snd_pcm_pool_buf,
+						   list));
+	list_add(&buf->list, &card->pcm_pool);
+	card->pcm_pool_bytes += dmab->bytes;
+	mutex_unlock(&card->memory_mutex);
+	return true;
+}
+
+static int __do_alloc_pages(struct snd_card *card, int type, struct device *dev,
+			    size_t size, struct snd_dma_buffer *dmab)
 {
 	int err;
 
@@ -48,6 +142,22 @@ static int do_alloc_pages(struct snd_card *card, int type, struct device *dev,
 	return err;
 }
 
+static int do_alloc_pages(struct snd_card *card, int type, struct device *dev,
+			  size_t size, struct snd_dma_buffer *dmab)
+{
+	int err;
+
+	err = __do_alloc_pages(card, type, dev, size, dmab);
+	if (err != -ENOMEM || list_empty(&card->pcm_pool))
+		return err;
+
+	/* the pooled buffers are reclaimed before giving up */
+	mutex_lock(&card->memory_mutex);
+	pool_flush(card);
+	mutex_unlock(&card->memory_mutex);
+	return __do_alloc_pages(card, type, dev, size, dmab);
+}
+
 static void do_free_pages(struct snd_card *card, struct snd_dma_buffer *dmab)
 {
 	if (!dmab->area)
@@ -121,6 +231,11 @@ void snd_pcm_lib_preallocate_free_for_all(struct snd_pcm *pcm)
 	for (stream = 0; stream < 2; stream++)
 		for (substream = pcm->streams[stream].substream; substream; substream = substream->next)
 			snd_pcm_lib_preallocate_free(substream);
+
+	/* the pool may hold buffers of the devices going away */
+	mutex_lock(&pcm->card->memory_mutex);
+	pool_flush(pcm->card);
+	mutex_unlock(&pcm->card->memory_mutex);
 }
 EXPORT_SYMBOL(snd_pcm_lib_preallocate_free_for_all);
 
@@ -361,6 +476,31 @@ struct page *snd_pcm_sgbuf_ops_page(struct snd_pcm_substream *substream, unsigne
 		return NULL;
 	return sgbuf->page_table[idx];
 }
+
+/*
+ * snd_pcm_sgbuf_mmap - map the pages of a SG-buffer at mmap time
+ * @substream: the pcm substream instance
+ * @area: the VMA, set up with the fault handler
+ *
+ * Inserts all the pages of the buffer at once rather than taking a fault
+ * for each of them.  The pages which could not be inserted are left to
+ * the fault handler.
+ */
+void snd_pcm_sgbuf_mmap(struct snd_pcm_substream *substream,
+			struct vm_area_struct *area)
+{
+	struct snd_sg_buf *sgbuf = snd_pcm_substream_sgbuf(substream);
+	unsigned long addr = area->vm_start;
+	unsigned int idx;
+
+	for (idx = area->vm_pgoff; idx < sgbuf->pages; idx++) {
+		if (addr >= area->vm_end)
+			break;
+		if (vm_insert_page(area, addr, sgbuf->page_table[idx]))
+			break;
+		addr += PAGE_SIZE;
+	}
+}
 #endif /* CONFIG_SND_DMA_SGBUF */
 
 /**
@@ -401,11 +541,19 @@ int snd_pcm_lib_malloc_pages(struct snd_pcm_substream *substream, size_t size)
 	    substream->dma_buffer.bytes >= size) {
 		dmab = &substream->dma_buffer; /* use the pre-allocated buffer */
 	} else {
+		dmab = pool_get(card, &substream->dma_buffer.dev, size);
+		if (dmab)
+			goto found;
 		dmab = kzalloc(sizeof(*dmab), GFP_KERNEL);
 		if (! dmab)
 			return -ENOMEM;
 		dmab->dev = substream->dma_buffer.dev;
+		/* allocate the whole size class, fall back to the exact size */
 		if (do_alloc_pages(card,
+				   substream->dma_buffer.dev.type,
+				   substream->dma_buffer.dev.dev,
+				   pool_size_class(size), dmab) < 0 &&
+		    do_alloc_pages(card,
 				   substream->dma_buffer.dev.type,
 				   substream->dma_buffer.dev.dev,
 				   size, dmab) < 0) {
@@ -413,6 +561,7 @@ int snd_pcm_lib_malloc_pages(struct snd_pcm_substream *substream, size_t size)
 			return -ENOMEM;
 		}
 	}
+found:
 	snd_pcm_set_runtime_buffer(substream, dmab);
 	runtime->dma_bytes = size;
 	return 1;			/* area was changed */
@@ -438,9 +587,11 @@ int snd_pcm_lib_free_pages(struct snd_pcm_substream *substream)
 	if (runtime->dma_area == NULL)
 		return 0;
 	if (runtime->dma_buffer_p != &substream->dma_buffer) {
-		/* it's a newly allocated buffer.  release it now. */
-		do_free_pages(card, runtime->dma_buffer_p);
-		kfree(runtime->dma_buffer_p);
+		/* it's a newly allocated buffer.  keep it for reuse or release it now. */
+		if (!pool_put(card, runtime->dma_buffer_p)) {
+			do_free_pages(card, runtime->dma_buffer_p);
+			kfree(runtime->dma_buffer_p);
+		}
 	}
 	snd_pcm_set_runtime_buffer(substream, NULL);
 	return 0;
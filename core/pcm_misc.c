@@ -21,6 +21,8 @@
   
 #include <linux/time.h>
 #include <linux/export.h>
+#include <linux/string.h>
+#include <asm/unaligned.h>
 #include <dkms/sound/core.h>
 #include <dkms/sound/pcm.h>
 
@@ -422,6 +424,7 @@ int snd_pcm_format_set_silence(snd_pcm_format_t format, void *data, unsigned int
 	int width;
 	unsigned char *dst;
 	const unsigned char *pat;
+	unsigned int bytes, done, len;
 
 	if (!valid_format(format))
 		return -EINVAL;
@@ -433,47 +436,40 @@ int snd_pcm_format_set_silence(snd_pcm_format_t format, void *data, unsigned int
 		return -EINVAL;
 	/* signed or 1 byte data */
 	if (pcm_formats[(INT)format].signd == 1 || width <= 8) {
-		unsigned int bytes = samples * width / 8;
+		bytes = samples * width / 8;
 		memset(data, *pat, bytes);
 		return 0;
 	}
-	/* non-zero samples, fill using a loop */
+	/* non-zero samples, store the pattern a word at a time if aligned */
 	width /= 8;
 	dst = data;
-#if 0
-	while (samples--) {
-		memcpy(dst, pat, width);
-		dst += width;
-	}
-#else
-	/* a bit optimization for constant width */
 	switch (width) {
 	case 2:
-		while (samples--) {
-			memcpy(dst, pat, 2);
-			dst += 2;
-		}
-		break;
-	case 3:
-		while (samples--) {
-			memcpy(dst, pat, 3);
-			dst += 3;
+		if (IS_ALIGNED((unsigned long)dst, 2)) {
+			memset16(data, get_unaligned((const u16 *)pat), samples);
+			return 0;
 		}
 		break;
 	case 4:
-		while (samples--) {
-			memcpy(dst, pat, 4);
-			dst += 4;
+		if (IS_ALIGNED((unsigned long)dst, 4)) {
+			memset32(data, get_unaligned((const u32 *)pat), samples);
+			return 0;
 		}
 		break;
 	case 8:
-		while (samples--) {
-			memcpy(dst, pat, 8);
-			dst += 8;
+		if (IS_ALIGNED((unsigned long)dst, 8)) {
+			memset64(data, get_unaligned((const u64 *)pat), samples);
+			return 0;
 		}
 		break;
 	}
-#endif
+	/* otherwise, copy the filled part over the rest, doubling it */
+	bytes = samples * width;
+	memcpy(dst, pat, width);
+	for (done = width; done < bytes; done += len) {
+		len = min(done, bytes - done);
+		memcpy(dst + done, dst, len);
+	}
 	return 0;
 }
 EXPORT_SYMBOL(snd_pcm_format_set_silence);
@@ -35,6 +35,10 @@
 #define trace_hw_interval_param_enabled()	0
 #define trace_hw_mask_param(substream, type, index, prev, curr)
 #define trace_hw_interval_param(substream, type, index, prev, curr)
+static inline void trace_pcm_phase(struct snd_pcm_substream *substream,
+				   const char *phase, int ret, ktime_t start)
+{
+}
 #endif
 
 /*
@@ -322,44 +326,46 @@ static int constrain_params_by_rules(struct snd_pcm_substream *substream,
 	struct snd_pcm_hw_constraints *constrs =
 					&substream->runtime->hw_constraints;
 	unsigned int k;
-	unsigned int *rstamps;
-	unsigned int vstamps[SNDRV_PCM_HW_PARAM_LAST_INTERVAL + 1];
-	unsigned int stamp;
+	unsigned long *pending;
 	struct snd_pcm_hw_rule *r;
-	unsigned int d;
 	struct snd_mask old_mask;
 	struct snd_interval old_interval;
-	bool again;
 	int changed, err = 0;
 
+	if (!constrs->rules_num)
+		return 0;
+
 	/*
-	 * Each application of rule has own sequence number.
-	 *
-	 * Each member of 'rstamps' array represents the sequence number of
-	 * recent application of corresponding rule.
+	 * The rules still to be applied.  A rule is applied again only when
+	 * one of the parameters it depends on was changed by another rule
+	 * since its last application, the per-parameter bitmaps of dependent
+	 * rules being built by snd_pcm_hw_rule_add().
 	 */
-	rstamps = kcalloc(constrs->rules_num, sizeof(unsigned int), GFP_KERNEL);
-	if (!rstamps)
+	pending = bitmap_zalloc(constrs->rules_num, GFP_KERNEL);
+	if (!pending)
 		return -ENOMEM;
 
 	/*
-	 * Each member of 'vstamps' array represents the sequence number of
-	 * recent application of rule in which corresponding parameters were
-	 * changed.
-	 *
-	 * In initial state, elements corresponding to parameters requested by
-	 * a caller is 1. For unrequested parameters, corresponding members
-	 * have 0 so that the parameters are never changed anymore.
+	 * In initial state, the rules depending on parameters requested by
+	 * a caller are pending. The rules depending only on unrequested
+	 * parameters are not applied until one of these is changed.
 	 */
-	for (k = 0; k <= SNDRV_PCM_HW_PARAM_LAST_INTERVAL; k++)
-		vstamps[k] = (params->rmask & PARAM_MASK_BIT(k)) ? 1 : 0;
-
-	/* Due to the above design, actual sequence number starts at 2. */
-	stamp = 2;
-retry:
-	/* Apply all rules in order. */
-	again = false;
-	for (k = 0; k < constrs->rules_num; k++) {
+	for (k = 0; k < SNDRV_PCM_HW_PARAM_NUM; k++) {
+		if (params->rmask & PARAM_MASK_BIT(k))
+			bitmap_or(pending, pending,
+				  constrs_rule_deps(constrs, k),
+				  constrs->rules_num);
+	}
+
+	/* Apply the pending rules in order, wrapping around. */
+	k = 0;
+	for (;;) {
+		k = find_next_bit(pending, constrs->rules_num, k);
+		if (k >= constrs->rules_num) {
+			k = find_first_bit(pending, constrs->rules_num);
+			if (k >= constrs->rules_num)
+				break;
+		}
 		r = &constrs->rules[k];
 
 		/*
@@ -368,25 +374,10 @@ retry:
 		 * never processed. SNDRV_PCM_HW_PARAMS_NO_PERIOD_WAKEUP
 		 * is an example of the condition bits.
 		 */
-		if (r->cond && !(r->cond & params->flags))
+		if (r->cond && !(r->cond & params->flags)) {
+			clear_bit(k, pending);
 			continue;
-
-		/*
-		 * The 'deps' array includes maximum three dependencies
-		 * to SNDRV_PCM_HW_PARAM_XXXs for this rule. The fourth
-		 * member of this array is a sentinel and should be
-		 * negative value.
-		 *
-		 * This rule should be processed in this time when dependent
-		 * parameters were changed at former applications of the other
-		 * rules.
-		 */
-		for (d = 0; r->deps[d] >= 0; d++) {
-			if (vstamps[r->deps[d]] > rstamps[k])
-				break;
 		}
-		if (r->deps[d] < 0)
-			continue;
 
 		if (trace_hw_mask_param_enabled()) {
 			if (hw_is_mask(r->var))
@@ -405,8 +396,8 @@ retry:
 
 		/*
 		 * When the parameter is changed, notify it to the caller
-		 * by corresponding returned bit, then preparing for next
-		 * iteration.
+		 * by corresponding returned bit, then schedule the rules
+		 * depending on it.
 		 */
 		if (changed && r->var >= 0) {
 			if (hw_is_mask(r->var)) {
@@ -421,19 +412,17 @@ retry:
 			}
 
 			params->cmask |= PARAM_MASK_BIT(r->var);
-			vstamps[r->var] = stamp;
-			again = true;
+			bitmap_or(pending, pending,
+				  constrs_rule_deps(constrs, r->var),
+				  constrs->rules_num);
 		}
 
-		rstamps[k] = stamp++;
+		/* a rule is not re-run for its own change */
+		clear_bit(k, pending);
 	}
 
-	/* Iterate to evaluate all rules till no parameters are changed. */
-	if (again)
-		goto retry;
-
  out:
-	kfree(rstamps);
+	bitmap_free(pending);
 	return err;
 }
 
@@ -514,16 +503,123 @@ int snd_pcm_hw_refine(struct snd_pcm_substream *substream,
 }
 EXPORT_SYMBOL(snd_pcm_hw_refine);
 
+/*
+ * Clients refine the same parameters over and over while negotiating a
+ * format, and running the rules to a fixpoint is the costly part of the
+ * HW_REFINE ioctl, so the last results are kept per runtime.  An entry is
+ * only valid for the generation of the constraints it was computed with;
+ * the generation of the pcm covers the rules depending on the parameters
+ * of the other substreams.
+ */
+#define SNDRV_PCM_REFINE_CACHE_SIZE	4
+
+struct snd_pcm_hw_refine_entry {
+	bool valid;
+	unsigned int gen;
+	unsigned int pcm_gen;
+	struct snd_pcm_hw_params in;
+	struct snd_pcm_hw_params out;
+};
+
+struct snd_pcm_hw_refine_cache {
+	struct mutex lock;
+	unsigned int next;		/* entry to replace next */
+	struct snd_pcm_hw_refine_entry entries[SNDRV_PCM_REFINE_CACHE_SIZE];
+};
+
+static struct snd_pcm_hw_refine_cache *
+snd_pcm_hw_refine_get_cache(struct snd_pcm_runtime *runtime)
+{
+	struct snd_pcm_hw_refine_cache *cache;
+
+	cache = READ_ONCE(runtime->refine_cache);
+	if (cache)
+		return cache;
+
+	cache = kzalloc(sizeof(*cache), GFP_KERNEL);
+	if (!cache)
+		return NULL;
+	mutex_init(&cache->lock);
+
+	/* concurrent HW_REFINE calls on the same stream */
+	if (cmpxchg(&runtime->refine_cache, NULL, cache)) {
+		kfree(cache);
+		cache = runtime->refine_cache;
+	}
+	return cache;
+}
+
+static bool snd_pcm_hw_refine_lookup(struct snd_pcm_substream *substream,
+				     struct snd_pcm_hw_params *params,
+				     unsigned int gen, unsigned int pcm_gen)
+{
+	struct snd_pcm_hw_refine_cache *cache = substream->runtime->refine_cache;
+	struct snd_pcm_hw_refine_entry *entry;
+	bool found = false;
+	int i;
+
+	if (!cache)
+		return false;
+
+	mutex_lock(&cache->lock);
+	for (i = 0; i < SNDRV_PCM_REFINE_CACHE_SIZE; i++) {
+		entry = &cache->entries[i];
+		if (entry->valid && entry->gen == gen &&
+		    entry->pcm_gen == pcm_gen &&
+		    !memcmp(&entry->in, params, sizeof(*params))) {
+			*params = entry->out;
+			found = true;
+			break;
+		}
+	}
+	mutex_unlock(&cache->lock);
+	return found;
+}
+
+static void snd_pcm_hw_refine_store(struct snd_pcm_substream *substream,
+				    const struct snd_pcm_hw_params *in,
+				    const struct snd_pcm_hw_params *out,
+				    unsigned int gen, unsigned int pcm_gen)
+{
+	struct snd_pcm_hw_refine_cache *cache;
+	struct snd_pcm_hw_refine_entry *entry;
+
+	cache = snd_pcm_hw_refine_get_cache(substream->runtime);
+	if (!cache)
+		return;
+
+	mutex_lock(&cache->lock);
+	entry = &cache->entries[cache->next];
+	cache->next = (cache->next + 1) % SNDRV_PCM_REFINE_CACHE_SIZE;
+	entry->in = *in;
+	entry->out = *out;
+	entry->gen = gen;
+	entry->pcm_gen = pcm_gen;
+	entry->valid = true;
+	mutex_unlock(&cache->lock);
+}
+
 static int snd_pcm_hw_refine_user(struct snd_pcm_substream *substream,
 				  struct snd_pcm_hw_params __user * _params)
 {
-	struct snd_pcm_hw_params *params;
-	int err;
+	struct snd_pcm_runtime *runtime = substream->runtime;
+	struct snd_pcm_hw_params *params, *in = NULL;
+	unsigned int gen, pcm_gen;
+	int err = 0;
 
 	params = memdup_user(_params, sizeof(*params));
 	if (IS_ERR(params))
 		return PTR_ERR(params);
 
+	/* sampled first, a change during the refinement voids the result */
+	gen = READ_ONCE(runtime->hw_constraints.gen);
+	pcm_gen = READ_ONCE(substream->pcm->hw_params_gen);
+	if (snd_pcm_hw_refine_lookup(substream, params, gen, pcm_gen))
+		goto copy;
+
+	/* the result is not cached if the key can't be kept */
+	in = kmemdup(params, sizeof(*params), GFP_KERNEL);
+
 	err = snd_pcm_hw_refine(substream, params);
 	if (err < 0)
 		goto end;
@@ -532,9 +628,13 @@ static int snd_pcm_hw_refine_user(struct snd_pcm_substream *substream,
 	if (err < 0)
 		goto end;
 
+	if (in)
+		snd_pcm_hw_refine_store(substream, in, params, gen, pcm_gen);
+copy:
 	if (copy_to_user(_params, params, sizeof(*params)))
 		err = -EFAULT;
 end:
+	kfree(in);
 	kfree(params);
 	return err;
 }
@@ -648,6 +748,27 @@ static int snd_pcm_hw_params_choose(struct snd_pcm_substream *pcm,
 	return 0;
 }
 
+/* cache the format properties used by the transfer paths */
+static void snd_pcm_cache_format(struct snd_pcm_runtime *runtime)
+{
+	const unsigned char *pat = snd_pcm_format_silence_64(runtime->format);
+	int i, bytes = runtime->sample_bits / 8;
+
+	runtime->format_width = snd_pcm_format_width(runtime->format);
+	runtime->format_signed = snd_pcm_format_signed(runtime->format);
+	runtime->silence_byte = -1;
+	if (!pat)
+		return;
+	if (runtime->format_signed == 1 || bytes <= 1) {
+		runtime->silence_byte = pat[0];
+		return;
+	}
+	for (i = 1; i < bytes; i++)
+		if (pat[i] != pat[0])
+			return;
+	runtime->silence_byte = pat[0];
+}
+
 static int snd_pcm_hw_params(struct snd_pcm_substream *substream,
 			     struct snd_pcm_hw_params *params)
 {
@@ -719,9 +840,14 @@ static int snd_pcm_hw_params(struct snd_pcm_substream *substream,
 	runtime->no_period_wakeup =
 			(params->info & SNDRV_PCM_INFO_NO_PERIOD_WAKEUP) &&
 			(params->flags & SNDRV_PCM_HW_PARAMS_NO_PERIOD_WAKEUP);
+	/* the prediction needs a pointer accurate between periods */
+	runtime->timer_wakeup =
+			(params->flags & SNDRV_PCM_HW_PARAMS_TIMER_WAKEUP) &&
+			!(params->info & SNDRV_PCM_INFO_BATCH);
 
 	bits = snd_pcm_format_physical_width(runtime->format);
 	runtime->sample_bits = bits;
+	snd_pcm_cache_format(runtime);
 	bits *= runtime->channels;
 	runtime->frame_bits = bits;
 	frames = 1;
@@ -750,6 +876,8 @@ static int snd_pcm_hw_params(struct snd_pcm_substream *substream,
 
 	snd_pcm_timer_resolution_change(substream);
 	snd_pcm_set_state(substream, SNDRV_PCM_STATE_SETUP);
+	WRITE_ONCE(substream->pcm->hw_params_gen,
+		   substream->pcm->hw_params_gen + 1);
 
 	if (cpu_latency_qos_request_active(&substream->latency_pm_qos_req))
 		cpu_latency_qos_remove_request(&substream->latency_pm_qos_req);
@@ -824,6 +952,8 @@ static int snd_pcm_hw_free(struct snd_pcm_substream *substream)
 		return -EBADFD;
 	result = do_hw_free(substream);
 	snd_pcm_set_state(substream, SNDRV_PCM_STATE_OPEN);
+	WRITE_ONCE(substream->pcm->hw_params_gen,
+		   substream->pcm->hw_params_gen + 1);
 	cpu_latency_qos_remove_request(&substream->latency_pm_qos_req);
 	return result;
 }
@@ -1135,21 +1265,35 @@ static int snd_pcm_action_group(const struct action_ops *ops,
 	struct snd_pcm_substream *s = NULL;
 	struct snd_pcm_substream *s1;
 	int res = 0, depth = 1;
+	u64 first_ns = 0, last_ns = 0;
 
-	snd_pcm_group_for_each_entry(s, substream) {
-		if (do_lock && s != substream) {
+	/*
+	 * Take all the locks and run all the checks before any trigger, so
+	 * that the hardware triggers below are issued back to back.
+	 */
+	if (do_lock) {
+		snd_pcm_group_for_each_entry(s, substream) {
+			if (s == substream)
+				continue;
 			if (s->pcm->nonatomic)
 				mutex_lock_nested(&s->self_group.mutex, depth);
 			else
 				spin_lock_nested(&s->self_group.lock, depth);
 			depth++;
 		}
+	}
+	snd_pcm_group_for_each_entry(s, substream) {
 		res = ops->pre_action(s, state);
-		if (res < 0)
+		if (res < 0) {
+			s = NULL; /* unlock all */
 			goto _unlock;
+		}
 	}
 	snd_pcm_group_for_each_entry(s, substream) {
 		res = ops->do_action(s, state);
+		last_ns = ktime_get_ns();
+		if (!first_ns)
+			first_ns = last_ns;
 		if (res < 0) {
 			if (ops->undo_action) {
 				snd_pcm_group_for_each_entry(s1, substream) {
@@ -1164,6 +1308,14 @@ static int snd_pcm_action_group(const struct action_ops *ops,
 	}
 	snd_pcm_group_for_each_entry(s, substream) {
 		ops->post_action(s, state);
+		snd_pcm_update_mmap_timing(s);
+		/* skew between the first and the last member started */
+		if (state == SNDRV_PCM_STATE_RUNNING) {
+			s->stats.trigger_skew_ns = last_ns - first_ns;
+			snd_pcm_stats_add(s->stats.trigger_skew,
+					  div_u64(last_ns - first_ns,
+						  NSEC_PER_USEC));
+		}
 	}
  _unlock:
 	if (do_lock) {
@@ -1195,9 +1347,10 @@ static int snd_pcm_action_single(const struct action_ops *ops,
 	if (res < 0)
 		return res;
 	res = ops->do_action(substream, state);
-	if (res == 0)
+	if (res == 0) {
 		ops->post_action(substream, state);
-	else if (ops->undo_action)
+		snd_pcm_update_mmap_timing(substream);
+	} else if (ops->undo_action)
 		ops->undo_action(substream, state);
 	return res;
 }
@@ -1355,6 +1508,8 @@ static void snd_pcm_post_start(struct snd_pcm_substream *substream,
 	runtime->hw_ptr_jiffies = jiffies;
 	runtime->hw_ptr_buffer_jiffies = (runtime->buffer_size * HZ) / 
 							    runtime->rate;
+	/* the first period interval is counted from the start */
+	substream->stats.last_period_ns = ktime_get_ns();
 	runtime->status->state = state;
 	if (substream->stream == SNDRV_PCM_STREAM_PLAYBACK &&
 	    runtime->silence_size > 0)
@@ -2889,22 +3044,73 @@ static snd_pcm_sframes_t snd_pcm_forward(struct snd_pcm_substream *substream,
 	return ret;
 }
 
+/*
+ * Compute the delay from the position published by the last pointer
+ * update without taking the stream lock.  Returns false when the position
+ * is older than the current tick or the stream isn't running; then the
+ * caller has to sync the position under the lock.
+ */
+static bool snd_pcm_delay_lockless(struct snd_pcm_substream *substream,
+				   snd_pcm_sframes_t *delay)
+{
+	struct snd_pcm_runtime *runtime = substream->runtime;
+	struct snd_pcm_hw_ptr_snapshot *snap = &runtime->hw_snapshot;
+	snd_pcm_uframes_t hw_ptr, appl_ptr, avail;
+	snd_pcm_sframes_t extra;
+	snd_pcm_state_t state;
+	unsigned long stamp;
+	unsigned int seq;
+
+	do {
+		seq = read_seqcount_begin(&snap->seq);
+		state = snap->state;
+		hw_ptr = snap->hw_ptr;
+		extra = snap->delay;
+		stamp = snap->jiffies;
+	} while (read_seqcount_retry(&snap->seq, seq));
+
+	if (state != SNDRV_PCM_STATE_RUNNING || stamp != jiffies)
+		return false;
+
+	appl_ptr = READ_ONCE(runtime->control->appl_ptr);
+	if (substream->stream == SNDRV_PCM_STREAM_PLAYBACK)
+		avail = appl_ptr - hw_ptr;
+	else
+		avail = hw_ptr - appl_ptr;
+	if ((snd_pcm_sframes_t)avail < 0)
+		avail += runtime->boundary;
+	/* an xrun in the making, let the locked path report it */
+	if (avail > runtime->buffer_size)
+		return false;
+
+	*delay = avail + extra;
+	return true;
+}
+
 static int snd_pcm_hwsync(struct snd_pcm_substream *substream)
 {
+	snd_pcm_sframes_t delay;
 	int err;
 
+	/* nothing to sync if the position was just updated */
+	if (snd_pcm_delay_lockless(substream, &delay))
+		return 0;
+
 	snd_pcm_stream_lock_irq(substream);
 	err = do_pcm_hwsync(substream);
 	snd_pcm_stream_unlock_irq(substream);
 	return err;
 }
-		
+
 static int snd_pcm_delay(struct snd_pcm_substream *substream,
 			 snd_pcm_sframes_t *delay)
 {
 	int err;
 	snd_pcm_sframes_t n = 0;
 
+	if (snd_pcm_delay_lockless(substream, delay))
+		return 0;
+
 	snd_pcm_stream_lock_irq(substream);
 	err = do_pcm_hwsync(substream);
 	if (!err)
@@ -3161,6 +3367,7 @@ static int snd_pcm_common_ioctl(struct file *file,
 				 unsigned int cmd, void __user *arg)
 {
 	struct snd_pcm_file *pcm_file = file->private_data;
+	ktime_t start;
 	int res;
 
 	if (PCM_RUNTIME_CHECK(substream))
@@ -3187,7 +3394,10 @@ static int snd_pcm_common_ioctl(struct file *file,
 	case SNDRV_PCM_IOCTL_HW_REFINE:
 		return snd_pcm_hw_refine_user(substream, arg);
 	case SNDRV_PCM_IOCTL_HW_PARAMS:
-		return snd_pcm_hw_params_user(substream, arg);
+		start = ktime_get();
+		res = snd_pcm_hw_params_user(substream, arg);
+		trace_pcm_phase(substream, "hw_params", res, start);
+		return res;
 	case SNDRV_PCM_IOCTL_HW_FREE:
 		return snd_pcm_hw_free(substream);
 	case SNDRV_PCM_IOCTL_SW_PARAMS:
@@ -3203,11 +3413,17 @@ static int snd_pcm_common_ioctl(struct file *file,
 	case SNDRV_PCM_IOCTL_CHANNEL_INFO:
 		return snd_pcm_channel_info_user(substream, arg);
 	case SNDRV_PCM_IOCTL_PREPARE:
-		return snd_pcm_prepare(substream, file);
+		start = ktime_get();
+		res = snd_pcm_prepare(substream, file);
+		trace_pcm_phase(substream, "prepare", res, start);
+		return res;
 	case SNDRV_PCM_IOCTL_RESET:
 		return snd_pcm_reset(substream);
 	case SNDRV_PCM_IOCTL_START:
-		return snd_pcm_start_lock_irq(substream);
+		start = ktime_get();
+		res = snd_pcm_start_lock_irq(substream);
+		trace_pcm_phase(substream, "start", res, start);
+		return res;
 	case SNDRV_PCM_IOCTL_LINK:
 		return snd_pcm_link(substream, (int)(unsigned long) arg);
 	case SNDRV_PCM_IOCTL_UNLINK:
@@ -3611,6 +3827,57 @@ static int snd_pcm_mmap_control(struct snd_pcm_substream *substream, struct file
 }
 #endif /* coherent mmap */
 
+/*
+ * The timing record is only written by the kernel, so it is also offered
+ * on the architectures without aliasing data caches where the status and
+ * control records can't be mmapped.
+ */
+#if defined(CONFIG_X86) || defined(CONFIG_PPC) || defined(CONFIG_ALPHA) || \
+	defined(CONFIG_ARM64)
+/*
+ * mmap timing record
+ */
+static vm_fault_t snd_pcm_mmap_timing_fault(struct vm_fault *vmf)
+{
+	struct snd_pcm_substream *substream = vmf->vma->vm_private_data;
+	struct snd_pcm_runtime *runtime;
+
+	if (substream == NULL)
+		return VM_FAULT_SIGBUS;
+	runtime = substream->runtime;
+	vmf->page = virt_to_page(runtime->timing);
+	get_page(vmf->page);
+	return 0;
+}
+
+static const struct vm_operations_struct snd_pcm_vm_ops_timing =
+{
+	.fault =	snd_pcm_mmap_timing_fault,
+};
+
+static int snd_pcm_mmap_timing(struct snd_pcm_substream *substream,
+			       struct file *file, struct vm_area_struct *area)
+{
+	long size;
+	if (!(area->vm_flags & VM_READ) || (area->vm_flags & VM_WRITE))
+		return -EINVAL;
+	size = area->vm_end - area->vm_start;
+	if (size != PAGE_ALIGN(sizeof(struct snd_pcm_mmap_timing)))
+		return -EINVAL;
+	area->vm_ops = &snd_pcm_vm_ops_timing;
+	area->vm_private_data = substream;
+	area->vm_flags |= VM_DONTEXPAND | VM_DONTDUMP;
+	area->vm_flags &= ~VM_MAYWRITE;
+	return 0;
+}
+#else
+static int snd_pcm_mmap_timing(struct snd_pcm_substream *substream,
+			       struct file *file, struct vm_area_struct *area)
+{
+	return -ENXIO;
+}
+#endif
+
 static inline struct page *
 snd_pcm_default_page_ops(struct snd_pcm_substream *substream, unsigned long ofs)
 {
@@ -3705,6 +3972,13 @@ int snd_pcm_lib_default_mmap(struct snd_pcm_substream *substream,
 #endif /* CONFIG_X86 */
 	/* mmap with fault handler */
 	area->vm_ops = &snd_pcm_vm_ops_data_fault;
+#ifdef CONFIG_SND_DMA_SGBUF
+	/* SG-buffers are made of large chunks, map them in one go */
+	if (!substream->ops->page &&
+	    (substream->dma_buffer.dev.type == SNDRV_DMA_TYPE_DEV_SG ||
+	     substream->dma_buffer.dev.type == SNDRV_DMA_TYPE_DEV_UC_SG))
+		snd_pcm_sgbuf_mmap(substream, area);
+#endif /* CONFIG_SND_DMA_SGBUF */
 	return 0;
 }
 EXPORT_SYMBOL_GPL(snd_pcm_lib_default_mmap);
@@ -3809,6 +4083,8 @@ static int snd_pcm_mmap(struct file *file, struct vm_area_struct *area)
 		if (!pcm_control_mmap_allowed(pcm_file))
 			return -ENXIO;
 		return snd_pcm_mmap_control(substream, file, area);
+	case SNDRV_PCM_MMAP_OFFSET_TIMING:
+		return snd_pcm_mmap_timing(substream, file, area);
 	default:
 		return snd_pcm_mmap_data(substream, file, area);
 	}
@@ -3969,6 +4245,8 @@ static unsigned long snd_pcm_get_unmapped_area(struct file *file,
 		return (unsigned long)runtime->status;
 	case SNDRV_PCM_MMAP_OFFSET_CONTROL_NEW:
 		return (unsigned long)runtime->control;
+	case SNDRV_PCM_MMAP_OFFSET_TIMING:
+		return (unsigned long)runtime->timing;
 	default:
 		return (unsigned long)runtime->dma_area + offset;
 	}
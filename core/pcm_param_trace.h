@@ -133,6 +133,38 @@ TRACE_EVENT(hw_interval_param,
 	)
 );
 
+TRACE_EVENT(pcm_phase,
+	TP_PROTO(struct snd_pcm_substream *substream, const char *phase, int ret, ktime_t start),
+	TP_ARGS(substream, phase, ret, start),
+	TP_STRUCT__entry(
+		__field(int, card)
+		__field(int, device)
+		__field(int, subdevice)
+		__field(int, direction)
+		__string(phase, phase)
+		__field(int, ret)
+		__field(u64, latency_us)
+	),
+	TP_fast_assign(
+		__entry->card = substream->pcm->card->number;
+		__entry->device = substream->pcm->device;
+		__entry->subdevice = substream->number;
+		__entry->direction = substream->stream;
+		__assign_str(phase, phase);
+		__entry->ret = ret;
+		__entry->latency_us = ktime_us_delta(ktime_get(), start);
+	),
+	TP_printk("pcmC%dD%d%s:%d %s ret=%d latency=%lluus",
+		  __entry->card,
+		  __entry->device,
+		  __entry->direction ? "c" : "p",
+		  __entry->subdevice,
+		  __get_str(phase),
+		  __entry->ret,
+		  __entry->latency_us
+	)
+);
+
 #endif /* _PCM_PARAMS_TRACE_H */
 
 /* This part must be outside protection */
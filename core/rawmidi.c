@@ -16,6 +16,7 @@
 #include <linux/delay.h>
 #include <linux/mm.h>
 #include <linux/nospec.h>
+#include <linux/vmalloc.h>
 #include <dkms/sound/rawmidi.h>
 #include <dkms/sound/info.h>
 #include <dkms/sound/control.h>
@@ -111,6 +112,75 @@ static inline int snd_rawmidi_ready_append(struct snd_rawmidi_substream *substre
 	       (!substream->append || runtime->avail >= count);
 }
 
+/* the input buffer is vmalloc'ed page-wise so that it can be mmapped */
+static void *snd_rawmidi_alloc_buffer(size_t size, bool is_input)
+{
+	if (is_input)
+		return vmalloc_user(size);
+	return kvzalloc(size, GFP_KERNEL);
+}
+
+/* publish the input position to the mmapped status page */
+static void snd_rawmidi_update_mmap_status(struct snd_rawmidi_runtime *runtime)
+{
+	struct snd_rawmidi_mmap_status *status = runtime->mmap_status;
+
+	if (!status)
+		return;
+	WRITE_ONCE(status->boundary, runtime->boundary);
+	WRITE_ONCE(status->buffer_size, runtime->buffer_size);
+	WRITE_ONCE(status->xruns, runtime->xruns);
+	/* the received data must be visible before the position */
+	smp_wmb();
+	WRITE_ONCE(status->hw_ptr, runtime->mmap_hw_ptr);
+}
+
+/* account the bytes consumed in place through the mmapped buffer */
+static void snd_rawmidi_sync_mmap_appl(struct snd_rawmidi_runtime *runtime)
+{
+	unsigned int appl, count;
+
+	if (!runtime->mmap_control)
+		return;
+	appl = READ_ONCE(runtime->mmap_control->appl_ptr);
+	if (appl >= runtime->boundary)
+		return;
+	count = (appl + runtime->boundary - runtime->mmap_appl_ptr) %
+		runtime->boundary;
+	/* ignore a position beyond the received data */
+	if (!count || count > runtime->avail)
+		return;
+	runtime->mmap_appl_ptr = appl;
+	runtime->appl_ptr = (runtime->appl_ptr + count) % runtime->buffer_size;
+	runtime->avail -= count;
+}
+
+/* account the bytes consumed by read() for the mmap users */
+static void snd_rawmidi_mmap_appl_forward(struct snd_rawmidi_runtime *runtime,
+					  size_t count)
+{
+	runtime->mmap_appl_ptr = (runtime->mmap_appl_ptr + count) %
+		runtime->boundary;
+	if (runtime->mmap_control)
+		WRITE_ONCE(runtime->mmap_control->appl_ptr,
+			   runtime->mmap_appl_ptr);
+}
+
+static void __reset_runtime_ptrs(struct snd_rawmidi_runtime *runtime,
+				 bool is_input)
+{
+	runtime->drain = 0;
+	runtime->appl_ptr = runtime->hw_ptr = 0;
+	runtime->avail = is_input ? 0 : runtime->buffer_size;
+	/* the largest multiple of the buffer size an int position can hold */
+	runtime->boundary = (0x80000000U / runtime->buffer_size) *
+		runtime->buffer_size;
+	runtime->mmap_hw_ptr = runtime->mmap_appl_ptr = 0;
+	if (runtime->mmap_control)
+		WRITE_ONCE(runtime->mmap_control->appl_ptr, 0);
+	snd_rawmidi_update_mmap_status(runtime);
+}
+
 static void snd_rawmidi_input_event_work(struct work_struct *work)
 {
 	struct snd_rawmidi_runtime *runtime =
@@ -134,16 +204,14 @@ static int snd_rawmidi_runtime_create(struct snd_rawmidi_substream *substream)
 	runtime->event = NULL;
 	runtime->buffer_size = PAGE_SIZE;
 	runtime->avail_min = 1;
-	if (substream->stream == SNDRV_RAWMIDI_STREAM_INPUT)
-		runtime->avail = 0;
-	else
-		runtime->avail = runtime->buffer_size;
-	runtime->buffer = kvzalloc(runtime->buffer_size, GFP_KERNEL);
+	runtime->buffer = snd_rawmidi_alloc_buffer(runtime->buffer_size,
+				substream->stream == SNDRV_RAWMIDI_STREAM_INPUT);
 	if (!runtime->buffer) {
 		kfree(runtime);
 		return -ENOMEM;
 	}
-	runtime->appl_ptr = runtime->hw_ptr = 0;
+	__reset_runtime_ptrs(runtime,
+			     substream->stream == SNDRV_RAWMIDI_STREAM_INPUT);
 	substream->runtime = runtime;
 	return 0;
 }
@@ -153,6 +221,8 @@ static int snd_rawmidi_runtime_free(struct snd_rawmidi_substream *substream)
 	struct snd_rawmidi_runtime *runtime = substream->runtime;
 
 	kvfree(runtime->buffer);
+	free_page((unsigned long)runtime->mmap_status);
+	free_page((unsigned long)runtime->mmap_control);
 	kfree(runtime);
 	substream->runtime = NULL;
 	return 0;
@@ -174,14 +244,6 @@ static void snd_rawmidi_input_trigger(struct snd_rawmidi_substream *substream, i
 		cancel_work_sync(&substream->runtime->event_work);
 }
 
-static void __reset_runtime_ptrs(struct snd_rawmidi_runtime *runtime,
-				 bool is_input)
-{
-	runtime->drain = 0;
-	runtime->appl_ptr = runtime->hw_ptr = 0;
-	runtime->avail = is_input ? 0 : runtime->buffer_size;
-}
-
 static void reset_runtime_ptrs(struct snd_rawmidi_runtime *runtime,
 			       bool is_input)
 {
@@ -292,6 +354,8 @@ static int open_substream(struct snd_rawmidi *rmidi,
 		}
 		substream->opened = 1;
 		substream->active_sensing = 0;
+		substream->framing = SNDRV_RAWMIDI_MODE_FRAMING_NONE;
+		substream->clock_type = SNDRV_RAWMIDI_MODE_CLOCK_NONE;
 		if (mode & SNDRV_RAWMIDI_LFLG_APPEND)
 			substream->append = 1;
 		substream->pid = get_pid(task_pid(current));
@@ -665,10 +729,17 @@ static int resize_runtime_buffer(struct snd_rawmidi_runtime *runtime,
 	if (params->avail_min < 1 || params->avail_min > params->buffer_size)
 		return -EINVAL;
 	if (params->buffer_size != runtime->buffer_size) {
-		newbuf = kvzalloc(params->buffer_size, GFP_KERNEL);
+		newbuf = snd_rawmidi_alloc_buffer(params->buffer_size,
+						  is_input);
 		if (!newbuf)
 			return -ENOMEM;
 		spin_lock_irq(&runtime->lock);
+		/* the mapped buffer must stay in place */
+		if (runtime->buffer_mmap_count) {
+			spin_unlock_irq(&runtime->lock);
+			kvfree(newbuf);
+			return -EBUSY;
+		}
 		oldbuf = runtime->buffer;
 		runtime->buffer = newbuf;
 		runtime->buffer_size = params->buffer_size;
@@ -694,8 +765,29 @@ EXPORT_SYMBOL(snd_rawmidi_output_params);
 int snd_rawmidi_input_params(struct snd_rawmidi_substream *substream,
 			     struct snd_rawmidi_params *params)
 {
+	unsigned int framing = params->mode & SNDRV_RAWMIDI_MODE_FRAMING_MASK;
+	unsigned int clock_type = params->mode & SNDRV_RAWMIDI_MODE_CLOCK_MASK;
+	int err;
+
+	if (framing == SNDRV_RAWMIDI_MODE_FRAMING_NONE &&
+	    clock_type != SNDRV_RAWMIDI_MODE_CLOCK_NONE)
+		return -EINVAL;
+	if (clock_type > SNDRV_RAWMIDI_MODE_CLOCK_MONOTONIC_RAW)
+		return -EINVAL;
+	if (framing > SNDRV_RAWMIDI_MODE_FRAMING_TSTAMP)
+		return -EINVAL;
+	/* the frames never wrap around the end of the buffer */
+	if (framing == SNDRV_RAWMIDI_MODE_FRAMING_TSTAMP &&
+	    params->buffer_size % sizeof(struct snd_rawmidi_framing_tstamp))
+		return -EINVAL;
 	snd_rawmidi_drain_input(substream);
-	return resize_runtime_buffer(substream->runtime, params, true);
+	err = resize_runtime_buffer(substream->runtime, params, true);
+	if (err < 0)
+		return err;
+
+	substream->framing = framing;
+	substream->clock_type = clock_type;
+	return 0;
 }
 EXPORT_SYMBOL(snd_rawmidi_input_params);
 
@@ -720,6 +812,7 @@ static int snd_rawmidi_input_status(struct snd_rawmidi_substream *substream,
 	memset(status, 0, sizeof(*status));
 	status->stream = SNDRV_RAWMIDI_STREAM_INPUT;
 	spin_lock_irq(&runtime->lock);
+	snd_rawmidi_sync_mmap_appl(runtime);
 	status->avail = runtime->avail;
 	status->xruns = runtime->xruns;
 	runtime->xruns = 0;
@@ -937,6 +1030,65 @@ static int snd_rawmidi_control_ioctl(struct snd_card *card,
 	return -ENOIOCTLCMD;
 }
 
+static void get_framing_tstamp(struct snd_rawmidi_substream *substream,
+			       struct timespec64 *ts)
+{
+	switch (substream->clock_type) {
+	case SNDRV_RAWMIDI_MODE_CLOCK_MONOTONIC_RAW:
+		ktime_get_raw_ts64(ts);
+		break;
+	case SNDRV_RAWMIDI_MODE_CLOCK_MONOTONIC:
+		ktime_get_ts64(ts);
+		break;
+	default:
+		ktime_get_real_ts64(ts);
+		break;
+	}
+}
+
+/* store the data in frames of the same timestamp; called with the lock */
+static int receive_with_tstamp_framing(struct snd_rawmidi_substream *substream,
+				       const unsigned char *buffer,
+				       int src_count,
+				       const struct timespec64 *tstamp)
+{
+	struct snd_rawmidi_runtime *runtime = substream->runtime;
+	struct snd_rawmidi_framing_tstamp *dest_ptr;
+	struct snd_rawmidi_framing_tstamp frame = {
+		.tv_sec = tstamp->tv_sec,
+		.tv_nsec = tstamp->tv_nsec,
+	};
+	int orig_count = src_count;
+	int frame_size = sizeof(struct snd_rawmidi_framing_tstamp);
+
+	BUILD_BUG_ON(frame_size != 0x20);
+	if (snd_BUG_ON((runtime->hw_ptr & 0x1f) != 0))
+		return -EINVAL;
+
+	while (src_count > 0) {
+		if ((int)(runtime->buffer_size - runtime->avail) < frame_size) {
+			runtime->xruns += src_count;
+			break;
+		}
+		if (src_count >= SNDRV_RAWMIDI_FRAMING_DATA_LENGTH) {
+			frame.length = SNDRV_RAWMIDI_FRAMING_DATA_LENGTH;
+		} else {
+			frame.length = src_count;
+			memset(frame.data, 0, SNDRV_RAWMIDI_FRAMING_DATA_LENGTH);
+		}
+		memcpy(frame.data, buffer, frame.length);
+		buffer += frame.length;
+		src_count -= frame.length;
+		dest_ptr = (struct snd_rawmidi_framing_tstamp *)
+			(runtime->buffer + runtime->hw_ptr);
+		*dest_ptr = frame;
+		runtime->avail += frame_size;
+		runtime->hw_ptr += frame_size;
+		runtime->hw_ptr %= runtime->buffer_size;
+	}
+	return orig_count - src_count;
+}
+
 /**
  * snd_rawmidi_receive - receive the input data from the device
  * @substream: the rawmidi substream
@@ -951,8 +1103,10 @@ int snd_rawmidi_receive(struct snd_rawmidi_substream *substream,
 			const unsigned char *buffer, int count)
 {
 	unsigned long flags;
+	struct timespec64 ts64;
 	int result = 0, count1;
 	struct snd_rawmidi_runtime *runtime = substream->runtime;
+	size_t avail;
 
 	if (!substream->opened)
 		return -EBADFD;
@@ -961,8 +1115,28 @@ int snd_rawmidi_receive(struct snd_rawmidi_substream *substream,
 			  "snd_rawmidi_receive: input is not active!!!\n");
 		return -EINVAL;
 	}
+	if (substream->framing == SNDRV_RAWMIDI_MODE_FRAMING_TSTAMP)
+		get_framing_tstamp(substream, &ts64);
 	spin_lock_irqsave(&runtime->lock, flags);
-	if (count == 1) {	/* special case, faster code */
+	if (runtime->receive &&
+	    substream->framing != SNDRV_RAWMIDI_MODE_FRAMING_TSTAMP) {
+		void (*receive)(struct snd_rawmidi_substream *substream,
+				const unsigned char *buffer, int count);
+
+		/* no copy nor wakeup, the consumer parses the bytes now */
+		receive = runtime->receive;
+		substream->bytes += count;
+		spin_unlock_irqrestore(&runtime->lock, flags);
+		receive(substream, buffer, count);
+		return count;
+	}
+	snd_rawmidi_sync_mmap_appl(runtime);
+	avail = runtime->avail;
+	if (substream->framing == SNDRV_RAWMIDI_MODE_FRAMING_TSTAMP) {
+		substream->bytes += count;
+		result = receive_with_tstamp_framing(substream, buffer, count,
+						     &ts64);
+	} else if (count == 1) {	/* special case, faster code */
 		substream->bytes++;
 		if (runtime->avail < runtime->buffer_size) {
 			runtime->buffer[runtime->hw_ptr++] = buffer[0];
@@ -1000,6 +1174,9 @@ int snd_rawmidi_receive(struct snd_rawmidi_substream *substream,
 			}
 		}
 	}
+	runtime->mmap_hw_ptr = (runtime->mmap_hw_ptr + runtime->avail - avail) %
+		runtime->boundary;
+	snd_rawmidi_update_mmap_status(runtime);
 	if (result > 0) {
 		if (runtime->event)
 			schedule_work(&runtime->event_work);
@@ -1021,6 +1198,7 @@ static long snd_rawmidi_kernel_read1(struct snd_rawmidi_substream *substream,
 	unsigned long appl_ptr;
 
 	spin_lock_irqsave(&runtime->lock, flags);
+	snd_rawmidi_sync_mmap_appl(runtime);
 	while (count > 0 && runtime->avail) {
 		count1 = runtime->buffer_size - runtime->appl_ptr;
 		if (count1 > count)
@@ -1033,6 +1211,7 @@ static long snd_rawmidi_kernel_read1(struct snd_rawmidi_substream *substream,
 		runtime->appl_ptr += count1;
 		runtime->appl_ptr %= runtime->buffer_size;
 		runtime->avail -= count1;
+		snd_rawmidi_mmap_appl_forward(runtime, count1);
 
 		if (kernelbuf)
 			memcpy(kernelbuf + result, runtime->buffer + appl_ptr, count1);
@@ -1077,6 +1256,7 @@ static ssize_t snd_rawmidi_read(struct file *file, char __user *buf, size_t coun
 	result = 0;
 	while (count > 0) {
 		spin_lock_irq(&runtime->lock);
+		snd_rawmidi_sync_mmap_appl(runtime);
 		while (!snd_rawmidi_ready(substream)) {
 			wait_queue_entry_t wait;
 
@@ -1476,8 +1656,12 @@ static __poll_t snd_rawmidi_poll(struct file *file, poll_table *wait)
 	}
 	mask = 0;
 	if (rfile->input != NULL) {
+		runtime = rfile->input->runtime;
+		spin_lock_irq(&runtime->lock);
+		snd_rawmidi_sync_mmap_appl(runtime);
 		if (snd_rawmidi_ready(rfile->input))
 			mask |= EPOLLIN | EPOLLRDNORM;
+		spin_unlock_irq(&runtime->lock);
 	}
 	if (rfile->output != NULL) {
 		if (snd_rawmidi_ready(rfile->output))
@@ -1486,6 +1670,141 @@ static __poll_t snd_rawmidi_poll(struct file *file, poll_table *wait)
 	return mask;
 }
 
+/*
+ * mmap of the input buffer
+ */
+static void snd_rawmidi_vm_open(struct vm_area_struct *area)
+{
+	struct snd_rawmidi_runtime *runtime = area->vm_private_data;
+
+	spin_lock_irq(&runtime->lock);
+	runtime->buffer_mmap_count++;
+	spin_unlock_irq(&runtime->lock);
+}
+
+static void snd_rawmidi_vm_close(struct vm_area_struct *area)
+{
+	struct snd_rawmidi_runtime *runtime = area->vm_private_data;
+
+	spin_lock_irq(&runtime->lock);
+	runtime->buffer_mmap_count--;
+	spin_unlock_irq(&runtime->lock);
+}
+
+static const struct vm_operations_struct snd_rawmidi_vm_ops = {
+	.open =		snd_rawmidi_vm_open,
+	.close =	snd_rawmidi_vm_close,
+};
+
+static int snd_rawmidi_mmap_buffer(struct snd_rawmidi_runtime *runtime,
+				   struct vm_area_struct *area)
+{
+	void *buffer;
+	int err;
+
+	/* the data is only produced by the device */
+	if (area->vm_flags & VM_WRITE)
+		return -EINVAL;
+	area->vm_flags &= ~VM_MAYWRITE;
+	area->vm_flags |= VM_DONTEXPAND | VM_DONTDUMP;
+
+	/* pin the buffer against a resize before mapping it */
+	spin_lock_irq(&runtime->lock);
+	buffer = runtime->buffer;
+	runtime->buffer_mmap_count++;
+	spin_unlock_irq(&runtime->lock);
+
+	err = remap_vmalloc_range(area, buffer, 0);
+	if (err < 0) {
+		spin_lock_irq(&runtime->lock);
+		runtime->buffer_mmap_count--;
+		spin_unlock_irq(&runtime->lock);
+		return err;
+	}
+	area->vm_ops = &snd_rawmidi_vm_ops;
+	area->vm_private_data = runtime;
+	return 0;
+}
+
+static int snd_rawmidi_mmap_status(struct snd_rawmidi_runtime *runtime,
+				   struct vm_area_struct *area)
+{
+	unsigned long page;
+
+	if (area->vm_flags & VM_WRITE)
+		return -EINVAL;
+	if (area->vm_end - area->vm_start != PAGE_SIZE)
+		return -EINVAL;
+	area->vm_flags &= ~VM_MAYWRITE;
+	area->vm_flags |= VM_DONTEXPAND | VM_DONTDUMP;
+
+	page = get_zeroed_page(GFP_KERNEL);
+	if (!page)
+		return -ENOMEM;
+	spin_lock_irq(&runtime->lock);
+	if (!runtime->mmap_status) {
+		runtime->mmap_status = (void *)page;
+		page = 0;
+		snd_rawmidi_update_mmap_status(runtime);
+	}
+	spin_unlock_irq(&runtime->lock);
+	free_page(page);
+
+	return vm_insert_page(area, area->vm_start,
+			      virt_to_page(runtime->mmap_status));
+}
+
+static int snd_rawmidi_mmap_control(struct snd_rawmidi_runtime *runtime,
+				    struct vm_area_struct *area)
+{
+	unsigned long page;
+
+	/* a private copy would never be seen by the kernel */
+	if ((area->vm_flags & VM_WRITE) && !(area->vm_flags & VM_SHARED))
+		return -EINVAL;
+	if (area->vm_end - area->vm_start != PAGE_SIZE)
+		return -EINVAL;
+	area->vm_flags |= VM_DONTEXPAND | VM_DONTDUMP;
+
+	page = get_zeroed_page(GFP_KERNEL);
+	if (!page)
+		return -ENOMEM;
+	spin_lock_irq(&runtime->lock);
+	if (!runtime->mmap_control) {
+		runtime->mmap_control = (void *)page;
+		page = 0;
+		runtime->mmap_control->appl_ptr = runtime->mmap_appl_ptr;
+	}
+	spin_unlock_irq(&runtime->lock);
+	free_page(page);
+
+	return vm_insert_page(area, area->vm_start,
+			      virt_to_page(runtime->mmap_control));
+}
+
+static int snd_rawmidi_mmap(struct file *file, struct vm_area_struct *area)
+{
+	struct snd_rawmidi_file *rfile = file->private_data;
+	struct snd_rawmidi_runtime *runtime;
+	unsigned long offset;
+
+	/* only the input buffer can be consumed in place */
+	if (!rfile->input)
+		return -ENXIO;
+	runtime = rfile->input->runtime;
+
+	offset = area->vm_pgoff << PAGE_SHIFT;
+	switch (offset) {
+	case SNDRV_RAWMIDI_MMAP_OFFSET_DATA:
+		return snd_rawmidi_mmap_buffer(runtime, area);
+	case SNDRV_RAWMIDI_MMAP_OFFSET_STATUS:
+		return snd_rawmidi_mmap_status(runtime, area);
+	case SNDRV_RAWMIDI_MMAP_OFFSET_CONTROL:
+		return snd_rawmidi_mmap_control(runtime, area);
+	}
+	return -ENXIO;
+}
+
 /*
  */
 #ifdef CONFIG_COMPAT
@@ -1570,6 +1889,7 @@ static const struct file_operations snd_rawmidi_f_ops = {
 	.release =	snd_rawmidi_release,
 	.llseek =	no_llseek,
 	.poll =		snd_rawmidi_poll,
+	.mmap =		snd_rawmidi_mmap,
 	.unlocked_ioctl =	snd_rawmidi_ioctl,
 	.compat_ioctl =	snd_rawmidi_ioctl_compat,
 };
@@ -38,6 +38,7 @@ int seq_default_timer_device =
 	;
 int seq_default_timer_subdevice = 0;
 int seq_default_timer_resolution = 0;	/* Hz */
+bool seq_default_timer_tickless;
 
 MODULE_AUTHOR("Frank van de Pol <fvdpol@coil.demon.nl>, Jaroslav Kysela <perex@perex.cz>");
 MODULE_DESCRIPTION("Advanced Linux Sound Architecture sequencer.");
@@ -57,6 +58,8 @@ module_param(seq_default_timer_subdevice, int, 0644);
 MODULE_PARM_DESC(seq_default_timer_subdevice, "The default timer subdevice number.");
 module_param(seq_default_timer_resolution, int, 0644);
 MODULE_PARM_DESC(seq_default_timer_resolution, "The default timer resolution in Hz.");
+module_param(seq_default_timer_tickless, bool, 0644);
+MODULE_PARM_DESC(seq_default_timer_tickless, "Drive the queues by one-shot timers programmed to the next event.");
 
 MODULE_ALIAS_CHARDEV(CONFIG_SND_MAJOR, SNDRV_MINOR_SEQUENCER);
 MODULE_ALIAS("devname:snd/seq");
@@ -73,10 +76,14 @@ static int __init alsa_seq_init(void)
 	if (err < 0)
 		goto error;
 
+	err = snd_seq_ext_buf_init();
+	if (err < 0)
+		goto error;
+
 	/* register sequencer device */
 	err = snd_sequencer_device_init();
 	if (err < 0)
-		goto error;
+		goto error_ext_buf;
 
 	/* register proc interface */
 	err = snd_seq_info_init();
@@ -95,6 +102,8 @@ static int __init alsa_seq_init(void)
 	snd_seq_info_done();
  error_device:
 	snd_sequencer_device_done();
+ error_ext_buf:
+	snd_seq_ext_buf_done();
  error:
 	return err;
 }
@@ -114,6 +123,8 @@ static void __exit alsa_seq_exit(void)
 	snd_sequencer_device_done();
 
 	snd_seq_autoload_exit();
+
+	snd_seq_ext_buf_done();
 }
 
 module_init(alsa_seq_init)
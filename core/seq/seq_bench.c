@@ -0,0 +1,610 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * ALSA sequencer benchmark client
+ */
+
+#include <linux/init.h>
+#include <linux/slab.h>
+#include <linux/module.h>
+#include <linux/ktime.h>
+#include <linux/log2.h>
+#include <linux/wait.h>
+#include <dkms/sound/core.h>
+#include <dkms/sound/info.h>
+#include "seq_clientmgr.h"
+
+/*
+
+  Sequencer benchmark client
+
+  This client measures the event delivery of the sequencer core.  It
+  creates "ports" source ports and "subscribers" sink ports, and each
+  source port is subscribed by all the sink ports.  A run sends
+  "events" events round-robin from the source ports and measures when
+  each copy reaches a sink port.
+
+  A run is started by writing its mode to /proc/asound/seq/bench:
+
+	direct	events are dispatched directly, bypassing the queues
+	tick	events are enqueued with relative tick time-stamps
+	real	events are enqueued with relative real-time time-stamps
+
+  The queued events are spread "interval" microseconds apart.  When
+  "varlen" is non-zero, variable-length events of that many bytes are
+  sent instead of fixed-length ones.  Events which can't be enqueued
+  because the pool is exhausted are counted and dropped, the pool size
+  is given via "pool".
+
+  Reading the same file shows the results of the last run: the event
+  rate and the latency between the time an event was due and the time
+  it was delivered.
+
+ */
+
+
+MODULE_DESCRIPTION("ALSA sequencer benchmark client");
+MODULE_LICENSE("GPL");
+
+static int ports = 1;
+static int subscribers = 1;
+static int pool = SNDRV_SEQ_DEFAULT_EVENTS;
+static int events = 10000;
+static int interval = 100;
+static int varlen;
+
+module_param(ports, int, 0444);
+MODULE_PARM_DESC(ports, "number of source ports");
+module_param(subscribers, int, 0444);
+MODULE_PARM_DESC(subscribers, "number of sink ports subscribed to each source port");
+module_param(pool, int, 0444);
+MODULE_PARM_DESC(pool, "size of the output pool");
+module_param(events, int, 0644);
+MODULE_PARM_DESC(events, "number of events sent per run");
+module_param(interval, int, 0644);
+MODULE_PARM_DESC(interval, "interval between queued events in usec");
+module_param(varlen, int, 0644);
+MODULE_PARM_DESC(varlen, "size of variable-length events, 0 = fixed-length events");
+
+/* queue resolution: 1000000 usec per quarter, 100 usec per tick */
+#define BENCH_TEMPO		1000000
+#define BENCH_TICK_USEC		100
+#define BENCH_PPQ		(BENCH_TEMPO / BENCH_TICK_USEC)
+
+/* latencies are sorted in power-of-two nsec buckets */
+#define BENCH_BUCKETS		40
+
+/* the variable-length payload starts with struct bench_stamp */
+#define BENCH_MIN_VARLEN	sizeof(struct bench_stamp)
+
+enum {
+	BENCH_DIRECT,
+	BENCH_TICK,
+	BENCH_REAL,
+};
+
+static const char * const bench_modes[] = {
+	[BENCH_DIRECT] = "direct",
+	[BENCH_TICK] = "tick",
+	[BENCH_REAL] = "real",
+};
+
+struct bench_stamp {
+	u64 due;		/* ktime in nsec the event is due */
+	u32 run;		/* run the event belongs to */
+} __packed;
+
+/* snd_seq_dump_var_event() context to fetch the stamp */
+struct bench_dump {
+	struct bench_stamp stamp;
+	int copied;
+};
+
+struct bench_result {
+	int mode;
+	int varlen;
+	unsigned int sent;	/* events accepted by the sequencer */
+	unsigned int exhausted;	/* events rejected for lack of cells */
+	unsigned int errors;	/* events rejected otherwise */
+	unsigned int expected;	/* sent times the number of subscribers */
+	unsigned int delivered;
+	unsigned int early;	/* delivered before their due time */
+	u64 start;
+	u64 sent_end;
+	u64 last;
+	u64 max_latency;
+	u64 total_latency;
+	unsigned int buckets[BENCH_BUCKETS];
+};
+
+struct snd_seq_bench {
+	int client;
+	int queue;
+	int *src_ports;
+	struct mutex run_mutex;
+	u32 run;
+	spinlock_t lock;	/* protects result */
+	struct bench_result result;
+	wait_queue_head_t wait;
+	struct snd_info_entry *proc_entry;
+};
+
+static struct snd_seq_bench bench;
+
+/*
+ * record the delivery of an event copy
+ */
+static void bench_account(const struct bench_stamp *stamp)
+{
+	struct bench_result *r = &bench.result;
+	u64 now = ktime_get_ns();
+	u64 latency = 0;
+	unsigned long flags;
+	bool done;
+
+	spin_lock_irqsave(&bench.lock, flags);
+	if (stamp->run != bench.run) {
+		/* left over from an earlier run */
+		spin_unlock_irqrestore(&bench.lock, flags);
+		return;
+	}
+	if (now < stamp->due)
+		r->early++;
+	else
+		latency = now - stamp->due;
+	if (latency > r->max_latency)
+		r->max_latency = latency;
+	r->total_latency += latency;
+	r->buckets[min_t(int, latency ? ilog2(latency) : 0,
+			 BENCH_BUCKETS - 1)]++;
+	r->last = now;
+	done = ++r->delivered >= r->expected;
+	spin_unlock_irqrestore(&bench.lock, flags);
+
+	if (done)
+		wake_up(&bench.wait);
+}
+
+static int bench_copy_stamp(void *ptr, void *buf, int count)
+{
+	struct bench_dump *dump = ptr;
+	int len;
+
+	len = min_t(int, count, sizeof(dump->stamp) - dump->copied);
+	memcpy((char *)&dump->stamp + dump->copied, buf, len);
+	dump->copied += len;
+	return 0;
+}
+
+/*
+ * event input callback of the sink ports
+ */
+static int
+bench_input(struct snd_seq_event *ev, int direct, void *private_data,
+	    int atomic, int hop)
+{
+	struct bench_dump buf;
+
+	if (ev->source.client != bench.client)
+		return 0; /* not ours */
+
+	switch (ev->type) {
+	case SNDRV_SEQ_EVENT_USR0:
+		memcpy(&buf.stamp, &ev->data.raw8, sizeof(buf.stamp));
+		break;
+	case SNDRV_SEQ_EVENT_USR_VAR0:
+		buf.copied = 0;
+		snd_seq_dump_var_event(ev, bench_copy_stamp, &buf);
+		if (buf.copied < sizeof(buf.stamp))
+			return 0;
+		break;
+	default:
+		return 0;
+	}
+
+	bench_account(&buf.stamp);
+	return 0;
+}
+
+/*
+ * send one event from the source port of index idx, due at the nsec
+ * offset delay from now
+ */
+static int bench_send(int mode, int idx, u64 delay, char *data)
+{
+	struct snd_seq_event ev;
+	struct bench_stamp stamp;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.source.port = bench.src_ports[idx];
+	ev.dest.client = SNDRV_SEQ_ADDRESS_SUBSCRIBERS;
+	stamp.run = bench.run;
+
+	switch (mode) {
+	case BENCH_TICK:
+		ev.flags = SNDRV_SEQ_TIME_STAMP_TICK | SNDRV_SEQ_TIME_MODE_REL;
+		ev.queue = bench.queue;
+		ev.time.tick = div_u64(delay, BENCH_TICK_USEC * NSEC_PER_USEC);
+		delay = (u64)ev.time.tick * BENCH_TICK_USEC * NSEC_PER_USEC;
+		break;
+	case BENCH_REAL:
+		ev.flags = SNDRV_SEQ_TIME_STAMP_REAL | SNDRV_SEQ_TIME_MODE_REL;
+		ev.queue = bench.queue;
+		ev.time.time.tv_sec = div_u64_rem(delay, NSEC_PER_SEC,
+						  &ev.time.time.tv_nsec);
+		break;
+	default:
+		ev.queue = SNDRV_SEQ_QUEUE_DIRECT;
+		break;
+	}
+
+	stamp.due = ktime_get_ns() + delay;
+	if (data) {
+		ev.type = SNDRV_SEQ_EVENT_USR_VAR0;
+		ev.flags |= SNDRV_SEQ_EVENT_LENGTH_VARIABLE;
+		ev.data.ext.len = bench.result.varlen;
+		ev.data.ext.ptr = data;
+		/* the data is copied by the sequencer, the buffer is reused */
+		memcpy(data, &stamp, sizeof(stamp));
+	} else {
+		ev.type = SNDRV_SEQ_EVENT_USR0;
+		memcpy(&ev.data.raw8, &stamp, sizeof(stamp));
+	}
+
+	if (mode == BENCH_DIRECT)
+		return snd_seq_kernel_client_dispatch(bench.client, &ev, 0, 0);
+	return snd_seq_kernel_client_enqueue(bench.client, &ev, NULL, false);
+}
+
+static int bench_queue_control(int type)
+{
+	struct snd_seq_event ev;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.type = type;
+	ev.source.port = bench.src_ports[0];
+	ev.dest.client = SNDRV_SEQ_CLIENT_SYSTEM;
+	ev.dest.port = SNDRV_SEQ_PORT_SYSTEM_TIMER;
+	ev.data.queue.queue = bench.queue;
+	return snd_seq_kernel_client_dispatch(bench.client, &ev, 0, 0);
+}
+
+/*
+ * perform a run, called from the proc write callback
+ */
+static int bench_run(int mode)
+{
+	struct bench_result *r = &bench.result;
+	int count = events, len = varlen;
+	u64 step = (u64)max(interval, 0) * NSEC_PER_USEC;
+	unsigned long timeout;
+	char *data = NULL;
+	int i, err;
+
+	if (count < 1)
+		return -EINVAL;
+	if (len) {
+		if (len < BENCH_MIN_VARLEN || len > SNDRV_SEQ_MAX_EVENT_LEN)
+			return -EINVAL;
+		data = kzalloc(len, GFP_KERNEL);
+		if (!data)
+			return -ENOMEM;
+	}
+
+	spin_lock_irq(&bench.lock);
+	bench.run++;
+	memset(r, 0, sizeof(*r));
+	r->mode = mode;
+	r->varlen = len;
+	r->expected = UINT_MAX;
+	spin_unlock_irq(&bench.lock);
+
+	if (mode != BENCH_DIRECT) {
+		err = bench_queue_control(SNDRV_SEQ_EVENT_START);
+		if (err < 0)
+			goto out;
+	}
+
+	r->start = ktime_get_ns();
+	for (i = 0; i < count; i++) {
+		err = bench_send(mode, i % ports, i * step, data);
+		if (err >= 0)
+			r->sent++;
+		else if (err == -EAGAIN || err == -ENOMEM)
+			r->exhausted++;
+		else
+			r->errors++;
+		cond_resched();
+	}
+	r->sent_end = ktime_get_ns();
+
+	spin_lock_irq(&bench.lock);
+	r->expected = r->sent * subscribers;
+	spin_unlock_irq(&bench.lock);
+
+	/* wait for the last due event with one second of slack */
+	timeout = nsecs_to_jiffies(count * step) + HZ;
+	wait_event_interruptible_timeout(bench.wait,
+					 READ_ONCE(r->delivered) >= r->expected,
+					 timeout);
+
+	if (mode != BENCH_DIRECT)
+		bench_queue_control(SNDRV_SEQ_EVENT_STOP);
+	err = 0;
+
+ out:
+	kfree(data);
+	return err;
+}
+
+/* nsec bound below which the given fraction of the deliveries fall */
+static u64 bench_percentile(const struct bench_result *r, int percent)
+{
+	unsigned int target = DIV_ROUND_UP(r->delivered * percent, 100);
+	unsigned int sum = 0;
+	int i;
+
+	for (i = 0; i < BENCH_BUCKETS - 1; i++) {
+		sum += r->buckets[i];
+		if (sum >= target)
+			return min(2ULL << i, r->max_latency);
+	}
+	return r->max_latency;
+}
+
+static void bench_proc_read(struct snd_info_entry *entry,
+			    struct snd_info_buffer *buffer)
+{
+	struct bench_result *r;
+	u64 elapsed;
+
+	r = kmalloc(sizeof(*r), GFP_KERNEL);
+	if (!r)
+		return;
+
+	mutex_lock(&bench.run_mutex);
+	spin_lock_irq(&bench.lock);
+	*r = bench.result;
+	spin_unlock_irq(&bench.lock);
+	mutex_unlock(&bench.run_mutex);
+
+	snd_iprintf(buffer, "ports %d, subscribers %d, pool %d\n",
+		    ports, subscribers, pool);
+	if (!r->start) {
+		snd_iprintf(buffer, "no run yet\n");
+		goto out;
+	}
+
+	snd_iprintf(buffer, "mode %s, %s events\n", bench_modes[r->mode],
+		    r->varlen ? "variable-length" : "fixed-length");
+	if (r->varlen)
+		snd_iprintf(buffer, "event size %d\n", r->varlen);
+	snd_iprintf(buffer, "sent %u, pool exhausted %u, errors %u\n",
+		    r->sent, r->exhausted, r->errors);
+	snd_iprintf(buffer, "delivered %u/%u, early %u\n",
+		    r->delivered, r->expected, r->early);
+
+	elapsed = r->sent_end - r->start;
+	if (elapsed)
+		snd_iprintf(buffer, "send rate %llu events/s\n",
+			    div64_u64((u64)r->sent * NSEC_PER_SEC, elapsed));
+	if (!r->delivered)
+		goto out;
+	elapsed = r->last - r->start;
+	if (elapsed)
+		snd_iprintf(buffer, "delivery rate %llu events/s\n",
+			    div64_u64((u64)r->delivered * NSEC_PER_SEC,
+				      elapsed));
+	snd_iprintf(buffer, "latency avg %llu, p50 %llu, p90 %llu, p99 %llu, max %llu usec\n",
+		    div_u64(div_u64(r->total_latency, r->delivered),
+			    NSEC_PER_USEC),
+		    div_u64(bench_percentile(r, 50), NSEC_PER_USEC),
+		    div_u64(bench_percentile(r, 90), NSEC_PER_USEC),
+		    div_u64(bench_percentile(r, 99), NSEC_PER_USEC),
+		    div_u64(r->max_latency, NSEC_PER_USEC));
+
+ out:
+	kfree(r);
+}
+
+static void bench_proc_write(struct snd_info_entry *entry,
+			     struct snd_info_buffer *buffer)
+{
+	char line[64], str[16];
+	int mode, err;
+
+	while (!snd_info_get_line(buffer, line, sizeof(line))) {
+		snd_info_get_str(str, line, sizeof(str));
+		for (mode = 0; mode < ARRAY_SIZE(bench_modes); mode++)
+			if (!strcmp(str, bench_modes[mode]))
+				break;
+		if (mode >= ARRAY_SIZE(bench_modes)) {
+			pr_err("ALSA: seq_bench: invalid mode '%s'\n", str);
+			continue;
+		}
+
+		mutex_lock(&bench.run_mutex);
+		err = bench_run(mode);
+		mutex_unlock(&bench.run_mutex);
+		if (err < 0)
+			pr_err("ALSA: seq_bench: %s run failed (%d)\n",
+			       bench_modes[mode], err);
+	}
+}
+
+/*
+ * create a port, sink ports get the event input callback
+ */
+static int __init create_port(int idx, bool sink)
+{
+	struct snd_seq_port_info pinfo;
+	struct snd_seq_port_callback pcb;
+
+	memset(&pinfo, 0, sizeof(pinfo));
+	pinfo.addr.client = bench.client;
+	pinfo.type = SNDRV_SEQ_PORT_TYPE_SOFTWARE;
+	if (sink) {
+		sprintf(pinfo.name, "Benchmark Sink-%d", idx);
+		pinfo.capability = SNDRV_SEQ_PORT_CAP_WRITE |
+			SNDRV_SEQ_PORT_CAP_SUBS_WRITE;
+		memset(&pcb, 0, sizeof(pcb));
+		pcb.owner = THIS_MODULE;
+		pcb.event_input = bench_input;
+		pinfo.kernel = &pcb;
+	} else {
+		sprintf(pinfo.name, "Benchmark Source-%d", idx);
+		pinfo.capability = SNDRV_SEQ_PORT_CAP_READ |
+			SNDRV_SEQ_PORT_CAP_SUBS_READ;
+	}
+	if (snd_seq_kernel_client_ctl(bench.client, SNDRV_SEQ_IOCTL_CREATE_PORT,
+				      &pinfo) < 0)
+		return -ENOMEM;
+	return pinfo.addr.port;
+}
+
+static int __init setup_client(void)
+{
+	struct snd_seq_client_pool pinfo;
+	struct snd_seq_queue_info qinfo;
+	struct snd_seq_queue_tempo tempo;
+	struct snd_seq_port_subscribe subs;
+	int i, j, port, err;
+
+	memset(&pinfo, 0, sizeof(pinfo));
+	pinfo.client = bench.client;
+	pinfo.output_pool = pool;
+	err = snd_seq_kernel_client_ctl(bench.client,
+					SNDRV_SEQ_IOCTL_SET_CLIENT_POOL, &pinfo);
+	if (err < 0)
+		return err;
+
+	memset(&qinfo, 0, sizeof(qinfo));
+	qinfo.owner = bench.client;
+	qinfo.locked = 1;
+	strcpy(qinfo.name, "Sequencer Benchmark");
+	err = snd_seq_kernel_client_ctl(bench.client,
+					SNDRV_SEQ_IOCTL_CREATE_QUEUE, &qinfo);
+	if (err < 0)
+		return err;
+	bench.queue = qinfo.queue;
+
+	memset(&tempo, 0, sizeof(tempo));
+	tempo.queue = bench.queue;
+	tempo.tempo = BENCH_TEMPO;
+	tempo.ppq = BENCH_PPQ;
+	err = snd_seq_set_queue_tempo(bench.client, &tempo);
+	if (err < 0)
+		return err;
+
+	for (i = 0; i < ports; i++) {
+		port = create_port(i, false);
+		if (port < 0)
+			return port;
+		bench.src_ports[i] = port;
+	}
+
+	memset(&subs, 0, sizeof(subs));
+	subs.sender.client = bench.client;
+	subs.dest.client = bench.client;
+	for (j = 0; j < subscribers; j++) {
+		port = create_port(j, true);
+		if (port < 0)
+			return port;
+		subs.dest.port = port;
+		for (i = 0; i < ports; i++) {
+			subs.sender.port = bench.src_ports[i];
+			err = snd_seq_kernel_client_ctl(bench.client,
+							SNDRV_SEQ_IOCTL_SUBSCRIBE_PORT,
+							&subs);
+			if (err < 0)
+				return err;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * register client, ports and proc entry
+ */
+static int __init
+register_client(void)
+{
+	struct snd_info_entry *entry;
+	int err;
+
+	if (ports < 1 || subscribers < 1) {
+		pr_err("ALSA: seq_bench: invalid number of ports %d/%d\n",
+		       ports, subscribers);
+		return -EINVAL;
+	}
+
+	mutex_init(&bench.run_mutex);
+	spin_lock_init(&bench.lock);
+	init_waitqueue_head(&bench.wait);
+
+	bench.src_ports = kcalloc(ports, sizeof(int), GFP_KERNEL);
+	if (!bench.src_ports)
+		return -ENOMEM;
+
+	bench.client = snd_seq_create_kernel_client(NULL, -1,
+						    "Sequencer Benchmark");
+	if (bench.client < 0) {
+		err = bench.client;
+		goto error;
+	}
+
+	err = setup_client();
+	if (err < 0)
+		goto error_client;
+
+	entry = snd_info_create_module_entry(THIS_MODULE, "bench",
+					     snd_seq_root);
+	if (!entry) {
+		err = -ENOMEM;
+		goto error_client;
+	}
+	entry->content = SNDRV_INFO_CONTENT_TEXT;
+	entry->mode = S_IFREG | 0644;
+	entry->c.text.read = bench_proc_read;
+	entry->c.text.write = bench_proc_write;
+	err = snd_info_register(entry);
+	if (err < 0) {
+		snd_info_free_entry(entry);
+		goto error_client;
+	}
+	bench.proc_entry = entry;
+
+	return 0;
+
+ error_client:
+	/* deleting the client also deletes its queue */
+	snd_seq_delete_kernel_client(bench.client);
+ error:
+	kfree(bench.src_ports);
+	return err;
+}
+
+static void __exit
+delete_client(void)
+{
+	snd_info_free_entry(bench.proc_entry);
+	snd_seq_delete_kernel_client(bench.client);
+	kfree(bench.src_ports);
+}
+
+/*
+ *  Init part
+ */
+
+static int __init alsa_seq_bench_init(void)
+{
+	return register_client();
+}
+
+static void __exit alsa_seq_bench_exit(void)
+{
+	delete_client();
+}
+
+module_init(alsa_seq_bench_init)
+module_exit(alsa_seq_bench_exit)
@@ -405,7 +405,7 @@ static ssize_t snd_seq_read(struct file *file, char __user *buf, size_t count,
 	struct snd_seq_fifo *fifo;
 	int err;
 	long result = 0;
-	struct snd_seq_event_cell *cell;
+	struct snd_seq_event_cell *cell, *next;
 
 	if (!(snd_seq_file_flags(file) & SNDRV_SEQ_LFLG_INPUT))
 		return -ENXIO;
@@ -433,11 +433,19 @@ static ssize_t snd_seq_read(struct file *file, char __user *buf, size_t count,
 
 	/* while data available in queue */
 	while (count >= sizeof(struct snd_seq_event)) {
-		int nonblock;
+		int nonblock, max;
 
-		nonblock = (file->f_flags & O_NONBLOCK) || result > 0;
-		if ((err = snd_seq_fifo_cell_out(fifo, &cell, nonblock)) < 0) {
-			break;
+		/*
+		 * take as many cells as may fit in the buffer at once, the
+		 * ones left over are put back below
+		 */
+		if (!cell) {
+			nonblock = (file->f_flags & O_NONBLOCK) || result > 0;
+			max = min_t(size_t, count / sizeof(struct snd_seq_event),
+				    INT_MAX);
+			err = snd_seq_fifo_cells_out(fifo, &cell, max, nonblock);
+			if (err < 0)
+				break;
 		}
 		if (snd_seq_ev_is_variable(&cell->event)) {
 			struct snd_seq_event tmpev;
@@ -465,17 +473,16 @@ static ssize_t snd_seq_read(struct file *file, char __user *buf, size_t count,
 			count -= sizeof(struct snd_seq_event);
 			buf += sizeof(struct snd_seq_event);
 		}
+		next = cell->next;
 		snd_seq_cell_free(cell);
-		cell = NULL; /* to be sure */
+		cell = next;
 		result += sizeof(struct snd_seq_event);
 	}
 
-	if (err < 0) {
-		if (cell)
-			snd_seq_fifo_cell_putback(fifo, cell);
-		if (err == -EAGAIN && result > 0)
-			err = 0;
-	}
+	if (cell)
+		snd_seq_fifo_cell_putback(fifo, cell);
+	if (err == -EAGAIN && result > 0)
+		err = 0;
 	snd_seq_fifo_unlock(fifo);
 
 	return (err < 0) ? err : result;
@@ -676,12 +683,15 @@ static int deliver_to_subscribers(struct snd_seq_client *client,
 	event_saved = *event;
 	grp = &src_port->c_src;
 	
-	/* lock list */
+	/*
+	 * the atomic delivery can't sleep and walks the list under RCU,
+	 * otherwise the delivery may block and the list is locked
+	 */
 	if (atomic)
-		read_lock(&grp->list_lock);
+		rcu_read_lock();
 	else
 		down_read_nested(&grp->list_mutex, hop);
-	list_for_each_entry(subs, &grp->list_head, src_list) {
+	list_for_each_entry_rcu(subs, &grp->list_head, src_list) {
 		/* both ports ready? */
 		if (atomic_read(&subs->ref_count) != 2)
 			continue;
@@ -703,7 +713,7 @@ static int deliver_to_subscribers(struct snd_seq_client *client,
 		*event = event_saved;
 	}
 	if (atomic)
-		read_unlock(&grp->list_lock);
+		rcu_read_unlock();
 	else
 		up_read(&grp->list_mutex);
 	*event = event_saved; /* restore */
@@ -1005,6 +1015,37 @@ static int check_event_type_and_length(struct snd_seq_event *ev)
 }
 
 
+/* read-ahead of the event headers passed to write() */
+#define SEQ_WRITE_BATCH		8
+
+struct seq_write_batch {
+	const char __user *start;
+	size_t len;
+	struct snd_seq_event events[SEQ_WRITE_BATCH];
+};
+
+/*
+ * copy the event header at buf, reading ahead up to SEQ_WRITE_BATCH
+ * events with a single copy from the user space
+ */
+static int seq_write_fetch(struct seq_write_batch *b, const char __user *buf,
+			   size_t count, struct snd_seq_event *event)
+{
+	if (!b->start || buf < b->start ||
+	    buf + sizeof(*event) > b->start + b->len) {
+		b->len = min(count, sizeof(b->events));
+		if (copy_from_user(b->events, buf, b->len)) {
+			b->start = NULL;
+			return -EFAULT;
+		}
+		b->start = buf;
+	}
+
+	memcpy(event, (const char *)b->events + (buf - b->start),
+	       sizeof(*event));
+	return 0;
+}
+
 /* handle write() */
 /* possible error values:
  *	-ENXIO	invalid client or file open mode
@@ -1023,6 +1064,7 @@ static ssize_t snd_seq_write(struct file *file, const char __user *buf,
 	int written = 0, len;
 	int err, handled;
 	struct snd_seq_event event;
+	struct seq_write_batch batch = { .start = NULL };
 
 	if (!(snd_seq_file_flags(file) & SNDRV_SEQ_LFLG_OUTPUT))
 		return -ENXIO;
@@ -1049,10 +1091,9 @@ static ssize_t snd_seq_write(struct file *file, const char __user *buf,
 	while (count >= sizeof(struct snd_seq_event)) {
 		/* Read in the event header from the user */
 		len = sizeof(event);
-		if (copy_from_user(&event, buf, len)) {
-			err = -EFAULT;
+		err = seq_write_fetch(&batch, buf, count, &event);
+		if (err < 0)
 			break;
-		}
 		event.source.client = client->number;	/* fill in client number */
 		/* Check for extension data length */
 		if (check_event_type_and_length(&event)) {
@@ -1770,6 +1811,8 @@ static int snd_seq_ioctl_set_queue_timer(struct snd_seq_client *client,
 		if (tmr->type == SNDRV_SEQ_TIMER_ALSA) {
 			tmr->alsa_id = timer->u.alsa.id;
 			tmr->preferred_resolution = timer->u.alsa.resolution;
+			/* an explicitly chosen timer drives the queue */
+			tmr->tickless = 0;
 		}
 		result = snd_seq_queue_timer_open(timer->queue);
 		mutex_unlock(&q->timer_mutex);
@@ -41,7 +41,8 @@ struct snd_seq_fifo *snd_seq_fifo_new(int poolsize)
 
 	f->head = NULL;
 	f->tail = NULL;
-	f->cells = 0;
+	init_llist_head(&f->incoming);
+	atomic_set(&f->cells, 0);
 	
 	return f;
 }
@@ -102,7 +103,6 @@ int snd_seq_fifo_event_in(struct snd_seq_fifo *f,
 			  struct snd_seq_event *event)
 {
 	struct snd_seq_event_cell *cell;
-	unsigned long flags;
 	int err;
 
 	if (snd_BUG_ON(!f))
@@ -117,18 +117,14 @@ int snd_seq_fifo_event_in(struct snd_seq_fifo *f,
 		return err;
 	}
 		
-	/* append new cells to fifo */
-	spin_lock_irqsave(&f->lock, flags);
-	if (f->tail != NULL)
-		f->tail->next = cell;
-	f->tail = cell;
-	if (f->head == NULL)
-		f->head = cell;
-	cell->next = NULL;
-	f->cells++;
-	spin_unlock_irqrestore(&f->lock, flags);
-
-	/* wakeup client */
+	/*
+	 * push the new cell without taking the lock the reader may hold;
+	 * the reader moves the pushed cells to the fifo in order
+	 */
+	atomic_inc(&f->cells);
+	llist_add(&cell->fifo_node, &f->incoming);
+
+	/* wakeup client; llist_add() implies the barrier for the check */
 	if (waitqueue_active(&f->input_sleep))
 		wake_up(&f->input_sleep);
 
@@ -138,11 +134,36 @@ int snd_seq_fifo_event_in(struct snd_seq_fifo *f,
 
 }
 
+/* move the cells pushed by the producers to the fifo tail - f->lock held */
+static void fifo_collect(struct snd_seq_fifo *f)
+{
+	struct llist_node *node;
+	struct snd_seq_event_cell *cell;
+
+	if (llist_empty(&f->incoming))
+		return;
+
+	/* the producers push on a stack, restore the arrival order */
+	node = llist_reverse_order(llist_del_all(&f->incoming));
+	for (; node; node = node->next) {
+		cell = llist_entry(node, struct snd_seq_event_cell, fifo_node);
+		cell->next = NULL;
+		if (f->tail)
+			f->tail->next = cell;
+		else
+			f->head = cell;
+		f->tail = cell;
+	}
+}
+
 /* dequeue cell from fifo */
 static struct snd_seq_event_cell *fifo_cell_out(struct snd_seq_fifo *f)
 {
 	struct snd_seq_event_cell *cell;
 
+	if (!f->head)
+		fifo_collect(f);
+
 	if ((cell = f->head) != NULL) {
 		f->head = cell->next;
 
@@ -151,34 +172,49 @@ static struct snd_seq_event_cell *fifo_cell_out(struct snd_seq_fifo *f)
 			f->tail = NULL;
 
 		cell->next = NULL;
-		f->cells--;
+		atomic_dec(&f->cells);
 	}
 
 	return cell;
 }
 
-/* dequeue cell from fifo and copy on user space */
-int snd_seq_fifo_cell_out(struct snd_seq_fifo *f,
-			  struct snd_seq_event_cell **cellp, int nonblock)
+/*
+ * dequeue up to max cells from fifo at once, linked through their next
+ * pointer; wait for the first one unless nonblock is set
+ */
+int snd_seq_fifo_cells_out(struct snd_seq_fifo *f,
+			   struct snd_seq_event_cell **cellp, int max,
+			   int nonblock)
 {
-	struct snd_seq_event_cell *cell;
+	struct snd_seq_event_cell *cell, *tail;
 	unsigned long flags;
 	wait_queue_entry_t wait;
+	int n;
 
-	if (snd_BUG_ON(!f))
+	if (snd_BUG_ON(!f || max <= 0))
 		return -EINVAL;
 
 	*cellp = NULL;
 	init_waitqueue_entry(&wait, current);
 	spin_lock_irqsave(&f->lock, flags);
-	while ((cell = fifo_cell_out(f)) == NULL) {
+	for (;;) {
+		fifo_collect(f);
+		cell = f->head;
+		if (cell)
+			break;
 		if (nonblock) {
 			/* non-blocking - return immediately */
 			spin_unlock_irqrestore(&f->lock, flags);
 			return -EAGAIN;
 		}
-		set_current_state(TASK_INTERRUPTIBLE);
 		add_wait_queue(&f->input_sleep, &wait);
+		set_current_state(TASK_INTERRUPTIBLE);
+		/* the producers don't take the lock, check again once queued */
+		if (!llist_empty(&f->incoming)) {
+			__set_current_state(TASK_RUNNING);
+			remove_wait_queue(&f->input_sleep, &wait);
+			continue;
+		}
 		spin_unlock_irqrestore(&f->lock, flags);
 		schedule();
 		spin_lock_irqsave(&f->lock, flags);
@@ -188,25 +224,46 @@ int snd_seq_fifo_cell_out(struct snd_seq_fifo *f,
 			return -ERESTARTSYS;
 		}
 	}
+
+	/* detach the first cells in one go */
+	tail = cell;
+	for (n = 1; n < max && tail->next; n++)
+		tail = tail->next;
+	f->head = tail->next;
+	if (!f->head)
+		f->tail = NULL;
+	tail->next = NULL;
+	atomic_sub(n, &f->cells);
 	spin_unlock_irqrestore(&f->lock, flags);
 	*cellp = cell;
 
 	return 0;
 }
 
+/* dequeue cell from fifo and copy on user space */
+int snd_seq_fifo_cell_out(struct snd_seq_fifo *f,
+			  struct snd_seq_event_cell **cellp, int nonblock)
+{
+	return snd_seq_fifo_cells_out(f, cellp, 1, nonblock);
+}
+
 
 void snd_seq_fifo_cell_putback(struct snd_seq_fifo *f,
 			       struct snd_seq_event_cell *cell)
 {
+	struct snd_seq_event_cell *tail;
 	unsigned long flags;
+	int n;
 
 	if (cell) {
+		for (n = 1, tail = cell; tail->next; n++)
+			tail = tail->next;
 		spin_lock_irqsave(&f->lock, flags);
-		cell->next = f->head;
+		tail->next = f->head;
 		f->head = cell;
 		if (!f->tail)
-			f->tail = cell;
-		f->cells++;
+			f->tail = tail;
+		atomic_add(n, &f->cells);
 		spin_unlock_irqrestore(&f->lock, flags);
 	}
 }
@@ -217,7 +274,7 @@ int snd_seq_fifo_poll_wait(struct snd_seq_fifo *f, struct file *file,
 			   poll_table *wait)
 {
 	poll_wait(file, &f->input_sleep, wait);
-	return (f->cells > 0);
+	return atomic_read(&f->cells) > 0;
 }
 
 /* change the size of pool; all old events are removed */
@@ -241,12 +298,13 @@ int snd_seq_fifo_resize(struct snd_seq_fifo *f, int poolsize)
 	spin_lock_irq(&f->lock);
 	/* remember old pool */
 	oldpool = f->pool;
+	fifo_collect(f);
 	oldhead = f->head;
 	/* exchange pools */
 	f->pool = newpool;
 	f->head = NULL;
 	f->tail = NULL;
-	f->cells = 0;
+	atomic_set(&f->cells, 0);
 	/* NOTE: overflow flag is not cleared */
 	spin_unlock_irq(&f->lock);
 
@@ -16,8 +16,9 @@ struct snd_seq_fifo {
 	struct snd_seq_pool *pool;		/* FIFO pool */
 	struct snd_seq_event_cell *head;    	/* pointer to head of fifo */
 	struct snd_seq_event_cell *tail;    	/* pointer to tail of fifo */
-	int cells;
-	spinlock_t lock;
+	struct llist_head incoming;		/* cells pushed by the producers */
+	atomic_t cells;
+	spinlock_t lock;			/* protects head and tail */
 	snd_use_lock_t use_lock;
 	wait_queue_head_t input_sleep;
 	atomic_t overflow;
@@ -41,7 +42,11 @@ int snd_seq_fifo_event_in(struct snd_seq_fifo *f, struct snd_seq_event *event);
 /* get a cell from fifo - fifo should be locked */
 int snd_seq_fifo_cell_out(struct snd_seq_fifo *f, struct snd_seq_event_cell **cellp, int nonblock);
 
-/* free dequeued cell - fifo should be locked */
+/* get a chain of up to max cells from fifo - fifo should be locked */
+int snd_seq_fifo_cells_out(struct snd_seq_fifo *f, struct snd_seq_event_cell **cellp,
+			   int max, int nonblock);
+
+/* put back a dequeued cell or chain of cells - fifo should be locked */
 void snd_seq_fifo_cell_putback(struct snd_seq_fifo *f, struct snd_seq_event_cell *cell);
 
 /* clean up queue */
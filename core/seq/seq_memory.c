@@ -11,6 +11,7 @@
 #include <linux/slab.h>
 #include <linux/sched/signal.h>
 #include <linux/mm.h>
+#include <linux/refcount.h>
 #include <dkms/sound/core.h>
 
 #include <dkms/sound/seq_kernel.h>
@@ -32,7 +33,7 @@ static inline int snd_seq_output_ok(struct snd_seq_pool *pool)
 /*
  * Variable length event:
  * The event like sysex uses variable length type.
- * The external data may be stored in three different formats.
+ * The external data may be stored in four different formats.
  * 1) kernel space
  *    This is the normal case.
  *      ext.data.len = length
@@ -48,8 +49,99 @@ static inline int snd_seq_output_ok(struct snd_seq_pool *pool)
  *      ext.data.len = length | SNDRV_SEQ_EXT_CHAINED
  *      ext.data.ptr = the additiona cell head
  *         -> cell.next -> cell.next -> ..
+ * 4) shared buffer
+ *    Otherwise an enqueued event keeps the data in one contiguous,
+ *    refcounted buffer, so that the copies delivered to several
+ *    subscribers all point to the same data.  The pools are still
+ *    charged for the cells the data would take.
+ *      ext.data.len = length | SNDRV_SEQ_EXT_SHARED
+ *      ext.data.ptr = snd_seq_ext_buf.data
  */
 
+struct snd_seq_ext_buf {
+	refcount_t refcount;
+	int size_class;		/* index in ext_buf_caches, -1 if kmalloc'ed */
+	char data[];
+};
+
+/* data sizes of the buffer caches */
+static const unsigned int ext_buf_sizes[] = { 256, 1024, 4096, 16384 };
+static struct kmem_cache *ext_buf_caches[ARRAY_SIZE(ext_buf_sizes)];
+
+static struct snd_seq_ext_buf *snd_seq_ext_buf_alloc(int len, gfp_t gfp)
+{
+	struct snd_seq_ext_buf *buf;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(ext_buf_sizes); i++) {
+		if (len <= ext_buf_sizes[i] && ext_buf_caches[i])
+			break;
+	}
+
+	if (i < ARRAY_SIZE(ext_buf_sizes)) {
+		buf = kmem_cache_alloc(ext_buf_caches[i], gfp);
+	} else {
+		buf = kmalloc(struct_size(buf, data, len), gfp);
+		i = -1;
+	}
+	if (!buf)
+		return NULL;
+
+	refcount_set(&buf->refcount, 1);
+	buf->size_class = i;
+	return buf;
+}
+
+static inline struct snd_seq_ext_buf *
+snd_seq_ext_buf_of(const struct snd_seq_event *event)
+{
+	return container_of((char *)event->data.ext.ptr,
+			    struct snd_seq_ext_buf, data[0]);
+}
+
+static void snd_seq_ext_buf_put(struct snd_seq_ext_buf *buf)
+{
+	if (!refcount_dec_and_test(&buf->refcount))
+		return;
+
+	if (buf->size_class < 0)
+		kfree(buf);
+	else
+		kmem_cache_free(ext_buf_caches[buf->size_class], buf);
+}
+
+/* number of cells the data of a variable length event takes */
+static inline int snd_seq_ext_cells(unsigned int extlen)
+{
+	return DIV_ROUND_UP(extlen, sizeof(struct snd_seq_event));
+}
+
+int snd_seq_ext_buf_init(void)
+{
+	char name[24];
+	int i;
+
+	/* a missing cache only makes the bigger classes used */
+	for (i = 0; i < ARRAY_SIZE(ext_buf_sizes); i++) {
+		snprintf(name, sizeof(name), "snd_seq_ext_%u", ext_buf_sizes[i]);
+		ext_buf_caches[i] =
+			kmem_cache_create(name, sizeof(struct snd_seq_ext_buf) +
+					  ext_buf_sizes[i], 0, 0, NULL);
+	}
+
+	return 0;
+}
+
+void snd_seq_ext_buf_done(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(ext_buf_sizes); i++) {
+		kmem_cache_destroy(ext_buf_caches[i]);
+		ext_buf_caches[i] = NULL;
+	}
+}
+
 /*
  * exported:
  * call dump function to expand external data.
@@ -172,6 +264,7 @@ void snd_seq_cell_free(struct snd_seq_event_cell * cell)
 {
 	unsigned long flags;
 	struct snd_seq_pool *pool;
+	struct snd_seq_ext_buf *shared = NULL;
 
 	if (snd_BUG_ON(!cell))
 		return;
@@ -190,6 +283,10 @@ void snd_seq_cell_free(struct snd_seq_event_cell * cell)
 				curp->next = pool->free;
 				free_cell(pool, curp);
 			}
+		} else if (cell->event.data.ext.len & SNDRV_SEQ_EXT_SHARED) {
+			atomic_sub(snd_seq_ext_cells(get_var_len(&cell->event)),
+				   &pool->counter);
+			shared = snd_seq_ext_buf_of(&cell->event);
 		}
 	}
 	if (waitqueue_active(&pool->output_sleep)) {
@@ -198,20 +295,27 @@ void snd_seq_cell_free(struct snd_seq_event_cell * cell)
 			wake_up(&pool->output_sleep);
 	}
 	spin_unlock_irqrestore(&pool->lock, flags);
+
+	if (shared)
+		snd_seq_ext_buf_put(shared);
 }
 
 
 /*
- * allocate an event cell.
+ * allocate a chain of @count event cells, linked through their next
+ * pointer, and charge the pool for @charge cells.  The cells are taken at
+ * once under the pool lock, so that a variable length event doesn't hold
+ * a part of the pool while waiting for the rest of it.
  */
 static int snd_seq_cell_alloc(struct snd_seq_pool *pool,
 			      struct snd_seq_event_cell **cellp,
-			      int nonblock, struct file *file,
-			      struct mutex *mutexp)
+			      int count, int charge, int nonblock,
+			      struct file *file, struct mutex *mutexp)
 {
-	struct snd_seq_event_cell *cell;
+	struct snd_seq_event_cell *cell, *tail;
 	unsigned long flags;
 	int err = -EAGAIN;
+	int i, used;
 	wait_queue_entry_t wait;
 
 	if (pool == NULL)
@@ -226,7 +330,8 @@ static int snd_seq_cell_alloc(struct snd_seq_pool *pool,
 		err = -EINVAL;
 		goto __error;
 	}
-	while (pool->free == NULL && ! nonblock && ! pool->closing) {
+	while (snd_seq_unused_cells(pool) < charge && !nonblock &&
+	       !pool->closing) {
 
 		set_current_state(TASK_INTERRUPTIBLE);
 		add_wait_queue(&pool->output_sleep, &wait);
@@ -249,21 +354,26 @@ static int snd_seq_cell_alloc(struct snd_seq_pool *pool,
 		goto __error;
 	}
 
-	cell = pool->free;
-	if (cell) {
-		int used;
-		pool->free = cell->next;
-		atomic_inc(&pool->counter);
-		used = atomic_read(&pool->counter);
-		if (pool->max_used < used)
-			pool->max_used = used;
-		pool->event_alloc_success++;
-		/* clear cell pointers */
-		cell->next = NULL;
-		err = 0;
-	} else
+	if (snd_seq_unused_cells(pool) < charge) {
 		pool->event_alloc_failures++;
+		goto __error;
+	}
+
+	/* unlink the first count cells of the free list */
+	cell = tail = pool->free;
+	for (i = 1; i < count; i++)
+		tail = tail->next;
+	pool->free = tail->next;
+	/* clear cell pointers */
+	tail->next = NULL;
+
+	atomic_add(charge, &pool->counter);
+	used = atomic_read(&pool->counter);
+	if (pool->max_used < used)
+		pool->max_used = used;
+	pool->event_alloc_success += charge;
 	*cellp = cell;
+	err = 0;
 
 __error:
 	spin_unlock_irqrestore(&pool->lock, flags);
@@ -271,10 +381,52 @@ __error:
 }
 
 
+/*
+ * return a shared buffer holding the data of a variable length event, or
+ * NULL if the data is to be kept in chained cells
+ */
+static struct snd_seq_ext_buf *
+snd_seq_event_share(const struct snd_seq_event *event, unsigned int extlen)
+{
+	unsigned int flags = event->data.ext.len & SNDRV_SEQ_EXT_MASK;
+	struct snd_seq_ext_buf *buf;
+
+	/* fan-out: take a reference instead of copying the data */
+	if (flags & SNDRV_SEQ_EXT_SHARED) {
+		buf = snd_seq_ext_buf_of(event);
+		refcount_inc(&buf->refcount);
+		return buf;
+	}
+
+	/* a single cell is cheaper than a buffer */
+	if (extlen <= sizeof(struct snd_seq_event) ||
+	    (flags & SNDRV_SEQ_EXT_CHAINED))
+		return NULL;
+
+	if (flags & SNDRV_SEQ_EXT_USRPTR) {
+		buf = snd_seq_ext_buf_alloc(extlen, GFP_KERNEL);
+		if (!buf)
+			return NULL;
+		if (copy_from_user(buf->data,
+				   (void __force __user *)event->data.ext.ptr,
+				   extlen)) {
+			snd_seq_ext_buf_put(buf);
+			return ERR_PTR(-EFAULT);
+		}
+		return buf;
+	}
+
+	/* kernel clients may deliver from atomic context */
+	buf = snd_seq_ext_buf_alloc(extlen, GFP_ATOMIC | __GFP_NOWARN);
+	if (buf)
+		memcpy(buf->data, event->data.ext.ptr, extlen);
+	return buf;
+}
+
 /*
  * duplicate the event to a cell.
- * if the event has external data, the data is decomposed to additional
- * cells.
+ * if the event has external data, the data is kept in a shared buffer,
+ * or decomposed to additional cells.
  */
 int snd_seq_event_dup(struct snd_seq_pool *pool, struct snd_seq_event *event,
 		      struct snd_seq_event_cell **cellp, int nonblock,
@@ -282,7 +434,8 @@ int snd_seq_event_dup(struct snd_seq_pool *pool, struct snd_seq_event *event,
 {
 	int ncells, err;
 	unsigned int extlen;
-	struct snd_seq_event_cell *cell;
+	struct snd_seq_event_cell *cell, *tmp;
+	struct snd_seq_ext_buf *shared = NULL;
 
 	*cellp = NULL;
 
@@ -290,14 +443,38 @@ int snd_seq_event_dup(struct snd_seq_pool *pool, struct snd_seq_event *event,
 	extlen = 0;
 	if (snd_seq_ev_is_variable(event)) {
 		extlen = event->data.ext.len & ~SNDRV_SEQ_EXT_MASK;
-		ncells = (extlen + sizeof(struct snd_seq_event) - 1) / sizeof(struct snd_seq_event);
+		ncells = snd_seq_ext_cells(extlen);
 	}
 	if (ncells >= pool->total_elements)
 		return -ENOMEM;
 
-	err = snd_seq_cell_alloc(pool, &cell, nonblock, file, mutexp);
+	if (ncells > 0) {
+		shared = snd_seq_event_share(event, extlen);
+		if (IS_ERR(shared))
+			return PTR_ERR(shared);
+	}
+
+	if (shared) {
+		err = snd_seq_cell_alloc(pool, &cell, 1, ncells + 1, nonblock,
+					 file, mutexp);
+		if (err < 0) {
+			snd_seq_ext_buf_put(shared);
+			return err;
+		}
+		cell->event = *event;
+		cell->event.data.ext.len = extlen | SNDRV_SEQ_EXT_SHARED;
+		cell->event.data.ext.ptr = shared->data;
+		*cellp = cell;
+		return 0;
+	}
+
+	/* the event cell and its data cells are allocated together */
+	err = snd_seq_cell_alloc(pool, &cell, ncells + 1, ncells + 1,
+				 nonblock, file, mutexp);
 	if (err < 0)
 		return err;
+	tmp = cell->next;
+	cell->next = NULL;
 
 	/* copy the event */
 	cell->event = *event;
@@ -307,29 +484,20 @@ int snd_seq_event_dup(struct snd_seq_pool *pool, struct snd_seq_event *event,
 		int len = extlen;
 		int is_chained = event->data.ext.len & SNDRV_SEQ_EXT_CHAINED;
 		int is_usrptr = event->data.ext.len & SNDRV_SEQ_EXT_USRPTR;
-		struct snd_seq_event_cell *src, *tmp, *tail;
+		struct snd_seq_event_cell *src;
 		char *buf;
 
+		/* the chain is released with the event on error */
 		cell->event.data.ext.len = extlen | SNDRV_SEQ_EXT_CHAINED;
-		cell->event.data.ext.ptr = NULL;
+		cell->event.data.ext.ptr = tmp;
 
 		src = (struct snd_seq_event_cell *)event->data.ext.ptr;
 		buf = (char *)event->data.ext.ptr;
-		tail = NULL;
 
-		while (ncells-- > 0) {
+		for (; tmp; tmp = tmp->next) {
 			int size = sizeof(struct snd_seq_event);
 			if (len < size)
 				size = len;
-			err = snd_seq_cell_alloc(pool, &tmp, nonblock, file,
-						 mutexp);
-			if (err < 0)
-				goto __error;
-			if (cell->event.data.ext.ptr == NULL)
-				cell->event.data.ext.ptr = tmp;
-			if (tail)
-				tail->next = tmp;
-			tail = tmp;
 			/* copy chunk */
 			if (is_chained && src) {
 				tmp->event = src->event;
@@ -8,6 +8,8 @@
 
 #include <dkms/sound/seq_kernel.h>
 #include <linux/poll.h>
+#include <linux/llist.h>
+#include <linux/rbtree.h>
 
 struct snd_info_buffer;
 
@@ -16,6 +18,12 @@ struct snd_seq_event_cell {
 	struct snd_seq_event event;
 	struct snd_seq_pool *pool;				/* used pool */
 	struct snd_seq_event_cell *next;	/* next cell */
+	/* links while queued on a prioq */
+	struct rb_node node;			/* ordered on time stamp */
+	struct list_head source_list;		/* cells of the source client */
+	struct list_head dest_list;		/* cells of the dest client */
+	/* link while pushed on a fifo */
+	struct llist_node fifo_node;
 };
 
 /* design note: the pool is a contiguous block of memory, if we dynamicly
@@ -79,6 +87,10 @@ struct snd_seq_pool *snd_seq_pool_new(int poolsize);
 /* remove pool */
 int snd_seq_pool_delete(struct snd_seq_pool **pool);
 
+/* shared buffers for the variable length data */
+int snd_seq_ext_buf_init(void);
+void snd_seq_ext_buf_done(void);
+
 /* polling */
 int snd_seq_pool_poll_wait(struct snd_seq_pool *pool, struct file *file, poll_table *wait);
 
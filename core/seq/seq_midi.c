@@ -58,12 +58,35 @@ static struct seq_midisynth_client *synths[SNDRV_CARDS];
 static DEFINE_MUTEX(register_mutex);
 
 /* handle rawmidi input event (MIDI v1.0 stream) */
+/* encode the input bytes and dispatch the events to the subscribers */
+static void snd_midi_input_encode(struct seq_midisynth *msynth,
+				  const unsigned char *buf, long res)
+{
+	struct snd_seq_event ev;
+	long n;
+
+	if (msynth->parser == NULL)
+		return;
+	memset(&ev, 0, sizeof(ev));
+	while (res > 0) {
+		n = snd_midi_event_encode(msynth->parser, buf, res, &ev);
+		buf += n;
+		res -= n;
+		if (ev.type == SNDRV_SEQ_EVENT_NONE)
+			continue;
+		ev.source.port = msynth->seq_port;
+		ev.dest.client = SNDRV_SEQ_ADDRESS_SUBSCRIBERS;
+		snd_seq_kernel_client_dispatch(msynth->seq_client, &ev, 1, 0);
+		/* clear event and reset header */
+		memset(&ev, 0, sizeof(ev));
+	}
+}
+
 static void snd_midi_input_event(struct snd_rawmidi_substream *substream)
 {
 	struct snd_rawmidi_runtime *runtime;
 	struct seq_midisynth *msynth;
-	struct snd_seq_event ev;
-	char buf[16], *pbuf;
+	unsigned char buf[64];
 	long res;
 
 	if (substream == NULL)
@@ -72,27 +95,24 @@ static void snd_midi_input_event(struct snd_rawmidi_substream *substream)
 	msynth = runtime->private_data;
 	if (msynth == NULL)
 		return;
-	memset(&ev, 0, sizeof(ev));
 	while (runtime->avail > 0) {
 		res = snd_rawmidi_kernel_read(substream, buf, sizeof(buf));
 		if (res <= 0)
 			continue;
-		if (msynth->parser == NULL)
-			continue;
-		pbuf = buf;
-		while (res-- > 0) {
-			if (!snd_midi_event_encode_byte(msynth->parser,
-							*pbuf++, &ev))
-				continue;
-			ev.source.port = msynth->seq_port;
-			ev.dest.client = SNDRV_SEQ_ADDRESS_SUBSCRIBERS;
-			snd_seq_kernel_client_dispatch(msynth->seq_client, &ev, 1, 0);
-			/* clear event and reset header */
-			memset(&ev, 0, sizeof(ev));
-		}
+		snd_midi_input_encode(msynth, buf, res);
 	}
 }
 
+/* the bytes received by the driver, without going through the buffer */
+static void snd_midi_input_receive(struct snd_rawmidi_substream *substream,
+				   const unsigned char *buffer, int count)
+{
+	struct seq_midisynth *msynth = substream->runtime->private_data;
+
+	if (msynth)
+		snd_midi_input_encode(msynth, buffer, count);
+}
+
 static int dump_midi(struct snd_rawmidi_substream *substream, const char *buf, int count)
 {
 	struct snd_rawmidi_runtime *runtime;
@@ -183,8 +203,12 @@ static int midisynth_subscribe(void *private_data, struct snd_seq_port_subscribe
 		return err;
 	}
 	snd_midi_event_reset_encode(msynth->parser);
+	spin_lock_irq(&runtime->lock);
 	runtime->event = snd_midi_input_event;
 	runtime->private_data = msynth;
+	/* the input substream is ours alone, take the bytes directly */
+	runtime->receive = snd_midi_input_receive;
+	spin_unlock_irq(&runtime->lock);
 	snd_rawmidi_kernel_read(msynth->input_rfile.input, NULL, 0);
 	return 0;
 }
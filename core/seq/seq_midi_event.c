@@ -168,26 +168,40 @@ void snd_midi_event_no_status(struct snd_midi_event *dev, int on)
 }
 EXPORT_SYMBOL(snd_midi_event_no_status);
 
-/*
- *  read one byte and encode to sequencer event:
- *  return true if MIDI bytes are encoded to an event
- *         false data is not finished
- */
-bool snd_midi_event_encode_byte(struct snd_midi_event *dev, unsigned char c,
-				struct snd_seq_event *ev)
+/* encode a real-time byte, which doesn't affect the parser state */
+static bool encode_realtime(unsigned char c, struct snd_seq_event *ev)
 {
-	bool rc = false;
-	unsigned long flags;
+	ev->type = status_event[ST_SPECIAL + c - 0xf0].event;
+	ev->flags &= ~SNDRV_SEQ_EVENT_LENGTH_MASK;
+	ev->flags |= SNDRV_SEQ_EVENT_LENGTH_FIXED;
+	return ev->type != SNDRV_SEQ_EVENT_NONE;
+}
 
-	if (c >= MIDI_CMD_COMMON_CLOCK) {
-		/* real-time event */
-		ev->type = status_event[ST_SPECIAL + c - 0xf0].event;
-		ev->flags &= ~SNDRV_SEQ_EVENT_LENGTH_MASK;
-		ev->flags |= SNDRV_SEQ_EVENT_LENGTH_FIXED;
-		return ev->type != SNDRV_SEQ_EVENT_NONE;
-	}
+/* complete a sysex chunk if it ends or fills the buffer - dev->lock held */
+static bool encode_sysex_chunk(struct snd_midi_event *dev, unsigned char c,
+			       struct snd_seq_event *ev)
+{
+	if (c != MIDI_CMD_COMMON_SYSEX_END && dev->read < dev->bufsize)
+		return false;
+
+	ev->flags &= ~SNDRV_SEQ_EVENT_LENGTH_MASK;
+	ev->flags |= SNDRV_SEQ_EVENT_LENGTH_VARIABLE;
+	ev->type = SNDRV_SEQ_EVENT_SYSEX;
+	ev->data.ext.len = dev->read;
+	ev->data.ext.ptr = dev->buf;
+	if (c != MIDI_CMD_COMMON_SYSEX_END)
+		dev->read = 0; /* continue to parse */
+	else
+		reset_encode(dev); /* all parsed */
+	return true;
+}
+
+/* encode a non real-time byte - dev->lock held */
+static bool encode_byte(struct snd_midi_event *dev, unsigned char c,
+			struct snd_seq_event *ev)
+{
+	bool rc = false;
 
-	spin_lock_irqsave(&dev->lock, flags);
 	if ((c & 0x80) &&
 	    (c != MIDI_CMD_COMMON_SYSEX_END || dev->type != ST_SYSEX)) {
 		/* new command */
@@ -221,26 +235,76 @@ bool snd_midi_event_encode_byte(struct snd_midi_event *dev, unsigned char c,
 			dev->type = ST_INVALID;
 		rc = true;
 	} else 	if (dev->type == ST_SYSEX) {
-		if (c == MIDI_CMD_COMMON_SYSEX_END ||
-		    dev->read >= dev->bufsize) {
-			ev->flags &= ~SNDRV_SEQ_EVENT_LENGTH_MASK;
-			ev->flags |= SNDRV_SEQ_EVENT_LENGTH_VARIABLE;
-			ev->type = SNDRV_SEQ_EVENT_SYSEX;
-			ev->data.ext.len = dev->read;
-			ev->data.ext.ptr = dev->buf;
-			if (c != MIDI_CMD_COMMON_SYSEX_END)
-				dev->read = 0; /* continue to parse */
-			else
-				reset_encode(dev); /* all parsed */
-			rc = true;
-		}
+		rc = encode_sysex_chunk(dev, c, ev);
 	}
 
+	return rc;
+}
+
+/*
+ *  read one byte and encode to sequencer event:
+ *  return true if MIDI bytes are encoded to an event
+ *         false data is not finished
+ */
+bool snd_midi_event_encode_byte(struct snd_midi_event *dev, unsigned char c,
+				struct snd_seq_event *ev)
+{
+	bool rc;
+	unsigned long flags;
+
+	if (c >= MIDI_CMD_COMMON_CLOCK)
+		return encode_realtime(c, ev);
+
+	spin_lock_irqsave(&dev->lock, flags);
+	rc = encode_byte(dev, c, ev);
 	spin_unlock_irqrestore(&dev->lock, flags);
 	return rc;
 }
 EXPORT_SYMBOL(snd_midi_event_encode_byte);
 
+/*
+ *  encode MIDI bytes until an event is complete:
+ *  return the number of bytes consumed; ev->type is SNDRV_SEQ_EVENT_NONE
+ *  if no event was completed by the count bytes.
+ *  The running status and sysex state carry over to the next call, and
+ *  the data of a sysex event stays valid until then.
+ */
+long snd_midi_event_encode(struct snd_midi_event *dev, const unsigned char *buf,
+			   long count, struct snd_seq_event *ev)
+{
+	unsigned long flags;
+	long n, pos = 0;
+	bool rc = false;
+
+	ev->type = SNDRV_SEQ_EVENT_NONE;
+
+	spin_lock_irqsave(&dev->lock, flags);
+	while (!rc && pos < count) {
+		/* copy the data bytes of a sysex in one go */
+		if (dev->type == ST_SYSEX && dev->qlen > 0 &&
+		    dev->read < dev->bufsize && !(buf[pos] & 0x80)) {
+			for (n = pos; n < count && !(buf[n] & 0x80); n++)
+				;
+			n = min_t(long, n - pos, dev->bufsize - dev->read);
+			memcpy(dev->buf + dev->read, buf + pos, n);
+			dev->read += n;
+			pos += n;
+			rc = encode_sysex_chunk(dev, 0, ev);
+			continue;
+		}
+
+		if (buf[pos] >= MIDI_CMD_COMMON_CLOCK)
+			rc = encode_realtime(buf[pos], ev);
+		else
+			rc = encode_byte(dev, buf[pos], ev);
+		pos++;
+	}
+	spin_unlock_irqrestore(&dev->lock, flags);
+
+	return pos;
+}
+EXPORT_SYMBOL(snd_midi_event_encode);
+
 /* encode note event */
 static void note_event(struct snd_midi_event *dev, struct snd_seq_event *ev)
 {
@@ -100,7 +100,6 @@ static void port_subs_info_init(struct snd_seq_port_subs_info *grp)
 	INIT_LIST_HEAD(&grp->list_head);
 	grp->count = 0;
 	grp->exclusive = 0;
-	rwlock_init(&grp->list_lock);
 	init_rwsem(&grp->list_mutex);
 	grp->open = NULL;
 	grp->close = NULL;
@@ -498,15 +497,13 @@ static int check_and_subscribe_port(struct snd_seq_client *client,
 		goto __error;
 	}
 
-	/* add to list */
-	write_lock_irq(&grp->list_lock);
+	/* add to list, visible to the atomic delivery right away */
 	if (is_src)
-		list_add_tail(&subs->src_list, &grp->list_head);
+		list_add_tail_rcu(&subs->src_list, &grp->list_head);
 	else
-		list_add_tail(&subs->dest_list, &grp->list_head);
+		list_add_tail_rcu(&subs->dest_list, &grp->list_head);
 	grp->exclusive = exclusive;
 	atomic_inc(&subs->ref_count);
-	write_unlock_irq(&grp->list_lock);
 	err = 0;
 
  __error:
@@ -526,12 +523,17 @@ static void delete_and_unsubscribe_port(struct snd_seq_client *client,
 	grp = is_src ? &port->c_src : &port->c_dest;
 	list = is_src ? &subs->src_list : &subs->dest_list;
 	down_write(&grp->list_mutex);
-	write_lock_irq(&grp->list_lock);
 	empty = list_empty(list);
-	if (!empty)
-		list_del_init(list);
+	if (!empty) {
+		list_del_rcu(list);
+		/*
+		 * the callers free subs right after, wait for the lockless
+		 * readers before making the entry reusable
+		 */
+		synchronize_rcu();
+		INIT_LIST_HEAD(list);
+	}
 	grp->exclusive = 0;
-	write_unlock_irq(&grp->list_lock);
 
 	if (!empty)
 		unsubscribe_port(client, port, grp, &subs->info, ack);
@@ -7,6 +7,7 @@
 #define __SND_SEQ_PORTS_H
 
 #include <dkms/sound/seq_kernel.h>
+#include <linux/rculist.h>
 #include "seq_lock.h"
 
 /* list of 'exported' ports */
@@ -33,11 +34,10 @@ struct snd_seq_subscribers {
 };
 
 struct snd_seq_port_subs_info {
-	struct list_head list_head;	/* list of subscribed ports */
+	struct list_head list_head;	/* list of subscribed ports (RCU) */
 	unsigned int count;		/* count of subscribers */
 	unsigned int exclusive: 1;	/* exclusive mode */
 	struct rw_semaphore list_mutex;
-	rwlock_t list_lock;
 	int (*open)(void *private_data, struct snd_seq_port_subscribe *info);
 	int (*close)(void *private_data, struct snd_seq_port_subscribe *info);
 };
@@ -11,45 +11,36 @@
 #include "seq_prioq.h"
 
 
-/* Implementation is a simple linked list for now...
-
-   This priority queue orders the events on timestamp. For events with an
-   equeal timestamp the queue behaves as a FIFO. 
-
-   *
-   *           +-------+
-   *  Head --> | first |
-   *           +-------+
-   *                 |next
-   *           +-----v-+
-   *           |       |
-   *           +-------+
-   *                 |
-   *           +-----v-+
-   *           |       |
-   *           +-------+
-   *                 |
-   *           +-----v-+
-   *  Tail --> | last  |
-   *           +-------+
-   *
-
- */
+/* This priority queue orders the events on timestamp. For events with an
+   equal timestamp the queue behaves as a FIFO, except that the events with
+   the high priority flag go before the others.
 
+   The cells are kept in a red-black tree, so that an event is queued and
+   dequeued in O(log n) whatever its timestamp.  The last cell is cached:
+   the in-order data fed by a sequencer application or a midi file player
+   is appended next to it without a lookup.  The cells are also hashed on
+   their source and destination client, so that removing the events of a
+   client doesn't walk the whole queue.
 
+ */
 
 /* create new prioq (constructor) */
 struct snd_seq_prioq *snd_seq_prioq_new(void)
 {
 	struct snd_seq_prioq *f;
+	int i;
 
 	f = kzalloc(sizeof(*f), GFP_KERNEL);
 	if (!f)
 		return NULL;
 	
 	spin_lock_init(&f->lock);
-	f->head = NULL;
+	f->root = RB_ROOT_CACHED;
 	f->tail = NULL;
+	for (i = 0; i < SNDRV_SEQ_PRIOQ_CLIENT_HASH; i++) {
+		INIT_LIST_HEAD(&f->by_source[i]);
+		INIT_LIST_HEAD(&f->by_dest[i]);
+	}
 	f->cells = 0;
 	
 	return f;
@@ -127,14 +118,39 @@ static inline int compare_timestamp_rel(struct snd_seq_event *a,
 	}
 }
 
+static inline struct list_head *
+prioq_client_list(struct list_head *hash, int client)
+{
+	return &hash[client % SNDRV_SEQ_PRIOQ_CLIENT_HASH];
+}
+
+/* unlink the cell from the prioq; called with the lock */
+static void prioq_erase(struct snd_seq_prioq *f,
+			struct snd_seq_event_cell *cell)
+{
+	struct rb_node *prev;
+
+	if (f->tail == cell) {
+		prev = rb_prev(&cell->node);
+		f->tail = prev ? rb_entry(prev, struct snd_seq_event_cell, node) :
+			NULL;
+	}
+	rb_erase_cached(&cell->node, &f->root);
+	list_del(&cell->source_list);
+	list_del(&cell->dest_list);
+	f->cells--;
+	cell->next = NULL;
+}
+
 /* enqueue cell to prioq */
 int snd_seq_prioq_cell_in(struct snd_seq_prioq * f,
 			  struct snd_seq_event_cell * cell)
 {
-	struct snd_seq_event_cell *cur, *prev;
+	struct snd_seq_event_cell *cur;
+	struct rb_node **link, *parent;
 	unsigned long flags;
-	int count;
-	int prior;
+	bool leftmost, rightmost;
+	int prior, rel;
 
 	if (snd_BUG_ON(!f || !cell))
 		return -EINVAL;
@@ -147,53 +163,41 @@ int snd_seq_prioq_cell_in(struct snd_seq_prioq * f,
 	/* check if this element needs to inserted at the end (ie. ordered 
 	   data is inserted) This will be very likeley if a sequencer 
 	   application or midi file player is feeding us (sequential) data */
-	if (f->tail && !prior) {
-		if (compare_timestamp(&cell->event, &f->tail->event)) {
-			/* add new cell to tail of the fifo */
-			f->tail->next = cell;
-			f->tail = cell;
-			cell->next = NULL;
-			f->cells++;
-			spin_unlock_irqrestore(&f->lock, flags);
-			return 0;
-		}
-	}
-	/* traverse list of elements to find the place where the new cell is
-	   to be inserted... Note that this is a order n process ! */
-
-	prev = NULL;		/* previous cell */
-	cur = f->head;		/* cursor */
-
-	count = 10000; /* FIXME: enough big, isn't it? */
-	while (cur != NULL) {
-		/* compare timestamps */
-		int rel = compare_timestamp_rel(&cell->event, &cur->event);
-		if (rel < 0)
-			/* new cell has earlier schedule time, */
-			break;
-		else if (rel == 0 && prior)
-			/* equal schedule time and prior to others */
-			break;
-		/* new cell has equal or larger schedule time, */
-		/* move cursor to next cell */
-		prev = cur;
-		cur = cur->next;
-		if (! --count) {
-			spin_unlock_irqrestore(&f->lock, flags);
-			pr_err("ALSA: seq: cannot find a pointer.. infinite loop?\n");
-			return -EINVAL;
+	if (f->tail && !prior &&
+	    compare_timestamp(&cell->event, &f->tail->event)) {
+		/* the tail is the rightmost cell, it has no right child */
+		parent = &f->tail->node;
+		link = &parent->rb_right;
+		leftmost = false;
+		rightmost = true;
+	} else {
+		/* equal timestamps go to the right unless prior, as a FIFO */
+		parent = NULL;
+		link = &f->root.rb_root.rb_node;
+		leftmost = rightmost = true;
+		while (*link) {
+			parent = *link;
+			cur = rb_entry(parent, struct snd_seq_event_cell, node);
+			rel = compare_timestamp_rel(&cell->event, &cur->event);
+			if (rel < 0 || (rel == 0 && prior)) {
+				link = &parent->rb_left;
+				rightmost = false;
+			} else {
+				link = &parent->rb_right;
+				leftmost = false;
+			}
 		}
 	}
 
-	/* insert it before cursor */
-	if (prev != NULL)
-		prev->next = cell;
-	cell->next = cur;
-
-	if (f->head == cur) /* this is the first cell, set head to it */
-		f->head = cell;
-	if (cur == NULL) /* reached end of the list */
+	rb_link_node(&cell->node, parent, link);
+	rb_insert_color_cached(&cell->node, &f->root, leftmost);
+	if (rightmost)
 		f->tail = cell;
+	list_add_tail(&cell->source_list,
+		      prioq_client_list(f->by_source, cell->event.source.client));
+	list_add_tail(&cell->dest_list,
+		      prioq_client_list(f->by_dest, cell->event.dest.client));
+	cell->next = NULL;
 	f->cells++;
 	spin_unlock_irqrestore(&f->lock, flags);
 	return 0;
@@ -213,6 +217,7 @@ struct snd_seq_event_cell *snd_seq_prioq_cell_out(struct snd_seq_prioq *f,
 						  void *current_time)
 {
 	struct snd_seq_event_cell *cell;
+	struct rb_node *first;
 	unsigned long flags;
 
 	if (f == NULL) {
@@ -221,19 +226,12 @@ struct snd_seq_event_cell *snd_seq_prioq_cell_out(struct snd_seq_prioq *f,
 	}
 	spin_lock_irqsave(&f->lock, flags);
 
-	cell = f->head;
+	first = rb_first_cached(&f->root);
+	cell = first ? rb_entry(first, struct snd_seq_event_cell, node) : NULL;
 	if (cell && current_time && !event_is_ready(&cell->event, current_time))
 		cell = NULL;
-	if (cell) {
-		f->head = cell->next;
-
-		/* reset tail if this was the last element */
-		if (f->tail == cell)
-			f->tail = NULL;
-
-		cell->next = NULL;
-		f->cells--;
-	}
+	if (cell)
+		prioq_erase(f, cell);
 
 	spin_unlock_irqrestore(&f->lock, flags);
 	return cell;
@@ -246,9 +244,32 @@ int snd_seq_prioq_avail(struct snd_seq_prioq * f)
 		pr_debug("ALSA: seq: snd_seq_prioq_cell_in() called with NULL prioq\n");
 		return 0;
 	}
+
 	return f->cells;
 }
 
+/* get the time stamp of the first event, -ENOENT if prioq is empty */
+int snd_seq_prioq_next_time(struct snd_seq_prioq *f,
+			    union snd_seq_timestamp *time)
+{
+	struct rb_node *first;
+	unsigned long flags;
+	int err = -ENOENT;
+
+	if (f == NULL)
+		return -EINVAL;
+
+	spin_lock_irqsave(&f->lock, flags);
+	first = rb_first_cached(&f->root);
+	if (first) {
+		*time = rb_entry(first, struct snd_seq_event_cell,
+				 node)->event.time;
+		err = 0;
+	}
+	spin_unlock_irqrestore(&f->lock, flags);
+	return err;
+}
+
 static inline int prioq_match(struct snd_seq_event_cell *cell,
 			      int client, int timestamp)
 {
@@ -271,58 +292,59 @@ static inline int prioq_match(struct snd_seq_event_cell *cell,
 	return 0;
 }
 
+/* unlink the cell and add it to the list of cells to be freed */
+static void prioq_collect(struct snd_seq_prioq *f,
+			  struct snd_seq_event_cell *cell,
+			  struct snd_seq_event_cell **freelist)
+{
+	prioq_erase(f, cell);
+	cell->next = *freelist;
+	*freelist = cell;
+}
+
+static void prioq_free_cells(struct snd_seq_event_cell *cell)
+{
+	struct snd_seq_event_cell *next;
+
+	for (; cell; cell = next) {
+		next = cell->next;
+		snd_seq_cell_free(cell);
+	}
+}
+
 /* remove cells for left client */
 void snd_seq_prioq_leave(struct snd_seq_prioq * f, int client, int timestamp)
 {
-	register struct snd_seq_event_cell *cell, *next;
+	struct snd_seq_event_cell *cell, *next, *freelist = NULL;
+	struct rb_node *node;
 	unsigned long flags;
-	struct snd_seq_event_cell *prev = NULL;
-	struct snd_seq_event_cell *freefirst = NULL, *freeprev = NULL, *freenext;
 
 	/* collect all removed cells */
 	spin_lock_irqsave(&f->lock, flags);
-	cell = f->head;
-	while (cell) {
-		next = cell->next;
-		if (prioq_match(cell, client, timestamp)) {
-			/* remove cell from prioq */
-			if (cell == f->head) {
-				f->head = cell->next;
-			} else {
-				prev->next = cell->next;
-			}
-			if (cell == f->tail)
-				f->tail = cell->next;
-			f->cells--;
-			/* add cell to free list */
-			cell->next = NULL;
-			if (freefirst == NULL) {
-				freefirst = cell;
-			} else {
-				freeprev->next = cell;
-			}
-			freeprev = cell;
-		} else {
-#if 0
-			pr_debug("ALSA: seq: type = %i, source = %i, dest = %i, "
-			       "client = %i\n",
-				cell->event.type,
-				cell->event.source.client,
-				cell->event.dest.client,
-				client);
-#endif
-			prev = cell;
+	if (!timestamp) {
+		/* only the cells from or to the client, found via the hashes */
+		list_for_each_entry_safe(cell, next,
+					 prioq_client_list(f->by_source, client),
+					 source_list)
+			if (cell->event.source.client == client)
+				prioq_collect(f, cell, &freelist);
+		list_for_each_entry_safe(cell, next,
+					 prioq_client_list(f->by_dest, client),
+					 dest_list)
+			if (cell->event.dest.client == client)
+				prioq_collect(f, cell, &freelist);
+	} else {
+		for (node = rb_first_cached(&f->root); node; ) {
+			cell = rb_entry(node, struct snd_seq_event_cell, node);
+			node = rb_next(node);
+			if (prioq_match(cell, client, timestamp))
+				prioq_collect(f, cell, &freelist);
 		}
-		cell = next;		
 	}
-	spin_unlock_irqrestore(&f->lock, flags);	
+	spin_unlock_irqrestore(&f->lock, flags);
 
 	/* remove selected cells */
-	while (freefirst) {
-		freenext = freefirst->next;
-		snd_seq_cell_free(freefirst);
-		freefirst = freenext;
-	}
+	prioq_free_cells(freelist);
 }
 
 static int prioq_remove_match(struct snd_seq_remove_events *info,
@@ -384,53 +406,19 @@ static int prioq_remove_match(struct snd_seq_remove_events *info,
 void snd_seq_prioq_remove_events(struct snd_seq_prioq * f, int client,
 				 struct snd_seq_remove_events *info)
 {
-	struct snd_seq_event_cell *cell, *next;
+	struct snd_seq_event_cell *cell, *next, *freelist = NULL;
 	unsigned long flags;
-	struct snd_seq_event_cell *prev = NULL;
-	struct snd_seq_event_cell *freefirst = NULL, *freeprev = NULL, *freenext;
 
-	/* collect all removed cells */
+	/* collect all removed cells; only the client's own events match */
 	spin_lock_irqsave(&f->lock, flags);
-	cell = f->head;
-
-	while (cell) {
-		next = cell->next;
+	list_for_each_entry_safe(cell, next,
+				 prioq_client_list(f->by_source, client),
+				 source_list)
 		if (cell->event.source.client == client &&
-			prioq_remove_match(info, &cell->event)) {
-
-			/* remove cell from prioq */
-			if (cell == f->head) {
-				f->head = cell->next;
-			} else {
-				prev->next = cell->next;
-			}
-
-			if (cell == f->tail)
-				f->tail = cell->next;
-			f->cells--;
-
-			/* add cell to free list */
-			cell->next = NULL;
-			if (freefirst == NULL) {
-				freefirst = cell;
-			} else {
-				freeprev->next = cell;
-			}
-
-			freeprev = cell;
-		} else {
-			prev = cell;
-		}
-		cell = next;		
-	}
-	spin_unlock_irqrestore(&f->lock, flags);	
+		    prioq_remove_match(info, &cell->event))
+			prioq_collect(f, cell, &freelist);
+	spin_unlock_irqrestore(&f->lock, flags);
 
 	/* remove selected cells */
-	while (freefirst) {
-		freenext = freefirst->next;
-		snd_seq_cell_free(freefirst);
-		freefirst = freenext;
-	}
+	prioq_free_cells(freelist);
 }
-
-
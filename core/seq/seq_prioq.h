@@ -11,9 +11,15 @@
 
 /* === PRIOQ === */
 
+/* buckets of the per-client indexes */
+#define SNDRV_SEQ_PRIOQ_CLIENT_HASH	16
+
 struct snd_seq_prioq {
-	struct snd_seq_event_cell *head;      /* pointer to head of prioq */
+	struct rb_root_cached root;	      /* cells ordered on time stamp */
 	struct snd_seq_event_cell *tail;      /* pointer to tail of prioq */
+	/* cells hashed on their source and destination client */
+	struct list_head by_source[SNDRV_SEQ_PRIOQ_CLIENT_HASH];
+	struct list_head by_dest[SNDRV_SEQ_PRIOQ_CLIENT_HASH];
 	int cells;
 	spinlock_t lock;
 };
@@ -35,6 +41,10 @@ struct snd_seq_event_cell *snd_seq_prioq_cell_out(struct snd_seq_prioq *f,
 /* return number of events available in prioq */
 int snd_seq_prioq_avail(struct snd_seq_prioq *f);
 
+/* get the time stamp of the first event */
+int snd_seq_prioq_next_time(struct snd_seq_prioq *f,
+			    union snd_seq_timestamp *time);
+
 /* client left queue */
 void snd_seq_prioq_leave(struct snd_seq_prioq *f, int client, int timestamp);        
 
@@ -282,6 +282,9 @@ void snd_seq_check_queue(struct snd_seq_queue *q, int atomic, int hop)
 	}
 	q->check_blocked = 0;
 	spin_unlock_irqrestore(&q->check_lock, flags);
+
+	/* a tickless queue sleeps until its next event */
+	snd_seq_timer_reprogram(q);
 }
 
 
@@ -290,6 +293,7 @@ int snd_seq_enqueue_event(struct snd_seq_event_cell *cell, int atomic, int hop)
 {
 	int dest, err;
 	struct snd_seq_queue *q;
+	snd_seq_real_time_t cur_time;
 
 	if (snd_BUG_ON(!cell))
 		return -EINVAL;
@@ -301,12 +305,13 @@ int snd_seq_enqueue_event(struct snd_seq_event_cell *cell, int atomic, int hop)
 	if ((cell->event.flags & SNDRV_SEQ_TIME_MODE_MASK) == SNDRV_SEQ_TIME_MODE_REL) {
 		switch (cell->event.flags & SNDRV_SEQ_TIME_STAMP_MASK) {
 		case SNDRV_SEQ_TIME_STAMP_TICK:
-			cell->event.time.tick += q->timer->tick.cur_tick;
+			cell->event.time.tick +=
+				snd_seq_timer_get_cur_tick(q->timer);
 			break;
 
 		case SNDRV_SEQ_TIME_STAMP_REAL:
-			snd_seq_inc_real_time(&cell->event.time.time,
-					      &q->timer->cur_time);
+			cur_time = snd_seq_timer_get_cur_time(q->timer, false);
+			snd_seq_inc_real_time(&cell->event.time.time, &cur_time);
 			break;
 		}
 		cell->event.flags &= ~SNDRV_SEQ_TIME_MODE_MASK;
@@ -645,7 +650,7 @@ static void queue_broadcast_event(struct snd_seq_queue *q, struct snd_seq_event
 	sev = *ev;
 	
 	sev.flags = SNDRV_SEQ_TIME_STAMP_TICK|SNDRV_SEQ_TIME_MODE_ABS;
-	sev.time.tick = q->timer->tick.cur_tick;
+	sev.time.tick = snd_seq_timer_get_cur_tick(q->timer);
 	sev.queue = q->queue;
 	sev.data.queue.queue = q->queue;
 
@@ -18,6 +18,11 @@
 
 #define SKEW_BASE	0x10000	/* 16bit shift */
 
+/* longest sleep of a tickless queue, the deadline is recomputed after it */
+#define TICKLESS_MAX_SLEEP_NS	(3600 * NSEC_PER_SEC)
+
+static enum hrtimer_restart snd_seq_timer_hrtimer_fire(struct hrtimer *hrt);
+
 static void snd_seq_timer_set_tick_resolution(struct snd_seq_timer *tmr)
 {
 	if (tmr->tempo < 1000000)
@@ -44,6 +49,8 @@ struct snd_seq_timer *snd_seq_timer_new(void)
 	if (!tmr)
 		return NULL;
 	spin_lock_init(&tmr->lock);
+	hrtimer_init(&tmr->hrtimer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	tmr->hrtimer.function = snd_seq_timer_hrtimer_fire;
 
 	/* reset setup to defaults */
 	snd_seq_timer_defaults(tmr);
@@ -69,6 +76,7 @@ void snd_seq_timer_delete(struct snd_seq_timer **tmr)
 	/* reset time */
 	snd_seq_timer_stop(t);
 	snd_seq_timer_reset(t);
+	hrtimer_cancel(&t->hrtimer);
 
 	kfree(t);
 }
@@ -91,6 +99,7 @@ void snd_seq_timer_defaults(struct snd_seq_timer * tmr)
 	tmr->alsa_id.device = seq_default_timer_device;
 	tmr->alsa_id.subdevice = seq_default_timer_subdevice;
 	tmr->preferred_resolution = seq_default_timer_resolution;
+	tmr->tickless = seq_default_timer_tickless;
 
 	tmr->skew = tmr->skew_base = SKEW_BASE;
 	spin_unlock_irqrestore(&tmr->lock, flags);
@@ -116,6 +125,45 @@ void snd_seq_timer_reset(struct snd_seq_timer *tmr)
 }
 
 
+/* advance the queue time by the given wall clock time - tmr->lock held */
+static void seq_timer_apply(struct snd_seq_timer *tmr, unsigned long resolution)
+{
+	if (tmr->skew != tmr->skew_base) {
+		/* FIXME: assuming skew_base = 0x10000 */
+		resolution = (resolution >> 16) * tmr->skew +
+			(((resolution & 0xffff) * tmr->skew) >> 16);
+	}
+
+	/* update timer */
+	snd_seq_inc_time_nsec(&tmr->cur_time, resolution);
+
+	/* calculate current tick */
+	snd_seq_timer_update_tick(&tmr->tick, resolution);
+}
+
+/* bring a running tickless timer up to now - tmr->lock held */
+static void seq_timer_advance(struct snd_seq_timer *tmr)
+{
+	struct timespec64 now, delta;
+	u64 nsec;
+	unsigned long chunk;
+
+	if (!tmr->tickless || !tmr->running)
+		return;
+
+	ktime_get_ts64(&now);
+	delta = timespec64_sub(now, tmr->last_update);
+	tmr->last_update = now;
+	if (delta.tv_sec < 0)
+		return;
+
+	/* in chunks, the skew is applied on an unsigned long */
+	for (nsec = timespec64_to_ns(&delta); nsec; nsec -= chunk) {
+		chunk = min_t(u64, nsec, NSEC_PER_SEC / 10);
+		seq_timer_apply(tmr, chunk);
+	}
+}
+
 /* called by timer interrupt routine. the period time since previous invocation is passed */
 static void snd_seq_timer_interrupt(struct snd_timer_instance *timeri,
 				    unsigned long resolution,
@@ -137,17 +185,7 @@ static void snd_seq_timer_interrupt(struct snd_timer_instance *timeri,
 	}
 
 	resolution *= ticks;
-	if (tmr->skew != tmr->skew_base) {
-		/* FIXME: assuming skew_base = 0x10000 */
-		resolution = (resolution >> 16) * tmr->skew +
-			(((resolution & 0xffff) * tmr->skew) >> 16);
-	}
-
-	/* update timer */
-	snd_seq_inc_time_nsec(&tmr->cur_time, resolution);
-
-	/* calculate current tick */
-	snd_seq_timer_update_tick(&tmr->tick, resolution);
+	seq_timer_apply(tmr, resolution);
 
 	/* register actual time of this timer update */
 	ktime_get_ts64(&tmr->last_update);
@@ -158,6 +196,75 @@ static void snd_seq_timer_interrupt(struct snd_timer_instance *timeri,
 	snd_seq_check_queue(q, 1, 0);
 }
 
+/* tickless mode: the first event of the queue is due */
+static enum hrtimer_restart snd_seq_timer_hrtimer_fire(struct hrtimer *hrt)
+{
+	struct snd_seq_timer *tmr = container_of(hrt, struct snd_seq_timer,
+						 hrtimer);
+
+	/* snd_seq_check_queue() programs the next deadline */
+	if (tmr->queue)
+		snd_seq_check_queue(tmr->queue, 1, 0);
+	return HRTIMER_NORESTART;
+}
+
+/* nsec of queue time until the given tick - tmr->lock held */
+static u64 seq_timer_tick_delay(struct snd_seq_timer *tmr,
+				snd_seq_tick_time_t tick)
+{
+	if (snd_seq_compare_tick_time(&tmr->tick.cur_tick, &tick))
+		return 0;
+	return (u64)(tick - tmr->tick.cur_tick) * tmr->tick.resolution -
+		tmr->tick.fraction;
+}
+
+/* nsec of queue time until the given real time - tmr->lock held */
+static u64 seq_timer_time_delay(struct snd_seq_timer *tmr,
+				snd_seq_real_time_t *time)
+{
+	if (snd_seq_compare_real_time(&tmr->cur_time, time))
+		return 0;
+	return (u64)(time->tv_sec - tmr->cur_time.tv_sec) * NSEC_PER_SEC +
+		time->tv_nsec - tmr->cur_time.tv_nsec;
+}
+
+/*
+ * program the hrtimer of a tickless queue to the first event due in the
+ * tick or the real-time queue; nothing is armed while the queue is empty
+ */
+void snd_seq_timer_reprogram(struct snd_seq_queue *q)
+{
+	struct snd_seq_timer *tmr = q->timer;
+	union snd_seq_timestamp tick_next, time_next;
+	bool has_tick, has_time;
+	unsigned long flags;
+	u64 nsec = TICKLESS_MAX_SLEEP_NS;
+
+	if (!tmr || !tmr->tickless)
+		return;
+
+	has_tick = !snd_seq_prioq_next_time(q->tickq, &tick_next);
+	has_time = !snd_seq_prioq_next_time(q->timeq, &time_next);
+
+	spin_lock_irqsave(&tmr->lock, flags);
+	if (!tmr->running || !tmr->skew || (!has_tick && !has_time))
+		goto unlock;
+
+	seq_timer_advance(tmr);
+	if (has_tick)
+		nsec = min(nsec, seq_timer_tick_delay(tmr, tick_next.tick));
+	if (has_time)
+		nsec = min(nsec, seq_timer_time_delay(tmr, &time_next.time));
+
+	/* the queue time runs skew / skew_base times the wall clock */
+	if (tmr->skew != tmr->skew_base)
+		nsec = div_u64(nsec * tmr->skew_base, tmr->skew);
+
+	hrtimer_start(&tmr->hrtimer, ns_to_ktime(nsec), HRTIMER_MODE_REL);
+ unlock:
+	spin_unlock_irqrestore(&tmr->lock, flags);
+}
+
 /* set current tempo */
 int snd_seq_timer_set_tempo(struct snd_seq_timer * tmr, int tempo)
 {
@@ -169,10 +276,14 @@ int snd_seq_timer_set_tempo(struct snd_seq_timer * tmr, int tempo)
 		return -EINVAL;
 	spin_lock_irqsave(&tmr->lock, flags);
 	if ((unsigned int)tempo != tmr->tempo) {
+		/* the time elapsed so far runs at the former tempo */
+		seq_timer_advance(tmr);
 		tmr->tempo = tempo;
 		snd_seq_timer_set_tick_resolution(tmr);
 	}
 	spin_unlock_irqrestore(&tmr->lock, flags);
+	if (tmr->queue)
+		snd_seq_timer_reprogram(tmr->queue);
 	return 0;
 }
 
@@ -195,11 +306,15 @@ int snd_seq_timer_set_tempo_ppq(struct snd_seq_timer *tmr, int tempo, int ppq)
 		return -EBUSY;
 	}
 	changed = (tempo != tmr->tempo) || (ppq != tmr->ppq);
+	if (changed)
+		seq_timer_advance(tmr);
 	tmr->tempo = tempo;
 	tmr->ppq = ppq;
 	if (changed)
 		snd_seq_timer_set_tick_resolution(tmr);
 	spin_unlock_irqrestore(&tmr->lock, flags);
+	if (changed && tmr->queue)
+		snd_seq_timer_reprogram(tmr->queue);
 	return 0;
 }
 
@@ -250,8 +365,11 @@ int snd_seq_timer_set_skew(struct snd_seq_timer *tmr, unsigned int skew,
 		return -EINVAL;
 	}
 	spin_lock_irqsave(&tmr->lock, flags);
+	seq_timer_advance(tmr);
 	tmr->skew = skew;
 	spin_unlock_irqrestore(&tmr->lock, flags);
+	if (tmr->queue)
+		snd_seq_timer_reprogram(tmr->queue);
 	return 0;
 }
 
@@ -267,6 +385,11 @@ int snd_seq_timer_open(struct snd_seq_queue *q)
 		return -EINVAL;
 	if (tmr->timeri)
 		return -EBUSY;
+	if (tmr->tickless) {
+		/* no ALSA timer, snd_seq_timer_reprogram() arms the hrtimer */
+		tmr->queue = q;
+		return 0;
+	}
 	sprintf(str, "sequencer queue %i", q->queue);
 	if (tmr->type != SNDRV_SEQ_TIMER_ALSA)	/* standard ALSA timer */
 		return -EINVAL;
@@ -278,6 +401,8 @@ int snd_seq_timer_open(struct snd_seq_queue *q)
 	t->callback = snd_seq_timer_interrupt;
 	t->callback_data = q;
 	t->flags |= SNDRV_TIMER_IFLG_AUTO;
+	/* dispatch the queue before the other users of the same tick */
+	t->priority = -1;
 	err = snd_timer_open(t, &tmr->alsa_id, q->queue);
 	if (err < 0 && tmr->alsa_id.dev_class != SNDRV_TIMER_CLASS_SLAVE) {
 		if (tmr->alsa_id.dev_class != SNDRV_TIMER_CLASS_GLOBAL ||
@@ -298,6 +423,7 @@ int snd_seq_timer_open(struct snd_seq_queue *q)
 	}
 	spin_lock_irq(&tmr->lock);
 	tmr->timeri = t;
+	tmr->queue = q;
 	spin_unlock_irq(&tmr->lock);
 	return 0;
 }
@@ -314,6 +440,7 @@ int snd_seq_timer_close(struct snd_seq_queue *q)
 	t = tmr->timeri;
 	tmr->timeri = NULL;
 	spin_unlock_irq(&tmr->lock);
+	hrtimer_cancel(&tmr->hrtimer);
 	if (t) {
 		snd_timer_close(t);
 		snd_timer_instance_free(t);
@@ -323,10 +450,17 @@ int snd_seq_timer_close(struct snd_seq_queue *q)
 
 static int seq_timer_stop(struct snd_seq_timer *tmr)
 {
-	if (! tmr->timeri)
+	if (!tmr->timeri && !tmr->tickless)
 		return -EINVAL;
 	if (!tmr->running)
 		return 0;
+	if (tmr->tickless) {
+		seq_timer_advance(tmr);
+		tmr->running = 0;
+		/* may be called from the hrtimer callback itself */
+		hrtimer_try_to_cancel(&tmr->hrtimer);
+		return 0;
+	}
 	tmr->running = 0;
 	snd_timer_pause(tmr->timeri);
 	return 0;
@@ -373,13 +507,26 @@ static int initialize_timer(struct snd_seq_timer *tmr)
 	return 0;
 }
 
+/* start the tickless timer, the queue is checked right away */
+static void seq_timer_start_tickless(struct snd_seq_timer *tmr)
+{
+	tmr->initialized = 1;
+	tmr->running = 1;
+	ktime_get_ts64(&tmr->last_update);
+	hrtimer_start(&tmr->hrtimer, 0, HRTIMER_MODE_REL);
+}
+
 static int seq_timer_start(struct snd_seq_timer *tmr)
 {
-	if (! tmr->timeri)
+	if (!tmr->timeri && !tmr->tickless)
 		return -EINVAL;
 	if (tmr->running)
 		seq_timer_stop(tmr);
 	seq_timer_reset(tmr);
+	if (tmr->tickless) {
+		seq_timer_start_tickless(tmr);
+		return 0;
+	}
 	if (initialize_timer(tmr) < 0)
 		return -EINVAL;
 	snd_timer_start(tmr->timeri, tmr->ticks);
@@ -401,10 +548,16 @@ int snd_seq_timer_start(struct snd_seq_timer *tmr)
 
 static int seq_timer_continue(struct snd_seq_timer *tmr)
 {
-	if (! tmr->timeri)
+	if (!tmr->timeri && !tmr->tickless)
 		return -EINVAL;
 	if (tmr->running)
 		return -EBUSY;
+	if (tmr->tickless) {
+		if (!tmr->initialized)
+			seq_timer_reset(tmr);
+		seq_timer_start_tickless(tmr);
+		return 0;
+	}
 	if (! tmr->initialized) {
 		seq_timer_reset(tmr);
 		if (initialize_timer(tmr) < 0)
@@ -435,8 +588,10 @@ snd_seq_real_time_t snd_seq_timer_get_cur_time(struct snd_seq_timer *tmr,
 	unsigned long flags;
 
 	spin_lock_irqsave(&tmr->lock, flags);
+	/* a tickless timer is brought up to now, no interpolation needed */
+	seq_timer_advance(tmr);
 	cur_time = tmr->cur_time;
-	if (adjust_ktime && tmr->running) {
+	if (adjust_ktime && tmr->running && !tmr->tickless) {
 		struct timespec64 tm;
 
 		ktime_get_ts64(&tm);
@@ -457,6 +612,7 @@ snd_seq_tick_time_t snd_seq_timer_get_cur_tick(struct snd_seq_timer *tmr)
 	unsigned long flags;
 
 	spin_lock_irqsave(&tmr->lock, flags);
+	seq_timer_advance(tmr);
 	cur_tick = tmr->tick.cur_tick;
 	spin_unlock_irqrestore(&tmr->lock, flags);
 	return cur_tick;
@@ -482,6 +638,11 @@ void snd_seq_info_timer_read(struct snd_info_entry *entry,
 		tmr = q->timer;
 		if (!tmr)
 			goto unlock;
+		if (tmr->tickless) {
+			snd_iprintf(buffer, "Timer for queue %i : tickless hrtimer\n", q->queue);
+			snd_iprintf(buffer, "  Skew : %u / %u\n", tmr->skew, tmr->skew_base);
+			goto unlock;
+		}
 		ti = tmr->timeri;
 		if (!ti)
 			goto unlock;
@@ -6,6 +6,7 @@
 #ifndef __SND_SEQ_TIMER_H
 #define __SND_SEQ_TIMER_H
 
+#include <linux/hrtimer.h>
 #include <dkms/sound/timer.h>
 #include <dkms/sound/seq_kernel.h>
 
@@ -19,7 +20,8 @@ struct snd_seq_timer {
 	/* ... tempo / offset / running state */
 
 	unsigned int		running:1,	/* running state of queue */	
-				initialized:1;	/* timer is initialized */
+				initialized:1,	/* timer is initialized */
+				tickless:1;	/* driven by a one-shot hrtimer */
 
 	unsigned int		tempo;		/* current tempo, us/tick */
 	int			ppq;		/* time resolution, ticks/quarter */
@@ -39,6 +41,10 @@ struct snd_seq_timer {
 
 	struct timespec64	last_update;	 /* time of last clock update, used for interpolation */
 
+	/* tickless mode: fires at the next event due in the queue */
+	struct hrtimer		hrtimer;
+	struct snd_seq_queue	*queue;
+
 	spinlock_t lock;
 };
 
@@ -123,6 +129,7 @@ int snd_seq_timer_set_skew(struct snd_seq_timer *tmr, unsigned int skew, unsigne
 snd_seq_real_time_t snd_seq_timer_get_cur_time(struct snd_seq_timer *tmr,
 					       bool adjust_ktime);
 snd_seq_tick_time_t snd_seq_timer_get_cur_tick(struct snd_seq_timer *tmr);
+void snd_seq_timer_reprogram(struct snd_seq_queue *q);
 
 extern int seq_default_timer_class;
 extern int seq_default_timer_sclass;
@@ -130,5 +137,6 @@ extern int seq_default_timer_card;
 extern int seq_default_timer_device;
 extern int seq_default_timer_subdevice;
 extern int seq_default_timer_resolution;
+extern bool seq_default_timer_tickless;
 
 #endif
@@ -126,8 +126,8 @@ static void snd_vmidi_output_work(struct work_struct *work)
 {
 	struct snd_virmidi *vmidi;
 	struct snd_rawmidi_substream *substream;
-	unsigned char input;
-	int ret;
+	unsigned char buf[32];
+	int count, i, ret;
 
 	vmidi = container_of(work, struct snd_virmidi, output_work);
 	substream = vmidi->substream;
@@ -140,19 +140,26 @@ static void snd_vmidi_output_work(struct work_struct *work)
 	}
 
 	while (READ_ONCE(vmidi->trigger)) {
-		if (snd_rawmidi_transmit(substream, &input, 1) != 1)
+		/* take a chunk at once instead of locking the buffer per byte */
+		count = snd_rawmidi_transmit_peek(substream, buf, sizeof(buf));
+		if (count <= 0)
 			break;
-		if (!snd_midi_event_encode_byte(vmidi->parser, input,
-						&vmidi->event))
-			continue;
-		if (vmidi->event.type != SNDRV_SEQ_EVENT_NONE) {
+		for (i = 0; i < count; ) {
+			if (!snd_midi_event_encode_byte(vmidi->parser, buf[i++],
+							&vmidi->event))
+				continue;
+			if (vmidi->event.type == SNDRV_SEQ_EVENT_NONE)
+				continue;
 			ret = snd_seq_kernel_client_dispatch(vmidi->client,
 							     &vmidi->event,
 							     false, 0);
 			vmidi->event.type = SNDRV_SEQ_EVENT_NONE;
-			if (ret < 0)
-				break;
+			if (ret < 0) {
+				snd_rawmidi_transmit_ack(substream, i);
+				return;
+			}
 		}
+		snd_rawmidi_transmit_ack(substream, count);
 		/* rawmidi input might be huge, allow to have a break */
 		cond_resched();
 	}
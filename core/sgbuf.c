@@ -7,6 +7,7 @@
 
 #include <linux/slab.h>
 #include <linux/mm.h>
+#include <linux/log2.h>
 #include <linux/vmalloc.h>
 #include <linux/export.h>
 #include <asm/pgtable.h>
@@ -50,7 +51,14 @@ int snd_free_sgbuf_pages(struct snd_dma_buffer *dmab)
 	return 0;
 }
 
-#define MAX_ALLOC_PAGES		32
+/*
+ * The pages are allocated in chunks of the largest order available, up
+ * to MAX_ALLOC_PAGES, so that the buffer is made of few physically
+ * contiguous areas: the controllers need fewer descriptor entries and the
+ * mappings fewer TLB entries.  The chunk size is stored in the low bits
+ * of the head entry address, hence must stay below PAGE_SIZE.
+ */
+#define MAX_ALLOC_PAGES		512
 
 void *snd_malloc_sgbuf_pages(struct device *device,
 			     size_t size, struct snd_dma_buffer *dmab,
@@ -88,13 +96,14 @@ void *snd_malloc_sgbuf_pages(struct device *device,
 	sgbuf->page_table = pgtable;
 
 	/* allocate pages */
+	BUILD_BUG_ON(MAX_ALLOC_PAGES >= PAGE_SIZE);
 	maxpages = MAX_ALLOC_PAGES;
 	while (pages > 0) {
 		chunk = pages;
-		/* don't be too eager to take a huge chunk */
 		if (chunk > maxpages)
 			chunk = maxpages;
-		chunk <<= PAGE_SHIFT;
+		/* a whole order, not to waste the rounded up allocation */
+		chunk = rounddown_pow_of_two(chunk) << PAGE_SHIFT;
 		if (snd_dma_alloc_pages_fallback(type, device,
 						 chunk, &tmpb) < 0) {
 			if (!sgbuf->pages)
@@ -772,6 +772,26 @@ static void snd_timer_reschedule(struct snd_timer * timer, unsigned long ticks_l
 	timer->sticks = ticks;
 }
 
+/*
+ * queue the callback of an instance, the ack lists are kept sorted by
+ * priority and instances of equal priority are called in expiry order
+ */
+static void snd_timer_queue_ack(struct snd_timer_instance *ti,
+				struct list_head *head)
+{
+	struct snd_timer_instance *pos;
+
+	if (!list_empty(&ti->ack_list))
+		return;
+	list_for_each_entry_reverse(pos, head, ack_list) {
+		if (pos->priority <= ti->priority) {
+			list_add(&ti->ack_list, &pos->ack_list);
+			return;
+		}
+	}
+	list_add(&ti->ack_list, head);
+}
+
 /* call callbacks in timer ack list */
 static void snd_timer_process_callbacks(struct snd_timer *timer,
 					struct list_head *head)
@@ -813,12 +833,16 @@ static void snd_timer_clear_callbacks(struct snd_timer *timer,
 }
 
 /*
- * timer tasklet
+ * slow callbacks
  *
+ * They run from a high priority work, queued on the CPU which took the
+ * timer interrupt, rather than from a tasklet which is deferred to
+ * ksoftirqd as soon as the softirq load gets high.
  */
-static void snd_timer_tasklet(unsigned long arg)
+static void snd_timer_work(struct work_struct *work)
 {
-	struct snd_timer *timer = (struct snd_timer *) arg;
+	struct snd_timer *timer = container_of(work, struct snd_timer,
+					       task_work);
 	unsigned long flags;
 
 	if (timer->card && timer->card->shutdown) {
@@ -843,7 +867,7 @@ void snd_timer_interrupt(struct snd_timer * timer, unsigned long ticks_left)
 	unsigned long resolution;
 	struct list_head *ack_list_head;
 	unsigned long flags;
-	int use_tasklet = 0;
+	int use_work = 0;
 
 	if (timer == NULL)
 		return;
@@ -889,13 +913,11 @@ void snd_timer_interrupt(struct snd_timer * timer, unsigned long ticks_left)
 			ack_list_head = &timer->ack_list_head;
 		else
 			ack_list_head = &timer->sack_list_head;
-		if (list_empty(&ti->ack_list))
-			list_add_tail(&ti->ack_list, ack_list_head);
+		snd_timer_queue_ack(ti, ack_list_head);
 		list_for_each_entry(ts, &ti->slave_active_head, active_list) {
 			ts->pticks = ti->pticks;
 			ts->resolution = resolution;
-			if (list_empty(&ts->ack_list))
-				list_add_tail(&ts->ack_list, ack_list_head);
+			snd_timer_queue_ack(ts, ack_list_head);
 		}
 	}
 	if (timer->flags & SNDRV_TIMER_FLG_RESCHED)
@@ -919,11 +941,11 @@ void snd_timer_interrupt(struct snd_timer * timer, unsigned long ticks_left)
 	snd_timer_process_callbacks(timer, &timer->ack_list_head);
 
 	/* do we have any slow callbacks? */
-	use_tasklet = !list_empty(&timer->sack_list_head);
+	use_work = !list_empty(&timer->sack_list_head);
 	spin_unlock_irqrestore(&timer->lock, flags);
 
-	if (use_tasklet)
-		tasklet_schedule(&timer->task_queue);
+	if (use_work)
+		queue_work(system_highpri_wq, &timer->task_work);
 }
 EXPORT_SYMBOL(snd_timer_interrupt);
 
@@ -967,8 +989,7 @@ int snd_timer_new(struct snd_card *card, char *id, struct snd_timer_id *tid,
 	INIT_LIST_HEAD(&timer->ack_list_head);
 	INIT_LIST_HEAD(&timer->sack_list_head);
 	spin_lock_init(&timer->lock);
-	tasklet_init(&timer->task_queue, snd_timer_tasklet,
-		     (unsigned long)timer);
+	INIT_WORK(&timer->task_work, snd_timer_work);
 	timer->max_instances = 1000; /* default limit per timer */
 	if (card != NULL) {
 		timer->module = card->module;
@@ -1003,6 +1024,7 @@ static int snd_timer_free(struct snd_timer *timer)
 	list_del(&timer->device_list);
 	mutex_unlock(&register_mutex);
 
+	cancel_work_sync(&timer->task_work);
 	if (timer->private_free)
 		timer->private_free(timer);
 	kfree(timer);
@@ -147,37 +147,56 @@ static int slave_get_val(struct link_slave *slave,
 	return 0;
 }
 
+/* the value written to the slave for its own value val and the master_val */
+static long slave_apply_master(struct link_slave *slave, int master_val,
+			       long val)
+{
+	long vol;
+
+	switch (slave->info.type) {
+	case SNDRV_CTL_ELEM_TYPE_BOOLEAN:
+		return val & !!master_val;
+	case SNDRV_CTL_ELEM_TYPE_INTEGER:
+		/* max master volume is supposed to be 0 dB */
+		vol = val + master_val - slave->master->info.max_val;
+		if (vol < slave->info.min_val)
+			vol = slave->info.min_val;
+		else if (vol > slave->info.max_val)
+			vol = slave->info.max_val;
+		return vol;
+	}
+	return val;
+}
+
 static int slave_put_val(struct link_slave *slave,
 			 struct snd_ctl_elem_value *ucontrol)
 {
-	int err, ch, vol;
+	int err, ch;
 
 	err = master_init(slave->master);
 	if (err < 0)
 		return err;
 
-	switch (slave->info.type) {
-	case SNDRV_CTL_ELEM_TYPE_BOOLEAN:
-		for (ch = 0; ch < slave->info.count; ch++)
-			ucontrol->value.integer.value[ch] &=
-				!!slave->master->val;
-		break;
-	case SNDRV_CTL_ELEM_TYPE_INTEGER:
-		for (ch = 0; ch < slave->info.count; ch++) {
-			/* max master volume is supposed to be 0 dB */
-			vol = ucontrol->value.integer.value[ch];
-			vol += slave->master->val - slave->master->info.max_val;
-			if (vol < slave->info.min_val)
-				vol = slave->info.min_val;
-			else if (vol > slave->info.max_val)
-				vol = slave->info.max_val;
-			ucontrol->value.integer.value[ch] = vol;
-		}
-		break;
-	}
+	for (ch = 0; ch < slave->info.count; ch++)
+		ucontrol->value.integer.value[ch] =
+			slave_apply_master(slave, slave->master->val,
+					   ucontrol->value.integer.value[ch]);
 	return slave->slave.put(&slave->slave, ucontrol);
 }
 
+/* whether the value written to the slave differs between both master values */
+static bool slave_master_changed(struct link_slave *slave, int old_val,
+				 int new_val)
+{
+	int ch;
+
+	for (ch = 0; ch < slave->info.count; ch++)
+		if (slave_apply_master(slave, old_val, slave->vals[ch]) !=
+		    slave_apply_master(slave, new_val, slave->vals[ch]))
+			return true;
+	return false;
+}
+
 /*
  * ctl callbacks for slaves
  */
@@ -317,11 +336,19 @@ static int sync_slaves(struct link_master *master, int old_val, int new_val)
 	uval = kmalloc(sizeof(*uval), GFP_KERNEL);
 	if (!uval)
 		return -ENOMEM;
+	master->val = new_val;
 	list_for_each_entry(slave, &master->slaves, list) {
-		master->val = old_val;
 		uval->id = slave->slave.id;
-		slave_get_val(slave, uval);
-		master->val = new_val;
+		if (slave_get_val(slave, uval) < 0)
+			continue;
+		/*
+		 * Skip the slaves whose resulting value doesn't move, e.g.
+		 * clamped at their minimum, so that no bus write is issued
+		 * for them; a forced sync still writes all of them.
+		 */
+		if (old_val != new_val &&
+		    !slave_master_changed(slave, old_val, new_val))
+			continue;
 		slave_put_val(slave, uval);
 	}
 	kfree(uval);
@@ -100,7 +100,7 @@ void snd_hdac_stream_free_all(struct hdac_bus *bus)
 	list_for_each_entry_safe(s, _s, &bus->stream_list, list) {
 		stream = stream_to_hdac_ext_stream(s);
 		snd_hdac_ext_stream_decouple(bus, stream, false);
-		list_del(&s->list);
+		snd_hdac_stream_remove(s);
 		kfree(stream);
 	}
 }
@@ -285,34 +285,25 @@ hdac_ext_host_stream_assign(struct hdac_bus *bus,
 				struct snd_pcm_substream *substream)
 {
 	struct hdac_ext_stream *res = NULL;
-	struct hdac_stream *stream = NULL;
+	unsigned long free;
 
 	if (!bus->ppcap) {
 		dev_err(bus->dev, "stream type not supported\n");
 		return NULL;
 	}
 
-	list_for_each_entry(stream, &bus->stream_list, list) {
-		struct hdac_ext_stream *hstream = container_of(stream,
-						struct hdac_ext_stream,
-						hstream);
-		if (stream->direction != substream->stream)
-			continue;
-
-		if (!stream->opened) {
-			if (!hstream->decoupled)
-				snd_hdac_ext_stream_decouple(bus, hstream, true);
-			res = hstream;
-			break;
-		}
-	}
-	if (res) {
-		spin_lock_irq(&bus->reg_lock);
-		res->hstream.opened = 1;
+	spin_lock_irq(&bus->reg_lock);
+	free = bus->free_streams[substream->stream];
+	if (free) {
+		res = stream_to_hdac_ext_stream(bus->streams[__ffs(free)]);
+		snd_hdac_stream_set_opened(&res->hstream, true);
 		res->hstream.running = 0;
 		res->hstream.substream = substream;
-		spin_unlock_irq(&bus->reg_lock);
 	}
+	spin_unlock_irq(&bus->reg_lock);
+
+	if (res && !res->decoupled)
+		snd_hdac_ext_stream_decouple(bus, res, true);
 
 	return res;
 }
@@ -32,10 +32,12 @@ int snd_hdac_bus_init(struct hdac_bus *bus, struct device *dev,
 {
 	memset(bus, 0, sizeof(*bus));
 	bus->dev = dev;
-	if (ops)
+	if (ops) {
 		bus->ops = ops;
-	else
+	} else {
 		bus->ops = &default_ops;
+		bus->cmd_batch = true;
+	}
 	bus->dma_type = SNDRV_DMA_TYPE_DEV;
 	INIT_LIST_HEAD(&bus->stream_list);
 	INIT_LIST_HEAD(&bus->codec_list);
@@ -123,6 +125,172 @@ int snd_hdac_bus_exec_verb_unlocked(struct hdac_bus *bus, unsigned int addr,
 }
 EXPORT_SYMBOL_GPL(snd_hdac_bus_exec_verb_unlocked);
 
+/* wait for the responses of all codecs in @mask */
+static int bus_wait_responses(struct hdac_bus *bus, unsigned long mask)
+{
+	unsigned int addr;
+	int err;
+
+	for_each_set_bit(addr, &mask, HDA_MAX_CODECS) {
+		err = bus->ops->get_response(bus, addr, NULL);
+		if (err)
+			return err;
+	}
+	return 0;
+}
+
+/* mask of the codecs with responses still pending */
+static unsigned long bus_pending_responses(struct hdac_bus *bus)
+{
+	unsigned long mask = 0;
+	unsigned int addr;
+
+	spin_lock_irq(&bus->reg_lock);
+	for (addr = 0; addr < HDA_MAX_CODECS; addr++)
+		if (bus->rirb.cmds[addr])
+			mask |= BIT(addr);
+	spin_unlock_irq(&bus->reg_lock);
+	return mask;
+}
+
+/*
+ * queue up to HDAC_VERB_BATCH verbs in the CORB, then wait once for their
+ * responses; they are collected by snd_hdac_bus_update_rirb() in arrival
+ * order and matched back to the verbs by codec address, as each codec
+ * answers its verbs in order
+ */
+static int bus_exec_verb_batch(struct hdac_bus *bus, const unsigned int *cmds,
+			       unsigned int *res, unsigned int count)
+{
+	u32 batch_res[HDAC_VERB_BATCH];
+	u8 batch_addr[HDAC_VERB_BATCH];
+	u8 cursor[HDA_MAX_CODECS] = {};
+	unsigned long sent = 0;
+	unsigned int i, j, addr, len;
+	int err, ret;
+
+	/* responses of async verbs sent before can't be told apart */
+	err = bus_wait_responses(bus, bus_pending_responses(bus));
+	if (err)
+		return err;
+
+	spin_lock_irq(&bus->reg_lock);
+	bus->batch_res = batch_res;
+	bus->batch_addr = batch_addr;
+	bus->batch_len = 0;
+	bus->batch_size = count;
+	spin_unlock_irq(&bus->reg_lock);
+
+	for (i = 0; i < count; i++) {
+		if (cmds[i] == ~0)
+			continue;
+		trace_hda_send_cmd(bus, cmds[i]);
+		err = bus->ops->command(bus, cmds[i]);
+		if (err == -EAGAIN) {
+			/* CORB full, let the queued verbs through first */
+			err = bus_wait_responses(bus, bus_pending_responses(bus));
+			if (!err)
+				err = bus->ops->command(bus, cmds[i]);
+		}
+		if (err)
+			break;
+		sent |= BIT(cmds[i] >> 28);
+	}
+
+	ret = bus_wait_responses(bus, sent);
+	if (!err)
+		err = ret;
+
+	spin_lock_irq(&bus->reg_lock);
+	bus->batch_res = NULL;
+	bus->batch_addr = NULL;
+	len = bus->batch_len;
+	spin_unlock_irq(&bus->reg_lock);
+
+	if (!res)
+		return err;
+
+	for (i = 0; i < count; i++) {
+		res[i] = -1;
+		if (cmds[i] == ~0)
+			continue;
+		addr = cmds[i] >> 28;
+		for (j = cursor[addr]; j < len; j++)
+			if (batch_addr[j] == addr)
+				break;
+		if (j >= len) {
+			if (!err)
+				err = -EIO;
+			continue;
+		}
+		res[i] = batch_res[j];
+		cursor[addr] = j + 1;
+		trace_hda_get_response(bus, addr, res[i]);
+	}
+	return err;
+}
+
+/**
+ * snd_hdac_bus_exec_verbs_unlocked - unlocked version
+ * @bus: bus object
+ * @cmds: HD-audio encoded verbs, for one or more codecs
+ * @res: array to store the responses, NULL if not needed
+ * @count: number of verbs
+ *
+ * Returns 0 if successful, or a negative error code.
+ */
+int snd_hdac_bus_exec_verbs_unlocked(struct hdac_bus *bus,
+				     const unsigned int *cmds,
+				     unsigned int *res, unsigned int count)
+{
+	unsigned int i, n;
+	int err;
+
+	if (!bus->cmd_batch || bus->sync_write) {
+		for (i = 0; i < count; i++) {
+			err = snd_hdac_bus_exec_verb_unlocked(bus, cmds[i] >> 28,
+							      cmds[i],
+							      res ? &res[i] : NULL);
+			if (err)
+				return err;
+		}
+		return 0;
+	}
+
+	for (i = 0; i < count; i += n) {
+		n = min_t(unsigned int, count - i, HDAC_VERB_BATCH);
+		err = bus_exec_verb_batch(bus, cmds + i, res ? res + i : NULL, n);
+		if (err)
+			return err;
+	}
+	return 0;
+}
+EXPORT_SYMBOL_GPL(snd_hdac_bus_exec_verbs_unlocked);
+
+/**
+ * snd_hdac_bus_exec_verbs - execute several HD-audio verbs at once
+ * @bus: bus object
+ * @cmds: HD-audio encoded verbs, for one or more codecs
+ * @res: array to store the responses, NULL if not needed
+ * @count: number of verbs
+ *
+ * The verbs are queued together and the responses waited for once, when
+ * the controller allows it; otherwise they are executed one by one.
+ *
+ * Returns 0 if successful, or a negative error code.
+ */
+int snd_hdac_bus_exec_verbs(struct hdac_bus *bus, const unsigned int *cmds,
+			    unsigned int *res, unsigned int count)
+{
+	int err;
+
+	mutex_lock(&bus->cmd_mutex);
+	err = snd_hdac_bus_exec_verbs_unlocked(bus, cmds, res, count);
+	mutex_unlock(&bus->cmd_mutex);
+	return err;
+}
+EXPORT_SYMBOL_GPL(snd_hdac_bus_exec_verbs);
+
 /**
  * snd_hdac_bus_queue_event - add an unsolicited event to queue
  * @bus: the BUS
@@ -216,6 +216,10 @@ void snd_hdac_bus_update_rirb(struct hdac_bus *bus)
 			snd_hdac_bus_queue_event(bus, res, res_ex);
 		else if (bus->rirb.cmds[addr]) {
 			bus->rirb.res[addr] = res;
+			if (bus->batch_res && bus->batch_len < bus->batch_size) {
+				bus->batch_res[bus->batch_len] = res;
+				bus->batch_addr[bus->batch_len++] = addr;
+			}
 			bus->rirb.cmds[addr]--;
 			if (!bus->rirb.cmds[addr] &&
 			    waitqueue_active(&bus->rirb_wq))
@@ -10,6 +10,7 @@
 #include <linux/module.h>
 #include <linux/export.h>
 #include <linux/pm_runtime.h>
+#include <linux/sched.h>
 #include <dkms/sound/hdaudio.h>
 #include <dkms/sound/hda_regmap.h>
 #include <dkms/sound/pcm.h>
@@ -239,6 +240,187 @@ static unsigned int snd_hdac_make_cmd(struct hdac_device *codec, hda_nid_t nid,
 	return val;
 }
 
+/**
+ * snd_hdac_count_verb - account a verb in the codec statistics
+ * @codec: the codec object
+ * @cmd: encoded verb
+ */
+void snd_hdac_count_verb(struct hdac_device *codec, unsigned int cmd)
+{
+	unsigned int verb = (cmd >> 8) & 0xfff;
+	unsigned int idx;
+
+	if ((verb >> 8) == 0x7 || (verb >> 8) == 0xf)
+		idx = ((verb >> 3) & 0x100) | (verb & 0xff);
+	else
+		idx = 0x200 | (verb >> 8);
+	codec->stats.verbs[idx]++;
+	codec->stats.nid_verbs[(cmd >> 20) & 0x7f]++;
+}
+EXPORT_SYMBOL_GPL(snd_hdac_count_verb);
+
+static void snd_hdac_flush_verbs(struct hdac_device *codec);
+
+static int exec_verbs_now(struct hdac_device *codec, const unsigned int *cmds,
+			  unsigned int *res, unsigned int count)
+{
+	if (codec->exec_verbs)
+		return codec->exec_verbs(codec, cmds, res, count);
+	return snd_hdac_bus_exec_verbs(codec->bus, cmds, res, count);
+}
+
+/**
+ * snd_hdac_exec_verbs - execute several encoded verbs at once
+ * @codec: the codec object
+ * @cmds: encoded verbs to execute
+ * @res: array to store the results, NULL if not needed
+ * @count: number of verbs
+ *
+ * Returns zero if successful, or a negative error code.
+ *
+ * This calls the exec_verbs op when set in hdac_codec.  If not,
+ * call the default snd_hdac_bus_exec_verbs().  Between
+ * snd_hdac_batch_verbs_begin() and _end(), verbs without results are
+ * queued with the other writes instead.
+ */
+int snd_hdac_exec_verbs(struct hdac_device *codec, const unsigned int *cmds,
+			unsigned int *res, unsigned int count)
+{
+	unsigned int i;
+
+	if (READ_ONCE(codec->batch_owner) == current) {
+		/* writes join the queue, reads keep the order with it */
+		if (!res) {
+			for (i = 0; i < count; i++)
+				snd_hdac_exec_verb(codec, cmds[i], 0, NULL);
+			return 0;
+		}
+		snd_hdac_flush_verbs(codec);
+	}
+
+	for (i = 0; i < count; i++)
+		snd_hdac_count_verb(codec, cmds[i]);
+	return exec_verbs_now(codec, cmds, res, count);
+}
+EXPORT_SYMBOL_GPL(snd_hdac_exec_verbs);
+
+/*
+ * encode the verbs accessing the coefs @idx of @nid, the index verb being
+ * omitted when the codec increments it by itself; @data is the data verb
+ * of each coef, ORed with @vals when given.  Returns the number of verbs.
+ */
+static unsigned int make_coef_cmds(struct hdac_device *codec, hda_nid_t nid,
+				   const unsigned int *idx,
+				   const unsigned int *vals, unsigned int count,
+				   unsigned int data, unsigned int *cmds)
+{
+	unsigned int i, n = 0;
+
+	for (i = 0; i < count; i++) {
+		if (!i || !codec->coef_auto_inc || idx[i] != idx[i - 1] + 1)
+			cmds[n++] = snd_hdac_make_cmd(codec, nid,
+						      AC_VERB_SET_COEF_INDEX,
+						      idx[i]);
+		cmds[n++] = snd_hdac_make_cmd(codec, nid, data,
+					      vals ? vals[i] & 0xffff : 0);
+	}
+	return n;
+}
+
+/**
+ * snd_hdac_read_coefs - read several processing coefficients at once
+ * @codec: the codec object
+ * @nid: NID of the coefs
+ * @idx: indices of the coefs to read
+ * @vals: array to store the values
+ * @count: number of coefs
+ *
+ * The index and data verbs of all coefs are sent as a single batch.  When
+ * coef_auto_inc is set, the index verb is skipped for each coef following
+ * its predecessor.
+ *
+ * Returns zero if successful, or a negative error code.
+ */
+int snd_hdac_read_coefs(struct hdac_device *codec, hda_nid_t nid,
+			const unsigned int *idx, unsigned int *vals,
+			unsigned int count)
+{
+	unsigned int *cmds;
+	unsigned int i, n;
+	int err;
+
+	if (!count)
+		return 0;
+	cmds = kmalloc_array(count, 2 * sizeof(*cmds), GFP_KERNEL);
+	if (!cmds)
+		return -ENOMEM;
+
+	n = make_coef_cmds(codec, nid, idx, NULL, count,
+			   AC_VERB_GET_PROC_COEF, cmds);
+	err = snd_hdac_exec_verbs(codec, cmds, cmds, n);
+	if (!err) {
+		/* the response of each data verb follows its index verb */
+		for (i = count, n--; i-- > 0; n--) {
+			vals[i] = cmds[n];
+			if (!i || !codec->coef_auto_inc ||
+			    idx[i] != idx[i - 1] + 1)
+				n--;
+		}
+	}
+	kfree(cmds);
+	return err;
+}
+EXPORT_SYMBOL_GPL(snd_hdac_read_coefs);
+
+/**
+ * snd_hdac_write_coefs - write several processing coefficients at once
+ * @codec: the codec object
+ * @nid: NID of the coefs
+ * @idx: indices of the coefs to write
+ * @vals: values to write
+ * @count: number of coefs
+ *
+ * Like snd_hdac_read_coefs(), the verbs of all coefs are sent as a single
+ * batch, in the given order.
+ *
+ * Returns zero if successful, or a negative error code.
+ */
+int snd_hdac_write_coefs(struct hdac_device *codec, hda_nid_t nid,
+			 const unsigned int *idx, const unsigned int *vals,
+			 unsigned int count)
+{
+	unsigned int *cmds;
+	unsigned int n;
+	int err;
+
+	if (!count)
+		return 0;
+	cmds = kmalloc_array(count, 2 * sizeof(*cmds), GFP_KERNEL);
+	if (!cmds)
+		return -ENOMEM;
+
+	n = make_coef_cmds(codec, nid, idx, vals, count,
+			   AC_VERB_SET_PROC_COEF, cmds);
+	err = snd_hdac_exec_verbs(codec, cmds, NULL, n);
+	kfree(cmds);
+	return err;
+}
+EXPORT_SYMBOL_GPL(snd_hdac_write_coefs);
+
+/* send the verb writes queued since snd_hdac_batch_verbs_begin() */
+static void snd_hdac_flush_verbs(struct hdac_device *codec)
+{
+	unsigned int count = codec->batch_count;
+	int err;
+
+	if (!count)
+		return;
+	codec->batch_count = 0;
+	err = exec_verbs_now(codec, codec->batch_cmds, NULL, count);
+	if (err && !codec->batch_err)
+		codec->batch_err = err;
+}
+
 /**
  * snd_hdac_exec_verb - execute an encoded verb
  * @codec: the codec object
@@ -254,11 +436,65 @@ static unsigned int snd_hdac_make_cmd(struct hdac_device *codec, hda_nid_t nid,
 int snd_hdac_exec_verb(struct hdac_device *codec, unsigned int cmd,
 		       unsigned int flags, unsigned int *res)
 {
+	if (cmd != ~0)
+		snd_hdac_count_verb(codec, cmd);
+
+	if (READ_ONCE(codec->batch_owner) == current) {
+		if (!res && !flags && cmd != ~0) {
+			codec->batch_cmds[codec->batch_count++] = cmd;
+			if (codec->batch_count == HDAC_VERB_BATCH)
+				snd_hdac_flush_verbs(codec);
+			return 0;
+		}
+		/* keep the order with the queued writes */
+		snd_hdac_flush_verbs(codec);
+	}
+
 	if (codec->exec_verb)
 		return codec->exec_verb(codec, cmd, flags, res);
 	return snd_hdac_bus_exec_verb(codec->bus, codec->addr, cmd, res);
 }
 
+/**
+ * snd_hdac_batch_verbs_begin - start queuing the verb writes
+ * @codec: the codec object
+ *
+ * Until the matching snd_hdac_batch_verbs_end(), the verbs the calling
+ * task writes to the codec without reading a response are queued and sent
+ * HDAC_VERB_BATCH at a time.  A verb with a response sends the queue
+ * first.  The calls can be nested; if another task is batching already,
+ * the verbs are executed as usual.
+ */
+void snd_hdac_batch_verbs_begin(struct hdac_device *codec)
+{
+	if (READ_ONCE(codec->batch_owner) != current &&
+	    cmpxchg(&codec->batch_owner, NULL, current))
+		return;
+	codec->batch_depth++;
+}
+EXPORT_SYMBOL_GPL(snd_hdac_batch_verbs_begin);
+
+/**
+ * snd_hdac_batch_verbs_end - send the queued verb writes
+ * @codec: the codec object
+ *
+ * Returns the first error of the verbs queued since the outermost
+ * snd_hdac_batch_verbs_begin(), or zero.
+ */
+int snd_hdac_batch_verbs_end(struct hdac_device *codec)
+{
+	int err;
+
+	if (READ_ONCE(codec->batch_owner) != current || --codec->batch_depth)
+		return 0;
+	snd_hdac_flush_verbs(codec);
+	err = codec->batch_err;
+	codec->batch_err = 0;
+	WRITE_ONCE(codec->batch_owner, NULL);
+	return err;
+}
+EXPORT_SYMBOL_GPL(snd_hdac_batch_verbs_end);
+
 
 /**
  * snd_hdac_read - execute a verb
@@ -604,7 +840,7 @@ EXPORT_SYMBOL_GPL(snd_hdac_power_up_pm);
 
 /* like snd_hdac_power_up_pm(), but only increment the pm count when
  * already powered up.  Returns -1 if not powered up, 1 if incremented
- * or 0 if unchanged.  Only used in hdac_regmap.c
+ * or 0 if unchanged.  Used by hdac_regmap.c and the codec proc file.
  */
 int snd_hdac_keep_power_up(struct hdac_device *codec)
 {
@@ -617,6 +853,7 @@ int snd_hdac_keep_power_up(struct hdac_device *codec)
 	}
 	return 1;
 }
+EXPORT_SYMBOL_GPL(snd_hdac_keep_power_up);
 
 /**
  * snd_hdac_power_down_pm - power down the codec
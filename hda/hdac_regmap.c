@@ -157,17 +157,17 @@ static bool is_stereo_amp_verb(unsigned int reg)
 static int hda_reg_read_stereo_amp(struct hdac_device *codec,
 				   unsigned int reg, unsigned int *val)
 {
-	unsigned int left, right;
+	unsigned int verbs[2];
 	int err;
 
+	/* both channels are read with a single round trip */
 	reg &= ~(AC_AMP_SET_LEFT | AC_AMP_SET_RIGHT);
-	err = snd_hdac_exec_verb(codec, reg | AC_AMP_GET_LEFT, 0, &left);
+	verbs[0] = reg | AC_AMP_GET_LEFT;
+	verbs[1] = reg | AC_AMP_GET_RIGHT;
+	err = snd_hdac_exec_verbs(codec, verbs, verbs, 2);
 	if (err < 0)
 		return err;
-	err = snd_hdac_exec_verb(codec, reg | AC_AMP_GET_RIGHT, 0, &right);
-	if (err < 0)
-		return err;
-	*val = left | (right << 8);
+	*val = verbs[0] | (verbs[1] << 8);
 	return 0;
 }
 
@@ -175,8 +175,7 @@ static int hda_reg_read_stereo_amp(struct hdac_device *codec,
 static int hda_reg_write_stereo_amp(struct hdac_device *codec,
 				    unsigned int reg, unsigned int val)
 {
-	int err;
-	unsigned int verb, left, right;
+	unsigned int verb, left, right, verbs[2];
 
 	verb = AC_VERB_SET_AMP_GAIN_MUTE << 8;
 	if (reg & AC_AMP_GET_OUTPUT)
@@ -192,50 +191,43 @@ static int hda_reg_write_stereo_amp(struct hdac_device *codec,
 		return snd_hdac_exec_verb(codec, reg | left, 0, NULL);
 	}
 
-	err = snd_hdac_exec_verb(codec, reg | AC_AMP_SET_LEFT | left, 0, NULL);
-	if (err < 0)
-		return err;
-	err = snd_hdac_exec_verb(codec, reg | AC_AMP_SET_RIGHT | right, 0, NULL);
-	if (err < 0)
-		return err;
-	return 0;
+	verbs[0] = reg | AC_AMP_SET_LEFT | left;
+	verbs[1] = reg | AC_AMP_SET_RIGHT | right;
+	return snd_hdac_exec_verbs(codec, verbs, NULL, 2);
 }
 
 /* read a pseudo coef register (16bit) */
 static int hda_reg_read_coef(struct hdac_device *codec, unsigned int reg,
 			     unsigned int *val)
 {
-	unsigned int verb;
+	unsigned int verbs[2];
 	int err;
 
 	if (!codec->cache_coef)
 		return -EINVAL;
-	/* LSB 8bit = coef index */
-	verb = (reg & ~0xfff00) | (AC_VERB_SET_COEF_INDEX << 8);
-	err = snd_hdac_exec_verb(codec, verb, 0, NULL);
+	/* LSB 8bit = coef index; both verbs are sent at once */
+	verbs[0] = (reg & ~0xfff00) | (AC_VERB_SET_COEF_INDEX << 8);
+	verbs[1] = (reg & ~0xfffff) | (AC_VERB_GET_COEF_INDEX << 8);
+	err = snd_hdac_exec_verbs(codec, verbs, verbs, 2);
 	if (err < 0)
 		return err;
-	verb = (reg & ~0xfffff) | (AC_VERB_GET_COEF_INDEX << 8);
-	return snd_hdac_exec_verb(codec, verb, 0, val);
+	*val = verbs[1];
+	return 0;
 }
 
 /* write a pseudo coef register (16bit) */
 static int hda_reg_write_coef(struct hdac_device *codec, unsigned int reg,
 			      unsigned int val)
 {
-	unsigned int verb;
-	int err;
+	unsigned int verbs[2];
 
 	if (!codec->cache_coef)
 		return -EINVAL;
-	/* LSB 8bit = coef index */
-	verb = (reg & ~0xfff00) | (AC_VERB_SET_COEF_INDEX << 8);
-	err = snd_hdac_exec_verb(codec, verb, 0, NULL);
-	if (err < 0)
-		return err;
-	verb = (reg & ~0xfffff) | (AC_VERB_GET_COEF_INDEX << 8) |
+	/* LSB 8bit = coef index; both verbs are sent at once */
+	verbs[0] = (reg & ~0xfff00) | (AC_VERB_SET_COEF_INDEX << 8);
+	verbs[1] = (reg & ~0xfffff) | (AC_VERB_GET_COEF_INDEX << 8) |
 		(val & 0xffff);
-	return snd_hdac_exec_verb(codec, verb, 0, NULL);
+	return snd_hdac_exec_verbs(codec, verbs, NULL, 2);
 }
 
 static int hda_reg_read(void *context, unsigned int reg, unsigned int *val)
@@ -250,6 +242,7 @@ static int hda_reg_read(void *context, unsigned int reg, unsigned int *val)
 		if (pm_lock < 0)
 			return -EAGAIN;
 	}
+	codec->stats.regmap_hw_reads++;
 	reg |= (codec->addr << 28);
 	if (is_stereo_amp_verb(reg)) {
 		err = hda_reg_read_stereo_amp(codec, reg, val);
@@ -470,10 +463,13 @@ static int reg_raw_read(struct hdac_device *codec, unsigned int reg,
 	int err;
 
 	mutex_lock(&codec->regmap_lock);
-	if (uncached || !codec->regmap)
+	if (uncached || !codec->regmap) {
+		codec->stats.regmap_uncached++;
 		err = hda_reg_read(codec, reg, val);
-	else
+	} else {
+		codec->stats.regmap_reads++;
 		err = regmap_read(codec->regmap, reg, val);
+	}
 	mutex_unlock(&codec->regmap_lock);
 	return err;
 }
@@ -599,7 +595,9 @@ void snd_hdac_regmap_sync(struct hdac_device *codec)
 {
 	if (codec->regmap) {
 		mutex_lock(&codec->regmap_lock);
+		snd_hdac_batch_verbs_begin(codec);
 		regcache_sync(codec->regmap);
+		snd_hdac_batch_verbs_end(codec);
 		mutex_unlock(&codec->regmap_lock);
 	}
 }
@@ -7,6 +7,7 @@
 #include <linux/delay.h>
 #include <linux/export.h>
 #include <linux/clocksource.h>
+#include <linux/hash.h>
 #include <dkms/sound/core.h>
 #include <dkms/sound/pcm.h>
 #include <dkms/sound/hdaudio.h>
@@ -69,7 +70,7 @@ void snd_hdac_stream_init(struct hdac_bus *bus, struct hdac_stream *azx_dev,
 	azx_dev->direction = direction;
 	azx_dev->stream_tag = tag;
 	snd_hdac_dsp_lock_init(azx_dev);
-	list_add_tail(&azx_dev->list, &bus->stream_list);
+	snd_hdac_stream_add(bus, azx_dev);
 }
 EXPORT_SYMBOL_GPL(snd_hdac_stream_init);
 
@@ -83,6 +84,7 @@ EXPORT_SYMBOL_GPL(snd_hdac_stream_init);
 void snd_hdac_stream_start(struct hdac_stream *azx_dev, bool fresh_start)
 {
 	struct hdac_bus *bus = azx_dev->bus;
+	unsigned int int_mask = SD_INT_MASK;
 	int stripe_ctl;
 
 	trace_snd_hdac_stream_start(bus, azx_dev);
@@ -104,9 +106,15 @@ void snd_hdac_stream_start(struct hdac_stream *azx_dev, bool fresh_start)
 		snd_hdac_stream_updateb(azx_dev, SD_CTL_3B, SD_CTL_STRIPE_MASK,
 					stripe_ctl);
 	}
+	/*
+	 * without period wakeups, the stream is serviced from the PCM core
+	 * timer, so only the error interrupts are left enabled
+	 */
+	if (azx_dev->no_period_wakeup)
+		int_mask &= ~SD_INT_COMPLETE;
 	/* set DMA start and interrupt mask */
 	snd_hdac_stream_updateb(azx_dev, SD_CTL,
-				0, SD_CTL_DMA_START | SD_INT_MASK);
+				0, SD_CTL_DMA_START | int_mask);
 	azx_dev->running = true;
 }
 EXPORT_SYMBOL_GPL(snd_hdac_stream_start);
@@ -278,37 +286,50 @@ EXPORT_SYMBOL_GPL(snd_hdac_stream_cleanup);
  * The function tries to keep using the same stream object when it's used
  * beforehand.  Also, when bus->reverse_assign flag is set, the last free
  * or matching entry is returned.  This is needed for some strange codecs.
+ *
+ * The stream last assigned to the substream is remembered in a small key
+ * cache, so reopening the same substream does not need to look at the
+ * other streams.
  */
 struct hdac_stream *snd_hdac_stream_assign(struct hdac_bus *bus,
 					   struct snd_pcm_substream *substream)
 {
 	struct hdac_stream *azx_dev;
 	struct hdac_stream *res = NULL;
+	struct hdac_stream **slot;
+	unsigned long free;
+	int i;
 
 	/* make a non-zero unique key for the substream */
 	int key = (substream->pcm->device << 16) | (substream->number << 2) |
 		(substream->stream + 1);
 
-	list_for_each_entry(azx_dev, &bus->stream_list, list) {
-		if (azx_dev->direction != substream->stream)
-			continue;
-		if (azx_dev->opened)
-			continue;
-		if (azx_dev->assigned_key == key) {
-			res = azx_dev;
-			break;
+	slot = &bus->key_cache[hash_32(key, HDA_STREAM_KEY_BITS)];
+
+	spin_lock_irq(&bus->reg_lock);
+	/* the key holds the direction, a match is a stream of ours */
+	if (*slot && !(*slot)->opened && (*slot)->assigned_key == key) {
+		res = *slot;
+	} else {
+		free = bus->free_streams[substream->stream];
+		for_each_set_bit(i, &free, HDA_MAX_STREAMS) {
+			azx_dev = bus->streams[i];
+			if (azx_dev->assigned_key == key) {
+				res = azx_dev;
+				break;
+			}
+			if (!res || bus->reverse_assign)
+				res = azx_dev;
 		}
-		if (!res || bus->reverse_assign)
-			res = azx_dev;
 	}
 	if (res) {
-		spin_lock_irq(&bus->reg_lock);
-		res->opened = 1;
+		snd_hdac_stream_set_opened(res, true);
 		res->running = 0;
 		res->assigned_key = key;
 		res->substream = substream;
-		spin_unlock_irq(&bus->reg_lock);
+		*slot = res;
 	}
+	spin_unlock_irq(&bus->reg_lock);
 	return res;
 }
 EXPORT_SYMBOL_GPL(snd_hdac_stream_assign);
@@ -324,7 +345,7 @@ void snd_hdac_stream_release(struct hdac_stream *azx_dev)
 	struct hdac_bus *bus = azx_dev->bus;
 
 	spin_lock_irq(&bus->reg_lock);
-	azx_dev->opened = 0;
+	snd_hdac_stream_set_opened(azx_dev, false);
 	azx_dev->running = 0;
 	azx_dev->substream = NULL;
 	spin_unlock_irq(&bus->reg_lock);
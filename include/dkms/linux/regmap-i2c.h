@@ -0,0 +1,10 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+
+#ifndef __REGMAP_I2C_H
+#define __REGMAP_I2C_H
+
+#include <linux/regmap.h>
+
+int regmap_i2c_set_combined_write(struct regmap *map, bool enable);
+
+#endif /* __REGMAP_I2C_H */
@@ -0,0 +1,11 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+
+#ifndef __REGMAP_MMIO_H
+#define __REGMAP_MMIO_H
+
+#include <linux/regmap.h>
+
+int regmap_mmio_set_relaxed(struct regmap *map, bool relaxed);
+void regmap_mmio_barrier(struct regmap *map);
+
+#endif /* __REGMAP_MMIO_H */
@@ -0,0 +1,62 @@
+/* SPDX-License-Identifier: GPL-2.0-only */
+/* Copyright(c) 2020 Intel Corporation. */
+
+#ifndef __REGMAP_SDW_MBQ_H
+#define __REGMAP_SDW_MBQ_H
+
+#include <linux/regmap.h>
+
+struct sdw_slave;
+
+/**
+ * struct regmap_sdw_mbq_cfg - SoundWire Multi-Byte Quantity layout
+ *
+ * @lsb_reg: returns the address of the LSB register for the 16-bit
+ * quantity whose MSB is at @reg. The MSB is always written first.
+ */
+struct regmap_sdw_mbq_cfg {
+	unsigned int (*lsb_reg)(unsigned int reg);
+};
+
+struct regmap *__regmap_init_sdw_mbq(struct sdw_slave *sdw,
+				     const struct regmap_config *config,
+				     const struct regmap_sdw_mbq_cfg *mbq_cfg,
+				     struct lock_class_key *lock_key,
+				     const char *lock_name);
+struct regmap *__devm_regmap_init_sdw_mbq(struct sdw_slave *sdw,
+					  const struct regmap_config *config,
+					  const struct regmap_sdw_mbq_cfg *mbq_cfg,
+					  struct lock_class_key *lock_key,
+					  const char *lock_name);
+
+/**
+ * regmap_init_sdw_mbq() - Initialise register map for MBQ registers
+ *
+ * @sdw: Device that will be interacted with
+ * @config: Configuration for register map
+ * @mbq_cfg: MBQ register layout
+ *
+ * The return value will be an ERR_PTR() on error or a valid pointer to
+ * a struct regmap.
+ */
+#define regmap_init_sdw_mbq(sdw, config, mbq_cfg)			\
+	__regmap_lockdep_wrapper(__regmap_init_sdw_mbq, #config,	\
+				sdw, config, mbq_cfg)
+
+/**
+ * devm_regmap_init_sdw_mbq() - Initialise managed register map for MBQ
+ * registers
+ *
+ * @sdw: Device that will be interacted with
+ * @config: Configuration for register map
+ * @mbq_cfg: MBQ register layout
+ *
+ * The return value will be an ERR_PTR() on error or a valid pointer
+ * to a struct regmap. The regmap will be automatically freed by the
+ * device management code.
+ */
+#define devm_regmap_init_sdw_mbq(sdw, config, mbq_cfg)			\
+	__regmap_lockdep_wrapper(__devm_regmap_init_sdw_mbq, #config,	\
+				sdw, config, mbq_cfg)
+
+#endif /* __REGMAP_SDW_MBQ_H */
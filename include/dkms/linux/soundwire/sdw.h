@@ -38,7 +38,10 @@ struct sdw_slave;
 #define SDW_FRAME_CTRL_BITS		48
 #define SDW_MAX_DEVICES			11
 
+#define SDW_MAX_LANES			8
+
 #define SDW_VALID_PORT_RANGE(n)		((n) <= 14 && (n) >= 1)
+#define SDW_MAX_PORTS			15
 
 enum {
 	SDW_PORT_DIRN_SINK = 0,
@@ -128,12 +131,15 @@ enum sdw_dpn_grouping {
  *
  * @SDW_STREAM_PCM: PCM data stream
  * @SDW_STREAM_PDM: PDM data stream
+ * @SDW_STREAM_BPT: Bulk Payload Transport stream, carries Bulk Register
+ * Access packets on the Slave Data Port 0
  *
  * spec doesn't define this, but is used in implementation
  */
 enum sdw_stream_type {
 	SDW_STREAM_PCM = 0,
 	SDW_STREAM_PDM = 1,
+	SDW_STREAM_BPT = 2,
 };
 
 /**
@@ -301,6 +307,9 @@ struct sdw_dpn_audio_mode {
  * @block_pack_mode: Type of block port mode supported
  * @read_only_wordlength: Read Only wordlength field in DPN_BlockCtrl1 register
  * @port_encoding: Payload Channel Sample encoding schemes supported
+ * @lanes: Bitmap, bit N set when the port can use data lane N. Lane 0
+ * is always supported, other lanes require @lane_control_support in
+ * the Slave properties
  * @audio_modes: Audio modes supported
  */
 struct sdw_dpn_prop {
@@ -325,6 +334,7 @@ struct sdw_dpn_prop {
 	bool block_pack_mode;
 	bool read_only_wordlength;
 	u32 port_encoding;
+	u32 lanes;
 	struct sdw_dpn_audio_mode *audio_modes;
 };
 
@@ -344,6 +354,8 @@ struct sdw_dpn_prop {
  * @high_PHY_capable: Slave is HighPHY capable
  * @paging_support: Slave implements paging registers SCP_AddrPage1 and
  * SCP_AddrPage2
+ * @sticky_page: Slave tolerates SCP_AddrPage1/2 being left programmed
+ * between paged accesses, the bus then only writes them on page changes
  * @bank_delay_support: Slave implements bank delay/bridge support registers
  * SCP_BankDelay and SCP_NextFrame
  * @p15_behave: Slave behavior when the Master attempts a read to the Port15
@@ -355,6 +367,11 @@ struct sdw_dpn_prop {
  * @dp0_prop: Data Port 0 properties
  * @src_dpn_prop: Source Data Port N properties
  * @sink_dpn_prop: Sink Data Port N properties
+ * @dp0_dpn_prop: Data Port 0 properties in Data Port N form, filled by the
+ * bus when Data Port 0 is used by a BPT stream
+ * @clk_stop_lost_regs: registers not retained in Clock Stop Mode 0, saved
+ * by the bus before stopping the clock and restored on exit
+ * @num_clk_stop_lost_regs: number of entries in @clk_stop_lost_regs
  */
 struct sdw_slave_prop {
 	u32 mipi_revision;
@@ -367,6 +384,7 @@ struct sdw_slave_prop {
 	enum sdw_clk_stop_reset_behave reset_behave;
 	bool high_PHY_capable;
 	bool paging_support;
+	bool sticky_page;
 	bool bank_delay_support;
 	enum sdw_p15_behave p15_behave;
 	bool lane_control_support;
@@ -376,6 +394,9 @@ struct sdw_slave_prop {
 	struct sdw_dp0_prop *dp0_prop;
 	struct sdw_dpn_prop *src_dpn_prop;
 	struct sdw_dpn_prop *sink_dpn_prop;
+	struct sdw_dpn_prop dp0_dpn_prop;
+	const u32 *clk_stop_lost_regs;
+	u32 num_clk_stop_lost_regs;
 };
 
 /**
@@ -395,6 +416,8 @@ struct sdw_slave_prop {
  * command
  * @mclk_freq: clock reference passed to SoundWire Master, in Hz.
  * @hw_disabled: if true, the Master is not functional, typically due to pin-mux
+ * @num_lanes: Number of data lanes of the Master, including lane 0. Zero
+ * is handled as a single lane
  */
 struct sdw_master_prop {
 	u32 revision;
@@ -411,6 +434,7 @@ struct sdw_master_prop {
 	u32 err_threshold;
 	u32 mclk_freq;
 	bool hw_disabled;
+	u32 num_lanes;
 };
 
 int sdw_master_read_prop(struct sdw_bus *bus);
@@ -552,6 +576,84 @@ struct sdw_bus_params {
 	unsigned int row;
 };
 
+/**
+ * struct sdw_frame_shape - frame shape available on the bus
+ *
+ * @clk_freq: Double rate clock frequency, in Hz
+ * @bandwidth: Bandwidth left for payload once the control bits are
+ * accounted for, in bits per second
+ * @row: Number of rows
+ * @col: Number of columns
+ */
+struct sdw_frame_shape {
+	unsigned int clk_freq;
+	unsigned int bandwidth;
+	u16 row;
+	u16 col;
+};
+
+/**
+ * struct sdw_rt_pool - free stream runtimes of a bus
+ *
+ * @m_rt: Master runtimes
+ * @s_rt: Slave runtimes
+ * @p_rt: port runtimes
+ */
+struct sdw_rt_pool {
+	struct list_head m_rt;
+	struct list_head s_rt;
+	struct list_head p_rt;
+};
+
+#define SDW_BW_CACHE_GROUPS	4
+
+/**
+ * struct sdw_bw_cache - last result of the bandwidth allocation
+ *
+ * @valid: cache contains a result
+ * @bandwidth: total bandwidth of the streams
+ * @count: number of sample rate groups
+ * @rate: sample rate of each group
+ * @payload: payload bits per sample of each group
+ * @curr_dr_freq: selected double rate clock frequency
+ * @row: selected number of rows
+ * @col: selected number of columns
+ */
+struct sdw_bw_cache {
+	bool valid;
+	unsigned int bandwidth;
+	int count;
+	unsigned int rate[SDW_BW_CACHE_GROUPS];
+	int payload[SDW_BW_CACHE_GROUPS];
+	unsigned int curr_dr_freq;
+	unsigned int row;
+	unsigned int col;
+};
+
+#define SDW_BANK_SWITCH_HIST	8
+
+/**
+ * struct sdw_bus_stats - bus statistics
+ *
+ * @cmds: commands issued
+ * @retries: commands issued again after a failure, up to err_threshold
+ * @ignored: commands answered with IGNORED
+ * @failed: commands NAKed, timed out or aborted
+ * @page_resets: SCP_AddrPage resets
+ * @bank_switches: successful bank switches
+ * @bank_switch_hist: bank switch latency histogram, bucket i counts the
+ * switches taking less than 100us << i, the last bucket counts the others
+ */
+struct sdw_bus_stats {
+	u64 cmds;
+	u64 retries;
+	u64 ignored;
+	u64 failed;
+	u64 page_resets;
+	u64 bank_switches;
+	u64 bank_switch_hist[SDW_BANK_SWITCH_HIST];
+};
+
 /**
  * struct sdw_slave_ops: Slave driver callback ops
  *
@@ -607,6 +709,15 @@ struct sdw_slave_ops {
  * between the Master suspending and the codec resuming, and make sure that
  * when the Master triggered a reset the Slave is properly enumerated and
  * initialized
+ * @attach_work: work used to initialize the Slave once it is attached,
+ * so that several Slaves can be initialized in parallel
+ * @clk_stop_ctx: values of the prop.clk_stop_lost_regs registers, saved
+ * when preparing for Clock Stop Mode 0
+ * @rt_reserved: the bus runtime pools were filled for this Slave
+ * @disco_prop: firmware properties parsed by sdw_slave_read_prop(), kept
+ * across driver rebinds
+ * @dpn_prop_map: Data Port properties indexed by direction and port
+ * number, built when the Slave is probed
  */
 struct sdw_slave {
 	struct sdw_slave_id id;
@@ -628,6 +739,11 @@ struct sdw_slave {
 	struct completion enumeration_complete;
 	struct completion initialization_complete;
 	u32 unattach_request;
+	struct work_struct attach_work;
+	u8 *clk_stop_ctx;
+	bool rt_reserved;
+	struct sdw_slave_prop *disco_prop;
+	struct sdw_dpn_prop *dpn_prop_map[SDW_DATA_DIR_TX + 1][SDW_MAX_PORTS];
 };
 
 #define dev_to_sdw_dev(_dev) container_of(_dev, struct sdw_slave, dev)
@@ -732,8 +848,7 @@ struct sdw_port_params {
  * @hstart: Horizontal start of the payload data
  * @hstop: Horizontal stop of the payload data
  * @blk_pkg_mode: Block per channel or block per port
- * @lane_ctrl: Data lane Port uses for Data transfer. Currently only single
- * data lane is supported in bus
+ * @lane_ctrl: Data lane Port uses for Data transfer
  *
  * This is used to program the Data Port based on Data Port transport
  * parameters. All these parameters are banked and can be modified
@@ -803,21 +918,52 @@ struct sdw_defer {
 	struct sdw_msg *msg;
 };
 
+/*
+ * Bulk Payload Transport is only worth setting up a data stream for large
+ * transfers, shorter ones use the command path
+ */
+#define SDW_BPT_MIN_LEN		64
+
+/**
+ * struct sdw_bpt_msg - Bulk Payload Transport message
+ * @addr: first register address, BRA addresses are 32-bit so no paging
+ * is involved
+ * @len: number of registers
+ * @dev_num: Slave device number
+ * @flags: SDW_MSG_FLAG_READ or SDW_MSG_FLAG_WRITE
+ * @buf: values to be written, or buffer for the values read
+ */
+struct sdw_bpt_msg {
+	u32 addr;
+	size_t len;
+	u16 dev_num;
+	u8 flags;
+	u8 *buf;
+};
+
 /**
  * struct sdw_master_ops - Master driver ops
  * @read_prop: Read Master properties
  * @xfer_msg: Transfer message callback
+ * @xfer_msg_batch: Transfer an array of messages with as few completion
+ * waits as possible. The Master programs the SCP page address registers
+ * for messages with page set, resetting them is done by the bus (optional)
  * @xfer_msg_defer: Defer version of transfer message callback
  * @reset_page_addr: Reset the SCP page address registers
  * @set_bus_conf: Set the bus configuration
  * @pre_bank_switch: Callback for pre bank switch
  * @post_bank_switch: Callback for post bank switch
+ * @bpt_xfer: Transfer a Bulk Payload Transport message over a data port
+ * of the Master and Data Port 0 of the Slave (optional). Return
+ * -EOPNOTSUPP to let the bus fall back to the command path
  */
 struct sdw_master_ops {
 	int (*read_prop)(struct sdw_bus *bus);
 
 	enum sdw_command_response (*xfer_msg)
 			(struct sdw_bus *bus, struct sdw_msg *msg);
+	enum sdw_command_response (*xfer_msg_batch)
+			(struct sdw_bus *bus, struct sdw_msg *msgs, int num);
 	enum sdw_command_response (*xfer_msg_defer)
 			(struct sdw_bus *bus, struct sdw_msg *msg,
 			struct sdw_defer *defer);
@@ -827,6 +973,8 @@ struct sdw_master_ops {
 			struct sdw_bus_params *params);
 	int (*pre_bank_switch)(struct sdw_bus *bus);
 	int (*post_bank_switch)(struct sdw_bus *bus);
+	int (*bpt_xfer)(struct sdw_bus *bus, struct sdw_slave *slave,
+			struct sdw_bpt_msg *msg);
 
 };
 
@@ -837,8 +985,13 @@ struct sdw_master_ops {
  * @slaves: list of Slaves on this bus
  * @assigned: Bitmap for Slave device numbers.
  * Bit set implies used number, bit clear implies unused number.
- * @bus_lock: bus lock
- * @msg_lock: message lock
+ * @bus_lock: protects the stream and bus parameters, held across stream
+ * state changes
+ * @msg_lock: protects the command channel, held for single transfers or
+ * batches and across the deferred bank switch of multi-link streams
+ * @slave_lock: protects @slaves, @assigned and the status of the Slaves,
+ * so that Slave enumeration and alerts don't wait for stream operations.
+ * Locks are taken in the bus_lock, slave_lock, msg_lock order
  * @compute_params: points to Bus resource management implementation
  * @ops: Master callback ops
  * @port_ops: Master port callback ops
@@ -849,6 +1002,8 @@ struct sdw_master_ops {
  * transport and port parameters
  * @debugfs: Bus debugfs
  * @defer_msg: Defer message
+ * @bank_switch_msg: FrameCtrl write of the bank switch, allocated once
+ * @bank_switch_buf: FrameCtrl value written by @bank_switch_msg
  * @clk_stop_timeout: Clock stop timeout computed
  * @bank_switch_timeout: Bank switch timeout computed
  * @multi_link: Store bus property that indicates if multi links
@@ -859,6 +1014,25 @@ struct sdw_master_ops {
  * meaningful if multi_link is set. If set to 1, hardware-based
  * synchronization will be used even if a stream only uses a single
  * SoundWire segment.
+ * @page_cache: last SCP_AddrPage1/2 value programmed for each device
+ * number, SDW_PAGE_INVALID if unknown. Protected by msg_lock
+ * @async_list: queue of pending asynchronous transfers
+ * @async_lock: protects @async_list
+ * @async_work: drains @async_list
+ * @frame_shapes: all clock frequency and frame shape combinations
+ * supported by the Master, sorted by increasing clock frequency with
+ * the default frame shape first for each frequency
+ * @num_frame_shapes: number of entries in @frame_shapes
+ * @bw_cache: last bandwidth allocation result, used to skip the search
+ * when the same set of streams is prepared again
+ * @stats: command and bank switch statistics, exposed in debugfs
+ * @no_fw_slaves: Slaves are not described in firmware, the Master driver
+ * adds them with sdw_bus_add_slave()
+ * @slave_ctx_retained: the Slaves exited clock stop without bus reset and
+ * kept their context, including the Data Port banks
+ * @rt_pool: free stream runtimes, protected by bus_lock
+ * @ctx_gen: incremented each time the Master or a Slave may have lost the
+ * stream configuration, see sdw_bus_ctx_lost()
  */
 struct sdw_bus {
 	struct device *dev;
@@ -867,6 +1041,7 @@ struct sdw_bus {
 	DECLARE_BITMAP(assigned, SDW_MAX_DEVICES);
 	struct mutex bus_lock;
 	struct mutex msg_lock;
+	struct mutex slave_lock;
 	int (*compute_params)(struct sdw_bus *bus);
 	const struct sdw_master_ops *ops;
 	const struct sdw_master_port_ops *port_ops;
@@ -877,14 +1052,29 @@ struct sdw_bus {
 	struct dentry *debugfs;
 #endif
 	struct sdw_defer defer_msg;
+	struct sdw_msg *bank_switch_msg;
+	u8 bank_switch_buf;
 	unsigned int clk_stop_timeout;
 	u32 bank_switch_timeout;
 	bool multi_link;
 	int hw_sync_min_links;
+	int page_cache[SDW_MAX_DEVICES + 1];
+	struct list_head async_list;
+	spinlock_t async_lock;
+	struct work_struct async_work;
+	struct sdw_frame_shape *frame_shapes;
+	int num_frame_shapes;
+	struct sdw_bw_cache bw_cache;
+	struct sdw_bus_stats stats;
+	bool no_fw_slaves;
+	bool slave_ctx_retained;
+	struct sdw_rt_pool rt_pool;
+	unsigned int ctx_gen;
 };
 
 int sdw_add_bus_master(struct sdw_bus *bus);
 void sdw_delete_bus_master(struct sdw_bus *bus);
+int sdw_bus_add_slave(struct sdw_bus *bus, struct sdw_slave_id *id);
 
 /**
  * sdw_master_device_add() - create a Linux Master Device representation.
@@ -1021,6 +1211,7 @@ int sdw_stream_remove_slave(struct sdw_slave *slave,
 		struct sdw_stream_runtime *stream);
 int sdw_startup_stream(void *sdw_substream);
 int sdw_prepare_stream(struct sdw_stream_runtime *stream);
+bool sdw_stream_ctx_retained(struct sdw_stream_runtime *stream);
 int sdw_enable_stream(struct sdw_stream_runtime *stream);
 int sdw_disable_stream(struct sdw_stream_runtime *stream);
 int sdw_deprepare_stream(struct sdw_stream_runtime *stream);
@@ -1028,12 +1219,54 @@ void sdw_shutdown_stream(void *sdw_substream);
 int sdw_bus_prep_clk_stop(struct sdw_bus *bus);
 int sdw_bus_clk_stop(struct sdw_bus *bus);
 int sdw_bus_exit_clk_stop(struct sdw_bus *bus);
+bool sdw_bus_clk_stop_retains_ctx(struct sdw_bus *bus);
+void sdw_bus_ctx_lost(struct sdw_bus *bus);
 
 /* messaging and data APIs */
 
+/**
+ * struct sdw_slave_xfer - contiguous register access in a batch
+ *
+ * @addr: first register address
+ * @count: number of registers
+ * @buf: values to be written, or buffer for the values read
+ * @read: read access if true, write otherwise
+ */
+struct sdw_slave_xfer {
+	u32 addr;
+	size_t count;
+	u8 *buf;
+	bool read;
+};
+
+/**
+ * struct sdw_async_xfer - asynchronous Slave access
+ *
+ * @xfer: register access, the buffer must remain valid until completion
+ * @complete: called from process context once the access is done, with
+ * 0 or a negative error code
+ * @context: caller private data
+ * @slave: Slave accessed, set by the bus
+ * @node: sdw_bus async_list node
+ */
+struct sdw_async_xfer {
+	struct sdw_slave_xfer xfer;
+	void (*complete)(struct sdw_async_xfer *async, int ret);
+	void *context;
+	struct sdw_slave *slave;
+	struct list_head node;
+};
+
 int sdw_read(struct sdw_slave *slave, u32 addr);
 int sdw_write(struct sdw_slave *slave, u32 addr, u8 value);
 int sdw_nread(struct sdw_slave *slave, u32 addr, size_t count, u8 *val);
 int sdw_nwrite(struct sdw_slave *slave, u32 addr, size_t count, u8 *val);
+int sdw_xfer_batch(struct sdw_slave *slave, struct sdw_slave_xfer *xfers,
+		   int num);
+int sdw_group_write(struct sdw_slave **slaves, int num,
+		    struct sdw_slave_xfer *xfers, int num_xfers, bool verify);
+int sdw_xfer_async(struct sdw_slave *slave, struct sdw_async_xfer *async);
+int sdw_bpt_xfer(struct sdw_slave *slave, struct sdw_bpt_msg *msg);
+void sdw_xfer_async_flush(struct sdw_slave *slave);
 
 #endif /* __SOUNDWIRE_H */
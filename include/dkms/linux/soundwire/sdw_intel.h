@@ -31,15 +31,42 @@ struct sdw_intel_stream_free_data {
 	int link_id;
 };
 
+/**
+ * struct sdw_intel_bpt_data: Bulk Payload Transport DMA request
+ *
+ * @link_id: link on which the transfer is done
+ * @tx_alh_id: ALH stream of PDI0, data sent by the Master
+ * @rx_alh_id: ALH stream of PDI1, data driven by the Slave
+ * @tx: data to be sent
+ * @tx_len: size of @tx, a multiple of 32 bits
+ * @rx: buffer for the data received
+ * @rx_len: size of @rx, a multiple of 32 bits
+ */
+struct sdw_intel_bpt_data {
+	int link_id;
+	int tx_alh_id;
+	int rx_alh_id;
+	const u8 *tx;
+	size_t tx_len;
+	u8 *rx;
+	size_t rx_len;
+};
+
 /**
  * struct sdw_intel_ops: Intel audio driver callback ops
  *
+ * @params_stream: set up the DMA of an audio stream
+ * @free_stream: release the DMA of an audio stream
+ * @bpt_xfer: run the DMA of a Bulk transfer, the SoundWire stream is
+ * enabled when called (optional)
  */
 struct sdw_intel_ops {
 	int (*params_stream)(struct device *dev,
 			     struct sdw_intel_stream_params_data *params_data);
 	int (*free_stream)(struct device *dev,
 			   struct sdw_intel_stream_free_data *free_data);
+	int (*bpt_xfer)(struct device *dev,
+			struct sdw_intel_bpt_data *data);
 };
 
 /**
@@ -94,6 +121,14 @@ struct sdw_intel_link_res;
  */
 #define SDW_INTEL_CLK_STOP_BUS_RESET		BIT(3)
 
+/*
+ * With SDW_INTEL_CLK_STOP_BUS_RESET, skip the bus reset when all the
+ * Slaves were in Clock Stop Mode 0: they keep their Device Number and
+ * Data Port configuration, only the registers they declare as lost are
+ * restored, and only the controller is re-initialized.
+ */
+#define SDW_INTEL_CLK_STOP_FAST_EXIT		BIT(4)
+
 struct sdw_intel_slave_id {
 	int link_id;
 	struct sdw_slave_id id;
@@ -54,6 +54,8 @@ struct snd_compr_runtime {
 	dma_addr_t dma_addr;
 	size_t dma_bytes;
 	struct snd_dma_buffer *dma_buffer_p;
+
+	struct snd_compr_mmap_control *control;	/* mmapped positions */
 };
 
 /**
@@ -8,6 +8,7 @@
  */
 
 #include <linux/wait.h>
+#include <linux/hashtable.h>
 #include <linux/nospec.h>
 #include <dkms/sound/asound.h>
 
@@ -81,12 +82,14 @@ struct snd_kcontrol {
 #define snd_kcontrol(n) list_entry(n, struct snd_kcontrol, list)
 
 struct snd_kctl_event {
-	struct list_head list;	/* list of events */
+	struct hlist_node node;	/* entry of the numid hash */
 	struct snd_ctl_elem_id id;
 	unsigned int mask;
 };
 
-#define snd_kctl_event(n) list_entry(n, struct snd_kctl_event, list)
+/* size of the event ring of each control file */
+#define SND_CTL_EVENT_RING	256
+#define SND_CTL_EVENT_HASH_BITS	6
 
 struct pid;
 
@@ -105,7 +108,11 @@ struct snd_ctl_file {
 	spinlock_t read_lock;
 	struct fasync_struct *fasync;
 	int subscribed;			/* read interface is activated */
-	struct list_head events;	/* waiting events for read */
+	struct snd_kctl_event *events;	/* ring of waiting events for read */
+	unsigned int event_head;	/* oldest waiting event */
+	unsigned int event_count;	/* number of waiting events */
+	bool event_overflow;		/* events were lost since last read */
+	DECLARE_HASHTABLE(event_hash, SND_CTL_EVENT_HASH_BITS);
 };
 
 #define snd_ctl_file(n) list_entry(n, struct snd_ctl_file, list)
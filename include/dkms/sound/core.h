@@ -14,6 +14,7 @@
 #include <linux/pm.h>			/* pm_message_t */
 #include <linux/stringify.h>
 #include <linux/printk.h>
+#include <linux/xarray.h>
 
 /* number of supported soundcards */
 #ifdef CONFIG_SND_DYNAMIC_MINORS
@@ -103,6 +104,11 @@ struct snd_card {
 	int user_ctl_count;		/* count of all user controls */
 	struct list_head controls;	/* all controls for this card */
 	struct list_head ctl_files;	/* active control files */
+#ifdef CONFIG_SND_CTL_FAST_LOOKUP
+	struct xarray ctl_numids;	/* hash table for control IDs */
+	struct xarray ctl_hash;		/* hash table for ctl id matching */
+	bool ctl_hash_collision;	/* ctl_hash collision seen? */
+#endif
 
 	struct snd_info_entry *proc_root;	/* root for soundcard specific files */
 	struct proc_dir_entry *proc_root_link;	/* number link to real id */
@@ -121,6 +127,8 @@ struct snd_card {
 	wait_queue_head_t remove_sleep;
 
 	size_t total_pcm_alloc_bytes;	/* total amount of allocated buffers */
+	struct list_head pcm_pool;	/* released buffers kept for reuse */
+	size_t pcm_pool_bytes;		/* total amount of buffers in the pool */
 	struct mutex memory_mutex;	/* protection for the above */
 
 #ifdef CONFIG_PM
@@ -30,6 +30,7 @@ int snd_hwparams_to_dma_slave_config(const struct snd_pcm_substream *substream,
 int snd_dmaengine_pcm_trigger(struct snd_pcm_substream *substream, int cmd);
 snd_pcm_uframes_t snd_dmaengine_pcm_pointer(struct snd_pcm_substream *substream);
 snd_pcm_uframes_t snd_dmaengine_pcm_pointer_no_residue(struct snd_pcm_substream *substream);
+int snd_dmaengine_pcm_setup_sg(struct snd_pcm_substream *substream);
 
 int snd_dmaengine_pcm_open(struct snd_pcm_substream *substream,
 	struct dma_chan *chan);
@@ -104,6 +105,11 @@ int snd_dmaengine_pcm_refine_runtime_hwparams(
  * playback.
  */
 #define SND_DMAENGINE_PCM_FLAG_HALF_DUPLEX BIT(3)
+/*
+ * Allocate SG buffers when the DMA channels support slave_sg transfers, so
+ * that large buffers do not need contiguous memory.
+ */
+#define SND_DMAENGINE_PCM_FLAG_SG BIT(4)
 
 /**
  * struct snd_dmaengine_pcm_config - Configuration data for dmaengine based PCM
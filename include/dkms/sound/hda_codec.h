@@ -198,11 +198,15 @@ struct hda_codec {
 
 	/* widget capabilities cache */
 	u32 *wcaps;
+	/* raw widget caps and connections shared by the same codec models */
+	struct hda_topology *topology;
 
 	struct snd_array mixers;	/* list of assigned mixer elements */
 	struct snd_array nids;		/* list of mapped mixer elements */
 
 	struct list_head conn_list;	/* linked-list of connection-list */
+	struct hda_conn_list **conn_index; /* conn_list entries by NID */
+	unsigned int conn_gen;		/* bumped when a conn list changes */
 
 	struct mutex spdif_mutex;
 	struct mutex control_mutex;
@@ -254,6 +258,8 @@ struct hda_codec {
 	unsigned int link_down_at_suspend:1; /* link down at runtime suspend */
 	unsigned int relaxed_resume:1;	/* don't resume forcibly for jack */
 	unsigned int mst_no_extra_pcms:1; /* no backup PCMs for DP-MST */
+	unsigned int jackpoll_backoff:1; /* slow down polling while idle */
+	unsigned int jackpoll_in_use:1;	/* poll only while in use */
 
 #ifdef CONFIG_PM
 	unsigned long power_on_acct;
@@ -273,6 +279,7 @@ struct hda_codec {
 	struct snd_array jacktbl;
 	unsigned long jackpoll_interval; /* In jiffies. Zero means no poll, rely on unsol events */
 	struct delayed_work jackpoll_work;
+	unsigned int jackpoll_shift;	/* backoff of jackpoll_interval */
 
 	int depop_delay; /* depop delay in ms, -1 for default delay time */
 
@@ -304,6 +311,7 @@ int snd_hda_codec_new(struct hda_bus *bus, struct snd_card *card,
 int snd_hda_codec_device_new(struct hda_bus *bus, struct snd_card *card,
 		      unsigned int codec_addr, struct hda_codec *codec);
 int snd_hda_codec_configure(struct hda_codec *codec);
+void snd_hda_codecs_preload(struct hda_bus *bus);
 int snd_hda_codec_update_widgets(struct hda_codec *codec);
 
 /*
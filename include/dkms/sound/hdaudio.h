@@ -43,6 +43,31 @@ struct snd_array {
 	void *list;
 };
 
+/* max number of verbs sent at once by snd_hdac_bus_exec_verbs() */
+#define HDAC_VERB_BATCH		32
+
+/*
+ * verb statistics of a codec; the 12-bit verbs are counted by ID, the
+ * 4-bit verbs (carrying a 16-bit payload) by their 4-bit ID
+ */
+#define HDAC_STATS_VERB_IDS	(0x200 + 0x10)
+#define HDAC_STATS_NIDS		0x80
+/* RIRB wait buckets of 4^n * 16us */
+#define HDAC_STATS_RIRB_WAITS	6
+
+struct hdac_verb_stats {
+	unsigned int verbs[HDAC_STATS_VERB_IDS];
+	unsigned int nid_verbs[HDAC_STATS_NIDS];
+	/* regmap reads through the cache, and those bypassing it */
+	unsigned int regmap_reads;
+	unsigned int regmap_uncached;
+	/* verb reads sent by regmap, i.e. cache misses + uncached reads */
+	unsigned int regmap_hw_reads;
+	unsigned int rirb_waits[HDAC_STATS_RIRB_WAITS];
+	unsigned int rirb_timeouts;
+	unsigned int fallbacks;		/* polling, MSI off, single_cmd */
+};
+
 /*
  * HD-audio codec base device
  */
@@ -73,6 +98,16 @@ struct hdac_device {
 	/* verb exec op override */
 	int (*exec_verb)(struct hdac_device *dev, unsigned int cmd,
 			 unsigned int flags, unsigned int *res);
+	/* batched verb exec op override */
+	int (*exec_verbs)(struct hdac_device *dev, const unsigned int *cmds,
+			  unsigned int *res, unsigned int count);
+
+	/* writes queued by snd_hdac_batch_verbs_begin() */
+	struct task_struct *batch_owner;
+	unsigned int batch_depth;
+	unsigned int batch_count;
+	int batch_err;
+	unsigned int batch_cmds[HDAC_VERB_BATCH];
 
 	/* widgets */
 	unsigned int num_nodes;
@@ -92,6 +127,10 @@ struct hdac_device {
 	bool lazy_cache:1;	/* don't wake up for writes */
 	bool caps_overwriting:1; /* caps overwrite being in process */
 	bool cache_coef:1;	/* cache COEF read/write too */
+	bool coef_auto_inc:1;	/* COEF index increments at each access */
+
+	/* approximate, updated without locking */
+	struct hdac_verb_stats stats;
 };
 
 /* device/driver type used for matching */
@@ -126,6 +165,17 @@ int snd_hdac_refresh_widgets(struct hdac_device *codec);
 
 int snd_hdac_read(struct hdac_device *codec, hda_nid_t nid,
 		  unsigned int verb, unsigned int parm, unsigned int *res);
+int snd_hdac_exec_verbs(struct hdac_device *codec, const unsigned int *cmds,
+			unsigned int *res, unsigned int count);
+void snd_hdac_count_verb(struct hdac_device *codec, unsigned int cmd);
+int snd_hdac_read_coefs(struct hdac_device *codec, hda_nid_t nid,
+			const unsigned int *idx, unsigned int *vals,
+			unsigned int count);
+int snd_hdac_write_coefs(struct hdac_device *codec, hda_nid_t nid,
+			 const unsigned int *idx, const unsigned int *vals,
+			 unsigned int count);
+void snd_hdac_batch_verbs_begin(struct hdac_device *codec);
+int snd_hdac_batch_verbs_end(struct hdac_device *codec);
 int _snd_hdac_read_parm(struct hdac_device *codec, hda_nid_t nid, int parm,
 			unsigned int *res);
 int snd_hdac_read_parm_uncached(struct hdac_device *codec, hda_nid_t nid,
@@ -253,6 +303,8 @@ struct hdac_ext_bus_ops {
 
 #define HDA_UNSOL_QUEUE_SIZE	64
 #define HDA_MAX_CODECS		8	/* limit by controller side */
+#define HDA_MAX_STREAMS		32	/* stream indexes tracked per bus */
+#define HDA_STREAM_KEY_BITS	3	/* substream key cache slots */
 
 /*
  * CORB/RIRB
@@ -321,6 +373,11 @@ struct hdac_bus {
 	unsigned int last_cmd[HDA_MAX_CODECS];	/* last sent command */
 	wait_queue_head_t rirb_wq;
 
+	/* responses collected for snd_hdac_bus_exec_verbs() */
+	u32 *batch_res;
+	u8 *batch_addr;
+	unsigned int batch_len, batch_size;
+
 	/* CORB/RIRB and position buffers */
 	struct snd_dma_buffer rb;
 	struct snd_dma_buffer posbuf;
@@ -328,6 +385,12 @@ struct hdac_bus {
 
 	/* hdac_stream linked list */
 	struct list_head stream_list;
+	/* streams by index, with per direction masks of all and free ones */
+	struct hdac_stream *streams[HDA_MAX_STREAMS];
+	unsigned long stream_mask[2];
+	unsigned long free_streams[2];
+	/* last stream assigned per substream key slot */
+	struct hdac_stream *key_cache[1 << HDA_STREAM_KEY_BITS];
 
 	/* operation state */
 	bool chip_init:1;		/* h/w initialized */
@@ -342,6 +405,7 @@ struct hdac_bus {
 	bool corbrp_self_clear:1;	/* CORBRP clears itself after reset */
 	bool polling_mode:1;
 	bool needs_damn_long_delay:1;
+	bool cmd_batch:1;		/* verbs can be queued in the CORB */
 
 	int poll_count;
 
@@ -373,6 +437,11 @@ int snd_hdac_bus_exec_verb(struct hdac_bus *bus, unsigned int addr,
 			   unsigned int cmd, unsigned int *res);
 int snd_hdac_bus_exec_verb_unlocked(struct hdac_bus *bus, unsigned int addr,
 				    unsigned int cmd, unsigned int *res);
+int snd_hdac_bus_exec_verbs(struct hdac_bus *bus, const unsigned int *cmds,
+			    unsigned int *res, unsigned int count);
+int snd_hdac_bus_exec_verbs_unlocked(struct hdac_bus *bus,
+				     const unsigned int *cmds,
+				     unsigned int *res, unsigned int count);
 void snd_hdac_bus_queue_event(struct hdac_bus *bus, u32 res, u32 res_ex);
 
 static inline void snd_hdac_codec_link_up(struct hdac_device *codec)
@@ -543,6 +612,60 @@ struct hdac_stream {
 #endif
 };
 
+/*
+ * snd_hdac_stream_add - link a stream in the bus, with its index and
+ * direction set, and index it as a free stream of its direction
+ */
+static inline void snd_hdac_stream_add(struct hdac_bus *bus,
+				       struct hdac_stream *azx_dev)
+{
+	list_add_tail(&azx_dev->list, &bus->stream_list);
+
+	if (WARN_ON(azx_dev->index >= HDA_MAX_STREAMS))
+		return;
+
+	bus->streams[azx_dev->index] = azx_dev;
+	bus->stream_mask[azx_dev->direction] |= BIT(azx_dev->index);
+	if (!azx_dev->opened)
+		bus->free_streams[azx_dev->direction] |= BIT(azx_dev->index);
+}
+
+/* snd_hdac_stream_remove - unlink a stream added by snd_hdac_stream_add() */
+static inline void snd_hdac_stream_remove(struct hdac_stream *azx_dev)
+{
+	struct hdac_bus *bus = azx_dev->bus;
+	int i;
+
+	list_del(&azx_dev->list);
+
+	if (azx_dev->index >= HDA_MAX_STREAMS)
+		return;
+
+	bus->streams[azx_dev->index] = NULL;
+	bus->stream_mask[azx_dev->direction] &= ~BIT(azx_dev->index);
+	bus->free_streams[azx_dev->direction] &= ~BIT(azx_dev->index);
+	for (i = 0; i < ARRAY_SIZE(bus->key_cache); i++)
+		if (bus->key_cache[i] == azx_dev)
+			bus->key_cache[i] = NULL;
+}
+
+/*
+ * snd_hdac_stream_set_opened - mark a stream opened or free
+ *
+ * Keeps the bus free stream masks in sync, call with bus->reg_lock held.
+ */
+static inline void snd_hdac_stream_set_opened(struct hdac_stream *azx_dev,
+					      bool opened)
+{
+	unsigned long *free = &azx_dev->bus->free_streams[azx_dev->direction];
+
+	azx_dev->opened = opened;
+	if (opened)
+		__clear_bit(azx_dev->index, free);
+	else
+		__set_bit(azx_dev->index, free);
+}
+
 void snd_hdac_stream_init(struct hdac_bus *bus, struct hdac_stream *azx_dev,
 			  int idx, int direction, int tag);
 struct hdac_stream *snd_hdac_stream_assign(struct hdac_bus *bus,
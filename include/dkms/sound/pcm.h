@@ -16,6 +16,7 @@
 #include <linux/bitops.h>
 #include <linux/pm_qos.h>
 #include <linux/refcount.h>
+#include <linux/seqlock.h>
 
 #define snd_pcm_substream_chip(substream) ((substream)->private_data)
 #define snd_pcm_chip(pcm) ((pcm)->private_data)
@@ -49,6 +50,7 @@ struct snd_pcm_substream;
 
 struct snd_pcm_audio_tstamp_config; /* definitions further down */
 struct snd_pcm_audio_tstamp_report;
+struct snd_pcm_hw_refine_cache;
 
 struct snd_pcm_ops {
 	int (*open)(struct snd_pcm_substream *substream);
@@ -243,6 +245,8 @@ struct snd_pcm_hw_constraints {
 	unsigned int rules_num;
 	unsigned int rules_all;
 	struct snd_pcm_hw_rule *rules;
+	unsigned long *rule_deps;	/* per variable, bitmap of dependent rules */
+	unsigned int gen;	/* bumped on each change of the constraints */
 };
 
 static inline struct snd_mask *constrs_mask(struct snd_pcm_hw_constraints *constrs,
@@ -341,6 +345,20 @@ static inline void snd_pcm_pack_audio_tstamp_report(__u32 *data, __u32 *accuracy
 }
 
 
+/*
+ * Position published at each pointer update, for the readers which can do
+ * with a recent position and don't want to take the stream lock.
+ */
+struct snd_pcm_hw_ptr_snapshot {
+	seqcount_t seq;
+	snd_pcm_state_t state;
+	snd_pcm_uframes_t hw_ptr;	/* status->hw_ptr */
+	snd_pcm_uframes_t hw_ptr_base;
+	snd_pcm_sframes_t delay;	/* runtime->delay */
+	unsigned long jiffies;		/* time of the update */
+	struct timespec tstamp;		/* status->tstamp */
+};
+
 struct snd_pcm_runtime {
 	/* -- Status -- */
 	struct snd_pcm_substream *trigger_master;
@@ -368,10 +386,15 @@ struct snd_pcm_runtime {
 	size_t byte_align;
 	unsigned int frame_bits;
 	unsigned int sample_bits;
+	/* format properties cached at hw_params */
+	int format_width;		/* snd_pcm_format_width() */
+	int format_signed;		/* snd_pcm_format_signed() */
+	int silence_byte;		/* byte repeated as silence, or -1 */
 	unsigned int info;
 	unsigned int rate_num;
 	unsigned int rate_den;
 	unsigned int no_period_wakeup: 1;
+	unsigned int timer_wakeup: 1;	/* predict the wakeups of transfers */
 
 	/* -- SW params -- */
 	int tstamp_mode;		/* mmap timestamp is updated */
@@ -391,6 +414,9 @@ struct snd_pcm_runtime {
 	/* -- mmap -- */
 	struct snd_pcm_mmap_status *status;
 	struct snd_pcm_mmap_control *control;
+	struct snd_pcm_mmap_timing *timing;
+	struct snd_pcm_hw_ptr_snapshot hw_snapshot;	/* lockless position */
+	struct snd_pcm_hw_refine_cache *refine_cache;	/* HW_REFINE results */
 
 	/* -- locking / scheduling -- */
 	snd_pcm_uframes_t twake; 	/* do transfer (!poll) wakeup if non-zero */
@@ -430,6 +456,20 @@ struct snd_pcm_runtime {
 #endif
 };
 
+/**
+ * snd_pcm_hw_constraints_changed - drop the cached refinement results
+ * @runtime: PCM runtime instance
+ *
+ * The results of HW_REFINE are cached until the constraints of the stream
+ * change.  Drivers whose rules depend on some external state must call this
+ * whenever that state changes.
+ */
+static inline void
+snd_pcm_hw_constraints_changed(struct snd_pcm_runtime *runtime)
+{
+	WRITE_ONCE(runtime->hw_constraints.gen, runtime->hw_constraints.gen + 1);
+}
+
 struct snd_pcm_group {		/* keep linked substreams */
 	spinlock_t lock;
 	struct mutex mutex;
@@ -439,6 +479,26 @@ struct snd_pcm_group {		/* keep linked substreams */
 
 struct pid;
 
+/*
+ * Always-on statistics of a substream, shown in the stats proc file.
+ * The histograms are in log2 buckets: bucket 0 counts the zero values,
+ * bucket n the values in [2^(n-1), 2^n) and the last one everything above.
+ */
+#define SNDRV_PCM_STATS_BUCKETS		16
+
+struct snd_pcm_substream_stats {
+	unsigned long xruns;
+	unsigned long periods;		/* period interrupts */
+	u64 last_period_ns;		/* time of the last period interrupt */
+	u64 wakeup_ns;			/* time of the pending transfer wakeup */
+	u64 trigger_skew_ns;		/* skew of the last linked start */
+	unsigned int period_interval[SNDRV_PCM_STATS_BUCKETS];	/* usecs */
+	unsigned int hw_ptr_jitter[SNDRV_PCM_STATS_BUCKETS];	/* frames */
+	unsigned int wakeup_latency[SNDRV_PCM_STATS_BUCKETS];	/* usecs */
+	unsigned int appl_lead[SNDRV_PCM_STATS_BUCKETS];	/* frames */
+	unsigned int trigger_skew[SNDRV_PCM_STATS_BUCKETS];	/* usecs */
+};
+
 struct snd_pcm_substream {
 	struct snd_pcm *pcm;
 	struct snd_pcm_str *pstr;
@@ -470,6 +530,7 @@ struct snd_pcm_substream {
 	unsigned int f_flags;
 	void (*pcm_release)(struct snd_pcm_substream *);
 	struct pid *pid;
+	struct snd_pcm_substream_stats stats;
 #if IS_ENABLED(CONFIG_SND_PCM_OSS)
 	/* -- OSS things -- */
 	struct snd_pcm_oss_substream oss;
@@ -523,6 +584,7 @@ struct snd_pcm {
 	bool internal; /* pcm is for internal use only */
 	bool nonatomic; /* whole PCM operations are in non-atomic context */
 	bool no_device_suspend; /* don't invoke device PM suspend */
+	unsigned int hw_params_gen; /* bumped on each hw_params/hw_free */
 #if IS_ENABLED(CONFIG_SND_PCM_OSS)
 	struct snd_pcm_oss oss;
 #endif
@@ -1067,6 +1129,11 @@ void snd_pcm_set_sync(struct snd_pcm_substream *substream);
 int snd_pcm_lib_ioctl(struct snd_pcm_substream *substream,
 		      unsigned int cmd, void *arg);                      
 void snd_pcm_period_elapsed(struct snd_pcm_substream *substream);
+void snd_pcm_period_elapsed_under_stream_lock(struct snd_pcm_substream *substream);
+void snd_pcm_periods_elapsed(struct snd_pcm_substream *substream,
+			     unsigned int periods);
+void snd_pcm_period_elapsed_batch(struct snd_pcm_substream **substreams,
+				  unsigned int count);
 snd_pcm_sframes_t __snd_pcm_lib_xfer(struct snd_pcm_substream *substream,
 				     void *buf, bool interleaved,
 				     snd_pcm_uframes_t frames, bool in_kernel);
@@ -1436,6 +1503,186 @@ static inline u64 pcm_format_to_bits(snd_pcm_format_t pcm_format)
 	     (__force int)(f) <= (__force int)SNDRV_PCM_FORMAT_LAST;	\
 	     (f) = (__force snd_pcm_format_t)((__force int)(f) + 1))
 
+/*
+ * Format groups for the inline helpers below; they must be kept in sync
+ * with the format table in pcm_misc.c.
+ */
+#define __SNDRV_PCM_FMTBIT_SIGNED					\
+	(SNDRV_PCM_FMTBIT_S8 | SNDRV_PCM_FMTBIT_S16_LE |		\
+	 SNDRV_PCM_FMTBIT_S16_BE | SNDRV_PCM_FMTBIT_S24_LE |		\
+	 SNDRV_PCM_FMTBIT_S24_BE | SNDRV_PCM_FMTBIT_S32_LE |		\
+	 SNDRV_PCM_FMTBIT_S32_BE | SNDRV_PCM_FMTBIT_S20_LE |		\
+	 SNDRV_PCM_FMTBIT_S20_BE | SNDRV_PCM_FMTBIT_S24_3LE |		\
+	 SNDRV_PCM_FMTBIT_S24_3BE | SNDRV_PCM_FMTBIT_S20_3LE |		\
+	 SNDRV_PCM_FMTBIT_S20_3BE | SNDRV_PCM_FMTBIT_S18_3LE |		\
+	 SNDRV_PCM_FMTBIT_S18_3BE)
+#define __SNDRV_PCM_FMTBIT_UNSIGNED					\
+	(SNDRV_PCM_FMTBIT_U8 | SNDRV_PCM_FMTBIT_U16_LE |		\
+	 SNDRV_PCM_FMTBIT_U16_BE | SNDRV_PCM_FMTBIT_U24_LE |		\
+	 SNDRV_PCM_FMTBIT_U24_BE | SNDRV_PCM_FMTBIT_U32_LE |		\
+	 SNDRV_PCM_FMTBIT_U32_BE | SNDRV_PCM_FMTBIT_U20_LE |		\
+	 SNDRV_PCM_FMTBIT_U20_BE | SNDRV_PCM_FMTBIT_U24_3LE |		\
+	 SNDRV_PCM_FMTBIT_U24_3BE | SNDRV_PCM_FMTBIT_U20_3LE |		\
+	 SNDRV_PCM_FMTBIT_U20_3BE | SNDRV_PCM_FMTBIT_U18_3LE |		\
+	 SNDRV_PCM_FMTBIT_U18_3BE | SNDRV_PCM_FMTBIT_DSD_U8 |		\
+	 SNDRV_PCM_FMTBIT_DSD_U16_LE | SNDRV_PCM_FMTBIT_DSD_U32_LE |	\
+	 SNDRV_PCM_FMTBIT_DSD_U16_BE | SNDRV_PCM_FMTBIT_DSD_U32_BE)
+#define __SNDRV_PCM_FMTBIT_WIDTH_8					\
+	(SNDRV_PCM_FMTBIT_S8 | SNDRV_PCM_FMTBIT_U8 |			\
+	 SNDRV_PCM_FMTBIT_MU_LAW | SNDRV_PCM_FMTBIT_A_LAW |		\
+	 SNDRV_PCM_FMTBIT_DSD_U8)
+#define __SNDRV_PCM_FMTBIT_WIDTH_16					\
+	(SNDRV_PCM_FMTBIT_S16_LE | SNDRV_PCM_FMTBIT_S16_BE |		\
+	 SNDRV_PCM_FMTBIT_U16_LE | SNDRV_PCM_FMTBIT_U16_BE |		\
+	 SNDRV_PCM_FMTBIT_DSD_U16_LE | SNDRV_PCM_FMTBIT_DSD_U16_BE)
+#define __SNDRV_PCM_FMTBIT_WIDTH_18					\
+	(SNDRV_PCM_FMTBIT_S18_3LE | SNDRV_PCM_FMTBIT_S18_3BE |		\
+	 SNDRV_PCM_FMTBIT_U18_3LE | SNDRV_PCM_FMTBIT_U18_3BE)
+#define __SNDRV_PCM_FMTBIT_WIDTH_20					\
+	(SNDRV_PCM_FMTBIT_S20_LE | SNDRV_PCM_FMTBIT_S20_BE |		\
+	 SNDRV_PCM_FMTBIT_U20_LE | SNDRV_PCM_FMTBIT_U20_BE |		\
+	 SNDRV_PCM_FMTBIT_S20_3LE | SNDRV_PCM_FMTBIT_S20_3BE |		\
+	 SNDRV_PCM_FMTBIT_U20_3LE | SNDRV_PCM_FMTBIT_U20_3BE)
+#define __SNDRV_PCM_FMTBIT_WIDTH_24					\
+	(SNDRV_PCM_FMTBIT_S24_LE | SNDRV_PCM_FMTBIT_S24_BE |		\
+	 SNDRV_PCM_FMTBIT_U24_LE | SNDRV_PCM_FMTBIT_U24_BE |		\
+	 SNDRV_PCM_FMTBIT_S24_3LE | SNDRV_PCM_FMTBIT_S24_3BE |		\
+	 SNDRV_PCM_FMTBIT_U24_3LE | SNDRV_PCM_FMTBIT_U24_3BE)
+#define __SNDRV_PCM_FMTBIT_WIDTH_32					\
+	(SNDRV_PCM_FMTBIT_S32_LE | SNDRV_PCM_FMTBIT_S32_BE |		\
+	 SNDRV_PCM_FMTBIT_U32_LE | SNDRV_PCM_FMTBIT_U32_BE |		\
+	 SNDRV_PCM_FMTBIT_FLOAT_LE | SNDRV_PCM_FMTBIT_FLOAT_BE |	\
+	 SNDRV_PCM_FMTBIT_IEC958_SUBFRAME_LE |				\
+	 SNDRV_PCM_FMTBIT_IEC958_SUBFRAME_BE |				\
+	 SNDRV_PCM_FMTBIT_DSD_U32_LE | SNDRV_PCM_FMTBIT_DSD_U32_BE)
+#define __SNDRV_PCM_FMTBIT_WIDTH_64					\
+	(SNDRV_PCM_FMTBIT_FLOAT64_LE | SNDRV_PCM_FMTBIT_FLOAT64_BE)
+/* the 24 bit packed formats, the other 18, 20 and 24 bit ones use 32 bits */
+#define __SNDRV_PCM_FMTBIT_PHYS_24					\
+	(SNDRV_PCM_FMTBIT_S24_3LE | SNDRV_PCM_FMTBIT_S24_3BE |		\
+	 SNDRV_PCM_FMTBIT_U24_3LE | SNDRV_PCM_FMTBIT_U24_3BE |		\
+	 SNDRV_PCM_FMTBIT_S20_3LE | SNDRV_PCM_FMTBIT_S20_3BE |		\
+	 SNDRV_PCM_FMTBIT_U20_3LE | SNDRV_PCM_FMTBIT_U20_3BE |		\
+	 SNDRV_PCM_FMTBIT_S18_3LE | SNDRV_PCM_FMTBIT_S18_3BE |		\
+	 SNDRV_PCM_FMTBIT_U18_3LE | SNDRV_PCM_FMTBIT_U18_3BE)
+
+static __always_inline bool __snd_pcm_format_valid(snd_pcm_format_t format)
+{
+	return (__force int)format >= 0 &&
+	       (__force int)format <= (__force int)SNDRV_PCM_FORMAT_LAST;
+}
+
+/**
+ * __snd_pcm_format_signed - inline variant of snd_pcm_format_signed()
+ * @format: the format to check
+ *
+ * Folded to a constant when @format is known at build time, otherwise
+ * only a few bit tests.
+ *
+ * Return: as snd_pcm_format_signed().
+ */
+static __always_inline int __snd_pcm_format_signed(snd_pcm_format_t format)
+{
+	u64 bit;
+
+	if (!__snd_pcm_format_valid(format))
+		return -EINVAL;
+	bit = pcm_format_to_bits(format);
+	if (bit & __SNDRV_PCM_FMTBIT_SIGNED)
+		return 1;
+	if (bit & __SNDRV_PCM_FMTBIT_UNSIGNED)
+		return 0;
+	return -EINVAL;
+}
+
+/**
+ * __snd_pcm_format_width - inline variant of snd_pcm_format_width()
+ * @format: the format to check
+ *
+ * Return: as snd_pcm_format_width().
+ */
+static __always_inline int __snd_pcm_format_width(snd_pcm_format_t format)
+{
+	u64 bit;
+
+	if (!__snd_pcm_format_valid(format))
+		return -EINVAL;
+	bit = pcm_format_to_bits(format);
+	if (bit & __SNDRV_PCM_FMTBIT_WIDTH_8)
+		return 8;
+	if (bit & __SNDRV_PCM_FMTBIT_WIDTH_16)
+		return 16;
+	if (bit & __SNDRV_PCM_FMTBIT_WIDTH_18)
+		return 18;
+	if (bit & __SNDRV_PCM_FMTBIT_WIDTH_20)
+		return 20;
+	if (bit & __SNDRV_PCM_FMTBIT_WIDTH_24)
+		return 24;
+	if (bit & __SNDRV_PCM_FMTBIT_WIDTH_32)
+		return 32;
+	if (bit & __SNDRV_PCM_FMTBIT_WIDTH_64)
+		return 64;
+	if (bit & (SNDRV_PCM_FMTBIT_G723_24 | SNDRV_PCM_FMTBIT_G723_24_1B))
+		return 3;
+	if (bit & SNDRV_PCM_FMTBIT_IMA_ADPCM)
+		return 4;
+	if (bit & (SNDRV_PCM_FMTBIT_G723_40 | SNDRV_PCM_FMTBIT_G723_40_1B))
+		return 5;
+	return -EINVAL;
+}
+
+/**
+ * __snd_pcm_format_physical_width - inline snd_pcm_format_physical_width()
+ * @format: the format to check
+ *
+ * Return: as snd_pcm_format_physical_width().
+ */
+static __always_inline int
+__snd_pcm_format_physical_width(snd_pcm_format_t format)
+{
+	u64 bit;
+
+	if (!__snd_pcm_format_valid(format))
+		return -EINVAL;
+	bit = pcm_format_to_bits(format);
+	if (bit & (__SNDRV_PCM_FMTBIT_WIDTH_8 |
+		   SNDRV_PCM_FMTBIT_G723_24_1B | SNDRV_PCM_FMTBIT_G723_40_1B))
+		return 8;
+	if (bit & __SNDRV_PCM_FMTBIT_WIDTH_16)
+		return 16;
+	if (bit & __SNDRV_PCM_FMTBIT_PHYS_24)
+		return 24;
+	if (bit & (__SNDRV_PCM_FMTBIT_WIDTH_20 | __SNDRV_PCM_FMTBIT_WIDTH_24 |
+		   __SNDRV_PCM_FMTBIT_WIDTH_32))
+		return 32;
+	if (bit & __SNDRV_PCM_FMTBIT_WIDTH_64)
+		return 64;
+	if (bit & SNDRV_PCM_FMTBIT_G723_24)
+		return 3;
+	if (bit & SNDRV_PCM_FMTBIT_IMA_ADPCM)
+		return 4;
+	if (bit & SNDRV_PCM_FMTBIT_G723_40)
+		return 5;
+	return -EINVAL;
+}
+
+/**
+ * __snd_pcm_format_size - inline variant of snd_pcm_format_size()
+ * @format: the format to check
+ * @samples: sampling rate
+ *
+ * Return: as snd_pcm_format_size().
+ */
+static __always_inline ssize_t
+__snd_pcm_format_size(snd_pcm_format_t format, size_t samples)
+{
+	int phys_width = __snd_pcm_format_physical_width(format);
+
+	if (phys_width < 0)
+		return -EINVAL;
+	return samples * phys_width / 8;
+}
+
 /* printk helpers */
 #define pcm_err(pcm, fmt, args...) \
 	dev_err((pcm)->card->dev, fmt, ##args)
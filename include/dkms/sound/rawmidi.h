@@ -61,11 +61,24 @@ struct snd_rawmidi_runtime {
 	size_t avail_min;	/* min avail for wakeup */
 	size_t avail;		/* max used buffer for wakeup */
 	size_t xruns;		/* over/underruns counter */
+	/* mmap of the input buffer, positions modulo boundary */
+	struct snd_rawmidi_mmap_status *mmap_status;
+	struct snd_rawmidi_mmap_control *mmap_control;
+	unsigned int boundary;
+	unsigned int mmap_hw_ptr;	/* bytes received */
+	unsigned int mmap_appl_ptr;	/* bytes consumed */
+	int buffer_mmap_count;	/* mappings of the buffer */
 	/* misc */
 	spinlock_t lock;
 	wait_queue_head_t sleep;
 	/* event handler (new bytes, input only) */
 	void (*event)(struct snd_rawmidi_substream *substream);
+	/*
+	 * in-kernel consumer fed with the received bytes straight from
+	 * snd_rawmidi_receive(), bypassing the buffer (input only)
+	 */
+	void (*receive)(struct snd_rawmidi_substream *substream,
+			const unsigned char *buffer, int count);
 	/* defers calls to event [input] or ops->trigger [output] */
 	struct work_struct event_work;
 	/* private data */
@@ -80,6 +93,8 @@ struct snd_rawmidi_substream {
 	bool opened;			/* open flag */
 	bool append;			/* append flag (merge more streams) */
 	bool active_sensing;		/* send active sensing when close */
+	unsigned int framing;		/* whether to frame input data */
+	unsigned int clock_type;	/* clock source to use for input framing */
 	int use_count;			/* use counter (for output) */
 	size_t bytes;
 	struct snd_rawmidi *rmidi;
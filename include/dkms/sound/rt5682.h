@@ -38,6 +38,7 @@ struct rt5682_platform_data {
 	enum rt5682_dmic1_clk_pin dmic1_clk_pin;
 	enum rt5682_jd_src jd_src;
 	unsigned int btndet_delay;
+	bool jd_irq_only; /* JD1 IRQ is debounced and raised on removal */
 	unsigned int dmic_clk_rate;
 	unsigned int dmic_delay;
 
@@ -38,7 +38,7 @@ typedef union snd_seq_timestamp snd_seq_timestamp_t;
 #define SNDRV_SEQ_MAX_HOPS		8
 
 /* max size of event size */
-#define SNDRV_SEQ_MAX_EVENT_LEN		0x3fffffff
+#define SNDRV_SEQ_MAX_EVENT_LEN		0x1fffffff
 
 /* call-backs for kernel port */
 struct snd_seq_port_callback {
@@ -63,9 +63,10 @@ int snd_seq_kernel_client_enqueue(int client, struct snd_seq_event *ev,
 int snd_seq_kernel_client_dispatch(int client, struct snd_seq_event *ev, int atomic, int hop);
 int snd_seq_kernel_client_ctl(int client, unsigned int cmd, void *arg);
 
-#define SNDRV_SEQ_EXT_MASK	0xc0000000
+#define SNDRV_SEQ_EXT_MASK	0xe0000000
 #define SNDRV_SEQ_EXT_USRPTR	0x80000000
 #define SNDRV_SEQ_EXT_CHAINED	0x40000000
+#define SNDRV_SEQ_EXT_SHARED	0x20000000
 
 typedef int (*snd_seq_dump_func_t)(void *ptr, void *buf, int count);
 int snd_seq_expand_var_event(const struct snd_seq_event *event, int count, char *buf,
@@ -32,6 +32,9 @@ void snd_midi_event_reset_decode(struct snd_midi_event *dev);
 void snd_midi_event_no_status(struct snd_midi_event *dev, int on);
 bool snd_midi_event_encode_byte(struct snd_midi_event *dev, unsigned char c,
 				struct snd_seq_event *ev);
+/* encode from bytes to an event - return number of consumed bytes */
+long snd_midi_event_encode(struct snd_midi_event *dev, const unsigned char *buf,
+			   long count, struct snd_seq_event *ev);
 /* decode from event to bytes - return number of written bytes if success */
 long snd_midi_event_decode(struct snd_midi_event *dev, unsigned char *buf, long count,
 			   struct snd_seq_event *ev);
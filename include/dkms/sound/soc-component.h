@@ -92,6 +92,8 @@ struct snd_soc_component_driver {
 			 struct snd_pcm_substream *substream);
 	snd_pcm_uframes_t (*pointer)(struct snd_soc_component *component,
 				     struct snd_pcm_substream *substream);
+	int (*ack)(struct snd_soc_component *component,
+		   struct snd_pcm_substream *substream);
 	int (*get_time_info)(struct snd_soc_component *component,
 		struct snd_pcm_substream *substream, struct timespec64 *system_ts,
 		struct timespec64 *audio_ts,
@@ -304,6 +306,27 @@ int snd_soc_component_test_bits(struct snd_soc_component *component,
 				unsigned int reg, unsigned int mask,
 				unsigned int value);
 
+/* register updates of a component applied together */
+#define SND_SOC_COMPONENT_TXN_MAX	8
+
+struct snd_soc_component_txn {
+	struct snd_soc_component *component;
+	unsigned int num;
+	int change;
+	struct {
+		unsigned int reg;
+		unsigned int mask;
+		unsigned int val;
+	} updates[SND_SOC_COMPONENT_TXN_MAX];
+};
+
+void snd_soc_component_txn_begin(struct snd_soc_component_txn *txn,
+				 struct snd_soc_component *component);
+int snd_soc_component_txn_update_bits(struct snd_soc_component_txn *txn,
+				      unsigned int reg, unsigned int mask,
+				      unsigned int val);
+int snd_soc_component_txn_commit(struct snd_soc_component_txn *txn);
+
 /* component wide operations */
 int snd_soc_component_set_sysclk(struct snd_soc_component *component,
 				 int clk_id, int source,
@@ -405,6 +428,7 @@ int snd_soc_component_of_xlate_dai_name(struct snd_soc_component *component,
 					const char **dai_name);
 
 int snd_soc_pcm_component_pointer(struct snd_pcm_substream *substream);
+int snd_soc_pcm_component_ack(struct snd_pcm_substream *substream);
 int snd_soc_pcm_component_ioctl(struct snd_pcm_substream *substream,
 				unsigned int cmd, void *arg);
 int snd_soc_pcm_component_sync_stop(struct snd_pcm_substream *substream);
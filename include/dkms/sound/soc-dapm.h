@@ -598,9 +598,13 @@ struct snd_soc_dapm_widget {
 	const char *name;		/* widget name */
 	const char *sname;	/* stream name */
 	struct list_head list;
+	struct hlist_node hash_node;	/* card widget_hash entry */
 	struct snd_soc_dapm_context *dapm;
 
 	void *priv;				/* widget specific data */
+	/* DPCM BE of a DAI widget, valid while dpcm_be_gen is the card's */
+	struct snd_soc_pcm_runtime *dpcm_be;
+	unsigned int dpcm_be_gen;
 	struct regulator *regulator;		/* attached regulator */
 	struct pinctrl *pinctrl;		/* attached pinctrl */
 
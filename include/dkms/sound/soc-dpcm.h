@@ -101,6 +101,12 @@ struct snd_soc_dpcm_runtime {
 	enum snd_soc_dpcm_state state;
 
 	int trigger_pending; /* trigger cmd + 1 if pending, 0 if not */
+
+	/* last dpcm_path_get() result, see dpcm_path_cache_valid() */
+	struct snd_soc_dapm_widget_list *path_cache;
+	int path_count;
+	unsigned int path_conn_gen;
+	unsigned int path_be_gen;
 };
 
 #define for_each_dpcm_fe(be, stream, _dpcm)				\
@@ -11,6 +11,7 @@
 #define __LINUX_SND_SOC_H
 
 #include <linux/of.h>
+#include <linux/hashtable.h>
 #include <linux/platform_device.h>
 #include <linux/types.h>
 #include <linux/notifier.h>
@@ -401,6 +402,7 @@ struct soc_enum;
 struct snd_soc_jack;
 struct snd_soc_jack_zone;
 struct snd_soc_jack_pin;
+struct snd_soc_jack_update;
 #include <dkms/sound/soc-dapm.h>
 #include <dkms/sound/soc-dpcm.h>
 #include <dkms/sound/soc-topology.h>
@@ -503,6 +505,8 @@ int snd_soc_card_jack_new(struct snd_soc_card *card, const char *id, int type,
 	unsigned int num_pins);
 
 void snd_soc_jack_report(struct snd_soc_jack *jack, int status, int mask);
+void snd_soc_jack_report_batch(const struct snd_soc_jack_update *updates,
+			       int num);
 int snd_soc_jack_add_pins(struct snd_soc_jack *jack, int count,
 			  struct snd_soc_jack_pin *pins);
 void snd_soc_jack_notifier_register(struct snd_soc_jack *jack,
@@ -644,6 +648,20 @@ struct snd_soc_jack_pin {
 	bool invert;
 };
 
+/**
+ * struct snd_soc_jack_update - Describes a jack report for
+ *				snd_soc_jack_report_batch()
+ *
+ * @jack:   the jack to report, entries with a NULL jack are skipped
+ * @status: a bitmask of enum snd_jack_type values that are currently detected
+ * @mask:   a bitmask of enum snd_jack_type values that being reported
+ */
+struct snd_soc_jack_update {
+	struct snd_soc_jack *jack;
+	int status;
+	int mask;
+};
+
 /**
  * struct snd_soc_jack_zone - Describes voltage zones of jack detection
  *
@@ -837,6 +855,9 @@ struct snd_soc_dai_link {
 	/* DPCM used FE & BE merged rate */
 	unsigned int dpcm_merged_rate:1;
 
+	/* DPCM BEs of this FE are prepared concurrently */
+	unsigned int dpcm_async_prepare:1;
+
 	/* pmdown_time is ignored at stop */
 	unsigned int ignore_pmdown_time:1;
 
@@ -1067,12 +1088,22 @@ struct snd_soc_card {
 	int num_of_dapm_routes;
 	bool fully_routed;
 	bool disable_route_checks;
+	/* power the widgets of unrelated components concurrently */
+	bool parallel_seq;
+	/* probe the components of a probe order level concurrently */
+	bool parallel_probe;
 
 	/* lists of probed devices belonging to this card */
 	struct list_head component_dev_list;
 	struct list_head list;
 
 	struct list_head widgets;
+	/* widgets indexed by their (prefixed) name */
+	DECLARE_HASHTABLE(widget_hash, 8);
+	/* bumped when the DAPM graph connectivity changes */
+	unsigned int dapm_conn_gen;
+	/* bumped when runtimes or DAI widgets are added or removed */
+	unsigned int dpcm_be_gen;
 	struct list_head paths;
 	struct list_head dapm_list;
 	struct list_head dapm_dirty;
@@ -1165,6 +1196,7 @@ struct snd_soc_pcm_runtime {
 	/* bit field */
 	unsigned int pop_wait:1;
 	unsigned int fe_compr:1; /* for Dynamic PCM */
+	unsigned int dai_delay:1; /* a DAI has a delay op, see soc_pcm_pointer() */
 
 	int num_components;
 	struct snd_soc_component *components[0]; /* CPU/Codec/Platform */
@@ -10,6 +10,7 @@
 
 #include <dkms/sound/asound.h>
 #include <linux/interrupt.h>
+#include <linux/workqueue.h>
 
 #define snd_timer_chip(timer) ((timer)->private_data)
 
@@ -74,7 +75,7 @@ struct snd_timer {
 	struct list_head active_list_head;
 	struct list_head ack_list_head;
 	struct list_head sack_list_head; /* slow ack list head */
-	struct tasklet_struct task_queue;
+	struct work_struct task_work;	/* runs the slow callbacks */
 	int max_instances;	/* upper limit of timer instances */
 	int num_instances;	/* current number of timer instances */
 };
@@ -98,6 +99,7 @@ struct snd_timer_instance {
 	unsigned long pticks;		/* accumulated ticks for callback */
 	unsigned long resolution;	/* current resolution for tasklet */
 	unsigned long lost;		/* lost ticks */
+	int priority;			/* callback order, lower first */
 	int slave_class;
 	unsigned int slave_id;
 	struct list_head open_list;
@@ -156,7 +156,7 @@ struct snd_hwdep_dsp_image {
  *                                                                           *
  *****************************************************************************/
 
-#define SNDRV_PCM_VERSION		SNDRV_PROTOCOL_VERSION(2, 0, 15)
+#define SNDRV_PCM_VERSION		SNDRV_PROTOCOL_VERSION(2, 0, 17)
 
 typedef unsigned long snd_pcm_uframes_t;
 typedef signed long snd_pcm_sframes_t;
@@ -325,6 +325,7 @@ enum {
 	SNDRV_PCM_MMAP_OFFSET_CONTROL_OLD = 0x81000000,
 	SNDRV_PCM_MMAP_OFFSET_STATUS_NEW = 0x82000000,
 	SNDRV_PCM_MMAP_OFFSET_CONTROL_NEW = 0x83000000,
+	SNDRV_PCM_MMAP_OFFSET_TIMING = 0x84000000,
 #ifdef __SND_STRUCT_TIME64
 	SNDRV_PCM_MMAP_OFFSET_STATUS = SNDRV_PCM_MMAP_OFFSET_STATUS_NEW,
 	SNDRV_PCM_MMAP_OFFSET_CONTROL = SNDRV_PCM_MMAP_OFFSET_CONTROL_NEW,
@@ -391,6 +392,7 @@ typedef int snd_pcm_hw_param_t;
 #define SNDRV_PCM_HW_PARAMS_NORESAMPLE	(1<<0)	/* avoid rate resampling */
 #define SNDRV_PCM_HW_PARAMS_EXPORT_BUFFER	(1<<1)	/* export buffer */
 #define SNDRV_PCM_HW_PARAMS_NO_PERIOD_WAKEUP	(1<<2)	/* disable period wakeups */
+#define SNDRV_PCM_HW_PARAMS_TIMER_WAKEUP	(1<<3)	/* wake up blocked transfers from a timer */
 
 struct snd_interval {
 	unsigned int min, max;
@@ -598,6 +600,29 @@ struct __snd_pcm_sync_ptr64 {
 	} c;
 };
 
+/*
+ * Read-only timing record, updated by the kernel on each hw_ptr update
+ * and state change.  seq is odd while an update is in progress: a reader
+ * retries until it sees the same even seq before and after reading the
+ * other fields.
+ */
+#define SNDRV_PCM_MMAP_TIMING_VERSION	1
+
+struct snd_pcm_mmap_timing {
+	__u32 version;			/* RO: SNDRV_PCM_MMAP_TIMING_VERSION */
+	__u32 seq;			/* RO: update sequence count */
+	snd_pcm_state_t state;		/* RO: state - SNDRV_PCM_STATE_XXXX */
+	__u32 pad1;			/* Needed for 64 bit alignment */
+	__u64 hw_ptr;			/* RO: hw ptr (0...boundary-1) */
+	__u64 appl_ptr;			/* RO: appl ptr (0...boundary-1) */
+	__s64 delay;			/* RO: current delay in frames */
+	__s64 tstamp_sec;		/* RO: timestamp of the hw_ptr update */
+	__s64 tstamp_nsec;
+	__s64 audio_tstamp_sec;		/* RO: sample counter or wall clock */
+	__s64 audio_tstamp_nsec;
+	unsigned char reserved[56];
+};
+
 struct snd_xferi {
 	snd_pcm_sframes_t result;
 	void __user *buf;
@@ -710,7 +735,7 @@ enum {
  *  Raw MIDI section - /dev/snd/midi??
  */
 
-#define SNDRV_RAWMIDI_VERSION		SNDRV_PROTOCOL_VERSION(2, 0, 1)
+#define SNDRV_RAWMIDI_VERSION		SNDRV_PROTOCOL_VERSION(2, 0, 2)
 
 enum {
 	SNDRV_RAWMIDI_STREAM_OUTPUT = 0,
@@ -736,12 +761,68 @@ struct snd_rawmidi_info {
 	unsigned char reserved[64];	/* reserved for future use */
 };
 
+#define SNDRV_RAWMIDI_MODE_FRAMING_MASK		(7<<0)
+#define SNDRV_RAWMIDI_MODE_FRAMING_SHIFT	0
+#define SNDRV_RAWMIDI_MODE_FRAMING_NONE		(0<<0)
+#define SNDRV_RAWMIDI_MODE_FRAMING_TSTAMP	(1<<0)
+#define SNDRV_RAWMIDI_MODE_CLOCK_MASK		(7<<3)
+#define SNDRV_RAWMIDI_MODE_CLOCK_SHIFT		3
+#define SNDRV_RAWMIDI_MODE_CLOCK_NONE		(0<<3)
+#define SNDRV_RAWMIDI_MODE_CLOCK_REALTIME	(1<<3)
+#define SNDRV_RAWMIDI_MODE_CLOCK_MONOTONIC	(2<<3)
+#define SNDRV_RAWMIDI_MODE_CLOCK_MONOTONIC_RAW	(3<<3)
+
+#define SNDRV_RAWMIDI_FRAMING_DATA_LENGTH 16
+
+/* input frame of the SNDRV_RAWMIDI_MODE_FRAMING_TSTAMP mode */
+struct snd_rawmidi_framing_tstamp {
+	/* For now, frame_type is always 0. Applications are expected to
+	 * skip unknown frame types.
+	 */
+	__u8 frame_type;
+	__u8 length; /* number of valid bytes in data field */
+	__u8 reserved[2];
+	__u32 tv_nsec;		/* nanoseconds */
+	__u64 tv_sec;		/* seconds */
+	__u8 data[SNDRV_RAWMIDI_FRAMING_DATA_LENGTH];
+} __attribute__((packed));
+
 struct snd_rawmidi_params {
 	int stream;
 	size_t buffer_size;		/* queue size in bytes */
 	size_t avail_min;		/* minimum avail bytes for wakeup */
 	unsigned int no_active_sensing: 1; /* do not send active sensing byte in close() */
-	unsigned char reserved[16];	/* reserved for future use */
+	unsigned int mode;		/* For input data only, frame incoming data */
+	unsigned char reserved[12];	/* reserved for future use */
+};
+
+/*
+ * mmap of the input ring buffer
+ *
+ * The input buffer can be mapped read-only at SNDRV_RAWMIDI_MMAP_OFFSET_DATA.
+ * The kernel publishes the received bytes in the read-only status page at
+ * SNDRV_RAWMIDI_MMAP_OFFSET_STATUS, and the application reports the bytes
+ * it consumed in place by storing its position in the control page at
+ * SNDRV_RAWMIDI_MMAP_OFFSET_CONTROL, without any syscall.  Both positions
+ * count bytes and wrap at the boundary, a multiple of the buffer size, so
+ * the buffer offset of a position is the position modulo buffer_size.
+ * The positions restart from zero when the buffer is reset or resized.
+ */
+#define SNDRV_RAWMIDI_MMAP_OFFSET_DATA		0x00000000
+#define SNDRV_RAWMIDI_MMAP_OFFSET_STATUS	0x80000000
+#define SNDRV_RAWMIDI_MMAP_OFFSET_CONTROL	0x81000000
+
+struct snd_rawmidi_mmap_status {
+	__u32 hw_ptr;			/* RO: bytes received, modulo boundary */
+	__u32 boundary;			/* RO: wrap point of the positions */
+	__u32 buffer_size;		/* RO: size of the buffer in bytes */
+	__u32 xruns;			/* RO: overruns since the last status */
+	unsigned char reserved[48];	/* reserved for future use */
+};
+
+struct snd_rawmidi_mmap_control {
+	__u32 appl_ptr;			/* RW: bytes consumed, modulo boundary */
+	unsigned char reserved[60];	/* reserved for future use */
 };
 
 #ifndef __KERNEL__
@@ -936,7 +1017,7 @@ struct snd_timer_tread {
  *                                                                          *
  ****************************************************************************/
 
-#define SNDRV_CTL_VERSION		SNDRV_PROTOCOL_VERSION(2, 0, 8)
+#define SNDRV_CTL_VERSION		SNDRV_PROTOCOL_VERSION(2, 0, 10)
 
 struct snd_ctl_card_info {
 	int card;			/* card number */
@@ -1068,6 +1149,14 @@ struct snd_ctl_elem_value {
 	unsigned char reserved[128];
 };
 
+struct snd_ctl_elem_batch {
+	unsigned int count;		/* W: count of element values */
+	unsigned int flags;		/* W: reserved, must be zero */
+	__u64 values;			/* RW: struct snd_ctl_elem_value array */
+	__u64 errors;			/* R: int array, result of each element */
+	unsigned char reserved[40];
+};
+
 struct snd_ctl_tlv {
 	unsigned int numid;	/* control element numeric identification */
 	unsigned int length;	/* in bytes aligned to 4 */
@@ -1089,6 +1178,8 @@ struct snd_ctl_tlv {
 #define SNDRV_CTL_IOCTL_TLV_READ	_IOWR('U', 0x1a, struct snd_ctl_tlv)
 #define SNDRV_CTL_IOCTL_TLV_WRITE	_IOWR('U', 0x1b, struct snd_ctl_tlv)
 #define SNDRV_CTL_IOCTL_TLV_COMMAND	_IOWR('U', 0x1c, struct snd_ctl_tlv)
+#define SNDRV_CTL_IOCTL_ELEM_READ_BATCH	_IOWR('U', 0x1d, struct snd_ctl_elem_batch)
+#define SNDRV_CTL_IOCTL_ELEM_WRITE_BATCH _IOWR('U', 0x1e, struct snd_ctl_elem_batch)
 #define SNDRV_CTL_IOCTL_HWDEP_NEXT_DEVICE _IOWR('U', 0x20, int)
 #define SNDRV_CTL_IOCTL_HWDEP_INFO	_IOR('U', 0x21, struct snd_hwdep_info)
 #define SNDRV_CTL_IOCTL_PCM_NEXT_DEVICE	_IOR('U', 0x30, int)
@@ -1106,7 +1197,8 @@ struct snd_ctl_tlv {
 
 enum sndrv_ctl_event_type {
 	SNDRV_CTL_EVENT_ELEM = 0,
-	SNDRV_CTL_EVENT_LAST = SNDRV_CTL_EVENT_ELEM,
+	SNDRV_CTL_EVENT_OVERFLOW,	/* events were lost, no data */
+	SNDRV_CTL_EVENT_LAST = SNDRV_CTL_EVENT_OVERFLOW,
 };
 
 #define SNDRV_CTL_EVENT_MASK_VALUE	(1<<0)	/* element value was changed */
@@ -31,7 +31,7 @@
 #include <dkms/uapi/sound/compress_params.h>
 
 
-#define SNDRV_COMPRESS_VERSION SNDRV_PROTOCOL_VERSION(0, 2, 0)
+#define SNDRV_COMPRESS_VERSION SNDRV_PROTOCOL_VERSION(0, 2, 1)
 /**
  * struct snd_compressed_buffer - compressed buffer
  * @fragment_size: size of buffer fragment in bytes
@@ -160,6 +160,8 @@ struct snd_compr_metadata {
  * SNDRV_COMPRESS_STOP: stop a running stream, discarding ring buffer content
  * and the buffers currently with DSP
  * SNDRV_COMPRESS_DRAIN: Play till end of buffers and stop after that
+ * SNDRV_COMPRESS_COMMIT: account bytes written or read through the mmapped
+ * ring buffer
  * SNDRV_COMPRESS_IOCTL_VERSION: Query the API version
  */
 #define SNDRV_COMPRESS_IOCTL_VERSION	_IOR('C', 0x00, int)
@@ -181,11 +183,38 @@ struct snd_compr_metadata {
 #define SNDRV_COMPRESS_DRAIN		_IO('C', 0x34)
 #define SNDRV_COMPRESS_NEXT_TRACK	_IO('C', 0x35)
 #define SNDRV_COMPRESS_PARTIAL_DRAIN	_IO('C', 0x36)
+#define SNDRV_COMPRESS_COMMIT		_IOW('C', 0x37, __u32)
+
 /*
- * TODO
- * 1. add mmap support
+ * mmap of the ring buffer
  *
+ * The ring buffer of the drivers without a copy callback can be mmapped
+ * at SNDRV_COMPRESS_MMAP_OFFSET_DATA once the parameters are set; a
+ * playback stream has to be opened O_RDWR for a shared writable mapping.
+ * The application fills or drains the buffer in place and reports the
+ * bytes written or read with SNDRV_COMPRESS_COMMIT.  The positions are
+ * published in the read-only page at SNDRV_COMPRESS_MMAP_OFFSET_CONTROL.
  */
+#define SNDRV_COMPRESS_MMAP_OFFSET_DATA		0x00000000
+#define SNDRV_COMPRESS_MMAP_OFFSET_CONTROL	0x80000000
+
+/**
+ * struct snd_compr_mmap_control - stream positions shared with user-space
+ * @seq: odd while the kernel updates the record, read it until it is even
+ *	and unchanged around the read
+ * @state: stream state, SNDRV_PCM_STATE_*
+ * @appl_ptr: total bytes written (playback) or read (capture) by the app
+ * @hw_ptr: total bytes consumed (playback) or produced (capture) by the DSP
+ * @buffer_size: size of the ring buffer in bytes
+ */
+struct snd_compr_mmap_control {
+	__u32 seq;
+	__u32 state;
+	__u64 appl_ptr;
+	__u64 hw_ptr;
+	__u64 buffer_size;
+	__u8 reserved[32];
+} __attribute__((packed, aligned(4)));
 #define SND_COMPR_TRIGGER_DRAIN 7 /*FIXME move this to pcm.h */
 #define SND_COMPR_TRIGGER_NEXT_TRACK 8
 #define SND_COMPR_TRIGGER_PARTIAL_DRAIN 9
@@ -4,6 +4,7 @@
  * Copyright (c) Takashi Iwai <tiwai@suse.de>
  */
 
+#include <linux/async.h>
 #include <linux/init.h>
 #include <linux/slab.h>
 #include <linux/mutex.h>
@@ -225,6 +226,53 @@ static void request_codec_module(struct hda_codec *codec)
 }
 
 /* try to auto-load and bind the codec module */
+#if IS_ENABLED(CONFIG_SND_HDA_GENERIC)
+#define is_generic_config(codec) \
+	(codec->modelname && !strcmp(codec->modelname, "generic"))
+#else
+#define is_generic_config(codec)	0
+#endif
+
+#ifdef MODULE
+static ASYNC_DOMAIN_EXCLUSIVE(codec_preload_domain);
+
+static void codec_preload_work(void *data, async_cookie_t cookie)
+{
+	struct hda_codec *codec = data;
+	char modalias[32];
+
+	snd_hdac_codec_modalias(&codec->core, modalias, sizeof(modalias));
+	request_module(modalias);
+}
+#endif /* MODULE */
+
+/**
+ * snd_hda_codecs_preload - Load the codec drivers of a bus in parallel
+ * @bus: the HDA bus
+ *
+ * Request the driver module of each codec on the bus concurrently and wait
+ * for all of them, so that the following snd_hda_codec_configure() calls
+ * find their drivers already loaded instead of loading them one by one.
+ * The binding itself is left to snd_hda_codec_configure().
+ */
+void snd_hda_codecs_preload(struct hda_bus *bus)
+{
+#ifdef MODULE
+	struct hda_codec *codec;
+
+	if (bus->core.num_codecs < 2)
+		return;
+
+	list_for_each_codec(codec, bus) {
+		if (!codec->preset && !is_generic_config(codec))
+			async_schedule_domain(codec_preload_work, codec,
+					      &codec_preload_domain);
+	}
+	async_synchronize_full_domain(&codec_preload_domain);
+#endif
+}
+EXPORT_SYMBOL_GPL(snd_hda_codecs_preload);
+
 static void codec_bind_module(struct hda_codec *codec)
 {
 #ifdef MODULE
@@ -277,13 +325,6 @@ static int codec_bind_generic(struct hda_codec *codec)
 	return -ENODEV;
 }
 
-#if IS_ENABLED(CONFIG_SND_HDA_GENERIC)
-#define is_generic_config(codec) \
-	(codec->modelname && !strcmp(codec->modelname, "generic"))
-#else
-#define is_generic_config(codec)	0
-#endif
-
 /**
  * snd_hda_codec_configure - (Re-)configure the HD-audio codec
  * @codec: the HDA codec
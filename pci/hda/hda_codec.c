@@ -68,6 +68,25 @@ static int codec_exec_verb(struct hdac_device *dev, unsigned int cmd,
 	return err;
 }
 
+/* queue several verbs at once, see snd_hdac_bus_exec_verbs() */
+static int codec_exec_verbs(struct hdac_device *dev, const unsigned int *cmds,
+			    unsigned int *res, unsigned int count)
+{
+	struct hda_codec *codec = container_of(dev, struct hda_codec, core);
+	struct hda_bus *bus = codec->bus;
+	int err;
+
+	snd_hda_power_up_pm(codec);
+	mutex_lock(&bus->core.cmd_mutex);
+	err = snd_hdac_bus_exec_verbs_unlocked(&bus->core, cmds, res, count);
+	mutex_unlock(&bus->core.cmd_mutex);
+	snd_hda_power_down_pm(codec);
+	/* clear reset-flag when the communication gets recovered */
+	if (!err || codec_in_pm(codec))
+		bus->response_reset = 0;
+	return err;
+}
+
 /**
  * snd_hda_sequence_write - sequence writes
  * @codec: the HDA codec
@@ -78,8 +97,10 @@ static int codec_exec_verb(struct hdac_device *dev, unsigned int cmd,
  */
 void snd_hda_sequence_write(struct hda_codec *codec, const struct hda_verb *seq)
 {
+	snd_hdac_batch_verbs_begin(&codec->core);
 	for (; seq->nid; seq++)
 		snd_hda_codec_write(codec, seq->nid, 0, seq->verb, seq->param);
+	snd_hdac_batch_verbs_end(&codec->core);
 }
 EXPORT_SYMBOL_GPL(snd_hda_sequence_write);
 
@@ -91,11 +112,17 @@ struct hda_conn_list {
 	hda_nid_t conns[];
 };
 
+/* size of the conn_index table, covering all NIDs a verb can address */
+#define HDA_CONN_INDEX_SIZE	0x80
+
 /* look up the cached results */
 static struct hda_conn_list *
 lookup_conn_list(struct hda_codec *codec, hda_nid_t nid)
 {
 	struct hda_conn_list *p;
+
+	if (nid < HDA_CONN_INDEX_SIZE)
+		return codec->conn_index[nid];
 	list_for_each_entry(p, &codec->conn_list, list) {
 		if (p->nid == nid)
 			return p;
@@ -115,6 +142,8 @@ static int add_conn_list(struct hda_codec *codec, hda_nid_t nid, int len,
 	p->nid = nid;
 	memcpy(p->conns, list, len * sizeof(hda_nid_t));
 	list_add(&p->list, &codec->conn_list);
+	if (nid < HDA_CONN_INDEX_SIZE)
+		codec->conn_index[nid] = p;
 	return 0;
 }
 
@@ -126,6 +155,137 @@ static void remove_conn_list(struct hda_codec *codec)
 		list_del(&p->list);
 		kfree(p);
 	}
+	if (codec->conn_index)
+		memset(codec->conn_index, 0,
+		       HDA_CONN_INDEX_SIZE * sizeof(*codec->conn_index));
+	codec->conn_gen++;
+}
+
+/*
+ * Topology snapshots
+ *
+ * The raw widget caps and connection lists of each codec model, as read
+ * from the hardware before any driver override, are kept until the module
+ * is unloaded.  A codec with the same vendor, subsystem and revision IDs
+ * and the same widget range reuses them on a rebind or a reprobe after a
+ * cheap check, instead of querying every widget again.
+ */
+struct hda_topology {
+	struct list_head list;
+	u32 vendor_id;
+	u32 subsystem_id;
+	u32 revision_id;
+	hda_nid_t start_nid;
+	int num_nodes;
+	struct list_head conn_list;	/* raw connection lists read so far */
+	u32 wcaps[];
+};
+
+static LIST_HEAD(hda_topologies);
+static DEFINE_MUTEX(hda_topology_mutex);
+
+static bool topology_match(struct hda_codec *codec, struct hda_topology *t)
+{
+	return t->vendor_id == codec->core.vendor_id &&
+		t->subsystem_id == codec->core.subsystem_id &&
+		t->revision_id == codec->core.revision_id &&
+		t->start_nid == codec->core.start_nid &&
+		t->num_nodes == codec->core.num_nodes;
+}
+
+/* look up the snapshot for the codec, NULL if none */
+static struct hda_topology *lookup_topology(struct hda_codec *codec)
+{
+	struct hda_topology *t;
+
+	mutex_lock(&hda_topology_mutex);
+	list_for_each_entry(t, &hda_topologies, list) {
+		if (topology_match(codec, t))
+			goto unlock;
+	}
+	t = NULL;
+ unlock:
+	mutex_unlock(&hda_topology_mutex);
+	return t;
+}
+
+/* record the widget caps just read from the codec as a new snapshot */
+static void add_topology(struct hda_codec *codec)
+{
+	struct hda_topology *t;
+
+	t = kmalloc(struct_size(t, wcaps, codec->core.num_nodes), GFP_KERNEL);
+	if (!t)
+		return;
+	t->vendor_id = codec->core.vendor_id;
+	t->subsystem_id = codec->core.subsystem_id;
+	t->revision_id = codec->core.revision_id;
+	t->start_nid = codec->core.start_nid;
+	t->num_nodes = codec->core.num_nodes;
+	INIT_LIST_HEAD(&t->conn_list);
+	memcpy(t->wcaps, codec->wcaps, codec->core.num_nodes * 4);
+
+	mutex_lock(&hda_topology_mutex);
+	list_add(&t->list, &hda_topologies);
+	mutex_unlock(&hda_topology_mutex);
+	codec->topology = t;
+}
+
+static void free_topologies(void)
+{
+	struct hda_topology *t, *n;
+	struct hda_conn_list *p, *q;
+
+	list_for_each_entry_safe(t, n, &hda_topologies, list) {
+		list_for_each_entry_safe(p, q, &t->conn_list, list)
+			kfree(p);
+		kfree(t);
+	}
+}
+
+/* copy the raw connection list from the snapshot, -ENOENT if not there */
+static int get_topology_conns(struct hda_codec *codec, hda_nid_t nid,
+			      hda_nid_t **listp, hda_nid_t *buf, int size)
+{
+	struct hda_topology *t = codec->topology;
+	struct hda_conn_list *p;
+	int len = -ENOENT;
+
+	mutex_lock(&hda_topology_mutex);
+	list_for_each_entry(p, &t->conn_list, list) {
+		if (p->nid != nid)
+			continue;
+		len = p->len;
+		if (len > size) {
+			*listp = kmemdup(p->conns, len * sizeof(hda_nid_t),
+					 GFP_KERNEL);
+			if (!*listp)
+				len = -ENOMEM;
+		} else {
+			*listp = buf;
+			memcpy(buf, p->conns, len * sizeof(hda_nid_t));
+		}
+		break;
+	}
+	mutex_unlock(&hda_topology_mutex);
+	return len;
+}
+
+static void add_topology_conns(struct hda_codec *codec, hda_nid_t nid,
+			       int len, const hda_nid_t *list)
+{
+	struct hda_conn_list *p;
+
+	p = kmalloc(struct_size(p, conns, len), GFP_KERNEL);
+	if (!p)
+		return;
+	p->len = len;
+	p->nid = nid;
+	memcpy(p->conns, list, len * sizeof(hda_nid_t));
+
+	mutex_lock(&hda_topology_mutex);
+	list_add(&p->list, &codec->topology->conn_list);
+	mutex_unlock(&hda_topology_mutex);
 }
 
 /* read the connection and add to the cache */
@@ -135,6 +295,13 @@ static int read_and_add_raw_conns(struct hda_codec *codec, hda_nid_t nid)
 	hda_nid_t *result = list;
 	int len;
 
+	if (codec->topology) {
+		len = get_topology_conns(codec, nid, &result, list,
+					 ARRAY_SIZE(list));
+		if (len != -ENOENT)
+			goto add;
+	}
+
 	len = snd_hda_get_raw_connections(codec, nid, list, ARRAY_SIZE(list));
 	if (len == -ENOSPC) {
 		len = snd_hda_get_num_raw_conns(codec, nid);
@@ -143,6 +310,9 @@ static int read_and_add_raw_conns(struct hda_codec *codec, hda_nid_t nid)
 			return -ENOMEM;
 		len = snd_hda_get_raw_connections(codec, nid, result, len);
 	}
+	if (len >= 0 && codec->topology)
+		add_topology_conns(codec, nid, len, result);
+ add:
 	if (len >= 0)
 		len = snd_hda_override_conn_list(codec, nid, len, result);
 	if (result != list)
@@ -243,7 +413,11 @@ int snd_hda_override_conn_list(struct hda_codec *codec, hda_nid_t nid, int len,
 	p = lookup_conn_list(codec, nid);
 	if (p) {
 		list_del(&p->list);
+		if (nid < HDA_CONN_INDEX_SIZE)
+			codec->conn_index[nid] = NULL;
 		kfree(p);
+		/* invalidate the results derived from the old list */
+		codec->conn_gen++;
 	}
 
 	return add_conn_list(codec, nid, len, list);
@@ -411,28 +585,114 @@ int snd_hda_set_dev_select(struct hda_codec *codec, hda_nid_t nid, int dev_id)
 EXPORT_SYMBOL_GPL(snd_hda_set_dev_select);
 
 /*
- * read widget caps for each widget and store in cache
+ * check a snapshot against the codec: the caps of the first and the last
+ * widgets must still be the same
  */
-static int read_widget_caps(struct hda_codec *codec, hda_nid_t fg_node)
+static bool validate_topology(struct hda_codec *codec, struct hda_topology *t)
 {
+	int last = t->num_nodes - 1;
+
+	return snd_hdac_read_parm_uncached(&codec->core, t->start_nid,
+					   AC_PAR_AUDIO_WIDGET_CAP) ==
+		t->wcaps[0] &&
+		snd_hdac_read_parm_uncached(&codec->core, t->start_nid + last,
+					    AC_PAR_AUDIO_WIDGET_CAP) ==
+		t->wcaps[last];
+}
+
+/*
+ * read widget caps for each widget and store in cache;
+ * the topology snapshot is skipped when @refresh is set
+ */
+static int read_widget_caps(struct hda_codec *codec, hda_nid_t fg_node,
+			    bool refresh)
+{
+	struct hda_topology *t = NULL;
 	int i;
 	hda_nid_t nid;
 
 	codec->wcaps = kmalloc_array(codec->core.num_nodes, 4, GFP_KERNEL);
 	if (!codec->wcaps)
 		return -ENOMEM;
+
+	if (!refresh) {
+		t = lookup_topology(codec);
+		if (t && validate_topology(codec, t)) {
+			memcpy(codec->wcaps, t->wcaps, t->num_nodes * 4);
+			codec->topology = t;
+			return 0;
+		}
+	}
+
+	/* read all the caps at once; the responses land in wcaps */
+	nid = codec->core.start_nid;
+	for (i = 0; i < codec->core.num_nodes; i++, nid++)
+		codec->wcaps[i] = snd_hda_codec_verb_cmd(codec, nid,
+							 AC_VERB_PARAMETERS,
+							 AC_PAR_AUDIO_WIDGET_CAP);
+	if (!snd_hdac_exec_verbs(&codec->core, codec->wcaps, codec->wcaps,
+				 codec->core.num_nodes))
+		goto done;
+
 	nid = codec->core.start_nid;
 	for (i = 0; i < codec->core.num_nodes; i++, nid++)
 		codec->wcaps[i] = snd_hdac_read_parm_uncached(&codec->core,
 					nid, AC_PAR_AUDIO_WIDGET_CAP);
+ done:
+	/* a stale snapshot is left alone, a new one is only made once */
+	if (!refresh && !t)
+		add_topology(codec);
 	return 0;
 }
 
 /* read all pin default configurations and save codec->init_pins */
 static int read_pin_defaults(struct hda_codec *codec)
 {
+	unsigned int *cmds, *res;
 	hda_nid_t nid;
+	int i, npins = 0;
+
+	/* read the config and control of all pins at once if possible */
+	for_each_hda_codec_node(nid, codec)
+		if (get_wcaps_type(get_wcaps(codec, nid)) == AC_WID_PIN)
+			npins++;
+	cmds = kmalloc_array(npins, 4 * sizeof(*cmds), GFP_KERNEL);
+	if (!cmds)
+		goto fallback;
+	res = cmds + 2 * npins;
+	i = 0;
+	for_each_hda_codec_node(nid, codec) {
+		if (get_wcaps_type(get_wcaps(codec, nid)) != AC_WID_PIN)
+			continue;
+		cmds[i++] = snd_hda_codec_verb_cmd(codec, nid,
+						   AC_VERB_GET_CONFIG_DEFAULT, 0);
+		cmds[i++] = snd_hda_codec_verb_cmd(codec, nid,
+						   AC_VERB_GET_PIN_WIDGET_CONTROL,
+						   0);
+	}
+	if (snd_hdac_exec_verbs(&codec->core, cmds, res, 2 * npins)) {
+		kfree(cmds);
+		goto fallback;
+	}
+	i = 0;
+	for_each_hda_codec_node(nid, codec) {
+		struct hda_pincfg *pin;
+
+		if (get_wcaps_type(get_wcaps(codec, nid)) != AC_WID_PIN)
+			continue;
+		pin = snd_array_new(&codec->init_pins);
+		if (!pin) {
+			kfree(cmds);
+			return -ENOMEM;
+		}
+		pin->nid = nid;
+		pin->cfg = res[i++];
+		pin->ctrl = res[i++];
+	}
+	kfree(cmds);
+	return 0;
 
+ fallback:
 	for_each_hda_codec_node(nid, codec) {
 		struct hda_pincfg *pin;
 		unsigned int wcaps = get_wcaps(codec, nid);
@@ -640,15 +900,37 @@ static void hda_jackpoll_work(struct work_struct *work)
 {
 	struct hda_codec *codec =
 		container_of(work, struct hda_codec, jackpoll_work.work);
+	int changed, active = -EINVAL;
+
+	/*
+	 * with jackpoll_in_use, the polling alone doesn't keep the codec
+	 * powered; it's done only while the codec is used for other reasons,
+	 * and at resume
+	 */
+	if (codec->jackpoll_in_use && !codec_in_pm(codec)) {
+		active = pm_runtime_get_if_in_use(hda_codec_dev(codec));
+		if (!active)
+			goto reschedule;
+	}
 
 	snd_hda_jack_set_dirty_all(codec);
-	snd_hda_jack_poll_all(codec);
+	changed = snd_hda_jack_poll_all(codec);
+
+	if (active > 0)
+		pm_runtime_put_autosuspend(hda_codec_dev(codec));
 
+	/* double the interval at each idle poll, up to 8 times */
+	if (!codec->jackpoll_backoff || changed)
+		codec->jackpoll_shift = 0;
+	else if (codec->jackpoll_shift < 3)
+		codec->jackpoll_shift++;
+
+ reschedule:
 	if (!codec->jackpoll_interval)
 		return;
 
 	schedule_delayed_work(&codec->jackpoll_work,
-			      codec->jackpoll_interval);
+			      codec->jackpoll_interval << codec->jackpoll_shift);
 }
 
 /* release all pincfg lists */
@@ -846,6 +1128,7 @@ static void snd_hda_codec_dev_release(struct device *dev)
 	snd_hda_sysfs_clear(codec);
 	kfree(codec->modelname);
 	kfree(codec->wcaps);
+	kfree(codec->conn_index);
 
 	/*
 	 * In the case of ASoC HD-audio, hda_codec is device managed.
@@ -930,6 +1213,7 @@ int snd_hda_codec_device_new(struct hda_bus *bus, struct snd_card *card,
 
 	codec->core.dev.release = snd_hda_codec_dev_release;
 	codec->core.exec_verb = codec_exec_verb;
+	codec->core.exec_verbs = codec_exec_verbs;
 
 	codec->bus = bus;
 	codec->card = card;
@@ -957,6 +1241,13 @@ int snd_hda_codec_device_new(struct hda_bus *bus, struct snd_card *card,
 
 	snd_hda_sysfs_init(codec);
 
+	codec->conn_index = kcalloc(HDA_CONN_INDEX_SIZE,
+				    sizeof(*codec->conn_index), GFP_KERNEL);
+	if (!codec->conn_index) {
+		err = -ENOMEM;
+		goto error;
+	}
+
 	if (codec->bus->modelname) {
 		codec->modelname = kstrdup(codec->bus->modelname, GFP_KERNEL);
 		if (!codec->modelname) {
@@ -966,7 +1257,7 @@ int snd_hda_codec_device_new(struct hda_bus *bus, struct snd_card *card,
 	}
 
 	fg = codec->core.afg ? codec->core.afg : codec->core.mfg;
-	err = read_widget_caps(codec, fg);
+	err = read_widget_caps(codec, fg, false);
 	if (err < 0)
 		goto error;
 	err = read_pin_defaults(codec);
@@ -1017,8 +1308,9 @@ int snd_hda_codec_update_widgets(struct hda_codec *codec)
 	 * only the widget nodes may change.
 	 */
 	kfree(codec->wcaps);
+	codec->topology = NULL;
 	fg = codec->core.afg ? codec->core.afg : codec->core.mfg;
-	err = read_widget_caps(codec, fg);
+	err = read_widget_caps(codec, fg, true);
 	if (err < 0)
 		return err;
 
@@ -2900,9 +3192,18 @@ static void hda_call_codec_resume(struct hda_codec *codec)
 
 	codec->power_jiffies = jiffies;
 
+	/*
+	 * Queue the writes of the generic power-up sequence: they are sent
+	 * in batches, and only flushed ahead of a read, e.g. while polling
+	 * the power state to settle.  The init and resume callbacks of the
+	 * codec driver may rely on delays between their verbs, so they
+	 * aren't batched here.
+	 */
+	snd_hdac_batch_verbs_begin(&codec->core);
 	hda_set_power_state(codec, AC_PWRST_D0);
 	restore_shutup_pins(codec);
 	hda_exec_init_verbs(codec);
+	snd_hdac_batch_verbs_end(&codec->core);
 	snd_hda_jack_set_dirty_all(codec);
 	if (codec->patch_ops.resume)
 		codec->patch_ops.resume(codec);
@@ -4029,4 +4330,10 @@ void snd_print_pcm_bits(int pcm, char *buf, int buflen)
 EXPORT_SYMBOL_GPL(snd_print_pcm_bits);
 
 MODULE_DESCRIPTION("HDA codec core");
+static void __exit hda_codec_exit(void)
+{
+	free_topologies();
+}
+module_exit(hda_codec_exit);
+
 MODULE_LICENSE("GPL");
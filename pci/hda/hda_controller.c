@@ -296,8 +296,15 @@ unsigned int azx_get_position(struct azx *chip,
 
 	if (chip->get_position[stream])
 		pos = chip->get_position[stream](chip, azx_dev);
-	else /* use the position buffer as default */
+	else { /* use the position buffer as default */
 		pos = azx_get_pos_posbuf(chip, azx_dev);
+		/*
+		 * a stream without period IRQs never gets the position method
+		 * checked; don't trust a position buffer that isn't written
+		 */
+		if (pos == (u32)-1 && azx_dev->core.no_period_wakeup)
+			pos = azx_get_pos_lpib(chip, azx_dev);
+	}
 
 	if (pos >= azx_dev->core.bufsize)
 		pos = 0;
@@ -779,15 +786,42 @@ static unsigned int azx_command_addr(u32 cmd)
 }
 
 /* receive a response */
+/* account the time waited for a response in the codec statistics */
+static void azx_count_rirb_wait(struct hdac_device *codec, ktime_t start,
+				int err)
+{
+	s64 us = ktime_us_delta(ktime_get(), start);
+	int i;
+
+	if (err) {
+		codec->stats.rirb_timeouts++;
+		return;
+	}
+	for (i = 0; i < HDAC_STATS_RIRB_WAITS - 1; i++)
+		if (us < (16 << (2 * i)))
+			break;
+	codec->stats.rirb_waits[i]++;
+}
+
+static void azx_count_fallback(struct hdac_device *codec)
+{
+	if (codec)
+		codec->stats.fallbacks++;
+}
+
 static int azx_rirb_get_response(struct hdac_bus *bus, unsigned int addr,
 				 unsigned int *res)
 {
 	struct azx *chip = bus_to_azx(bus);
 	struct hda_bus *hbus = &chip->bus;
+	struct hdac_device *codec = bus->caddr_tbl[addr];
+	ktime_t start = ktime_get();
 	int err;
 
  again:
 	err = snd_hdac_bus_get_response(bus, addr, res);
+	if (codec)
+		azx_count_rirb_wait(codec, start, err);
 	if (!err)
 		return 0;
 
@@ -795,6 +829,7 @@ static int azx_rirb_get_response(struct hdac_bus *bus, unsigned int addr,
 		return -EIO;
 
 	if (!bus->polling_mode) {
+		azx_count_fallback(codec);
 		dev_warn(chip->card->dev,
 			 "azx_get_response timeout, switching to polling mode: last cmd=0x%08x\n",
 			 bus->last_cmd[addr]);
@@ -803,6 +838,7 @@ static int azx_rirb_get_response(struct hdac_bus *bus, unsigned int addr,
 	}
 
 	if (chip->msi) {
+		azx_count_fallback(codec);
 		dev_warn(chip->card->dev,
 			 "No response from codec, disabling MSI: last cmd=0x%08x\n",
 			 bus->last_cmd[addr]);
@@ -829,6 +865,7 @@ static int azx_rirb_get_response(struct hdac_bus *bus, unsigned int addr,
 	 */
 	if (hbus->allow_bus_reset && !hbus->response_reset && !hbus->in_reset) {
 		hbus->response_reset = 1;
+		azx_count_fallback(codec);
 		dev_err(chip->card->dev,
 			"No response from codec, resetting bus: last cmd=0x%08x\n",
 			bus->last_cmd[addr]);
@@ -838,7 +875,9 @@ static int azx_rirb_get_response(struct hdac_bus *bus, unsigned int addr,
 	dev_err(chip->card->dev,
 		"azx_get_response timeout, switching to single_cmd mode: last cmd=0x%08x\n",
 		bus->last_cmd[addr]);
+	azx_count_fallback(codec);
 	chip->single_cmd = 1;
+	bus->cmd_batch = 0;
 	hbus->response_reset = 0;
 	snd_hdac_bus_stop_cmd_io(bus);
 	return -EIO;
@@ -1196,6 +1235,8 @@ int azx_bus_init(struct azx *chip, const char *model)
 	    chip->get_position[1] != azx_get_pos_lpib)
 		bus->core.use_posbuf = true;
 	bus->core.bdl_pos_adj = chip->bdl_pos_adj;
+	/* the immediate command interface handles one verb at a time */
+	bus->core.cmd_batch = !chip->single_cmd;
 	if (chip->driver_caps & AZX_DCAPS_CORBRP_SELF_CLEAR)
 		bus->core.corbrp_self_clear = true;
 
@@ -1257,6 +1298,8 @@ int azx_probe_codecs(struct azx *chip, unsigned int max_slots)
 			if (err < 0)
 				continue;
 			codec->jackpoll_interval = chip->jackpoll_interval;
+			codec->jackpoll_backoff = chip->jackpoll_backoff;
+			codec->jackpoll_in_use = chip->jackpoll_in_use;
 			codec->beep_mode = chip->beep_mode;
 			codecs++;
 		}
@@ -1274,6 +1317,9 @@ int azx_codec_configure(struct azx *chip)
 {
 	struct hda_codec *codec, *next;
 
+	/* load the codec drivers concurrently before binding them in order */
+	snd_hda_codecs_preload(&chip->bus);
+
 	/* use _safe version here since snd_hda_codec_configure() deregisters
 	 * the device upon error and deletes itself from the bus list.
 	 */
@@ -1338,7 +1384,7 @@ void azx_free_streams(struct azx *chip)
 
 	while (!list_empty(&bus->stream_list)) {
 		s = list_first_entry(&bus->stream_list, struct hdac_stream, list);
-		list_del(&s->list);
+		snd_hdac_stream_remove(s);
 		kfree(stream_to_azx_dev(s));
 	}
 }
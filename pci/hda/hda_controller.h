@@ -109,6 +109,8 @@ struct azx {
 	int capture_index_offset;
 	int num_streams;
 	int jackpoll_interval; /* jack poll interval in jiffies */
+	unsigned int jackpoll_backoff:1; /* see hda_codec.jackpoll_backoff */
+	unsigned int jackpoll_in_use:1; /* see hda_codec.jackpoll_in_use */
 
 	/* Register interaction. */
 	const struct hda_controller_ops *ops;
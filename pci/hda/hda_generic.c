@@ -14,6 +14,7 @@
 #include <linux/delay.h>
 #include <linux/ctype.h>
 #include <linux/string.h>
+#include <linux/bitmap.h>
 #include <linux/bitops.h>
 #include <linux/module.h>
 #include <linux/leds.h>
@@ -91,6 +92,9 @@ static void snd_hda_gen_spec_free(struct hda_gen_spec *spec)
 	free_kctls(spec);
 	snd_array_free(&spec->paths);
 	snd_array_free(&spec->loopback_list);
+	bitmap_free(spec->reach_known);
+	bitmap_free(spec->reach_ok);
+	spec->reach_known = spec->reach_ok = NULL;
 }
 
 /*
@@ -323,13 +327,63 @@ static bool is_dac_already_used(struct hda_codec *codec, hda_nid_t nid)
 	return false;
 }
 
-/* check whether the given two widgets can be connected */
+/* NIDs covered by the is_reachable_path() memo */
+#define REACH_MEMO_NIDS		0x80
+
+/* allocate the memo, or reset it if a connection list changed meanwhile */
+static bool reach_memo_ready(struct hda_codec *codec)
+{
+	struct hda_gen_spec *spec = codec->spec;
+	unsigned int bits = REACH_MEMO_NIDS * REACH_MEMO_NIDS;
+
+	if (!spec->reach_known) {
+		spec->reach_known = bitmap_zalloc(bits, GFP_KERNEL);
+		spec->reach_ok = bitmap_zalloc(bits, GFP_KERNEL);
+		if (!spec->reach_known || !spec->reach_ok) {
+			bitmap_free(spec->reach_known);
+			bitmap_free(spec->reach_ok);
+			spec->reach_known = spec->reach_ok = NULL;
+			return false;
+		}
+		spec->reach_gen = codec->conn_gen;
+	} else if (spec->reach_gen != codec->conn_gen) {
+		bitmap_zero(spec->reach_known, bits);
+		spec->reach_gen = codec->conn_gen;
+	}
+	return true;
+}
+
+/*
+ * check whether the given two widgets can be connected;
+ * the assignment code asks the same pairs over and over while evaluating
+ * the DAC combinations, so the results of the recursive search are kept
+ * until a connection list is overridden
+ */
 static bool is_reachable_path(struct hda_codec *codec,
 			      hda_nid_t from_nid, hda_nid_t to_nid)
 {
+	struct hda_gen_spec *spec = codec->spec;
+	unsigned int bit;
+	bool ok;
+
 	if (!from_nid || !to_nid)
 		return false;
-	return snd_hda_get_conn_index(codec, to_nid, from_nid, true) >= 0;
+	if (from_nid >= REACH_MEMO_NIDS || to_nid >= REACH_MEMO_NIDS ||
+	    !reach_memo_ready(codec))
+		return snd_hda_get_conn_index(codec, to_nid, from_nid,
+					      true) >= 0;
+
+	bit = from_nid * REACH_MEMO_NIDS + to_nid;
+	if (test_bit(bit, spec->reach_known))
+		return test_bit(bit, spec->reach_ok);
+
+	ok = snd_hda_get_conn_index(codec, to_nid, from_nid, true) >= 0;
+	__set_bit(bit, spec->reach_known);
+	if (ok)
+		__set_bit(bit, spec->reach_ok);
+	else
+		__clear_bit(bit, spec->reach_ok);
+	return ok;
 }
 
 /* nid, dir and idx */
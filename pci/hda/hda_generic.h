@@ -175,6 +175,11 @@ struct hda_gen_spec {
 	/* path list */
 	struct snd_array paths;
 
+	/* memoized is_reachable_path() results, per (from, to) NID pair */
+	unsigned long *reach_known;
+	unsigned long *reach_ok;
+	unsigned int reach_gen;		/* codec->conn_gen of the results */
+
 	/* path indices */
 	int out_paths[AUTO_CFG_MAX_OUTS];
 	int hp_paths[AUTO_CFG_MAX_OUTS];
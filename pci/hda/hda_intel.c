@@ -116,6 +116,8 @@ static int bdl_pos_adj[SNDRV_CARDS] = {[0 ... (SNDRV_CARDS-1)] = -1};
 static int probe_mask[SNDRV_CARDS] = {[0 ... (SNDRV_CARDS-1)] = -1};
 static int probe_only[SNDRV_CARDS];
 static int jackpoll_ms[SNDRV_CARDS];
+static bool jackpoll_backoff;
+static bool jackpoll_in_use;
 static int single_cmd = -1;
 static int enable_msi = -1;
 #ifdef CONFIG_SND_HDA_PATCH_LOADER
@@ -146,6 +148,10 @@ module_param_array(probe_only, int, NULL, 0444);
 MODULE_PARM_DESC(probe_only, "Only probing and no codec initialization.");
 module_param_array(jackpoll_ms, int, NULL, 0444);
 MODULE_PARM_DESC(jackpoll_ms, "Ms between polling for jack events (default = 0, using unsol events only)");
+module_param(jackpoll_backoff, bool, 0444);
+MODULE_PARM_DESC(jackpoll_backoff, "Slow down jack polling up to 8 times while nothing changes.");
+module_param(jackpoll_in_use, bool, 0444);
+MODULE_PARM_DESC(jackpoll_in_use, "Poll jacks only while the codec is powered for other reasons.");
 module_param(single_cmd, bint, 0444);
 MODULE_PARM_DESC(single_cmd, "Use single command to communicate with codecs "
 		 "(for debugging only).");
@@ -643,6 +649,75 @@ static int azx_get_delay_from_lpib(struct azx *chip, struct azx_dev *azx_dev,
 
 static int azx_position_ok(struct azx *chip, struct azx_dev *azx_dev);
 
+/* number of period IRQs sampled before choosing the position method */
+#define AZX_POS_CALIB_PERIODS	8
+
+/* the position looks behind the period boundary the IRQ was issued for */
+static bool azx_position_late(struct azx_dev *azx_dev, u32 wallclk,
+			      unsigned int pos)
+{
+	if (pos >= azx_dev->core.bufsize)
+		pos = 0;
+	return wallclk < (azx_dev->core.period_wallclk * 5) / 4 &&
+		pos % azx_dev->core.period_bytes >
+		azx_dev->core.period_bytes / 2;
+}
+
+static void azx_use_pos_lpib(struct azx *chip, int stream)
+{
+	chip->get_position[stream] = azx_get_pos_lpib;
+	if (chip->get_position[0] == azx_get_pos_lpib &&
+	    chip->get_position[1] == azx_get_pos_lpib)
+		azx_bus(chip)->use_posbuf = false;
+	chip->get_delay[stream] = NULL;
+}
+
+/*
+ * position_fix=auto: the position buffer is used if valid, and checked
+ * against LPIB at each of the first period IRQs.  The method giving the
+ * fewer positions behind the period boundary is kept for the stream
+ * direction, so that the IRQs don't need to be deferred afterwards.
+ */
+static unsigned int azx_auto_position(struct azx *chip,
+				      struct azx_dev *azx_dev, u32 wallclk)
+{
+	struct hda_intel *hda = container_of(chip, struct hda_intel, chip);
+	int stream = azx_dev->core.substream->stream;
+	unsigned int pos, lpib;
+
+	pos = azx_get_pos_posbuf(chip, azx_dev);
+	if (!pos || pos == (u32)-1) {
+		dev_info(chip->card->dev,
+			 "Invalid position buffer, using LPIB read method instead.\n");
+		azx_use_pos_lpib(chip, stream);
+		return azx_get_pos_lpib(chip, azx_dev);
+	}
+
+	lpib = azx_get_pos_lpib(chip, azx_dev);
+	if (azx_position_late(azx_dev, wallclk, pos))
+		hda->pos_late_posbuf[stream]++;
+	if (azx_position_late(azx_dev, wallclk, lpib))
+		hda->pos_late_lpib[stream]++;
+	if (++hda->pos_samples[stream] < AZX_POS_CALIB_PERIODS)
+		return pos;
+
+	dev_dbg(chip->card->dev,
+		"%s position late: posbuf %u, LPIB %u of %u periods\n",
+		stream ? "capture" : "playback",
+		hda->pos_late_posbuf[stream], hda->pos_late_lpib[stream],
+		hda->pos_samples[stream]);
+
+	if (hda->pos_late_lpib[stream] < hda->pos_late_posbuf[stream]) {
+		azx_use_pos_lpib(chip, stream);
+		return lpib;
+	}
+
+	chip->get_position[stream] = azx_get_pos_posbuf;
+	if (chip->driver_caps & AZX_DCAPS_COUNT_LPIB_DELAY)
+		chip->get_delay[stream] = azx_get_delay_from_lpib;
+	return pos;
+}
+
 /* called from IRQ */
 static int azx_position_check(struct azx *chip, struct azx_dev *azx_dev)
 {
@@ -684,34 +759,16 @@ static int azx_position_ok(struct azx *chip, struct azx_dev *azx_dev)
 	if (wallclk < (azx_dev->core.period_wallclk * 2) / 3)
 		return -1;	/* bogus (too early) interrupt */
 
-	if (chip->get_position[stream])
-		pos = chip->get_position[stream](chip, azx_dev);
-	else { /* use the position buffer as default */
-		pos = azx_get_pos_posbuf(chip, azx_dev);
-		if (!pos || pos == (u32)-1) {
-			dev_info(chip->card->dev,
-				 "Invalid position buffer, using LPIB read method instead.\n");
-			chip->get_position[stream] = azx_get_pos_lpib;
-			if (chip->get_position[0] == azx_get_pos_lpib &&
-			    chip->get_position[1] == azx_get_pos_lpib)
-				azx_bus(chip)->use_posbuf = false;
-			pos = azx_get_pos_lpib(chip, azx_dev);
-			chip->get_delay[stream] = NULL;
-		} else {
-			chip->get_position[stream] = azx_get_pos_posbuf;
-			if (chip->driver_caps & AZX_DCAPS_COUNT_LPIB_DELAY)
-				chip->get_delay[stream] = azx_get_delay_from_lpib;
-		}
-	}
-
-	if (pos >= azx_dev->core.bufsize)
-		pos = 0;
-
 	if (WARN_ONCE(!azx_dev->core.period_bytes,
 		      "hda-intel: zero azx_dev->period_bytes"))
 		return -1; /* this shouldn't happen! */
-	if (wallclk < (azx_dev->core.period_wallclk * 5) / 4 &&
-	    pos % azx_dev->core.period_bytes > azx_dev->core.period_bytes / 2)
+
+	if (chip->get_position[stream])
+		pos = chip->get_position[stream](chip, azx_dev);
+	else /* use the position buffer as default */
+		pos = azx_auto_position(chip, azx_dev, wallclk);
+
+	if (azx_position_late(azx_dev, wallclk, pos))
 		/* NG - it's below the first next period boundary */
 		return chip->bdl_pos_adj ? 0 : -1;
 	azx_dev->core.start_wallclk += wallclk;
@@ -1786,6 +1843,8 @@ static int azx_create(struct snd_card *card, struct pci_dev *pci,
 	chip->dev_index = dev;
 	if (jackpoll_ms[dev] >= 50 && jackpoll_ms[dev] <= 60000)
 		chip->jackpoll_interval = msecs_to_jiffies(jackpoll_ms[dev]);
+	chip->jackpoll_backoff = jackpoll_backoff;
+	chip->jackpoll_in_use = jackpoll_in_use;
 	INIT_LIST_HEAD(&chip->pcm_list);
 	INIT_WORK(&hda->irq_pending_work, azx_irq_pending_work);
 	INIT_LIST_HEAD(&hda->list);
@@ -12,6 +12,11 @@ struct hda_intel {
 	/* for pending irqs */
 	struct work_struct irq_pending_work;
 
+	/* position_fix=auto calibration, per stream direction */
+	unsigned int pos_samples[2];
+	unsigned int pos_late_posbuf[2];
+	unsigned int pos_late_lpib[2];
+
 	/* sync probing */
 	struct completion probe_wait;
 	struct work_struct probe_work;
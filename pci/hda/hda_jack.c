@@ -189,6 +189,8 @@ static void jack_detect_update(struct hda_codec *codec,
 
 	if (jack->phantom_jack)
 		jack->pin_sense = AC_PINSENSE_PRESENCE;
+	else if (jack->sense_fetched)
+		jack->sense_fetched = 0;
 	else
 		jack->pin_sense = read_pin_sense(codec, jack->nid,
 						 jack->dev_id);
@@ -372,11 +374,50 @@ EXPORT_SYMBOL_GPL(snd_hda_jack_set_gating_jack);
  * snd_hda_jack_report_sync - sync the states of all jacks and report if changed
  * @codec: the HDA codec
  */
+/*
+ * read the pin sense of the dirty jacks not needing a trigger with a single
+ * batch of verbs; jack_detect_update() then reads only the others
+ */
+static void jack_fetch_sense(struct hda_codec *codec)
+{
+	struct hda_jack_tbl *jacks[HDAC_VERB_BATCH];
+	unsigned int cmds[HDAC_VERB_BATCH];
+	struct hda_jack_tbl *jack;
+	int i, n = 0;
+
+	jack = codec->jacktbl.list;
+	for (i = 0; i < codec->jacktbl.used && n < ARRAY_SIZE(cmds);
+	     i++, jack++) {
+		if (!jack->nid || !jack->jack_dirty || jack->phantom_jack)
+			continue;
+		if (!codec->no_trigger_sense &&
+		    (snd_hda_query_pin_caps(codec, jack->nid) &
+		     AC_PINCAP_TRIG_REQ))
+			continue;
+		cmds[n] = snd_hda_codec_verb_cmd(codec, jack->nid,
+						 AC_VERB_GET_PIN_SENSE,
+						 jack->dev_id);
+		jacks[n++] = jack;
+	}
+
+	if (n < 2 || snd_hdac_exec_verbs(&codec->core, cmds, cmds, n))
+		return;
+
+	for (i = 0; i < n; i++) {
+		jacks[i]->pin_sense = cmds[i];
+		if (codec->inv_jack_detect)
+			jacks[i]->pin_sense ^= AC_PINSENSE_PRESENCE;
+		jacks[i]->sense_fetched = 1;
+	}
+}
+
 void snd_hda_jack_report_sync(struct hda_codec *codec)
 {
 	struct hda_jack_tbl *jack;
 	int i, state;
 
+	jack_fetch_sense(codec);
+
 	/* update all jacks at first */
 	jack = codec->jacktbl.list;
 	for (i = 0; i < codec->jacktbl.used; i++, jack++)
@@ -644,12 +685,16 @@ EXPORT_SYMBOL_GPL(snd_hda_jack_unsol_event);
  *
  * Poll all detectable jacks with dirty flag, update the status, call
  * callbacks and call snd_hda_jack_report_sync() if any changes are found.
+ *
+ * Returns non-zero if any jack changed.
  */
-void snd_hda_jack_poll_all(struct hda_codec *codec)
+int snd_hda_jack_poll_all(struct hda_codec *codec)
 {
 	struct hda_jack_tbl *jack = codec->jacktbl.list;
 	int i, changes = 0;
 
+	jack_fetch_sense(codec);
+
 	for (i = 0; i < codec->jacktbl.used; i++, jack++) {
 		unsigned int old_sense;
 		if (!jack->nid || !jack->jack_dirty || jack->phantom_jack)
@@ -663,6 +708,7 @@ void snd_hda_jack_poll_all(struct hda_codec *codec)
 	}
 	if (changes)
 		snd_hda_jack_report_sync(codec);
+	return changes;
 }
 EXPORT_SYMBOL_GPL(snd_hda_jack_poll_all);
 
@@ -38,6 +38,7 @@ struct hda_jack_tbl {
 	unsigned int jack_dirty:1;	/* needs to update? */
 	unsigned int phantom_jack:1;    /* a fixed, always present port? */
 	unsigned int block_report:1;    /* in a transitional state - do not report to userspace */
+	unsigned int sense_fetched:1;	/* pin_sense read ahead, still valid */
 	hda_nid_t gating_jack;		/* valid when gating jack plugged */
 	hda_nid_t gated_jack;		/* gated is dependent on this jack */
 	int type;
@@ -181,6 +182,6 @@ void snd_hda_jack_report_sync(struct hda_codec *codec);
 
 void snd_hda_jack_unsol_event(struct hda_codec *codec, unsigned int res);
 
-void snd_hda_jack_poll_all(struct hda_codec *codec);
+int snd_hda_jack_poll_all(struct hda_codec *codec);
 
 #endif /* __SOUND_HDA_JACK_H */
@@ -446,6 +446,15 @@ int snd_hda_codec_set_pin_target(struct hda_codec *codec, hda_nid_t nid,
 #define for_each_hda_codec_node(nid, codec) \
 	for ((nid) = (codec)->core.start_nid; (nid) < (codec)->core.end_nid; (nid)++)
 
+/* encode a verb for snd_hdac_exec_verbs() */
+static inline unsigned int snd_hda_codec_verb_cmd(struct hda_codec *codec,
+						  hda_nid_t nid,
+						  unsigned int verb,
+						  unsigned int parm)
+{
+	return (codec->core.addr << 28) | ((u32)nid << 20) | (verb << 8) | parm;
+}
+
 /*
  * get widget capabilities
  */
@@ -18,6 +18,10 @@ static int dump_coef = -1;
 module_param(dump_coef, int, 0644);
 MODULE_PARM_DESC(dump_coef, "Dump processing coefficients in codec proc file (-1=auto, 0=disable, 1=enable)");
 
+static bool proc_no_wake;
+module_param(proc_no_wake, bool, 0644);
+MODULE_PARM_DESC(proc_no_wake, "Show only the cached state of a suspended codec in its proc file instead of waking it up");
+
 /* always use noncached version */
 #define param_read(codec, nid, parm) \
 	snd_hdac_read_parm_uncached(&(codec)->core, nid, parm)
@@ -735,6 +739,72 @@ static void print_codec_core_info(struct hdac_device *codec,
 		snd_iprintf(buffer, "No Modem Function Group found\n");
 }
 
+static void print_cached_amp_vals(struct snd_info_buffer *buffer,
+				  struct hda_codec *codec, hda_nid_t nid,
+				  int dir, unsigned int wcaps)
+{
+	int ch, val;
+
+	snd_iprintf(buffer, " [");
+	for (ch = 0; ch < ((wcaps & AC_WCAP_STEREO) ? 2 : 1); ch++) {
+		/* served from the regmap cache, never sent to the codec */
+		val = snd_hda_codec_amp_read(codec, nid, ch, dir, 0);
+		if (ch)
+			snd_iprintf(buffer, " ");
+		if (val < 0)
+			snd_iprintf(buffer, "--");
+		else
+			snd_iprintf(buffer, "0x%02x", val);
+	}
+	snd_iprintf(buffer, "]\n");
+}
+
+/*
+ * The codec is suspended and proc_no_wake is set: show what is kept in
+ * software only, i.e. the widget caps read at probe time, the assigned
+ * controls and PCMs, the pin configs and targets, and the amp values of
+ * the first index found in the regmap cache.
+ */
+static void print_codec_info_cached(struct snd_info_buffer *buffer,
+				    struct hda_codec *codec)
+{
+	hda_nid_t nid = codec->core.start_nid;
+	unsigned int wid_caps, wid_type;
+	int i;
+
+	snd_iprintf(buffer, "Codec is suspended, showing cached state only\n");
+
+	for (i = 0; i < codec->core.num_nodes; i++, nid++) {
+		wid_caps = get_wcaps(codec, nid);
+		wid_type = get_wcaps_type(wid_caps);
+
+		snd_iprintf(buffer, "Node 0x%02x [%s] wcaps 0x%x\n", nid,
+			    get_wid_type_name(wid_type), wid_caps);
+
+		print_nid_array(buffer, codec, nid, &codec->mixers);
+		print_nid_array(buffer, codec, nid, &codec->nids);
+		print_nid_pcms(buffer, codec, nid);
+
+		if (wid_caps & AC_WCAP_IN_AMP) {
+			snd_iprintf(buffer, "  Amp-In vals: ");
+			print_cached_amp_vals(buffer, codec, nid, HDA_INPUT,
+					      wid_caps);
+		}
+		if (wid_caps & AC_WCAP_OUT_AMP) {
+			snd_iprintf(buffer, "  Amp-Out vals: ");
+			print_cached_amp_vals(buffer, codec, nid, HDA_OUTPUT,
+					      wid_caps);
+		}
+
+		if (wid_type == AC_WID_PIN) {
+			snd_iprintf(buffer, "  Pin Default 0x%08x\n",
+				    snd_hda_codec_get_pincfg(codec, nid));
+			snd_iprintf(buffer, "  Pin-ctls: 0x%02x\n",
+				    snd_hda_codec_get_pin_target(codec, nid));
+		}
+	}
+}
+
 static void print_codec_info(struct snd_info_entry *entry,
 			     struct snd_info_buffer *buffer)
 {
@@ -746,7 +816,25 @@ static void print_codec_info(struct snd_info_entry *entry,
 	fg = codec->core.afg;
 	if (!fg)
 		return;
-	snd_hda_power_up(codec);
+
+	if (READ_ONCE(proc_no_wake)) {
+		switch (snd_hdac_keep_power_up(&codec->core)) {
+		case -1:
+			print_codec_info_cached(buffer, codec);
+			return;
+		case 0:
+			/* no runtime PM, the codec is always powered */
+			snd_hda_power_up(codec);
+			break;
+		default:
+			/* already active: swap for a plain power reference */
+			snd_hda_power_up(codec);
+			snd_hdac_power_down_pm(&codec->core);
+			break;
+		}
+	} else {
+		snd_hda_power_up(codec);
+	}
 	snd_iprintf(buffer, "Default PCM:\n");
 	print_pcm_caps(buffer, codec, fg);
 	snd_iprintf(buffer, "Default Amp-In caps: ");
@@ -902,11 +990,60 @@ static void print_codec_info(struct snd_info_entry *entry,
 /*
  * create a proc read
  */
+/* verb statistics, in a separate file keeping codec#N format unchanged */
+static void print_codec_stats(struct snd_info_entry *entry,
+			      struct snd_info_buffer *buffer)
+{
+	struct hda_codec *codec = entry->private_data;
+	const struct hdac_verb_stats *stats = &codec->core.stats;
+	unsigned int i, total = 0, misses;
+
+	for (i = 0; i < HDAC_STATS_VERB_IDS; i++)
+		total += stats->verbs[i];
+	snd_iprintf(buffer, "Verbs: %u\n", total);
+	for (i = 0; i < HDAC_STATS_VERB_IDS; i++) {
+		if (!stats->verbs[i])
+			continue;
+		if (i < 0x200)
+			snd_iprintf(buffer, "  Verb 0x%03x: %u\n",
+				    (i & 0x100 ? 0xf00 : 0x700) | (i & 0xff),
+				    stats->verbs[i]);
+		else
+			snd_iprintf(buffer, "  Verb 0x%x: %u\n",
+				    i & 0xf, stats->verbs[i]);
+	}
+	for (i = 0; i < HDAC_STATS_NIDS; i++)
+		if (stats->nid_verbs[i])
+			snd_iprintf(buffer, "  Node 0x%02x: %u\n", i,
+				    stats->nid_verbs[i]);
+
+	misses = stats->regmap_hw_reads - min(stats->regmap_hw_reads,
+					      stats->regmap_uncached);
+	snd_iprintf(buffer, "Regmap reads: %u cached (%u misses), %u uncached\n",
+		    stats->regmap_reads, min(misses, stats->regmap_reads),
+		    stats->regmap_uncached);
+
+	snd_iprintf(buffer, "RIRB waits:");
+	for (i = 0; i < HDAC_STATS_RIRB_WAITS - 1; i++)
+		snd_iprintf(buffer, " <%uus: %u", 16 << (2 * i),
+			    stats->rirb_waits[i]);
+	snd_iprintf(buffer, " more: %u\n", stats->rirb_waits[i]);
+	snd_iprintf(buffer, "RIRB timeouts: %u, fallbacks: %u\n",
+		    stats->rirb_timeouts, stats->fallbacks);
+}
+
 int snd_hda_codec_proc_new(struct hda_codec *codec)
 {
 	char name[32];
+	int err;
 
 	snprintf(name, sizeof(name), "codec#%d", codec->core.addr);
-	return snd_card_ro_proc_new(codec->card, name, codec, print_codec_info);
+	err = snd_card_ro_proc_new(codec->card, name, codec, print_codec_info);
+	if (err < 0)
+		return err;
+
+	snprintf(name, sizeof(name), "codec#%d.stats", codec->core.addr);
+	return snd_card_ro_proc_new(codec->card, name, codec,
+				    print_codec_stats);
 }
 
@@ -149,7 +149,8 @@ static void alc_update_coefex_idx(struct hda_codec *codec, hda_nid_t nid,
 {
 	unsigned int val = alc_read_coefex_idx(codec, nid, coef_idx);
 
-	if (val != -1)
+	/* spare the index and data verbs when nothing changes */
+	if (val != -1 && ((val & ~mask) | bits_set) != val)
 		alc_write_coefex_idx(codec, nid, coef_idx,
 				     (val & ~mask) | bits_set);
 }
@@ -181,15 +182,79 @@ struct coef_fw {
 #define WRITE_COEF(_idx, _val) WRITE_COEFEX(0x20, _idx, _val)
 #define UPDATE_COEF(_idx, _mask, _val) UPDATE_COEFEX(0x20, _idx, _mask, _val)
 
+#define coef_fw_is_write(fw)	((fw)->mask == (unsigned short)-1)
+
+/* max number of table entries processed at once */
+#define ALC_COEF_BATCH		16
+
+static void alc_process_coef_fw_one(struct hda_codec *codec,
+				    const struct coef_fw *fw)
+{
+	if (coef_fw_is_write(fw))
+		alc_write_coefex_idx(codec, fw->nid, fw->idx, fw->val);
+	else
+		alc_update_coefex_idx(codec, fw->nid, fw->idx,
+				      fw->mask, fw->val);
+}
+
+/*
+ * The table is processed in runs of entries on the same NID made of
+ * updates followed by plain writes, so that the values of all updates
+ * can be read in one batch of verbs and all the new values written in
+ * another, in the table order.  An update applies on top of the previous
+ * entries of the run for the same coef, and the coefs which end up with
+ * the value they already have aren't written again.
+ */
 static void alc_process_coef_fw(struct hda_codec *codec,
 				const struct coef_fw *fw)
 {
-	for (; fw->nid; fw++) {
-		if (fw->mask == (unsigned short)-1)
-			alc_write_coefex_idx(codec, fw->nid, fw->idx, fw->val);
-		else
-			alc_update_coefex_idx(codec, fw->nid, fw->idx,
-					      fw->mask, fw->val);
+	unsigned int idx[ALC_COEF_BATCH], vals[ALC_COEF_BATCH];
+	unsigned int old[ALC_COEF_BATCH];
+	const struct coef_fw *end;
+	int i, j, n, w, updates;
+
+	while (fw->nid) {
+		for (end = fw, n = 0, updates = 0;
+		     end->nid == fw->nid && n < ALC_COEF_BATCH; end++, n++) {
+			if (coef_fw_is_write(end))
+				continue;
+			if (n && coef_fw_is_write(end - 1))
+				break;
+			updates++;
+		}
+
+		for (i = 0; i < n; i++)
+			idx[i] = fw[i].idx;
+		if (snd_hdac_read_coefs(&codec->core, fw->nid, idx, vals,
+					updates)) {
+			for (; fw < end; fw++)
+				alc_process_coef_fw_one(codec, fw);
+			continue;
+		}
+
+		/* current value of each coef, as read or left by the run */
+		for (i = 0; i < n; i++) {
+			old[i] = i < updates ? vals[i] : -1;
+			for (j = i - 1; j >= 0; j--) {
+				if (idx[j] == idx[i]) {
+					old[i] = vals[j];
+					break;
+				}
+			}
+			if (i < updates)
+				vals[i] = (old[i] & ~fw[i].mask) | fw[i].val;
+			else
+				vals[i] = fw[i].val;
+		}
+
+		for (i = 0, w = 0; i < n; i++) {
+			if (vals[i] == old[i])
+				continue;
+			idx[w] = idx[i];
+			vals[w++] = vals[i];
+		}
+		snd_hdac_write_coefs(&codec->core, fw->nid, idx, vals, w);
+		fw = end;
 	}
 }
 
@@ -13,12 +13,54 @@
 #include <linux/device.h>
 #include <linux/regmap.h>
 #include <linux/fs.h>
+#include <linux/ktime.h>
 #include <linux/list.h>
 #include <linux/wait.h>
+#include <linux/workqueue.h>
+#include <linux/xarray.h>
 
 struct regmap;
 struct regcache_ops;
 
+/* flags of struct regmap access */
+#define REGMAP_ACCESS_WRITEABLE		BIT(0)
+#define REGMAP_ACCESS_READABLE		BIT(1)
+#define REGMAP_ACCESS_VOLATILE		BIT(2)
+#define REGMAP_ACCESS_PRECIOUS		BIT(3)
+
+/* largest number of registers for which the access flags are precompiled */
+#define REGMAP_ACCESS_MAX_REGS		8192
+
+/* buckets of the latency histograms, bucket n counts [2^(n-1), 2^n) us */
+#define REGMAP_STATS_BUCKETS		16
+
+enum regmap_stats_op {
+	REGMAP_STATS_READ,
+	REGMAP_STATS_WRITE,
+	REGMAP_STATS_SYNC,
+	REGMAP_STATS_NUM_OPS,
+};
+
+/**
+ * struct regmap_stats - aggregated access statistics of a map
+ *
+ * @count: number of operations
+ * @bytes: bytes transferred by the operations
+ * @hist: log2 histogram of the latency of the operations
+ * @cache_hit: reads served by the cache
+ * @cache_miss: reads of a cached map that needed a HW access
+ *
+ * All fields but the cache counters, which the lockless reads update,
+ * are protected by the map lock.
+ */
+struct regmap_stats {
+	u64 count[REGMAP_STATS_NUM_OPS];
+	u64 bytes[REGMAP_STATS_NUM_OPS];
+	u64 hist[REGMAP_STATS_NUM_OPS][REGMAP_STATS_BUCKETS];
+	atomic64_t cache_hit;
+	atomic64_t cache_miss;
+};
+
 struct regmap_debugfs_off_cache {
 	struct list_head list;
 	off_t min;
@@ -73,6 +115,14 @@ struct regmap {
 	struct list_head async_free;
 	int async_ret;
 
+	/* if set, cached writes are flushed to the HW by write_behind_work */
+	bool write_behind;
+	/* set while the pending writes are being flushed */
+	bool write_behind_busy;
+	/* registers written to the cache but not yet to the HW */
+	struct xarray write_behind_pending;
+	struct work_struct write_behind_work;
+
 #ifdef CONFIG_DEBUG_FS
 	bool debugfs_disable;
 	struct dentry *debugfs;
@@ -84,6 +134,14 @@ struct regmap {
 
 	struct list_head debugfs_off_cache;
 	struct mutex cache_lock;
+	/* lazy construction state of debugfs_off_cache */
+	struct regmap_debugfs_off_cache *debugfs_off_open;
+	struct regmap_debugfs_off_cache *debugfs_off_hint;
+	unsigned int debugfs_scan_reg;
+	loff_t debugfs_scan_pos;
+	bool debugfs_scan_done;
+
+	struct regmap_stats stats;
 #endif
 
 	unsigned int max_register;
@@ -99,6 +157,9 @@ struct regmap {
 	const struct regmap_access_table *precious_table;
 	const struct regmap_access_table *wr_noinc_table;
 	const struct regmap_access_table *rd_noinc_table;
+	/* precompiled REGMAP_ACCESS_* flags, one per register index */
+	u8 *access;
+	unsigned int num_access;
 
 	int (*reg_read)(void *context, unsigned int reg, unsigned int *val);
 	int (*reg_write)(void *context, unsigned int reg, unsigned int val);
@@ -142,6 +203,12 @@ struct regmap {
 	bool cache_dirty;
 	/* if set, the HW registers are known to match map->reg_defaults */
 	bool no_sync_defaults;
+	/* registers written while cache_only was set, see regcache_sync() */
+	struct xarray cache_written;
+	/* if set, cache_written is incomplete and a full sync is needed */
+	bool cache_written_lost;
+	/* if set, cached reads are served without taking the map lock */
+	bool cache_lockless_read;
 
 	struct reg_sequence *patch;
 	int patch_regs;
@@ -152,6 +219,9 @@ struct regmap {
 	bool use_single_write;
 	/* if set, the device supports multi write mode */
 	bool can_multi_write;
+	/* if set, writes num reg/val pairs as one combined bus transaction */
+	int (*combined_write)(void *context, const void *data,
+			      size_t pair_size, size_t num);
 
 	/* if set, raw reads/writes are limited to this size */
 	size_t max_raw_read;
@@ -172,6 +242,9 @@ struct regcache_ops {
 	void (*debugfs_init)(struct regmap *map);
 #endif
 	int (*read)(struct regmap *map, unsigned int reg, unsigned int *value);
+	/* optional, called under rcu_read_lock() without the map lock */
+	int (*read_lockless)(struct regmap *map, unsigned int reg,
+			     unsigned int *value);
 	int (*write)(struct regmap *map, unsigned int reg, unsigned int value);
 	int (*sync)(struct regmap *map, unsigned int min, unsigned int max);
 	int (*drop)(struct regmap *map, unsigned int min, unsigned int max);
@@ -219,17 +292,37 @@ struct regmap_field {
 extern void regmap_debugfs_initcall(void);
 extern void regmap_debugfs_init(struct regmap *map, const char *name);
 extern void regmap_debugfs_exit(struct regmap *map);
+extern void regmap_debugfs_invalidate(struct regmap *map);
 
 static inline void regmap_debugfs_disable(struct regmap *map)
 {
 	map->debugfs_disable = true;
 }
 
+void regmap_stats_add(struct regmap *map, enum regmap_stats_op op,
+		      ktime_t start, size_t bytes);
+
+static inline ktime_t regmap_stats_start(void)
+{
+	return ktime_get();
+}
+
+static inline void regmap_stats_cache(struct regmap *map, bool hit)
+{
+	atomic64_inc(hit ? &map->stats.cache_hit : &map->stats.cache_miss);
+}
+
 #else
 static inline void regmap_debugfs_initcall(void) { }
 static inline void regmap_debugfs_init(struct regmap *map, const char *name) { }
 static inline void regmap_debugfs_exit(struct regmap *map) { }
+static inline void regmap_debugfs_invalidate(struct regmap *map) { }
 static inline void regmap_debugfs_disable(struct regmap *map) { }
+static inline void regmap_stats_add(struct regmap *map,
+				    enum regmap_stats_op op,
+				    ktime_t start, size_t bytes) { }
+static inline ktime_t regmap_stats_start(void) { return 0; }
+static inline void regmap_stats_cache(struct regmap *map, bool hit) { }
 #endif
 
 /* regcache core declarations */
@@ -237,6 +330,14 @@ int regcache_init(struct regmap *map, const struct regmap_config *config);
 void regcache_exit(struct regmap *map);
 int regcache_read(struct regmap *map,
 		       unsigned int reg, unsigned int *value);
+int regcache_read_lockless(struct regmap *map,
+			   unsigned int reg, unsigned int *value);
+int regcache_set_written(struct regmap *map, struct xarray *written,
+			 unsigned int reg);
+int regcache_written_sync(struct regmap *map, struct xarray *written,
+			  unsigned int min, unsigned int max);
+
+int _regmap_write_behind_flush(struct regmap *map);
 int regcache_write(struct regmap *map,
 			unsigned int reg, unsigned int value);
 int regcache_sync(struct regmap *map);
@@ -260,6 +361,9 @@ int regcache_lookup_reg(struct regmap *map, unsigned int reg);
 
 int _regmap_raw_write(struct regmap *map, unsigned int reg,
 		      const void *val, size_t val_len);
+int _regmap_multi_reg_write(struct regmap *map,
+			    const struct reg_sequence *regs,
+			    size_t num_regs);
 
 void regmap_async_complete_cb(struct regmap_async *async, int ret);
 
@@ -269,7 +373,9 @@ enum regmap_endian regmap_get_val_endian(struct device *dev,
 
 extern struct regcache_ops regcache_rbtree_ops;
 extern struct regcache_ops regcache_lzo_ops;
+extern struct regcache_ops regcache_lz4_ops;
 extern struct regcache_ops regcache_flat_ops;
+extern struct regcache_ops regcache_sparse_ops;
 
 static inline const char *regmap_name(const struct regmap *map)
 {
@@ -62,13 +62,24 @@ static int regcache_flat_read(struct regmap *map,
 	return 0;
 }
 
+static int regcache_flat_read_lockless(struct regmap *map,
+				       unsigned int reg, unsigned int *value)
+{
+	unsigned int *cache = map->cache;
+	unsigned int index = regcache_flat_get_index(map, reg);
+
+	*value = READ_ONCE(cache[index]);
+
+	return 0;
+}
+
 static int regcache_flat_write(struct regmap *map, unsigned int reg,
 			       unsigned int value)
 {
 	unsigned int *cache = map->cache;
 	unsigned int index = regcache_flat_get_index(map, reg);
 
-	cache[index] = value;
+	WRITE_ONCE(cache[index], value);
 
 	return 0;
 }
@@ -79,5 +90,6 @@ struct regcache_ops regcache_flat_ops = {
 	.init = regcache_flat_init,
 	.exit = regcache_flat_exit,
 	.read = regcache_flat_read,
+	.read_lockless = regcache_flat_read_lockless,
 	.write = regcache_flat_write,
 };
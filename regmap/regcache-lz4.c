@@ -0,0 +1,390 @@
+// SPDX-License-Identifier: GPL-2.0
+//
+// Register cache access API - LZ4 caching support
+//
+// The register space is split in blocks of REGCACHE_LZ4_BLOCK_REGS
+// registers, each kept LZ4 compressed. Accessed blocks are kept
+// decompressed in a small LRU so that reads and writes only cost a
+// lookup, and the blocks modified are only compressed again from a
+// delayed work, once the writes have settled.
+
+#include <linux/bitmap.h>
+#include <linux/device.h>
+#include <linux/list.h>
+#include <linux/lz4.h>
+#include <linux/slab.h>
+#include <linux/workqueue.h>
+
+#include "internal.h"
+
+/* number of registers of a block, a multiple of BITS_PER_LONG */
+#define REGCACHE_LZ4_BLOCK_REGS		256
+/* number of blocks kept decompressed */
+#define REGCACHE_LZ4_HOT_BLOCKS		4
+/* delay before the modified blocks are compressed */
+#define REGCACHE_LZ4_DELAY_MS		100
+
+struct regcache_lz4_block {
+	/* compressed copy of the block, stale while dirty is set */
+	void *comp;
+	unsigned int comp_len;
+	/* decompressed copy of the block, NULL if not in the LRU */
+	void *data;
+	/* if set, data is newer than comp */
+	bool dirty;
+	struct list_head lru;
+};
+
+struct regcache_lz4_ctx {
+	struct regmap *map;
+	struct regcache_lz4_block *blocks;
+	unsigned int num_blocks;
+	size_t block_bytes;
+	/* registers written since the cache was initialized */
+	unsigned long *sync_bmp;
+	unsigned int num_regs;
+	/* decompressed blocks, most recently used first */
+	struct list_head lru;
+	unsigned int num_hot;
+	/* compression work memory and output buffer */
+	void *wrkmem;
+	void *tmp;
+	int tmp_len;
+	struct delayed_work work;
+};
+
+static inline unsigned int regcache_lz4_get_index(const struct regmap *map,
+						  unsigned int reg)
+{
+	if (map->reg_stride_order >= 0)
+		return regcache_get_index_by_order(map, reg);
+
+	return reg / map->reg_stride;
+}
+
+static int regcache_lz4_compress(struct regcache_lz4_ctx *ctx,
+				 struct regcache_lz4_block *blk)
+{
+	struct regmap *map = ctx->map;
+	void *comp;
+	int len;
+
+	len = LZ4_compress_default(blk->data, ctx->tmp, ctx->block_bytes,
+				   ctx->tmp_len, ctx->wrkmem);
+	if (len <= 0)
+		return -EINVAL;
+
+	comp = kmemdup(ctx->tmp, len, map->alloc_flags);
+	if (!comp)
+		return -ENOMEM;
+
+	kfree(blk->comp);
+	blk->comp = comp;
+	blk->comp_len = len;
+	blk->dirty = false;
+
+	return 0;
+}
+
+static void regcache_lz4_evict(struct regcache_lz4_ctx *ctx,
+			       struct regcache_lz4_block *blk)
+{
+	list_del(&blk->lru);
+	kfree(blk->data);
+	blk->data = NULL;
+	ctx->num_hot--;
+}
+
+/*
+ * Compress the dirty blocks if @compress is set, then release the least
+ * recently used clean blocks beyond the LRU size.
+ */
+static void regcache_lz4_flush(struct regcache_lz4_ctx *ctx, bool compress)
+{
+	struct regcache_lz4_block *blk, *tmp;
+	int ret;
+
+	if (compress) {
+		list_for_each_entry(blk, &ctx->lru, lru) {
+			if (!blk->dirty)
+				continue;
+
+			ret = regcache_lz4_compress(ctx, blk);
+			if (ret)
+				dev_warn(ctx->map->dev,
+					 "Failed to compress cache block: %d\n",
+					 ret);
+		}
+	}
+
+	list_for_each_entry_safe_reverse(blk, tmp, &ctx->lru, lru) {
+		if (ctx->num_hot <= REGCACHE_LZ4_HOT_BLOCKS)
+			break;
+
+		/* the latest block accessed is still in use */
+		if (!blk->dirty && blk->lru.prev != &ctx->lru)
+			regcache_lz4_evict(ctx, blk);
+	}
+}
+
+static void regcache_lz4_work(struct work_struct *work)
+{
+	struct regcache_lz4_ctx *ctx = container_of(work,
+						    struct regcache_lz4_ctx,
+						    work.work);
+	struct regmap *map = ctx->map;
+
+	map->lock(map->lock_arg);
+	regcache_lz4_flush(ctx, true);
+	map->unlock(map->lock_arg);
+}
+
+/* return the decompressed data of block @blkindex, moved to the LRU head */
+static void *regcache_lz4_get_block(struct regcache_lz4_ctx *ctx,
+				    unsigned int blkindex)
+{
+	struct regcache_lz4_block *blk = &ctx->blocks[blkindex];
+	struct regmap *map = ctx->map;
+	void *data;
+	int len;
+
+	if (blk->data) {
+		list_move(&blk->lru, &ctx->lru);
+		return blk->data;
+	}
+
+	data = kmalloc(ctx->block_bytes, map->alloc_flags);
+	if (!data)
+		return NULL;
+
+	len = LZ4_decompress_safe(blk->comp, data, blk->comp_len,
+				  ctx->block_bytes);
+	if (len != ctx->block_bytes) {
+		kfree(data);
+		return NULL;
+	}
+
+	blk->data = data;
+	list_add(&blk->lru, &ctx->lru);
+	ctx->num_hot++;
+
+	regcache_lz4_flush(ctx, false);
+
+	/*
+	 * Only clean blocks are released here; if too many are waiting for
+	 * the work, compress them now to bound the memory used.
+	 */
+	if (ctx->num_hot > 2 * REGCACHE_LZ4_HOT_BLOCKS)
+		regcache_lz4_flush(ctx, true);
+
+	return data;
+}
+
+static int regcache_lz4_exit(struct regmap *map)
+{
+	struct regcache_lz4_ctx *ctx = map->cache;
+	unsigned int i;
+
+	if (!ctx)
+		return 0;
+
+	cancel_delayed_work_sync(&ctx->work);
+
+	if (ctx->blocks) {
+		for (i = 0; i < ctx->num_blocks; i++) {
+			kfree(ctx->blocks[i].comp);
+			kfree(ctx->blocks[i].data);
+		}
+	}
+
+	kfree(ctx->blocks);
+	bitmap_free(ctx->sync_bmp);
+	kfree(ctx->tmp);
+	kfree(ctx->wrkmem);
+	kfree(ctx);
+	map->cache = NULL;
+
+	return 0;
+}
+
+static int regcache_lz4_set(struct regmap *map, unsigned int reg,
+			    unsigned int value)
+{
+	struct regcache_lz4_ctx *ctx = map->cache;
+	unsigned int idx = regcache_lz4_get_index(map, reg);
+	void *data;
+
+	if (idx >= ctx->num_regs)
+		return -EINVAL;
+
+	data = regcache_lz4_get_block(ctx, idx / REGCACHE_LZ4_BLOCK_REGS);
+	if (!data)
+		return -ENOMEM;
+
+	regcache_set_val(map, data, idx % REGCACHE_LZ4_BLOCK_REGS, value);
+	ctx->blocks[idx / REGCACHE_LZ4_BLOCK_REGS].dirty = true;
+
+	return 0;
+}
+
+static int regcache_lz4_init(struct regmap *map)
+{
+	struct regcache_lz4_ctx *ctx;
+	void *zero;
+	unsigned int i;
+	int ret, len;
+
+	if (!map->max_register)
+		return -EINVAL;
+
+	ctx = kzalloc(sizeof(*ctx), GFP_KERNEL);
+	if (!ctx)
+		return -ENOMEM;
+
+	map->cache = ctx;
+	ctx->map = map;
+	INIT_LIST_HEAD(&ctx->lru);
+	INIT_DELAYED_WORK(&ctx->work, regcache_lz4_work);
+
+	ctx->num_regs = regcache_lz4_get_index(map, map->max_register) + 1;
+	ctx->num_blocks = DIV_ROUND_UP(ctx->num_regs,
+				       REGCACHE_LZ4_BLOCK_REGS);
+	ctx->block_bytes = REGCACHE_LZ4_BLOCK_REGS * map->cache_word_size;
+	ctx->tmp_len = LZ4_compressBound(ctx->block_bytes);
+
+	ctx->blocks = kcalloc(ctx->num_blocks, sizeof(*ctx->blocks),
+			      GFP_KERNEL);
+	ctx->sync_bmp = bitmap_zalloc(ctx->num_regs, GFP_KERNEL);
+	ctx->wrkmem = kmalloc(LZ4_MEM_COMPRESS, GFP_KERNEL);
+	ctx->tmp = kmalloc(ctx->tmp_len, GFP_KERNEL);
+	if (!ctx->blocks || !ctx->sync_bmp || !ctx->wrkmem || !ctx->tmp) {
+		ret = -ENOMEM;
+		goto err;
+	}
+
+	/* all the blocks start as the same, compressed, zeroed block */
+	zero = kzalloc(ctx->block_bytes, GFP_KERNEL);
+	if (!zero) {
+		ret = -ENOMEM;
+		goto err;
+	}
+
+	len = LZ4_compress_default(zero, ctx->tmp, ctx->block_bytes,
+				   ctx->tmp_len, ctx->wrkmem);
+	kfree(zero);
+	if (len <= 0) {
+		ret = -EINVAL;
+		goto err;
+	}
+
+	for (i = 0; i < ctx->num_blocks; i++) {
+		ctx->blocks[i].comp = kmemdup(ctx->tmp, len, GFP_KERNEL);
+		if (!ctx->blocks[i].comp) {
+			ret = -ENOMEM;
+			goto err;
+		}
+		ctx->blocks[i].comp_len = len;
+	}
+
+	for (i = 0; i < map->num_reg_defaults; i++) {
+		ret = regcache_lz4_set(map, map->reg_defaults[i].reg,
+				       map->reg_defaults[i].def);
+		if (ret)
+			goto err;
+	}
+
+	regcache_lz4_flush(ctx, true);
+
+	return 0;
+
+err:
+	regcache_lz4_exit(map);
+	return ret;
+}
+
+static int regcache_lz4_read(struct regmap *map,
+			     unsigned int reg, unsigned int *value)
+{
+	struct regcache_lz4_ctx *ctx = map->cache;
+	unsigned int idx = regcache_lz4_get_index(map, reg);
+	void *data;
+
+	if (idx >= ctx->num_regs)
+		return -EINVAL;
+
+	data = regcache_lz4_get_block(ctx, idx / REGCACHE_LZ4_BLOCK_REGS);
+	if (!data)
+		return -ENOMEM;
+
+	*value = regcache_get_val(map, data, idx % REGCACHE_LZ4_BLOCK_REGS);
+
+	return 0;
+}
+
+static int regcache_lz4_write(struct regmap *map,
+			      unsigned int reg, unsigned int value)
+{
+	struct regcache_lz4_ctx *ctx = map->cache;
+	int ret;
+
+	ret = regcache_lz4_set(map, reg, value);
+	if (ret)
+		return ret;
+
+	/* set the bit so we know we have to sync this register */
+	set_bit(regcache_lz4_get_index(map, reg), ctx->sync_bmp);
+
+	schedule_delayed_work(&ctx->work,
+			      msecs_to_jiffies(REGCACHE_LZ4_DELAY_MS));
+
+	return 0;
+}
+
+static int regcache_lz4_sync(struct regmap *map, unsigned int min,
+			     unsigned int max)
+{
+	struct regcache_lz4_ctx *ctx = map->cache;
+	unsigned int min_idx = regcache_lz4_get_index(map, min);
+	unsigned int max_idx = regcache_lz4_get_index(map, max);
+	unsigned int blk, first, start, end;
+	unsigned long *bmp;
+	void *data;
+	int ret;
+
+	max_idx = min(max_idx, ctx->num_regs - 1);
+
+	for (blk = min_idx / REGCACHE_LZ4_BLOCK_REGS;
+	     blk <= max_idx / REGCACHE_LZ4_BLOCK_REGS; blk++) {
+		first = blk * REGCACHE_LZ4_BLOCK_REGS;
+		start = max(min_idx, first) - first;
+		end = min_t(unsigned int, max_idx - first + 1,
+			    REGCACHE_LZ4_BLOCK_REGS);
+		bmp = ctx->sync_bmp + first / BITS_PER_LONG;
+
+		/* only the blocks with written registers are decompressed */
+		if (find_next_bit(bmp, end, start) >= end)
+			continue;
+
+		data = regcache_lz4_get_block(ctx, blk);
+		if (!data)
+			return -ENOMEM;
+
+		ret = regcache_sync_block(map, data, bmp,
+					  regmap_get_offset(map, first),
+					  start, end);
+		if (ret)
+			return ret;
+	}
+
+	return regmap_async_complete(map);
+}
+
+struct regcache_ops regcache_lz4_ops = {
+	.type = REGCACHE_LZ4,
+	.name = "lz4",
+	.init = regcache_lz4_init,
+	.exit = regcache_lz4_exit,
+	.read = regcache_lz4_read,
+	.write = regcache_lz4_write,
+	.sync = regcache_lz4_sync,
+};
@@ -181,6 +181,59 @@ static void rbtree_debugfs_init(struct regmap *map)
 }
 #endif
 
+/*
+ * Build the blocks straight from the defaults when they are sorted, as
+ * they normally are since regcache looks them up with bsearch(). Registers
+ * no further apart than regcache_rbtree_write() would merge share a block,
+ * which is allocated at its final size and inserted once instead of being
+ * grown one register at a time.
+ */
+static int regcache_rbtree_init_blocks(struct regmap *map)
+{
+	struct regcache_rbtree_ctx *rbtree_ctx = map->cache;
+	const struct reg_default *def = map->reg_defaults;
+	struct regcache_rbtree_node *rbnode;
+	unsigned int max_dist;
+	int i, j, k;
+
+	max_dist = map->reg_stride * sizeof(*rbnode) / map->cache_word_size;
+
+	for (i = 0; i < map->num_reg_defaults; i = j) {
+		for (j = i + 1; j < map->num_reg_defaults; j++)
+			if (def[j].reg - def[j - 1].reg > max_dist)
+				break;
+
+		rbnode = kzalloc(sizeof(*rbnode), GFP_KERNEL);
+		if (!rbnode)
+			return -ENOMEM;
+
+		rbnode->base_reg = def[i].reg;
+		rbnode->blklen = (def[j - 1].reg - def[i].reg) /
+			map->reg_stride + 1;
+
+		rbnode->block = kmalloc_array(rbnode->blklen,
+					      map->cache_word_size, GFP_KERNEL);
+		rbnode->cache_present = kcalloc(BITS_TO_LONGS(rbnode->blklen),
+						sizeof(*rbnode->cache_present),
+						GFP_KERNEL);
+		if (!rbnode->block || !rbnode->cache_present) {
+			kfree(rbnode->cache_present);
+			kfree(rbnode->block);
+			kfree(rbnode);
+			return -ENOMEM;
+		}
+
+		for (k = i; k < j; k++)
+			regcache_rbtree_set_register(map, rbnode,
+				(def[k].reg - rbnode->base_reg) /
+				map->reg_stride, def[k].def);
+
+		regcache_rbtree_insert(map, &rbtree_ctx->root, rbnode);
+	}
+
+	return 0;
+}
+
 static int regcache_rbtree_init(struct regmap *map)
 {
 	struct regcache_rbtree_ctx *rbtree_ctx;
@@ -195,6 +248,18 @@ static int regcache_rbtree_init(struct regmap *map)
 	rbtree_ctx->root = RB_ROOT;
 	rbtree_ctx->cached_rbnode = NULL;
 
+	for (i = 1; i < map->num_reg_defaults; i++)
+		if (map->reg_defaults[i].reg <= map->reg_defaults[i - 1].reg)
+			break;
+
+	if (i >= map->num_reg_defaults) {
+		ret = regcache_rbtree_init_blocks(map);
+		if (ret)
+			goto err;
+
+		return 0;
+	}
+
 	for (i = 0; i < map->num_reg_defaults; i++) {
 		ret = regcache_rbtree_write(map,
 					    map->reg_defaults[i].reg,
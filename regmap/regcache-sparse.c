@@ -0,0 +1,351 @@
+// SPDX-License-Identifier: GPL-2.0
+//
+// Register cache access API - sparse range caching support
+//
+// Registers are grouped in fixed, aligned blocks indexed by an xarray.
+// A block is allocated the first time one of its registers is cached
+// and is never resized, so inserting a register next to an existing
+// one is done in place and neighbouring blocks form contiguous ranges
+// without any copy. Each block keeps a present and a dirty bitmap, a
+// register is dirty when its value may differ from the hardware
+// default and only dirty registers are visited when syncing after a
+// reset.
+
+#include <linux/bitmap.h>
+#include <linux/debugfs.h>
+#include <linux/device.h>
+#include <linux/rcupdate.h>
+#include <linux/seq_file.h>
+#include <linux/slab.h>
+#include <linux/xarray.h>
+
+#include "internal.h"
+
+/* number of registers handled by one block */
+#define REGCACHE_SPARSE_BLOCK_REGS	64
+
+struct regcache_sparse_block {
+	/* blocks are freed after a grace period for lockless readers */
+	struct rcu_head rcu;
+	/* Which registers are present */
+	DECLARE_BITMAP(present, REGCACHE_SPARSE_BLOCK_REGS);
+	/* Which registers may differ from their default */
+	DECLARE_BITMAP(dirty, REGCACHE_SPARSE_BLOCK_REGS);
+	/* register values, map->cache_word_size each */
+	u8 data[];
+};
+
+struct regcache_sparse_ctx {
+	struct xarray blocks;
+	/* last block accessed, most accesses hit the same block */
+	struct regcache_sparse_block *cached_block;
+	unsigned long cached_key;
+};
+
+static inline unsigned int regcache_sparse_get_index(const struct regmap *map,
+						     unsigned int reg)
+{
+	if (map->reg_stride_order >= 0)
+		return regcache_get_index_by_order(map, reg);
+
+	return reg / map->reg_stride;
+}
+
+static inline unsigned int regcache_sparse_base_reg(const struct regmap *map,
+						    unsigned long key)
+{
+	return regmap_get_offset(map, key * REGCACHE_SPARSE_BLOCK_REGS);
+}
+
+static struct regcache_sparse_block *
+regcache_sparse_lookup(struct regmap *map, unsigned long key)
+{
+	struct regcache_sparse_ctx *ctx = map->cache;
+	struct regcache_sparse_block *block;
+
+	if (ctx->cached_block && ctx->cached_key == key)
+		return ctx->cached_block;
+
+	block = xa_load(&ctx->blocks, key);
+	if (block) {
+		ctx->cached_block = block;
+		ctx->cached_key = key;
+	}
+
+	return block;
+}
+
+static int regcache_sparse_read(struct regmap *map,
+				unsigned int reg, unsigned int *value)
+{
+	struct regcache_sparse_block *block;
+	unsigned int idx = regcache_sparse_get_index(map, reg);
+	unsigned int offset = idx % REGCACHE_SPARSE_BLOCK_REGS;
+
+	block = regcache_sparse_lookup(map, idx / REGCACHE_SPARSE_BLOCK_REGS);
+	if (!block || !test_bit(offset, block->present))
+		return -ENOENT;
+
+	*value = regcache_get_val(map, block->data, offset);
+
+	return 0;
+}
+
+/* the cached block is left alone as it is only updated under the lock */
+static int regcache_sparse_read_lockless(struct regmap *map,
+					 unsigned int reg, unsigned int *value)
+{
+	struct regcache_sparse_ctx *ctx = map->cache;
+	struct regcache_sparse_block *block;
+	unsigned int idx = regcache_sparse_get_index(map, reg);
+	unsigned int offset = idx % REGCACHE_SPARSE_BLOCK_REGS;
+
+	block = xa_load(&ctx->blocks, idx / REGCACHE_SPARSE_BLOCK_REGS);
+	if (!block || !test_bit(offset, block->present))
+		return -ENOENT;
+
+	/* pairs with the barrier in regcache_sparse_set() */
+	smp_rmb();
+	*value = regcache_get_val(map, block->data, offset);
+
+	return 0;
+}
+
+static int regcache_sparse_set(struct regmap *map, unsigned int reg,
+			       unsigned int value, bool dirty)
+{
+	struct regcache_sparse_ctx *ctx = map->cache;
+	struct regcache_sparse_block *block;
+	unsigned int idx = regcache_sparse_get_index(map, reg);
+	unsigned int offset = idx % REGCACHE_SPARSE_BLOCK_REGS;
+	unsigned long key = idx / REGCACHE_SPARSE_BLOCK_REGS;
+	int ret;
+
+	block = regcache_sparse_lookup(map, key);
+	if (!block) {
+		block = kzalloc(struct_size(block, data,
+					    REGCACHE_SPARSE_BLOCK_REGS *
+					    map->cache_word_size),
+				map->alloc_flags);
+		if (!block)
+			return -ENOMEM;
+
+		ret = xa_err(xa_store(&ctx->blocks, key, block,
+				      map->alloc_flags));
+		if (ret) {
+			kfree(block);
+			return ret;
+		}
+
+		ctx->cached_block = block;
+		ctx->cached_key = key;
+	}
+
+	regcache_set_val(map, block->data, offset, value);
+	if (!test_bit(offset, block->present)) {
+		/* lockless readers must see the value before the bit */
+		smp_wmb();
+		set_bit(offset, block->present);
+	}
+	if (dirty)
+		set_bit(offset, block->dirty);
+
+	return 0;
+}
+
+static int regcache_sparse_write(struct regmap *map, unsigned int reg,
+				 unsigned int value)
+{
+	return regcache_sparse_set(map, reg, value, true);
+}
+
+static int regcache_sparse_exit(struct regmap *map)
+{
+	struct regcache_sparse_ctx *ctx = map->cache;
+	struct regcache_sparse_block *block;
+	unsigned long key;
+
+	if (!ctx)
+		return 0;
+
+	xa_for_each(&ctx->blocks, key, block)
+		kfree(block);
+	xa_destroy(&ctx->blocks);
+
+	kfree(ctx);
+	map->cache = NULL;
+
+	return 0;
+}
+
+static int regcache_sparse_init(struct regmap *map)
+{
+	struct regcache_sparse_ctx *ctx;
+	int i;
+	int ret;
+
+	ctx = kzalloc(sizeof(*ctx), GFP_KERNEL);
+	if (!ctx)
+		return -ENOMEM;
+
+	xa_init(&ctx->blocks);
+	map->cache = ctx;
+
+	/* defaults match the hardware after a reset, they are not dirty */
+	for (i = 0; i < map->num_reg_defaults; i++) {
+		ret = regcache_sparse_set(map, map->reg_defaults[i].reg,
+					  map->reg_defaults[i].def, false);
+		if (ret)
+			goto err;
+	}
+
+	return 0;
+
+err:
+	regcache_sparse_exit(map);
+	return ret;
+}
+
+/* walk the blocks overlapping the registers [min, max] */
+#define regcache_sparse_for_each(map, ctx, key, block, min, max)	\
+	xa_for_each_range(&(ctx)->blocks, key, block,			\
+			  regcache_sparse_get_index(map, min) /		\
+			  REGCACHE_SPARSE_BLOCK_REGS,			\
+			  regcache_sparse_get_index(map, max) /		\
+			  REGCACHE_SPARSE_BLOCK_REGS)
+
+/* offsets of the registers of a block that fall within [min, max] */
+static void regcache_sparse_bounds(struct regmap *map, unsigned long key,
+				   unsigned int min, unsigned int max,
+				   unsigned int *start, unsigned int *end)
+{
+	unsigned int first = key * REGCACHE_SPARSE_BLOCK_REGS;
+	unsigned int min_idx = regcache_sparse_get_index(map, min);
+	unsigned int max_idx = regcache_sparse_get_index(map, max);
+
+	*start = min_idx > first ? min_idx - first : 0;
+	*end = min_t(unsigned int, max_idx - first + 1,
+		     REGCACHE_SPARSE_BLOCK_REGS);
+}
+
+static int regcache_sparse_sync(struct regmap *map, unsigned int min,
+				unsigned int max)
+{
+	struct regcache_sparse_ctx *ctx = map->cache;
+	struct regcache_sparse_block *block;
+	unsigned int start, end;
+	unsigned long key;
+	unsigned long *mask;
+	int ret;
+
+	regcache_sparse_for_each(map, ctx, key, block, min, max) {
+		/*
+		 * After a reset only the registers which may differ from
+		 * their default need a write, otherwise sync them all.
+		 */
+		mask = map->no_sync_defaults ? block->dirty : block->present;
+
+		regcache_sparse_bounds(map, key, min, max, &start, &end);
+		if (find_next_bit(mask, end, start) >= end)
+			continue;
+
+		ret = regcache_sync_block(map, block->data, mask,
+					  regcache_sparse_base_reg(map, key),
+					  start, end);
+		if (ret != 0)
+			return ret;
+	}
+
+	return regmap_async_complete(map);
+}
+
+static int regcache_sparse_drop(struct regmap *map, unsigned int min,
+				unsigned int max)
+{
+	struct regcache_sparse_ctx *ctx = map->cache;
+	struct regcache_sparse_block *block;
+	unsigned int start, end;
+	unsigned long key;
+
+	regcache_sparse_for_each(map, ctx, key, block, min, max) {
+		regcache_sparse_bounds(map, key, min, max, &start, &end);
+		bitmap_clear(block->present, start, end - start);
+		bitmap_clear(block->dirty, start, end - start);
+
+		if (!bitmap_empty(block->present, REGCACHE_SPARSE_BLOCK_REGS))
+			continue;
+
+		xa_erase(&ctx->blocks, key);
+		if (ctx->cached_block == block)
+			ctx->cached_block = NULL;
+		kfree_rcu(block, rcu);
+	}
+
+	return 0;
+}
+
+#ifdef CONFIG_DEBUG_FS
+static int sparse_show(struct seq_file *s, void *ignored)
+{
+	struct regmap *map = s->private;
+	struct regcache_sparse_ctx *ctx = map->cache;
+	struct regcache_sparse_block *block;
+	unsigned int base, registers = 0, dirty = 0;
+	unsigned int this_registers, this_dirty;
+	unsigned long key;
+	size_t mem_size;
+	int blocks = 0;
+
+	map->lock(map->lock_arg);
+
+	mem_size = sizeof(*ctx);
+
+	xa_for_each(&ctx->blocks, key, block) {
+		mem_size += struct_size(block, data,
+					REGCACHE_SPARSE_BLOCK_REGS *
+					map->cache_word_size);
+
+		base = regcache_sparse_base_reg(map, key);
+		this_registers = bitmap_weight(block->present,
+					       REGCACHE_SPARSE_BLOCK_REGS);
+		this_dirty = bitmap_weight(block->dirty,
+					   REGCACHE_SPARSE_BLOCK_REGS);
+		seq_printf(s, "%x-%x (%u, %u dirty)\n", base,
+			   base + (REGCACHE_SPARSE_BLOCK_REGS - 1) *
+			   map->reg_stride, this_registers, this_dirty);
+
+		blocks++;
+		registers += this_registers;
+		dirty += this_dirty;
+	}
+
+	seq_printf(s, "%d blocks, %u registers, %u dirty, used %zu bytes\n",
+		   blocks, registers, dirty, mem_size);
+
+	map->unlock(map->lock_arg);
+
+	return 0;
+}
+
+DEFINE_SHOW_ATTRIBUTE(sparse);
+
+static void sparse_debugfs_init(struct regmap *map)
+{
+	debugfs_create_file("sparse", 0400, map->debugfs, map, &sparse_fops);
+}
+#endif
+
+struct regcache_ops regcache_sparse_ops = {
+	.type = REGCACHE_SPARSE,
+	.name = "sparse",
+	.init = regcache_sparse_init,
+	.exit = regcache_sparse_exit,
+#ifdef CONFIG_DEBUG_FS
+	.debugfs_init = sparse_debugfs_init,
+#endif
+	.read = regcache_sparse_read,
+	.read_lockless = regcache_sparse_read_lockless,
+	.write = regcache_sparse_write,
+	.sync = regcache_sparse_sync,
+	.drop = regcache_sparse_drop,
+};
@@ -9,8 +9,10 @@
 #include <linux/bsearch.h>
 #include <linux/device.h>
 #include <linux/export.h>
+#include <linux/rcupdate.h>
 #include <linux/slab.h>
 #include <linux/sort.h>
+#include <linux/xarray.h>
 
 #include "trace.h"
 #include "internal.h"
@@ -19,10 +21,83 @@ static const struct regcache_ops *cache_types[] = {
 	&regcache_rbtree_ops,
 #if IS_ENABLED(CONFIG_REGCACHE_COMPRESSED)
 	&regcache_lzo_ops,
+#endif
+#if IS_ENABLED(CONFIG_REGCACHE_LZ4)
+	&regcache_lz4_ops,
 #endif
 	&regcache_flat_ops,
+	&regcache_sparse_ops,
 };
 
+/*
+ * cache_written holds one bitmap of REGCACHE_WRITTEN_BITS registers per
+ * entry, stored as an xarray value so that no memory is allocated for
+ * the bitmaps themselves.
+ */
+#define REGCACHE_WRITTEN_BITS	(BITS_PER_LONG / 2)
+
+static inline unsigned int regcache_written_index(struct regmap *map,
+						  unsigned int reg)
+{
+	if (map->reg_stride_order >= 0)
+		return regcache_get_index_by_order(map, reg);
+
+	return reg / map->reg_stride;
+}
+
+/*
+ * Without raw writes the registers to sync are gathered in sequences
+ * and handed to _regmap_multi_reg_write(), so that buses able to write
+ * several registers at once get them in a single transfer.
+ */
+#define REGCACHE_SYNC_SEQ_LEN	16
+
+struct regcache_sync_seq {
+	struct reg_sequence regs[REGCACHE_SYNC_SEQ_LEN];
+	unsigned int count;
+};
+
+static int regcache_sync_seq_flush(struct regmap *map,
+				   struct regcache_sync_seq *seq)
+{
+	unsigned int i;
+	int ret;
+
+	if (!seq->count)
+		return 0;
+
+	map->cache_bypass = true;
+	ret = _regmap_multi_reg_write(map, seq->regs, seq->count);
+	map->cache_bypass = false;
+
+	if (ret) {
+		dev_err(map->dev, "Unable to sync registers %#x-%#x. %d\n",
+			seq->regs[0].reg, seq->regs[seq->count - 1].reg, ret);
+	} else {
+		for (i = 0; i < seq->count; i++)
+			dev_dbg(map->dev, "Synced register %#x, value %#x\n",
+				seq->regs[i].reg, seq->regs[i].def);
+	}
+
+	seq->count = 0;
+
+	return ret;
+}
+
+static int regcache_sync_seq_add(struct regmap *map,
+				 struct regcache_sync_seq *seq,
+				 unsigned int reg, unsigned int val)
+{
+	seq->regs[seq->count].reg = reg;
+	seq->regs[seq->count].def = val;
+	seq->regs[seq->count].delay_us = 0;
+
+	if (++seq->count < REGCACHE_SYNC_SEQ_LEN)
+		return 0;
+
+	return regcache_sync_seq_flush(map, seq);
+}
+
 static int regcache_hw_init(struct regmap *map)
 {
 	int i, j;
@@ -155,6 +230,8 @@ int regcache_init(struct regmap *map, const struct regmap_config *config)
 
 	map->cache = NULL;
 	map->cache_ops = cache_types[i];
+	xa_init(&map->cache_written);
+	map->cache_written_lost = false;
 
 	if (!map->cache_ops->read ||
 	    !map->cache_ops->write ||
@@ -214,6 +291,8 @@ void regcache_exit(struct regmap *map)
 	if (map->cache_free)
 		kfree(map->reg_defaults_raw);
 
+	xa_destroy(&map->cache_written);
+
 	if (map->cache_ops->exit) {
 		dev_dbg(map->dev, "Destroying %s cache\n",
 			map->cache_ops->name);
@@ -252,6 +331,41 @@ int regcache_read(struct regmap *map,
 	return -EINVAL;
 }
 
+/**
+ * regcache_read_lockless - Fetch a cached value without the map lock
+ *
+ * @map: map to configure.
+ * @reg: The register index.
+ * @value: The value to be returned.
+ *
+ * Only used once regcache_cache_lockless_read() was called on the map
+ * and the cache type supports it. The caller falls back to the locked
+ * path on any error.
+ *
+ * Return a negative value on failure, 0 on success.
+ */
+int regcache_read_lockless(struct regmap *map,
+			   unsigned int reg, unsigned int *value)
+{
+	int ret;
+
+	if (!READ_ONCE(map->cache_lockless_read) ||
+	    READ_ONCE(map->cache_bypass))
+		return -EAGAIN;
+
+	if (regmap_volatile(map, reg))
+		return -EINVAL;
+
+	rcu_read_lock();
+	ret = map->cache_ops->read_lockless(map, reg, value);
+	rcu_read_unlock();
+
+	if (ret == 0)
+		trace_regmap_reg_read_cache(map, reg, *value);
+
+	return ret;
+}
+
 /**
  * regcache_write - Set the value of a given register in the cache.
  *
@@ -261,18 +375,54 @@ int regcache_read(struct regmap *map,
  *
  * Return a negative value on failure, 0 on success.
  */
+/*
+ * Record @reg in the written registers bitmap @written. On failure the
+ * caller has to handle the register being missing from the bitmap.
+ */
+int regcache_set_written(struct regmap *map, struct xarray *written,
+			 unsigned int reg)
+{
+	unsigned int idx = regcache_written_index(map, reg);
+	unsigned long key = idx / REGCACHE_WRITTEN_BITS;
+	unsigned long bits;
+	void *entry;
+
+	entry = xa_load(written, key);
+	bits = entry ? xa_to_value(entry) : 0;
+	bits |= BIT(idx % REGCACHE_WRITTEN_BITS);
+
+	return xa_err(xa_store(written, key, xa_mk_value(bits),
+			       map->alloc_flags));
+}
+
+static void regcache_mark_written(struct regmap *map, unsigned int reg)
+{
+	if (map->cache_written_lost)
+		return;
+
+	/* if the bitmap can't be updated fall back to a full sync */
+	if (regcache_set_written(map, &map->cache_written, reg))
+		map->cache_written_lost = true;
+}
+
 int regcache_write(struct regmap *map,
 		   unsigned int reg, unsigned int value)
 {
+	int ret;
+
 	if (map->cache_type == REGCACHE_NONE)
 		return 0;
 
 	BUG_ON(!map->cache_ops);
 
-	if (!regmap_volatile(map, reg))
-		return map->cache_ops->write(map, reg, value);
+	if (regmap_volatile(map, reg))
+		return 0;
 
-	return 0;
+	ret = map->cache_ops->write(map, reg, value);
+	if (ret == 0 && map->cache_only)
+		regcache_mark_written(map, reg);
+
+	return ret;
 }
 
 static bool regcache_reg_needs_sync(struct regmap *map, unsigned int reg,
@@ -294,6 +444,7 @@ static bool regcache_reg_needs_sync(struct regmap *map, unsigned int reg,
 static int regcache_default_sync(struct regmap *map, unsigned int min,
 				 unsigned int max)
 {
+	struct regcache_sync_seq seq = { .count = 0 };
 	unsigned int reg;
 
 	for (reg = min; reg <= max; reg += map->reg_stride) {
@@ -311,18 +462,62 @@ static int regcache_default_sync(struct regmap *map, unsigned int min,
 		if (!regcache_reg_needs_sync(map, reg, val))
 			continue;
 
-		map->cache_bypass = true;
-		ret = _regmap_write(map, reg, val);
-		map->cache_bypass = false;
-		if (ret) {
-			dev_err(map->dev, "Unable to sync register %#x. %d\n",
-				reg, ret);
+		ret = regcache_sync_seq_add(map, &seq, reg, val);
+		if (ret)
 			return ret;
+	}
+
+	return regcache_sync_seq_flush(map, &seq);
+}
+
+/*
+ * Write out the cached value of the registers of @written between @min
+ * and @max.
+ *
+ * If the hardware was not reset, it only lags behind the cache by the
+ * registers written while cache_only was set: write those and skip the
+ * walk of the whole cache.
+ */
+int regcache_written_sync(struct regmap *map, struct xarray *written,
+			  unsigned int min, unsigned int max)
+{
+	struct regcache_sync_seq seq = { .count = 0 };
+	unsigned long key, bits;
+	unsigned int bit, reg, val;
+	void *entry;
+	int ret;
+
+	xa_for_each_range(written, key, entry,
+			  regcache_written_index(map, min) /
+			  REGCACHE_WRITTEN_BITS,
+			  regcache_written_index(map, max) /
+			  REGCACHE_WRITTEN_BITS) {
+		bits = xa_to_value(entry);
+
+		for_each_set_bit(bit, &bits, REGCACHE_WRITTEN_BITS) {
+			reg = regmap_get_offset(map, key *
+						REGCACHE_WRITTEN_BITS + bit);
+			if (reg < min || reg > max ||
+			    regmap_volatile(map, reg) ||
+			    !regmap_writeable(map, reg))
+				continue;
+
+			/* dropped from the cache since it was written */
+			if (regcache_read(map, reg, &val))
+				continue;
+
+			ret = regcache_sync_seq_add(map, &seq, reg, val);
+			if (ret)
+				return ret;
 		}
-		dev_dbg(map->dev, "Synced register %#x, value %#x\n", reg, val);
 	}
 
-	return 0;
+	return regcache_sync_seq_flush(map, &seq);
+}
+
+static bool regcache_use_written(struct regmap *map)
+{
+	return !map->no_sync_defaults && !map->cache_written_lost;
 }
 
 /**
@@ -334,10 +529,14 @@ static int regcache_default_sync(struct regmap *map, unsigned int min,
  * volatile.  In general drivers can choose not to use the provided
  * syncing functionality if they so require.
  *
+ * Unless regcache_mark_dirty() was called, only the registers written
+ * while in cache only mode are written out.
+ *
  * Return a negative value on failure, 0 on success.
  */
 int regcache_sync(struct regmap *map)
 {
+	ktime_t start;
 	int ret = 0;
 	unsigned int i;
 	const char *name;
@@ -351,8 +550,13 @@ int regcache_sync(struct regmap *map)
 	dev_dbg(map->dev, "Syncing %s cache\n",
 		map->cache_ops->name);
 	name = map->cache_ops->name;
+	start = regmap_stats_start();
 	trace_regcache_sync(map, name, "start");
 
+	ret = _regmap_write_behind_flush(map);
+	if (ret)
+		goto out;
+
 	if (!map->cache_dirty)
 		goto out;
 
@@ -370,19 +574,26 @@ int regcache_sync(struct regmap *map)
 	}
 	map->cache_bypass = false;
 
-	if (map->cache_ops->sync)
+	if (regcache_use_written(map))
+		ret = regcache_written_sync(map, &map->cache_written, 0,
+					    map->max_register);
+	else if (map->cache_ops->sync)
 		ret = map->cache_ops->sync(map, 0, map->max_register);
 	else
 		ret = regcache_default_sync(map, 0, map->max_register);
 
-	if (ret == 0)
+	if (ret == 0) {
 		map->cache_dirty = false;
+		xa_destroy(&map->cache_written);
+		map->cache_written_lost = false;
+	}
 
 out:
 	/* Restore the bypass state */
 	map->async = false;
 	map->cache_bypass = bypass;
 	map->no_sync_defaults = false;
+	regmap_stats_add(map, REGMAP_STATS_SYNC, start, 0);
 	map->unlock(map->lock_arg);
 
 	regmap_async_complete(map);
@@ -408,6 +619,7 @@ EXPORT_SYMBOL_GPL(regcache_sync);
 int regcache_sync_region(struct regmap *map, unsigned int min,
 			 unsigned int max)
 {
+	ktime_t start;
 	int ret = 0;
 	const char *name;
 	bool bypass;
@@ -422,14 +634,22 @@ int regcache_sync_region(struct regmap *map, unsigned int min,
 	name = map->cache_ops->name;
 	dev_dbg(map->dev, "Syncing %s cache from %d-%d\n", name, min, max);
 
+	start = regmap_stats_start();
 	trace_regcache_sync(map, name, "start region");
 
+	ret = _regmap_write_behind_flush(map);
+	if (ret)
+		goto out;
+
 	if (!map->cache_dirty)
 		goto out;
 
 	map->async = true;
 
-	if (map->cache_ops->sync)
+	if (regcache_use_written(map))
+		ret = regcache_written_sync(map, &map->cache_written,
+					    min, max);
+	else if (map->cache_ops->sync)
 		ret = map->cache_ops->sync(map, min, max);
 	else
 		ret = regcache_default_sync(map, min, max);
@@ -439,6 +659,7 @@ out:
 	map->cache_bypass = bypass;
 	map->async = false;
 	map->no_sync_defaults = false;
+	regmap_stats_add(map, REGMAP_STATS_SYNC, start, 0);
 	map->unlock(map->lock_arg);
 
 	regmap_async_complete(map);
@@ -476,6 +697,9 @@ int regcache_drop_region(struct regmap *map, unsigned int min,
 
 	map->unlock(map->lock_arg);
 
+	/* registers only known from the cache may have disappeared */
+	regmap_debugfs_invalidate(map);
+
 	return ret;
 }
 EXPORT_SYMBOL_GPL(regcache_drop_region);
@@ -496,12 +720,42 @@ void regcache_cache_only(struct regmap *map, bool enable)
 {
 	map->lock(map->lock_arg);
 	WARN_ON(map->cache_bypass && enable);
+	/* cache only writes must not overtake deferred ones */
+	if (enable)
+		_regmap_write_behind_flush(map);
 	map->cache_only = enable;
 	trace_regmap_cache_only(map, enable);
 	map->unlock(map->lock_arg);
 }
 EXPORT_SYMBOL_GPL(regcache_cache_only);
 
+/**
+ * regcache_cache_lockless_read - Serve cached reads without the map lock
+ *
+ * @map: map to configure
+ * @enable: flag if cached reads may skip the map lock
+ *
+ * Reads of non-volatile registers found in the cache are then done
+ * under RCU only, which helps maps read very often from several
+ * contexts, e.g. for DAPM or control updates. Reads may return a value
+ * being concurrently overwritten, as if they had been done just before
+ * the write. Only the flat and sparse caches support this mode.
+ *
+ * Return -EINVAL if the cache type can't be read locklessly, 0 on success.
+ */
+int regcache_cache_lockless_read(struct regmap *map, bool enable)
+{
+	if (!map->cache_ops || !map->cache_ops->read_lockless)
+		return -EINVAL;
+
+	map->lock(map->lock_arg);
+	WRITE_ONCE(map->cache_lockless_read, enable);
+	map->unlock(map->lock_arg);
+
+	return 0;
+}
+EXPORT_SYMBOL_GPL(regcache_cache_lockless_read);
+
 /**
  * regcache_mark_dirty - Indicate that HW registers were reset to default values
  *
@@ -670,6 +924,7 @@ static int regcache_sync_block_single(struct regmap *map, void *block,
 				      unsigned int block_base,
 				      unsigned int start, unsigned int end)
 {
+	struct regcache_sync_seq seq = { .count = 0 };
 	unsigned int i, regtmp, val;
 	int ret;
 
@@ -684,21 +939,12 @@ static int regcache_sync_block_single(struct regmap *map, void *block,
 		if (!regcache_reg_needs_sync(map, regtmp, val))
 			continue;
 
-		map->cache_bypass = true;
-
-		ret = _regmap_write(map, regtmp, val);
-
-		map->cache_bypass = false;
-		if (ret != 0) {
-			dev_err(map->dev, "Unable to sync register %#x. %d\n",
-				regtmp, ret);
+		ret = regcache_sync_seq_add(map, &seq, regtmp, val);
+		if (ret != 0)
 			return ret;
-		}
-		dev_dbg(map->dev, "Synced register %#x, value %#x\n",
-			regtmp, val);
 	}
 
-	return 0;
+	return regcache_sync_seq_flush(map, &seq);
 }
 
 static int regcache_sync_block_raw_flush(struct regmap *map, const void **data,
@@ -12,6 +12,7 @@
 #include <linux/uaccess.h>
 #include <linux/device.h>
 #include <linux/list.h>
+#include <linux/log2.h>
 
 #include "internal.h"
 
@@ -76,6 +77,29 @@ static void regmap_debugfs_free_dump_cache(struct regmap *map)
 		list_del(&c->list);
 		kfree(c);
 	}
+
+	map->debugfs_off_open = NULL;
+	map->debugfs_off_hint = NULL;
+	map->debugfs_scan_reg = 0;
+	map->debugfs_scan_pos = 0;
+	map->debugfs_scan_done = false;
+}
+
+/**
+ * regmap_debugfs_invalidate() - Discard the register dump index
+ *
+ * @map: map whose set of printable registers changed
+ *
+ * The index is built again, lazily, by the next read of the files.
+ */
+void regmap_debugfs_invalidate(struct regmap *map)
+{
+	if (!map->debugfs)
+		return;
+
+	mutex_lock(&map->cache_lock);
+	regmap_debugfs_free_dump_cache(map);
+	mutex_unlock(&map->cache_lock);
 }
 
 static bool regmap_printable(struct regmap *map, unsigned int reg)
@@ -90,90 +114,120 @@ static bool regmap_printable(struct regmap *map, unsigned int reg)
 }
 
 /*
- * Work out where the start offset maps into register numbers, bearing
- * in mind that we suppress hidden registers.
+ * The dump cache is an index of the blocks of printable registers and
+ * of their offset in the `registers' file. It is only built as far as
+ * the reads need it: scanning resumes from debugfs_scan_reg, and
+ * debugfs_off_open is the block still growing at the end of the scan.
+ *
+ * Scan until the file position @pos and the register @reg are both
+ * covered, called with cache_lock held.
  */
-static unsigned int regmap_debugfs_get_dump_start(struct regmap *map,
-						  unsigned int base,
-						  loff_t from,
-						  loff_t *pos)
+static int regmap_debugfs_scan(struct regmap *map, loff_t pos,
+			       unsigned int reg)
 {
-	struct regmap_debugfs_off_cache *c = NULL;
-	loff_t p = 0;
-	unsigned int i, ret;
-	unsigned int fpos_offset;
-	unsigned int reg_offset;
-
-	/* Suppress the cache if we're using a subrange */
-	if (base)
-		return base;
-
-	/*
-	 * If we don't have a cache build one so we don't have to do a
-	 * linear scan each time.
-	 */
-	mutex_lock(&map->cache_lock);
-	i = base;
-	if (list_empty(&map->debugfs_off_cache)) {
-		for (; i <= map->max_register; i += map->reg_stride) {
-			/* Skip unprinted registers, closing off cache entry */
-			if (!regmap_printable(map, i)) {
-				if (c) {
-					c->max = p - 1;
-					c->max_reg = i - map->reg_stride;
-					list_add_tail(&c->list,
-						      &map->debugfs_off_cache);
-					c = NULL;
-				}
+	struct regmap_debugfs_off_cache *c = map->debugfs_off_open;
+	unsigned int i;
 
-				continue;
-			}
+	while (!map->debugfs_scan_done &&
+	       (map->debugfs_scan_pos <= pos || map->debugfs_scan_reg <= reg)) {
+		i = map->debugfs_scan_reg;
 
+		if (regmap_printable(map, i)) {
 			/* No cache entry?  Start a new one */
 			if (!c) {
 				c = kzalloc(sizeof(*c), GFP_KERNEL);
 				if (!c) {
 					regmap_debugfs_free_dump_cache(map);
-					mutex_unlock(&map->cache_lock);
-					return base;
+					return -ENOMEM;
 				}
-				c->min = p;
+				c->min = map->debugfs_scan_pos;
 				c->base_reg = i;
+				list_add_tail(&c->list,
+					      &map->debugfs_off_cache);
 			}
 
-			p += map->debugfs_tot_len;
+			map->debugfs_scan_pos += map->debugfs_tot_len;
+			c->max = map->debugfs_scan_pos - 1;
+			c->max_reg = i;
+		} else {
+			/* Skip unprinted registers, closing off cache entry */
+			c = NULL;
 		}
-	}
 
-	/* Close the last entry off if we didn't scan beyond it */
-	if (c) {
-		c->max = p - 1;
-		c->max_reg = i - map->reg_stride;
-		list_add_tail(&c->list,
-			      &map->debugfs_off_cache);
+		if (map->max_register - i < map->reg_stride)
+			map->debugfs_scan_done = true;
+		else
+			map->debugfs_scan_reg += map->reg_stride;
 	}
 
-	/*
-	 * This should never happen; we return above if we fail to
-	 * allocate and we should never be in this code if there are
-	 * no registers at all.
-	 */
-	WARN_ON(list_empty(&map->debugfs_off_cache));
-	ret = base;
+	map->debugfs_off_open = c;
 
-	/* Find the relevant block:offset */
-	list_for_each_entry(c, &map->debugfs_off_cache, list) {
-		if (from >= c->min && from <= c->max) {
-			fpos_offset = from - c->min;
-			reg_offset = fpos_offset / map->debugfs_tot_len;
-			*pos = c->min + (reg_offset * map->debugfs_tot_len);
-			mutex_unlock(&map->cache_lock);
-			return c->base_reg + (reg_offset * map->reg_stride);
+	return 0;
+}
+
+/* first block ending at or after @from, resuming from the last lookup */
+static struct regmap_debugfs_off_cache *
+regmap_debugfs_find_block(struct regmap *map, loff_t from)
+{
+	struct regmap_debugfs_off_cache *c = map->debugfs_off_hint;
+
+	if (!c || from < c->min)
+		c = list_first_entry(&map->debugfs_off_cache,
+				     struct regmap_debugfs_off_cache, list);
+
+	list_for_each_entry_from(c, &map->debugfs_off_cache, list) {
+		if (from <= c->max) {
+			map->debugfs_off_hint = c;
+			return c;
 		}
+	}
+
+	return NULL;
+}
+
+/*
+ * Work out where the start offset maps into register numbers, bearing
+ * in mind that we suppress hidden registers.
+ */
+static unsigned int regmap_debugfs_get_dump_start(struct regmap *map,
+						  unsigned int base,
+						  loff_t from,
+						  loff_t *pos)
+{
+	struct regmap_debugfs_off_cache *c;
+	unsigned int fpos_offset;
+	unsigned int reg_offset;
+	unsigned int ret = base;
+
+	/* Suppress the cache if we're using a subrange */
+	if (base)
+		return base;
 
+	mutex_lock(&map->cache_lock);
+
+	if (regmap_debugfs_scan(map, from, 0) ||
+	    list_empty(&map->debugfs_off_cache))
+		goto out;
+
+	/* Find the relevant block:offset */
+	c = regmap_debugfs_find_block(map, from);
+	if (c && from >= c->min) {
+		fpos_offset = from - c->min;
+		reg_offset = fpos_offset / map->debugfs_tot_len;
+		*pos = c->min + (reg_offset * map->debugfs_tot_len);
+		ret = c->base_reg + (reg_offset * map->reg_stride);
+	} else if (!c) {
+		c = list_last_entry(&map->debugfs_off_cache,
+				    struct regmap_debugfs_off_cache, list);
 		*pos = c->max;
 		ret = c->max_reg;
+	} else {
+		/* from falls in a gap, start with the next block */
+		*pos = c->min;
+		ret = c->base_reg;
 	}
+
+out:
 	mutex_unlock(&map->cache_lock);
 
 	return ret;
@@ -194,22 +248,40 @@ static inline void regmap_calc_tot_len(struct regmap *map,
 static int regmap_next_readable_reg(struct regmap *map, int reg)
 {
 	struct regmap_debugfs_off_cache *c;
+	unsigned int next;
 	int ret = -EINVAL;
 
-	if (regmap_printable(map, reg + map->reg_stride)) {
-		ret = reg + map->reg_stride;
-	} else {
-		mutex_lock(&map->cache_lock);
-		list_for_each_entry(c, &map->debugfs_off_cache, list) {
-			if (reg > c->max_reg)
-				continue;
+	if (regmap_printable(map, reg + map->reg_stride))
+		return reg + map->reg_stride;
+
+	mutex_lock(&map->cache_lock);
+
+	/* extend the index until a block starts beyond reg */
+	for (next = reg + map->reg_stride; ; next += 64 * map->reg_stride) {
+		if (regmap_debugfs_scan(map, 0, next))
+			break;
+
+		c = map->debugfs_off_hint;
+		if (!c || reg < c->base_reg)
+			c = list_first_entry(&map->debugfs_off_cache,
+					     struct regmap_debugfs_off_cache,
+					     list);
+
+		list_for_each_entry_from(c, &map->debugfs_off_cache, list) {
 			if (reg < c->base_reg) {
+				map->debugfs_off_hint = c;
 				ret = c->base_reg;
-				break;
+				goto out;
 			}
 		}
-		mutex_unlock(&map->cache_lock);
+
+		if (map->debugfs_scan_done)
+			break;
 	}
+
+out:
+	mutex_unlock(&map->cache_lock);
+
 	return ret;
 }
 
@@ -387,12 +459,13 @@ static ssize_t regmap_reg_ranges_read_file(struct file *file,
 	 * about the file position information that is contained
 	 * in the cache, just about the actual register blocks */
 	regmap_calc_tot_len(map, buf, count);
-	regmap_debugfs_get_dump_start(map, 0, *ppos, &p);
 
 	/* Reset file pointer as the fixed-format of the `registers'
 	 * file is not compatible with the `range' file */
 	p = 0;
 	mutex_lock(&map->cache_lock);
+	/* every block is listed, complete the index */
+	regmap_debugfs_scan(map, LLONG_MAX, map->max_register);
 	list_for_each_entry(c, &map->debugfs_off_cache, list) {
 		entry_len = snprintf(entry, PAGE_SIZE, "%x-%x\n",
 				     c->base_reg, c->max_reg);
@@ -451,6 +524,65 @@ static int regmap_access_show(struct seq_file *s, void *ignored)
 
 DEFINE_SHOW_ATTRIBUTE(regmap_access);
 
+void regmap_stats_add(struct regmap *map, enum regmap_stats_op op,
+		      ktime_t start, size_t bytes)
+{
+	struct regmap_stats *stats = &map->stats;
+	s64 us = ktime_us_delta(ktime_get(), start);
+	unsigned int bucket = 0;
+
+	if (us > 0)
+		bucket = min_t(unsigned int, ilog2(us) + 1,
+			       REGMAP_STATS_BUCKETS - 1);
+
+	stats->count[op]++;
+	stats->bytes[op] += bytes;
+	stats->hist[op][bucket]++;
+}
+
+static const char * const regmap_stats_names[REGMAP_STATS_NUM_OPS] = {
+	[REGMAP_STATS_READ] = "read",
+	[REGMAP_STATS_WRITE] = "write",
+	[REGMAP_STATS_SYNC] = "sync",
+};
+
+static int regmap_stats_show(struct seq_file *s, void *ignored)
+{
+	struct regmap *map = s->private;
+	struct regmap_stats stats;
+	int op, i;
+
+	map->lock(map->lock_arg);
+	memcpy(&stats, &map->stats, sizeof(stats));
+	map->unlock(map->lock_arg);
+
+	seq_printf(s, "cache hit %lld miss %lld\n",
+		   (s64)atomic64_read(&stats.cache_hit),
+		   (s64)atomic64_read(&stats.cache_miss));
+
+	for (op = 0; op < REGMAP_STATS_NUM_OPS; op++) {
+		seq_printf(s, "%s: %llu ops %llu bytes\n",
+			   regmap_stats_names[op], stats.count[op],
+			   stats.bytes[op]);
+
+		for (i = 0; i < REGMAP_STATS_BUCKETS; i++) {
+			if (!stats.hist[op][i])
+				continue;
+
+			if (i == REGMAP_STATS_BUCKETS - 1)
+				seq_printf(s, "  >= %lu us: %llu\n",
+					   BIT(i - 1), stats.hist[op][i]);
+			else
+				seq_printf(s, "  <  %lu us: %llu\n",
+					   BIT(i), stats.hist[op][i]);
+		}
+	}
+
+	return 0;
+}
+
+DEFINE_SHOW_ATTRIBUTE(regmap_stats);
+
 static ssize_t regmap_cache_only_write_file(struct file *file,
 					    const char __user *user_buf,
 					    size_t count, loff_t *ppos)
@@ -566,6 +698,7 @@ void regmap_debugfs_init(struct regmap *map, const char *name)
 
 	INIT_LIST_HEAD(&map->debugfs_off_cache);
 	mutex_init(&map->cache_lock);
+	regmap_debugfs_free_dump_cache(map);
 
 	if (map->dev)
 		devname = dev_name(map->dev);
@@ -595,6 +728,9 @@ void regmap_debugfs_init(struct regmap *map, const char *name)
 	debugfs_create_file("range", 0400, map->debugfs,
 			    map, &regmap_reg_ranges_fops);
 
+	debugfs_create_file("stats", 0400, map->debugfs,
+			    map, &regmap_stats_fops);
+
 	if (map->max_register || regmap_readable(map, 0)) {
 		umode_t registers_mode;
 
@@ -9,6 +9,8 @@
 #include <linux/regmap.h>
 #include <linux/i2c.h>
 #include <linux/module.h>
+#include <linux/slab.h>
+#include <dkms/linux/regmap-i2c.h>
 
 #include "internal.h"
 
@@ -197,6 +199,51 @@ static int regmap_i2c_read(void *context,
 		return -EIO;
 }
 
+/*
+ * Each reg/val pair is its own message, the adapter puts a repeated
+ * START between them instead of a STOP/START.
+ */
+static int regmap_i2c_combined_write(void *context, const void *data,
+				     size_t pair_size, size_t num)
+{
+	struct device *dev = context;
+	struct i2c_client *i2c = to_i2c_client(dev);
+	const struct i2c_adapter_quirks *q = i2c->adapter->quirks;
+	size_t max_msgs = num;
+	struct i2c_msg *xfer;
+	size_t i, done, n;
+	int ret = 0;
+
+	if (q && q->max_num_msgs)
+		max_msgs = min_t(size_t, num, q->max_num_msgs);
+
+	xfer = kcalloc(max_msgs, sizeof(*xfer), GFP_KERNEL);
+	if (!xfer)
+		return -ENOMEM;
+
+	for (done = 0; done < num; done += n) {
+		n = min(num - done, max_msgs);
+
+		for (i = 0; i < n; i++) {
+			xfer[i].addr = i2c->addr;
+			xfer[i].flags = 0;
+			xfer[i].len = pair_size;
+			xfer[i].buf = (u8 *)data + (done + i) * pair_size;
+		}
+
+		ret = i2c_transfer(i2c->adapter, xfer, n);
+		if (ret == n)
+			ret = 0;
+		else if (ret >= 0)
+			ret = -EIO;
+		if (ret)
+			break;
+	}
+
+	kfree(xfer);
+	return ret;
+}
+
 static const struct regmap_bus regmap_i2c = {
 	.write = regmap_i2c_write,
 	.gather_write = regmap_i2c_gather_write,
@@ -304,4 +351,43 @@ struct regmap *__devm_regmap_init_i2c(struct i2c_client *i2c,
 }
 EXPORT_SYMBOL_GPL(__devm_regmap_init_i2c);
 
+/**
+ * regmap_i2c_set_combined_write() - Combine multi register writes
+ *
+ * @map: Register map created by regmap_init_i2c()
+ * @enable: flag if regmap_multi_reg_write() may combine the writes
+ *
+ * For devices that cannot take a burst of reg/val pairs in one message
+ * (regmap_config.can_multi_write), send the writes of a
+ * regmap_multi_reg_write() or regmap_register_patch() sequence as one
+ * i2c_transfer() with a repeated START between the registers rather
+ * than one transfer per register. Only enable this for devices that
+ * latch each register write at the end of its data, not on STOP.
+ *
+ * Sequences with delays or paged registers are still written one
+ * register at a time.
+ *
+ * Return -EINVAL if @map is not a plain I2C map, -EOPNOTSUPP if the
+ * adapter cannot do repeated START, 0 on success.
+ */
+int regmap_i2c_set_combined_write(struct regmap *map, bool enable)
+{
+	struct i2c_client *i2c;
+
+	if (map->bus != &regmap_i2c)
+		return -EINVAL;
+
+	i2c = to_i2c_client(map->bus_context);
+	if (enable && i2c->adapter->quirks &&
+	    (i2c->adapter->quirks->flags & I2C_AQ_NO_REP_START))
+		return -EOPNOTSUPP;
+
+	map->lock(map->lock_arg);
+	map->combined_write = enable ? regmap_i2c_combined_write : NULL;
+	map->unlock(map->lock_arg);
+
+	return 0;
+}
+EXPORT_SYMBOL_GPL(regmap_i2c_set_combined_write);
+
 MODULE_LICENSE("GPL");
@@ -31,6 +31,7 @@ struct regmap_irq_chip_data {
 	int wake_count;
 
 	void *status_reg_buf;
+	struct reg_sequence *ack_seq;
 	unsigned int *main_status_buf;
 	unsigned int *status_buf;
 	unsigned int *mask_buf;
@@ -326,30 +327,112 @@ static const struct irq_chip regmap_irq_chip = {
 	.irq_set_wake		= regmap_irq_set_wake,
 };
 
+static unsigned int regmap_irq_get_reg_buf(struct regmap *map,
+					   const void *buf, unsigned int i)
+{
+	switch (map->format.val_bytes) {
+	case 1:
+		return ((const u8 *)buf)[i];
+	case 2:
+		return ((const u16 *)buf)[i];
+	case 4:
+		return ((const u32 *)buf)[i];
+	default:
+		BUG();
+	}
+
+	return 0;
+}
+
+/*
+ * Read @num registers starting at @base into @vals. Registers are read
+ * with a single bulk read when they are contiguous and the map allows
+ * it, status_reg_buf is then used as a bounce buffer.
+ */
+static int regmap_irq_read_regs(struct regmap_irq_chip_data *data,
+				unsigned int base, unsigned int num,
+				unsigned int *vals)
+{
+	struct regmap *map = data->map;
+	unsigned int i;
+	int ret;
+
+	if (data->status_reg_buf && num > 1 && num <= data->chip->num_regs) {
+		ret = regmap_bulk_read(map, base, data->status_reg_buf, num);
+		if (ret)
+			return ret;
+
+		for (i = 0; i < num; i++)
+			vals[i] = regmap_irq_get_reg_buf(map,
+							 data->status_reg_buf,
+							 i);
+		return 0;
+	}
+
+	for (i = 0; i < num; i++) {
+		ret = regmap_read(map, base + (i * map->reg_stride *
+					       data->irq_reg_stride),
+				  &vals[i]);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/*
+ * Read the sub registers of the main status bits @b to @b + @num - 1,
+ * with the linear mapping the whole run is covered by one read.
+ */
 static inline int read_sub_irq_data(struct regmap_irq_chip_data *data,
-					   unsigned int b)
+				    unsigned int b, unsigned int num)
 {
 	const struct regmap_irq_chip *chip = data->chip;
 	struct regmap *map = data->map;
 	struct regmap_irq_sub_irq_map *subreg;
+	unsigned int first, run;
 	int i, ret = 0;
 
 	if (!chip->sub_reg_offsets) {
 		/* Assume linear mapping */
-		ret = regmap_read(map, chip->status_base +
-				  (b * map->reg_stride * data->irq_reg_stride),
-				   &data->status_buf[b]);
-	} else {
+		return regmap_irq_read_regs(data, chip->status_base +
+					    (b * map->reg_stride *
+					     data->irq_reg_stride),
+					    num, &data->status_buf[b]);
+	}
+
+	for (; num; b++, num--) {
 		subreg = &chip->sub_reg_offsets[b];
-		for (i = 0; i < subreg->num_regs; i++) {
-			unsigned int offset = subreg->offset[i];
 
-			ret = regmap_read(map, chip->status_base + offset,
-					  &data->status_buf[offset]);
+		if (!data->status_reg_buf) {
+			for (i = 0; i < subreg->num_regs; i++) {
+				unsigned int offset = subreg->offset[i];
+
+				ret = regmap_read(map,
+						  chip->status_base + offset,
+						  &data->status_buf[offset]);
+				if (ret)
+					return ret;
+			}
+			continue;
+		}
+
+		/* bulk read each run of adjacent sub registers */
+		for (i = 0; i < subreg->num_regs; i += run) {
+			first = subreg->offset[i];
+			for (run = 1; i + run < subreg->num_regs; run++)
+				if (subreg->offset[i + run] != first + run)
+					break;
+
+			ret = regmap_irq_read_regs(data,
+						   chip->status_base + first,
+						   run,
+						   &data->status_buf[first]);
 			if (ret)
-				break;
+				return ret;
 		}
 	}
+
 	return ret;
 }
 
@@ -358,7 +441,7 @@ static irqreturn_t regmap_irq_thread(int irq, void *d)
 	struct regmap_irq_chip_data *data = d;
 	const struct regmap_irq_chip *chip = data->chip;
 	struct regmap *map = data->map;
-	int ret, i;
+	int ret, i, num_acks;
 	bool handled = false;
 	u32 reg;
 
@@ -391,115 +474,91 @@ static irqreturn_t regmap_irq_thread(int irq, void *d)
 		/* Clear the status buf as we don't read all status regs */
 		memset(data->status_buf, 0, size);
 
-		/* We could support bulk read for main status registers
-		 * but I don't expect to see devices with really many main
-		 * status registers so let's only support single reads for the
-		 * sake of simplicity. and add bulk reads only if needed
-		 */
-		for (i = 0; i < chip->num_main_regs; i++) {
-			ret = regmap_read(map, chip->main_status +
-				  (i * map->reg_stride
-				   * data->irq_reg_stride),
-				  &data->main_status_buf[i]);
-			if (ret) {
-				dev_err(map->dev,
-					"Failed to read IRQ status %d\n",
-					ret);
-				goto exit;
+		/* status_reg_buf only holds num_regs registers */
+		if (chip->num_main_regs <= chip->num_regs) {
+			ret = regmap_irq_read_regs(data, chip->main_status,
+						   chip->num_main_regs,
+						   data->main_status_buf);
+		} else {
+			for (i = 0, ret = 0; i < chip->num_main_regs; i++) {
+				ret = regmap_read(map, chip->main_status +
+						  (i * map->reg_stride *
+						   data->irq_reg_stride),
+						  &data->main_status_buf[i]);
+				if (ret)
+					break;
 			}
 		}
+		if (ret) {
+			dev_err(map->dev, "Failed to read IRQ status %d\n",
+				ret);
+			goto exit;
+		}
 
 		/* Read sub registers with active IRQs */
 		for (i = 0; i < chip->num_main_regs; i++) {
-			unsigned int b;
+			unsigned int b, end, base;
 			const unsigned long mreg = data->main_status_buf[i];
+			const unsigned int bits = map->format.val_bytes * 8;
+
+			base = i * bits;
 
-			for_each_set_bit(b, &mreg, map->format.val_bytes * 8) {
-				if (i * map->format.val_bytes * 8 + b >
-				    max_main_bits)
+			/* each run of set bits is read at once */
+			for_each_set_bit(b, &mreg, bits) {
+				if (base + b > max_main_bits)
 					break;
-				ret = read_sub_irq_data(data, b);
 
+				end = find_next_zero_bit(&mreg, bits, b);
+				if (base + end > max_main_bits + 1)
+					end = max_main_bits + 1 - base;
+
+				ret = read_sub_irq_data(data, b, end - b);
 				if (ret != 0) {
 					dev_err(map->dev,
 						"Failed to read IRQ status %d\n",
 						ret);
 					goto exit;
 				}
+
+				b = end;
 			}
 
 		}
-	} else if (!map->use_single_read && map->reg_stride == 1 &&
-		   data->irq_reg_stride == 1) {
-
-		u8 *buf8 = data->status_reg_buf;
-		u16 *buf16 = data->status_reg_buf;
-		u32 *buf32 = data->status_reg_buf;
-
-		BUG_ON(!data->status_reg_buf);
-
-		ret = regmap_bulk_read(map, chip->status_base,
-				       data->status_reg_buf,
-				       chip->num_regs);
+	} else {
+		ret = regmap_irq_read_regs(data, chip->status_base,
+					   chip->num_regs, data->status_buf);
 		if (ret != 0) {
 			dev_err(map->dev, "Failed to read IRQ status: %d\n",
 				ret);
 			goto exit;
 		}
-
-		for (i = 0; i < data->chip->num_regs; i++) {
-			switch (map->format.val_bytes) {
-			case 1:
-				data->status_buf[i] = buf8[i];
-				break;
-			case 2:
-				data->status_buf[i] = buf16[i];
-				break;
-			case 4:
-				data->status_buf[i] = buf32[i];
-				break;
-			default:
-				BUG();
-				goto exit;
-			}
-		}
-
-	} else {
-		for (i = 0; i < data->chip->num_regs; i++) {
-			ret = regmap_read(map, chip->status_base +
-					  (i * map->reg_stride
-					   * data->irq_reg_stride),
-					  &data->status_buf[i]);
-
-			if (ret != 0) {
-				dev_err(map->dev,
-					"Failed to read IRQ status: %d\n",
-					ret);
-				goto exit;
-			}
-		}
 	}
 
 	/*
 	 * Ignore masked IRQs and ack if we need to; we ack early so
 	 * there is no race between handling and acknowleding the
-	 * interrupt.  We assume that typically few of the interrupts
-	 * will fire simultaneously so don't worry about overhead from
-	 * doing a write per register.
+	 * interrupt. All the acks are submitted together so that buses
+	 * able to write several registers at once do a single transfer.
 	 */
-	for (i = 0; i < data->chip->num_regs; i++) {
+	for (i = 0, num_acks = 0; i < data->chip->num_regs; i++) {
 		data->status_buf[i] &= ~data->mask_buf[i];
 
-		if (data->status_buf[i] && (chip->ack_base || chip->use_ack)) {
+		if (data->status_buf[i] && data->ack_seq) {
 			reg = chip->ack_base +
 				(i * map->reg_stride * data->irq_reg_stride);
-			ret = regmap_write(map, reg, data->status_buf[i]);
-			if (ret != 0)
-				dev_err(map->dev, "Failed to ack 0x%x: %d\n",
-					reg, ret);
+			data->ack_seq[num_acks].reg = reg;
+			data->ack_seq[num_acks].def = data->status_buf[i];
+			num_acks++;
 		}
 	}
 
+	if (num_acks) {
+		ret = regmap_multi_reg_write(map, data->ack_seq, num_acks);
+		if (ret != 0)
+			dev_err(map->dev, "Failed to ack 0x%x: %d\n",
+				data->ack_seq[0].reg, ret);
+	}
+
 	for (i = 0; i < chip->num_irqs; i++) {
 		if (data->status_buf[chip->irqs[i].reg_offset /
 				     map->reg_stride] & chip->irqs[i].mask) {
@@ -664,6 +723,13 @@ int regmap_add_irq_chip(struct regmap *map, int irq, int irq_flags,
 			goto err_alloc;
 	}
 
+	if (chip->ack_base || chip->use_ack) {
+		d->ack_seq = kcalloc(chip->num_regs, sizeof(*d->ack_seq),
+				     GFP_KERNEL);
+		if (!d->ack_seq)
+			goto err_alloc;
+	}
+
 	mutex_init(&d->lock);
 
 	for (i = 0; i < chip->num_irqs; i++)
@@ -805,6 +871,7 @@ err_alloc:
 	kfree(d->mask_buf);
 	kfree(d->status_buf);
 	kfree(d->status_reg_buf);
+	kfree(d->ack_seq);
 	kfree(d);
 	return ret;
 }
@@ -850,6 +917,7 @@ void regmap_del_irq_chip(int irq, struct regmap_irq_chip_data *d)
 	kfree(d->mask_buf_def);
 	kfree(d->mask_buf);
 	kfree(d->status_reg_buf);
+	kfree(d->ack_seq);
 	kfree(d->status_buf);
 	kfree(d);
 }
@@ -10,6 +10,7 @@
 #include <linux/module.h>
 #include <linux/regmap.h>
 #include <linux/slab.h>
+#include <dkms/linux/regmap-mmio.h>
 
 #include "internal.h"
 
@@ -17,6 +18,7 @@ struct regmap_mmio_context {
 	void __iomem *regs;
 	unsigned val_bytes;
 
+	bool big_endian;
 	bool attached_clk;
 	struct clk *clk;
 
@@ -112,6 +114,36 @@ static void regmap_mmio_write64le(struct regmap_mmio_context *ctx,
 }
 #endif
 
+static void regmap_mmio_write8_relaxed(struct regmap_mmio_context *ctx,
+				       unsigned int reg,
+				       unsigned int val)
+{
+	writeb_relaxed(val, ctx->regs + reg);
+}
+
+static void regmap_mmio_write16le_relaxed(struct regmap_mmio_context *ctx,
+					  unsigned int reg,
+					  unsigned int val)
+{
+	writew_relaxed(val, ctx->regs + reg);
+}
+
+static void regmap_mmio_write32le_relaxed(struct regmap_mmio_context *ctx,
+					  unsigned int reg,
+					  unsigned int val)
+{
+	writel_relaxed(val, ctx->regs + reg);
+}
+
+#ifdef CONFIG_64BIT
+static void regmap_mmio_write64le_relaxed(struct regmap_mmio_context *ctx,
+					  unsigned int reg,
+					  unsigned int val)
+{
+	writeq_relaxed(val, ctx->regs + reg);
+}
+#endif
+
 static int regmap_mmio_write(void *context, unsigned int reg, unsigned int val)
 {
 	struct regmap_mmio_context *ctx = context;
@@ -169,6 +201,32 @@ static unsigned int regmap_mmio_read64le(struct regmap_mmio_context *ctx,
 }
 #endif
 
+static unsigned int regmap_mmio_read8_relaxed(struct regmap_mmio_context *ctx,
+					      unsigned int reg)
+{
+	return readb_relaxed(ctx->regs + reg);
+}
+
+static unsigned int regmap_mmio_read16le_relaxed(struct regmap_mmio_context *ctx,
+						 unsigned int reg)
+{
+	return readw_relaxed(ctx->regs + reg);
+}
+
+static unsigned int regmap_mmio_read32le_relaxed(struct regmap_mmio_context *ctx,
+						 unsigned int reg)
+{
+	return readl_relaxed(ctx->regs + reg);
+}
+
+#ifdef CONFIG_64BIT
+static unsigned int regmap_mmio_read64le_relaxed(struct regmap_mmio_context *ctx,
+						 unsigned int reg)
+{
+	return readq_relaxed(ctx->regs + reg);
+}
+#endif
+
 static int regmap_mmio_read(void *context, unsigned int reg, unsigned int *val)
 {
 	struct regmap_mmio_context *ctx = context;
@@ -273,6 +331,7 @@ static struct regmap_mmio_context *regmap_mmio_gen_context(struct device *dev,
 #ifdef __BIG_ENDIAN
 	case REGMAP_ENDIAN_NATIVE:
 #endif
+		ctx->big_endian = true;
 		switch (config->val_bits) {
 		case 8:
 			ctx->reg_read = regmap_mmio_read8;
@@ -376,4 +435,78 @@ void regmap_mmio_detach_clk(struct regmap *map)
 }
 EXPORT_SYMBOL_GPL(regmap_mmio_detach_clk);
 
+/**
+ * regmap_mmio_set_relaxed() - Use relaxed MMIO accessors for a register map
+ *
+ * @map: Register map created by regmap_init_mmio() or a variant of it
+ * @relaxed: true for the _relaxed() accessors, false for the default ones
+ *
+ * The relaxed accessors drop the barrier that readl()/writel() place
+ * around every access. Accesses to the device stay ordered with respect
+ * to each other, but not with respect to normal memory such as DMA
+ * buffers, so the driver must call regmap_mmio_barrier() wherever that
+ * ordering matters, typically before starting DMA in its trigger and
+ * after reading the interrupt status in its handler.
+ *
+ * This must be called before the map is used concurrently. Big endian
+ * maps with registers wider than 8 bits have no relaxed accessors and
+ * return -EINVAL.
+ */
+int regmap_mmio_set_relaxed(struct regmap *map, bool relaxed)
+{
+	struct regmap_mmio_context *ctx = map->bus_context;
+
+	if (ctx->big_endian && ctx->val_bytes > 1)
+		return -EINVAL;
+
+	switch (ctx->val_bytes) {
+	case 1:
+		ctx->reg_read = relaxed ? regmap_mmio_read8_relaxed :
+					  regmap_mmio_read8;
+		ctx->reg_write = relaxed ? regmap_mmio_write8_relaxed :
+					   regmap_mmio_write8;
+		break;
+	case 2:
+		ctx->reg_read = relaxed ? regmap_mmio_read16le_relaxed :
+					  regmap_mmio_read16le;
+		ctx->reg_write = relaxed ? regmap_mmio_write16le_relaxed :
+					   regmap_mmio_write16le;
+		break;
+	case 4:
+		ctx->reg_read = relaxed ? regmap_mmio_read32le_relaxed :
+					  regmap_mmio_read32le;
+		ctx->reg_write = relaxed ? regmap_mmio_write32le_relaxed :
+					   regmap_mmio_write32le;
+		break;
+#ifdef CONFIG_64BIT
+	case 8:
+		ctx->reg_read = relaxed ? regmap_mmio_read64le_relaxed :
+					  regmap_mmio_read64le;
+		ctx->reg_write = relaxed ? regmap_mmio_write64le_relaxed :
+					   regmap_mmio_write64le;
+		break;
+#endif
+	default:
+		return -EINVAL;
+	}
+
+	return 0;
+}
+EXPORT_SYMBOL_GPL(regmap_mmio_set_relaxed);
+
+/**
+ * regmap_mmio_barrier() - Order relaxed MMIO accesses against memory
+ *
+ * @map: Register map switched to relaxed accessors
+ *
+ * Orders all register accesses made through @map before this call
+ * against all normal memory accesses after it, and the other way
+ * round.
+ */
+void regmap_mmio_barrier(struct regmap *map)
+{
+	mb();
+}
+EXPORT_SYMBOL_GPL(regmap_mmio_barrier);
+
 MODULE_LICENSE("GPL v2");
@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: GPL-2.0
+// Copyright(c) 2020 Intel Corporation.
+
+#include <linux/device.h>
+#include <linux/errno.h>
+#include <linux/mod_devicetable.h>
+#include <linux/module.h>
+#include <linux/slab.h>
+#include <dkms/linux/soundwire/sdw.h>
+#include <dkms/linux/regmap-sdw-mbq.h>
+#include "internal.h"
+
+/*
+ * Multi-Byte Quantity registers: the MSB is latched by the Slave and
+ * the complete value is committed when the LSB is written, so both
+ * bytes are sent as a single batched SoundWire transfer.
+ */
+struct regmap_mbq_context {
+	struct sdw_slave *slave;
+	const struct regmap_sdw_mbq_cfg *mbq_cfg;
+};
+
+static int regmap_sdw_mbq_write(void *context, unsigned int reg,
+				unsigned int val)
+{
+	struct regmap_mbq_context *ctx = context;
+	u8 msb = (val >> 8) & 0xff;
+	u8 lsb = val & 0xff;
+	struct sdw_slave_xfer xfers[] = {
+		{ .addr = reg, .count = 1, .buf = &msb },
+		{ .addr = ctx->mbq_cfg->lsb_reg(reg), .count = 1, .buf = &lsb },
+	};
+
+	return sdw_xfer_batch(ctx->slave, xfers, ARRAY_SIZE(xfers));
+}
+
+static int regmap_sdw_mbq_read(void *context, unsigned int reg,
+			       unsigned int *val)
+{
+	struct regmap_mbq_context *ctx = context;
+	u8 msb, lsb;
+	struct sdw_slave_xfer xfers[] = {
+		{ .addr = reg, .count = 1, .buf = &msb, .read = true },
+		{ .addr = ctx->mbq_cfg->lsb_reg(reg), .count = 1, .buf = &lsb,
+		  .read = true },
+	};
+	int ret;
+
+	ret = sdw_xfer_batch(ctx->slave, xfers, ARRAY_SIZE(xfers));
+	if (ret < 0)
+		return ret;
+
+	*val = msb << 8 | lsb;
+	return 0;
+}
+
+static void regmap_sdw_mbq_free_context(void *context)
+{
+	kfree(context);
+}
+
+static struct regmap_bus regmap_sdw_mbq = {
+	.reg_read = regmap_sdw_mbq_read,
+	.reg_write = regmap_sdw_mbq_write,
+	.free_context = regmap_sdw_mbq_free_context,
+	.reg_format_endian_default = REGMAP_ENDIAN_LITTLE,
+	.val_format_endian_default = REGMAP_ENDIAN_LITTLE,
+};
+
+static struct regmap_mbq_context *
+regmap_sdw_mbq_gen_context(struct sdw_slave *sdw,
+			   const struct regmap_config *config,
+			   const struct regmap_sdw_mbq_cfg *mbq_cfg)
+{
+	struct regmap_mbq_context *ctx;
+
+	/* MBQ registers are 16-bits wide, split in two 8-bit registers */
+	if (config->val_bits != 16)
+		return ERR_PTR(-ENOTSUPP);
+
+	/* Registers are 32 bits wide */
+	if (config->reg_bits != 32)
+		return ERR_PTR(-ENOTSUPP);
+
+	if (config->pad_bits != 0)
+		return ERR_PTR(-ENOTSUPP);
+
+	if (!mbq_cfg || !mbq_cfg->lsb_reg)
+		return ERR_PTR(-EINVAL);
+
+	ctx = kzalloc(sizeof(*ctx), GFP_KERNEL);
+	if (!ctx)
+		return ERR_PTR(-ENOMEM);
+
+	ctx->slave = sdw;
+	ctx->mbq_cfg = mbq_cfg;
+
+	return ctx;
+}
+
+struct regmap *__regmap_init_sdw_mbq(struct sdw_slave *sdw,
+				     const struct regmap_config *config,
+				     const struct regmap_sdw_mbq_cfg *mbq_cfg,
+				     struct lock_class_key *lock_key,
+				     const char *lock_name)
+{
+	struct regmap_mbq_context *ctx;
+
+	ctx = regmap_sdw_mbq_gen_context(sdw, config, mbq_cfg);
+	if (IS_ERR(ctx))
+		return ERR_CAST(ctx);
+
+	return __regmap_init(&sdw->dev, &regmap_sdw_mbq,
+			ctx, config, lock_key, lock_name);
+}
+EXPORT_SYMBOL_GPL(__regmap_init_sdw_mbq);
+
+struct regmap *__devm_regmap_init_sdw_mbq(struct sdw_slave *sdw,
+					  const struct regmap_config *config,
+					  const struct regmap_sdw_mbq_cfg *mbq_cfg,
+					  struct lock_class_key *lock_key,
+					  const char *lock_name)
+{
+	struct regmap_mbq_context *ctx;
+
+	ctx = regmap_sdw_mbq_gen_context(sdw, config, mbq_cfg);
+	if (IS_ERR(ctx))
+		return ERR_CAST(ctx);
+
+	return __devm_regmap_init(&sdw->dev, &regmap_sdw_mbq,
+			ctx, config, lock_key, lock_name);
+}
+EXPORT_SYMBOL_GPL(__devm_regmap_init_sdw_mbq);
+
+MODULE_DESCRIPTION("Regmap SoundWire MBQ Module");
+MODULE_LICENSE("GPL v2");
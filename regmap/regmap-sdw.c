@@ -4,34 +4,83 @@
 #include <linux/device.h>
 #include <linux/mod_devicetable.h>
 #include <linux/module.h>
+#include <asm/unaligned.h>
 #include <dkms/linux/soundwire/sdw.h>
 #include "internal.h"
 
-static int regmap_sdw_write(void *context, unsigned int reg, unsigned int val)
+/*
+ * Contiguous accesses are split so that the SCP_AddrPage registers
+ * programmed for the first register of a transfer remain valid
+ */
+#define REGMAP_SDW_PAGE_SIZE	0x8000
+
+static int regmap_sdw_xfer(struct sdw_slave *slave, u32 reg, u8 *buf,
+			   size_t count, bool write)
+{
+	size_t len;
+	int ret;
+
+	while (count) {
+		len = REGMAP_SDW_PAGE_SIZE - (reg & (REGMAP_SDW_PAGE_SIZE - 1));
+		len = min(len, count);
+
+		if (write)
+			ret = sdw_nwrite(slave, reg, len, buf);
+		else
+			ret = sdw_nread(slave, reg, len, buf);
+		if (ret < 0)
+			return ret;
+
+		reg += len;
+		buf += len;
+		count -= len;
+	}
+
+	return 0;
+}
+
+static int regmap_sdw_gather_write(void *context,
+				   const void *reg_buf, size_t reg_size,
+				   const void *val_buf, size_t val_size)
 {
 	struct device *dev = context;
 	struct sdw_slave *slave = dev_to_sdw_dev(dev);
 
-	return sdw_write(slave, reg, val);
+	if (reg_size != sizeof(u32))
+		return -EINVAL;
+
+	return regmap_sdw_xfer(slave, get_unaligned_le32(reg_buf),
+			       (u8 *)val_buf, val_size, true);
+}
+
+static int regmap_sdw_write(void *context, const void *data, size_t count)
+{
+	if (count < sizeof(u32))
+		return -EINVAL;
+
+	return regmap_sdw_gather_write(context, data, sizeof(u32),
+				       data + sizeof(u32),
+				       count - sizeof(u32));
 }
 
-static int regmap_sdw_read(void *context, unsigned int reg, unsigned int *val)
+static int regmap_sdw_read(void *context,
+			   const void *reg_buf, size_t reg_size,
+			   void *val_buf, size_t val_size)
 {
 	struct device *dev = context;
 	struct sdw_slave *slave = dev_to_sdw_dev(dev);
-	int read;
 
-	read = sdw_read(slave, reg);
-	if (read < 0)
-		return read;
+	if (reg_size != sizeof(u32))
+		return -EINVAL;
 
-	*val = read;
-	return 0;
+	return regmap_sdw_xfer(slave, get_unaligned_le32(reg_buf),
+			       val_buf, val_size, false);
 }
 
 static struct regmap_bus regmap_sdw = {
-	.reg_read = regmap_sdw_read,
-	.reg_write = regmap_sdw_write,
+	.write = regmap_sdw_write,
+	.gather_write = regmap_sdw_gather_write,
+	.read = regmap_sdw_read,
 	.reg_format_endian_default = REGMAP_ENDIAN_LITTLE,
 	.val_format_endian_default = REGMAP_ENDIAN_LITTLE,
 };
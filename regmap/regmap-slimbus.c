@@ -7,19 +7,64 @@
 
 #include "internal.h"
 
+/*
+ * A value element message carries 1, 2, 3, 4, 6, 8, 12 or 16 bytes, larger
+ * or odd sized transfers are split in as few messages as possible.
+ */
+static size_t regmap_slimbus_slice(size_t count)
+{
+	static const u8 slice_sizes[] = { 16, 12, 8, 6, 4, 3, 2, 1 };
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(slice_sizes) - 1; i++) {
+		if (slice_sizes[i] <= count)
+			break;
+	}
+
+	return slice_sizes[i];
+}
+
 static int regmap_slimbus_write(void *context, const void *data, size_t count)
 {
 	struct slim_device *sdev = context;
-
-	return slim_write(sdev, *(u16 *)data, count - 2, (u8 *)data + 2);
+	u16 reg = *(u16 *)data;
+	u8 *val = (u8 *)data + 2;
+	size_t len;
+	int ret;
+
+	for (count -= 2; count; count -= len) {
+		len = regmap_slimbus_slice(count);
+		ret = slim_write(sdev, reg, len, val);
+		if (ret)
+			return ret;
+
+		reg += len;
+		val += len;
+	}
+
+	return 0;
 }
 
 static int regmap_slimbus_read(void *context, const void *reg, size_t reg_size,
 			       void *val, size_t val_size)
 {
 	struct slim_device *sdev = context;
-
-	return slim_read(sdev, *(u16 *)reg, val_size, val);
+	u16 addr = *(u16 *)reg;
+	u8 *buf = val;
+	size_t len;
+	int ret;
+
+	for (; val_size; val_size -= len) {
+		len = regmap_slimbus_slice(val_size);
+		ret = slim_read(sdev, addr, len, buf);
+		if (ret)
+			return ret;
+
+		addr += len;
+		buf += len;
+	}
+
+	return 0;
 }
 
 static struct regmap_bus regmap_slimbus_bus = {
@@ -63,7 +108,7 @@ struct regmap *__devm_regmap_init_slimbus(struct slim_device *slimbus,
 	if (IS_ERR(bus))
 		return ERR_CAST(bus);
 
-	return __devm_regmap_init(&slimbus->dev, bus, &slimbus, config,
+	return __devm_regmap_init(&slimbus->dev, bus, slimbus, config,
 				  lock_key, lock_name);
 }
 EXPORT_SYMBOL_GPL(__devm_regmap_init_slimbus);
@@ -17,6 +17,7 @@
 #include <linux/delay.h>
 #include <linux/log2.h>
 #include <linux/hwspinlock.h>
+#include <linux/workqueue.h>
 
 #define CREATE_TRACE_POINTS
 #include "trace.h"
@@ -41,6 +42,7 @@ static inline bool regmap_should_log(struct regmap *map) { return false; }
 #endif
 
 
+static void regmap_write_behind_work(struct work_struct *work);
 static int _regmap_update_bits(struct regmap *map, unsigned int reg,
 			       unsigned int mask, unsigned int val,
 			       bool *change, bool force_write);
@@ -86,7 +88,7 @@ bool regmap_check_range_table(struct regmap *map, unsigned int reg,
 }
 EXPORT_SYMBOL_GPL(regmap_check_range_table);
 
-bool regmap_writeable(struct regmap *map, unsigned int reg)
+static bool __regmap_writeable(struct regmap *map, unsigned int reg)
 {
 	if (map->max_register && reg > map->max_register)
 		return false;
@@ -123,7 +125,7 @@ bool regmap_cached(struct regmap *map, unsigned int reg)
 	return true;
 }
 
-bool regmap_readable(struct regmap *map, unsigned int reg)
+static bool __regmap_readable(struct regmap *map, unsigned int reg)
 {
 	if (!map->reg_read)
 		return false;
@@ -143,7 +145,7 @@ bool regmap_readable(struct regmap *map, unsigned int reg)
 	return true;
 }
 
-bool regmap_volatile(struct regmap *map, unsigned int reg)
+static bool __regmap_volatile(struct regmap *map, unsigned int reg)
 {
 	if (!map->format.format_write && !regmap_readable(map, reg))
 		return false;
@@ -160,7 +162,7 @@ bool regmap_volatile(struct regmap *map, unsigned int reg)
 		return true;
 }
 
-bool regmap_precious(struct regmap *map, unsigned int reg)
+static bool __regmap_precious(struct regmap *map, unsigned int reg)
 {
 	if (!regmap_readable(map, reg))
 		return false;
@@ -174,6 +176,106 @@ bool regmap_precious(struct regmap *map, unsigned int reg)
 	return false;
 }
 
+static bool regmap_access_lookup(struct regmap *map, unsigned int reg,
+				 u8 *access)
+{
+	unsigned int idx;
+
+	if (!map->access || !IS_ALIGNED(reg, map->reg_stride))
+		return false;
+
+	idx = reg / map->reg_stride;
+	if (idx >= map->num_access)
+		return false;
+
+	*access = map->access[idx];
+
+	return true;
+}
+
+bool regmap_writeable(struct regmap *map, unsigned int reg)
+{
+	u8 access;
+
+	if (regmap_access_lookup(map, reg, &access))
+		return access & REGMAP_ACCESS_WRITEABLE;
+
+	return __regmap_writeable(map, reg);
+}
+
+bool regmap_readable(struct regmap *map, unsigned int reg)
+{
+	u8 access;
+
+	if (regmap_access_lookup(map, reg, &access))
+		return access & REGMAP_ACCESS_READABLE;
+
+	return __regmap_readable(map, reg);
+}
+
+bool regmap_volatile(struct regmap *map, unsigned int reg)
+{
+	u8 access;
+
+	if (regmap_access_lookup(map, reg, &access))
+		return access & REGMAP_ACCESS_VOLATILE;
+
+	return __regmap_volatile(map, reg);
+}
+
+bool regmap_precious(struct regmap *map, unsigned int reg)
+{
+	u8 access;
+
+	if (regmap_access_lookup(map, reg, &access))
+		return access & REGMAP_ACCESS_PRECIOUS;
+
+	return __regmap_precious(map, reg);
+}
+
+/*
+ * The access callbacks and tables are evaluated once for every register
+ * of small enough maps, so that the checks done on each access become a
+ * table lookup. They are expected not to change except through
+ * regmap_reinit_cache(), which evaluates them again.
+ */
+static int regmap_access_init(struct regmap *map)
+{
+	unsigned int i, num, reg;
+	u8 *access;
+
+	map->num_access = 0;
+
+	if (!map->max_register)
+		return 0;
+
+	num = map->max_register / map->reg_stride + 1;
+	if (num > REGMAP_ACCESS_MAX_REGS)
+		return 0;
+
+	access = kcalloc(num, sizeof(*access), GFP_KERNEL);
+	if (!access)
+		return -ENOMEM;
+
+	for (i = 0; i < num; i++) {
+		reg = regmap_get_offset(map, i);
+
+		if (__regmap_writeable(map, reg))
+			access[i] |= REGMAP_ACCESS_WRITEABLE;
+		if (__regmap_readable(map, reg))
+			access[i] |= REGMAP_ACCESS_READABLE;
+		if (__regmap_volatile(map, reg))
+			access[i] |= REGMAP_ACCESS_VOLATILE;
+		if (__regmap_precious(map, reg))
+			access[i] |= REGMAP_ACCESS_PRECIOUS;
+	}
+
+	map->access = access;
+	map->num_access = num;
+
+	return 0;
+}
+
 bool regmap_writeable_noinc(struct regmap *map, unsigned int reg)
 {
 	if (map->writeable_noinc_reg)
@@ -808,6 +910,8 @@ struct regmap *__regmap_init(struct device *dev,
 	INIT_LIST_HEAD(&map->async_list);
 	INIT_LIST_HEAD(&map->async_free);
 	init_waitqueue_head(&map->async_waitq);
+	xa_init(&map->write_behind_pending);
+	INIT_WORK(&map->write_behind_work, regmap_write_behind_work);
 
 	if (config->read_flag_mask ||
 	    config->write_flag_mask ||
@@ -1144,6 +1248,10 @@ skip_format_initialization:
 	if (ret != 0)
 		goto err_range;
 
+	ret = regmap_access_init(map);
+	if (ret != 0)
+		goto err_regcache;
+
 	if (dev) {
 		ret = regmap_attach_dev(dev, map, config);
 		if (ret != 0)
@@ -1155,6 +1263,7 @@ skip_format_initialization:
 	return map;
 
 err_regcache:
+	kfree(map->access);
 	regcache_exit(map);
 err_range:
 	regmap_range_exit(map);
@@ -1309,9 +1418,19 @@ EXPORT_SYMBOL_GPL(regmap_field_free);
  */
 int regmap_reinit_cache(struct regmap *map, const struct regmap_config *config)
 {
+	int ret;
+
+	/* the pending writes need the cache about to be discarded */
+	cancel_work_sync(&map->write_behind_work);
+	_regmap_write_behind_flush(map);
+
 	regcache_exit(map);
 	regmap_debugfs_exit(map);
 
+	/* the new callbacks must be used while the cache is initialized */
+	kfree(map->access);
+	map->access = NULL;
+
 	map->max_register = config->max_register;
 	map->writeable_reg = config->writeable_reg;
 	map->readable_reg = config->readable_reg;
@@ -1326,7 +1445,11 @@ int regmap_reinit_cache(struct regmap *map, const struct regmap_config *config)
 	map->cache_bypass = false;
 	map->cache_only = false;
 
-	return regcache_init(map, config);
+	ret = regcache_init(map, config);
+	if (ret != 0)
+		return ret;
+
+	return regmap_access_init(map);
 }
 EXPORT_SYMBOL_GPL(regmap_reinit_cache);
 
@@ -1339,9 +1462,14 @@ void regmap_exit(struct regmap *map)
 {
 	struct regmap_async *async;
 
+	cancel_work_sync(&map->write_behind_work);
+	_regmap_write_behind_flush(map);
+	xa_destroy(&map->write_behind_pending);
+
 	regcache_exit(map);
 	regmap_debugfs_exit(map);
 	regmap_range_exit(map);
+	kfree(map->access);
 	if (map->bus && map->bus->free_context)
 		map->bus->free_context(map->bus_context);
 	kfree(map->work_buf);
@@ -1474,6 +1602,95 @@ static void regmap_set_work_buf_flag_mask(struct regmap *map, int max_bytes,
 		buf[i] |= (mask >> (8 * i)) & 0xff;
 }
 
+/*
+ * Write out the registers accepted in the cache by the write-behind
+ * mode, called with the map locked.
+ */
+int _regmap_write_behind_flush(struct regmap *map)
+{
+	bool bypass = map->cache_bypass;
+	int ret;
+
+	if (map->write_behind_busy || xa_empty(&map->write_behind_pending))
+		return 0;
+
+	map->write_behind_busy = true;
+
+	ret = regcache_written_sync(map, &map->write_behind_pending, 0,
+				    map->max_register);
+	if (ret)
+		dev_err(map->dev, "Failed to flush the pending writes: %d\n",
+			ret);
+
+	map->cache_bypass = bypass;
+	xa_destroy(&map->write_behind_pending);
+	map->write_behind_busy = false;
+
+	return ret;
+}
+
+static void regmap_write_behind_work(struct work_struct *work)
+{
+	struct regmap *map = container_of(work, struct regmap,
+					  write_behind_work);
+
+	map->lock(map->lock_arg);
+	_regmap_write_behind_flush(map);
+	map->unlock(map->lock_arg);
+}
+
+/*
+ * Accept a write already stored in the cache without writing it to the
+ * HW. Volatile registers are always written immediately, and if the
+ * register can't be recorded the write is done synchronously.
+ */
+static bool regmap_write_behind_defer(struct regmap *map, unsigned int reg)
+{
+	if (!map->write_behind || map->write_behind_busy ||
+	    regmap_volatile(map, reg))
+		return false;
+
+	if (regcache_set_written(map, &map->write_behind_pending, reg))
+		return false;
+
+	schedule_work(&map->write_behind_work);
+
+	return true;
+}
+
+/**
+ * regmap_write_behind() - Let cached writes complete asynchronously
+ *
+ * @map: Register map to configure
+ * @enable: flag if the writes to the HW may be deferred
+ *
+ * In write-behind mode, writes to non-volatile registers only update the
+ * cache and return, the HW is updated from a worker, in batches when
+ * the bus can write several registers at once. Any other access to the
+ * HW first flushes the pending writes so the ordering is kept, and
+ * regmap_async_complete() waits for all of them to be written.
+ *
+ * Errors of the deferred writes are only logged.
+ *
+ * Return -EINVAL if the map has no cache, 0 on success.
+ */
+int regmap_write_behind(struct regmap *map, bool enable)
+{
+	int ret = 0;
+
+	if (map->cache_type == REGCACHE_NONE)
+		return -EINVAL;
+
+	map->lock(map->lock_arg);
+	map->write_behind = enable;
+	if (!enable)
+		ret = _regmap_write_behind_flush(map);
+	map->unlock(map->lock_arg);
+
+	return ret;
+}
+EXPORT_SYMBOL_GPL(regmap_write_behind);
+
 static int _regmap_raw_write_impl(struct regmap *map, unsigned int reg,
 				  const void *val, size_t val_len)
 {
@@ -1522,6 +1739,10 @@ static int _regmap_raw_write_impl(struct regmap *map, unsigned int reg,
 		}
 	}
 
+	ret = _regmap_write_behind_flush(map);
+	if (ret)
+		return ret;
+
 	range = _regmap_range_lookup(map, reg);
 	if (range) {
 		int val_num = val_len / map->format.val_bytes;
@@ -1767,6 +1988,7 @@ static inline void *_regmap_map_get_context(struct regmap *map)
 int _regmap_write(struct regmap *map, unsigned int reg,
 		  unsigned int val)
 {
+	ktime_t start;
 	int ret;
 	void *context = _regmap_map_get_context(map);
 
@@ -1781,14 +2003,26 @@ int _regmap_write(struct regmap *map, unsigned int reg,
 			map->cache_dirty = true;
 			return 0;
 		}
+		if (regmap_write_behind_defer(map, reg))
+			return 0;
 	}
 
+	ret = _regmap_write_behind_flush(map);
+	if (ret)
+		return ret;
+
 	if (regmap_should_log(map))
 		dev_info(map->dev, "%x <= %x\n", reg, val);
 
 	trace_regmap_reg_write(map, reg, val);
 
-	return map->reg_write(context, reg, val);
+	start = regmap_stats_start();
+	ret = map->reg_write(context, reg, val);
+	if (ret == 0)
+		regmap_stats_add(map, REGMAP_STATS_WRITE, start,
+				 map->format.val_bytes);
+
+	return ret;
 }
 
 /**
@@ -1856,6 +2090,8 @@ int _regmap_raw_write(struct regmap *map, unsigned int reg,
 	size_t val_count = val_len / val_bytes;
 	size_t chunk_count, chunk_bytes;
 	size_t chunk_regs = val_count;
+	ktime_t start = regmap_stats_start();
+	size_t len = val_len;
 	int ret, i;
 
 	if (!val_count)
@@ -1884,6 +2120,9 @@ int _regmap_raw_write(struct regmap *map, unsigned int reg,
 	if (val_len)
 		ret = _regmap_raw_write_impl(map, reg, val, val_len);
 
+	if (ret == 0 && !map->cache_only)
+		regmap_stats_add(map, REGMAP_STATS_WRITE, start, len);
+
 	return ret;
 }
 
@@ -2265,14 +2504,100 @@ static int _regmap_range_multi_paged_reg_write(struct regmap *map,
 	return 0;
 }
 
-static int _regmap_multi_reg_write(struct regmap *map,
-				   const struct reg_sequence *regs,
-				   size_t num_regs)
+static bool regmap_can_combine_write(struct regmap *map,
+				     const struct reg_sequence *regs,
+				     size_t num_regs)
+{
+	int i;
+
+	if (!map->combined_write || num_regs < 2 ||
+	    map->format.format_write || map->write_behind)
+		return false;
+
+	for (i = 0; i < num_regs; i++)
+		if (regs[i].delay_us || _regmap_range_lookup(map, regs[i].reg))
+			return false;
+
+	return true;
+}
+
+/*
+ * Same as writing the registers one by one with _regmap_write(), but
+ * the ones that reach the HW are sent in a single combined transfer.
+ */
+static int _regmap_combined_multi_reg_write(struct regmap *map,
+					    const struct reg_sequence *regs,
+					    size_t num_regs)
+{
+	size_t reg_bytes = map->format.reg_bytes;
+	size_t pad_bytes = map->format.pad_bytes;
+	size_t pair_size = reg_bytes + pad_bytes + map->format.val_bytes;
+	ktime_t start;
+	size_t n = 0;
+	u8 *buf, *pair;
+	int i, ret;
+
+	buf = kmalloc_array(num_regs, pair_size, GFP_KERNEL);
+	if (!buf)
+		return -ENOMEM;
+
+	for (i = 0; i < num_regs; i++) {
+		unsigned int reg = regs[i].reg;
+		unsigned int val = regs[i].def;
+
+		if (!regmap_writeable(map, reg)) {
+			ret = -EIO;
+			goto out;
+		}
+
+		if (!map->cache_bypass && !map->defer_caching) {
+			ret = regcache_write(map, reg, val);
+			if (ret != 0)
+				goto out;
+			if (map->cache_only) {
+				map->cache_dirty = true;
+				continue;
+			}
+		}
+
+		if (regmap_should_log(map))
+			dev_info(map->dev, "%x <= %x\n", reg, val);
+
+		trace_regmap_reg_write(map, reg, val);
+
+		pair = buf + n * pair_size;
+		map->format.format_reg(pair, reg, map->reg_shift);
+		map->format.format_val(pair + reg_bytes + pad_bytes, val, 0);
+		pair[0] |= map->write_flag_mask;
+		n++;
+	}
+
+	ret = 0;
+	if (!n)
+		goto out;
+
+	start = regmap_stats_start();
+	ret = map->combined_write(map->bus_context, buf, pair_size, n);
+	if (ret == 0)
+		regmap_stats_add(map, REGMAP_STATS_WRITE, start,
+				 n * map->format.val_bytes);
+out:
+	kfree(buf);
+	return ret;
+}
+
+int _regmap_multi_reg_write(struct regmap *map,
+			    const struct reg_sequence *regs,
+			    size_t num_regs)
 {
 	int i;
 	int ret;
 
 	if (!map->can_multi_write) {
+		if (regmap_can_combine_write(map, regs, num_regs))
+			return _regmap_combined_multi_reg_write(map, regs,
+								num_regs);
+
 		for (i = 0; i < num_regs; i++) {
 			ret = _regmap_write(map, regs[i].reg, regs[i].def);
 			if (ret != 0)
@@ -2314,6 +2639,10 @@ static int _regmap_multi_reg_write(struct regmap *map,
 		}
 	}
 
+	ret = _regmap_write_behind_flush(map);
+	if (ret)
+		return ret;
+
 	WARN_ON(!map->bus);
 
 	for (i = 0; i < num_regs; i++) {
@@ -2460,8 +2789,8 @@ int regmap_raw_write_async(struct regmap *map, unsigned int reg,
 }
 EXPORT_SYMBOL_GPL(regmap_raw_write_async);
 
-static int _regmap_raw_read(struct regmap *map, unsigned int reg, void *val,
-			    unsigned int val_len)
+static int __regmap_raw_read(struct regmap *map, unsigned int reg, void *val,
+			     unsigned int val_len)
 {
 	struct regmap_range_node *range;
 	int ret;
@@ -2471,6 +2800,10 @@ static int _regmap_raw_read(struct regmap *map, unsigned int reg, void *val,
 	if (!map->bus || !map->bus->read)
 		return -EINVAL;
 
+	ret = _regmap_write_behind_flush(map);
+	if (ret)
+		return ret;
+
 	range = _regmap_range_lookup(map, reg);
 	if (range) {
 		ret = _regmap_select_page(map, &reg, range,
@@ -2493,6 +2826,20 @@ static int _regmap_raw_read(struct regmap *map, unsigned int reg, void *val,
 	return ret;
 }
 
+/* single register reads through the bus are accounted by _regmap_read() */
+static int _regmap_raw_read(struct regmap *map, unsigned int reg, void *val,
+			    unsigned int val_len)
+{
+	ktime_t start = regmap_stats_start();
+	int ret;
+
+	ret = __regmap_raw_read(map, reg, val, val_len);
+	if (ret == 0)
+		regmap_stats_add(map, REGMAP_STATS_READ, start, val_len);
+
+	return ret;
+}
+
 static int _regmap_bus_reg_read(void *context, unsigned int reg,
 				unsigned int *val)
 {
@@ -2512,7 +2859,7 @@ static int _regmap_bus_read(void *context, unsigned int reg,
 	if (!map->format.parse_val)
 		return -EINVAL;
 
-	ret = _regmap_raw_read(map, reg, work_val, map->format.val_bytes);
+	ret = __regmap_raw_read(map, reg, work_val, map->format.val_bytes);
 	if (ret == 0)
 		*val = map->format.parse_val(work_val);
 
@@ -2522,13 +2869,18 @@ static int _regmap_bus_read(void *context, unsigned int reg,
 static int _regmap_read(struct regmap *map, unsigned int reg,
 			unsigned int *val)
 {
+	ktime_t start;
 	int ret;
 	void *context = _regmap_map_get_context(map);
 
 	if (!map->cache_bypass) {
 		ret = regcache_read(map, reg, val);
-		if (ret == 0)
+		if (ret == 0) {
+			regmap_stats_cache(map, true);
 			return 0;
+		}
+		if (map->cache_type != REGCACHE_NONE)
+			regmap_stats_cache(map, false);
 	}
 
 	if (map->cache_only)
@@ -2537,8 +2889,16 @@ static int _regmap_read(struct regmap *map, unsigned int reg,
 	if (!regmap_readable(map, reg))
 		return -EIO;
 
+	ret = _regmap_write_behind_flush(map);
+	if (ret)
+		return ret;
+
+	start = regmap_stats_start();
 	ret = map->reg_read(context, reg, val);
 	if (ret == 0) {
+		regmap_stats_add(map, REGMAP_STATS_READ, start,
+				 map->format.val_bytes);
+
 		if (regmap_should_log(map))
 			dev_info(map->dev, "%x => %x\n", reg, *val);
 
@@ -2568,6 +2928,9 @@ int regmap_read(struct regmap *map, unsigned int reg, unsigned int *val)
 	if (!IS_ALIGNED(reg, map->reg_stride))
 		return -EINVAL;
 
+	if (regcache_read_lockless(map, reg, val) == 0)
+		return 0;
+
 	map->lock(map->lock_arg);
 
 	ret = _regmap_read(map, reg, val);
@@ -2982,6 +3345,18 @@ int regmap_async_complete(struct regmap *map)
 	unsigned long flags;
 	int ret;
 
+	/*
+	 * Flush the write-behind writes, unless called from a cache sync
+	 * which already holds the map lock and flushed them.
+	 */
+	if (READ_ONCE(map->write_behind) && !map->async) {
+		map->lock(map->lock_arg);
+		ret = _regmap_write_behind_flush(map);
+		map->unlock(map->lock_arg);
+		if (ret)
+			return ret;
+	}
+
 	/* Nothing to do with no async support */
 	if (!map->bus || !map->bus->async_write)
 		return 0;
@@ -140,6 +140,19 @@ static void config_acp3x_dma(struct i2s_stream_instance *rtd, int direction)
 	rv_writel(PAGE_SIZE_4K_ENABLE, rtd->acp3x_base +
 		  mmACPAXI2AXI_ATU_PAGE_SIZE_GRP_1);
 
+	/*
+	 * The page table lives in ACP SRAM, which keeps its contents while
+	 * the stream is open. Only rewrite it when the buffer moved.
+	 */
+	if (rtd->pte_valid && rtd->pte_offset == val &&
+	    rtd->pte_addr == addr && rtd->pte_pages == rtd->num_pages)
+		goto skip_pte;
+
+	rtd->pte_valid = true;
+	rtd->pte_offset = val;
+	rtd->pte_addr = addr;
+	rtd->pte_pages = rtd->num_pages;
+
 	for (page_idx = 0; page_idx < rtd->num_pages; page_idx++) {
 		/* Load the low address of page int ACP SRAM through SRBM */
 		low = lower_32_bits(addr);
@@ -154,6 +167,8 @@ static void config_acp3x_dma(struct i2s_stream_instance *rtd, int direction)
 		addr += PAGE_SIZE;
 	}
 
+skip_pte:
+
 	if (direction == SNDRV_PCM_STREAM_PLAYBACK) {
 		switch (rtd->i2s_instance) {
 		case I2S_BT_INSTANCE:
@@ -447,6 +462,8 @@ static int acp3x_resume(struct device *dev)
 	if (adata->play_stream && adata->play_stream->runtime) {
 		struct i2s_stream_instance *rtd =
 			adata->play_stream->runtime->private_data;
+		/* the ACP SRAM was powered off */
+		rtd->pte_valid = false;
 		config_acp3x_dma(rtd, SNDRV_PCM_STREAM_PLAYBACK);
 		switch (rtd->i2s_instance) {
 		case I2S_BT_INSTANCE:
@@ -463,6 +480,8 @@ static int acp3x_resume(struct device *dev)
 	if (adata->capture_stream && adata->capture_stream->runtime) {
 		struct i2s_stream_instance *rtd =
 			adata->capture_stream->runtime->private_data;
+		/* the ACP SRAM was powered off */
+		rtd->pte_valid = false;
 		config_acp3x_dma(rtd, SNDRV_PCM_STREAM_CAPTURE);
 		switch (rtd->i2s_instance) {
 		case I2S_BT_INSTANCE:
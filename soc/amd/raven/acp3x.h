@@ -106,6 +106,11 @@ struct i2s_stream_instance {
 	dma_addr_t dma_addr;
 	u64 bytescount;
 	void __iomem *acp3x_base;
+	/* what the ACP SRAM page table currently maps, if pte_valid */
+	bool pte_valid;
+	u32 pte_offset;
+	u16 pte_pages;
+	dma_addr_t pte_addr;
 };
 
 static inline u32 rv_readl(void __iomem *base_addr)
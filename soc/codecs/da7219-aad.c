@@ -345,19 +345,30 @@ static irqreturn_t da7219_aad_irq_thread(int irq, void *data)
 	struct snd_soc_component *component = da7219_aad->component;
 	struct snd_soc_dapm_context *dapm = snd_soc_component_get_dapm(component);
 	struct da7219_priv *da7219 = snd_soc_component_get_drvdata(component);
-	u8 events[DA7219_AAD_IRQ_REG_MAX];
+	u8 accdet[DA7219_ACCDET_IRQ_EVENT_B - DA7219_ACCDET_STATUS_A + 1];
+	u8 *events = &accdet[DA7219_ACCDET_IRQ_EVENT_A - DA7219_ACCDET_STATUS_A];
 	u8 statusa;
 	int i, report = 0, mask = 0;
 
-	/* Read current IRQ events */
-	regmap_bulk_read(da7219->regmap, DA7219_ACCDET_IRQ_EVENT_A,
-			 events, DA7219_AAD_IRQ_REG_MAX);
+	/*
+	 * Read current IRQ events, along with the status registers for jack
+	 * insertion & type status which precede them
+	 */
+	if (regmap_bulk_read(da7219->regmap, DA7219_ACCDET_STATUS_A,
+			     accdet, ARRAY_SIZE(accdet)))
+		return IRQ_NONE;
 
 	if (!events[DA7219_AAD_IRQ_REG_A] && !events[DA7219_AAD_IRQ_REG_B])
 		return IRQ_NONE;
 
-	/* Read status register for jack insertion & type status */
-	statusa = snd_soc_component_read32(component, DA7219_ACCDET_STATUS_A);
+	statusa = accdet[0];
+
+	/* the status may have been read just before an insertion event */
+	if ((events[DA7219_AAD_IRQ_REG_A] & (DA7219_E_JACK_INSERTED_MASK |
+					     DA7219_E_JACK_DETECT_COMPLETE_MASK)) &&
+	    !(statusa & DA7219_JACK_INSERTION_STS_MASK))
+		statusa = snd_soc_component_read32(component,
+						   DA7219_ACCDET_STATUS_A);
 
 	/* Clear events */
 	regmap_bulk_write(da7219->regmap, DA7219_ACCDET_IRQ_EVENT_A,
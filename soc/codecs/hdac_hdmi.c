@@ -14,6 +14,7 @@
 #include <linux/module.h>
 #include <linux/pm_runtime.h>
 #include <linux/hdmi.h>
+#include <linux/jhash.h>
 #include <drm/drm_edid.h>
 #include <dkms/sound/pcm_params.h>
 #include <dkms/sound/jack.h>
@@ -67,6 +68,7 @@ struct hdac_hdmi_eld {
 	bool	monitor_present;
 	bool	eld_valid;
 	int	eld_size;
+	u32	eld_hash;
 	char    eld_buffer[ELD_MAX_SIZE];
 	struct	hdac_hdmi_parsed_eld info;
 };
@@ -1246,8 +1248,10 @@ static void hdac_hdmi_present_sense(struct hdac_hdmi_pin *pin,
 	struct hdac_device *hdev = pin->hdev;
 	struct hdac_hdmi_priv *hdmi = hdev_to_hdmi_priv(hdev);
 	struct hdac_hdmi_pcm *pcm;
+	bool was_connected, changed = true;
 	int size = 0;
 	int port_id = -1;
+	u32 hash = 0;
 
 	if (!hdmi)
 		return;
@@ -1257,6 +1261,7 @@ static void hdac_hdmi_present_sense(struct hdac_hdmi_pin *pin,
 	 * to be -1.
 	 */
 	mutex_lock(&hdmi->pin_mutex);
+	was_connected = port->eld.monitor_present && port->eld.eld_valid;
 	port->eld.monitor_present = false;
 
 	if (pin->mst_capable)
@@ -1269,22 +1274,35 @@ static void hdac_hdmi_present_sense(struct hdac_hdmi_pin *pin,
 
 	if (size > 0) {
 		size = min(size, ELD_MAX_SIZE);
-		if (hdac_hdmi_parse_eld(hdev, port) < 0)
+		hash = jhash(port->eld.eld_buffer, size, 0);
+		changed = !port->eld.eld_valid || size != port->eld.eld_size ||
+			  hash != port->eld.eld_hash;
+
+		/* the parsed info is kept as long as the ELD doesn't change */
+		if (changed && hdac_hdmi_parse_eld(hdev, port) < 0)
 			size = -EINVAL;
 	}
 
 	if (size > 0) {
 		port->eld.eld_valid = true;
 		port->eld.eld_size = size;
+		port->eld.eld_hash = hash;
 	} else {
 		port->eld.eld_valid = false;
 		port->eld.eld_size = 0;
+		port->eld.eld_hash = 0;
 	}
 
 	pcm = hdac_hdmi_get_pcm(hdev, port);
 
 	if (!port->eld.monitor_present || !port->eld.eld_valid) {
 
+		/* already reported, e.g. sensed again at resume */
+		if (!was_connected && !port->is_connect) {
+			mutex_unlock(&hdmi->pin_mutex);
+			return;
+		}
+
 		dev_err(&hdev->dev, "%s: disconnect for pin:port %d:%d\n",
 						__func__, pin->nid, port->id);
 
@@ -1302,16 +1320,24 @@ static void hdac_hdmi_present_sense(struct hdac_hdmi_pin *pin,
 		return;
 	}
 
-	if (port->eld.monitor_present && port->eld.eld_valid) {
-		if (pcm) {
-			hdac_hdmi_jack_report(pcm, port, true);
-			schedule_work(&port->dapm_work);
-		}
-
-		print_hex_dump_debug("ELD: ", DUMP_PREFIX_OFFSET, 16, 1,
-			  port->eld.eld_buffer, port->eld.eld_size, false);
+	/*
+	 * Docks repeat the hotplug notification for the monitors which
+	 * didn't change, don't report them again: that would also bump
+	 * the PCM jack count.
+	 */
+	if (!changed && was_connected && port->is_connect) {
+		mutex_unlock(&hdmi->pin_mutex);
+		return;
+	}
 
+	if (pcm) {
+		hdac_hdmi_jack_report(pcm, port, true);
+		schedule_work(&port->dapm_work);
 	}
+
+	print_hex_dump_debug("ELD: ", DUMP_PREFIX_OFFSET, 16, 1,
+		  port->eld.eld_buffer, port->eld.eld_size, false);
+
 	mutex_unlock(&hdmi->pin_mutex);
 }
 
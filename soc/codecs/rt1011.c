@@ -2290,9 +2290,13 @@ static int rt1011_calibrate(struct rt1011_priv *rt1011, unsigned char cali_flag)
 		}
 	}
 
-	/* depop */
+	/*
+	 * depop: only needed when class D was driven for the R0 measurement,
+	 * the EFUSE-only pass used with DP calibration data never enables it.
+	 */
 	regmap_write(rt1011->regmap, RT1011_SPK_TEMP_PROTECT_0, 0x0000);
-	msleep(400);
+	if (cali_flag)
+		msleep(400);
 	regmap_write(rt1011->regmap, RT1011_POWER_9, 0xa840);
 	regmap_write(rt1011->regmap, RT1011_SPK_TEMP_PROTECT_6, 0x0702);
 	regmap_write(rt1011->regmap, RT1011_MIXER_1, 0xffdd);
@@ -23,6 +23,9 @@
 #include <linux/clk.h>
 #include <linux/firmware.h>
 #include <linux/acpi.h>
+#include <linux/swab.h>
+
+#include <asm/unaligned.h>
 
 #include <sound/soc.h>
 
@@ -55,8 +58,14 @@
 					sizeof(u32)))
 #define RT5677_MIC_BUF_FIRST_READ_SIZE	0x10000
 
+/* Holds the read header, or the write header, body and DummyPhase */
+#define RT5677_SPI_TX_BUF_LEN	(RT5677_SPI_HEADER + RT5677_SPI_BURST_LEN + 1)
+
 static struct spi_device *g_spi;
 static DEFINE_MUTEX(spi_mutex);
+/* DMA-safe transfer buffers, unlike the stack, protected by spi_mutex */
+static u8 *g_spi_tx_buf;
+static u8 *g_spi_rx_buf;
 
 struct rt5677_dsp {
 	struct device *dev;
@@ -455,10 +464,17 @@ static u8 rt5677_spi_select_cmd(bool read, u32 align, u32 remain, u32 *len)
  */
 static void rt5677_spi_reverse(u8 *dst, u32 dstlen, const u8 *src, u32 srclen)
 {
-	u32 w, i, si;
+	u32 w = 0, i, si;
 	u32 word_size = min_t(u32, dstlen, 8);
 
-	for (w = 0; w < dstlen; w += word_size) {
+	/* whole burst words are byte-swapped at once */
+	if (word_size == 8) {
+		for (; w + 8 <= dstlen && w + 8 <= srclen; w += 8)
+			put_unaligned(swab64(get_unaligned((u64 *)(src + w))),
+				      (u64 *)(dst + w));
+	}
+
+	for (; w < dstlen; w += word_size) {
 		for (i = 0; i < word_size && i + w < dstlen; i++) {
 			si = w + word_size - i - 1;
 			dst[w + i] = si < srclen ? src[si] : 0;
@@ -474,14 +490,17 @@ int rt5677_spi_read(u32 addr, void *rxbuf, size_t len)
 	struct spi_transfer t[2];
 	struct spi_message m;
 	/* +4 bytes is for the DummyPhase following the AddressPhase */
-	u8 header[RT5677_SPI_HEADER + 4];
-	u8 body[RT5677_SPI_BURST_LEN];
+	const size_t header_len = RT5677_SPI_HEADER + 4;
+	u8 *header, *body;
 	u8 spi_cmd;
 	u8 *cb = rxbuf;
 
 	if (!g_spi)
 		return -ENODEV;
 
+	header = g_spi_tx_buf;
+	body = g_spi_rx_buf;
+
 	if ((addr & 3) || (len & 3)) {
 		dev_err(&g_spi->dev, "Bad read align 0x%x(%zu)\n", addr, len);
 		return -EACCES;
@@ -489,7 +508,7 @@ int rt5677_spi_read(u32 addr, void *rxbuf, size_t len)
 
 	memset(t, 0, sizeof(t));
 	t[0].tx_buf = header;
-	t[0].len = sizeof(header);
+	t[0].len = header_len;
 	t[0].speed_hz = RT5677_SPI_FREQ;
 	t[1].rx_buf = body;
 	t[1].speed_hz = RT5677_SPI_FREQ;
@@ -499,6 +518,8 @@ int rt5677_spi_read(u32 addr, void *rxbuf, size_t len)
 		spi_cmd = rt5677_spi_select_cmd(true, (addr + offset) & 7,
 				len - offset, &t[1].len);
 
+		mutex_lock(&spi_mutex);
+
 		/* Construct SPI message header */
 		header[0] = spi_cmd;
 		header[1] = ((addr + offset) & 0xff000000) >> 24;
@@ -506,13 +527,17 @@ int rt5677_spi_read(u32 addr, void *rxbuf, size_t len)
 		header[3] = ((addr + offset) & 0x0000ff00) >> 8;
 		header[4] = ((addr + offset) & 0x000000ff) >> 0;
 
-		mutex_lock(&spi_mutex);
 		status |= spi_sync(g_spi, &m);
-		mutex_unlock(&spi_mutex);
 
+		/*
+		 * Copy data back to caller buffer, only this command's words:
+		 * the following ones are filled by the next commands
+		 */
+		rt5677_spi_reverse(cb + offset,
+				   min_t(size_t, len - offset, t[1].len),
+				   body, t[1].len);
 
-		/* Copy data back to caller buffer */
-		rt5677_spi_reverse(cb + offset, len - offset, body, t[1].len);
+		mutex_unlock(&spi_mutex);
 	}
 	return status;
 }
@@ -529,14 +554,16 @@ int rt5677_spi_write(u32 addr, const void *txbuf, size_t len)
 	struct spi_transfer t;
 	struct spi_message m;
 	/* +1 byte is for the DummyPhase following the DataPhase */
-	u8 buf[RT5677_SPI_HEADER + RT5677_SPI_BURST_LEN + 1];
-	u8 *body = buf + RT5677_SPI_HEADER;
+	u8 *buf, *body;
 	u8 spi_cmd;
 	const u8 *cb = txbuf;
 
 	if (!g_spi)
 		return -ENODEV;
 
+	buf = g_spi_tx_buf;
+	body = buf + RT5677_SPI_HEADER;
+
 	if (addr & 3) {
 		dev_err(&g_spi->dev, "Bad write align 0x%x(%zu)\n", addr, len);
 		return -EACCES;
@@ -551,6 +578,8 @@ int rt5677_spi_write(u32 addr, const void *txbuf, size_t len)
 		spi_cmd = rt5677_spi_select_cmd(false, (addr + offset) & 7,
 				len - offset, &t.len);
 
+		mutex_lock(&spi_mutex);
+
 		/* Construct SPI message header */
 		buf[0] = spi_cmd;
 		buf[1] = ((addr + offset) & 0xff000000) >> 24;
@@ -563,7 +592,6 @@ int rt5677_spi_write(u32 addr, const void *txbuf, size_t len)
 		offset += t.len;
 		t.len += RT5677_SPI_HEADER + 1;
 
-		mutex_lock(&spi_mutex);
 		status |= spi_sync(g_spi, &m);
 		mutex_unlock(&spi_mutex);
 	}
@@ -603,6 +631,13 @@ static int rt5677_spi_probe(struct spi_device *spi)
 {
 	int ret;
 
+	g_spi_tx_buf = devm_kmalloc(&spi->dev, RT5677_SPI_TX_BUF_LEN,
+				    GFP_KERNEL);
+	g_spi_rx_buf = devm_kmalloc(&spi->dev, RT5677_SPI_BURST_LEN,
+				    GFP_KERNEL);
+	if (!g_spi_tx_buf || !g_spi_rx_buf)
+		return -ENOMEM;
+
 	g_spi = spi;
 
 	ret = snd_soc_register_component(&spi->dev, &rt5677_spi_dai_component,
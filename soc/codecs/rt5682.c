@@ -977,9 +977,10 @@ static int rt5682_headset_detect(struct snd_soc_component *component,
 static irqreturn_t rt5682_irq(int irq, void *data)
 {
 	struct rt5682_priv *rt5682 = data;
+	unsigned int delay = rt5682->pdata.jd_irq_only ? 0 : 250;
 
 	mod_delayed_work(system_power_efficient_wq,
-			&rt5682->jack_detect_work, msecs_to_jiffies(250));
+			&rt5682->jack_detect_work, msecs_to_jiffies(delay));
 
 	return IRQ_HANDLED;
 }
@@ -1152,7 +1153,11 @@ static void rt5682_jack_detect_handler(struct work_struct *work)
 			    SND_JACK_BTN_0 | SND_JACK_BTN_1 |
 			    SND_JACK_BTN_2 | SND_JACK_BTN_3);
 
-	if (!rt5682->is_sdw) {
+	/*
+	 * Unless the board guarantees a JD1 IRQ on removal, poll for it
+	 * while a button is held
+	 */
+	if (!rt5682->is_sdw && !rt5682->pdata.jd_irq_only) {
 		if (rt5682->jack_type & (SND_JACK_BTN_0 | SND_JACK_BTN_1 |
 			SND_JACK_BTN_2 | SND_JACK_BTN_3))
 			schedule_delayed_work(&rt5682->jd_check_work, 0);
@@ -3242,6 +3247,8 @@ static int rt5682_parse_dt(struct rt5682_priv *rt5682, struct device *dev)
 		&rt5682->pdata.jd_src);
 	device_property_read_u32(dev, "realtek,btndet-delay",
 		&rt5682->pdata.btndet_delay);
+	rt5682->pdata.jd_irq_only = device_property_read_bool(dev,
+		"realtek,jd-irq-only");
 	device_property_read_u32(dev, "realtek,dmic-clk-rate-hz",
 		&rt5682->pdata.dmic_clk_rate);
 	device_property_read_u32(dev, "realtek,dmic-delay-ms",
@@ -3313,17 +3320,30 @@ static void rt5682_calibrate(struct rt5682_priv *rt5682)
 }
 
 #if IS_ENABLED(CONFIG_SND_SOC_RT5682_SDW)
+/*
+ * Each indirect access takes five SDW commands, send them as one batch
+ * rather than one regmap access at a time
+ */
 static int rt5682_sdw_read(void *context, unsigned int reg, unsigned int *val)
 {
 	struct device *dev = context;
 	struct rt5682_priv *rt5682 = dev_get_drvdata(dev);
-	unsigned int data_l, data_h;
+	u8 cmd = 0, addr_h = (reg >> 8) & 0xff, addr_l = reg & 0xff;
+	u8 data_h, data_l;
+	struct sdw_slave_xfer xfers[] = {
+		{ .addr = RT5682_SDW_CMD, .count = 1, .buf = &cmd },
+		{ .addr = RT5682_SDW_ADDR_H, .count = 1, .buf = &addr_h },
+		{ .addr = RT5682_SDW_ADDR_L, .count = 1, .buf = &addr_l },
+		{ .addr = RT5682_SDW_DATA_H, .count = 1, .buf = &data_h,
+		  .read = true },
+		{ .addr = RT5682_SDW_DATA_L, .count = 1, .buf = &data_l,
+		  .read = true },
+	};
+	int ret;
 
-	regmap_write(rt5682->sdw_regmap, RT5682_SDW_CMD, 0);
-	regmap_write(rt5682->sdw_regmap, RT5682_SDW_ADDR_H, (reg >> 8) & 0xff);
-	regmap_write(rt5682->sdw_regmap, RT5682_SDW_ADDR_L, (reg & 0xff));
-	regmap_read(rt5682->sdw_regmap, RT5682_SDW_DATA_H, &data_h);
-	regmap_read(rt5682->sdw_regmap, RT5682_SDW_DATA_L, &data_l);
+	ret = sdw_xfer_batch(rt5682->slave, xfers, ARRAY_SIZE(xfers));
+	if (ret < 0)
+		return ret;
 
 	*val = (data_h << 8) | data_l;
 
@@ -3336,12 +3356,20 @@ static int rt5682_sdw_write(void *context, unsigned int reg, unsigned int val)
 {
 	struct device *dev = context;
 	struct rt5682_priv *rt5682 = dev_get_drvdata(dev);
+	u8 cmd = 1, addr_h = (reg >> 8) & 0xff, addr_l = reg & 0xff;
+	u8 data_h = (val >> 8) & 0xff, data_l = val & 0xff;
+	struct sdw_slave_xfer xfers[] = {
+		{ .addr = RT5682_SDW_CMD, .count = 1, .buf = &cmd },
+		{ .addr = RT5682_SDW_ADDR_H, .count = 1, .buf = &addr_h },
+		{ .addr = RT5682_SDW_ADDR_L, .count = 1, .buf = &addr_l },
+		{ .addr = RT5682_SDW_DATA_H, .count = 1, .buf = &data_h },
+		{ .addr = RT5682_SDW_DATA_L, .count = 1, .buf = &data_l },
+	};
+	int ret;
 
-	regmap_write(rt5682->sdw_regmap, RT5682_SDW_CMD, 1);
-	regmap_write(rt5682->sdw_regmap, RT5682_SDW_ADDR_H, (reg >> 8) & 0xff);
-	regmap_write(rt5682->sdw_regmap, RT5682_SDW_ADDR_L, (reg & 0xff));
-	regmap_write(rt5682->sdw_regmap, RT5682_SDW_DATA_H, (val >> 8) & 0xff);
-	regmap_write(rt5682->sdw_regmap, RT5682_SDW_DATA_L, (val & 0xff));
+	ret = sdw_xfer_batch(rt5682->slave, xfers, ARRAY_SIZE(xfers));
+	if (ret < 0)
+		return ret;
 
 	dev_vdbg(dev, "[%s] %04x <= %04x\n", __func__, reg, val);
 
@@ -13,6 +13,7 @@
 #include <dkms/linux/soundwire/sdw_type.h>
 #include <linux/module.h>
 #include <linux/regmap.h>
+#include <dkms/linux/regmap-sdw-mbq.h>
 #include <dkms/sound/soc.h>
 #include "rt700.h"
 #include "rt700-sdw.h"
@@ -80,13 +81,22 @@ static bool rt700_volatile_register(struct device *dev, unsigned int reg)
 	}
 }
 
+static unsigned int rt700_mbq_lsb_reg(unsigned int reg)
+{
+	return (reg + 0x1000) | 0x80;
+}
+
+static const struct regmap_sdw_mbq_cfg rt700_mbq_cfg = {
+	.lsb_reg = rt700_mbq_lsb_reg,
+};
+
 static int rt700_sdw_read(void *context, unsigned int reg, unsigned int *val)
 {
 	struct device *dev = context;
 	struct rt700_priv *rt700 = dev_get_drvdata(dev);
-	unsigned int sdw_data_3, sdw_data_2, sdw_data_1, sdw_data_0;
-	unsigned int reg2 = 0, reg3 = 0, reg4 = 0, mask, nid, val2;
+	unsigned int reg2 = 0, reg3 = 0, mask, nid, val2;
 	unsigned int is_hda_reg = 1, is_index_reg = 0;
+	u8 hda_data[4];
 	int ret;
 
 	if (reg > 0xffff)
@@ -98,23 +108,12 @@ static int rt700_sdw_read(void *context, unsigned int reg, unsigned int *val)
 		val2 = reg & 0xff;
 		reg = reg >> 8;
 		nid = reg & 0xff;
-		ret = regmap_write(rt700->sdw_regmap, reg, 0);
-		if (ret < 0)
-			return ret;
-		reg2 = reg + 0x1000;
-		reg2 |= 0x80;
-		ret = regmap_write(rt700->sdw_regmap, reg2, val2);
+		ret = regmap_write(rt700->mbq_regmap, reg, val2);
 		if (ret < 0)
 			return ret;
 
 		reg3 = RT700_PRIV_DATA_R_H | nid;
-		ret = regmap_write(rt700->sdw_regmap,
-			reg3, ((*val >> 8) & 0xff));
-		if (ret < 0)
-			return ret;
-		reg4 = reg3 + 0x1000;
-		reg4 |= 0x80;
-		ret = regmap_write(rt700->sdw_regmap, reg4, (*val & 0xff));
+		ret = regmap_write(rt700->mbq_regmap, reg3, (*val & 0xffff));
 		if (ret < 0)
 			return ret;
 	} else if (mask   == 0x3000) {
@@ -125,33 +124,17 @@ static int rt700_sdw_read(void *context, unsigned int reg, unsigned int *val)
 	} else if (mask == 0x7000) {
 		reg += 0x2000;
 		reg |= 0x800;
-		ret = regmap_write(rt700->sdw_regmap,
-			reg, ((*val >> 8) & 0xff));
-		if (ret < 0)
-			return ret;
-		reg2 = reg + 0x1000;
-		reg2 |= 0x80;
-		ret = regmap_write(rt700->sdw_regmap, reg2, (*val & 0xff));
+		ret = regmap_write(rt700->mbq_regmap, reg, (*val & 0xffff));
 		if (ret < 0)
 			return ret;
 	} else if ((reg & 0xff00) == 0x8300) { /* for R channel */
 		reg2 = reg - 0x1000;
 		reg2 &= ~0x80;
-		ret = regmap_write(rt700->sdw_regmap,
-			reg2, ((*val >> 8) & 0xff));
-		if (ret < 0)
-			return ret;
-		ret = regmap_write(rt700->sdw_regmap, reg, (*val & 0xff));
+		ret = regmap_write(rt700->mbq_regmap, reg2, (*val & 0xffff));
 		if (ret < 0)
 			return ret;
 	} else if (mask == 0x9000) {
-		ret = regmap_write(rt700->sdw_regmap,
-			reg, ((*val >> 8) & 0xff));
-		if (ret < 0)
-			return ret;
-		reg2 = reg + 0x1000;
-		reg2 |= 0x80;
-		ret = regmap_write(rt700->sdw_regmap, reg2, (*val & 0xff));
+		ret = regmap_write(rt700->mbq_regmap, reg, (*val & 0xffff));
 		if (ret < 0)
 			return ret;
 	} else if (mask == 0xb000) {
@@ -166,36 +149,20 @@ static int rt700_sdw_read(void *context, unsigned int reg, unsigned int *val)
 	}
 
 	if (is_hda_reg || is_index_reg) {
-		sdw_data_3 = 0;
-		sdw_data_2 = 0;
-		sdw_data_1 = 0;
-		sdw_data_0 = 0;
-		ret = regmap_read(rt700->sdw_regmap,
-			RT700_READ_HDA_3, &sdw_data_3);
-		if (ret < 0)
-			return ret;
-		ret = regmap_read(rt700->sdw_regmap,
-			RT700_READ_HDA_2, &sdw_data_2);
+		/* RT700_READ_HDA_3 to RT700_READ_HDA_0 are contiguous */
+		ret = regmap_bulk_read(rt700->sdw_regmap, RT700_READ_HDA_3,
+				       hda_data, ARRAY_SIZE(hda_data));
 		if (ret < 0)
 			return ret;
-		ret = regmap_read(rt700->sdw_regmap,
-			RT700_READ_HDA_1, &sdw_data_1);
-		if (ret < 0)
-			return ret;
-		ret = regmap_read(rt700->sdw_regmap,
-			RT700_READ_HDA_0, &sdw_data_0);
-		if (ret < 0)
-			return ret;
-		*val = ((sdw_data_3 & 0xff) << 24) |
-			((sdw_data_2 & 0xff) << 16) |
-			((sdw_data_1 & 0xff) << 8) | (sdw_data_0 & 0xff);
+		*val = (hda_data[0] << 24) | (hda_data[1] << 16) |
+			(hda_data[2] << 8) | hda_data[3];
 	}
 
 	if (is_hda_reg == 0)
 		dev_dbg(dev, "[%s] %04x => %08x\n", __func__, reg, *val);
 	else if (is_index_reg)
-		dev_dbg(dev, "[%s] %04x %04x %04x %04x => %08x\n",
-			__func__, reg, reg2, reg3, reg4, *val);
+		dev_dbg(dev, "[%s] %04x %04x => %08x\n",
+			__func__, reg, reg3, *val);
 	else
 		dev_dbg(dev, "[%s] %04x %04x => %08x\n",
 			__func__, reg, reg2, *val);
@@ -207,7 +174,7 @@ static int rt700_sdw_write(void *context, unsigned int reg, unsigned int val)
 {
 	struct device *dev = context;
 	struct rt700_priv *rt700 = dev_get_drvdata(dev);
-	unsigned int reg2 = 0, reg3, reg4, nid, mask, val2;
+	unsigned int reg2 = 0, reg3, nid, mask, val2;
 	unsigned int is_index_reg = 0;
 	int ret;
 
@@ -220,26 +187,14 @@ static int rt700_sdw_write(void *context, unsigned int reg, unsigned int val)
 		val2 = reg & 0xff;
 		reg = reg >> 8;
 		nid = reg & 0xff;
-		ret = regmap_write(rt700->sdw_regmap, reg, 0);
-		if (ret < 0)
-			return ret;
-		reg2 = reg + 0x1000;
-		reg2 |= 0x80;
-		ret = regmap_write(rt700->sdw_regmap, reg2, val2);
+		ret = regmap_write(rt700->mbq_regmap, reg, val2);
 		if (ret < 0)
 			return ret;
 
 		reg3 = RT700_PRIV_DATA_W_H | nid;
-		ret = regmap_write(rt700->sdw_regmap,
-			reg3, ((val >> 8) & 0xff));
-		if (ret < 0)
-			return ret;
-		reg4 = reg3 + 0x1000;
-		reg4 |= 0x80;
-		ret = regmap_write(rt700->sdw_regmap, reg4, (val & 0xff));
+		ret = regmap_write(rt700->mbq_regmap, reg3, (val & 0xffff));
 		if (ret < 0)
 			return ret;
-		is_index_reg = 1;
 	} else if (reg < 0x4fff) {
 		ret = regmap_write(rt700->sdw_regmap, reg, val);
 		if (ret < 0)
@@ -249,35 +204,25 @@ static int rt700_sdw_write(void *context, unsigned int reg, unsigned int val)
 		if (ret < 0)
 			return ret;
 	} else if (mask == 0x7000) {
-		ret = regmap_write(rt700->sdw_regmap,
-			reg, ((val >> 8) & 0xff));
-		if (ret < 0)
-			return ret;
-		reg2 = reg + 0x1000;
-		reg2 |= 0x80;
-		ret = regmap_write(rt700->sdw_regmap, reg2, (val & 0xff));
+		ret = regmap_write(rt700->mbq_regmap, reg, (val & 0xffff));
 		if (ret < 0)
 			return ret;
 	} else if ((reg & 0xff00) == 0x8300) {  /* for R channel */
 		reg2 = reg - 0x1000;
 		reg2 &= ~0x80;
-		ret = regmap_write(rt700->sdw_regmap,
-			reg2, ((val >> 8) & 0xff));
-		if (ret < 0)
-			return ret;
-		ret = regmap_write(rt700->sdw_regmap, reg, (val & 0xff));
+		ret = regmap_write(rt700->mbq_regmap, reg2, (val & 0xffff));
 		if (ret < 0)
 			return ret;
 	}
 
-	if (reg2 == 0)
-		dev_dbg(dev, "[%s] %04x <= %04x\n", __func__, reg, val);
-	else if (is_index_reg)
-		dev_dbg(dev, "[%s] %04x %04x %04x %04x <= %04x %04x\n",
-			__func__, reg, reg2, reg3, reg4, val2, val);
-	else
+	if (is_index_reg)
+		dev_dbg(dev, "[%s] %04x %04x <= %04x %04x\n",
+			__func__, reg, reg3, val2, val);
+	else if (reg2)
 		dev_dbg(dev, "[%s] %04x %04x <= %04x\n",
-			__func__, reg, reg2, val);
+			__func__, reg2, reg, val);
+	else
+		dev_dbg(dev, "[%s] %04x <= %04x\n", __func__, reg, val);
 
 	return 0;
 }
@@ -304,10 +249,17 @@ static const struct regmap_config rt700_sdw_regmap = {
 	.readable_reg = rt700_readable_register,
 	.max_register = 0xff01,
 	.cache_type = REGCACHE_NONE,
-	.use_single_read = true,
 	.use_single_write = true,
 };
 
+static const struct regmap_config rt700_mbq_regmap = {
+	.name = "sdw-mbq",
+	.reg_bits = 32,
+	.val_bits = 16,
+	.max_register = 0xff01,
+	.cache_type = REGCACHE_NONE,
+};
+
 static int rt700_update_status(struct sdw_slave *slave,
 					enum sdw_slave_status status)
 {
@@ -448,7 +400,7 @@ static struct sdw_slave_ops rt700_slave_ops = {
 static int rt700_sdw_probe(struct sdw_slave *slave,
 				const struct sdw_device_id *id)
 {
-	struct regmap *sdw_regmap, *regmap;
+	struct regmap *sdw_regmap, *mbq_regmap, *regmap;
 
 	/* Assign ops */
 	slave->ops = &rt700_slave_ops;
@@ -458,12 +410,17 @@ static int rt700_sdw_probe(struct sdw_slave *slave,
 	if (!sdw_regmap)
 		return -EINVAL;
 
+	mbq_regmap = devm_regmap_init_sdw_mbq(slave, &rt700_mbq_regmap,
+					      &rt700_mbq_cfg);
+	if (IS_ERR(mbq_regmap))
+		return PTR_ERR(mbq_regmap);
+
 	regmap = devm_regmap_init(&slave->dev, NULL,
 		&slave->dev, &rt700_regmap);
 	if (IS_ERR(regmap))
 		return PTR_ERR(regmap);
 
-	rt700_init(&slave->dev, sdw_regmap, regmap, slave);
+	rt700_init(&slave->dev, sdw_regmap, mbq_regmap, regmap, slave);
 
 	return 0;
 }
@@ -220,31 +220,28 @@ static void rt700_btn_check_handler(struct work_struct *work)
 	struct rt700_priv *rt700 = container_of(work, struct rt700_priv,
 		jack_btn_check_work.work);
 	int btn_type = 0, ret;
-	unsigned int jack_status = 0, reg;
+	unsigned int jack_status = 0, reg, cbj;
 
 	reg = RT700_VERB_GET_PIN_SENSE | RT700_HP_OUT;
 	ret = regmap_read(rt700->regmap, reg, &jack_status);
 	if (ret < 0)
 		goto io_error;
 
+	/* cbj comparator, all set once the button has been released */
+	ret = rt700_index_read(rt700->regmap, RT700_COMBO_JACK_AUTO_CTL2, &cbj);
+	if (ret < 0)
+		goto io_error;
+
 	/* pin attached */
 	if (jack_status & (1 << 31)) {
-		if (rt700->jack_type == SND_JACK_HEADSET) {
-			/* jack is already in, report button event */
+		/* jack is already in, report button event */
+		if (rt700->jack_type == SND_JACK_HEADSET &&
+		    (cbj & 0xf0) != 0xf0)
 			btn_type = rt700_button_detect(rt700);
-		}
 	} else {
 		rt700->jack_type = 0;
 	}
 
-	/* cbj comparator */
-	ret = rt700_index_read(rt700->regmap, RT700_COMBO_JACK_AUTO_CTL2, &reg);
-	if (ret < 0)
-		goto io_error;
-
-	if ((reg & 0xf0) == 0xf0)
-		btn_type = 0;
-
 	dev_dbg(&rt700->slave->dev,
 		"%s, btn_type=0x%x\n",	__func__, btn_type);
 	snd_soc_jack_report(rt700->hs_jack, rt700->jack_type | btn_type,
@@ -1094,7 +1091,8 @@ int rt700_clock_config(struct device *dev)
 }
 
 int rt700_init(struct device *dev, struct regmap *sdw_regmap,
-			struct regmap *regmap, struct sdw_slave *slave)
+			struct regmap *mbq_regmap, struct regmap *regmap,
+			struct sdw_slave *slave)
 
 {
 	struct rt700_priv *rt700;
@@ -1107,6 +1105,7 @@ int rt700_init(struct device *dev, struct regmap *sdw_regmap,
 	dev_set_drvdata(dev, rt700);
 	rt700->slave = slave;
 	rt700->sdw_regmap = sdw_regmap;
+	rt700->mbq_regmap = mbq_regmap;
 	rt700->regmap = regmap;
 
 	/*
@@ -14,6 +14,7 @@ struct  rt700_priv {
 	struct snd_soc_component *component;
 	struct regmap *regmap;
 	struct regmap *sdw_regmap;
+	struct regmap *mbq_regmap;
 	struct sdw_slave *slave;
 	enum sdw_slave_status status;
 	struct sdw_bus_params params;
@@ -167,7 +168,8 @@ enum {
 
 int rt700_io_init(struct device *dev, struct sdw_slave *slave);
 int rt700_init(struct device *dev, struct regmap *sdw_regmap,
-	       struct regmap *regmap, struct sdw_slave *slave);
+	       struct regmap *mbq_regmap, struct regmap *regmap,
+	       struct sdw_slave *slave);
 
 int rt700_jack_detect(struct rt700_priv *rt700, bool *hp, bool *mic);
 int rt700_clock_config(struct device *dev);
@@ -70,6 +70,10 @@ static int rt711_index_update_bits(struct regmap *regmap, unsigned int nid,
 	tmp = orig & ~mask;
 	tmp |= val & mask;
 
+	/* each index access takes several bus transactions, avoid no-ops */
+	if (tmp == orig)
+		return 0;
+
 	return rt711_index_write(regmap, nid, reg, tmp);
 }
 
@@ -300,32 +304,29 @@ static void rt711_btn_check_handler(struct work_struct *work)
 	struct rt711_priv *rt711 = container_of(work, struct rt711_priv,
 		jack_btn_check_work.work);
 	int btn_type = 0, ret;
-	unsigned int jack_status = 0, reg;
+	unsigned int jack_status = 0, reg, cbj;
 
 	reg = RT711_VERB_GET_PIN_SENSE | RT711_HP_OUT;
 	ret = regmap_read(rt711->regmap, reg, &jack_status);
 	if (ret < 0)
 		goto io_error;
 
+	/* cbj comparator, all set once the button has been released */
+	ret = rt711_index_read(rt711->regmap, RT711_VENDOR_REG,
+		RT711_COMBO_JACK_AUTO_CTL2, &cbj);
+	if (ret < 0)
+		goto io_error;
+
 	/* pin attached */
 	if (jack_status & (1 << 31)) {
-		if (rt711->jack_type == SND_JACK_HEADSET) {
-			/* jack is already in, report button event */
+		/* jack is already in, report button event */
+		if (rt711->jack_type == SND_JACK_HEADSET &&
+		    (cbj & 0xf0) != 0xf0)
 			btn_type = rt711_button_detect(rt711);
-		}
 	} else {
 		rt711->jack_type = 0;
 	}
 
-	/* cbj comparator */
-	ret = rt711_index_read(rt711->regmap, RT711_VENDOR_REG,
-		RT711_COMBO_JACK_AUTO_CTL2, &reg);
-	if (ret < 0)
-		goto io_error;
-
-	if ((reg & 0xf0) == 0xf0)
-		btn_type = 0;
-
 	dev_dbg(&rt711->slave->dev,
 		"%s, btn_type=0x%x\n",	__func__, btn_type);
 	snd_soc_jack_report(rt711->hs_jack, rt711->jack_type | btn_type,
@@ -1135,7 +1136,8 @@ static void rt711_calibration_work(struct work_struct *work)
 }
 
 int rt711_init(struct device *dev, struct regmap *sdw_regmap,
-			struct regmap *regmap, struct sdw_slave *slave)
+			struct regmap *mbq_regmap, struct regmap *regmap,
+			struct sdw_slave *slave)
 {
 	struct rt711_priv *rt711;
 	int ret;
@@ -1147,6 +1149,7 @@ int rt711_init(struct device *dev, struct regmap *sdw_regmap,
 	dev_set_drvdata(dev, rt711);
 	rt711->slave = slave;
 	rt711->sdw_regmap = sdw_regmap;
+	rt711->mbq_regmap = mbq_regmap;
 	rt711->regmap = regmap;
 
 	/*
@@ -1252,18 +1255,21 @@ int rt711_io_init(struct device *dev, struct sdw_slave *slave)
 	/* Finish Initial Settings, set power to D3 */
 	regmap_write(rt711->regmap, RT711_SET_AUDIO_POWER_STATE, AC_PWRST_D3);
 
-	if (rt711->first_hw_init)
-		rt711_calibration(rt711);
-	else {
+	if (!rt711->first_hw_init) {
 		INIT_DELAYED_WORK(&rt711->jack_detect_work,
 			rt711_jack_detect_handler);
 		INIT_DELAYED_WORK(&rt711->jack_btn_check_work,
 			rt711_btn_check_handler);
 		mutex_init(&rt711->calibrate_mutex);
 		INIT_WORK(&rt711->calibration_work, rt711_calibration_work);
-		schedule_work(&rt711->calibration_work);
 	}
 
+	/*
+	 * The calibration polls the codec for up to several seconds, don't
+	 * hold up the bus and the other Slaves' initialization meanwhile.
+	 */
+	schedule_work(&rt711->calibration_work);
+
 	/*
 	 * if set_jack callback occurred early than io_init,
 	 * we set up the jack detection function now
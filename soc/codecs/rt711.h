@@ -13,6 +13,7 @@ extern const struct dev_pm_ops rt711_runtime_pm;
 struct  rt711_priv {
 	struct regmap *regmap;
 	struct regmap *sdw_regmap;
+	struct regmap *mbq_regmap;
 	struct snd_soc_component *component;
 	struct sdw_slave *slave;
 	enum sdw_slave_status status;
@@ -220,7 +221,8 @@ enum rt711_jd_src {
 
 int rt711_io_init(struct device *dev, struct sdw_slave *slave);
 int rt711_init(struct device *dev, struct regmap *sdw_regmap,
-	       struct regmap *regmap, struct sdw_slave *slave);
+	       struct regmap *mbq_regmap, struct regmap *regmap,
+	       struct sdw_slave *slave);
 
 int rt711_jack_detect(struct rt711_priv *rt711, bool *hp, bool *mic);
 int rt711_clock_config(struct device *dev);
@@ -759,7 +759,8 @@ int rt715_clock_config(struct device *dev)
 }
 
 int rt715_init(struct device *dev, struct regmap *sdw_regmap,
-	struct regmap *regmap, struct sdw_slave *slave)
+	struct regmap *mbq_regmap, struct regmap *regmap,
+	struct sdw_slave *slave)
 {
 	struct rt715_priv *rt715;
 	int ret;
@@ -772,6 +773,7 @@ int rt715_init(struct device *dev, struct regmap *sdw_regmap,
 	rt715->slave = slave;
 	rt715->regmap = regmap;
 	rt715->sdw_regmap = sdw_regmap;
+	rt715->mbq_regmap = mbq_regmap;
 
 	/*
 	 * Mark hw_init to false
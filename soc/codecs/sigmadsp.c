@@ -626,6 +626,68 @@ static bool sigmadsp_samplerate_valid(unsigned int supported,
 	return supported & requested;
 }
 
+static bool sigmadsp_data_active(const struct sigmadsp_data *data,
+	unsigned int samplerate_mask)
+{
+	return samplerate_mask &&
+		sigmadsp_samplerate_valid(data->samplerates, samplerate_mask);
+}
+
+/*
+ * The length is in bytes and a DSP word is at least one byte, so this may
+ * report chunks that are merely adjacent as overlapping, but never misses
+ * a real overlap.
+ */
+static bool sigmadsp_data_overlap(const struct sigmadsp_data *a,
+	const struct sigmadsp_data *b)
+{
+	return a->addr < b->addr + b->length && b->addr < a->addr + a->length;
+}
+
+/*
+ * Checks whether @data, which is about to be loaded for @new_mask, already is
+ * in the DSP memory after the program for @old_mask was loaded. That is the
+ * case if it was loaded for the old rate as well, or if the old rate used a
+ * chunk with the same contents at the same address, and if no other chunk of
+ * either rate overlaps it.
+ */
+static bool sigmadsp_data_loaded(struct sigmadsp *sigmadsp,
+	struct sigmadsp_data *data, unsigned int old_mask,
+	unsigned int new_mask)
+{
+	struct sigmadsp_data *old = NULL;
+	struct sigmadsp_data *tmp;
+
+	if (sigmadsp_data_active(data, old_mask)) {
+		old = data;
+	} else {
+		list_for_each_entry(tmp, &sigmadsp->data_list, head) {
+			if (sigmadsp_data_active(tmp, old_mask) &&
+			    tmp->addr == data->addr &&
+			    tmp->length == data->length &&
+			    !memcmp(tmp->data, data->data, data->length)) {
+				old = tmp;
+				break;
+			}
+		}
+
+		if (!old)
+			return false;
+	}
+
+	list_for_each_entry(tmp, &sigmadsp->data_list, head) {
+		if (tmp == data || tmp == old)
+			continue;
+		if (!sigmadsp_data_active(tmp, old_mask) &&
+		    !sigmadsp_data_active(tmp, new_mask))
+			continue;
+		if (sigmadsp_data_overlap(tmp, data))
+			return false;
+	}
+
+	return true;
+}
+
 static int sigmadsp_alloc_control(struct sigmadsp *sigmadsp,
 	struct sigmadsp_control *ctrl, unsigned int samplerate_mask)
 {
@@ -731,12 +793,17 @@ EXPORT_SYMBOL_GPL(sigmadsp_attach);
  * loaded) and enables the controls for the specified samplerate. Any control
  * parameter changes that have been made previously will be restored.
  *
+ * When switching from another samplerate without a reset in between, only
+ * the chunks that differ from what was loaded for the previous samplerate
+ * are written.
+ *
  * Returns 0 on success, a negative error code otherwise.
  */
 int sigmadsp_setup(struct sigmadsp *sigmadsp, unsigned int samplerate)
 {
 	struct sigmadsp_control *ctrl;
 	unsigned int samplerate_mask;
+	unsigned int old_mask;
 	struct sigmadsp_data *data;
 	int ret;
 
@@ -747,10 +814,17 @@ int sigmadsp_setup(struct sigmadsp *sigmadsp, unsigned int samplerate)
 	if (samplerate_mask == 0)
 		return -EINVAL;
 
+	/* 0 after a reset, the whole program has to be loaded then */
+	old_mask = sigmadsp_get_samplerate_mask(sigmadsp,
+		sigmadsp->current_samplerate);
+
 	list_for_each_entry(data, &sigmadsp->data_list, head) {
 		if (!sigmadsp_samplerate_valid(data->samplerates,
 		    samplerate_mask))
 			continue;
+		if (old_mask && sigmadsp_data_loaded(sigmadsp, data, old_mask,
+		    samplerate_mask))
+			continue;
 		ret = sigmadsp_write(sigmadsp, data->addr, data->data,
 			data->length);
 		if (ret)
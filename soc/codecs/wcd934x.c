@@ -2207,17 +2207,21 @@ static irqreturn_t wcd934x_slim_irq_handler(int irq, void *data)
 {
 	struct wcd934x_codec *wcd = data;
 	unsigned long status = 0;
-	int i, j, port_id;
+	u8 int_status[4];
+	int j, port_id;
 	unsigned int val, int_val = 0;
 	irqreturn_t ret = IRQ_NONE;
 	bool tx;
 	unsigned short reg = 0;
 
-	for (i = WCD934X_SLIM_PGD_PORT_INT_STATUS_RX_0, j = 0;
-	     i <= WCD934X_SLIM_PGD_PORT_INT_STATUS_TX_1; i++, j++) {
-		regmap_read(wcd->if_regmap, i, &val);
-		status |= ((u32)val << (8 * j));
-	}
+	/* all four status registers in a single value element message */
+	if (regmap_bulk_read(wcd->if_regmap,
+			     WCD934X_SLIM_PGD_PORT_INT_STATUS_RX_0,
+			     int_status, ARRAY_SIZE(int_status)))
+		return IRQ_NONE;
+
+	for (j = 0; j < ARRAY_SIZE(int_status); j++)
+		status |= ((u32)int_status[j] << (8 * j));
 
 	for_each_set_bit(j, &status, 32) {
 		tx = false;
@@ -219,6 +219,9 @@
 #define WM_ADSP_ACKED_CTL_MIN_VALUE          0
 #define WM_ADSP_ACKED_CTL_MAX_VALUE          0xFFFFFF
 
+/* largest write built by merging writes to consecutive registers */
+#define WM_ADSP_MAX_WRITE                    (64 * 1024)
+
 /*
  * Event control messages
  */
@@ -312,7 +315,7 @@ struct wm_adsp_buf {
 	void *buf;
 };
 
-static struct wm_adsp_buf *wm_adsp_buf_alloc(const void *src, size_t len,
+static struct wm_adsp_buf *wm_adsp_buf_alloc(size_t size,
 					     struct list_head *list)
 {
 	struct wm_adsp_buf *buf = kzalloc(sizeof(*buf), GFP_KERNEL);
@@ -320,12 +323,11 @@ static struct wm_adsp_buf *wm_adsp_buf_alloc(const void *src, size_t len,
 	if (buf == NULL)
 		return NULL;
 
-	buf->buf = vmalloc(len);
+	buf->buf = vmalloc(size);
 	if (!buf->buf) {
 		kfree(buf);
 		return NULL;
 	}
-	memcpy(buf->buf, src, len);
 
 	if (list)
 		list_add_tail(&buf->list, list);
@@ -345,6 +347,90 @@ static void wm_adsp_buf_free(struct list_head *list)
 	}
 }
 
+/*
+ * Merges async raw writes to consecutive registers, so that a firmware or
+ * coefficient file made of many small blocks goes out in a few large bus
+ * transfers. The buffers stay on buf_list until the writes are completed.
+ */
+struct wm_adsp_writer {
+	struct wm_adsp *dsp;
+	struct list_head *buf_list;
+	struct wm_adsp_buf *buf;
+	unsigned int reg;
+	size_t len;
+	size_t size;
+	size_t max;
+};
+
+static void wm_adsp_writer_init(struct wm_adsp_writer *writer,
+				struct wm_adsp *dsp,
+				struct list_head *buf_list)
+{
+	size_t max = regmap_get_raw_write_max(dsp->regmap);
+
+	writer->dsp = dsp;
+	writer->buf_list = buf_list;
+	writer->buf = NULL;
+	writer->len = 0;
+	writer->max = WM_ADSP_MAX_WRITE;
+	if (max)
+		writer->max = min(writer->max, max);
+}
+
+static int wm_adsp_writer_flush(struct wm_adsp_writer *writer)
+{
+	struct wm_adsp *dsp = writer->dsp;
+	int ret;
+
+	if (!writer->buf)
+		return 0;
+
+	ret = regmap_raw_write_async(dsp->regmap, writer->reg,
+				     writer->buf->buf, writer->len);
+	if (ret != 0)
+		adsp_err(dsp, "Failed to write %zu bytes at %x: %d\n",
+			 writer->len, writer->reg, ret);
+
+	writer->buf = NULL;
+	writer->len = 0;
+
+	return ret;
+}
+
+static int wm_adsp_writer_add(struct wm_adsp_writer *writer,
+			      unsigned int reg, const void *data, size_t len)
+{
+	struct regmap *regmap = writer->dsp->regmap;
+	unsigned int next;
+	int ret = 0;
+
+	if (writer->buf) {
+		next = writer->reg + writer->len /
+		       regmap_get_val_bytes(regmap) *
+		       regmap_get_reg_stride(regmap);
+
+		if (reg == next && writer->len + len <= writer->size) {
+			memcpy(writer->buf->buf + writer->len, data, len);
+			writer->len += len;
+			return 0;
+		}
+
+		/* a failed write is reported but the new data is still queued */
+		ret = wm_adsp_writer_flush(writer);
+	}
+
+	writer->size = max(len, writer->max);
+	writer->buf = wm_adsp_buf_alloc(writer->size, writer->buf_list);
+	if (!writer->buf)
+		return -ENOMEM;
+
+	memcpy(writer->buf->buf, data, len);
+	writer->reg = reg;
+	writer->len = len;
+
+	return ret;
+}
+
 #define WM_ADSP_FW_MBC_VSS  0
 #define WM_ADSP_FW_HIFI     1
 #define WM_ADSP_FW_TX       2
@@ -1354,21 +1440,38 @@ static int wm_coeff_init_control_caches(struct wm_adsp *dsp)
 
 static int wm_coeff_sync_controls(struct wm_adsp *dsp)
 {
+	LIST_HEAD(buf_list);
+	struct wm_adsp_writer writer;
 	struct wm_coeff_ctl *ctl;
-	int ret;
+	unsigned int reg;
+	int ret = 0;
+
+	/* controls of consecutive coefficients are written together */
+	wm_adsp_writer_init(&writer, dsp, &buf_list);
 
 	list_for_each_entry(ctl, &dsp->ctl_list, list) {
 		if (!ctl->enabled)
 			continue;
 		if (ctl->set && !(ctl->flags & WMFW_CTL_FLAG_VOLATILE)) {
-			ret = wm_coeff_write_ctrl_raw(ctl, ctl->cache,
-						      ctl->len);
+			ret = wm_coeff_base_reg(ctl, &reg);
+			if (ret)
+				goto out;
+
+			ret = wm_adsp_writer_add(&writer, reg, ctl->cache,
+						 ctl->len);
 			if (ret < 0)
-				return ret;
+				goto out;
 		}
 	}
 
-	return 0;
+	ret = wm_adsp_writer_flush(&writer);
+
+out:
+	if (regmap_async_complete(dsp->regmap) && !ret)
+		ret = -EIO;
+	wm_adsp_buf_free(&buf_list);
+
+	return ret;
 }
 
 static void wm_adsp_signal_event_controls(struct wm_adsp *dsp,
@@ -1813,6 +1916,82 @@ static bool wm_halo_validate_version(struct wm_adsp *dsp, unsigned int version)
 	}
 }
 
+static void wm_adsp_alg_cache_free(struct wm_adsp *dsp)
+{
+	kfree(dsp->alg_cache);
+	dsp->alg_cache = NULL;
+	dsp->alg_cache_len = 0;
+}
+
+/*
+ * Drop the cached algorithm information unless the firmware file about to
+ * be downloaded is the one it was read for.
+ */
+static void wm_adsp_alg_cache_check(struct wm_adsp *dsp, u64 timestamp,
+				    size_t size)
+{
+	if (dsp->alg_cache && dsp->alg_cache_fw == dsp->fw &&
+	    dsp->alg_cache_timestamp == timestamp &&
+	    dsp->alg_cache_fw_size == size)
+		return;
+
+	wm_adsp_alg_cache_free(dsp);
+
+	dsp->alg_cache_fw = dsp->fw;
+	dsp->alg_cache_timestamp = timestamp;
+	dsp->alg_cache_fw_size = size;
+}
+
+/*
+ * Read @len bytes of algorithm information at @pos DSP words of @mem into @buf.
+ * The information is read in order from the start of the region, so the
+ * cache only grows at its end; reads it already covers don't touch the bus.
+ */
+static int wm_adsp_read_alg_info(struct wm_adsp *dsp,
+				 const struct wm_adsp_region *mem,
+				 unsigned int pos, void *buf, size_t len)
+{
+	size_t start = pos * sizeof(u32);
+	size_t end = start + len;
+	unsigned int reg;
+	void *cache;
+	int ret;
+
+	if (dsp->alg_cache_len && dsp->alg_cache_type != mem->type)
+		goto uncached;
+
+	if (end <= dsp->alg_cache_len) {
+		memcpy(buf, dsp->alg_cache + start, len);
+		return 0;
+	}
+
+	if (start > dsp->alg_cache_len)
+		goto uncached;
+
+	cache = krealloc(dsp->alg_cache, end, GFP_KERNEL);
+	if (!cache)
+		goto uncached;
+	dsp->alg_cache = cache;
+
+	reg = dsp->ops->region_to_reg(mem, dsp->alg_cache_len / sizeof(u32));
+
+	ret = regmap_raw_read(dsp->regmap, reg, cache + dsp->alg_cache_len,
+			      end - dsp->alg_cache_len);
+	if (ret != 0)
+		return ret;
+
+	dsp->alg_cache_len = end;
+	dsp->alg_cache_type = mem->type;
+	memcpy(buf, cache + start, len);
+
+	return 0;
+
+uncached:
+	reg = dsp->ops->region_to_reg(mem, pos);
+
+	return regmap_raw_read(dsp->regmap, reg, buf, len);
+}
+
 static int wm_adsp_load(struct wm_adsp *dsp)
 {
 	LIST_HEAD(buf_list);
@@ -1824,9 +2003,9 @@ static int wm_adsp_load(struct wm_adsp *dsp)
 	const struct wmfw_footer *footer;
 	const struct wmfw_region *region;
 	const struct wm_adsp_region *mem;
+	struct wm_adsp_writer writer;
 	const char *region_name;
 	char *file, *text = NULL;
-	struct wm_adsp_buf *buf;
 	unsigned int reg;
 	int regions = 0;
 	int ret, offset, type;
@@ -1890,6 +2069,11 @@ static int wm_adsp_load(struct wm_adsp *dsp)
 	adsp_dbg(dsp, "%s: timestamp %llu\n", file,
 		 le64_to_cpu(footer->timestamp));
 
+	wm_adsp_alg_cache_check(dsp, le64_to_cpu(footer->timestamp),
+				firmware->size);
+
+	wm_adsp_writer_init(&writer, dsp, &buf_list);
+
 	while (pos < firmware->size &&
 	       sizeof(*region) < firmware->size - pos) {
 		region = (void *)&(firmware->data[pos]);
@@ -1966,17 +2150,8 @@ static int wm_adsp_load(struct wm_adsp *dsp)
 		}
 
 		if (reg) {
-			buf = wm_adsp_buf_alloc(region->data,
-						le32_to_cpu(region->len),
-						&buf_list);
-			if (!buf) {
-				adsp_err(dsp, "Out of memory\n");
-				ret = -ENOMEM;
-				goto out_fw;
-			}
-
-			ret = regmap_raw_write_async(regmap, reg, buf->buf,
-						     le32_to_cpu(region->len));
+			ret = wm_adsp_writer_add(&writer, reg, region->data,
+						 le32_to_cpu(region->len));
 			if (ret != 0) {
 				adsp_err(dsp,
 					"%s.%d: Failed to write %d bytes at %d in %s: %d\n",
@@ -1991,6 +2166,10 @@ static int wm_adsp_load(struct wm_adsp *dsp)
 		regions++;
 	}
 
+	ret = wm_adsp_writer_flush(&writer);
+	if (ret != 0)
+		goto out_fw;
+
 	ret = regmap_async_complete(regmap);
 	if (ret != 0) {
 		adsp_err(dsp, "Failed to complete async write: %d\n", ret);
@@ -2097,7 +2276,6 @@ static void *wm_adsp_read_algs(struct wm_adsp *dsp, size_t n_algs,
 			       unsigned int pos, unsigned int len)
 {
 	void *alg;
-	unsigned int reg;
 	int ret;
 	__be32 val;
 
@@ -2111,36 +2289,25 @@ static void *wm_adsp_read_algs(struct wm_adsp *dsp, size_t n_algs,
 		return ERR_PTR(-EINVAL);
 	}
 
-	/* Read the terminator first to validate the length */
-	reg = dsp->ops->region_to_reg(mem, pos + len);
-
-	ret = regmap_raw_read(dsp->regmap, reg, &val, sizeof(val));
-	if (ret != 0) {
-		adsp_err(dsp, "Failed to read algorithm list end: %d\n",
-			ret);
-		return ERR_PTR(ret);
-	}
-
-	if (be32_to_cpu(val) != 0xbedead)
-		adsp_warn(dsp, "Algorithm list end %x 0x%x != 0xbedead\n",
-			  reg, be32_to_cpu(val));
-
-	/* Convert length from DSP words to bytes */
-	len *= sizeof(u32);
-
-	alg = kzalloc(len, GFP_KERNEL | GFP_DMA);
+	/* Read the list along with the terminator that validates its length */
+	alg = kzalloc(len * sizeof(u32) + sizeof(val), GFP_KERNEL | GFP_DMA);
 	if (!alg)
 		return ERR_PTR(-ENOMEM);
 
-	reg = dsp->ops->region_to_reg(mem, pos);
-
-	ret = regmap_raw_read(dsp->regmap, reg, alg, len);
+	ret = wm_adsp_read_alg_info(dsp, mem, pos, alg,
+				    len * sizeof(u32) + sizeof(val));
 	if (ret != 0) {
 		adsp_err(dsp, "Failed to read algorithm list: %d\n", ret);
 		kfree(alg);
 		return ERR_PTR(ret);
 	}
 
+	memcpy(&val, alg + len * sizeof(u32), sizeof(val));
+	if (be32_to_cpu(val) != 0xbedead)
+		adsp_warn(dsp, "Algorithm list end %x 0x%x != 0xbedead\n",
+			  dsp->ops->region_to_reg(mem, pos + len),
+			  be32_to_cpu(val));
+
 	return alg;
 }
 
@@ -2348,8 +2515,7 @@ static int wm_adsp2_setup_algs(struct wm_adsp *dsp)
 	if (WARN_ON(!mem))
 		return -EINVAL;
 
-	ret = regmap_raw_read(dsp->regmap, mem->base, &adsp2_id,
-			      sizeof(adsp2_id));
+	ret = wm_adsp_read_alg_info(dsp, mem, 0, &adsp2_id, sizeof(adsp2_id));
 	if (ret != 0) {
 		adsp_err(dsp, "Failed to read algorithm info: %d\n",
 			 ret);
@@ -2488,8 +2654,7 @@ static int wm_halo_setup_algs(struct wm_adsp *dsp)
 	if (WARN_ON(!mem))
 		return -EINVAL;
 
-	ret = regmap_raw_read(dsp->regmap, mem->base, &halo_id,
-			      sizeof(halo_id));
+	ret = wm_adsp_read_alg_info(dsp, mem, 0, &halo_id, sizeof(halo_id));
 	if (ret != 0) {
 		adsp_err(dsp, "Failed to read algorithm info: %d\n",
 			 ret);
@@ -2544,10 +2709,10 @@ static int wm_adsp_load_coeff(struct wm_adsp *dsp)
 	const struct firmware *firmware;
 	const struct wm_adsp_region *mem;
 	struct wm_adsp_alg_region *alg_region;
+	struct wm_adsp_writer writer;
 	const char *region_name;
 	int ret, pos, blocks, type, offset, reg;
 	char *file;
-	struct wm_adsp_buf *buf;
 
 	file = kzalloc(PAGE_SIZE, GFP_KERNEL);
 	if (file == NULL)
@@ -2594,6 +2759,8 @@ static int wm_adsp_load_coeff(struct wm_adsp *dsp)
 
 	pos = le32_to_cpu(hdr->len);
 
+	wm_adsp_writer_init(&writer, dsp, &buf_list);
+
 	blocks = 0;
 	while (pos < firmware->size &&
 	       sizeof(*blk) < firmware->size - pos) {
@@ -2684,21 +2851,15 @@ static int wm_adsp_load_coeff(struct wm_adsp *dsp)
 				goto out_fw;
 			}
 
-			buf = wm_adsp_buf_alloc(blk->data,
-						le32_to_cpu(blk->len),
-						&buf_list);
-			if (!buf) {
-				adsp_err(dsp, "Out of memory\n");
-				ret = -ENOMEM;
-				goto out_fw;
-			}
-
 			adsp_dbg(dsp, "%s.%d: Writing %d bytes at %x\n",
 				 file, blocks, le32_to_cpu(blk->len),
 				 reg);
-			ret = regmap_raw_write_async(regmap, reg, buf->buf,
-						     le32_to_cpu(blk->len));
-			if (ret != 0) {
+			ret = wm_adsp_writer_add(&writer, reg, blk->data,
+						 le32_to_cpu(blk->len));
+			if (ret == -ENOMEM) {
+				adsp_err(dsp, "Out of memory\n");
+				goto out_fw;
+			} else if (ret != 0) {
 				adsp_err(dsp,
 					"%s.%d: Failed to write to %x in %s: %d\n",
 					file, blocks, reg, region_name, ret);
@@ -2709,6 +2870,8 @@ static int wm_adsp_load_coeff(struct wm_adsp *dsp)
 		blocks++;
 	}
 
+	wm_adsp_writer_flush(&writer);
+
 	ret = regmap_async_complete(regmap);
 	if (ret != 0)
 		adsp_err(dsp, "Failed to complete async write: %d\n", ret);
@@ -3411,6 +3574,8 @@ void wm_adsp2_remove(struct wm_adsp *dsp)
 		list_del(&ctl->list);
 		wm_adsp_free_ctl_blk(ctl);
 	}
+
+	wm_adsp_alg_cache_free(dsp);
 }
 EXPORT_SYMBOL_GPL(wm_adsp2_remove);
 
@@ -84,6 +84,17 @@ struct wm_adsp {
 	int fw;
 	int fw_ver;
 
+	/*
+	 * Copy of the algorithm information read from XM after the last boot,
+	 * valid while the same firmware file is downloaded again.
+	 */
+	void *alg_cache;
+	size_t alg_cache_len;
+	int alg_cache_type;
+	int alg_cache_fw;
+	u64 alg_cache_timestamp;
+	size_t alg_cache_fw_size;
+
 	bool preloaded;
 	bool booted;
 	bool running;
@@ -219,7 +219,7 @@ void fsl_asrc_release_pair(struct fsl_asrc_pair *pair)
 /**
  * Configure input and output thresholds
  */
-static void fsl_asrc_set_watermarks(struct fsl_asrc_pair *pair, u32 in, u32 out)
+void fsl_asrc_set_watermarks(struct fsl_asrc_pair *pair, u32 in, u32 out)
 {
 	struct fsl_asrc *asrc_priv = pair->asrc_priv;
 	enum asrc_pair_index index = pair->index;
@@ -306,7 +306,7 @@ static int fsl_asrc_set_ideal_ratio(struct fsl_asrc_pair *pair,
  * clock rate aligning with the output sample rate; For a use case requiring
  * faster conversion, set use_ideal_rate to have the faster speed.
  */
-static int fsl_asrc_config_pair(struct fsl_asrc_pair *pair, bool use_ideal_rate)
+int fsl_asrc_config_pair(struct fsl_asrc_pair *pair, bool use_ideal_rate)
 {
 	struct asrc_config *config = pair->config;
 	struct fsl_asrc *asrc_priv = pair->asrc_priv;
@@ -510,7 +510,7 @@ static int fsl_asrc_config_pair(struct fsl_asrc_pair *pair, bool use_ideal_rate)
  *
  * It enables the assigned pair and makes it stopped at the stall level.
  */
-static void fsl_asrc_start_pair(struct fsl_asrc_pair *pair)
+void fsl_asrc_start_pair(struct fsl_asrc_pair *pair)
 {
 	struct fsl_asrc *asrc_priv = pair->asrc_priv;
 	enum asrc_pair_index index = pair->index;
@@ -539,7 +539,7 @@ static void fsl_asrc_start_pair(struct fsl_asrc_pair *pair)
 /**
  * Stop the assigned ASRC pair
  */
-static void fsl_asrc_stop_pair(struct fsl_asrc_pair *pair)
+void fsl_asrc_stop_pair(struct fsl_asrc_pair *pair)
 {
 	struct fsl_asrc *asrc_priv = pair->asrc_priv;
 	enum asrc_pair_index index = pair->index;
@@ -21,6 +21,8 @@
 #define ASRC_DMA_BUFFER_SIZE		(1024 * 48 * 4)
 #define ASRC_MAX_BUFFER_SIZE		(1024 * 48)
 #define ASRC_OUTPUT_LAST_SAMPLE		8
+#define ASRC_M2M_INPUTFIFO_WML		4
+#define ASRC_M2M_OUTPUTFIFO_WML		2
 
 #define IDEAL_RATIO_RATE		1000000
 
@@ -524,5 +526,15 @@ extern struct snd_soc_component_driver fsl_asrc_component;
 struct dma_chan *fsl_asrc_get_dma_channel(struct fsl_asrc_pair *pair, bool dir);
 int fsl_asrc_request_pair(int channels, struct fsl_asrc_pair *pair);
 void fsl_asrc_release_pair(struct fsl_asrc_pair *pair);
+void fsl_asrc_set_watermarks(struct fsl_asrc_pair *pair, u32 in, u32 out);
+int fsl_asrc_config_pair(struct fsl_asrc_pair *pair, bool use_ideal_rate);
+void fsl_asrc_start_pair(struct fsl_asrc_pair *pair);
+void fsl_asrc_stop_pair(struct fsl_asrc_pair *pair);
+
+struct fsl_asrc_pair *fsl_asrc_m2m_open(struct fsl_asrc *asrc_priv,
+					struct asrc_config *config);
+int fsl_asrc_m2m_convert(struct fsl_asrc_pair *pair,
+			 struct asrc_convert_buffer *buf);
+void fsl_asrc_m2m_close(struct fsl_asrc_pair *pair);
 
 #endif /* _FSL_ASRC_H */
@@ -0,0 +1,384 @@
+// SPDX-License-Identifier: GPL-2.0
+//
+// Freescale ASRC memory to memory conversion
+//
+// A pair is used outside of any DPCM chain: the input buffer is pushed
+// to the input FIFO of the pair by one DMA channel and the converted
+// samples are pulled from its output FIFO by another one, so that the
+// sample rate conversion of a file or of a bridged stream runs in the
+// ASRC instead of the CPU.
+
+#include <linux/dma-mapping.h>
+#include <linux/dmaengine.h>
+#include <linux/math64.h>
+#include <linux/platform_data/dma-imx.h>
+#include <linux/pm_runtime.h>
+#include <linux/regmap.h>
+#include <linux/slab.h>
+#include <sound/dmaengine_pcm.h>
+#include <sound/pcm_params.h>
+
+#include "fsl_asrc.h"
+
+/* added to the real time duration of a conversion before timing out */
+#define ASRC_M2M_TIMEOUT_MS		500
+
+#define pair_err(fmt, ...) \
+	dev_err(&asrc_priv->pdev->dev, "Pair %c: " fmt, 'A' + index, ##__VA_ARGS__)
+
+#define pair_dbg(fmt, ...) \
+	dev_dbg(&asrc_priv->pdev->dev, "Pair %c: " fmt, 'A' + index, ##__VA_ARGS__)
+
+/**
+ * fsl_asrc_m2m: memory to memory conversion context
+ *
+ * @pair: the ASRC pair doing the conversion
+ * @config: configuration profile of the pair
+ * @dma_block: input and output DMA buffers
+ * @width: input and output sample container size in bytes
+ * @complete: signaled once the output DMA transfer is done
+ * @lock: serializes the conversions on the pair
+ */
+struct fsl_asrc_m2m {
+	struct fsl_asrc_pair pair;
+	struct asrc_config config;
+	struct dma_block dma_block[2];
+	unsigned int width[2];
+	struct completion complete;
+	struct mutex lock;
+};
+
+static void fsl_asrc_m2m_complete(void *arg)
+{
+	struct fsl_asrc_m2m *m2m = arg;
+
+	complete(&m2m->complete);
+}
+
+static enum dma_slave_buswidth fsl_asrc_m2m_buswidth(unsigned int width)
+{
+	switch (width) {
+	case 1:
+		return DMA_SLAVE_BUSWIDTH_1_BYTE;
+	case 2:
+		return DMA_SLAVE_BUSWIDTH_2_BYTES;
+	default:
+		return DMA_SLAVE_BUSWIDTH_4_BYTES;
+	}
+}
+
+static void fsl_asrc_m2m_release(struct fsl_asrc_m2m *m2m)
+{
+	struct fsl_asrc_pair *pair = &m2m->pair;
+	struct device *dev = &pair->asrc_priv->pdev->dev;
+	int dir;
+
+	for (dir = IN; dir <= OUT; dir++) {
+		if (pair->dma_chan[dir])
+			dma_release_channel(pair->dma_chan[dir]);
+		pair->dma_chan[dir] = NULL;
+
+		if (m2m->dma_block[dir].dma_vaddr)
+			dma_free_coherent(dev, m2m->dma_block[dir].length,
+					  m2m->dma_block[dir].dma_vaddr,
+					  m2m->dma_block[dir].dma_paddr);
+		m2m->dma_block[dir].dma_vaddr = NULL;
+	}
+}
+
+/**
+ * Request the DMA channels and buffers for both FIFOs of the pair
+ */
+static int fsl_asrc_m2m_init_dma(struct fsl_asrc_m2m *m2m,
+				 unsigned int size)
+{
+	struct fsl_asrc_pair *pair = &m2m->pair;
+	struct fsl_asrc *asrc_priv = pair->asrc_priv;
+	enum asrc_pair_index index = pair->index;
+	struct device *dev = &asrc_priv->pdev->dev;
+	struct dma_slave_config config;
+	int dir, ret;
+
+	for (dir = IN; dir <= OUT; dir++) {
+		pair->dma_chan[dir] = fsl_asrc_get_dma_channel(pair, dir);
+		if (!pair->dma_chan[dir]) {
+			pair_err("failed to request %s DMA channel\n",
+				 dir == IN ? "input" : "output");
+			return -EINVAL;
+		}
+
+		memset(&config, 0, sizeof(config));
+		if (dir == IN) {
+			config.direction = DMA_MEM_TO_DEV;
+			config.dst_addr = asrc_priv->paddr + REG_ASRDI(index);
+			config.dst_addr_width =
+				fsl_asrc_m2m_buswidth(m2m->width[IN]);
+			config.dst_maxburst =
+				ASRC_M2M_INPUTFIFO_WML * pair->channels;
+		} else {
+			config.direction = DMA_DEV_TO_MEM;
+			config.src_addr = asrc_priv->paddr + REG_ASRDO(index);
+			config.src_addr_width =
+				fsl_asrc_m2m_buswidth(m2m->width[OUT]);
+			config.src_maxburst =
+				ASRC_M2M_OUTPUTFIFO_WML * pair->channels;
+		}
+
+		ret = dmaengine_slave_config(pair->dma_chan[dir], &config);
+		if (ret) {
+			pair_err("failed to config %s DMA channel: %d\n",
+				 dir == IN ? "input" : "output", ret);
+			return ret;
+		}
+
+		m2m->dma_block[dir].length = size;
+		m2m->dma_block[dir].dma_vaddr =
+			dma_alloc_coherent(dev, size,
+					   &m2m->dma_block[dir].dma_paddr,
+					   GFP_KERNEL);
+		if (!m2m->dma_block[dir].dma_vaddr)
+			return -ENOMEM;
+	}
+
+	return 0;
+}
+
+/**
+ * fsl_asrc_m2m_open - Request a pair for memory to memory conversion
+ *
+ * @asrc_priv: ASRC instance
+ * @config: channels, sample rates and formats of the conversion, the
+ *	    optional dma_buffer_size bounds the buffers of a conversion
+ *
+ * The pair runs in ideal ratio mode at the fastest converting speed, no
+ * input or output clock is needed.
+ *
+ * Return: the pair or an error pointer.
+ */
+struct fsl_asrc_pair *fsl_asrc_m2m_open(struct fsl_asrc *asrc_priv,
+					struct asrc_config *config)
+{
+	struct device *dev = &asrc_priv->pdev->dev;
+	struct fsl_asrc_m2m *m2m;
+	struct fsl_asrc_pair *pair;
+	unsigned int size;
+	int ret;
+
+	m2m = kzalloc(sizeof(*m2m), GFP_KERNEL);
+	if (!m2m)
+		return ERR_PTR(-ENOMEM);
+
+	mutex_init(&m2m->lock);
+	init_completion(&m2m->complete);
+	m2m->config = *config;
+	m2m->config.inclk = INCLK_NONE;
+	m2m->config.outclk = OUTCLK_ASRCK1_CLK;
+	m2m->width[IN] = snd_pcm_format_physical_width(config->input_format) / 8;
+	m2m->width[OUT] = snd_pcm_format_physical_width(config->output_format) / 8;
+
+	pair = &m2m->pair;
+	pair->asrc_priv = asrc_priv;
+	pair->config = &m2m->config;
+	pair->private = m2m;
+
+	ret = pm_runtime_get_sync(dev);
+	if (ret < 0) {
+		pm_runtime_put_noidle(dev);
+		kfree(m2m);
+		return ERR_PTR(ret);
+	}
+
+	ret = fsl_asrc_request_pair(config->channel_num, pair);
+	if (ret) {
+		dev_err(dev, "fail to request asrc pair\n");
+		goto err_pm;
+	}
+
+	m2m->config.pair = pair->index;
+
+	ret = fsl_asrc_config_pair(pair, true);
+	if (ret) {
+		dev_err(dev, "fail to config asrc pair\n");
+		goto err_pair;
+	}
+
+	fsl_asrc_set_watermarks(pair, ASRC_M2M_INPUTFIFO_WML,
+				ASRC_M2M_OUTPUTFIFO_WML);
+
+	size = config->dma_buffer_size ? : ASRC_DMA_BUFFER_SIZE;
+	size = min_t(unsigned int, size, ASRC_DMA_BUFFER_SIZE);
+
+	ret = fsl_asrc_m2m_init_dma(m2m, PAGE_ALIGN(size));
+	if (ret)
+		goto err_dma;
+
+	return pair;
+
+err_dma:
+	fsl_asrc_m2m_release(m2m);
+err_pair:
+	fsl_asrc_release_pair(pair);
+err_pm:
+	pm_runtime_put(dev);
+	kfree(m2m);
+
+	return ERR_PTR(ret);
+}
+EXPORT_SYMBOL_GPL(fsl_asrc_m2m_open);
+
+/**
+ * Read the samples left in the output FIFO once the output DMA is done
+ */
+static unsigned int fsl_asrc_m2m_drain(struct fsl_asrc_m2m *m2m,
+				       void *buf, unsigned int room)
+{
+	struct fsl_asrc_pair *pair = &m2m->pair;
+	struct fsl_asrc *asrc_priv = pair->asrc_priv;
+	enum asrc_pair_index index = pair->index;
+	unsigned int width = m2m->width[OUT];
+	unsigned int i, words, reg, val;
+
+	regmap_read(asrc_priv->regmap, REG_ASRFST(index), &reg);
+	words = (reg & ASRFSTi_OUTPUT_FIFO_MASK) >> ASRFSTi_OUTPUT_FIFO_SHIFT;
+	words = min_t(unsigned int, words, ASRC_OUTPUT_LAST_SAMPLE);
+	words = min(words * pair->channels, room / width);
+
+	for (i = 0; i < words; i++) {
+		regmap_read(asrc_priv->regmap, REG_ASRDO(index), &val);
+		if (width == 2)
+			((u16 *)buf)[i] = val;
+		else
+			((u32 *)buf)[i] = val;
+	}
+
+	return words * width;
+}
+
+/**
+ * fsl_asrc_m2m_convert - Convert a buffer
+ *
+ * @pair: pair returned by fsl_asrc_m2m_open()
+ * @buf: input buffer and its length in bytes, output buffer and its size
+ *	 in bytes; the output length is updated to the bytes converted
+ *
+ * Both lengths are bounded by the buffer size of the pair, an input of
+ * N frames gives about N * output rate / input rate frames.
+ *
+ * Return: 0 on success or a negative error code.
+ */
+int fsl_asrc_m2m_convert(struct fsl_asrc_pair *pair,
+			 struct asrc_convert_buffer *buf)
+{
+	struct fsl_asrc_m2m *m2m = pair->private;
+	struct fsl_asrc *asrc_priv = pair->asrc_priv;
+	enum asrc_pair_index index = pair->index;
+	struct asrc_config *config = &m2m->config;
+	struct dma_async_tx_descriptor *desc[2];
+	unsigned int in_frame = m2m->width[IN] * pair->channels;
+	unsigned int out_frame = m2m->width[OUT] * pair->channels;
+	unsigned int in_len, out_len, burst, frames;
+	unsigned long timeout;
+	long left;
+	int ret = 0;
+
+	in_len = rounddown(buf->input_buffer_length, in_frame);
+	if (!in_len || in_len > m2m->dma_block[IN].length)
+		return -EINVAL;
+
+	/* the input FIFO is filled by whole bursts */
+	burst = ASRC_M2M_INPUTFIFO_WML * in_frame;
+	frames = in_len / in_frame;
+
+	/* the last output words are read from the FIFO once DMA is done */
+	out_len = div_u64((u64)frames * config->output_sample_rate,
+			  config->input_sample_rate) * out_frame;
+	out_len = rounddown(out_len, ASRC_M2M_OUTPUTFIFO_WML * out_frame);
+	if (!out_len || out_len > m2m->dma_block[OUT].length ||
+	    out_len > buf->output_buffer_length)
+		return -EINVAL;
+
+	mutex_lock(&m2m->lock);
+
+	memcpy(m2m->dma_block[IN].dma_vaddr, buf->input_buffer_vaddr, in_len);
+	if (roundup(in_len, burst) <= m2m->dma_block[IN].length) {
+		memset(m2m->dma_block[IN].dma_vaddr + in_len, 0,
+		       roundup(in_len, burst) - in_len);
+		in_len = roundup(in_len, burst);
+	}
+
+	desc[IN] = dmaengine_prep_slave_single(pair->dma_chan[IN],
+					       m2m->dma_block[IN].dma_paddr,
+					       in_len, DMA_MEM_TO_DEV,
+					       DMA_CTRL_ACK);
+	desc[OUT] = dmaengine_prep_slave_single(pair->dma_chan[OUT],
+						m2m->dma_block[OUT].dma_paddr,
+						out_len, DMA_DEV_TO_MEM,
+						DMA_PREP_INTERRUPT |
+						DMA_CTRL_ACK);
+	if (!desc[IN] || !desc[OUT]) {
+		pair_err("failed to prepare slave DMA\n");
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	reinit_completion(&m2m->complete);
+	desc[OUT]->callback = fsl_asrc_m2m_complete;
+	desc[OUT]->callback_param = m2m;
+
+	dmaengine_submit(desc[IN]);
+	dmaengine_submit(desc[OUT]);
+
+	fsl_asrc_start_pair(pair);
+	dma_async_issue_pending(pair->dma_chan[OUT]);
+	dma_async_issue_pending(pair->dma_chan[IN]);
+
+	timeout = msecs_to_jiffies(frames * 1000 / config->input_sample_rate +
+				   ASRC_M2M_TIMEOUT_MS);
+	left = wait_for_completion_interruptible_timeout(&m2m->complete,
+							 timeout);
+	if (left <= 0) {
+		ret = left ? : -ETIMEDOUT;
+		pair_err("conversion of %u bytes failed: %d\n", in_len, ret);
+		goto stop;
+	}
+
+	out_len += fsl_asrc_m2m_drain(m2m,
+				      m2m->dma_block[OUT].dma_vaddr + out_len,
+				      min(m2m->dma_block[OUT].length,
+					  buf->output_buffer_length) - out_len);
+
+	memcpy(buf->output_buffer_vaddr, m2m->dma_block[OUT].dma_vaddr,
+	       out_len);
+	buf->output_buffer_length = out_len;
+
+	if (pair->error)
+		pair_dbg("conversion error status 0x%x\n", pair->error);
+	pair->error = 0;
+
+stop:
+	fsl_asrc_stop_pair(pair);
+	dmaengine_terminate_all(pair->dma_chan[IN]);
+	dmaengine_terminate_all(pair->dma_chan[OUT]);
+out:
+	mutex_unlock(&m2m->lock);
+
+	return ret;
+}
+EXPORT_SYMBOL_GPL(fsl_asrc_m2m_convert);
+
+/**
+ * fsl_asrc_m2m_close - Release a pair requested by fsl_asrc_m2m_open()
+ *
+ * @pair: pair to release
+ */
+void fsl_asrc_m2m_close(struct fsl_asrc_pair *pair)
+{
+	struct fsl_asrc_m2m *m2m = pair->private;
+	struct device *dev = &pair->asrc_priv->pdev->dev;
+
+	fsl_asrc_m2m_release(m2m);
+	fsl_asrc_release_pair(pair);
+	pm_runtime_put(dev);
+	kfree(m2m);
+}
+EXPORT_SYMBOL_GPL(fsl_asrc_m2m_close);
@@ -75,6 +75,39 @@ static int tx_wait_done(struct sst_generic_ipc *ipc,
 	return ret;
 }
 
+/* locks held by caller */
+static void ipc_tx_msgs_locked(struct sst_generic_ipc *ipc)
+{
+	struct ipc_message *msg;
+
+	while (!list_empty(&ipc->tx_list) && !ipc->pending) {
+		/* if the DSP is busy, we will TX messages after IRQ.
+		 * also postpone if we are in the middle of processing
+		 * completion irq
+		 */
+		if (ipc->ops.is_dsp_busy && ipc->ops.is_dsp_busy(ipc->dsp)) {
+			dev_dbg(ipc->dev, "ipc_tx_msgs dsp busy\n");
+			break;
+		}
+
+		msg = list_first_entry(&ipc->tx_list, struct ipc_message, list);
+		list_move(&msg->list, &ipc->rx_list);
+
+		if (ipc->ops.tx_msg != NULL)
+			ipc->ops.tx_msg(ipc, msg);
+	}
+}
+
+static void ipc_tx_msgs(struct work_struct *work)
+{
+	struct sst_generic_ipc *ipc =
+		container_of(work, struct sst_generic_ipc, kwork);
+
+	spin_lock_irq(&ipc->dsp->spinlock);
+	ipc_tx_msgs_locked(ipc);
+	spin_unlock_irq(&ipc->dsp->spinlock);
+}
+
 static int ipc_tx_message(struct sst_generic_ipc *ipc,
 	struct sst_ipc_message request,
 	struct sst_ipc_message *reply, int wait)
@@ -103,7 +136,13 @@ static int ipc_tx_message(struct sst_generic_ipc *ipc,
 		ipc->ops.tx_data_copy(msg, request.data, request.size);
 
 	list_add_tail(&msg->list, &ipc->tx_list);
-	schedule_work(&ipc->kwork);
+
+	/*
+	 * Send right away when the mailbox is idle rather than bouncing
+	 * through the work, otherwise the message is sent from the work
+	 * once the DSP IRQ reports the mailbox is free again.
+	 */
+	ipc_tx_msgs_locked(ipc);
 	spin_unlock_irqrestore(&ipc->dsp->spinlock, flags);
 
 	if (wait)
@@ -149,34 +188,6 @@ free_mem:
 	return -ENOMEM;
 }
 
-static void ipc_tx_msgs(struct work_struct *work)
-{
-	struct sst_generic_ipc *ipc =
-		container_of(work, struct sst_generic_ipc, kwork);
-	struct ipc_message *msg;
-
-	spin_lock_irq(&ipc->dsp->spinlock);
-
-	while (!list_empty(&ipc->tx_list) && !ipc->pending) {
-		/* if the DSP is busy, we will TX messages after IRQ.
-		 * also postpone if we are in the middle of processing
-		 * completion irq
-		 */
-		if (ipc->ops.is_dsp_busy && ipc->ops.is_dsp_busy(ipc->dsp)) {
-			dev_dbg(ipc->dev, "ipc_tx_msgs dsp busy\n");
-			break;
-		}
-
-		msg = list_first_entry(&ipc->tx_list, struct ipc_message, list);
-		list_move(&msg->list, &ipc->rx_list);
-
-		if (ipc->ops.tx_msg != NULL)
-			ipc->ops.tx_msg(ipc, msg);
-	}
-
-	spin_unlock_irq(&ipc->dsp->spinlock);
-}
-
 int sst_ipc_tx_message_wait(struct sst_generic_ipc *ipc,
 	struct sst_ipc_message request, struct sst_ipc_message *reply)
 {
@@ -14,35 +14,29 @@
 #include "skl-i2s.h"
 
 static struct nhlt_specific_cfg *skl_get_specific_cfg(
-		struct device *dev, struct nhlt_fmt *fmt,
-		u8 no_ch, u32 rate, u16 bps, u8 linktype)
+		struct device *dev, struct skl_nhlt_ep *ep,
+		u8 no_ch, u32 rate, u16 bps)
 {
-	struct nhlt_specific_cfg *sp_config;
-	struct wav_fmt *wfmt;
-	struct nhlt_fmt_cfg *fmt_config = fmt->fmt_config;
+	struct skl_nhlt_fmt *fmt;
 	int i;
 
-	dev_dbg(dev, "Format count =%d\n", fmt->fmt_count);
+	dev_dbg(dev, "Format count =%d\n", ep->num_fmts);
 
-	for (i = 0; i < fmt->fmt_count; i++) {
-		wfmt = &fmt_config->fmt_ext.fmt;
-		dev_dbg(dev, "ch=%d fmt=%d s_rate=%d\n", wfmt->channels,
-			 wfmt->bits_per_sample, wfmt->samples_per_sec);
-		if (wfmt->channels == no_ch && wfmt->bits_per_sample == bps) {
+	for (i = 0; i < ep->num_fmts; i++) {
+		fmt = &ep->fmts[i];
+		dev_dbg(dev, "ch=%d fmt=%d s_rate=%d\n", fmt->channels,
+			 fmt->bps, fmt->rate);
+		if (fmt->channels == no_ch && fmt->bps == bps) {
 			/*
 			 * if link type is dmic ignore rate check as the blob is
 			 * generic for all rates
 			 */
-			sp_config = &fmt_config->config;
-			if (linktype == NHLT_LINK_DMIC)
-				return sp_config;
+			if (ep->linktype == NHLT_LINK_DMIC)
+				return fmt->cfg;
 
-			if (wfmt->samples_per_sec == rate)
-				return sp_config;
+			if (fmt->rate == rate)
+				return fmt->cfg;
 		}
-
-		fmt_config = (struct nhlt_fmt_cfg *)(fmt_config->config.caps +
-						fmt_config->config.size);
 	}
 
 	return NULL;
@@ -57,59 +51,113 @@ static void dump_config(struct device *dev, u32 instance_id, u8 linktype,
 	dev_dbg(dev, "bits_per_sample=%d\n", bps);
 }
 
-static bool skl_check_ep_match(struct device *dev, struct nhlt_endpoint *epnt,
+static bool skl_check_ep_match(struct device *dev, struct skl_nhlt_ep *ep,
 		u32 instance_id, u8 link_type, u8 dirn, u8 dev_type)
 {
 	dev_dbg(dev, "vbus_id=%d link_type=%d dir=%d dev_type = %d\n",
-			epnt->virtual_bus_id, epnt->linktype,
-			epnt->direction, epnt->device_type);
+			ep->vbus_id, ep->linktype,
+			ep->direction, ep->device_type);
 
-	if ((epnt->virtual_bus_id == instance_id) &&
-			(epnt->linktype == link_type) &&
-			(epnt->direction == dirn)) {
+	if ((ep->vbus_id == instance_id) &&
+			(ep->linktype == link_type) &&
+			(ep->direction == dirn)) {
 		/* do not check dev_type for DMIC link type */
-		if (epnt->linktype == NHLT_LINK_DMIC)
+		if (ep->linktype == NHLT_LINK_DMIC)
 			return true;
 
-		if (epnt->device_type == dev_type)
+		if (ep->device_type == dev_type)
 			return true;
 	}
 
 	return false;
 }
 
+/*
+ * Resolve the endpoints and formats of the NHLT table once, so that
+ * skl_get_ep_blob() compares compact entries instead of walking the
+ * variable length ACPI descriptors on every hw_params.
+ */
+int skl_nhlt_build_index(struct skl_dev *skl)
+{
+	struct nhlt_acpi_table *nhlt = skl->nhlt;
+	struct device *dev = skl_to_bus(skl)->dev;
+	struct nhlt_fmt_cfg *fmt_config;
+	struct nhlt_endpoint *epnt;
+	struct skl_nhlt_ep *ep;
+	struct nhlt_fmt *fmt;
+	struct wav_fmt *wfmt;
+	int i, j;
+
+	skl->nhlt_eps = devm_kcalloc(dev, nhlt->endpoint_count,
+				     sizeof(*skl->nhlt_eps), GFP_KERNEL);
+	if (!skl->nhlt_eps)
+		return -ENOMEM;
+
+	epnt = (struct nhlt_endpoint *)nhlt->desc;
+
+	for (i = 0; i < nhlt->endpoint_count; i++) {
+		ep = &skl->nhlt_eps[i];
+		ep->vbus_id = epnt->virtual_bus_id;
+		ep->linktype = epnt->linktype;
+		ep->direction = epnt->direction;
+		ep->device_type = epnt->device_type;
+
+		fmt = (struct nhlt_fmt *)(epnt->config.caps +
+					 epnt->config.size);
+		ep->fmts = devm_kcalloc(dev, fmt->fmt_count,
+					sizeof(*ep->fmts), GFP_KERNEL);
+		if (!ep->fmts && fmt->fmt_count)
+			return -ENOMEM;
+
+		ep->num_fmts = fmt->fmt_count;
+		fmt_config = fmt->fmt_config;
+
+		for (j = 0; j < fmt->fmt_count; j++) {
+			wfmt = &fmt_config->fmt_ext.fmt;
+			ep->fmts[j].channels = wfmt->channels;
+			ep->fmts[j].bps = wfmt->bits_per_sample;
+			ep->fmts[j].rate = wfmt->samples_per_sec;
+			ep->fmts[j].cfg = &fmt_config->config;
+
+			fmt_config = (struct nhlt_fmt_cfg *)
+				(fmt_config->config.caps +
+				 fmt_config->config.size);
+		}
+
+		epnt = (struct nhlt_endpoint *)((u8 *)epnt + epnt->length);
+	}
+
+	skl->nhlt_num_eps = nhlt->endpoint_count;
+
+	return 0;
+}
+
 struct nhlt_specific_cfg
 *skl_get_ep_blob(struct skl_dev *skl, u32 instance, u8 link_type,
 			u8 s_fmt, u8 num_ch, u32 s_rate,
 			u8 dirn, u8 dev_type)
 {
-	struct nhlt_fmt *fmt;
-	struct nhlt_endpoint *epnt;
+	struct skl_nhlt_ep *ep;
 	struct hdac_bus *bus = skl_to_bus(skl);
 	struct device *dev = bus->dev;
 	struct nhlt_specific_cfg *sp_config;
-	struct nhlt_acpi_table *nhlt = skl->nhlt;
 	u16 bps = (s_fmt == 16) ? 16 : 32;
 	u8 j;
 
 	dump_config(dev, instance, link_type, s_fmt, num_ch, s_rate, dirn, bps);
 
-	epnt = (struct nhlt_endpoint *)nhlt->desc;
+	dev_dbg(dev, "endpoint count =%d\n", skl->nhlt_num_eps);
 
-	dev_dbg(dev, "endpoint count =%d\n", nhlt->endpoint_count);
+	for (j = 0; j < skl->nhlt_num_eps; j++) {
+		ep = &skl->nhlt_eps[j];
 
-	for (j = 0; j < nhlt->endpoint_count; j++) {
-		if (skl_check_ep_match(dev, epnt, instance, link_type,
+		if (skl_check_ep_match(dev, ep, instance, link_type,
 						dirn, dev_type)) {
-			fmt = (struct nhlt_fmt *)(epnt->config.caps +
-						 epnt->config.size);
-			sp_config = skl_get_specific_cfg(dev, fmt, num_ch,
-							s_rate, bps, link_type);
+			sp_config = skl_get_specific_cfg(dev, ep, num_ch,
+							s_rate, bps);
 			if (sp_config)
 				return sp_config;
 		}
-
-		epnt = (struct nhlt_endpoint *)((u8 *)epnt + epnt->length);
 	}
 
 	return NULL;
@@ -1318,19 +1318,14 @@ static int skl_get_module_info(struct skl_dev *skl,
 		return -EIO;
 	}
 
-	list_for_each_entry(module, &skl->uuid_list, list) {
-		if (guid_equal(uuid_mod, &module->uuid)) {
-			mconfig->id.module_id = module->id;
-			if (mconfig->module)
-				mconfig->module->loadable = module->is_loadable;
-			ret = 0;
-			break;
-		}
-	}
-
-	if (ret)
+	module = skl_find_uuid_module(skl, uuid_mod);
+	if (!module)
 		return ret;
 
+	mconfig->id.module_id = module->id;
+	if (mconfig->module)
+		mconfig->module->loadable = module->is_loadable;
+
 	uuid_mod = &module->uuid;
 	ret = -EIO;
 	for (i = 0; i < skl->nr_modules; i++) {
@@ -1345,18 +1340,18 @@ static int skl_get_module_info(struct skl_dev *skl,
 	if (skl->nr_modules && ret)
 		return ret;
 
-	list_for_each_entry(module, &skl->uuid_list, list) {
-		for (i = 0; i < MAX_IN_QUEUE; i++) {
-			pin_id = &mconfig->m_in_pin[i].id;
-			if (guid_equal(&pin_id->mod_uuid, &module->uuid))
-				pin_id->module_id = module->id;
-		}
+	for (i = 0; i < MAX_IN_QUEUE; i++) {
+		pin_id = &mconfig->m_in_pin[i].id;
+		module = skl_find_uuid_module(skl, &pin_id->mod_uuid);
+		if (module)
+			pin_id->module_id = module->id;
+	}
 
-		for (i = 0; i < MAX_OUT_QUEUE; i++) {
-			pin_id = &mconfig->m_out_pin[i].id;
-			if (guid_equal(&pin_id->mod_uuid, &module->uuid))
-				pin_id->module_id = module->id;
-		}
+	for (i = 0; i < MAX_OUT_QUEUE; i++) {
+		pin_id = &mconfig->m_out_pin[i].id;
+		module = skl_find_uuid_module(skl, &pin_id->mod_uuid);
+		if (module)
+			pin_id->module_id = module->id;
 	}
 
 	return 0;
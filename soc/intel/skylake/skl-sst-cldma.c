@@ -83,15 +83,16 @@ static void skl_cldma_setup_bdle(struct sst_dsp *ctx,
 	ctx->cl_dev.frags = 0;
 	while (size > 0) {
 		phys_addr_t addr = virt_to_phys(dmab_data->area +
-				(ctx->cl_dev.frags * ctx->cl_dev.bufsize));
+				(ctx->cl_dev.frags * ctx->cl_dev.frag_size));
 
 		bdl[0] = cpu_to_le32(lower_32_bits(addr));
 		bdl[1] = cpu_to_le32(upper_32_bits(addr));
 
-		bdl[2] = cpu_to_le32(ctx->cl_dev.bufsize);
+		bdl[2] = cpu_to_le32(ctx->cl_dev.frag_size);
 
-		size -= ctx->cl_dev.bufsize;
-		bdl[3] = (size || !with_ioc) ? 0 : cpu_to_le32(0x01);
+		/* interrupt on each fragment so that it can be refilled */
+		size -= ctx->cl_dev.frag_size;
+		bdl[3] = with_ioc ? cpu_to_le32(0x01) : 0;
 
 		bdl += 4;
 		ctx->cl_dev.frags++;
@@ -157,12 +158,14 @@ static void skl_cldma_cleanup(struct sst_dsp  *ctx)
 	ctx->dsp_ops.free_dma_buf(ctx->dev, &ctx->cl_dev.dmab_bdl);
 }
 
+/* wait for the oldest fragment queued to be transferred */
 int skl_cldma_wait_interruptible(struct sst_dsp *ctx)
 {
 	int ret = 0;
 
 	if (!wait_event_timeout(ctx->cl_dev.wait_queue,
-				ctx->cl_dev.wait_condition,
+				atomic_add_unless(&ctx->cl_dev.frags_done,
+						  -1, 0),
 				msecs_to_jiffies(SKL_WAIT_TIMEOUT))) {
 		dev_err(ctx->dev, "%s: Wait timeout\n", __func__);
 		ret = -EIO;
@@ -173,8 +176,12 @@ int skl_cldma_wait_interruptible(struct sst_dsp *ctx)
 	if (ctx->cl_dev.wake_status != SKL_CL_DMA_BUF_COMPLETE) {
 		dev_err(ctx->dev, "%s: DMA Error\n", __func__);
 		ret = -EIO;
+		goto cleanup;
 	}
 
+	if (ctx->cl_dev.frags_queued)
+		ctx->cl_dev.frags_queued--;
+
 cleanup:
 	ctx->cl_dev.wake_status = SKL_CL_DMA_STATUS_NONE;
 	return ret;
@@ -183,43 +190,40 @@ cleanup:
 static void skl_cldma_stop(struct sst_dsp *ctx)
 {
 	skl_cldma_stream_run(ctx, false);
+
+	/* the next transfer starts with an idle ring */
+	ctx->cl_dev.frags_queued = 0;
+	atomic_set(&ctx->cl_dev.frags_done, 0);
 }
 
+/*
+ * Copy @size bytes to the ring at the current write position and move
+ * the SPIB past them. A chunk never crosses a fragment boundary, so the
+ * copy never wraps.
+ */
 static void skl_cldma_fill_buffer(struct sst_dsp *ctx, unsigned int size,
 		const void *curr_pos, bool intr_enable, bool trigger)
 {
 	dev_dbg(ctx->dev, "Size: %x, intr_enable: %d\n", size, intr_enable);
 	dev_dbg(ctx->dev, "buf_pos_index:%d, trigger:%d\n",
 			ctx->cl_dev.dma_buffer_offset, trigger);
-	dev_dbg(ctx->dev, "spib position: %d\n", ctx->cl_dev.curr_spib_pos);
-
-	/*
-	 * Check if the size exceeds buffer boundary. If it exceeds
-	 * max_buffer size, then copy till buffer size and then copy
-	 * remaining buffer from the start of ring buffer.
-	 */
-	if (ctx->cl_dev.dma_buffer_offset + size > ctx->cl_dev.bufsize) {
-		unsigned int size_b = ctx->cl_dev.bufsize -
-					ctx->cl_dev.dma_buffer_offset;
-		memcpy(ctx->cl_dev.dmab_data.area + ctx->cl_dev.dma_buffer_offset,
-			curr_pos, size_b);
-		size -= size_b;
-		curr_pos += size_b;
-		ctx->cl_dev.dma_buffer_offset = 0;
-	}
 
 	memcpy(ctx->cl_dev.dmab_data.area + ctx->cl_dev.dma_buffer_offset,
 			curr_pos, size);
 
+	/* dma transfers only till the write pointer as updated in spib */
+	ctx->cl_dev.curr_spib_pos = ctx->cl_dev.dma_buffer_offset + size;
 	if (ctx->cl_dev.curr_spib_pos == ctx->cl_dev.bufsize)
 		ctx->cl_dev.dma_buffer_offset = 0;
 	else
 		ctx->cl_dev.dma_buffer_offset = ctx->cl_dev.curr_spib_pos;
 
-	ctx->cl_dev.wait_condition = false;
+	dev_dbg(ctx->dev, "spib position: %d\n", ctx->cl_dev.curr_spib_pos);
 
 	if (intr_enable)
 		skl_cldma_int_enable(ctx);
+	else
+		skl_cldma_int_disable(ctx);
 
 	ctx->cl_dev.ops.cl_setup_spb(ctx, ctx->cl_dev.curr_spib_pos, trigger);
 	if (trigger)
@@ -230,27 +234,35 @@ static void skl_cldma_fill_buffer(struct sst_dsp *ctx, unsigned int size,
  * The CL dma doesn't have any way to update the transfer status until a BDL
  * buffer is fully transferred
  *
+ * The ring is split in SKL_CL_NUM_FRAGS fragments, each completing with an
+ * interrupt, so that a fragment is filled while the DMA transfers the
+ * others, instead of stopping the DMA on each refill.
+ *
  * So Copying is divided in two parts.
- * 1. Interrupt on buffer done where the size to be transferred is more than
- *    ring buffer size.
+ * 1. Interrupt on fragment done where the size left to be transferred is
+ *    more than a fragment. Each free fragment is filled, and once all of
+ *    them are queued a fragment completion is needed to go on.
  * 2. Polling on fw register to identify if data left to transferred doesn't
- *    fill the ring buffer. Caller takes care of polling the required status
+ *    fill a fragment. Caller takes care of polling the required status
  *    register to identify the transfer status.
- * 3. if wait flag is set, waits for DBL interrupt to copy the next chunk till
- *    bytes_left is 0.
- *    if wait flag is not set, doesn't wait for BDL interrupt. after ccopying
- *    the first chunk return the no of bytes_left to be copied.
+ * 3. if wait flag is set, waits for the fragment interrupts to copy the
+ *    next chunks till bytes_left is 0.
+ *    if wait flag is not set, doesn't wait for fragment interrupts. after
+ *    filling the free fragments return the no of bytes_left to be copied,
+ *    the caller waits with skl_cldma_wait_interruptible() before copying
+ *    the next chunk.
  */
 static int
 skl_cldma_copy_to_buf(struct sst_dsp *ctx, const void *bin,
 			u32 total_size, bool wait)
 {
-	int ret = 0;
-	bool start = true;
-	unsigned int excess_bytes;
-	u32 size;
+	struct skl_cl_dev *cl = &ctx->cl_dev;
 	unsigned int bytes_left = total_size;
 	const void *curr_pos = bin;
+	unsigned int room;
+	bool trigger;
+	u32 size;
+	int ret;
 
 	if (total_size <= 0)
 		return -EINVAL;
@@ -258,47 +270,39 @@ skl_cldma_copy_to_buf(struct sst_dsp *ctx, const void *bin,
 	dev_dbg(ctx->dev, "%s: Total binary size: %u\n", __func__, bytes_left);
 
 	while (bytes_left) {
-		if (bytes_left > ctx->cl_dev.bufsize) {
-
-			/*
-			 * dma transfers only till the write pointer as
-			 * updated in spib
-			 */
-			if (ctx->cl_dev.curr_spib_pos == 0)
-				ctx->cl_dev.curr_spib_pos = ctx->cl_dev.bufsize;
-
-			size = ctx->cl_dev.bufsize;
-			skl_cldma_fill_buffer(ctx, size, curr_pos, true, start);
-
-			if (wait) {
-				start = false;
-				ret = skl_cldma_wait_interruptible(ctx);
-				if (ret < 0) {
-					skl_cldma_stop(ctx);
-					return ret;
-				}
-			}
-		} else {
-			skl_cldma_int_disable(ctx);
-
-			if ((ctx->cl_dev.curr_spib_pos + bytes_left)
-							<= ctx->cl_dev.bufsize) {
-				ctx->cl_dev.curr_spib_pos += bytes_left;
-			} else {
-				excess_bytes = bytes_left -
-					(ctx->cl_dev.bufsize -
-					ctx->cl_dev.curr_spib_pos);
-				ctx->cl_dev.curr_spib_pos = excess_bytes;
+		if (cl->frags_queued == SKL_CL_NUM_FRAGS) {
+			if (!wait)
+				return bytes_left;
+
+			ret = skl_cldma_wait_interruptible(ctx);
+			if (ret < 0) {
+				skl_cldma_stop(ctx);
+				return ret;
 			}
+		}
+
+		/* the DMA is idle until the first fragment is queued */
+		trigger = !cl->frags_queued;
+
+		/*
+		 * the previous transfer may have stopped within a fragment,
+		 * only fill up to its end
+		 */
+		room = cl->frag_size - cl->dma_buffer_offset % cl->frag_size;
 
+		if (bytes_left > room) {
+			size = room;
+			cl->frags_queued++;
+			skl_cldma_fill_buffer(ctx, size, curr_pos, true,
+					      trigger);
+		} else {
 			size = bytes_left;
-			skl_cldma_fill_buffer(ctx, size,
-					curr_pos, false, start);
+			skl_cldma_fill_buffer(ctx, size, curr_pos, false,
+					      trigger);
 		}
+
 		bytes_left -= size;
 		curr_pos = curr_pos + size;
-		if (!wait)
-			return bytes_left;
 	}
 
 	return bytes_left;
@@ -313,10 +317,10 @@ void skl_cldma_process_intr(struct sst_dsp *ctx)
 
 	if (!(cl_dma_intr_status & SKL_CL_DMA_SD_INT_COMPLETE))
 		ctx->cl_dev.wake_status = SKL_CL_DMA_ERR;
-	else
+	else if (ctx->cl_dev.wake_status != SKL_CL_DMA_ERR)
 		ctx->cl_dev.wake_status = SKL_CL_DMA_BUF_COMPLETE;
 
-	ctx->cl_dev.wait_condition = true;
+	atomic_inc(&ctx->cl_dev.frags_done);
 	wake_up(&ctx->cl_dev.wait_queue);
 }
 
@@ -326,6 +330,7 @@ int skl_cldma_prepare(struct sst_dsp *ctx)
 	__le32 *bdl;
 
 	ctx->cl_dev.bufsize = SKL_MAX_BUFFER_SIZE;
+	ctx->cl_dev.frag_size = SKL_MAX_BUFFER_SIZE / SKL_CL_NUM_FRAGS;
 
 	/* Allocate cl ops */
 	ctx->cl_dev.ops.cl_setup_bdle = skl_cldma_setup_bdle;
@@ -362,6 +367,8 @@ int skl_cldma_prepare(struct sst_dsp *ctx)
 
 	ctx->cl_dev.curr_spib_pos = 0;
 	ctx->cl_dev.dma_buffer_offset = 0;
+	ctx->cl_dev.frags_queued = 0;
+	atomic_set(&ctx->cl_dev.frags_done, 0);
 	init_waitqueue_head(&ctx->cl_dev.wait_queue);
 
 	return ret;
@@ -183,6 +183,8 @@
 /* SST IPC SKL defines */
 #define SKL_WAIT_TIMEOUT		500	/* 500 msec */
 #define SKL_MAX_BUFFER_SIZE		(32 * PAGE_SIZE)
+/* the ring is split in fragments, one filled while the other is sent */
+#define SKL_CL_NUM_FRAGS		2
 
 enum skl_cl_dma_wake_states {
 	SKL_CL_DMA_STATUS_NONE = 0,
@@ -215,13 +217,15 @@ struct skl_cl_dev_ops {
  * @dmab_data: buffer pointer
  * @dmab_bdl: buffer descriptor list
  * @bufsize: ring buffer size
+ * @frag_size: size of a ring buffer fragment, one per buffer descriptor
  * @frags: Last valid buffer descriptor index in the BDL
+ * @frags_queued: fragments filled and not yet transferred
  * @curr_spib_pos: Current position in ring buffer
  * @dma_buffer_offset: dma buffer offset
  * @ops: operations supported on CL dma
  * @wait_queue: wait queue to wake for wake event
  * @wake_status: DMA wake status
- * @wait_condition: condition to wait on wait queue
+ * @frags_done: fragments transferred and not yet waited for
  * @cl_dma_lock: for synchronized access to cldma
  */
 struct skl_cl_dev {
@@ -229,7 +233,9 @@ struct skl_cl_dev {
 	struct snd_dma_buffer dmab_bdl;
 
 	unsigned int bufsize;
+	unsigned int frag_size;
 	unsigned int frags;
+	unsigned int frags_queued;
 
 	unsigned int curr_spib_pos;
 	unsigned int dma_buffer_offset;
@@ -237,7 +243,7 @@ struct skl_cl_dev {
 
 	wait_queue_head_t wait_queue;
 	int wake_status;
-	bool wait_condition;
+	atomic_t frags_done;
 };
 
 #endif /* SKL_SST_CLDMA_H_ */
@@ -179,6 +179,7 @@ struct uuid_module {
 	int *instance_id;
 
 	struct list_head list;
+	struct hlist_node hnode;
 };
 
 struct skl_load_module_info {
@@ -235,6 +236,8 @@ void bxt_sst_dsp_cleanup(struct device *dev, struct skl_dev *skl);
 
 int snd_skl_parse_uuids(struct sst_dsp *ctx, const struct firmware *fw,
 				unsigned int offset, int index);
+struct uuid_module *skl_find_uuid_module(struct skl_dev *skl,
+					 const guid_t *uuid);
 int skl_get_pvt_id(struct skl_dev *skl, guid_t *uuid_mod, int instance_id);
 int skl_put_pvt_id(struct skl_dev *skl, guid_t *uuid_mod, int *pvt_id);
 int skl_get_pvt_instance_id_map(struct skl_dev *skl,
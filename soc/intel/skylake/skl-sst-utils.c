@@ -6,6 +6,7 @@
  */
 
 #include <linux/device.h>
+#include <linux/jhash.h>
 #include <linux/slab.h>
 #include <linux/uuid.h>
 #include "../common/sst-dsp.h"
@@ -159,6 +160,55 @@ static inline int skl_pvtid_128(struct uuid_module *module)
 	return -EINVAL;
 }
 
+static u32 skl_uuid_key(const guid_t *uuid)
+{
+	return jhash(uuid, sizeof(*uuid), 0);
+}
+
+/* keep the manifest order within a bucket, the first match is used */
+static void skl_uuid_hash_add(struct skl_dev *skl, struct uuid_module *module)
+{
+	struct hlist_head *head;
+	struct hlist_node *last = NULL, *node;
+
+	head = &skl->uuid_hash[hash_min(skl_uuid_key(&module->uuid),
+					HASH_BITS(skl->uuid_hash))];
+	hlist_for_each(node, head)
+		last = node;
+
+	if (last)
+		hlist_add_behind(&module->hnode, last);
+	else
+		hlist_add_head(&module->hnode, head);
+}
+
+/* walk the modules of the firmware manifests matching @uuid */
+#define skl_for_each_uuid_module(skl, module, uuid)			\
+	hash_for_each_possible((skl)->uuid_hash, module, hnode,		\
+			       skl_uuid_key(uuid))			\
+		if (guid_equal(uuid, &(module)->uuid))
+
+/**
+ * skl_find_uuid_module: find the firmware module of a given UUID
+ *
+ * @skl: driver context
+ * @uuid: module's uuid
+ *
+ * Return the first module parsed from the firmware manifests matching
+ * @uuid, or NULL.
+ */
+struct uuid_module *skl_find_uuid_module(struct skl_dev *skl,
+					 const guid_t *uuid)
+{
+	struct uuid_module *module;
+
+	skl_for_each_uuid_module(skl, module, uuid)
+		return module;
+
+	return NULL;
+}
+EXPORT_SYMBOL_GPL(skl_find_uuid_module);
+
 /**
  * skl_get_pvt_id: generate a private id for use as module id
  *
@@ -174,15 +224,12 @@ int skl_get_pvt_id(struct skl_dev *skl, guid_t *uuid_mod, int instance_id)
 	struct uuid_module *module;
 	int pvt_id;
 
-	list_for_each_entry(module, &skl->uuid_list, list) {
-		if (guid_equal(uuid_mod, &module->uuid)) {
-
-			pvt_id = skl_pvtid_128(module);
-			if (pvt_id >= 0) {
-				module->instance_id[pvt_id] = instance_id;
+	skl_for_each_uuid_module(skl, module, uuid_mod) {
+		pvt_id = skl_pvtid_128(module);
+		if (pvt_id >= 0) {
+			module->instance_id[pvt_id] = instance_id;
 
-				return pvt_id;
-			}
+			return pvt_id;
 		}
 	}
 
@@ -204,18 +251,16 @@ int skl_put_pvt_id(struct skl_dev *skl, guid_t *uuid_mod, int *pvt_id)
 	int i;
 	struct uuid_module *module;
 
-	list_for_each_entry(module, &skl->uuid_list, list) {
-		if (guid_equal(uuid_mod, &module->uuid)) {
-
-			if (*pvt_id != 0)
-				i = (*pvt_id) / 64;
-			else
-				i = 0;
+	module = skl_find_uuid_module(skl, uuid_mod);
+	if (module) {
+		if (*pvt_id != 0)
+			i = (*pvt_id) / 64;
+		else
+			i = 0;
 
-			module->pvt_id[i] &= ~(1 << (*pvt_id));
-			*pvt_id = -1;
-			return 0;
-		}
+		module->pvt_id[i] &= ~(1 << (*pvt_id));
+		*pvt_id = -1;
+		return 0;
 	}
 
 	return -EINVAL;
@@ -303,6 +348,7 @@ int snd_skl_parse_uuids(struct sst_dsp *ctx, const struct firmware *fw,
 		}
 
 		list_add_tail(&module->list, &skl->uuid_list);
+		skl_uuid_hash_add(skl, module);
 
 		dev_dbg(ctx->dev,
 			"Adding uuid :%pUL   mod id: %d  Loadable: %d\n",
@@ -322,6 +368,7 @@ void skl_freeup_uuid_list(struct skl_dev *skl)
 
 	list_for_each_entry_safe(uuid, _uuid, &skl->uuid_list, list) {
 		list_del(&uuid->list);
+		hash_del(&uuid->hnode);
 		kfree(uuid);
 	}
 }
@@ -363,6 +410,7 @@ int skl_sst_ctx_init(struct device *dev, int irq, const char *fw_name,
 	skl->dev = dev;
 	skl_dev->thread_context = skl;
 	INIT_LIST_HEAD(&skl->uuid_list);
+	hash_init(skl->uuid_hash);
 	skl->dsp = skl_dsp_ctx_init(dev, skl_dev, irq);
 	if (!skl->dsp) {
 		dev_err(skl->dev, "%s: no device\n", __func__);
@@ -801,12 +801,11 @@ static int skl_get_module_id(struct skl_dev *skl, guid_t *uuid)
 {
 	struct uuid_module *module;
 
-	list_for_each_entry(module, &skl->uuid_list, list) {
-		if (guid_equal(uuid, &module->uuid))
-			return module->id;
-	}
+	module = skl_find_uuid_module(skl, uuid);
+	if (!module)
+		return -EINVAL;
 
-	return -EINVAL;
+	return module->id;
 }
 
 static int skl_tplg_find_moduleid_from_uuid(struct skl_dev *skl,
@@ -1941,6 +1940,19 @@ static int skl_tplg_fill_pipe_tkn(struct device *dev,
 	return 0;
 }
 
+static struct skl_pipeline *skl_tplg_find_pipe(struct skl_dev *skl,
+						int ppl_id)
+{
+	struct skl_pipeline *ppl;
+
+	hash_for_each_possible(skl->ppl_hash, ppl, hnode, ppl_id) {
+		if (ppl->pipe->ppl_id == ppl_id)
+			return ppl;
+	}
+
+	return NULL;
+}
+
 /*
  * Add pipeline by parsing the relevant tokens
  * Return an existing pipe if the pipe already exists.
@@ -1953,11 +1965,10 @@ static int skl_tplg_add_pipe(struct device *dev,
 	struct skl_pipe *pipe;
 	struct skl_pipe_params *params;
 
-	list_for_each_entry(ppl, &skl->ppl_list, node) {
-		if (ppl->pipe->ppl_id == tkn_elem->value) {
-			mconfig->pipe = ppl->pipe;
-			return -EEXIST;
-		}
+	ppl = skl_tplg_find_pipe(skl, tkn_elem->value);
+	if (ppl) {
+		mconfig->pipe = ppl->pipe;
+		return -EEXIST;
 	}
 
 	ppl = devm_kzalloc(dev, sizeof(*ppl), GFP_KERNEL);
@@ -1978,6 +1989,7 @@ static int skl_tplg_add_pipe(struct device *dev,
 
 	ppl->pipe = pipe;
 	list_add(&ppl->node, &skl->ppl_list);
+	hash_add(skl->ppl_hash, &ppl->hnode, pipe->ppl_id);
 
 	mconfig->pipe = pipe;
 	mconfig->pipe->state = SKL_PIPE_INVALID;
@@ -2607,11 +2619,10 @@ static int skl_tplg_add_pipe_v4(struct device *dev,
 	struct skl_pipe *pipe;
 	struct skl_pipe_params *params;
 
-	list_for_each_entry(ppl, &skl->ppl_list, node) {
-		if (ppl->pipe->ppl_id == dfw_pipe->pipe_id) {
-			mconfig->pipe = ppl->pipe;
-			return 0;
-		}
+	ppl = skl_tplg_find_pipe(skl, dfw_pipe->pipe_id);
+	if (ppl) {
+		mconfig->pipe = ppl->pipe;
+		return 0;
 	}
 
 	ppl = devm_kzalloc(dev, sizeof(*ppl), GFP_KERNEL);
@@ -2636,6 +2647,7 @@ static int skl_tplg_add_pipe_v4(struct device *dev,
 
 	ppl->pipe = pipe;
 	list_add(&ppl->node, &skl->ppl_list);
+	hash_add(skl->ppl_hash, &ppl->hnode, pipe->ppl_id);
 
 	mconfig->pipe = pipe;
 
@@ -3606,8 +3618,10 @@ void skl_tplg_exit(struct snd_soc_component *component, struct hdac_bus *bus)
 	struct skl_pipeline *ppl, *tmp;
 
 	if (!list_empty(&skl->ppl_list))
-		list_for_each_entry_safe(ppl, tmp, &skl->ppl_list, node)
+		list_for_each_entry_safe(ppl, tmp, &skl->ppl_list, node) {
 			list_del(&ppl->node);
+			hash_del(&ppl->hnode);
+		}
 
 	/* clean up topology */
 	snd_soc_tplg_component_remove(component, SND_SOC_TPLG_INDEX_ALL);
@@ -417,6 +417,7 @@ struct skl_algo_data {
 struct skl_pipeline {
 	struct skl_pipe *pipe;
 	struct list_head node;
+	struct hlist_node hnode;
 };
 
 struct skl_module_deferred_bind {
@@ -881,6 +881,7 @@ static int skl_create(struct pci_dev *pci,
 	bus = skl_to_bus(skl);
 
 	INIT_LIST_HEAD(&skl->ppl_list);
+	hash_init(skl->ppl_hash);
 	INIT_LIST_HEAD(&skl->bind_list);
 
 #if IS_ENABLED(CONFIG_SND_SOC_INTEL_SKYLAKE_HDAUDIO_CODEC)
@@ -1025,6 +1026,10 @@ static int skl_probe(struct pci_dev *pci,
 #endif
 	} else {
 
+		err = skl_nhlt_build_index(skl);
+		if (err < 0)
+			goto out_nhlt_free;
+
 		err = skl_nhlt_create_sysfs(skl);
 		if (err < 0) {
 			dev_err(bus->dev, "skl_nhlt_create_sysfs failed with err: %d\n", err);
@@ -12,6 +12,7 @@
 #ifndef __SOUND_SOC_SKL_H
 #define __SOUND_SOC_SKL_H
 
+#include <linux/hashtable.h>
 #include <sound/hda_register.h>
 #include <sound/hdaudio_ext.h>
 #include <sound/hda_codec.h>
@@ -40,6 +41,10 @@
 #define AZX_VS_EM2_DUM			BIT(23)
 #define AZX_REG_VS_EM2_L1SEN		BIT(13)
 
+/* lookup tables of the pipelines by id and of the modules by UUID */
+#define SKL_PPL_HASH_BITS		4
+#define SKL_UUID_HASH_BITS		5
+
 struct skl_debug;
 
 struct skl_astate_param {
@@ -56,6 +61,24 @@ struct skl_fw_config {
 	struct skl_astate_config *astate_cfg;
 };
 
+/* NHLT format of an endpoint, as matched by skl_get_ep_blob() */
+struct skl_nhlt_fmt {
+	u16 channels;
+	u16 bps;
+	u32 rate;
+	struct nhlt_specific_cfg *cfg;
+};
+
+/* NHLT endpoint, with its formats resolved once at probe */
+struct skl_nhlt_ep {
+	u32 vbus_id;
+	u8 linktype;
+	u8 direction;
+	u8 device_type;
+	unsigned int num_fmts;
+	struct skl_nhlt_fmt *fmts;
+};
+
 struct skl_dev {
 	struct hda_bus hbus;
 	struct pci_dev *pci;
@@ -68,8 +91,11 @@ struct skl_dev {
 	struct snd_soc_dai_driver *dais;
 
 	struct nhlt_acpi_table *nhlt; /* nhlt ptr */
+	struct skl_nhlt_ep *nhlt_eps;
+	unsigned int nhlt_num_eps;
 
 	struct list_head ppl_list;
+	DECLARE_HASHTABLE(ppl_hash, SKL_PPL_HASH_BITS);
 	struct list_head bind_list;
 
 	const char *fw_name;
@@ -109,6 +135,7 @@ struct skl_dev {
 
 	/* Populate module information */
 	struct list_head uuid_list;
+	DECLARE_HASHTABLE(uuid_hash, SKL_UUID_HASH_BITS);
 
 	/* Is firmware loaded */
 	bool fw_loaded;
@@ -170,6 +197,7 @@ struct nhlt_specific_cfg *skl_get_ep_blob(struct skl_dev *skl, u32 instance,
 					u32 s_rate, u8 dirn, u8 dev_type);
 
 int skl_nhlt_update_topology_bin(struct skl_dev *skl);
+int skl_nhlt_build_index(struct skl_dev *skl);
 int skl_init_dsp(struct skl_dev *skl);
 int skl_free_dsp(struct skl_dev *skl);
 int skl_suspend_late_dsp(struct skl_dev *skl);
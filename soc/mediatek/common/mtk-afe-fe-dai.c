@@ -46,6 +46,8 @@ int mtk_afe_fe_startup(struct snd_pcm_substream *substream,
 	int ret;
 
 	memif->substream = substream;
+	memif->irq_cnt = -1;
+	memif->irq_fs = -1;
 
 	snd_pcm_hw_constraint_step(substream->runtime, 0,
 				   SNDRV_PCM_HW_PARAM_BUFFER_BYTES, 16);
@@ -85,6 +87,8 @@ int mtk_afe_fe_startup(struct snd_pcm_substream *substream,
 		if (irq_id != afe->irqs_size) {
 			/* link */
 			memif->irq_usage = irq_id;
+			memif->irq_cnt = -1;
+			memif->irq_fs = -1;
 		} else {
 			dev_err(afe->dev, "%s() error: no more asys irq\n",
 				__func__);
@@ -219,20 +223,37 @@ int mtk_afe_fe_trigger(struct snd_pcm_substream *substream, int cmd,
 			return ret;
 		}
 
-		/* set irq counter */
-		mtk_regmap_update_bits(afe->regmap, irq_data->irq_cnt_reg,
-				       irq_data->irq_cnt_maskbit, counter,
-				       irq_data->irq_cnt_shift);
+		/*
+		 * The irq counter and fs only change with hw_params, only
+		 * program them when they differ from the last values written.
+		 */
+		if (memif->irq_cnt != (int)counter) {
+			mtk_regmap_update_bits(afe->regmap,
+					       irq_data->irq_cnt_reg,
+					       irq_data->irq_cnt_maskbit,
+					       counter,
+					       irq_data->irq_cnt_shift);
+			memif->irq_cnt = counter;
+		}
 
-		/* set irq fs */
 		fs = afe->irq_fs(substream, runtime->rate);
 
 		if (fs < 0)
 			return -EINVAL;
 
-		mtk_regmap_update_bits(afe->regmap, irq_data->irq_fs_reg,
-				       irq_data->irq_fs_maskbit, fs,
-				       irq_data->irq_fs_shift);
+		if (memif->irq_fs != fs) {
+			mtk_regmap_update_bits(afe->regmap,
+					       irq_data->irq_fs_reg,
+					       irq_data->irq_fs_maskbit, fs,
+					       irq_data->irq_fs_shift);
+			memif->irq_fs = fs;
+		}
+
+		/* route the irq status bit to this memif for the ISR */
+		if (irq_data->irq_en_shift >= 0 &&
+		    irq_data->irq_en_shift < MTK_AFE_IRQ_BITS)
+			WRITE_ONCE(afe->irq_memif[irq_data->irq_en_shift],
+				   memif);
 
 		/* enable interrupt */
 		mtk_regmap_update_bits(afe->regmap, irq_data->irq_en_reg,
@@ -363,6 +384,12 @@ int mtk_afe_resume(struct snd_soc_component *component)
 		mtk_regmap_write(regmap, afe->reg_back_up_list[i],
 				 afe->reg_back_up[i]);
 
+	/* the irq settings may not have survived, program them again */
+	for (i = 0; i < afe->memif_size; i++) {
+		afe->memif[i].irq_cnt = -1;
+		afe->memif[i].irq_fs = -1;
+	}
+
 	afe->suspended = false;
 	return 0;
 }
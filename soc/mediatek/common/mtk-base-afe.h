@@ -10,6 +10,7 @@
 #define _MTK_BASE_AFE_H_
 
 #define MTK_STREAM_NUM (SNDRV_PCM_STREAM_LAST + 1)
+#define MTK_AFE_IRQ_BITS 32
 
 struct mtk_base_memif_data {
 	int id;
@@ -91,6 +92,8 @@ struct mtk_base_afe {
 	int memif_size;
 	struct mtk_base_afe_irq *irqs;
 	int irqs_size;
+	/* memif by irq enable bit, set on trigger for the ISR dispatch */
+	struct mtk_base_afe_memif *irq_memif[MTK_AFE_IRQ_BITS];
 
 	struct list_head sub_dais;
 	struct snd_soc_dai_driver *dai_drivers;
@@ -121,6 +124,9 @@ struct mtk_base_afe_memif {
 	unsigned char *dma_area;
 	dma_addr_t dma_addr;
 	size_t dma_bytes;
+	/* irq counter and fs last programmed, -1 if unknown */
+	int irq_cnt;
+	int irq_fs;
 };
 
 struct mtk_base_afe_irq {
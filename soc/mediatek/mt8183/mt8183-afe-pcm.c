@@ -927,15 +927,16 @@ static const struct regmap_config mt8183_afe_regmap_config = {
 static irqreturn_t mt8183_afe_irq_handler(int irq_id, void *dev)
 {
 	struct mtk_base_afe *afe = dev;
-	struct mtk_base_afe_irq *irq;
+	struct mtk_base_afe_memif *memif;
 	unsigned int status;
 	unsigned int status_mcu;
+	unsigned long pending;
 	unsigned int mcu_en;
 	int ret;
 	int i;
 	irqreturn_t irq_ret = IRQ_HANDLED;
 
-	/* get irq that is sent to MCU */
+	/* get irq that is sent to MCU, served from the register cache */
 	regmap_read(afe->regmap, AFE_IRQ_MCU_EN, &mcu_en);
 
 	ret = regmap_read(afe->regmap, AFE_IRQ_MCU_STATUS, &status);
@@ -950,18 +951,15 @@ static irqreturn_t mt8183_afe_irq_handler(int irq_id, void *dev)
 		goto err_irq;
 	}
 
-	for (i = 0; i < MT8183_MEMIF_NUM; i++) {
-		struct mtk_base_afe_memif *memif = &afe->memif[i];
+	/* only visit the memifs whose irq fired */
+	pending = status_mcu;
+	for_each_set_bit(i, &pending, MTK_AFE_IRQ_BITS) {
+		memif = READ_ONCE(afe->irq_memif[i]);
 
-		if (!memif->substream)
+		if (!memif || !memif->substream || memif->irq_usage < 0)
 			continue;
 
-		if (memif->irq_usage < 0)
-			continue;
-
-		irq = &afe->irqs[memif->irq_usage];
-
-		if (status_mcu & (1 << irq->irq_data->irq_en_shift))
+		if (afe->irqs[memif->irq_usage].irq_data->irq_en_shift == i)
 			snd_pcm_period_elapsed(memif->substream);
 	}
 
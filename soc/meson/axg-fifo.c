@@ -27,7 +27,8 @@ static struct snd_pcm_hardware axg_fifo_hw = {
 		 SNDRV_PCM_INFO_MMAP |
 		 SNDRV_PCM_INFO_MMAP_VALID |
 		 SNDRV_PCM_INFO_BLOCK_TRANSFER |
-		 SNDRV_PCM_INFO_PAUSE),
+		 SNDRV_PCM_INFO_PAUSE |
+		 SNDRV_PCM_INFO_NO_PERIOD_WAKEUP),
 
 	.formats = AXG_FIFO_FORMATS,
 	.rate_min = 5512,
@@ -113,11 +114,18 @@ int axg_fifo_pcm_hw_params(struct snd_soc_component *component,
 {
 	struct snd_pcm_runtime *runtime = ss->runtime;
 	struct axg_fifo *fifo = axg_fifo_data(ss);
-	unsigned int burst_num, period, threshold;
+	unsigned int burst_num, period, threshold, irq_en;
 	dma_addr_t end_ptr;
 
 	period = params_period_bytes(params);
 
+	/* runtime->no_period_wakeup is only set after hw_params returns */
+	if ((params->info & SNDRV_PCM_INFO_NO_PERIOD_WAKEUP) &&
+	    (params->flags & SNDRV_PCM_HW_PARAMS_NO_PERIOD_WAKEUP))
+		irq_en = 0;
+	else
+		irq_en = CTRL0_INT_EN(FIFO_INT_COUNT_REPEAT);
+
 	/* Setup dma memory pointers */
 	end_ptr = runtime->dma_addr + runtime->dma_bytes - AXG_FIFO_BURST;
 	regmap_write(fifo->map, FIFO_START_ADDR, runtime->dma_addr);
@@ -142,10 +150,9 @@ int axg_fifo_pcm_hw_params(struct snd_soc_component *component,
 	regmap_field_write(fifo->field_threshold,
 			   threshold ? threshold - 1 : 0);
 
-	/* Enable block count irq */
+	/* Enable block count irq, unless period wakeups are not wanted */
 	regmap_update_bits(fifo->map, FIFO_CTRL0,
-			   CTRL0_INT_EN(FIFO_INT_COUNT_REPEAT),
-			   CTRL0_INT_EN(FIFO_INT_COUNT_REPEAT));
+			   CTRL0_INT_EN(FIFO_INT_COUNT_REPEAT), irq_en);
 
 	return 0;
 }
@@ -31,7 +31,8 @@ static const struct snd_pcm_hardware lpass_platform_pcm_hardware = {
 					SNDRV_PCM_INFO_MMAP_VALID |
 					SNDRV_PCM_INFO_INTERLEAVED |
 					SNDRV_PCM_INFO_PAUSE |
-					SNDRV_PCM_INFO_RESUME,
+					SNDRV_PCM_INFO_RESUME |
+					SNDRV_PCM_INFO_NO_PERIOD_WAKEUP,
 	.formats		=	SNDRV_PCM_FMTBIT_S16 |
 					SNDRV_PCM_FMTBIT_S24 |
 					SNDRV_PCM_FMTBIT_S32,
@@ -297,9 +298,15 @@ static int lpass_platform_pcmops_trigger(struct snd_soc_component *component,
 	struct lpass_pcm_data *pcm_data = rt->private_data;
 	struct lpass_variant *v = drvdata->variant;
 	int ret, ch, dir = substream->stream;
+	unsigned int irqen;
 
 	ch = pcm_data->dma_ch;
 
+	/* without period wakeups only the error interrupts are needed */
+	irqen = LPAIF_IRQ_XRUN(ch) | LPAIF_IRQ_ERR(ch);
+	if (!rt->no_period_wakeup)
+		irqen |= LPAIF_IRQ_PER(ch);
+
 	switch (cmd) {
 	case SNDRV_PCM_TRIGGER_START:
 	case SNDRV_PCM_TRIGGER_RESUME:
@@ -316,8 +323,7 @@ static int lpass_platform_pcmops_trigger(struct snd_soc_component *component,
 
 		ret = regmap_update_bits(drvdata->lpaif_map,
 				LPAIF_IRQEN_REG(v, LPAIF_IRQ_PORT_HOST),
-				LPAIF_IRQ_ALL(ch),
-				LPAIF_IRQ_ALL(ch));
+				LPAIF_IRQ_ALL(ch), irqen);
 		if (ret) {
 			dev_err(soc_runtime->dev,
 				"error writing to irqen reg: %d\n", ret);
@@ -370,19 +376,12 @@ static snd_pcm_uframes_t lpass_platform_pcmops_pointer(
 	struct snd_pcm_runtime *rt = substream->runtime;
 	struct lpass_pcm_data *pcm_data = rt->private_data;
 	struct lpass_variant *v = drvdata->variant;
-	unsigned int base_addr, curr_addr;
+	unsigned int curr_addr;
 	int ret, ch, dir = substream->stream;
 
 	ch = pcm_data->dma_ch;
 
-	ret = regmap_read(drvdata->lpaif_map,
-			LPAIF_DMABASE_REG(v, ch, dir), &base_addr);
-	if (ret) {
-		dev_err(soc_runtime->dev,
-			"error reading from rdmabase reg: %d\n", ret);
-		return ret;
-	}
-
+	/* prepare() programmed the DMA base with rt->dma_addr */
 	ret = regmap_read(drvdata->lpaif_map,
 			LPAIF_DMACURR_REG(v, ch, dir), &curr_addr);
 	if (ret) {
@@ -391,7 +390,8 @@ static snd_pcm_uframes_t lpass_platform_pcmops_pointer(
 		return ret;
 	}
 
-	return bytes_to_frames(substream->runtime, curr_addr - base_addr);
+	return bytes_to_frames(substream->runtime,
+			       curr_addr - (unsigned int)rt->dma_addr);
 }
 
 static int lpass_platform_pcmops_mmap(struct snd_soc_component *component,
@@ -411,59 +411,30 @@ static irqreturn_t lpass_dma_interrupt_handler(
 			int chan, u32 interrupts)
 {
 	struct snd_soc_pcm_runtime *soc_runtime = substream->private_data;
-	struct lpass_variant *v = drvdata->variant;
-	irqreturn_t ret = IRQ_NONE;
-	int rv;
 
-	if (interrupts & LPAIF_IRQ_PER(chan)) {
-		rv = regmap_write(drvdata->lpaif_map,
-				LPAIF_IRQCLEAR_REG(v, LPAIF_IRQ_PORT_HOST),
-				LPAIF_IRQ_PER(chan));
-		if (rv) {
-			dev_err(soc_runtime->dev,
-				"error writing to irqclear reg: %d\n", rv);
-			return IRQ_NONE;
-		}
-		snd_pcm_period_elapsed(substream);
-		ret = IRQ_HANDLED;
+	if (interrupts & LPAIF_IRQ_ERR(chan)) {
+		dev_err(soc_runtime->dev, "bus access error\n");
+		snd_pcm_stop(substream, SNDRV_PCM_STATE_DISCONNECTED);
+		return IRQ_HANDLED;
 	}
 
 	if (interrupts & LPAIF_IRQ_XRUN(chan)) {
-		rv = regmap_write(drvdata->lpaif_map,
-				LPAIF_IRQCLEAR_REG(v, LPAIF_IRQ_PORT_HOST),
-				LPAIF_IRQ_XRUN(chan));
-		if (rv) {
-			dev_err(soc_runtime->dev,
-				"error writing to irqclear reg: %d\n", rv);
-			return IRQ_NONE;
-		}
 		dev_warn(soc_runtime->dev, "xrun warning\n");
 		snd_pcm_stop_xrun(substream);
-		ret = IRQ_HANDLED;
+		return IRQ_HANDLED;
 	}
 
-	if (interrupts & LPAIF_IRQ_ERR(chan)) {
-		rv = regmap_write(drvdata->lpaif_map,
-				LPAIF_IRQCLEAR_REG(v, LPAIF_IRQ_PORT_HOST),
-				LPAIF_IRQ_ERR(chan));
-		if (rv) {
-			dev_err(soc_runtime->dev,
-				"error writing to irqclear reg: %d\n", rv);
-			return IRQ_NONE;
-		}
-		dev_err(soc_runtime->dev, "bus access error\n");
-		snd_pcm_stop(substream, SNDRV_PCM_STATE_DISCONNECTED);
-		ret = IRQ_HANDLED;
-	}
+	if (interrupts & LPAIF_IRQ_PER(chan))
+		snd_pcm_period_elapsed(substream);
 
-	return ret;
+	return IRQ_HANDLED;
 }
 
 static irqreturn_t lpass_platform_lpaif_irq(int irq, void *data)
 {
 	struct lpass_data *drvdata = data;
 	struct lpass_variant *v = drvdata->variant;
-	unsigned int irqs;
+	unsigned int irqs, handled = 0;
 	int rv, chan;
 
 	rv = regmap_read(drvdata->lpaif_map,
@@ -473,15 +444,26 @@ static irqreturn_t lpass_platform_lpaif_irq(int irq, void *data)
 		return IRQ_NONE;
 	}
 
+	for (chan = 0; chan < LPASS_MAX_DMA_CHANNELS; chan++)
+		if (drvdata->substream[chan])
+			handled |= irqs & LPAIF_IRQ_ALL(chan);
+
+	if (!handled)
+		return IRQ_HANDLED;
+
+	/* Clear the status of all the channels at once */
+	rv = regmap_write(drvdata->lpaif_map,
+			LPAIF_IRQCLEAR_REG(v, LPAIF_IRQ_PORT_HOST), handled);
+	if (rv) {
+		pr_err("error writing to irqclear reg: %d\n", rv);
+		return IRQ_NONE;
+	}
+
 	/* Handle per channel interrupts */
 	for (chan = 0; chan < LPASS_MAX_DMA_CHANNELS; chan++) {
-		if (irqs & LPAIF_IRQ_ALL(chan) && drvdata->substream[chan]) {
-			rv = lpass_dma_interrupt_handler(
-						drvdata->substream[chan],
-						drvdata, chan, irqs);
-			if (rv != IRQ_HANDLED)
-				return rv;
-		}
+		if (handled & LPAIF_IRQ_ALL(chan))
+			lpass_dma_interrupt_handler(drvdata->substream[chan],
+						    drvdata, chan, handled);
 	}
 
 	return IRQ_HANDLED;
@@ -34,6 +34,16 @@
 #define ADM_MATRIX_ID_AUDIO_RX		0
 #define ADM_MATRIX_ID_AUDIO_TX		1
 
+/*
+ * Command tokens carry the copp index in bits 0-7 and the AFE port index
+ * in bits 16-23, matrix map commands carry the session id in bits 8-15.
+ */
+#define ADM_TOKEN_COPP_IDX(t)		((t) & 0xFF)
+#define ADM_TOKEN_SESSION(t)		(((t) >> 8) & 0xFF)
+#define ADM_TOKEN_PORT_IDX(t)		(((t) >> 16) & 0xFF)
+/* pending matrix map commands, indexed by session id */
+#define ADM_MAP_SLOTS			16
+
 struct q6copp {
 	int afe_port;
 	int copp_idx;
@@ -47,21 +57,30 @@ struct q6copp {
 	int acdb_id;
 
 	struct aprv2_ibasic_rsp_result_t result;
+	/* one command in flight per copp */
+	struct mutex lock;
 	struct kref refcount;
 	wait_queue_head_t wait;
 	struct list_head node;
 	struct q6adm *adm;
 };
 
+struct q6adm_map_slot {
+	/* one matrix map command in flight per session */
+	struct mutex lock;
+	struct aprv2_ibasic_rsp_result_t result;
+};
+
 struct q6adm {
 	struct apr_device *apr;
 	struct device *dev;
 	struct q6core_svc_api_info ainfo;
 	unsigned long copp_bitmap[AFE_MAX_PORTS];
 	struct list_head copps_list;
+	/* copps by port and copp index, the responses are matched on it */
+	struct q6copp *copps[AFE_MAX_PORTS][MAX_COPPS_PER_PORT];
 	spinlock_t copps_list_lock;
-	struct aprv2_ibasic_rsp_result_t result;
-	struct mutex lock;
+	struct q6adm_map_slot map[ADM_MAP_SLOTS];
 	wait_queue_head_t matrix_map_wait;
 };
 
@@ -90,22 +109,20 @@ struct q6adm_session_map_node_v5 {
 static struct q6copp *q6adm_find_copp(struct q6adm *adm, int port_idx,
 				  int copp_idx)
 {
-	struct q6copp *c = NULL;
-	struct q6copp *ret = NULL;
+	struct q6copp *c;
 	unsigned long flags;
 
-	spin_lock_irqsave(&adm->copps_list_lock, flags);
-	list_for_each_entry(c, &adm->copps_list, node) {
-		if ((port_idx == c->afe_port) && (copp_idx == c->copp_idx)) {
-			ret = c;
-			kref_get(&c->refcount);
-			break;
-		}
-	}
+	if (port_idx < 0 || port_idx >= AFE_MAX_PORTS ||
+	    copp_idx < 0 || copp_idx >= MAX_COPPS_PER_PORT)
+		return NULL;
 
+	spin_lock_irqsave(&adm->copps_list_lock, flags);
+	c = adm->copps[port_idx][copp_idx];
+	if (c && !kref_get_unless_zero(&c->refcount))
+		c = NULL;
 	spin_unlock_irqrestore(&adm->copps_list_lock, flags);
 
-	return ret;
+	return c;
 
 }
 
@@ -117,6 +134,7 @@ static void q6adm_free_copp(struct kref *ref)
 
 	spin_lock_irqsave(&adm->copps_list_lock, flags);
 	clear_bit(c->copp_idx, &adm->copp_bitmap[c->afe_port]);
+	adm->copps[c->afe_port][c->copp_idx] = NULL;
 	list_del(&c->node);
 	spin_unlock_irqrestore(&adm->copps_list_lock, flags);
 	kfree(c);
@@ -129,12 +147,13 @@ static int q6adm_callback(struct apr_device *adev, struct apr_resp_pkt *data)
 	struct apr_hdr *hdr = &data->hdr;
 	struct q6copp *copp;
 	struct q6adm *adm = dev_get_drvdata(&adev->dev);
+	struct q6adm_map_slot *slot;
 
 	if (!data->payload_size)
 		return 0;
 
-	copp_idx = (hdr->token) & 0XFF;
-	port_idx = ((hdr->token) >> 16) & 0xFF;
+	copp_idx = ADM_TOKEN_COPP_IDX(hdr->token);
+	port_idx = ADM_TOKEN_PORT_IDX(hdr->token);
 	if (port_idx < 0 || port_idx >= AFE_MAX_PORTS) {
 		dev_err(&adev->dev, "Invalid port idx %d token %d\n",
 		       port_idx, hdr->token);
@@ -164,7 +183,9 @@ static int q6adm_callback(struct apr_device *adev, struct apr_resp_pkt *data)
 			kref_put(&copp->refcount, q6adm_free_copp);
 			break;
 		case ADM_CMD_MATRIX_MAP_ROUTINGS_V5:
-			adm->result = *result;
+			slot = &adm->map[ADM_TOKEN_SESSION(hdr->token) %
+					 ADM_MAP_SLOTS];
+			slot->result = *result;
 			wake_up(&adm->matrix_map_wait);
 			break;
 
@@ -217,7 +238,7 @@ static struct q6copp *q6adm_alloc_copp(struct q6adm *adm, int port_idx)
 	idx = find_first_zero_bit(&adm->copp_bitmap[port_idx],
 				  MAX_COPPS_PER_PORT);
 
-	if (idx > MAX_COPPS_PER_PORT)
+	if (idx >= MAX_COPPS_PER_PORT)
 		return ERR_PTR(-EBUSY);
 
 	c = kzalloc(sizeof(*c), GFP_ATOMIC);
@@ -229,6 +250,7 @@ static struct q6copp *q6adm_alloc_copp(struct q6adm *adm, int port_idx)
 	c->afe_port = port_idx;
 	c->adm = adm;
 
+	mutex_init(&c->lock);
 	init_waitqueue_head(&c->wait);
 
 	return c;
@@ -241,7 +263,7 @@ static int q6adm_apr_send_copp_pkt(struct q6adm *adm, struct q6copp *copp,
 	uint32_t opcode = pkt->hdr.opcode;
 	int ret;
 
-	mutex_lock(&adm->lock);
+	mutex_lock(&copp->lock);
 	copp->result.opcode = 0;
 	copp->result.status = 0;
 	ret = apr_send_pkt(adm->apr, pkt);
@@ -272,7 +294,7 @@ static int q6adm_apr_send_copp_pkt(struct q6adm *adm, struct q6copp *copp,
 	}
 
 err:
-	mutex_unlock(&adm->lock);
+	mutex_unlock(&copp->lock);
 	return ret;
 }
 
@@ -389,7 +411,7 @@ struct q6copp *q6adm_open(struct device *dev, int port_id, int path, int rate,
 	unsigned long flags;
 	int ret = 0;
 
-	if (port_id < 0) {
+	if (port_id < 0 || port_id >= AFE_MAX_PORTS) {
 		dev_err(dev, "Invalid port_id 0x%x\n", port_id);
 		return ERR_PTR(-EINVAL);
 	}
@@ -408,10 +430,11 @@ struct q6copp *q6adm_open(struct device *dev, int port_id, int path, int rate,
 		return ERR_CAST(copp);
 	}
 
+	kref_init(&copp->refcount);
 	list_add_tail(&copp->node, &adm->copps_list);
+	adm->copps[port_id][copp->copp_idx] = copp;
 	spin_unlock_irqrestore(&adm->copps_list_lock, flags);
 
-	kref_init(&copp->refcount);
 	copp->topology = topology;
 	copp->mode = perf_mode;
 	copp->rate = rate;
@@ -463,6 +486,7 @@ int q6adm_matrix_map(struct device *dev, int path,
 	struct q6adm *adm = dev_get_drvdata(dev->parent);
 	struct q6adm_cmd_matrix_map_routings_v5 *route;
 	struct q6adm_session_map_node_v5 *node;
+	struct q6adm_map_slot *slot;
 	struct apr_pkt *pkt;
 	uint16_t *copps_list;
 	int pkt_size, ret, i, copp_idx;
@@ -486,7 +510,7 @@ int q6adm_matrix_map(struct device *dev, int path,
 					   APR_HDR_LEN(APR_HDR_SIZE),
 					   APR_PKT_VER);
 	pkt->hdr.pkt_size = pkt_size;
-	pkt->hdr.token = 0;
+	pkt->hdr.token = (payload_map.session_id & 0xFF) << 8;
 	pkt->hdr.opcode = ADM_CMD_MATRIX_MAP_ROUTINGS_V5;
 	route->num_sessions = 1;
 
@@ -526,9 +550,10 @@ int q6adm_matrix_map(struct device *dev, int path,
 		kref_put(&copp->refcount, q6adm_free_copp);
 	}
 
-	mutex_lock(&adm->lock);
-	adm->result.status = 0;
-	adm->result.opcode = 0;
+	slot = &adm->map[ADM_TOKEN_SESSION(pkt->hdr.token) % ADM_MAP_SLOTS];
+	mutex_lock(&slot->lock);
+	slot->result.status = 0;
+	slot->result.opcode = 0;
 
 	ret = apr_send_pkt(adm->apr, pkt);
 	if (ret < 0) {
@@ -537,22 +562,22 @@ int q6adm_matrix_map(struct device *dev, int path,
 		goto fail_cmd;
 	}
 	ret = wait_event_timeout(adm->matrix_map_wait,
-				 adm->result.opcode == pkt->hdr.opcode,
+				 slot->result.opcode == pkt->hdr.opcode,
 				 msecs_to_jiffies(TIMEOUT_MS));
 	if (!ret) {
 		dev_err(dev, "routing for stream %d failed\n",
 		       payload_map.session_id);
 		ret = -ETIMEDOUT;
 		goto fail_cmd;
-	} else if (adm->result.status > 0) {
+	} else if (slot->result.status > 0) {
 		dev_err(dev, "DSP returned error[%d]\n",
-			adm->result.status);
+			slot->result.status);
 		ret = -EINVAL;
 		goto fail_cmd;
 	}
 
 fail_cmd:
-	mutex_unlock(&adm->lock);
+	mutex_unlock(&slot->lock);
 	kfree(pkt);
 	return ret;
 }
@@ -587,6 +612,7 @@ static int q6adm_probe(struct apr_device *adev)
 {
 	struct device *dev = &adev->dev;
 	struct q6adm *adm;
+	int i;
 
 	adm = devm_kzalloc(&adev->dev, sizeof(*adm), GFP_KERNEL);
 	if (!adm)
@@ -596,7 +622,8 @@ static int q6adm_probe(struct apr_device *adev)
 	dev_set_drvdata(&adev->dev, adm);
 	adm->dev = dev;
 	q6core_get_svc_api_info(adev->svc_id, &adm->ainfo);
-	mutex_init(&adm->lock);
+	for (i = 0; i < ADM_MAP_SLOTS; i++)
+		mutex_init(&adm->map[i].lock);
 	init_waitqueue_head(&adm->matrix_map_wait);
 
 	INIT_LIST_HEAD(&adm->copps_list);
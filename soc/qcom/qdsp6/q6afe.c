@@ -314,8 +314,9 @@ struct q6afe {
 	struct apr_device *apr;
 	struct device *dev;
 	struct q6core_svc_api_info ainfo;
-	struct mutex lock;
 	struct list_head port_list;
+	/* ports by token, the command responses are matched on it */
+	struct q6afe_port *ports[AFE_PORT_MAX];
 	spinlock_t port_list_lock;
 };
 
@@ -478,6 +479,8 @@ struct q6afe_port {
 	union afe_port_config port_cfg;
 	struct afe_param_id_slot_mapping_cfg *scfg;
 	struct aprv2_ibasic_rsp_result_t result;
+	/* one command in flight per port */
+	struct mutex lock;
 	int token;
 	int id;
 	int cfg_type;
@@ -711,7 +714,7 @@ static struct afe_port_map port_maps[AFE_PORT_MAX] = {
 
 static void q6afe_port_free(struct kref *ref)
 {
-	struct q6afe_port *port;
+	struct q6afe_port *port, *p;
 	struct q6afe *afe;
 	unsigned long flags;
 
@@ -719,6 +722,15 @@ static void q6afe_port_free(struct kref *ref)
 	afe = port->afe;
 	spin_lock_irqsave(&afe->port_list_lock, flags);
 	list_del(&port->node);
+	if (afe->ports[port->token] == port) {
+		afe->ports[port->token] = NULL;
+		/* a port bound again before this put takes over the token */
+		list_for_each_entry(p, &afe->port_list, node)
+			if (p->token == port->token) {
+				afe->ports[p->token] = p;
+				break;
+			}
+	}
 	spin_unlock_irqrestore(&afe->port_list_lock, flags);
 	kfree(port->scfg);
 	kfree(port);
@@ -726,20 +738,19 @@ static void q6afe_port_free(struct kref *ref)
 
 static struct q6afe_port *q6afe_find_port(struct q6afe *afe, int token)
 {
-	struct q6afe_port *p = NULL;
-	struct q6afe_port *ret = NULL;
+	struct q6afe_port *p;
 	unsigned long flags;
 
-	spin_lock_irqsave(&afe->port_list_lock, flags);
-	list_for_each_entry(p, &afe->port_list, node)
-		if (p->token == token) {
-			ret = p;
-			kref_get(&p->refcount);
-			break;
-		}
+	if (token < 0 || token >= AFE_PORT_MAX)
+		return NULL;
 
+	spin_lock_irqsave(&afe->port_list_lock, flags);
+	p = afe->ports[token];
+	if (p && !kref_get_unless_zero(&p->refcount))
+		p = NULL;
 	spin_unlock_irqrestore(&afe->port_list_lock, flags);
-	return ret;
+
+	return p;
 }
 
 static int q6afe_callback(struct apr_device *adev, struct apr_resp_pkt *data)
@@ -807,7 +818,7 @@ static int afe_apr_send_pkt(struct q6afe *afe, struct apr_pkt *pkt,
 	struct apr_hdr *hdr = &pkt->hdr;
 	int ret;
 
-	mutex_lock(&afe->lock);
+	mutex_lock(&port->lock);
 	port->result.opcode = 0;
 	port->result.status = 0;
 
@@ -831,7 +842,7 @@ static int afe_apr_send_pkt(struct q6afe *afe, struct apr_pkt *pkt,
 	}
 
 err:
-	mutex_unlock(&afe->lock);
+	mutex_unlock(&port->lock);
 
 	return ret;
 }
@@ -1430,6 +1441,7 @@ struct q6afe_port *q6afe_port_get_from_id(struct device *dev, int id)
 	if (!port)
 		return ERR_PTR(-ENOMEM);
 
+	mutex_init(&port->lock);
 	init_waitqueue_head(&port->wait);
 
 	port->token = id;
@@ -1439,6 +1451,8 @@ struct q6afe_port *q6afe_port_get_from_id(struct device *dev, int id)
 	kref_init(&port->refcount);
 
 	spin_lock_irqsave(&afe->port_list_lock, flags);
+	if (!afe->ports[id])
+		afe->ports[id] = port;
 	list_add_tail(&port->node, &afe->port_list);
 	spin_unlock_irqrestore(&afe->port_list_lock, flags);
 
@@ -1469,7 +1483,6 @@ static int q6afe_probe(struct apr_device *adev)
 
 	q6core_get_svc_api_info(adev->svc_id, &afe->ainfo);
 	afe->apr = adev;
-	mutex_init(&afe->lock);
 	afe->dev = dev;
 	INIT_LIST_HEAD(&afe->port_list);
 	spin_lock_init(&afe->port_list_lock);
@@ -496,14 +496,18 @@ static void compress_event_handler(uint32_t opcode, uint32_t token,
 	struct snd_compr_stream *substream = prtd->cstream;
 	unsigned long flags;
 	uint64_t avail;
+	int ret;
 
 	switch (opcode) {
 	case ASM_CLIENT_EVENT_CMD_RUN_DONE:
 		spin_lock_irqsave(&prtd->lock, flags);
 		if (!prtd->bytes_sent) {
-			q6asm_write_async(prtd->audio_client, prtd->pcm_count,
-					  0, 0, NO_TIMESTAMP);
-			prtd->bytes_sent += prtd->pcm_count;
+			avail = prtd->bytes_received - prtd->bytes_sent;
+			ret = q6asm_write_async_periods(prtd->audio_client,
+				max_t(u64, div_u64(avail, prtd->pcm_count), 1),
+				0, 0, NO_TIMESTAMP);
+			if (ret > 0)
+				prtd->bytes_sent += ret * prtd->pcm_count;
 		}
 
 		spin_unlock_irqrestore(&prtd->lock, flags);
@@ -516,7 +520,9 @@ static void compress_event_handler(uint32_t opcode, uint32_t token,
 	case ASM_CLIENT_EVENT_DATA_WRITE_DONE:
 		spin_lock_irqsave(&prtd->lock, flags);
 
-		prtd->copied_total += prtd->pcm_count;
+		/* a single write may have carried several fragments */
+		prtd->copied_total += prtd->pcm_count *
+				      Q6ASM_WRITE_TOKEN_PERIODS(token);
 		snd_compr_fragment_elapsed(substream);
 
 		if (prtd->state != Q6ASM_STREAM_RUNNING) {
@@ -526,11 +532,12 @@ static void compress_event_handler(uint32_t opcode, uint32_t token,
 
 		avail = prtd->bytes_received - prtd->bytes_sent;
 
-		if (avail >= prtd->pcm_count) {
-			q6asm_write_async(prtd->audio_client,
-					   prtd->pcm_count, 0, 0, NO_TIMESTAMP);
-			prtd->bytes_sent += prtd->pcm_count;
-		}
+		/* queue all the complete fragments with one write */
+		ret = q6asm_write_async_periods(prtd->audio_client,
+						div_u64(avail, prtd->pcm_count),
+						0, 0, NO_TIMESTAMP);
+		if (ret > 0)
+			prtd->bytes_sent += ret * prtd->pcm_count;
 
 		spin_unlock_irqrestore(&prtd->lock, flags);
 		break;
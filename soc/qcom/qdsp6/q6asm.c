@@ -684,12 +684,11 @@ static int32_t q6asm_stream_callback(struct apr_device *adev,
 				goto done;
 			}
 
-			phys = port->buf[hdr->token].phys;
+			phys = port->buf[Q6ASM_WRITE_TOKEN_FIRST(hdr->token)].phys;
 
 			if (lower_32_bits(phys) != result->opcode ||
 			    upper_32_bits(phys) != result->status) {
-				dev_err(ac->dev, "Expected addr %pa\n",
-					&port->buf[hdr->token].phys);
+				dev_err(ac->dev, "Expected addr %pa\n", &phys);
 				spin_unlock_irqrestore(&ac->lock, flags);
 				ret = -EINVAL;
 				goto done;
@@ -1486,19 +1485,9 @@ int q6asm_open_read(struct audio_client *ac, uint32_t format,
 }
 EXPORT_SYMBOL_GPL(q6asm_open_read);
 
-/**
- * q6asm_write_async() - non blocking write
- *
- * @ac: audio client pointer
- * @len: length in bytes
- * @msw_ts: timestamp msw
- * @lsw_ts: timestamp lsw
- * @wflags: flags associated with write
- *
- * Return: Will be an negative value on error or zero on success
- */
-int q6asm_write_async(struct audio_client *ac, uint32_t len, uint32_t msw_ts,
-		       uint32_t lsw_ts, uint32_t wflags)
+static int __q6asm_write_async(struct audio_client *ac, uint32_t len,
+			       unsigned int periods, uint32_t msw_ts,
+			       uint32_t lsw_ts, uint32_t wflags)
 {
 	struct asm_data_cmd_write_v2 *write;
 	struct audio_port_data *port;
@@ -1522,7 +1511,16 @@ int q6asm_write_async(struct audio_client *ac, uint32_t len, uint32_t msw_ts,
 	q6asm_add_hdr(ac, &pkt->hdr, pkt_size, false, ac->stream_id);
 
 	ab = &port->buf[port->dsp_buf];
-	pkt->hdr.token = port->dsp_buf;
+
+	/* the periods are consecutive in the region, up to its end */
+	if (periods) {
+		periods = min(periods, port->num_periods - port->dsp_buf);
+		len = periods * ab->size;
+	} else {
+		periods = 1;
+	}
+
+	pkt->hdr.token = Q6ASM_WRITE_TOKEN(port->dsp_buf, periods);
 	pkt->hdr.opcode = ASM_DATA_CMD_WRITE_V2;
 	write->buf_addr_lsw = lower_32_bits(ab->phys);
 	write->buf_addr_msw = upper_32_bits(ab->phys);
@@ -1538,7 +1536,7 @@ int q6asm_write_async(struct audio_client *ac, uint32_t len, uint32_t msw_ts,
 	else
 		write->flags = (0x80000000 | wflags);
 
-	port->dsp_buf++;
+	port->dsp_buf += periods;
 
 	if (port->dsp_buf >= port->num_periods)
 		port->dsp_buf = 0;
@@ -1546,13 +1544,61 @@ int q6asm_write_async(struct audio_client *ac, uint32_t len, uint32_t msw_ts,
 	spin_unlock_irqrestore(&ac->lock, flags);
 	rc = apr_send_pkt(ac->adev, pkt);
 	if (rc == pkt_size)
-		rc = 0;
+		rc = periods;
 
 	kfree(pkt);
 	return rc;
 }
+
+/**
+ * q6asm_write_async() - non blocking write
+ *
+ * @ac: audio client pointer
+ * @len: length in bytes
+ * @msw_ts: timestamp msw
+ * @lsw_ts: timestamp lsw
+ * @wflags: flags associated with write
+ *
+ * Return: Will be an negative value on error or zero on success
+ */
+int q6asm_write_async(struct audio_client *ac, uint32_t len, uint32_t msw_ts,
+		       uint32_t lsw_ts, uint32_t wflags)
+{
+	int rc;
+
+	rc = __q6asm_write_async(ac, len, 0, msw_ts, lsw_ts, wflags);
+
+	return rc < 0 ? rc : 0;
+}
 EXPORT_SYMBOL_GPL(q6asm_write_async);
 
+/**
+ * q6asm_write_async_periods() - non blocking write of consecutive periods
+ *
+ * @ac: audio client pointer
+ * @periods: number of full periods to write, from the next one
+ * @msw_ts: timestamp msw
+ * @lsw_ts: timestamp lsw
+ * @wflags: flags associated with write
+ *
+ * The buffer mapped by q6asm_map_memory_regions() is a single region, so
+ * consecutive periods are queued with a single write command, stopping at
+ * the end of the buffer. The token of the matching write done event tells
+ * how many periods were consumed, see Q6ASM_WRITE_TOKEN_PERIODS().
+ *
+ * Return: Will be an negative value on error or the number of periods queued
+ */
+int q6asm_write_async_periods(struct audio_client *ac, unsigned int periods,
+			      uint32_t msw_ts, uint32_t lsw_ts,
+			      uint32_t wflags)
+{
+	if (!periods)
+		return 0;
+
+	return __q6asm_write_async(ac, 0, periods, msw_ts, lsw_ts, wflags);
+}
+EXPORT_SYMBOL_GPL(q6asm_write_async_periods);
+
 static void q6asm_reset_buf_state(struct audio_client *ac)
 {
 	struct audio_port_data *port = NULL;
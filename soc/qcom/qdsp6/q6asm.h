@@ -30,6 +30,10 @@ enum {
 
 #define MAX_SESSIONS	8
 #define NO_TIMESTAMP    0xFF00
+/* ASM_CLIENT_EVENT_DATA_WRITE_DONE token: first period and period count */
+#define Q6ASM_WRITE_TOKEN(first, periods)	((first) | (((periods) - 1) << 16))
+#define Q6ASM_WRITE_TOKEN_FIRST(token)		((token) & 0xFFFF)
+#define Q6ASM_WRITE_TOKEN_PERIODS(token)	(((token) >> 16) + 1)
 #define FORMAT_LINEAR_PCM   0x0000
 
 struct q6asm_flac_cfg {
@@ -95,6 +99,9 @@ struct audio_client *q6asm_audio_client_alloc(struct device *dev,
 void q6asm_audio_client_free(struct audio_client *ac);
 int q6asm_write_async(struct audio_client *ac, uint32_t len, uint32_t msw_ts,
 		       uint32_t lsw_ts, uint32_t flags);
+int q6asm_write_async_periods(struct audio_client *ac, unsigned int periods,
+			      uint32_t msw_ts, uint32_t lsw_ts,
+			      uint32_t flags);
 int q6asm_open_write(struct audio_client *ac, uint32_t format,
 		     u32 codec_profile, uint16_t bits_per_sample);
 
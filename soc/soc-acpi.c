@@ -4,18 +4,49 @@
 //
 // Copyright (c) 2013-15, Intel Corporation.
 
+#include <linux/bitmap.h>
 #include <linux/export.h>
 #include <linux/module.h>
+#include <linux/string.h>
 #include <dkms/sound/soc-acpi.h>
 
+/* number of table entries whose HID lookup result is remembered */
+#define SND_SOC_ACPI_ID_CACHE	64
+
+/*
+ * Match tables list the same HID several times with different quirks,
+ * and acpi_dev_present() walks every ACPI device on each call. Reuse the
+ * result of an earlier entry carrying the same HID instead.
+ */
+static bool snd_soc_acpi_id_present(struct snd_soc_acpi_mach *machines,
+				    struct snd_soc_acpi_mach *mach,
+				    unsigned long *present)
+{
+	unsigned int i = mach - machines;
+	unsigned int j;
+
+	for (j = 0; j < i && j < SND_SOC_ACPI_ID_CACHE; j++) {
+		if (!strncmp(machines[j].id, mach->id, ACPI_ID_LEN))
+			return test_bit(j, present);
+	}
+
+	if (!acpi_dev_present(mach->id, NULL, -1))
+		return false;
+
+	if (i < SND_SOC_ACPI_ID_CACHE)
+		set_bit(i, present);
+	return true;
+}
+
 struct snd_soc_acpi_mach *
 snd_soc_acpi_find_machine(struct snd_soc_acpi_mach *machines)
 {
+	DECLARE_BITMAP(present, SND_SOC_ACPI_ID_CACHE) = { 0 };
 	struct snd_soc_acpi_mach *mach;
 	struct snd_soc_acpi_mach *mach_alt;
 
 	for (mach = machines; mach->id[0]; mach++) {
-		if (acpi_dev_present(mach->id, NULL, -1)) {
+		if (snd_soc_acpi_id_present(machines, mach, present)) {
 			if (mach->machine_quirk) {
 				mach_alt = mach->machine_quirk(mach);
 				if (!mach_alt)
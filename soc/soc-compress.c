@@ -340,6 +340,35 @@ static int soc_compr_components_trigger(struct snd_compr_stream *cstream,
 	return 0;
 }
 
+/*
+ * Gapless track transitions only hand the command to the DSP, they touch
+ * neither the DAI mute state nor the DPCM BE links, so run them without
+ * the card locks. This keeps a player's NEXT_TRACK/PARTIAL_DRAIN from
+ * queueing behind pointer/ack/copy calls or a DPCM update on another FE.
+ */
+static int soc_compr_trigger_gapless(struct snd_compr_stream *cstream,
+				     int cmd)
+{
+	struct snd_soc_pcm_runtime *rtd = cstream->private_data;
+	struct snd_soc_dai *cpu_dai = rtd->cpu_dai;
+	int ret;
+
+	if (cpu_dai->driver->cops && cpu_dai->driver->cops->trigger) {
+		ret = cpu_dai->driver->cops->trigger(cstream, cmd, cpu_dai);
+		if (ret < 0)
+			return ret;
+	}
+
+	return soc_compr_components_trigger(cstream, cmd);
+}
+
+static bool soc_compr_cmd_is_gapless(int cmd)
+{
+	return cmd == SND_COMPR_TRIGGER_NEXT_TRACK ||
+	       cmd == SND_COMPR_TRIGGER_PARTIAL_DRAIN ||
+	       cmd == SND_COMPR_TRIGGER_DRAIN;
+}
+
 static int soc_compr_trigger(struct snd_compr_stream *cstream, int cmd)
 {
 	struct snd_soc_pcm_runtime *rtd = cstream->private_data;
@@ -347,6 +376,9 @@ static int soc_compr_trigger(struct snd_compr_stream *cstream, int cmd)
 	struct snd_soc_dai *cpu_dai = rtd->cpu_dai;
 	int ret;
 
+	if (soc_compr_cmd_is_gapless(cmd))
+		return soc_compr_trigger_gapless(cstream, cmd);
+
 	mutex_lock_nested(&rtd->card->pcm_mutex, rtd->card->pcm_subclass);
 
 	ret = soc_compr_components_trigger(cstream, cmd);
@@ -376,9 +408,8 @@ static int soc_compr_trigger_fe(struct snd_compr_stream *cstream, int cmd)
 	struct snd_soc_dai *cpu_dai = fe->cpu_dai;
 	int ret, stream;
 
-	if (cmd == SND_COMPR_TRIGGER_PARTIAL_DRAIN ||
-	    cmd == SND_COMPR_TRIGGER_DRAIN)
-		return soc_compr_components_trigger(cstream, cmd);
+	if (soc_compr_cmd_is_gapless(cmd))
+		return soc_compr_trigger_gapless(cstream, cmd);
 
 	if (cstream->direction == SND_COMPRESS_PLAYBACK)
 		stream = SNDRV_PCM_STREAM_PLAYBACK;
@@ -19,6 +19,7 @@
 
 #include <linux/module.h>
 #include <linux/moduleparam.h>
+#include <linux/async.h>
 #include <linux/init.h>
 #include <linux/delay.h>
 #include <linux/pm.h>
@@ -398,6 +399,11 @@ static void soc_free_pcm_runtime(struct snd_soc_pcm_runtime *rtd)
 		return;
 
 	list_del(&rtd->list);
+	if (rtd->card)
+		rtd->card->dpcm_be_gen++;
+
+	kfree(rtd->dpcm[SNDRV_PCM_STREAM_PLAYBACK].path_cache);
+	kfree(rtd->dpcm[SNDRV_PCM_STREAM_CAPTURE].path_cache);
 
 	if (delayed_work_pending(&rtd->delayed_work))
 		flush_delayed_work(&rtd->delayed_work);
@@ -501,6 +507,7 @@ static struct snd_soc_pcm_runtime *soc_new_pcm_runtime(
 	list_add_tail(&rtd->list, &card->rtd_list);
 	rtd->num = card->num_rtd;
 	card->num_rtd++;
+	card->dpcm_be_gen++;
 
 	return rtd;
 
@@ -1172,17 +1179,20 @@ static void soc_remove_component(struct snd_soc_component *component,
 	snd_soc_component_module_put_when_remove(component);
 }
 
-static int soc_probe_component(struct snd_soc_card *card,
-			       struct snd_soc_component *component)
+/*
+ * Bind @component to @card and create its widgets, ahead of the driver
+ * probe. Returns 1 if there is nothing to probe.
+ */
+static int soc_probe_component_prepare(struct snd_soc_card *card,
+				       struct snd_soc_component *component)
 {
 	struct snd_soc_dapm_context *dapm =
 		snd_soc_component_get_dapm(component);
 	struct snd_soc_dai *dai;
-	int probed = 0;
 	int ret;
 
 	if (!strcmp(component->name, "snd-soc-dummy"))
-		return 0;
+		return 1;
 
 	if (component->card) {
 		if (component->card != card) {
@@ -1191,7 +1201,7 @@ static int soc_probe_component(struct snd_soc_card *card,
 				card->name, component->card->name);
 			return -ENODEV;
 		}
-		return 0;
+		return 1;
 	}
 
 	ret = snd_soc_component_module_get_when_probe(component);
@@ -1224,17 +1234,38 @@ static int soc_probe_component(struct snd_soc_card *card,
 		}
 	}
 
+	return 0;
+
+err_probe:
+	soc_remove_component(component, 0);
+
+	return ret;
+}
+
+static int soc_probe_component_driver(struct snd_soc_component *component)
+{
+	int ret;
+
 	ret = snd_soc_component_probe(component);
-	if (ret < 0) {
+	if (ret < 0)
 		dev_err(component->dev,
 			"ASoC: failed to probe component %d\n", ret);
-		goto err_probe;
-	}
+
+	return ret;
+}
+
+/* Finish the setup of @component once the driver is probed */
+static int soc_probe_component_finish(struct snd_soc_card *card,
+				      struct snd_soc_component *component)
+{
+	struct snd_soc_dapm_context *dapm =
+		snd_soc_component_get_dapm(component);
+	int ret;
+
 	WARN(dapm->idle_bias_off &&
 	     dapm->bias_level != SND_SOC_BIAS_OFF,
 	     "codec %s can not start from non-off bias with idle_bias_off==1\n",
 	     component->name);
-	probed = 1;
 
 	/* machine specific init */
 	if (component->init) {
@@ -1273,11 +1304,86 @@ static int soc_probe_component(struct snd_soc_card *card,
 
 err_probe:
 	if (ret < 0)
-		soc_remove_component(component, probed);
+		soc_remove_component(component, 1);
 
 	return ret;
 }
 
+static int soc_probe_component(struct snd_soc_card *card,
+			       struct snd_soc_component *component)
+{
+	int ret;
+
+	ret = soc_probe_component_prepare(card, component);
+	if (ret)
+		return ret < 0 ? ret : 0;
+
+	ret = soc_probe_component_driver(component);
+	if (ret < 0) {
+		soc_remove_component(component, 0);
+		return ret;
+	}
+
+	return soc_probe_component_finish(card, component);
+}
+
+struct soc_probe_job {
+	struct snd_soc_component *component;
+	int ret;
+};
+
+static void soc_probe_component_async(void *data, async_cookie_t cookie)
+{
+	struct soc_probe_job *job = data;
+
+	job->ret = soc_probe_component_driver(job->component);
+}
+
+/*
+ * Probe the components of one probe order level, the driver probes running
+ * concurrently. Everything the core does around them, which updates the card
+ * lists, is done one component at a time in the order of @jobs.
+ */
+static int soc_probe_components_async(struct snd_soc_card *card,
+				      struct soc_probe_job *jobs, int num)
+{
+	ASYNC_DOMAIN_EXCLUSIVE(async_domain);
+	int i, n = 0, ret, err = 0;
+
+	for (i = 0; i < num; i++) {
+		ret = soc_probe_component_prepare(card, jobs[i].component);
+		if (ret < 0) {
+			while (n--)
+				soc_remove_component(jobs[n].component, 0);
+			return ret;
+		}
+		if (ret == 0)
+			jobs[n++] = jobs[i];
+	}
+
+	for (i = 1; i < n; i++)
+		async_schedule_domain(soc_probe_component_async, &jobs[i],
+				      &async_domain);
+	if (n)
+		soc_probe_component_async(&jobs[0], 0);
+	async_synchronize_full_domain(&async_domain);
+
+	for (i = 0; i < n; i++) {
+		if (jobs[i].ret < 0) {
+			soc_remove_component(jobs[i].component, 0);
+			if (!err)
+				err = jobs[i].ret;
+		} else if (err) {
+			soc_remove_component(jobs[i].component, 1);
+		} else {
+			err = soc_probe_component_finish(card,
+							 jobs[i].component);
+		}
+	}
+
+	return err;
+}
+
 static void soc_remove_dai(struct snd_soc_dai *dai, int order)
 {
 	int err;
@@ -1374,12 +1480,49 @@ static void soc_remove_link_components(struct snd_soc_card *card)
 	}
 }
 
+static int soc_probe_link_components_async(struct snd_soc_card *card)
+{
+	struct snd_soc_component *component;
+	struct snd_soc_pcm_runtime *rtd;
+	struct soc_probe_job *jobs;
+	int i, num, ret = 0, order;
+
+	num = 0;
+	for_each_card_rtds(card, rtd)
+		num += rtd->num_components;
+
+	jobs = kcalloc(num, sizeof(*jobs), GFP_KERNEL);
+	if (!jobs)
+		return -ENOMEM;
+
+	for_each_comp_order(order) {
+		num = 0;
+		for_each_card_rtds(card, rtd) {
+			for_each_rtd_components(rtd, i, component) {
+				if (component->driver->probe_order == order)
+					jobs[num++].component = component;
+			}
+		}
+
+		ret = soc_probe_components_async(card, jobs, num);
+		if (ret < 0)
+			break;
+	}
+
+	kfree(jobs);
+
+	return ret;
+}
+
 static int soc_probe_link_components(struct snd_soc_card *card)
 {
 	struct snd_soc_component *component;
 	struct snd_soc_pcm_runtime *rtd;
 	int i, ret, order;
 
+	if (card->parallel_probe)
+		return soc_probe_link_components_async(card);
+
 	for_each_comp_order(order) {
 		for_each_card_rtds(card, rtd) {
 			for_each_rtd_components(rtd, i, component) {
@@ -1425,12 +1568,45 @@ static int soc_bind_aux_dev(struct snd_soc_card *card)
 	return 0;
 }
 
+static int soc_probe_aux_devices_async(struct snd_soc_card *card)
+{
+	struct snd_soc_component *component;
+	struct soc_probe_job *jobs;
+	int num = 0, ret = 0, order;
+
+	for_each_card_auxs(card, component)
+		num++;
+
+	jobs = kcalloc(num, sizeof(*jobs), GFP_KERNEL);
+	if (!jobs)
+		return -ENOMEM;
+
+	for_each_comp_order(order) {
+		num = 0;
+		for_each_card_auxs(card, component) {
+			if (component->driver->probe_order == order)
+				jobs[num++].component = component;
+		}
+
+		ret = soc_probe_components_async(card, jobs, num);
+		if (ret < 0)
+			break;
+	}
+
+	kfree(jobs);
+
+	return ret;
+}
+
 static int soc_probe_aux_devices(struct snd_soc_card *card)
 {
 	struct snd_soc_component *component;
 	int order;
 	int ret;
 
+	if (card->parallel_probe)
+		return soc_probe_aux_devices_async(card);
+
 	for_each_comp_order(order) {
 		for_each_card_auxs(card, component) {
 			if (component->driver->probe_order != order)
@@ -2249,6 +2425,10 @@ int snd_soc_register_card(struct snd_soc_card *card)
 	dev_set_drvdata(card->dev, card);
 
 	INIT_LIST_HEAD(&card->widgets);
+	hash_init(card->widget_hash);
+	/* zero is never valid, see dpcm_get_be() */
+	card->dapm_conn_gen = 1;
+	card->dpcm_be_gen = 1;
 	INIT_LIST_HEAD(&card->paths);
 	INIT_LIST_HEAD(&card->dapm_list);
 	INIT_LIST_HEAD(&card->aux_comp_list);
@@ -31,6 +31,7 @@
 #include <linux/pinctrl/consumer.h>
 #include <linux/clk.h>
 #include <linux/slab.h>
+#include <linux/stringhash.h>
 #include <dkms/sound/core.h>
 #include <dkms/sound/pcm.h>
 #include <dkms/sound/pcm_params.h>
@@ -244,6 +245,7 @@ static __always_inline void dapm_widget_invalidate_paths(
  */
 static void dapm_widget_invalidate_input_paths(struct snd_soc_dapm_widget *w)
 {
+	w->dapm->card->dapm_conn_gen++;
 	dapm_widget_invalidate_paths(w, SND_SOC_DAPM_DIR_IN);
 }
 
@@ -261,6 +263,7 @@ static void dapm_widget_invalidate_input_paths(struct snd_soc_dapm_widget *w)
  */
 static void dapm_widget_invalidate_output_paths(struct snd_soc_dapm_widget *w)
 {
+	w->dapm->card->dapm_conn_gen++;
 	dapm_widget_invalidate_paths(w, SND_SOC_DAPM_DIR_OUT);
 }
 
@@ -277,6 +280,8 @@ static void dapm_widget_invalidate_output_paths(struct snd_soc_dapm_widget *w)
  */
 static void dapm_path_invalidate(struct snd_soc_dapm_path *p)
 {
+	p->source->dapm->card->dapm_conn_gen++;
+
 	/*
 	 * Weak paths or supply paths do not influence the number of input or
 	 * output paths of their neighbors.
@@ -296,6 +301,109 @@ static void dapm_path_invalidate(struct snd_soc_dapm_path *p)
 		dapm_widget_invalidate_output_paths(p->source);
 }
 
+/* bound on the widgets visited by one delta update before invalidating */
+#define DAPM_DELTA_MAX_VISITS	64
+
+/*
+ * dapm_widget_update_paths() - Apply a change of the number of connected
+ *  endpoints to the cached counts
+ * @w: The widget whose count changes
+ * @dir: The direction of the count
+ * @delta: The change of the count
+ * @budget: The number of widgets that may still be visited
+ *
+ * Adds @delta to the cached count of @w and of all widgets reachable from it
+ * via connected paths, stopping at widgets whose count is unknown or doesn't
+ * depend on their neighbors. Returns false if the update was aborted on a
+ * cycle or because too many widgets were visited, in which case the counts
+ * reachable from @w must be invalidated.
+ */
+static bool dapm_widget_update_paths(struct snd_soc_dapm_widget *w,
+	enum snd_soc_dapm_direction dir, int delta, int *budget)
+{
+	enum snd_soc_dapm_direction rdir = SND_SOC_DAPM_DIR_REVERSE(dir);
+	struct snd_soc_dapm_path *p;
+	bool ret = true;
+
+	/* Unknown counts, and all counts depending on them, get recomputed */
+	if (w->endpoints[dir] < 0)
+		return true;
+
+	if ((w->is_ep & SND_SOC_DAPM_DIR_TO_EP(dir)) && w->connected)
+		return true;
+
+	if (--(*budget) < 0 || w->endpoints[dir] + delta < 0)
+		return false;
+
+	w->endpoints[dir] += delta;
+
+	snd_soc_dapm_widget_for_each_path(w, dir, p) {
+		if (p->is_supply || p->weak || !p->connect)
+			continue;
+		if (p->walking)
+			return false;
+
+		p->walking = 1;
+		ret = dapm_widget_update_paths(p->node[rdir], dir, delta,
+					       budget);
+		p->walking = 0;
+		if (!ret)
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * dapm_path_update() - Updates the cached number of inputs and outputs for
+ *  the widgets connected to a path whose connected state changed
+ * @p: The path that was connected or disconnected
+ * @connect: The new connect state of the path
+ *
+ * Rather than invalidating the counts of the whole subgraph behind the path,
+ * the number of endpoints gained or lost through the path is propagated to
+ * the widgets that have a cached count, so that the next power update only
+ * walks the widgets it didn't reach before. Falls back to
+ * dapm_path_invalidate() if that's not possible.
+ */
+static void dapm_path_update(struct snd_soc_dapm_path *p, bool connect)
+{
+	int in = p->source->endpoints[SND_SOC_DAPM_DIR_IN];
+	int out = p->sink->endpoints[SND_SOC_DAPM_DIR_OUT];
+	int budget = DAPM_DELTA_MAX_VISITS;
+	bool ok;
+
+	if (p->weak || p->is_supply)
+		return;
+
+	p->source->dapm->card->dapm_conn_gen++;
+
+	if (in < 0 || out < 0) {
+		dapm_path_invalidate(p);
+		return;
+	}
+
+	/* Loops formed through the path itself abort the update */
+	p->walking = 1;
+
+	if (in) {
+		ok = dapm_widget_update_paths(p->sink, SND_SOC_DAPM_DIR_IN,
+					      connect ? in : -in, &budget);
+		if (!ok)
+			dapm_widget_invalidate_input_paths(p->sink);
+	}
+
+	if (out) {
+		budget = DAPM_DELTA_MAX_VISITS;
+		ok = dapm_widget_update_paths(p->source, SND_SOC_DAPM_DIR_OUT,
+					      connect ? out : -out, &budget);
+		if (!ok)
+			dapm_widget_invalidate_output_paths(p->source);
+	}
+
+	p->walking = 0;
+}
+
 void dapm_mark_endpoints_dirty(struct snd_soc_card *card)
 {
 	struct snd_soc_dapm_widget *w;
@@ -1560,19 +1668,153 @@ static void dapm_seq_check_event(struct snd_soc_card *card,
 }
 
 /* Apply the coalesced changes from a DAPM sequence */
+/* number of register updates of a sequence step submitted together */
+#define DAPM_SEQ_BATCH	16
+
+/*
+ * Register updates of a power sequence step which have no event attached,
+ * gathered across the DAPM contexts and written per regmap in one go.
+ */
+struct dapm_seq_batch {
+	unsigned int count;
+	struct {
+		struct snd_soc_dapm_context *dapm;
+		int reg;
+		unsigned int mask;
+		unsigned int value;
+	} writes[DAPM_SEQ_BATCH];
+};
+
+static struct regmap *dapm_seq_regmap(struct snd_soc_dapm_context *dapm)
+{
+	return dapm->component ? dapm->component->regmap : NULL;
+}
+
+/* Apply the updates queued in @batch, one multi write per regmap */
+static void dapm_seq_batch_flush(struct snd_soc_card *card,
+				 struct dapm_seq_batch *batch)
+{
+	struct reg_sequence seq[DAPM_SEQ_BATCH];
+	unsigned int old[DAPM_SEQ_BATCH];
+	struct snd_soc_dapm_context *dapm;
+	struct regmap *regmap;
+	unsigned long done = 0;
+	unsigned int i, j, k, n, val;
+	int ret;
+
+	BUILD_BUG_ON(DAPM_SEQ_BATCH > BITS_PER_LONG);
+
+	for (i = 0; i < batch->count; i++) {
+		if (done & BIT(i))
+			continue;
+
+		dapm = batch->writes[i].dapm;
+		regmap = dapm_seq_regmap(dapm);
+
+		pop_dbg(dapm->dev, card->pop_time,
+			"pop test : Applying 0x%x/0x%x to %x in %dms\n",
+			batch->writes[i].value, batch->writes[i].mask,
+			batch->writes[i].reg, card->pop_time);
+
+		if (!regmap) {
+			soc_dapm_update_bits(dapm, batch->writes[i].reg,
+					     batch->writes[i].mask,
+					     batch->writes[i].value);
+			continue;
+		}
+
+		n = 0;
+		for (j = i; j < batch->count; j++) {
+			if (done & BIT(j) ||
+			    dapm_seq_regmap(batch->writes[j].dapm) != regmap)
+				continue;
+			done |= BIT(j);
+
+			/* the same register may be updated from two contexts */
+			for (k = 0; k < n; k++)
+				if (seq[k].reg == batch->writes[j].reg)
+					break;
+
+			if (k == n) {
+				ret = regmap_read(regmap, batch->writes[j].reg,
+						  &val);
+				if (ret < 0) {
+					dev_err(dapm->dev,
+						"ASoC: Failed to read %x: %d\n",
+						batch->writes[j].reg, ret);
+					continue;
+				}
+				old[n] = val;
+				seq[n].reg = batch->writes[j].reg;
+				seq[n].def = val;
+				seq[n].delay_us = 0;
+				n++;
+			}
+
+			seq[k].def &= ~batch->writes[j].mask;
+			seq[k].def |= batch->writes[j].value &
+				      batch->writes[j].mask;
+		}
+
+		pop_wait(card->pop_time);
+
+		/* as with regmap_update_bits(), skip the unchanged registers */
+		for (j = 0, k = 0; j < n; j++)
+			if (seq[j].def != old[j])
+				seq[k++] = seq[j];
+
+		if (!k)
+			continue;
+
+		ret = regmap_multi_reg_write(regmap, seq, k);
+		if (ret < 0)
+			dev_err(dapm->dev,
+				"ASoC: Failed to apply widget power: %d\n",
+				ret);
+	}
+
+	batch->count = 0;
+}
+
+static bool dapm_seq_has_events(struct list_head *pending)
+{
+	struct snd_soc_dapm_widget *w;
+
+	list_for_each_entry(w, pending, power_list)
+		if (w->event && (w->event_flags & (SND_SOC_DAPM_PRE_PMU |
+						   SND_SOC_DAPM_POST_PMU |
+						   SND_SOC_DAPM_PRE_PMD |
+						   SND_SOC_DAPM_POST_PMD)))
+			return true;
+
+	return false;
+}
+
+/*
+ * Apply the pending widgets, which all update the same register. If none
+ * of them has an event to run around the update, the update is queued in
+ * @batch and written along with the other updates of the same sequence
+ * step, otherwise @batch is flushed first to keep the events in order.
+ */
 static void dapm_seq_run_coalesced(struct snd_soc_card *card,
-				   struct list_head *pending)
+				   struct list_head *pending,
+				   struct dapm_seq_batch *batch)
 {
 	struct snd_soc_dapm_context *dapm;
 	struct snd_soc_dapm_widget *w;
 	int reg;
 	unsigned int value = 0;
 	unsigned int mask = 0;
+	bool defer;
 
 	w = list_first_entry(pending, struct snd_soc_dapm_widget, power_list);
 	reg = w->reg;
 	dapm = w->dapm;
 
+	defer = reg >= 0 && !dapm_seq_has_events(pending);
+	if (!defer || batch->count == DAPM_SEQ_BATCH)
+		dapm_seq_batch_flush(card, batch);
+
 	list_for_each_entry(w, pending, power_list) {
 		WARN_ON(reg != w->reg || dapm != w->dapm);
 		w->power = w->new_power;
@@ -1592,6 +1834,15 @@ static void dapm_seq_run_coalesced(struct snd_soc_card *card,
 		dapm_seq_check_event(card, w, SND_SOC_DAPM_PRE_PMD);
 	}
 
+	if (defer) {
+		batch->writes[batch->count].dapm = dapm;
+		batch->writes[batch->count].reg = reg;
+		batch->writes[batch->count].mask = mask;
+		batch->writes[batch->count].value = value;
+		batch->count++;
+		return;
+	}
+
 	if (reg >= 0) {
 		/* Any widget will do, they should all be updating the
 		 * same register.
@@ -1614,15 +1865,17 @@ static void dapm_seq_run_coalesced(struct snd_soc_card *card,
  *
  * We walk over a pre-sorted list of widgets to apply power to.  In
  * order to minimise the number of writes to the device required
- * multiple widgets will be updated in a single write where possible.
- * Currently anything that requires more than a single write is not
- * handled.
+ * multiple widgets will be updated in a single write where possible,
+ * and the writes of a sequence step which have no events attached are
+ * submitted together per regmap. Currently anything that requires more
+ * than a single write per widget is not handled.
  */
 static void dapm_seq_run(struct snd_soc_card *card,
 	struct list_head *list, int event, bool power_up)
 {
 	struct snd_soc_dapm_widget *w, *n;
 	struct snd_soc_dapm_context *d;
+	struct dapm_seq_batch batch = { .count = 0 };
 	LIST_HEAD(pending);
 	int cur_sort = -1;
 	int cur_subseq = -1;
@@ -1643,7 +1896,14 @@ static void dapm_seq_run(struct snd_soc_card *card,
 		if (sort[w->id] != cur_sort || w->reg != cur_reg ||
 		    w->dapm != cur_dapm || w->subseq != cur_subseq) {
 			if (!list_empty(&pending))
-				dapm_seq_run_coalesced(card, &pending);
+				dapm_seq_run_coalesced(card, &pending, &batch);
+
+			/* the step is over or the component wants to know */
+			if (sort[w->id] != cur_sort ||
+			    w->subseq != cur_subseq ||
+			    (cur_dapm && cur_dapm->component &&
+			     cur_dapm->component->driver->seq_notifier))
+				dapm_seq_batch_flush(card, &batch);
 
 			if (cur_dapm && cur_dapm->component) {
 				for (i = 0; i < ARRAY_SIZE(dapm_up_seq); i++)
@@ -1706,7 +1966,9 @@ static void dapm_seq_run(struct snd_soc_card *card,
 	}
 
 	if (!list_empty(&pending))
-		dapm_seq_run_coalesced(card, &pending);
+		dapm_seq_run_coalesced(card, &pending, &batch);
+
+	dapm_seq_batch_flush(card, &batch);
 
 	if (cur_dapm && cur_dapm->component) {
 		for (i = 0; i < ARRAY_SIZE(dapm_up_seq); i++)
@@ -1720,6 +1982,103 @@ static void dapm_seq_run(struct snd_soc_card *card,
 		soc_dapm_async_complete(d);
 }
 
+/* most components a power sequence is split over */
+#define DAPM_SEQ_MAX_JOBS	8
+
+struct dapm_seq_job {
+	struct snd_soc_card *card;
+	struct snd_soc_dapm_context *dapm;
+	struct list_head list;
+	int event;
+	bool power_up;
+};
+
+static void dapm_seq_run_async(void *data, async_cookie_t cookie)
+{
+	struct dapm_seq_job *job = data;
+
+	dapm_seq_run(job->card, &job->list, job->event, job->power_up);
+}
+
+static struct dapm_seq_job *dapm_seq_find_job(struct dapm_seq_job *jobs,
+	int num_jobs, struct snd_soc_dapm_context *dapm)
+{
+	int i;
+
+	for (i = 0; i < num_jobs; i++)
+		if (jobs[i].dapm == dapm)
+			return &jobs[i];
+
+	return NULL;
+}
+
+/*
+ * Apply a DAPM power sequence split per component, the sequences of the
+ * components running in parallel. This is only done if the card allows it,
+ * no card level widget is part of the sequence and no path links widgets of
+ * two different components that both change power, since their relative
+ * order would be lost. Returns false if the sequence has to be run as a
+ * whole by dapm_seq_run().
+ */
+static bool dapm_seq_run_parallel(struct snd_soc_card *card,
+	struct list_head *list, int event, bool power_up)
+{
+	ASYNC_DOMAIN_EXCLUSIVE(async_domain);
+	struct dapm_seq_job jobs[DAPM_SEQ_MAX_JOBS];
+	struct snd_soc_dapm_widget *w, *n, *node;
+	struct snd_soc_dapm_path *p;
+	struct dapm_seq_job *job;
+	enum snd_soc_dapm_direction dir;
+	int num_jobs = 0;
+	int i;
+
+	if (!card->parallel_seq)
+		return false;
+
+	list_for_each_entry(w, list, power_list) {
+		if (!w->dapm->component)
+			return false;
+
+		snd_soc_dapm_for_each_direction(dir) {
+			snd_soc_dapm_widget_for_each_path(w, dir, p) {
+				node = p->node[SND_SOC_DAPM_DIR_REVERSE(dir)];
+				if (node->dapm != w->dapm &&
+				    node->power != node->new_power)
+					return false;
+			}
+		}
+
+		if (dapm_seq_find_job(jobs, num_jobs, w->dapm))
+			continue;
+		if (num_jobs == DAPM_SEQ_MAX_JOBS)
+			return false;
+
+		job = &jobs[num_jobs++];
+		job->card = card;
+		job->dapm = w->dapm;
+		INIT_LIST_HEAD(&job->list);
+		job->event = event;
+		job->power_up = power_up;
+	}
+
+	if (num_jobs < 2)
+		return false;
+
+	/* the lists stay sorted as required by dapm_seq_run() */
+	list_for_each_entry_safe(w, n, list, power_list) {
+		job = dapm_seq_find_job(jobs, num_jobs, w->dapm);
+		list_move_tail(&w->power_list, &job->list);
+	}
+
+	for (i = 1; i < num_jobs; i++)
+		async_schedule_domain(dapm_seq_run_async, &jobs[i],
+				      &async_domain);
+	dapm_seq_run_async(&jobs[0], 0);
+	async_synchronize_full_domain(&async_domain);
+
+	return true;
+}
+
 static void dapm_widget_update(struct snd_soc_card *card)
 {
 	struct snd_soc_dapm_update *update = card->update;
@@ -1745,19 +2104,37 @@ static void dapm_widget_update(struct snd_soc_card *card)
 	if (!w)
 		return;
 
-	ret = soc_dapm_update_bits(w->dapm, update->reg, update->mask,
-		update->val);
-	if (ret < 0)
-		dev_err(w->dapm->dev, "ASoC: %s DAPM update failed: %d\n",
-			w->name, ret);
+	if (update->has_second_set && w->dapm->component) {
+		/* both registers of the control are written at once */
+		struct snd_soc_component_txn txn;
 
-	if (update->has_second_set) {
-		ret = soc_dapm_update_bits(w->dapm, update->reg2,
-					   update->mask2, update->val2);
+		snd_soc_component_txn_begin(&txn, w->dapm->component);
+		snd_soc_component_txn_update_bits(&txn, update->reg,
+						  update->mask, update->val);
+		snd_soc_component_txn_update_bits(&txn, update->reg2,
+						  update->mask2, update->val2);
+		ret = snd_soc_component_txn_commit(&txn);
+		if (ret < 0)
+			dev_err(w->dapm->dev,
+				"ASoC: %s DAPM update failed: %d\n",
+				w->name, ret);
+	} else {
+		ret = soc_dapm_update_bits(w->dapm, update->reg, update->mask,
+			update->val);
 		if (ret < 0)
 			dev_err(w->dapm->dev,
 				"ASoC: %s DAPM update failed: %d\n",
 				w->name, ret);
+
+		if (update->has_second_set) {
+			ret = soc_dapm_update_bits(w->dapm, update->reg2,
+						   update->mask2,
+						   update->val2);
+			if (ret < 0)
+				dev_err(w->dapm->dev,
+					"ASoC: %s DAPM update failed: %d\n",
+					w->name, ret);
+		}
 	}
 
 	for_each_dapm_widgets(wlist, wi, w) {
@@ -2040,12 +2417,14 @@ static int dapm_power_widgets(struct snd_soc_card *card, int event)
 	}
 
 	/* Power down widgets first; try to avoid amplifying pops. */
-	dapm_seq_run(card, &down_list, event, false);
+	if (!dapm_seq_run_parallel(card, &down_list, event, false))
+		dapm_seq_run(card, &down_list, event, false);
 
 	dapm_widget_update(card);
 
 	/* Now power up. */
-	dapm_seq_run(card, &up_list, event, true);
+	if (!dapm_seq_run_parallel(card, &up_list, event, true))
+		dapm_seq_run(card, &up_list, event, true);
 
 	/* Run all the bias changes in parallel */
 	for_each_card_dapms(card, d) {
@@ -2247,7 +2626,7 @@ static void soc_dapm_connect_path(struct snd_soc_dapm_path *path,
 	path->connect = connect;
 	dapm_mark_dirty(path->source, reason);
 	dapm_mark_dirty(path->sink, reason);
-	dapm_path_invalidate(path);
+	dapm_path_update(path, connect);
 }
 
 /* test and update the power status of a mux widget */
@@ -2469,6 +2848,8 @@ void snd_soc_dapm_free_widget(struct snd_soc_dapm_widget *w)
 	enum snd_soc_dapm_direction dir;
 
 	list_del(&w->list);
+	hash_del(&w->hash_node);
+	w->dapm->card->dapm_conn_gen++;
 	/*
 	 * remove source and sink paths associated to this widget.
 	 * While removing the path, remove reference to it from both
@@ -2504,21 +2885,58 @@ static void dapm_free_widgets(struct snd_soc_dapm_context *dapm)
 	snd_soc_dapm_reset_cache(dapm);
 }
 
+static unsigned int dapm_widget_hash(const char *name)
+{
+	return full_name_hash(NULL, name, strlen(name));
+}
+
+/*
+ * Look up the widgets of the card named @name. The widget from @dapm is
+ * returned if there is one, otherwise @fallback is set to the last widget of
+ * that name added to the card. If @count isn't NULL it is set to the number
+ * of widgets of that name.
+ */
+static struct snd_soc_dapm_widget *dapm_lookup_widget(
+			struct snd_soc_dapm_context *dapm, const char *name,
+			struct snd_soc_dapm_widget **fallback, int *count)
+{
+	struct snd_soc_dapm_widget *w, *found = NULL;
+	int n = 0;
+
+	*fallback = NULL;
+
+	/* widgets are added at the head, latest first */
+	hash_for_each_possible(dapm->card->widget_hash, w, hash_node,
+			       dapm_widget_hash(name)) {
+		if (strcmp(w->name, name))
+			continue;
+
+		n++;
+		if (w->dapm == dapm) {
+			found = w;
+			if (!count)
+				break;
+		} else if (!*fallback) {
+			*fallback = w;
+		}
+	}
+
+	if (count)
+		*count = n;
+
+	return found;
+}
+
 static struct snd_soc_dapm_widget *dapm_find_widget(
 			struct snd_soc_dapm_context *dapm, const char *pin,
 			bool search_other_contexts)
 {
 	struct snd_soc_dapm_widget *w;
-	struct snd_soc_dapm_widget *fallback = NULL;
+	struct snd_soc_dapm_widget *fallback;
 
-	for_each_card_widgets(dapm->card, w) {
-		if (!strcmp(w->name, pin)) {
-			if (w->dapm == dapm)
-				return w;
-			else
-				fallback = w;
-		}
-	}
+	w = dapm_lookup_widget(dapm, pin, &fallback, NULL);
+	if (w)
+		return w;
 
 	if (search_other_contexts)
 		return fallback;
@@ -2876,15 +3294,15 @@ err:
 static int snd_soc_dapm_add_route(struct snd_soc_dapm_context *dapm,
 				  const struct snd_soc_dapm_route *route)
 {
-	struct snd_soc_dapm_widget *wsource = NULL, *wsink = NULL, *w;
+	struct snd_soc_dapm_widget *wsource = NULL, *wsink = NULL;
 	struct snd_soc_dapm_widget *wtsource = NULL, *wtsink = NULL;
 	const char *sink;
 	const char *source;
 	char prefixed_sink[80];
 	char prefixed_source[80];
 	const char *prefix;
-	unsigned int sink_ref = 0;
-	unsigned int source_ref = 0;
+	int sink_ref = 0;
+	int source_ref = 0;
 	int ret;
 
 	prefix = soc_dapm_prefix(dapm);
@@ -2910,34 +3328,19 @@ static int snd_soc_dapm_add_route(struct snd_soc_dapm_context *dapm,
 	 * find src and dest widgets over all widgets but favor a widget from
 	 * current DAPM context
 	 */
-	for_each_card_widgets(dapm->card, w) {
-		if (!wsink && !(strcmp(w->name, sink))) {
-			wtsink = w;
-			if (w->dapm == dapm) {
-				wsink = w;
-				if (wsource)
-					break;
-			}
-			sink_ref++;
-			if (sink_ref > 1)
-				dev_warn(dapm->dev,
-					"ASoC: sink widget %s overwritten\n",
-					w->name);
-			continue;
-		}
-		if (!wsource && !(strcmp(w->name, source))) {
-			wtsource = w;
-			if (w->dapm == dapm) {
-				wsource = w;
-				if (wsink)
-					break;
-			}
-			source_ref++;
-			if (source_ref > 1)
-				dev_warn(dapm->dev,
-					"ASoC: source widget %s overwritten\n",
-					w->name);
-		}
+	if (!wsink) {
+		wsink = dapm_lookup_widget(dapm, sink, &wtsink, &sink_ref);
+		if (sink_ref > 1)
+			dev_warn(dapm->dev,
+				 "ASoC: sink widget %s overwritten\n", sink);
+	}
+	if (!wsource) {
+		wsource = dapm_lookup_widget(dapm, source, &wtsource,
+					     &source_ref);
+		if (source_ref > 1)
+			dev_warn(dapm->dev,
+				 "ASoC: source widget %s overwritten\n",
+				 source);
 	}
 	/* use widget from another DAPM context if not found from this */
 	if (!wsink)
@@ -3705,6 +4108,8 @@ snd_soc_dapm_new_control_unlocked(struct snd_soc_dapm_context *dapm,
 	INIT_LIST_HEAD(&w->dirty);
 	/* see for_each_card_widgets */
 	list_add_tail(&w->list, &dapm->card->widgets);
+	hash_add(dapm->card->widget_hash, &w->hash_node,
+		 dapm_widget_hash(w->name));
 
 	snd_soc_dapm_for_each_direction(dir) {
 		INIT_LIST_HEAD(&w->edges[dir]);
@@ -4200,6 +4605,7 @@ int snd_soc_dapm_new_dai_widgets(struct snd_soc_dapm_context *dapm,
 
 		w->priv = dai;
 		dai->playback_widget = w;
+		dapm->card->dpcm_be_gen++;
 	}
 
 	if (dai->driver->capture.stream_name) {
@@ -4216,6 +4622,7 @@ int snd_soc_dapm_new_dai_widgets(struct snd_soc_dapm_context *dapm,
 
 		w->priv = dai;
 		dai->capture_widget = w;
+		dapm->card->dpcm_be_gen++;
 	}
 
 	return 0;
@@ -110,7 +110,7 @@ static int dmaengine_pcm_hw_params(struct snd_soc_component *component,
 			return ret;
 	}
 
-	return 0;
+	return snd_dmaengine_pcm_setup_sg(substream);
 }
 
 int snd_dmaengine_pcm_refine_runtime_hwparams(
@@ -135,6 +135,9 @@ int snd_dmaengine_pcm_refine_runtime_hwparams(
 			hw->info |= SNDRV_PCM_INFO_PAUSE | SNDRV_PCM_INFO_RESUME;
 		if (dma_caps.residue_granularity <= DMA_RESIDUE_GRANULARITY_SEGMENT)
 			hw->info |= SNDRV_PCM_INFO_BATCH;
+		/* the pointer is exact without period interrupts */
+		else if (!(hw->info & SNDRV_PCM_INFO_BATCH))
+			hw->info |= SNDRV_PCM_INFO_NO_PERIOD_WAKEUP;
 
 		if (substream->stream == SNDRV_PCM_STREAM_PLAYBACK)
 			addr_widths = dma_caps.dst_addr_widths;
@@ -306,6 +309,14 @@ static bool dmaengine_pcm_can_report_residue(struct device *dev,
 	return true;
 }
 
+static bool dmaengine_pcm_can_sg(struct dmaengine_pcm *pcm,
+				 struct dma_chan *chan)
+{
+	return (pcm->flags & SND_DMAENGINE_PCM_FLAG_SG) &&
+	       dma_has_cap(DMA_SLAVE, chan->device->cap_mask) &&
+	       chan->device->device_prep_slave_sg;
+}
+
 static int dmaengine_pcm_new(struct snd_soc_component *component,
 			     struct snd_soc_pcm_runtime *rtd)
 {
@@ -346,7 +357,8 @@ static int dmaengine_pcm_new(struct snd_soc_component *component,
 		}
 
 		snd_pcm_set_managed_buffer(substream,
-				SNDRV_DMA_TYPE_DEV_IRAM,
+				dmaengine_pcm_can_sg(pcm, pcm->chan[i]) ?
+				SNDRV_DMA_TYPE_DEV_SG : SNDRV_DMA_TYPE_DEV_IRAM,
 				dmaengine_dma_dev(pcm, substream),
 				prealloc_buffer_size,
 				max_buffer_size);
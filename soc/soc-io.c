@@ -175,6 +175,134 @@ void snd_soc_component_async_complete(struct snd_soc_component *component)
 }
 EXPORT_SYMBOL_GPL(snd_soc_component_async_complete);
 
+/**
+ * snd_soc_component_txn_begin() - Start a register update transaction
+ * @txn: Transaction to initialize
+ * @component: Component the registers belong to
+ *
+ * The updates queued with snd_soc_component_txn_update_bits() are applied
+ * by snd_soc_component_txn_commit(). For components with a regmap all the
+ * registers changed are then written with a single multi register write,
+ * which the bus may turn into one transaction.
+ */
+void snd_soc_component_txn_begin(struct snd_soc_component_txn *txn,
+				 struct snd_soc_component *component)
+{
+	txn->component = component;
+	txn->num = 0;
+	txn->change = 0;
+}
+EXPORT_SYMBOL_GPL(snd_soc_component_txn_begin);
+
+static int snd_soc_component_txn_apply(struct snd_soc_component_txn *txn)
+{
+	struct snd_soc_component *component = txn->component;
+	struct reg_sequence seq[SND_SOC_COMPONENT_TXN_MAX];
+	unsigned int i, n = 0, old, new;
+	int ret = 0;
+
+	if (!component->regmap) {
+		for (i = 0; i < txn->num && ret >= 0; i++) {
+			ret = snd_soc_component_update_bits(component,
+				txn->updates[i].reg, txn->updates[i].mask,
+				txn->updates[i].val);
+			if (ret > 0)
+				txn->change = 1;
+		}
+		goto out;
+	}
+
+	for (i = 0; i < txn->num; i++) {
+		ret = regmap_read(component->regmap, txn->updates[i].reg, &old);
+		if (ret < 0)
+			goto out;
+
+		new = (old & ~txn->updates[i].mask) |
+		      (txn->updates[i].val & txn->updates[i].mask);
+		if (new == old)
+			continue;
+
+		seq[n].reg = txn->updates[i].reg;
+		seq[n].def = new;
+		seq[n].delay_us = 0;
+		n++;
+	}
+
+	if (n) {
+		ret = regmap_multi_reg_write(component->regmap, seq, n);
+		if (ret == 0)
+			txn->change = 1;
+	}
+out:
+	txn->num = 0;
+
+	return ret < 0 ? ret : 0;
+}
+
+/**
+ * snd_soc_component_txn_update_bits() - Queue a read/modify/write cycle
+ * @txn: Transaction started with snd_soc_component_txn_begin()
+ * @reg: Register to update
+ * @mask: Mask that specifies which bits to update
+ * @val: New value for the bits specified by mask
+ *
+ * Updates of a register already queued are merged. If the transaction is
+ * full the queued updates are applied first.
+ *
+ * Return: 0 on success, a negative error code otherwise.
+ */
+int snd_soc_component_txn_update_bits(struct snd_soc_component_txn *txn,
+				      unsigned int reg, unsigned int mask,
+				      unsigned int val)
+{
+	unsigned int i;
+	int ret;
+
+	for (i = 0; i < txn->num; i++) {
+		if (txn->updates[i].reg != reg)
+			continue;
+
+		txn->updates[i].val &= ~mask;
+		txn->updates[i].val |= val & mask;
+		txn->updates[i].mask |= mask;
+		return 0;
+	}
+
+	if (txn->num == SND_SOC_COMPONENT_TXN_MAX) {
+		ret = snd_soc_component_txn_apply(txn);
+		if (ret < 0)
+			return ret;
+	}
+
+	txn->updates[txn->num].reg = reg;
+	txn->updates[txn->num].mask = mask;
+	txn->updates[txn->num].val = val;
+	txn->num++;
+
+	return 0;
+}
+EXPORT_SYMBOL_GPL(snd_soc_component_txn_update_bits);
+
+/**
+ * snd_soc_component_txn_commit() - Apply a register update transaction
+ * @txn: Transaction started with snd_soc_component_txn_begin()
+ *
+ * Return: 1 if the operation was successful and the value of a register
+ * changed, 0 if the operation was successful, but no value changed.
+ * Returns a negative error code otherwise.
+ */
+int snd_soc_component_txn_commit(struct snd_soc_component_txn *txn)
+{
+	int ret;
+
+	ret = snd_soc_component_txn_apply(txn);
+	if (ret < 0)
+		return ret;
+
+	return txn->change;
+}
+EXPORT_SYMBOL_GPL(snd_soc_component_txn_commit);
+
 /**
  * snd_soc_component_test_bits - Test register for change
  * @component: component
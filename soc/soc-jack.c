@@ -61,35 +61,21 @@ int snd_soc_card_jack_new(struct snd_soc_card *card, const char *id, int type,
 }
 EXPORT_SYMBOL_GPL(snd_soc_card_jack_new);
 
-/**
- * snd_soc_jack_report - Report the current status for a jack
- *
- * @jack:   the jack
- * @status: a bitmask of enum snd_jack_type values that are currently detected.
- * @mask:   a bitmask of enum snd_jack_type values that being reported.
- *
- * If configured using snd_soc_jack_add_pins() then the associated
- * DAPM pins will be enabled or disabled as appropriate and DAPM
- * synchronised.
- *
- * Note: This function uses mutexes and should be called from a
- * context which can sleep (such as a workqueue).
+/*
+ * Update the status and the DAPM pins of a jack and notify the jack
+ * notifiers. Called with jack->mutex held, returns true if DAPM needs
+ * to be synchronised.
  */
-void snd_soc_jack_report(struct snd_soc_jack *jack, int status, int mask)
+static bool snd_soc_jack_update(struct snd_soc_jack *jack, int status,
+				int mask)
 {
-	struct snd_soc_dapm_context *dapm;
+	struct snd_soc_dapm_context *dapm = &jack->card->dapm;
 	struct snd_soc_jack_pin *pin;
-	unsigned int sync = 0;
+	bool sync = false;
 	int enable;
 
-	if (!jack)
-		return;
 	trace_snd_soc_jack_report(jack, mask, status);
 
-	dapm = &jack->card->dapm;
-
-	mutex_lock(&jack->mutex);
-
 	jack->status &= ~mask;
 	jack->status |= status & mask;
 
@@ -107,14 +93,38 @@ void snd_soc_jack_report(struct snd_soc_jack *jack, int status, int mask)
 			snd_soc_dapm_disable_pin(dapm, pin->pin);
 
 		/* we need to sync for this case only */
-		sync = 1;
+		sync = true;
 	}
 
 	/* Report before the DAPM sync to help users updating micbias status */
 	blocking_notifier_call_chain(&jack->notifier, jack->status, jack);
 
-	if (sync)
-		snd_soc_dapm_sync(dapm);
+	return sync;
+}
+
+/**
+ * snd_soc_jack_report - Report the current status for a jack
+ *
+ * @jack:   the jack
+ * @status: a bitmask of enum snd_jack_type values that are currently detected.
+ * @mask:   a bitmask of enum snd_jack_type values that being reported.
+ *
+ * If configured using snd_soc_jack_add_pins() then the associated
+ * DAPM pins will be enabled or disabled as appropriate and DAPM
+ * synchronised.
+ *
+ * Note: This function uses mutexes and should be called from a
+ * context which can sleep (such as a workqueue).
+ */
+void snd_soc_jack_report(struct snd_soc_jack *jack, int status, int mask)
+{
+	if (!jack)
+		return;
+
+	mutex_lock(&jack->mutex);
+
+	if (snd_soc_jack_update(jack, status, mask))
+		snd_soc_dapm_sync(&jack->card->dapm);
 
 	snd_jack_report(jack->jack, jack->status);
 
@@ -122,6 +132,71 @@ void snd_soc_jack_report(struct snd_soc_jack *jack, int status, int mask)
 }
 EXPORT_SYMBOL_GPL(snd_soc_jack_report);
 
+/**
+ * snd_soc_jack_report_batch - Report the status of several jacks at once
+ *
+ * @updates: the jacks and the status to report for each of them
+ * @num:     number of elements in the @updates array
+ *
+ * Like snd_soc_jack_report() for each element of @updates, but the DAPM
+ * pins of all the jacks are updated first and each card is synchronised
+ * only once, so a dock or headset event flipping the pins of several
+ * jacks results in a single DAPM run. The jack notifiers are called
+ * before the DAPM sync and the jack status is reported after it, as
+ * with snd_soc_jack_report().
+ *
+ * Note: This function uses mutexes and should be called from a
+ * context which can sleep (such as a workqueue).
+ */
+void snd_soc_jack_report_batch(const struct snd_soc_jack_update *updates,
+			       int num)
+{
+	struct snd_soc_jack *jack, *prev;
+	bool sync;
+	int i, j;
+
+	for (i = 0; i < num; i++) {
+		jack = updates[i].jack;
+		if (!jack)
+			continue;
+
+		mutex_lock(&jack->mutex);
+		snd_soc_jack_update(jack, updates[i].status, updates[i].mask);
+		mutex_unlock(&jack->mutex);
+	}
+
+	/* only jacks with pins need a sync, once per card */
+	for (i = 0; i < num; i++) {
+		jack = updates[i].jack;
+		if (!jack || list_empty(&jack->pins))
+			continue;
+
+		sync = true;
+		for (j = 0; j < i; j++) {
+			prev = updates[j].jack;
+			if (prev && prev->card == jack->card &&
+			    !list_empty(&prev->pins)) {
+				sync = false;
+				break;
+			}
+		}
+
+		if (sync)
+			snd_soc_dapm_sync(&jack->card->dapm);
+	}
+
+	for (i = 0; i < num; i++) {
+		jack = updates[i].jack;
+		if (!jack)
+			continue;
+
+		mutex_lock(&jack->mutex);
+		snd_jack_report(jack->jack, jack->status);
+		mutex_unlock(&jack->mutex);
+	}
+}
+EXPORT_SYMBOL_GPL(snd_soc_jack_report_batch);
+
 /**
  * snd_soc_jack_add_zones - Associate voltage zones with jack
  *
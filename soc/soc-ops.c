@@ -314,6 +314,7 @@ int snd_soc_put_volsw(struct snd_kcontrol *kcontrol,
 	unsigned int sign_bit = mc->sign_bit;
 	unsigned int mask = (1 << fls(max)) - 1;
 	unsigned int invert = mc->invert;
+	struct snd_soc_component_txn txn;
 	int err;
 	bool type_2r = false;
 	unsigned int val2 = 0;
@@ -339,15 +340,21 @@ int snd_soc_put_volsw(struct snd_kcontrol *kcontrol,
 			type_2r = true;
 		}
 	}
-	err = snd_soc_component_update_bits(component, reg, val_mask, val);
+	/* both channels are written at once */
+	snd_soc_component_txn_begin(&txn, component);
+
+	err = snd_soc_component_txn_update_bits(&txn, reg, val_mask, val);
 	if (err < 0)
 		return err;
 
-	if (type_2r)
-		err = snd_soc_component_update_bits(component, reg2, val_mask,
+	if (type_2r) {
+		err = snd_soc_component_txn_update_bits(&txn, reg2, val_mask,
 			val2);
+		if (err < 0)
+			return err;
+	}
 
-	return err;
+	return snd_soc_component_txn_commit(&txn);
 }
 EXPORT_SYMBOL_GPL(snd_soc_put_volsw);
 
@@ -419,6 +426,7 @@ int snd_soc_put_volsw_sx(struct snd_kcontrol *kcontrol,
 	int max = mc->max;
 	int min = mc->min;
 	unsigned int mask = (1U << (fls(min + max) - 1)) - 1;
+	struct snd_soc_component_txn txn;
 	int err = 0;
 	unsigned int val, val_mask, val2 = 0;
 
@@ -426,7 +434,9 @@ int snd_soc_put_volsw_sx(struct snd_kcontrol *kcontrol,
 	val = (ucontrol->value.integer.value[0] + min) & mask;
 	val = val << shift;
 
-	err = snd_soc_component_update_bits(component, reg, val_mask, val);
+	snd_soc_component_txn_begin(&txn, component);
+
+	err = snd_soc_component_txn_update_bits(&txn, reg, val_mask, val);
 	if (err < 0)
 		return err;
 
@@ -435,10 +445,13 @@ int snd_soc_put_volsw_sx(struct snd_kcontrol *kcontrol,
 		val2 = (ucontrol->value.integer.value[1] + min) & mask;
 		val2 = val2 << rshift;
 
-		err = snd_soc_component_update_bits(component, reg2, val_mask,
+		err = snd_soc_component_txn_update_bits(&txn, reg2, val_mask,
 			val2);
+		if (err < 0)
+			return err;
 	}
-	return err;
+
+	return snd_soc_component_txn_commit(&txn);
 }
 EXPORT_SYMBOL_GPL(snd_soc_put_volsw_sx);
 
@@ -495,6 +508,7 @@ int snd_soc_put_volsw_range(struct snd_kcontrol *kcontrol,
 	int max = mc->max;
 	unsigned int mask = (1 << fls(max)) - 1;
 	unsigned int invert = mc->invert;
+	struct snd_soc_component_txn txn;
 	unsigned int val, val_mask;
 	int ret;
 
@@ -505,7 +519,9 @@ int snd_soc_put_volsw_range(struct snd_kcontrol *kcontrol,
 	val_mask = mask << shift;
 	val = val << shift;
 
-	ret = snd_soc_component_update_bits(component, reg, val_mask, val);
+	snd_soc_component_txn_begin(&txn, component);
+
+	ret = snd_soc_component_txn_update_bits(&txn, reg, val_mask, val);
 	if (ret < 0)
 		return ret;
 
@@ -517,11 +533,13 @@ int snd_soc_put_volsw_range(struct snd_kcontrol *kcontrol,
 		val_mask = mask << shift;
 		val = val << shift;
 
-		ret = snd_soc_component_update_bits(component, rreg, val_mask,
+		ret = snd_soc_component_txn_update_bits(&txn, rreg, val_mask,
 			val);
+		if (ret < 0)
+			return ret;
 	}
 
-	return ret;
+	return snd_soc_component_txn_commit(&txn);
 }
 EXPORT_SYMBOL_GPL(snd_soc_put_volsw_range);
 
@@ -879,22 +897,26 @@ int snd_soc_put_xr_sx(struct snd_kcontrol *kcontrol,
 	unsigned long mask = (1UL<<mc->nbits)-1;
 	long max = mc->max;
 	long val = ucontrol->value.integer.value[0];
+	struct snd_soc_component_txn txn;
 	unsigned int i, regval, regmask;
 	int err;
 
 	if (invert)
 		val = max - val;
 	val &= mask;
+	snd_soc_component_txn_begin(&txn, component);
 	for (i = 0; i < regcount; i++) {
 		regval = (val >> (regwshift*(regcount-i-1))) & regwmask;
 		regmask = (mask >> (regwshift*(regcount-i-1))) & regwmask;
-		err = snd_soc_component_update_bits(component, regbase+i,
+		err = snd_soc_component_txn_update_bits(&txn, regbase+i,
 				regmask, regval);
 		if (err < 0)
 			return err;
 	}
 
-	return 0;
+	err = snd_soc_component_txn_commit(&txn);
+
+	return err < 0 ? err : 0;
 }
 EXPORT_SYMBOL_GPL(snd_soc_put_xr_sx);
 
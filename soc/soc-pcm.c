@@ -12,6 +12,7 @@
 
 #include <linux/kernel.h>
 #include <linux/init.h>
+#include <linux/async.h>
 #include <linux/delay.h>
 #include <linux/pinctrl/consumer.h>
 #include <linux/pm_runtime.h>
@@ -925,20 +926,19 @@ static void codec2codec_close_delayed_work(struct snd_soc_pcm_runtime *rtd)
  * rate, etc.  This function is non atomic and can be called multiple times,
  * it can refer to the runtime info.
  */
-static int soc_pcm_prepare(struct snd_pcm_substream *substream)
+/* prepare the machine, components and DAIs, pcm_mutex held */
+static int soc_pcm_prepare_dais(struct snd_soc_pcm_runtime *rtd,
+				struct snd_pcm_substream *substream)
 {
-	struct snd_soc_pcm_runtime *rtd = substream->private_data;
 	struct snd_soc_component *component;
 	struct snd_soc_dai *dai;
-	int i, ret = 0;
-
-	mutex_lock_nested(&rtd->card->pcm_mutex, rtd->card->pcm_subclass);
+	int i, ret;
 
 	ret = soc_rtd_prepare(rtd, substream);
 	if (ret < 0) {
 		dev_err(rtd->card->dev,
 			"ASoC: machine prepare error: %d\n", ret);
-		goto out;
+		return ret;
 	}
 
 	for_each_rtd_components(rtd, i, component) {
@@ -946,7 +946,7 @@ static int soc_pcm_prepare(struct snd_pcm_substream *substream)
 		if (ret < 0) {
 			dev_err(component->dev,
 				"ASoC: platform prepare error: %d\n", ret);
-			goto out;
+			return ret;
 		}
 	}
 
@@ -955,10 +955,20 @@ static int soc_pcm_prepare(struct snd_pcm_substream *substream)
 		if (ret < 0) {
 			dev_err(dai->dev,
 				"ASoC: DAI prepare error: %d\n", ret);
-			goto out;
+			return ret;
 		}
 	}
 
+	return 0;
+}
+
+/* start the stream once prepared, pcm_mutex held */
+static void soc_pcm_prepare_done(struct snd_soc_pcm_runtime *rtd,
+				 struct snd_pcm_substream *substream)
+{
+	struct snd_soc_dai *dai;
+	int i;
+
 	/* cancel any delayed stream shutdown that is pending */
 	if (substream->stream == SNDRV_PCM_STREAM_PLAYBACK &&
 	    rtd->pop_wait) {
@@ -971,8 +981,19 @@ static int soc_pcm_prepare(struct snd_pcm_substream *substream)
 
 	for_each_rtd_dais(rtd, i, dai)
 		snd_soc_dai_digital_mute(dai, 0, substream->stream);
+}
+
+static int soc_pcm_prepare(struct snd_pcm_substream *substream)
+{
+	struct snd_soc_pcm_runtime *rtd = substream->private_data;
+	int ret;
+
+	mutex_lock_nested(&rtd->card->pcm_mutex, rtd->card->pcm_subclass);
+
+	ret = soc_pcm_prepare_dais(rtd, substream);
+	if (ret == 0)
+		soc_pcm_prepare_done(rtd, substream);
 
-out:
 	mutex_unlock(&rtd->card->pcm_mutex);
 	return ret;
 }
@@ -1302,6 +1323,10 @@ static snd_pcm_uframes_t soc_pcm_pointer(struct snd_pcm_substream *substream)
 
 	offset = snd_soc_pcm_component_pointer(substream);
 
+	/* most links have no DAI reporting a delay, keep this path short */
+	if (!rtd->dai_delay)
+		return offset;
+
 	/* base delay if assigned in pointer callback */
 	delay = runtime->delay;
 
@@ -1425,8 +1450,28 @@ static struct snd_soc_pcm_runtime *dpcm_get_be(struct snd_soc_card *card,
 	struct snd_soc_dai *dai;
 	int i;
 
+	/* only the stream widgets of the DAIs can belong to a BE */
+	switch (widget->id) {
+	case snd_soc_dapm_dai_in:
+		if (stream != SNDRV_PCM_STREAM_PLAYBACK)
+			return NULL;
+		break;
+	case snd_soc_dapm_dai_out:
+		if (stream != SNDRV_PCM_STREAM_CAPTURE)
+			return NULL;
+		break;
+	default:
+		return NULL;
+	}
+
+	if (widget->dpcm_be_gen == card->dpcm_be_gen)
+		return widget->dpcm_be;
+
 	dev_dbg(card->dev, "ASoC: find BE for widget %s\n", widget->name);
 
+	widget->dpcm_be_gen = card->dpcm_be_gen;
+	widget->dpcm_be = NULL;
+
 	for_each_card_rtds(card, be) {
 
 		if (!be->dai_link->no_pcm)
@@ -1438,8 +1483,10 @@ static struct snd_soc_pcm_runtime *dpcm_get_be(struct snd_soc_card *card,
 			dev_dbg(card->dev, "ASoC: try BE : %s\n",
 				w ? w->name : "(not set)");
 
-			if (w == widget)
+			if (w == widget) {
+				widget->dpcm_be = be;
 				return be;
+			}
 		}
 	}
 
@@ -1480,10 +1527,31 @@ static bool dpcm_end_walk_at_be(struct snd_soc_dapm_widget *widget,
 	return false;
 }
 
+static size_t dpcm_path_size(struct snd_soc_dapm_widget_list *list)
+{
+	return struct_size(list, widgets, list->num_widgets);
+}
+
+/*
+ * The paths of a FE only change along with the connectivity of the DAPM
+ * graph or the set of BEs, the walk stopping at them.
+ */
+static bool dpcm_path_cache_valid(struct snd_soc_pcm_runtime *fe, int stream)
+{
+	struct snd_soc_dpcm_runtime *dpcm = &fe->dpcm[stream];
+
+	return dpcm->path_cache &&
+	       dpcm->path_conn_gen == fe->card->dapm_conn_gen &&
+	       dpcm->path_be_gen == fe->card->dpcm_be_gen;
+}
+
 int dpcm_path_get(struct snd_soc_pcm_runtime *fe,
 	int stream, struct snd_soc_dapm_widget_list **list)
 {
+	struct snd_soc_dpcm_runtime *dpcm = &fe->dpcm[stream];
+	struct snd_soc_card *card = fe->card;
 	struct snd_soc_dai *cpu_dai = fe->cpu_dai;
+	unsigned int conn_gen, be_gen;
 	int paths;
 
 	if (fe->num_cpus > 1) {
@@ -1492,6 +1560,17 @@ int dpcm_path_get(struct snd_soc_pcm_runtime *fe,
 		return -EINVAL;
 	}
 
+	if (dpcm_path_cache_valid(fe, stream)) {
+		*list = kmemdup(dpcm->path_cache,
+				dpcm_path_size(dpcm->path_cache), GFP_KERNEL);
+		if (*list)
+			return dpcm->path_count;
+	}
+
+	/* sampled first, a change during the walk invalidates the result */
+	conn_gen = card->dapm_conn_gen;
+	be_gen = card->dpcm_be_gen;
+
 	/* get number of valid DAI paths and their widgets */
 	paths = snd_soc_dapm_dai_get_connected_widgets(cpu_dai, stream, list,
 			dpcm_end_walk_at_be);
@@ -1499,6 +1578,15 @@ int dpcm_path_get(struct snd_soc_pcm_runtime *fe,
 	dev_dbg(fe->dev, "ASoC: found %d audio %s paths\n", paths,
 			stream ? "capture" : "playback");
 
+	if (paths < 0)
+		return paths;
+
+	kfree(dpcm->path_cache);
+	dpcm->path_cache = kmemdup(*list, dpcm_path_size(*list), GFP_KERNEL);
+	dpcm->path_count = paths;
+	dpcm->path_conn_gen = conn_gen;
+	dpcm->path_be_gen = be_gen;
+
 	return paths;
 }
 
@@ -2533,25 +2621,133 @@ static int dpcm_fe_dai_trigger(struct snd_pcm_substream *substream, int cmd)
 	return dpcm_fe_dai_do_trigger(substream, cmd);
 }
 
+static bool dpcm_be_can_prepare(struct snd_soc_pcm_runtime *fe,
+				struct snd_soc_pcm_runtime *be, int stream)
+{
+	/* is this op for this BE ? */
+	if (!snd_soc_dpcm_be_can_update(fe, be, stream))
+		return false;
+
+	return be->dpcm[stream].state == SND_SOC_DPCM_STATE_HW_PARAMS ||
+	       be->dpcm[stream].state == SND_SOC_DPCM_STATE_STOP ||
+	       be->dpcm[stream].state == SND_SOC_DPCM_STATE_SUSPEND ||
+	       be->dpcm[stream].state == SND_SOC_DPCM_STATE_PAUSED;
+}
+
+/* most BEs of a FE prepared concurrently */
+#define DPCM_ASYNC_PREPARE_MAX	8
+
+struct dpcm_be_prepare_job {
+	struct snd_soc_pcm_runtime *be;
+	struct snd_pcm_substream *substream;
+	int ret;
+};
+
+static void dpcm_be_prepare_async(void *data, async_cookie_t cookie)
+{
+	struct dpcm_be_prepare_job *job = data;
+
+	dev_dbg(job->be->dev, "ASoC: prepare BE %s\n",
+		job->be->dai_link->name);
+
+	job->ret = soc_pcm_prepare_dais(job->be, job->substream);
+}
+
+static bool dpcm_be_share_component(struct snd_soc_pcm_runtime *a,
+				    struct snd_soc_pcm_runtime *b)
+{
+	struct snd_soc_component *ca, *cb;
+	int i, j;
+
+	for_each_rtd_components(a, i, ca)
+		for_each_rtd_components(b, j, cb)
+			if (ca == cb)
+				return true;
+
+	return false;
+}
+
+/*
+ * Prepare the BEs of @fe concurrently, as prepare may have to go through
+ * slow bus transactions (e.g. SoundWire stream setup). Only the driver
+ * callbacks run in parallel, each of the BEs then gets its DAPM stream
+ * event in order. BEs sharing a component are prepared one after another
+ * by dpcm_be_dai_prepare() instead, in which case false is returned.
+ */
+static bool dpcm_be_dai_prepare_concurrent(struct snd_soc_pcm_runtime *fe,
+					   int stream, int *ret)
+{
+	ASYNC_DOMAIN_EXCLUSIVE(async_domain);
+	struct dpcm_be_prepare_job jobs[DPCM_ASYNC_PREPARE_MAX];
+	struct snd_soc_card *card = fe->card;
+	struct snd_soc_dpcm *dpcm;
+	int num_jobs = 0;
+	int i;
+
+	for_each_dpcm_be(fe, stream, dpcm) {
+		if (!dpcm_be_can_prepare(fe, dpcm->be, stream))
+			continue;
+		if (num_jobs == DPCM_ASYNC_PREPARE_MAX)
+			return false;
+		for (i = 0; i < num_jobs; i++)
+			if (dpcm_be_share_component(jobs[i].be, dpcm->be))
+				return false;
+
+		jobs[num_jobs].be = dpcm->be;
+		jobs[num_jobs].substream =
+			snd_soc_dpcm_get_substream(dpcm->be, stream);
+		jobs[num_jobs].ret = 0;
+		num_jobs++;
+	}
+
+	if (num_jobs < 2)
+		return false;
+
+	mutex_lock_nested(&card->pcm_mutex, card->pcm_subclass);
+
+	for (i = 1; i < num_jobs; i++)
+		async_schedule_domain(dpcm_be_prepare_async, &jobs[i],
+				      &async_domain);
+	dpcm_be_prepare_async(&jobs[0], 0);
+	async_synchronize_full_domain(&async_domain);
+
+	*ret = 0;
+	for (i = 0; i < num_jobs; i++) {
+		struct snd_soc_pcm_runtime *be = jobs[i].be;
+
+		if (jobs[i].ret < 0) {
+			dev_err(be->dev, "ASoC: backend prepare failed %d\n",
+				jobs[i].ret);
+			if (!*ret)
+				*ret = jobs[i].ret;
+			continue;
+		}
+
+		soc_pcm_prepare_done(be, jobs[i].substream);
+		be->dpcm[stream].state = SND_SOC_DPCM_STATE_PREPARE;
+	}
+
+	mutex_unlock(&card->pcm_mutex);
+
+	return true;
+}
+
 int dpcm_be_dai_prepare(struct snd_soc_pcm_runtime *fe, int stream)
 {
 	struct snd_soc_dpcm *dpcm;
 	int ret = 0;
 
+	if (fe->dai_link->dpcm_async_prepare &&
+	    dpcm_be_dai_prepare_concurrent(fe, stream, &ret))
+		return ret;
+
 	for_each_dpcm_be(fe, stream, dpcm) {
 
 		struct snd_soc_pcm_runtime *be = dpcm->be;
 		struct snd_pcm_substream *be_substream =
 			snd_soc_dpcm_get_substream(be, stream);
 
-		/* is this op for this BE ? */
-		if (!snd_soc_dpcm_be_can_update(fe, be, stream))
-			continue;
-
-		if ((be->dpcm[stream].state != SND_SOC_DPCM_STATE_HW_PARAMS) &&
-		    (be->dpcm[stream].state != SND_SOC_DPCM_STATE_STOP) &&
-		    (be->dpcm[stream].state != SND_SOC_DPCM_STATE_SUSPEND) &&
-		    (be->dpcm[stream].state != SND_SOC_DPCM_STATE_PAUSED))
+		if (!dpcm_be_can_prepare(fe, be, stream))
 			continue;
 
 		dev_dbg(be->dev, "ASoC: prepare BE %s\n",
@@ -3018,6 +3214,12 @@ int soc_new_pcm(struct snd_soc_pcm_runtime *rtd, int num)
 		rtd->ops.pointer	= soc_pcm_pointer;
 	}
 
+	/* the pointer is queried often, only call the DAIs needed there */
+	rtd->dai_delay = 0;
+	for_each_rtd_dais(rtd, i, cpu_dai)
+		if (cpu_dai->driver->ops->delay)
+			rtd->dai_delay = 1;
+
 	for_each_rtd_components(rtd, i, component) {
 		const struct snd_soc_component_driver *drv = component->driver;
 
@@ -3025,6 +3227,8 @@ int soc_new_pcm(struct snd_soc_pcm_runtime *rtd, int num)
 			rtd->ops.ioctl		= snd_soc_pcm_component_ioctl;
 		if (drv->sync_stop)
 			rtd->ops.sync_stop	= snd_soc_pcm_component_sync_stop;
+		if (drv->ack)
+			rtd->ops.ack		= snd_soc_pcm_component_ack;
 		if (drv->copy_user)
 			rtd->ops.copy_user	= snd_soc_pcm_component_copy_user;
 		if (drv->page)
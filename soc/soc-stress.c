@@ -0,0 +1,412 @@
+// SPDX-License-Identifier: GPL-2.0
+//
+// soc-stress.c  --  Synthetic ASoC card for DAPM/DPCM scalability tests
+//
+// Builds a DPCM card out of a single component with a configurable
+// number of front ends, back ends, mixer stages and mixer fan-in, on top
+// of the dummy codec and platform. The mixer switches are backed by an
+// in-memory regmap with a configurable latency per write, so the cost of
+// DAPM graph walks, DPCM path lookups and register I/O can be measured
+// without any hardware.
+//
+// For each back end b the graph contains "stages" mixers "P<b> S<k>".
+// Mixer k of back end b takes "fanin" inputs: the FE stream widgets
+// (k == 0) or mixer k - 1 of the following back ends (k > 0), each
+// through its own "In<j> Switch". The last mixer feeds the BE DAI stream
+// widget "BE<b> Tx", which ends at the output "BE<b> Out". All switches
+// start enabled, so every FE reaches every BE once fanin * stages covers
+// the back ends.
+
+#include <linux/delay.h>
+#include <linux/module.h>
+#include <linux/platform_device.h>
+#include <linux/regmap.h>
+#include <linux/slab.h>
+#include <dkms/sound/soc.h>
+#include <dkms/sound/soc-dapm.h>
+
+#define SND_SOC_STRESS_MAX		64
+#define SND_SOC_STRESS_MAX_FANIN	32
+
+static int fes = 4;
+module_param(fes, int, 0444);
+MODULE_PARM_DESC(fes, "Number of front end DAI links");
+
+static int bes = 4;
+module_param(bes, int, 0444);
+MODULE_PARM_DESC(bes, "Number of back end DAI links");
+
+static int stages = 8;
+module_param(stages, int, 0444);
+MODULE_PARM_DESC(stages, "Number of mixer widgets on each back end path");
+
+static int fanin = 2;
+module_param(fanin, int, 0444);
+MODULE_PARM_DESC(fanin, "Number of inputs of each mixer widget");
+
+static unsigned int write_latency_us;
+module_param(write_latency_us, uint, 0644);
+MODULE_PARM_DESC(write_latency_us, "Simulated latency per register write, in us");
+
+/**
+ * struct snd_soc_stress - synthetic card instance
+ *
+ * @card: the DPCM card
+ * @regs: register file, one mixer per register and one switch per bit
+ * @num_fes: number of front ends
+ * @num_bes: number of back ends
+ * @num_stages: number of mixers on each back end path
+ * @fanin: number of inputs of each mixer
+ */
+struct snd_soc_stress {
+	struct snd_soc_card card;
+	u32 *regs;
+	int num_fes;
+	int num_bes;
+	int num_stages;
+	int fanin;
+};
+
+#define card_to_stress(_card) container_of(_card, struct snd_soc_stress, card)
+
+static int snd_soc_stress_reg_read(void *context, unsigned int reg,
+				   unsigned int *val)
+{
+	struct snd_soc_stress *stress = context;
+
+	*val = stress->regs[reg];
+	return 0;
+}
+
+static int snd_soc_stress_reg_write(void *context, unsigned int reg,
+				    unsigned int val)
+{
+	struct snd_soc_stress *stress = context;
+	unsigned int us = READ_ONCE(write_latency_us);
+
+	stress->regs[reg] = val;
+
+	if (!us)
+		return 0;
+
+	if (us < 10)
+		udelay(us);
+	else
+		usleep_range(us, us + us / 10 + 1);
+
+	return 0;
+}
+
+static int snd_soc_stress_mixer_reg(struct snd_soc_stress *stress,
+				    int be, int stage)
+{
+	return be * stress->num_stages + stage;
+}
+
+static int snd_soc_stress_new_mixer(struct device *dev,
+				    struct snd_soc_stress *stress,
+				    struct snd_soc_dapm_widget *w,
+				    int be, int stage)
+{
+	struct snd_kcontrol_new *kc;
+	struct soc_mixer_control *mc;
+	int j;
+
+	kc = devm_kcalloc(dev, stress->fanin, sizeof(*kc), GFP_KERNEL);
+	mc = devm_kcalloc(dev, stress->fanin, sizeof(*mc), GFP_KERNEL);
+	if (!kc || !mc)
+		return -ENOMEM;
+
+	for (j = 0; j < stress->fanin; j++) {
+		mc[j].reg = snd_soc_stress_mixer_reg(stress, be, stage);
+		mc[j].rreg = mc[j].reg;
+		mc[j].shift = j;
+		mc[j].rshift = j;
+		mc[j].max = 1;
+		mc[j].platform_max = 1;
+
+		kc[j].iface = SNDRV_CTL_ELEM_IFACE_MIXER;
+		kc[j].name = devm_kasprintf(dev, GFP_KERNEL, "In%d Switch", j);
+		if (!kc[j].name)
+			return -ENOMEM;
+		kc[j].info = snd_soc_info_volsw;
+		kc[j].get = snd_soc_dapm_get_volsw;
+		kc[j].put = snd_soc_dapm_put_volsw;
+		kc[j].private_value = (unsigned long)&mc[j];
+	}
+
+	w->id = snd_soc_dapm_mixer;
+	w->name = devm_kasprintf(dev, GFP_KERNEL, "P%d S%d", be, stage);
+	if (!w->name)
+		return -ENOMEM;
+	w->reg = SND_SOC_NOPM;
+	w->kcontrol_news = kc;
+	w->num_kcontrols = stress->fanin;
+
+	return 0;
+}
+
+static int snd_soc_stress_probe(struct snd_soc_component *component)
+{
+	struct snd_soc_dapm_context *dapm =
+		snd_soc_component_get_dapm(component);
+	struct snd_soc_stress *stress = card_to_stress(component->card);
+	struct device *dev = component->dev;
+	struct snd_soc_dapm_widget *widgets, *w;
+	struct snd_soc_dapm_route *routes, *r;
+	int num_widgets, num_routes;
+	int b, k, j, ret;
+
+	num_widgets = stress->num_bes * (stress->num_stages + 1);
+	num_routes = stress->num_bes *
+		     (stress->num_stages * stress->fanin + 2);
+
+	widgets = devm_kcalloc(dev, num_widgets, sizeof(*widgets), GFP_KERNEL);
+	routes = devm_kcalloc(dev, num_routes, sizeof(*routes), GFP_KERNEL);
+	if (!widgets || !routes)
+		return -ENOMEM;
+
+	w = widgets;
+	r = routes;
+	for (b = 0; b < stress->num_bes; b++) {
+		for (k = 0; k < stress->num_stages; k++) {
+			ret = snd_soc_stress_new_mixer(dev, stress, w, b, k);
+			if (ret < 0)
+				return ret;
+
+			for (j = 0; j < stress->fanin; j++, r++) {
+				r->sink = w->name;
+				r->control = w->kcontrol_news[j].name;
+				if (k)
+					r->source = devm_kasprintf(dev,
+						GFP_KERNEL, "P%d S%d",
+						(b + j) % stress->num_bes,
+						k - 1);
+				else
+					r->source = devm_kasprintf(dev,
+						GFP_KERNEL, "FE%d Playback",
+						(b + j) % stress->num_fes);
+				if (!r->source)
+					return -ENOMEM;
+			}
+			w++;
+		}
+
+		r->sink = devm_kasprintf(dev, GFP_KERNEL, "BE%d Tx", b);
+		r->source = w[-1].name;
+		r++;
+
+		w->id = snd_soc_dapm_output;
+		w->name = devm_kasprintf(dev, GFP_KERNEL, "BE%d Out", b);
+		w->reg = SND_SOC_NOPM;
+		r->sink = w->name;
+		r->source = r[-1].sink;
+		if (!r[-1].sink || !w->name)
+			return -ENOMEM;
+		r++;
+		w++;
+	}
+
+	ret = snd_soc_dapm_new_controls(dapm, widgets, num_widgets);
+	if (ret < 0)
+		return ret;
+
+	return snd_soc_dapm_add_routes(dapm, routes, num_routes);
+}
+
+static const struct snd_soc_component_driver snd_soc_stress_component = {
+	.name = "snd-soc-stress",
+	.probe = snd_soc_stress_probe,
+};
+
+static int snd_soc_stress_new_dais(struct device *dev,
+				   struct snd_soc_stress *stress,
+				   struct snd_soc_dai_driver **drvs)
+{
+	struct snd_soc_dai_driver *drv;
+	int num = stress->num_fes + stress->num_bes;
+	int i, id;
+
+	drv = devm_kcalloc(dev, num, sizeof(*drv), GFP_KERNEL);
+	if (!drv)
+		return -ENOMEM;
+
+	for (i = 0; i < num; i++) {
+		if (i < stress->num_fes) {
+			id = i;
+			drv[i].name = devm_kasprintf(dev, GFP_KERNEL,
+						     "stress-fe%d", id);
+			drv[i].playback.stream_name =
+				devm_kasprintf(dev, GFP_KERNEL,
+					       "FE%d Playback", id);
+		} else {
+			id = i - stress->num_fes;
+			drv[i].name = devm_kasprintf(dev, GFP_KERNEL,
+						     "stress-be%d", id);
+			drv[i].playback.stream_name =
+				devm_kasprintf(dev, GFP_KERNEL, "BE%d Tx", id);
+		}
+		if (!drv[i].name || !drv[i].playback.stream_name)
+			return -ENOMEM;
+
+		drv[i].id = i;
+		drv[i].playback.channels_min = 1;
+		drv[i].playback.channels_max = 2;
+		drv[i].playback.rates = SNDRV_PCM_RATE_8000_192000;
+		drv[i].playback.formats = SNDRV_PCM_FMTBIT_S16_LE |
+					  SNDRV_PCM_FMTBIT_S24_LE |
+					  SNDRV_PCM_FMTBIT_S32_LE;
+	}
+
+	*drvs = drv;
+	return num;
+}
+
+static int snd_soc_stress_new_links(struct device *dev,
+				    struct snd_soc_stress *stress,
+				    struct snd_soc_dai_driver *drvs)
+{
+	struct snd_soc_card *card = &stress->card;
+	struct snd_soc_dai_link_component *dlc;
+	struct snd_soc_dai_link *links;
+	int num = stress->num_fes + stress->num_bes;
+	int i;
+
+	links = devm_kcalloc(dev, num, sizeof(*links), GFP_KERNEL);
+	if (!links)
+		return -ENOMEM;
+
+	for (i = 0; i < num; i++) {
+		dlc = devm_kcalloc(dev, 3, sizeof(*dlc), GFP_KERNEL);
+		if (!dlc)
+			return -ENOMEM;
+
+		links[i].name = drvs[i].name;
+		links[i].stream_name = drvs[i].name;
+		links[i].id = i;
+
+		links[i].cpus = &dlc[0];
+		links[i].codecs = &dlc[1];
+		links[i].platforms = &dlc[2];
+
+		links[i].num_cpus = 1;
+		links[i].num_codecs = 1;
+		links[i].num_platforms = 1;
+
+		links[i].cpus->dai_name = drvs[i].name;
+		links[i].codecs->name = "snd-soc-dummy";
+		links[i].codecs->dai_name = "snd-soc-dummy-dai";
+		links[i].platforms->name = "snd-soc-dummy";
+		links[i].dpcm_playback = 1;
+
+		if (i < stress->num_fes) {
+			links[i].dynamic = 1;
+			links[i].trigger[SNDRV_PCM_STREAM_PLAYBACK] =
+				SND_SOC_DPCM_TRIGGER_POST;
+		} else {
+			links[i].no_pcm = 1;
+		}
+	}
+
+	card->dai_link = links;
+	card->num_links = num;
+
+	return 0;
+}
+
+static int snd_soc_stress_dev_probe(struct platform_device *pdev)
+{
+	struct device *dev = &pdev->dev;
+	struct snd_soc_dai_driver *drvs;
+	struct snd_soc_stress *stress;
+	struct regmap_config config = {
+		.reg_bits = 32,
+		.val_bits = 32,
+		.reg_read = snd_soc_stress_reg_read,
+		.reg_write = snd_soc_stress_reg_write,
+		.cache_type = REGCACHE_NONE,
+	};
+	struct regmap *regmap;
+	int num_regs, num_dais, i;
+	int ret;
+
+	stress = devm_kzalloc(dev, sizeof(*stress), GFP_KERNEL);
+	if (!stress)
+		return -ENOMEM;
+
+	stress->num_fes = clamp(fes, 1, SND_SOC_STRESS_MAX);
+	stress->num_bes = clamp(bes, 1, SND_SOC_STRESS_MAX);
+	stress->num_stages = clamp(stages, 1, SND_SOC_STRESS_MAX);
+	stress->fanin = clamp(fanin, 1, SND_SOC_STRESS_MAX_FANIN);
+
+	/* all the mixer inputs start connected */
+	num_regs = stress->num_bes * stress->num_stages;
+	stress->regs = devm_kcalloc(dev, num_regs, sizeof(*stress->regs),
+				    GFP_KERNEL);
+	if (!stress->regs)
+		return -ENOMEM;
+	for (i = 0; i < num_regs; i++)
+		stress->regs[i] = GENMASK(stress->fanin - 1, 0);
+
+	config.max_register = num_regs - 1;
+	regmap = devm_regmap_init(dev, NULL, stress, &config);
+	if (IS_ERR(regmap))
+		return PTR_ERR(regmap);
+
+	num_dais = snd_soc_stress_new_dais(dev, stress, &drvs);
+	if (num_dais < 0)
+		return num_dais;
+
+	ret = devm_snd_soc_register_component(dev, &snd_soc_stress_component,
+					      drvs, num_dais);
+	if (ret < 0)
+		return ret;
+
+	ret = snd_soc_stress_new_links(dev, stress, drvs);
+	if (ret < 0)
+		return ret;
+
+	stress->card.name = "stress";
+	stress->card.owner = THIS_MODULE;
+	stress->card.dev = dev;
+
+	return devm_snd_soc_register_card(dev, &stress->card);
+}
+
+static struct platform_driver snd_soc_stress_driver = {
+	.probe = snd_soc_stress_dev_probe,
+	.driver = {
+		.name = "snd-soc-stress",
+	},
+};
+
+static struct platform_device *snd_soc_stress_dev;
+
+static int __init snd_soc_stress_init(void)
+{
+	int ret;
+
+	ret = platform_driver_register(&snd_soc_stress_driver);
+	if (ret)
+		return ret;
+
+	snd_soc_stress_dev = platform_device_register_simple("snd-soc-stress",
+							     -1, NULL, 0);
+	if (IS_ERR(snd_soc_stress_dev)) {
+		platform_driver_unregister(&snd_soc_stress_driver);
+		return PTR_ERR(snd_soc_stress_dev);
+	}
+
+	return 0;
+}
+module_init(snd_soc_stress_init);
+
+static void __exit snd_soc_stress_exit(void)
+{
+	platform_device_unregister(snd_soc_stress_dev);
+	platform_driver_unregister(&snd_soc_stress_driver);
+}
+module_exit(snd_soc_stress_exit);
+
+MODULE_DESCRIPTION("ASoC synthetic card for DAPM/DPCM scalability tests");
+MODULE_LICENSE("GPL v2");
@@ -1187,6 +1187,7 @@ static int soc_tplg_dapm_graph_elems_load(struct soc_tplg *tplg,
 	struct snd_soc_dapm_context *dapm = &tplg->comp->dapm;
 	struct snd_soc_tplg_dapm_graph_elem *elem;
 	struct snd_soc_dapm_route **routes;
+	struct snd_soc_dapm_route *batch;
 	int count, i, j;
 	int ret = 0;
 
@@ -1218,6 +1219,13 @@ static int soc_tplg_dapm_graph_elems_load(struct soc_tplg *tplg,
 	if (!routes)
 		return -ENOMEM;
 
+	/* contiguous copy of the routes, added at once */
+	batch = kcalloc(count, sizeof(*batch), GFP_KERNEL);
+	if (!batch) {
+		kfree(routes);
+		return -ENOMEM;
+	}
+
 	/*
 	 * allocate memory for each dapm route in the array.
 	 * This needs to be done individually so that
@@ -1230,6 +1238,7 @@ static int soc_tplg_dapm_graph_elems_load(struct soc_tplg *tplg,
 			for (j = 0; j < i; j++)
 				kfree(routes[j]);
 
+			kfree(batch);
 			kfree(routes);
 			return -ENOMEM;
 		}
@@ -1274,15 +1283,23 @@ static int soc_tplg_dapm_graph_elems_load(struct soc_tplg *tplg,
 
 		soc_tplg_add_route(tplg, routes[i]);
 
-		/* add route, but keep going if some fail */
-		snd_soc_dapm_add_routes(dapm, routes[i], 1);
+		batch[i] = *routes[i];
 	}
 
+	/*
+	 * add the routes under a single lock of the card, the failing ones
+	 * are reported and skipped
+	 */
+	if (ret == 0)
+		snd_soc_dapm_add_routes(dapm, batch, count);
+
 	/* free memory allocated for all dapm routes in case of error */
 	if (ret < 0)
 		for (i = 0; i < count ; i++)
 			kfree(routes[i]);
 
+	kfree(batch);
+
 	/*
 	 * free pointer to array of dapm routes as this is no longer needed.
 	 * The memory allocated for each dapm route will be freed
@@ -1588,15 +1605,17 @@ static int soc_tplg_dapm_widget_create(struct soc_tplg *tplg,
 	if ((int)template.id < 0)
 		return template.id;
 
-	/* strings are allocated here, but used and freed by the widget */
-	template.name = kstrdup(w->name, GFP_KERNEL);
-	if (!template.name)
-		return -ENOMEM;
-	template.sname = kstrdup(w->sname, GFP_KERNEL);
-	if (!template.sname) {
-		ret = -ENOMEM;
-		goto err;
-	}
+	/*
+	 * The strings are referenced in place, the widget makes its own copy
+	 * and the template doesn't outlive the firmware.
+	 */
+	if (strnlen(w->name, SNDRV_CTL_ELEM_ID_NAME_MAXLEN) ==
+		    SNDRV_CTL_ELEM_ID_NAME_MAXLEN ||
+	    strnlen(w->sname, SNDRV_CTL_ELEM_ID_NAME_MAXLEN) ==
+		    SNDRV_CTL_ELEM_ID_NAME_MAXLEN)
+		return -EINVAL;
+	template.name = w->name;
+	template.sname = w->sname;
 	template.reg = le32_to_cpu(w->reg);
 	template.shift = le32_to_cpu(w->shift);
 	template.mask = le32_to_cpu(w->mask);
@@ -1698,18 +1717,12 @@ widget:
 	if (ret < 0)
 		goto ready_err;
 
-	kfree(template.sname);
-	kfree(template.name);
-
 	return 0;
 
 ready_err:
 	snd_soc_tplg_widget_remove(widget);
 	snd_soc_dapm_free_widget(widget);
 hdr_err:
-	kfree(template.sname);
-err:
-	kfree(template.name);
 	return ret;
 }
 
@@ -8,11 +8,309 @@
 // Author: Cezary Rojewski <cezary.rojewski@intel.com>
 //
 
+#include <linux/mm.h>
+#include <linux/vmalloc.h>
 #include <sound/soc.h>
 #include "compress.h"
 #include "ops.h"
 #include "probe.h"
 
+/*
+ * The extraction stream interleaves the packets of all the probe points.
+ * The demultiplexer splits their data into one ring per probe point, in a
+ * buffer that debugfs maps read-only: the first page is a table of struct
+ * sof_probe_demux_info, the rings follow. Reading the debugfs entry
+ * demultiplexes the data extracted so far and returns the same table.
+ */
+#define SOF_PROBE_DEMUX_RINGS		8
+#define SOF_PROBE_DEMUX_RING_SIZE	(64 * 1024)
+
+struct sof_probe_demux_ring {
+	u32 buffer_id;		/* probe point, only valid if size is set */
+	u32 offset;		/* from the start of the mapping */
+	u32 size;
+	u32 reserved;
+	u64 head;		/* bytes written, the ring wraps at size */
+};
+
+struct sof_probe_demux_info {
+	u32 num_rings;
+	u32 reserved;
+	u64 lost;		/* bytes overwritten by the DMA before demux */
+	u64 unmatched;		/* bytes of probe points without a ring */
+	u64 resync;		/* bytes skipped looking for a packet */
+	struct sof_probe_demux_ring ring[SOF_PROBE_DEMUX_RINGS];
+};
+
+struct sof_probe_demux {
+	struct mutex lock;	/* protects the demux state */
+	struct snd_compr_stream *cstream;
+	struct snd_soc_dai *dai;
+	void *area;
+	struct sof_probe_demux_info *info;
+	/* bytes of the extraction stream already demultiplexed */
+	u64 pos;
+	/* current packet */
+	struct sof_probe_packet hdr;
+	size_t hdr_bytes;
+	size_t data_left;
+	size_t trailer_left;
+	int ring;
+};
+
+#define SOF_PROBE_DEMUX_AREA_SIZE \
+	(PAGE_SIZE + SOF_PROBE_DEMUX_RINGS * SOF_PROBE_DEMUX_RING_SIZE)
+
+static void sof_probe_demux_reset(struct sof_probe_demux *demux)
+{
+	memset(demux->info, 0, sizeof(*demux->info));
+	demux->pos = 0;
+	demux->hdr_bytes = 0;
+	demux->data_left = 0;
+	demux->trailer_left = 0;
+}
+
+/* the buffer may still be mapped, so it lasts as long as the device */
+static void sof_probe_demux_release(void *data)
+{
+	struct sof_probe_demux *demux = data;
+
+	vfree(demux->area);
+}
+
+static int sof_probe_demux_start(struct snd_sof_dev *sdev,
+				 struct snd_compr_stream *cstream,
+				 struct snd_soc_dai *dai)
+{
+	struct sof_probe_demux *demux = sdev->probe_demux;
+	int ret;
+
+	if (!demux) {
+		demux = devm_kzalloc(sdev->dev, sizeof(*demux), GFP_KERNEL);
+		if (!demux)
+			return -ENOMEM;
+
+		demux->area = vmalloc_user(SOF_PROBE_DEMUX_AREA_SIZE);
+		if (!demux->area)
+			return -ENOMEM;
+
+		ret = devm_add_action_or_reset(sdev->dev,
+					       sof_probe_demux_release, demux);
+		if (ret < 0)
+			return ret;
+
+		mutex_init(&demux->lock);
+		demux->info = demux->area;
+		sdev->probe_demux = demux;
+	}
+
+	mutex_lock(&demux->lock);
+	sof_probe_demux_reset(demux);
+	demux->cstream = cstream;
+	demux->dai = dai;
+	mutex_unlock(&demux->lock);
+
+	return 0;
+}
+
+static void sof_probe_demux_stop(struct snd_sof_dev *sdev)
+{
+	struct sof_probe_demux *demux = sdev->probe_demux;
+
+	if (!demux)
+		return;
+
+	mutex_lock(&demux->lock);
+	demux->cstream = NULL;
+	demux->dai = NULL;
+	mutex_unlock(&demux->lock);
+}
+
+static int sof_probe_demux_find_ring(struct sof_probe_demux *demux,
+				     u32 buffer_id)
+{
+	struct sof_probe_demux_info *info = demux->info;
+	struct sof_probe_demux_ring *ring;
+	int i;
+
+	for (i = 0; i < info->num_rings; i++)
+		if (info->ring[i].buffer_id == buffer_id)
+			return i;
+
+	if (info->num_rings == SOF_PROBE_DEMUX_RINGS)
+		return -ENOSPC;
+
+	ring = &info->ring[info->num_rings];
+	ring->buffer_id = buffer_id;
+	ring->offset = PAGE_SIZE + info->num_rings * SOF_PROBE_DEMUX_RING_SIZE;
+	ring->head = 0;
+	/* readers check size to know the ring is set up */
+	smp_wmb();
+	WRITE_ONCE(ring->size, SOF_PROBE_DEMUX_RING_SIZE);
+
+	return info->num_rings++;
+}
+
+static void sof_probe_demux_write(struct sof_probe_demux *demux,
+				  const u8 *data, size_t len)
+{
+	struct sof_probe_demux_ring *ring = &demux->info->ring[demux->ring];
+	u8 *buf = demux->area + ring->offset;
+	size_t offset, n;
+
+	while (len) {
+		offset = ring->head % ring->size;
+		n = min(len, (size_t)(ring->size - offset));
+		memcpy(buf + offset, data, n);
+		data += n;
+		len -= n;
+		/* readers check head after the data */
+		smp_wmb();
+		WRITE_ONCE(ring->head, ring->head + n);
+	}
+}
+
+static void sof_probe_demux_parse(struct sof_probe_demux *demux,
+				  const u8 *data, size_t len)
+{
+	struct sof_probe_demux_info *info = demux->info;
+	size_t hdr_size = sizeof(demux->hdr);
+	size_t n;
+
+	while (len) {
+		if (demux->hdr_bytes < hdr_size) {
+			n = min(len, hdr_size - demux->hdr_bytes);
+			memcpy((u8 *)&demux->hdr + demux->hdr_bytes, data, n);
+			demux->hdr_bytes += n;
+			data += n;
+			len -= n;
+			if (demux->hdr_bytes < hdr_size)
+				break;
+
+			/* out of sync, look for the sync word a word later */
+			if (demux->hdr.sync_word != SOF_PROBE_PACKET_SYNC ||
+			    demux->hdr.data_size_bytes >
+			    demux->cstream->runtime->buffer_size) {
+				memmove(&demux->hdr, (u8 *)&demux->hdr + 4,
+					hdr_size - 4);
+				demux->hdr_bytes -= 4;
+				info->resync += 4;
+				continue;
+			}
+
+			demux->ring = sof_probe_demux_find_ring(demux,
+							demux->hdr.buffer_id);
+			demux->data_left = demux->hdr.data_size_bytes;
+			demux->trailer_left = sizeof(u64);
+			if (demux->ring < 0)
+				info->unmatched += demux->data_left;
+			continue;
+		}
+
+		if (demux->data_left) {
+			n = min(len, demux->data_left);
+			if (demux->ring >= 0)
+				sof_probe_demux_write(demux, data, n);
+			demux->data_left -= n;
+		} else {
+			/* the checksum is not checked */
+			n = min(len, demux->trailer_left);
+			demux->trailer_left -= n;
+			if (!demux->trailer_left)
+				demux->hdr_bytes = 0;
+		}
+		data += n;
+		len -= n;
+	}
+}
+
+/* demultiplex the data extracted since the last update */
+static int sof_probe_demux_update(struct snd_sof_dev *sdev,
+				  struct sof_probe_demux *demux)
+{
+	struct snd_compr_stream *cstream = demux->cstream;
+	struct snd_compr_runtime *rtd;
+	struct snd_compr_tstamp tstamp = {0};
+	unsigned int offset;
+	u64 avail;
+	size_t n;
+	int ret;
+
+	if (!cstream)
+		return 0;
+	rtd = cstream->runtime;
+
+	ret = snd_sof_probe_compr_pointer(sdev, cstream, &tstamp, demux->dai);
+	if (ret < 0)
+		return ret;
+
+	avail = tstamp.copied_total - demux->pos;
+	if (avail > rtd->buffer_size) {
+		/* the DMA overwrote data, restart at the oldest valid byte */
+		demux->info->lost += avail - rtd->buffer_size;
+		demux->pos = tstamp.copied_total - rtd->buffer_size;
+		demux->hdr_bytes = 0;
+		demux->data_left = 0;
+		demux->trailer_left = 0;
+		avail = rtd->buffer_size;
+	}
+
+	while (avail) {
+		div_u64_rem(demux->pos, rtd->buffer_size, &offset);
+		n = min_t(u64, avail, rtd->buffer_size - offset);
+		sof_probe_demux_parse(demux, rtd->dma_area + offset, n);
+		demux->pos += n;
+		avail -= n;
+	}
+
+	return 0;
+}
+
+static ssize_t sof_probe_demux_read(struct file *file, char __user *buf,
+				    size_t count, loff_t *ppos)
+{
+	struct snd_sof_dfsentry *dfse = file->private_data;
+	struct snd_sof_dev *sdev = dfse->sdev;
+	struct sof_probe_demux *demux = sdev->probe_demux;
+	loff_t pos = 0;
+	ssize_t ret;
+
+	if (!demux)
+		return -ENODEV;
+
+	/* each read returns the whole table, whatever the file position */
+	mutex_lock(&demux->lock);
+	ret = sof_probe_demux_update(sdev, demux);
+	if (!ret)
+		ret = simple_read_from_buffer(buf, count, &pos, demux->info,
+					      sizeof(*demux->info));
+	mutex_unlock(&demux->lock);
+
+	return ret;
+}
+
+static int sof_probe_demux_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	struct snd_sof_dfsentry *dfse = file->private_data;
+	struct sof_probe_demux *demux = dfse->sdev->probe_demux;
+
+	if (!demux)
+		return -ENODEV;
+	if (vma->vm_flags & VM_WRITE)
+		return -EPERM;
+
+	vma->vm_flags &= ~VM_MAYWRITE;
+
+	return remap_vmalloc_range(vma, demux->area, vma->vm_pgoff);
+}
+
+const struct file_operations sof_probe_demux_fops = {
+	.open = simple_open,
+	.read = sof_probe_demux_read,
+	.mmap = sof_probe_demux_mmap,
+	.llseek = default_llseek,
+};
+
 struct snd_compr_ops sof_probe_compressed_ops = {
 	.copy		= sof_probe_compr_copy,
 };
@@ -62,6 +360,7 @@ exit:
 		dev_err(dai->dev, "Failed to deinit probe: %d\n", ret);
 
 	sdev->extractor_stream_tag = SOF_PROBE_INVALID_NODE_ID;
+	sof_probe_demux_stop(sdev);
 	snd_compr_free_pages(cstream);
 
 	return snd_sof_probe_compr_free(sdev, cstream, dai);
@@ -93,7 +392,7 @@ int sof_probe_compr_set_params(struct snd_compr_stream *cstream,
 		return ret;
 	}
 
-	return 0;
+	return sof_probe_demux_start(sdev, cstream, dai);
 }
 EXPORT_SYMBOL(sof_probe_compr_set_params);
 
@@ -28,4 +28,6 @@ int sof_probe_compr_pointer(struct snd_compr_stream *cstream,
 int sof_probe_compr_copy(struct snd_compr_stream *cstream,
 		char __user *buf, size_t count);
 
+extern const struct file_operations sof_probe_demux_fops;
+
 #endif
@@ -103,6 +103,7 @@ int snd_sof_volume_put(struct snd_kcontrol *kcontrol,
 		cdata->chanv[i].channel = i;
 		cdata->chanv[i].value = value;
 	}
+	scontrol->dirty |= change;
 
 	/* notify DSP of mixer updates */
 	if (pm_runtime_active(scomp->dev))
@@ -149,6 +150,7 @@ int snd_sof_switch_put(struct snd_kcontrol *kcontrol,
 		cdata->chanv[i].channel = i;
 		cdata->chanv[i].value = value;
 	}
+	scontrol->dirty |= change;
 
 	if (scontrol->led_ctl.use_led)
 		update_mute_led(scontrol, kcontrol, ucontrol);
@@ -199,6 +201,7 @@ int snd_sof_enum_put(struct snd_kcontrol *kcontrol,
 		cdata->chanv[i].channel = i;
 		cdata->chanv[i].value = value;
 	}
+	scontrol->dirty |= change;
 
 	/* notify DSP of enum updates */
 	if (pm_runtime_active(scomp->dev))
@@ -273,6 +276,7 @@ int snd_sof_bytes_put(struct snd_kcontrol *kcontrol,
 
 	/* copy from kcontrol */
 	memcpy(data, ucontrol->value.bytes.data, size);
+	scontrol->dirty = true;
 
 	/* notify DSP of byte control updates */
 	if (pm_runtime_active(scomp->dev))
@@ -321,6 +325,7 @@ int snd_sof_bytes_ext_put(struct snd_kcontrol *kcontrol,
 		return -EINVAL;
 	}
 
+	scontrol->dirty = true;
 	if (copy_from_user(cdata->data, tlvd->tlv, header.length))
 		return -EFAULT;
 
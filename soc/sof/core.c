@@ -8,6 +8,7 @@
 // Author: Liam Girdwood <liam.r.girdwood@linux.intel.com>
 //
 
+#include <linux/async.h>
 #include <linux/firmware.h>
 #include <linux/module.h>
 #include <dkms/sound/soc.h>
@@ -135,15 +136,30 @@ EXPORT_SYMBOL(snd_sof_get_status);
  *	(System Suspend/Runtime Suspend)
  */
 
+static void sof_request_firmware_async(void *data, async_cookie_t cookie)
+{
+	struct snd_sof_dev *sdev = data;
+
+	/* failures are reported again by snd_sof_load_firmware() */
+	snd_sof_request_firmware(sdev);
+}
+
 static int sof_probe_continue(struct snd_sof_dev *sdev)
 {
 	struct snd_sof_pdata *plat_data = sdev->pdata;
+	ASYNC_DOMAIN_EXCLUSIVE(fw_domain);
 	int ret;
 
+	/* fetch the firmware image while the DSP hardware is brought up */
+	async_schedule_domain(sof_request_firmware_async, sdev, &fw_domain);
+
 	/* probe the DSP hardware */
 	ret = snd_sof_probe(sdev);
+	async_synchronize_full_domain(&fw_domain);
 	if (ret < 0) {
 		dev_err(sdev->dev, "error: failed to probe DSP %d\n", ret);
+		release_firmware(plat_data->fw);
+		plat_data->fw = NULL;
 		return ret;
 	}
 
@@ -18,6 +18,7 @@
 #include "ops.h"
 
 #if IS_ENABLED(CONFIG_SND_SOC_SOF_DEBUG_PROBES)
+#include "compress.h"
 #include "probe.h"
 
 /**
@@ -224,7 +225,13 @@ static int snd_sof_debugfs_probe_item(struct snd_sof_dev *sdev,
 	dfse->type = SOF_DFSENTRY_TYPE_BUF;
 	dfse->sdev = sdev;
 
-	debugfs_create_file(name, mode, sdev->debugfs_root, dfse, fops);
+	/* fops with mmap bypass the debugfs proxy, which doesn't forward it */
+	if (fops->mmap)
+		debugfs_create_file_unsafe(name, mode, sdev->debugfs_root,
+					   dfse, fops);
+	else
+		debugfs_create_file(name, mode, sdev->debugfs_root, dfse,
+				    fops);
 	/* add to dfsentry list */
 	list_add(&dfse->list, &sdev->dfsentry_list);
 
@@ -660,6 +667,10 @@ int snd_sof_dbg_init(struct snd_sof_dev *sdev)
 			0200, &probe_points_remove_fops);
 	if (err < 0)
 		return err;
+	err = snd_sof_debugfs_probe_item(sdev, "probe_demux",
+			0444, &sof_probe_demux_fops);
+	if (err < 0)
+		return err;
 #endif
 
 #if IS_ENABLED(CONFIG_SND_SOC_SOF_DEBUG_IPC_FLOOD_TEST)
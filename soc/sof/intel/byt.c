@@ -584,8 +584,8 @@ const struct snd_sof_dsp_ops sof_tng_ops = {
 	.get_mailbox_offset = byt_get_mailbox_offset,
 	.get_window_offset = byt_get_window_offset,
 
-	.ipc_msg_data	= intel_ipc_msg_data,
-	.ipc_pcm_params	= intel_ipc_pcm_params,
+	.ipc_msg_data	= sof_ipc_msg_data,
+	.ipc_pcm_params	= sof_ipc_pcm_params,
 
 	/* machine driver */
 	.machine_select = byt_machine_select,
@@ -599,8 +599,9 @@ const struct snd_sof_dsp_ops sof_tng_ops = {
 	.dbg_dump	= byt_dump,
 
 	/* stream callbacks */
-	.pcm_open	= intel_pcm_open,
-	.pcm_close	= intel_pcm_close,
+	.pcm_open	= sof_stream_pcm_open,
+	.pcm_close	= sof_stream_pcm_close,
+	.pcm_pointer	= sof_stream_pcm_pointer,
 
 	/* module loading */
 	.load_module	= snd_sof_parse_module_memcpy,
@@ -760,8 +761,8 @@ const struct snd_sof_dsp_ops sof_byt_ops = {
 	.get_mailbox_offset = byt_get_mailbox_offset,
 	.get_window_offset = byt_get_window_offset,
 
-	.ipc_msg_data	= intel_ipc_msg_data,
-	.ipc_pcm_params	= intel_ipc_pcm_params,
+	.ipc_msg_data	= sof_ipc_msg_data,
+	.ipc_pcm_params	= sof_ipc_pcm_params,
 
 	/* machine driver */
 	.machine_select = byt_machine_select,
@@ -775,8 +776,9 @@ const struct snd_sof_dsp_ops sof_byt_ops = {
 	.dbg_dump	= byt_dump,
 
 	/* stream callbacks */
-	.pcm_open	= intel_pcm_open,
-	.pcm_close	= intel_pcm_close,
+	.pcm_open	= sof_stream_pcm_open,
+	.pcm_close	= sof_stream_pcm_close,
+	.pcm_pointer	= sof_stream_pcm_pointer,
 
 	/* module loading */
 	.load_module	= snd_sof_parse_module_memcpy,
@@ -834,8 +836,8 @@ const struct snd_sof_dsp_ops sof_cht_ops = {
 	.get_mailbox_offset = byt_get_mailbox_offset,
 	.get_window_offset = byt_get_window_offset,
 
-	.ipc_msg_data	= intel_ipc_msg_data,
-	.ipc_pcm_params	= intel_ipc_pcm_params,
+	.ipc_msg_data	= sof_ipc_msg_data,
+	.ipc_pcm_params	= sof_ipc_pcm_params,
 
 	/* machine driver */
 	.machine_select = byt_machine_select,
@@ -849,8 +851,9 @@ const struct snd_sof_dsp_ops sof_cht_ops = {
 	.dbg_dump	= byt_dump,
 
 	/* stream callbacks */
-	.pcm_open	= intel_pcm_open,
-	.pcm_close	= intel_pcm_close,
+	.pcm_open	= sof_stream_pcm_open,
+	.pcm_close	= sof_stream_pcm_close,
+	.pcm_pointer	= sof_stream_pcm_pointer,
 
 	/* module loading */
 	.load_module	= snd_sof_parse_module_memcpy,
@@ -883,5 +886,4 @@ EXPORT_SYMBOL(cht_chip_info);
 #endif /* CONFIG_SND_SOC_SOF_BAYTRAIL */
 
 MODULE_LICENSE("Dual BSD/GPL");
-//MODULE_IMPORT_NS(SND_SOC_SOF_INTEL_HIFI_EP_IPC);
 //MODULE_IMPORT_NS(SND_SOC_SOF_XTENSA);
@@ -104,10 +104,33 @@ int hda_probe_compr_pointer(struct snd_sof_dev *sdev,
 			    struct snd_soc_dai *dai)
 {
 	struct hdac_ext_stream *stream = hda_compr_get_stream(cstream);
+	struct hdac_stream *hstream = hdac_stream(stream);
+	struct hdac_bus *bus = sof_to_bus(sdev);
+	u64 buffer_size = cstream->runtime->buffer_size;
 	struct snd_soc_pcm_stream *pstream;
+	u64 total, prev_pos, pos;
+
+	/*
+	 * curr_pos only moves at fragment interrupts, add what the DMA
+	 * transferred since from the position buffer.
+	 */
+	spin_lock_irq(&bus->reg_lock);
+	total = hstream->curr_pos;
+	pos = snd_hdac_stream_get_pos_posbuf(hstream);
+	spin_unlock_irq(&bus->reg_lock);
+
+	div64_u64_rem(total, buffer_size, &prev_pos);
+	if (pos >= buffer_size)
+		pos = prev_pos;
+
+	if (pos < prev_pos)
+		total += buffer_size - prev_pos + pos;
+	else
+		total += pos - prev_pos;
 
 	pstream = &dai->driver->capture;
-	tstamp->copied_total = hdac_stream(stream)->curr_pos;
+	tstamp->byte_offset = pos;
+	tstamp->copied_total = total;
 	tstamp->sampling_rate = snd_pcm_rate_bit_to_rate(pstream->rates);
 
 	return 0;
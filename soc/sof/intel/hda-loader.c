@@ -46,11 +46,15 @@ static int cl_stream_prepare(struct snd_sof_dev *sdev, unsigned int format,
 	hstream = &dsp_stream->hstream;
 	hstream->substream = NULL;
 
-	/* allocate DMA buffer */
-	ret = snd_dma_alloc_pages(SNDRV_DMA_TYPE_DEV_SG, &pci->dev, size, dmab);
-	if (ret < 0) {
-		dev_err(sdev->dev, "error: memory alloc failed: %x\n", ret);
-		goto error;
+	/* allocate DMA buffer, it is kept with the image between boots */
+	if (!dmab->area) {
+		ret = snd_dma_alloc_pages(SNDRV_DMA_TYPE_DEV_SG, &pci->dev,
+					  size, dmab);
+		if (ret < 0) {
+			dev_err(sdev->dev, "error: memory alloc failed: %x\n",
+				ret);
+			goto error;
+		}
 	}
 
 	hstream->period_bytes = 0;/* initialize period_bytes */
@@ -70,6 +74,7 @@ static int cl_stream_prepare(struct snd_sof_dev *sdev, unsigned int format,
 error:
 	hda_dsp_stream_put(sdev, direction, hstream->stream_tag);
 	snd_dma_free_pages(dmab);
+	dmab->area = NULL;
 	return ret;
 }
 
@@ -235,8 +240,6 @@ static int cl_cleanup(struct snd_sof_dev *sdev, struct snd_dma_buffer *dmab,
 			  sd_offset + SOF_HDA_ADSP_REG_CL_SD_BDLPU, 0);
 
 	snd_sof_dsp_write(sdev, HDA_DSP_HDA_BAR, sd_offset, 0);
-	snd_dma_free_pages(dmab);
-	dmab->area = NULL;
 	hstream->bufsize = 0;
 	hstream->format_val = 0;
 
@@ -289,6 +292,7 @@ int hda_dsp_cl_boot_firmware(struct snd_sof_dev *sdev)
 	const struct sof_intel_dsp_desc *chip_info;
 	struct hdac_ext_stream *stream;
 	struct firmware stripped_firmware;
+	bool cached = sdev->dmab.area;
 	int ret, ret1, tag, i;
 
 	chip_info = desc->chip_info;
@@ -324,8 +328,10 @@ int hda_dsp_cl_boot_firmware(struct snd_sof_dev *sdev)
 		goto err;
 	}
 
-	memcpy(sdev->dmab.area, stripped_firmware.data,
-	       stripped_firmware.size);
+	/* the image is still in the buffer from the previous boot */
+	if (!cached)
+		memcpy(sdev->dmab.area, stripped_firmware.data,
+		       stripped_firmware.size);
 
 	/* try ROM init a few times before giving up */
 	for (i = 0; i < HDA_FW_BOOT_ATTEMPTS; i++) {
@@ -89,6 +89,7 @@ int hda_dsp_pcm_hw_params(struct snd_sof_dev *sdev,
 	struct hdac_stream *hstream = substream->runtime->private_data;
 	struct hdac_ext_stream *stream = stream_to_hdac_ext_stream(hstream);
 	struct sof_intel_hda_dev *hda = sdev->pdata->hw_pdata;
+	struct sof_intel_hda_stream *hda_stream;
 	struct snd_dma_buffer *dmab;
 	struct sof_ipc_fw_version *v = &sdev->fw_ready.version;
 	int ret;
@@ -115,8 +116,24 @@ int hda_dsp_pcm_hw_params(struct snd_sof_dev *sdev,
 		return ret;
 	}
 
-	/* disable SPIB, to enable buffer wrap for stream */
-	hda_dsp_stream_spib_config(sdev, stream, HDA_DSP_SPIB_DISABLE, 0);
+	/*
+	 * Deep playback buffers are bounded by SPIB, updated from .ack as the
+	 * application writes, so the DMA fetches in bursts and lets the link
+	 * idle in between. Otherwise disable SPIB to let the stream wrap.
+	 */
+	hda_stream = hstream_to_sof_hda_stream(stream);
+	hda_stream->deep_buffer =
+		(substream->runtime->hw.info & SNDRV_PCM_INFO_SYNC_APPLPTR) &&
+		(hstream->no_period_wakeup ||
+		 params_buffer_size(params) * 1000 >=
+		 params_rate(params) * HDA_DSP_DEEP_BUFFER_MS);
+
+	if (hda_stream->deep_buffer)
+		hda_dsp_stream_spib_config(sdev, stream, HDA_DSP_SPIB_ENABLE,
+					   size);
+	else
+		hda_dsp_stream_spib_config(sdev, stream, HDA_DSP_SPIB_DISABLE,
+					   0);
 
 	/* update no_stream_position flag for ipc params */
 	if (hda && hda->no_ipc_position) {
@@ -212,6 +229,28 @@ found:
 	return pos;
 }
 
+int hda_dsp_pcm_ack(struct snd_sof_dev *sdev,
+		    struct snd_pcm_substream *substream)
+{
+	struct snd_pcm_runtime *runtime = substream->runtime;
+	struct hdac_stream *hstream = runtime->private_data;
+	struct hdac_ext_stream *stream = stream_to_hdac_ext_stream(hstream);
+	u32 spib;
+
+	if (!hstream_to_sof_hda_stream(stream)->deep_buffer)
+		return 0;
+
+	/* SPIB is the byte offset the DMA may fetch up to, 1 to bufsize */
+	spib = frames_to_bytes(runtime,
+			       runtime->control->appl_ptr % runtime->buffer_size);
+	if (!spib)
+		spib = hstream->bufsize;
+
+	sof_io_write(sdev, stream->spib_addr, spib);
+
+	return 0;
+}
+
 int hda_dsp_pcm_open(struct snd_sof_dev *sdev,
 		     struct snd_pcm_substream *substream)
 {
@@ -225,6 +264,14 @@ int hda_dsp_pcm_open(struct snd_sof_dev *sdev,
 		return -ENODEV;
 	}
 
+	/*
+	 * Playback .ack drives SPIB for deep buffers, which needs every
+	 * appl_ptr update to be seen: do not let the control be mmapped.
+	 */
+	if (direction == SNDRV_PCM_STREAM_PLAYBACK &&
+	    sdev->bar[HDA_DSP_SPIB_BAR])
+		substream->runtime->hw.info |= SNDRV_PCM_INFO_SYNC_APPLPTR;
+
 	/* binding pcm substream to hda stream */
 	substream->runtime->private_data = &dsp_stream->hstream;
 	return 0;
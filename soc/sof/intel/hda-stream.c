@@ -158,24 +158,23 @@ hda_dsp_stream_get(struct snd_sof_dev *sdev, int direction)
 	struct hdac_bus *bus = sof_to_bus(sdev);
 	struct sof_intel_hda_stream *hda_stream;
 	struct hdac_ext_stream *stream = NULL;
-	struct hdac_stream *s;
+	unsigned long free;
+	int i;
 
 	spin_lock_irq(&bus->reg_lock);
 
 	/* get an unused stream */
-	list_for_each_entry(s, &bus->stream_list, list) {
-		if (s->direction == direction && !s->opened) {
-			stream = stream_to_hdac_ext_stream(s);
-			hda_stream = container_of(stream,
-						  struct sof_intel_hda_stream,
-						  hda_stream);
-			/* check if the host DMA channel is reserved */
-			if (hda_stream->host_reserved)
-				continue;
+	free = bus->free_streams[direction];
+	for_each_set_bit(i, &free, HDA_MAX_STREAMS) {
+		hda_stream = hstream_to_sof_hda_stream(
+			stream_to_hdac_ext_stream(bus->streams[i]));
+		/* check if the host DMA channel is reserved */
+		if (hda_stream->host_reserved)
+			continue;
 
-			s->opened = true;
-			break;
-		}
+		stream = &hda_stream->hda_stream;
+		snd_hdac_stream_set_opened(&stream->hstream, true);
+		break;
 	}
 
 	spin_unlock_irq(&bus->reg_lock);
@@ -205,27 +204,29 @@ int hda_dsp_stream_put(struct snd_sof_dev *sdev, int direction, int stream_tag)
 {
 	struct hdac_bus *bus = sof_to_bus(sdev);
 	struct hdac_stream *s;
-	bool active_capture_stream = false;
+	bool active_capture_stream;
 	bool found = false;
+	unsigned long opened;
+	int i;
 
 	spin_lock_irq(&bus->reg_lock);
 
-	/*
-	 * close stream matching the stream tag
-	 * and check if there are any open capture streams.
-	 */
-	list_for_each_entry(s, &bus->stream_list, list) {
-		if (!s->opened)
-			continue;
-
-		if (s->direction == direction && s->stream_tag == stream_tag) {
-			s->opened = false;
+	/* close the opened stream matching the stream tag */
+	opened = bus->stream_mask[direction] & ~bus->free_streams[direction];
+	for_each_set_bit(i, &opened, HDA_MAX_STREAMS) {
+		s = bus->streams[i];
+		if (s->stream_tag == stream_tag) {
+			snd_hdac_stream_set_opened(s, false);
 			found = true;
-		} else if (s->direction == SNDRV_PCM_STREAM_CAPTURE) {
-			active_capture_stream = true;
+			break;
 		}
 	}
 
+	/* check if there are any open capture streams */
+	active_capture_stream =
+		bus->stream_mask[SNDRV_PCM_STREAM_CAPTURE] !=
+		bus->free_streams[SNDRV_PCM_STREAM_CAPTURE];
+
 	spin_unlock_irq(&bus->reg_lock);
 
 	/* Enable DMI L1 entry if there are no capture streams open */
@@ -537,9 +538,18 @@ int hda_dsp_stream_hw_free(struct snd_sof_dev *sdev,
 	struct hdac_ext_stream *link_dev = container_of(stream,
 							struct hdac_ext_stream,
 							hstream);
+	struct sof_intel_hda_stream *hda_stream;
 	struct hdac_bus *bus = sof_to_bus(sdev);
 	u32 mask = 0x1 << stream->index;
 
+	/* release the SPIB bound of a deep buffer */
+	hda_stream = hstream_to_sof_hda_stream(link_dev);
+	if (hda_stream->deep_buffer) {
+		hda_dsp_stream_spib_config(sdev, link_dev,
+					   HDA_DSP_SPIB_DISABLE, 0);
+		hda_stream->deep_buffer = false;
+	}
+
 	spin_lock_irq(&bus->reg_lock);
 	/* couple host and link DMA if link DMA channel is idle */
 	if (!link_dev->link_locked)
@@ -775,7 +785,7 @@ int hda_dsp_stream_init(struct snd_sof_dev *sdev)
 		hstream->posbuf = (__le32 *)(bus->posbuf.area +
 			(hstream->index) * 8);
 
-		list_add_tail(&hstream->list, &bus->stream_list);
+		snd_hdac_stream_add(bus, hstream);
 	}
 
 	/* create playback streams */
@@ -832,7 +842,7 @@ int hda_dsp_stream_init(struct snd_sof_dev *sdev)
 		hstream->posbuf = (__le32 *)(bus->posbuf.area +
 			(hstream->index) * 8);
 
-		list_add_tail(&hstream->list, &bus->stream_list);
+		snd_hdac_stream_add(bus, hstream);
 	}
 
 	/* store total stream count (playback + capture) from GCAP */
@@ -864,7 +874,7 @@ void hda_dsp_stream_free(struct snd_sof_dev *sdev)
 		/* free bdl buffer */
 		if (s->bdl.area)
 			snd_dma_free_pages(&s->bdl);
-		list_del(&s->list);
+		snd_hdac_stream_remove(s);
 		stream = stream_to_hdac_ext_stream(s);
 		hda_stream = container_of(stream, struct sof_intel_hda_stream,
 					  hda_stream);
@@ -920,6 +920,12 @@ int hda_dsp_remove(struct snd_sof_dev *sdev)
 	if (sdev->msi_enabled)
 		pci_free_irq_vectors(pci);
 
+	/* free the code loader buffer kept between boots */
+	if (sdev->dmab.area) {
+		snd_dma_free_pages(&sdev->dmab);
+		sdev->dmab.area = NULL;
+	}
+
 	hda_dsp_stream_free(sdev);
 #if IS_ENABLED(CONFIG_SND_SOC_SOF_HDA)
 	snd_hdac_link_free_all(bus);
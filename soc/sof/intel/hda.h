@@ -181,6 +181,13 @@
 #define HDA_DSP_SPIB_ENABLE			1
 #define HDA_DSP_SPIB_DISABLE			0
 
+/*
+ * Playback buffers of at least this duration, in ms, are deep buffers: the
+ * host DMA is bounded by SPIB so that it only fetches what the application
+ * wrote and then idles, instead of polling the buffer.
+ */
+#define HDA_DSP_DEEP_BUFFER_MS			100
+
 #define SOF_HDA_MAX_BUFFER_SIZE			(32 * PAGE_SIZE)
 
 #define HDA_DSP_STACK_DUMP_SIZE			32
@@ -468,6 +475,7 @@ struct sof_intel_hda_stream {
 	struct hdac_ext_stream hda_stream;
 	struct sof_intel_stream stream;
 	int host_reserved; /* reserve host DMA channel */
+	bool deep_buffer; /* host DMA bounded by SPIB */
 };
 
 #define hstream_to_sof_hda_stream(hstream) \
@@ -535,6 +543,8 @@ int hda_dsp_pcm_trigger(struct snd_sof_dev *sdev,
 			struct snd_pcm_substream *substream, int cmd);
 snd_pcm_uframes_t hda_dsp_pcm_pointer(struct snd_sof_dev *sdev,
 				      struct snd_pcm_substream *substream);
+int hda_dsp_pcm_ack(struct snd_sof_dev *sdev,
+		    struct snd_pcm_substream *substream);
 
 /*
  * DSP Stream Operations.
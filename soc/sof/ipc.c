@@ -11,7 +11,10 @@
 // by platform driver code.
 //
 
+#include <linux/debugfs.h>
+#include <linux/ktime.h>
 #include <linux/mutex.h>
+#include <linux/seq_file.h>
 #include <linux/types.h>
 
 #include "sof-priv.h"
@@ -25,6 +28,37 @@ static void ipc_stream_message(struct snd_sof_dev *sdev, u32 msg_cmd);
  * IPC message Tx/Rx message handling.
  */
 
+#if IS_ENABLED(CONFIG_SND_SOC_SOF_DEBUG_IPC_STATS)
+/* one entry per global message type */
+#define SOF_IPC_STATS_TYPES	((SOF_GLB_TYPE_MASK >> SOF_GLB_TYPE_SHIFT) + 1)
+
+/* upper bounds of the reply latency histogram buckets, the last is open */
+static const unsigned int sof_ipc_stats_bounds_us[] = {
+	100, 200, 500, 1000, 2000, 5000, 10000, 50000,
+};
+
+#define SOF_IPC_STATS_BUCKETS	(ARRAY_SIZE(sof_ipc_stats_bounds_us) + 1)
+
+struct sof_ipc_type_stats {
+	/* messages sent by the host */
+	u64 tx_count;
+	u64 tx_errors;
+	u64 tx_timeouts;
+	u64 tx_bytes;
+	u64 reply_bytes;
+	u64 latency_total_us;
+	u64 latency_max_us;
+	u64 latency_hist[SOF_IPC_STATS_BUCKETS];
+	/* notifications sent by the DSP */
+	u64 rx_count;
+};
+
+struct sof_ipc_stats {
+	ktime_t start;
+	struct sof_ipc_type_stats type[SOF_IPC_STATS_TYPES];
+};
+#endif
+
 /* SOF generic IPC data */
 struct snd_sof_ipc {
 	struct snd_sof_dev *sdev;
@@ -35,6 +69,14 @@ struct snd_sof_ipc {
 	bool disable_ipc_tx;
 
 	struct snd_sof_ipc_msg msg;
+
+	/* chunk of large control data, protected by tx_mutex */
+	struct sof_ipc_ctrl_data *ctrl_chunk;
+
+#if IS_ENABLED(CONFIG_SND_SOC_SOF_DEBUG_IPC_STATS)
+	/* tx stats are updated under tx_mutex, rx from the IPC handler */
+	struct sof_ipc_stats stats;
+#endif
 };
 
 struct sof_ipc_ctrl_data_params {
@@ -196,6 +238,129 @@ static inline void ipc_log_header(struct device *dev, u8 *text, u32 cmd)
 }
 #endif
 
+#if IS_ENABLED(CONFIG_SND_SOC_SOF_DEBUG_IPC_STATS)
+static struct sof_ipc_type_stats *ipc_stats_type(struct snd_sof_ipc *ipc,
+						 u32 cmd)
+{
+	return &ipc->stats.type[(cmd & SOF_GLB_TYPE_MASK) >>
+				SOF_GLB_TYPE_SHIFT];
+}
+
+static void ipc_stats_tx(struct snd_sof_ipc *ipc, u32 cmd, size_t msg_bytes,
+			 size_t reply_bytes, ktime_t start, int ret)
+{
+	struct sof_ipc_type_stats *s = ipc_stats_type(ipc, cmd);
+	u64 us = ktime_us_delta(ktime_get(), start);
+	unsigned int i;
+
+	s->tx_count++;
+	s->tx_bytes += msg_bytes;
+	if (ret == -ETIMEDOUT)
+		s->tx_timeouts++;
+	if (ret < 0) {
+		s->tx_errors++;
+		return;
+	}
+
+	s->reply_bytes += reply_bytes;
+	s->latency_total_us += us;
+	s->latency_max_us = max(s->latency_max_us, us);
+
+	for (i = 0; i < ARRAY_SIZE(sof_ipc_stats_bounds_us); i++)
+		if (us < sof_ipc_stats_bounds_us[i])
+			break;
+	s->latency_hist[i]++;
+}
+
+static void ipc_stats_rx(struct snd_sof_ipc *ipc, u32 cmd)
+{
+	ipc_stats_type(ipc, cmd)->rx_count++;
+}
+
+static int ipc_stats_show(struct seq_file *s, void *unused)
+{
+	struct snd_sof_ipc *ipc = s->private;
+	struct sof_ipc_type_stats *t;
+	u64 elapsed_ms = ktime_ms_delta(ktime_get(), ipc->stats.start);
+	unsigned int i, j;
+
+	seq_printf(s, "elapsed %llu ms\n", elapsed_ms);
+	seq_puts(s, "type tx errors timeouts tx_bytes reply_bytes avg_us max_us rx rx_per_s latency_us(");
+	for (j = 0; j < ARRAY_SIZE(sof_ipc_stats_bounds_us); j++)
+		seq_printf(s, "<%u ", sof_ipc_stats_bounds_us[j]);
+	seq_puts(s, "more)\n");
+
+	for (i = 0; i < SOF_IPC_STATS_TYPES; i++) {
+		t = &ipc->stats.type[i];
+		if (!t->tx_count && !t->rx_count)
+			continue;
+
+		seq_printf(s, "0x%x %llu %llu %llu %llu %llu %llu %llu %llu %llu",
+			   i, t->tx_count, t->tx_errors, t->tx_timeouts,
+			   t->tx_bytes, t->reply_bytes,
+			   t->tx_count > t->tx_errors ?
+			   div64_u64(t->latency_total_us,
+				     t->tx_count - t->tx_errors) : 0,
+			   t->latency_max_us, t->rx_count,
+			   elapsed_ms ?
+			   div64_u64(t->rx_count * MSEC_PER_SEC, elapsed_ms) : 0);
+		for (j = 0; j < SOF_IPC_STATS_BUCKETS; j++)
+			seq_printf(s, " %llu", t->latency_hist[j]);
+		seq_putc(s, '\n');
+	}
+
+	return 0;
+}
+
+static int ipc_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, ipc_stats_show, inode->i_private);
+}
+
+/* any write resets the counters */
+static ssize_t ipc_stats_write(struct file *file, const char __user *buffer,
+			       size_t count, loff_t *ppos)
+{
+	struct snd_sof_ipc *ipc = file_inode(file)->i_private;
+
+	mutex_lock(&ipc->tx_mutex);
+	memset(&ipc->stats, 0, sizeof(ipc->stats));
+	ipc->stats.start = ktime_get();
+	mutex_unlock(&ipc->tx_mutex);
+
+	return count;
+}
+
+static const struct file_operations ipc_stats_fops = {
+	.open = ipc_stats_open,
+	.read = seq_read,
+	.write = ipc_stats_write,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static void ipc_stats_init(struct snd_sof_ipc *ipc)
+{
+	ipc->stats.start = ktime_get();
+	debugfs_create_file("ipc_stats", 0644, ipc->sdev->debugfs_root, ipc,
+			    &ipc_stats_fops);
+}
+#else
+static inline void ipc_stats_tx(struct snd_sof_ipc *ipc, u32 cmd,
+				size_t msg_bytes, size_t reply_bytes,
+				ktime_t start, int ret)
+{
+}
+
+static inline void ipc_stats_rx(struct snd_sof_ipc *ipc, u32 cmd)
+{
+}
+
+static inline void ipc_stats_init(struct snd_sof_ipc *ipc)
+{
+}
+#endif
+
 /* wait for IPC message reply */
 static int tx_wait_done(struct snd_sof_ipc *ipc, struct snd_sof_ipc_msg *msg,
 			void *reply_data)
@@ -237,6 +402,7 @@ static int sof_ipc_tx_message_unlocked(struct snd_sof_ipc *ipc, u32 header,
 {
 	struct snd_sof_dev *sdev = ipc->sdev;
 	struct snd_sof_ipc_msg *msg;
+	ktime_t start = ktime_get();
 	int ret;
 
 	if (ipc->disable_ipc_tx)
@@ -273,6 +439,7 @@ static int sof_ipc_tx_message_unlocked(struct snd_sof_ipc *ipc, u32 header,
 		dev_err_ratelimited(sdev->dev,
 				    "error: ipc tx failed with error %d\n",
 				    ret);
+		ipc_stats_tx(ipc, header, msg_bytes, 0, start, ret);
 		return ret;
 	}
 
@@ -282,6 +449,8 @@ static int sof_ipc_tx_message_unlocked(struct snd_sof_ipc *ipc, u32 header,
 	if (!ret)
 		ret = tx_wait_done(ipc, msg, reply_data);
 
+	ipc_stats_tx(ipc, header, msg_bytes, reply_bytes, start, ret);
+
 	return ret;
 }
 
@@ -307,6 +476,60 @@ int sof_ipc_tx_message(struct snd_sof_ipc *ipc, u32 header,
 }
 EXPORT_SYMBOL(sof_ipc_tx_message);
 
+/*
+ * Send a sequence of IPC messages to the DSP. The DSP is brought to D0 and
+ * the TX lock is taken once for the whole sequence, so that no other message
+ * gets in between. The firmware only handles one message at a time, each one
+ * is still acknowledged before the next is sent. The replies are all stored
+ * in @reply_data, callers only interested in errors can share one buffer.
+ * @sent is set to the number of messages acknowledged without error.
+ */
+int sof_ipc_tx_message_batch(struct snd_sof_ipc *ipc,
+			     const struct sof_ipc_batch_msg *msgs,
+			     unsigned int count, void *reply_data,
+			     size_t reply_bytes, unsigned int *sent)
+{
+	const struct sof_dsp_power_state target_state = {
+		.state = SOF_DSP_PM_D0,
+	};
+	unsigned int i;
+	int ret;
+
+	*sent = 0;
+
+	if (reply_bytes > SOF_IPC_MSG_MAX_SIZE)
+		return -ENOBUFS;
+
+	for (i = 0; i < count; i++)
+		if (msgs[i].msg_bytes > SOF_IPC_MSG_MAX_SIZE)
+			return -ENOBUFS;
+
+	/* ensure the DSP is in D0 before sending a new IPC */
+	ret = snd_sof_dsp_set_power_state(ipc->sdev, &target_state);
+	if (ret < 0) {
+		dev_err(ipc->sdev->dev, "error: resuming DSP %d\n", ret);
+		return ret;
+	}
+
+	mutex_lock(&ipc->tx_mutex);
+
+	for (i = 0; i < count; i++) {
+		ret = sof_ipc_tx_message_unlocked(ipc, msgs[i].header,
+						  msgs[i].msg_data,
+						  msgs[i].msg_bytes,
+						  reply_data, reply_bytes);
+		if (ret < 0)
+			break;
+	}
+
+	mutex_unlock(&ipc->tx_mutex);
+
+	*sent = i;
+
+	return ret;
+}
+EXPORT_SYMBOL(sof_ipc_tx_message_batch);
+
 /*
  * send IPC message from host to DSP without modifying the DSP state.
  * This will be used for IPC's that can be handled by the DSP
@@ -363,6 +586,7 @@ void snd_sof_ipc_msgs_rx(struct snd_sof_dev *sdev)
 	/* read back header */
 	snd_sof_ipc_msg_data(sdev, NULL, &hdr, sizeof(hdr));
 	ipc_log_header(sdev->dev, "ipc rx", hdr.cmd);
+	ipc_stats_rx(sdev->ipc, hdr.cmd);
 
 	cmd = hdr.cmd & SOF_GLB_TYPE_MASK;
 	type = hdr.cmd & SOF_CMD_TYPE_MASK;
@@ -575,7 +799,7 @@ static int sof_set_get_large_ctrl_data(struct snd_sof_dev *sdev,
 				       struct sof_ipc_ctrl_data_params *sparams,
 				       bool send)
 {
-	struct sof_ipc_ctrl_data *partdata;
+	struct sof_ipc_ctrl_data *partdata = sdev->ipc->ctrl_chunk;
 	size_t send_bytes;
 	size_t offset = 0;
 	size_t msg_bytes;
@@ -583,10 +807,8 @@ static int sof_set_get_large_ctrl_data(struct snd_sof_dev *sdev,
 	int err;
 	int i;
 
-	/* allocate max ipc size because we have at least one */
-	partdata = kzalloc(SOF_IPC_MSG_MAX_SIZE, GFP_KERNEL);
-	if (!partdata)
-		return -ENOMEM;
+	/* Serialise IPC TX, this also protects the chunk buffer */
+	mutex_lock(&sdev->ipc->tx_mutex);
 
 	if (send)
 		err = sof_get_ctrl_copy_params(cdata->type, cdata, partdata,
@@ -595,7 +817,7 @@ static int sof_set_get_large_ctrl_data(struct snd_sof_dev *sdev,
 		err = sof_get_ctrl_copy_params(cdata->type, partdata, cdata,
 					       sparams);
 	if (err < 0) {
-		kfree(partdata);
+		mutex_unlock(&sdev->ipc->tx_mutex);
 		return err;
 	}
 
@@ -605,9 +827,6 @@ static int sof_set_get_large_ctrl_data(struct snd_sof_dev *sdev,
 	/* copy the header data */
 	memcpy(partdata, cdata, sparams->hdr_bytes);
 
-	/* Serialise IPC TX */
-	mutex_lock(&sdev->ipc->tx_mutex);
-
 	/* copy the payload data in a loop */
 	for (i = 0; i < sparams->num_msg; i++) {
 		send_bytes = min(msg_bytes, pl_size);
@@ -637,7 +856,6 @@ static int sof_set_get_large_ctrl_data(struct snd_sof_dev *sdev,
 
 	mutex_unlock(&sdev->ipc->tx_mutex);
 
-	kfree(partdata);
 	return err;
 }
 
@@ -840,8 +1058,16 @@ struct snd_sof_ipc *snd_sof_ipc_init(struct snd_sof_dev *sdev)
 	if (!msg->reply_data)
 		return NULL;
 
+	/* max ipc size as large control data is sent in full chunks */
+	ipc->ctrl_chunk = devm_kzalloc(sdev->dev, SOF_IPC_MSG_MAX_SIZE,
+				       GFP_KERNEL);
+	if (!ipc->ctrl_chunk)
+		return NULL;
+
 	init_waitqueue_head(&msg->waitq);
 
+	ipc_stats_init(ipc);
+
 	return ipc;
 }
 EXPORT_SYMBOL(snd_sof_ipc_init);
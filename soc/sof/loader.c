@@ -631,11 +631,10 @@ static int load_modules(struct snd_sof_dev *sdev, const struct firmware *fw,
 	return 0;
 }
 
-int snd_sof_load_firmware_raw(struct snd_sof_dev *sdev)
+int snd_sof_request_firmware(struct snd_sof_dev *sdev)
 {
 	struct snd_sof_pdata *plat_data = sdev->pdata;
 	const char *fw_filename;
-	ssize_t ext_man_size;
 	int ret;
 
 	/* Don't request firmware again if firmware is already requested */
@@ -653,12 +652,33 @@ int snd_sof_load_firmware_raw(struct snd_sof_dev *sdev)
 	if (ret < 0) {
 		dev_err(sdev->dev, "error: request firmware %s failed err: %d\n",
 			fw_filename, ret);
-		goto err;
 	} else {
 		dev_dbg(sdev->dev, "request_firmware %s successful\n",
 			fw_filename);
 	}
 
+	kfree(fw_filename);
+
+	return ret;
+}
+
+int snd_sof_load_firmware_raw(struct snd_sof_dev *sdev)
+{
+	struct snd_sof_pdata *plat_data = sdev->pdata;
+	ssize_t ext_man_size;
+	int ret;
+
+	/*
+	 * The image may have been fetched ahead of time during probe, the
+	 * extended manifest still has to be parsed once on first boot.
+	 */
+	if (plat_data->fw && !sdev->first_boot)
+		return 0;
+
+	ret = snd_sof_request_firmware(sdev);
+	if (ret < 0)
+		return ret;
+
 	/* check for extended manifest */
 	ext_man_size = snd_sof_ext_man_size(plat_data->fw);
 	if (ext_man_size > 0) {
@@ -668,20 +688,19 @@ int snd_sof_load_firmware_raw(struct snd_sof_dev *sdev)
 		if (!ret)
 			plat_data->fw_offset = ext_man_size;
 		else
-			dev_err(sdev->dev, "error: firmware %s contains unsupported or invalid extended manifest: %d\n",
-				fw_filename, ret);
+			dev_err(sdev->dev, "error: firmware %s/%s contains unsupported or invalid extended manifest: %d\n",
+				plat_data->fw_filename_prefix,
+				plat_data->fw_filename, ret);
 	} else if (!ext_man_size) {
 		/* No extended manifest, so nothing to skip during FW load */
 		dev_dbg(sdev->dev, "firmware doesn't contain extended manifest\n");
 	} else {
 		ret = ext_man_size;
-		dev_err(sdev->dev, "error: firmware %s contains unsupported or invalid extended manifest: %d\n",
-			fw_filename, ret);
+		dev_err(sdev->dev, "error: firmware %s/%s contains unsupported or invalid extended manifest: %d\n",
+			plat_data->fw_filename_prefix,
+			plat_data->fw_filename, ret);
 	}
 
-err:
-	kfree(fw_filename);
-
 	return ret;
 }
 EXPORT_SYMBOL(snd_sof_load_firmware_raw);
@@ -695,11 +714,14 @@ int snd_sof_load_firmware_memcpy(struct snd_sof_dev *sdev)
 	if (ret < 0)
 		return ret;
 
-	/* make sure the FW header and file is valid */
-	ret = check_header(sdev, plat_data->fw, plat_data->fw_offset);
-	if (ret < 0) {
-		dev_err(sdev->dev, "error: invalid FW header\n");
-		goto error;
+	/* make sure the FW header and file is valid, once per request */
+	if (!sdev->fw_header_valid) {
+		ret = check_header(sdev, plat_data->fw, plat_data->fw_offset);
+		if (ret < 0) {
+			dev_err(sdev->dev, "error: invalid FW header\n");
+			goto error;
+		}
+		sdev->fw_header_valid = true;
 	}
 
 	/* prepare the DSP for FW loading */
@@ -721,6 +743,7 @@ int snd_sof_load_firmware_memcpy(struct snd_sof_dev *sdev)
 error:
 	release_firmware(plat_data->fw);
 	plat_data->fw = NULL;
+	sdev->fw_header_valid = false;
 	return ret;
 
 }
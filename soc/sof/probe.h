@@ -33,6 +33,21 @@ struct sof_probe_point_desc {
 	unsigned int stream_tag;
 } __packed;
 
+#define SOF_PROBE_PACKET_SYNC	0xBABEBEBA
+
+/*
+ * Header of the packets in the extraction stream, followed by
+ * data_size_bytes of data and a 64-bit checksum.
+ */
+struct sof_probe_packet {
+	u32 sync_word;
+	u32 buffer_id;
+	u32 format;
+	u32 timestamp_low;
+	u32 timestamp_high;
+	u32 data_size_bytes;
+} __packed;
+
 struct sof_ipc_probe_dma_add_params {
 	struct sof_ipc_cmd_hdr hdr;
 	unsigned int num_elems;
@@ -100,11 +100,17 @@ static int sof_restore_kcontrols(struct device *dev)
 	int ipc_cmd, ctrl_type;
 	int ret = 0;
 
-	/* restore kcontrol values */
+	/*
+	 * Restore kcontrol values. The DSP sets the others to the values
+	 * read back after topology load when their widget is created again.
+	 */
 	list_for_each_entry(scontrol, &sdev->kcontrol_list, list) {
 		/* reset readback offset for scontrol after resuming */
 		scontrol->readback_offset = 0;
 
+		if (!scontrol->dirty)
+			continue;
+
 		/* notify DSP of kcontrol values */
 		switch (scontrol->cmd) {
 		case SOF_CTRL_CMD_VOLUME:
@@ -142,21 +148,41 @@ static int sof_restore_kcontrols(struct device *dev)
 	return 0;
 }
 
-int sof_restore_pipelines(struct device *dev)
+void sof_replay_invalidate(struct snd_sof_dev *sdev)
 {
-	struct snd_sof_dev *sdev = dev_get_drvdata(dev);
+	kfree(sdev->replay);
+	sdev->replay = NULL;
+	sdev->replay_count = 0;
+}
+
+/*
+ * Record the widget and route IPCs in the order they were sent when the
+ * topology was loaded. The payloads are the ones kept by the widgets and
+ * routes, so the log only holds pointers and is dropped whenever a widget
+ * or a route is added or removed.
+ */
+static int sof_replay_build(struct snd_sof_dev *sdev)
+{
+	struct snd_sof_replay_msg *replay, *m;
 	struct snd_sof_widget *swidget;
 	struct snd_sof_route *sroute;
-	struct sof_ipc_pipe_new *pipeline;
-	struct snd_sof_dai *dai;
+	struct sof_ipc_pipe_comp_connect *connect;
 	struct sof_ipc_comp_dai *comp_dai;
 	struct sof_ipc_cmd_hdr *hdr;
-	int ret;
+	struct snd_sof_dai *dai;
+	unsigned int count = 0;
 
-	/* restore pipeline components */
-	list_for_each_entry_reverse(swidget, &sdev->widget_list, list) {
-		struct sof_ipc_comp_reply r;
+	list_for_each_entry(swidget, &sdev->widget_list, list)
+		count++;
+	list_for_each_entry(sroute, &sdev->route_list, list)
+		count++;
+
+	replay = kcalloc(count, sizeof(*replay), GFP_KERNEL);
+	if (!replay)
+		return -ENOMEM;
 
+	m = replay;
+	list_for_each_entry_reverse(swidget, &sdev->widget_list, list) {
 		/* skip if there is no private data */
 		if (!swidget->private)
 			continue;
@@ -166,69 +192,114 @@ int sof_restore_pipelines(struct device *dev)
 		case snd_soc_dapm_dai_out:
 			dai = swidget->private;
 			comp_dai = &dai->comp_dai;
-			ret = sof_ipc_tx_message(sdev->ipc,
-						 comp_dai->comp.hdr.cmd,
-						 comp_dai, sizeof(*comp_dai),
-						 &r, sizeof(r));
+			m->msg.header = comp_dai->comp.hdr.cmd;
+			m->msg.msg_data = comp_dai;
+			m->msg.msg_bytes = sizeof(*comp_dai);
 			break;
 		case snd_soc_dapm_scheduler:
-
-			/*
-			 * During suspend, all DSP cores are powered off.
-			 * Therefore upon resume, create the pipeline comp
-			 * and power up the core that the pipeline is
-			 * scheduled on.
-			 */
-			pipeline = swidget->private;
-			ret = sof_load_pipeline_ipc(dev, pipeline, &r);
+			m->pipeline = swidget->private;
 			break;
 		default:
 			hdr = swidget->private;
-			ret = sof_ipc_tx_message(sdev->ipc, hdr->cmd,
-						 swidget->private, hdr->size,
-						 &r, sizeof(r));
+			m->msg.header = hdr->cmd;
+			m->msg.msg_data = hdr;
+			m->msg.msg_bytes = hdr->size;
 			break;
 		}
-		if (ret < 0) {
-			dev_err(dev,
-				"error: failed to load widget type %d with ID: %d\n",
-				swidget->widget->id, swidget->comp_id);
-
-			return ret;
-		}
+		m++;
 	}
 
-	/* restore pipeline connections */
 	list_for_each_entry_reverse(sroute, &sdev->route_list, list) {
-		struct sof_ipc_pipe_comp_connect *connect;
-		struct sof_ipc_reply reply;
-
 		/* skip if there's no private data */
 		if (!sroute->private)
 			continue;
 
 		connect = sroute->private;
+		m->msg.header = connect->hdr.cmd;
+		m->msg.msg_data = connect;
+		m->msg.msg_bytes = sizeof(*connect);
+		m++;
+	}
 
-		/* send ipc */
-		ret = sof_ipc_tx_message(sdev->ipc,
-					 connect->hdr.cmd,
-					 connect, sizeof(*connect),
-					 &reply, sizeof(reply));
+	sdev->replay = replay;
+	sdev->replay_count = m - replay;
+
+	return 0;
+}
+
+/*
+ * Send the replay log. Messages are sent in sequences, only broken by the
+ * pipelines which need their core powered up before the next message.
+ */
+static int sof_replay_send(struct snd_sof_dev *sdev)
+{
+	struct snd_sof_replay_msg *replay = sdev->replay;
+	struct sof_ipc_batch_msg *msgs;
+	struct sof_ipc_comp_reply r;
+	unsigned int i, first, sent;
+	int ret = 0;
+
+	msgs = kcalloc(sdev->replay_count, sizeof(*msgs), GFP_KERNEL);
+	if (!msgs)
+		return -ENOMEM;
+
+	for (first = 0; first < sdev->replay_count; first = i + 1) {
+		for (i = first; i < sdev->replay_count; i++) {
+			if (replay[i].pipeline)
+				break;
+			msgs[i - first] = replay[i].msg;
+		}
+
+		if (i > first) {
+			ret = sof_ipc_tx_message_batch(sdev->ipc, msgs,
+						       i - first, &r,
+						       sizeof(r), &sent);
+			if (ret < 0) {
+				dev_err(sdev->dev,
+					"error: failed to restore IPC 0x%x: %d\n",
+					msgs[sent].header, ret);
+				break;
+			}
+		}
+
+		if (i == sdev->replay_count)
+			break;
+
+		ret = sof_load_pipeline_ipc(sdev->dev, replay[i].pipeline, &r);
 		if (ret < 0) {
-			dev_err(dev,
-				"error: failed to load route sink %s control %s source %s\n",
-				sroute->route->sink,
-				sroute->route->control ? sroute->route->control
-					: "none",
-				sroute->route->source);
+			dev_err(sdev->dev,
+				"error: failed to restore pipeline %d\n",
+				replay[i].pipeline->pipeline_id);
+			break;
+		}
+	}
+
+	kfree(msgs);
+
+	return ret;
+}
+
+int sof_restore_pipelines(struct device *dev)
+{
+	struct snd_sof_dev *sdev = dev_get_drvdata(dev);
+	struct snd_sof_widget *swidget;
+	struct snd_sof_dai *dai;
+	struct sof_ipc_reply reply;
+	int ret;
 
+	/* restore pipeline components and connections */
+	if (!sdev->replay) {
+		ret = sof_replay_build(sdev);
+		if (ret < 0)
 			return ret;
-		}
 	}
 
+	ret = sof_replay_send(sdev);
+	if (ret < 0)
+		return ret;
+
 	/* restore dai links */
 	list_for_each_entry_reverse(dai, &sdev->dai_list, list) {
-		struct sof_ipc_reply reply;
 		struct sof_ipc_dai_config *config = dai->dai_config;
 
 		if (!config) {
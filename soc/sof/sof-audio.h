@@ -71,6 +71,7 @@ struct snd_sof_control {
 	u32 size;	/* cdata size */
 	enum sof_ipc_ctrl_cmd cmd;
 	u32 *volume_table; /* volume table computed from tlv data*/
+	bool dirty; /* differs from the value set when its widget is created */
 
 	struct list_head list;	/* list in sdev control list */
 
@@ -202,7 +203,15 @@ int snd_sof_ipc_set_get_comp_data(struct snd_sof_control *scontrol,
 				  enum sof_ipc_ctrl_cmd ctrl_cmd,
 				  bool send);
 
+/* IPC replayed to restore a widget or a route on resume */
+struct snd_sof_replay_msg {
+	struct sof_ipc_batch_msg msg;
+	/* set for a pipeline, its core is powered up once it is created */
+	struct sof_ipc_pipe_new *pipeline;
+};
+
 /* PM */
+void sof_replay_invalidate(struct snd_sof_dev *sdev);
 int sof_restore_pipelines(struct device *dev);
 int sof_set_hw_params_upon_resume(struct device *dev);
 bool snd_sof_stream_suspend_ignored(struct snd_sof_dev *sdev);
@@ -170,6 +170,10 @@ struct snd_sof_dsp_ops {
 	snd_pcm_uframes_t (*pcm_pointer)(struct snd_sof_dev *sdev,
 					 struct snd_pcm_substream *substream); /* optional */
 
+	/* host stream application pointer update */
+	int (*pcm_ack)(struct snd_sof_dev *sdev,
+		       struct snd_pcm_substream *substream); /* optional */
+
 #if IS_ENABLED(CONFIG_SND_SOC_SOF_DEBUG_PROBES)
 	/* Except for probe_pointer, all probe ops are mandatory */
 	int (*probe_assign)(struct snd_sof_dev *sdev,
@@ -400,6 +404,7 @@ struct snd_sof_dev {
 	/* firmware loader */
 	struct snd_dma_buffer dmab;
 	struct snd_dma_buffer dmab_bdl;
+	bool fw_header_valid; /* pdata->fw passed check_header() */
 	struct sof_ipc_fw_ready fw_ready;
 	struct sof_ipc_fw_version fw_version;
 	struct sof_ipc_cc_version *cc_version;
@@ -414,6 +419,10 @@ struct snd_sof_dev {
 	struct snd_soc_component *component;
 	u32 enabled_cores_mask; /* keep track of enabled cores */
 
+	/* widget and route IPCs replayed on resume, NULL until first resume */
+	struct snd_sof_replay_msg *replay;
+	unsigned int replay_count;
+
 	/* FW configuration */
 	struct sof_ipc_window *info_window;
 
@@ -423,6 +432,7 @@ struct snd_sof_dev {
 
 #if IS_ENABLED(CONFIG_SND_SOC_SOF_DEBUG_PROBES)
 	unsigned int extractor_stream_tag;
+	struct sof_probe_demux *probe_demux;
 #endif
 
 	/* DMA for Trace */
@@ -431,6 +441,7 @@ struct snd_sof_dev {
 	int dma_trace_pages;
 	wait_queue_head_t trace_sleep;
 	u32 host_offset;
+	struct snd_sof_dtrace_pos *dtrace_pos;
 	u32 dtrace_is_supported; /* set with Kconfig or module parameter */
 	u32 dtrace_is_enabled;
 	u32 dtrace_error;
@@ -441,6 +452,16 @@ struct snd_sof_dev {
 	void *private;			/* core does not touch this */
 };
 
+/*
+ * DMA trace position, mapped read-only to userspace in the page following
+ * the trace buffer.
+ */
+struct snd_sof_dtrace_pos {
+	u32 host_offset;	/* DMA write offset in the trace buffer */
+	u32 size;		/* trace buffer size in bytes */
+	u32 updates;		/* incremented at each host_offset change */
+};
+
 /*
  * Device Level.
  */
@@ -466,6 +487,7 @@ int snd_sof_create_page_table(struct device *dev,
  * Firmware loading.
  */
 int snd_sof_load_firmware(struct snd_sof_dev *sdev);
+int snd_sof_request_firmware(struct snd_sof_dev *sdev);
 int snd_sof_load_firmware_raw(struct snd_sof_dev *sdev);
 int snd_sof_load_firmware_memcpy(struct snd_sof_dev *sdev);
 int snd_sof_run_firmware(struct snd_sof_dev *sdev);
@@ -490,6 +512,18 @@ int snd_sof_ipc_valid(struct snd_sof_dev *sdev);
 int sof_ipc_tx_message(struct snd_sof_ipc *ipc, u32 header,
 		       void *msg_data, size_t msg_bytes, void *reply_data,
 		       size_t reply_bytes);
+
+/* one message of sof_ipc_tx_message_batch() */
+struct sof_ipc_batch_msg {
+	u32 header;
+	void *msg_data;
+	size_t msg_bytes;
+};
+
+int sof_ipc_tx_message_batch(struct snd_sof_ipc *ipc,
+			     const struct sof_ipc_batch_msg *msgs,
+			     unsigned int count, void *reply_data,
+			     size_t reply_bytes, unsigned int *sent);
 int sof_ipc_tx_message_no_pm(struct snd_sof_ipc *ipc, u32 header,
 			     void *msg_data, size_t msg_bytes,
 			     void *reply_data, size_t reply_bytes);
@@ -559,17 +593,19 @@ void sof_block_read(struct snd_sof_dev *sdev, u32 bar, u32 offset, void *dest,
 
 int sof_fw_ready(struct snd_sof_dev *sdev, u32 msg_id);
 
-void intel_ipc_msg_data(struct snd_sof_dev *sdev,
-			struct snd_pcm_substream *substream,
-			void *p, size_t sz);
-int intel_ipc_pcm_params(struct snd_sof_dev *sdev,
-			 struct snd_pcm_substream *substream,
-			 const struct sof_ipc_pcm_params_reply *reply);
-
-int intel_pcm_open(struct snd_sof_dev *sdev,
-		   struct snd_pcm_substream *substream);
-int intel_pcm_close(struct snd_sof_dev *sdev,
-		    struct snd_pcm_substream *substream);
+void sof_ipc_msg_data(struct snd_sof_dev *sdev,
+		      struct snd_pcm_substream *substream,
+		      void *p, size_t sz);
+int sof_ipc_pcm_params(struct snd_sof_dev *sdev,
+		       struct snd_pcm_substream *substream,
+		       const struct sof_ipc_pcm_params_reply *reply);
+
+int sof_stream_pcm_open(struct snd_sof_dev *sdev,
+			struct snd_pcm_substream *substream);
+int sof_stream_pcm_close(struct snd_sof_dev *sdev,
+			 struct snd_pcm_substream *substream);
+snd_pcm_uframes_t sof_stream_pcm_pointer(struct snd_sof_dev *sdev,
+					 struct snd_pcm_substream *substream);
 
 int sof_machine_check(struct snd_sof_dev *sdev);
 
@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: (GPL-2.0 OR BSD-3-Clause)
+//
+// This file is provided under a dual BSD/GPLv2 license.  When using or
+// redistributing this file, you may do so under either license.
+//
+// Copyright(c) 2019 Intel Corporation. All rights reserved.
+//
+// Authors: Guennadi Liakhovetski <guennadi.liakhovetski@linux.intel.com>
+
+/* Generic SOF IPC code */
+
+#include <linux/device.h>
+#include <linux/export.h>
+#include <linux/module.h>
+#include <linux/types.h>
+
+#include <dkms/sound/pcm.h>
+#include <dkms/sound/sof/stream.h>
+
+#include "ops.h"
+#include "sof-audio.h"
+#include "sof-priv.h"
+
+/* reads of a position the DSP may be updating before giving up */
+#define SOF_POSN_READ_ATTEMPTS	4
+
+struct sof_stream {
+	size_t posn_offset;	/* 0 until the stream params are set */
+};
+
+/* Mailbox-based Generic IPC implementation */
+void sof_ipc_msg_data(struct snd_sof_dev *sdev,
+		      struct snd_pcm_substream *substream,
+		      void *p, size_t sz)
+{
+	if (!substream || !sdev->stream_box.size) {
+		sof_mailbox_read(sdev, sdev->dsp_box.offset, p, sz);
+	} else {
+		struct sof_stream *stream = substream->runtime->private_data;
+
+		/* The stream might already be closed */
+		if (stream)
+			sof_mailbox_read(sdev, stream->posn_offset, p, sz);
+	}
+}
+EXPORT_SYMBOL(sof_ipc_msg_data);
+
+int sof_ipc_pcm_params(struct snd_sof_dev *sdev,
+		       struct snd_pcm_substream *substream,
+		       const struct sof_ipc_pcm_params_reply *reply)
+{
+	struct sof_stream *stream = substream->runtime->private_data;
+	size_t posn_offset = reply->posn_offset;
+
+	/* without a stream window positions come with the IPC */
+	if (!sdev->stream_box.size)
+		return 0;
+
+	/* check if offset is overflow or it is not aligned */
+	if (posn_offset > sdev->stream_box.size ||
+	    posn_offset % sizeof(struct sof_ipc_stream_posn) != 0)
+		return -EINVAL;
+
+	stream->posn_offset = sdev->stream_box.offset + posn_offset;
+
+	dev_dbg(sdev->dev, "pcm: stream dir %d, posn mailbox offset is %zu",
+		substream->stream, stream->posn_offset);
+
+	return 0;
+}
+EXPORT_SYMBOL(sof_ipc_pcm_params);
+
+int sof_stream_pcm_open(struct snd_sof_dev *sdev,
+			struct snd_pcm_substream *substream)
+{
+	struct sof_stream *stream = kzalloc(sizeof(*stream), GFP_KERNEL);
+
+	if (!stream)
+		return -ENOMEM;
+
+	/* binding pcm substream to hda stream */
+	substream->runtime->private_data = stream;
+
+	return 0;
+}
+EXPORT_SYMBOL(sof_stream_pcm_open);
+
+int sof_stream_pcm_close(struct snd_sof_dev *sdev,
+			 struct snd_pcm_substream *substream)
+{
+	struct sof_stream *stream = substream->runtime->private_data;
+
+	substream->runtime->private_data = NULL;
+	kfree(stream);
+
+	return 0;
+}
+EXPORT_SYMBOL(sof_stream_pcm_close);
+
+/*
+ * The DSP writes the position in the stream window before sending the
+ * position IPC, read it from there rather than waiting for the IPC to be
+ * handled. No lock is shared with the DSP, so the host position is read
+ * until two reads agree.
+ */
+snd_pcm_uframes_t sof_stream_pcm_pointer(struct snd_sof_dev *sdev,
+					 struct snd_pcm_substream *substream)
+{
+	struct snd_soc_pcm_runtime *rtd = substream->private_data;
+	struct sof_stream *stream = substream->runtime->private_data;
+	size_t offset = offsetof(struct sof_ipc_stream_posn, host_posn);
+	struct snd_sof_pcm *spcm;
+	u64 host, prev;
+	int i;
+
+	if (stream && stream->posn_offset && sdev->stream_box.size) {
+		sof_mailbox_read(sdev, stream->posn_offset + offset, &host,
+				 sizeof(host));
+		for (i = 1; i < SOF_POSN_READ_ATTEMPTS; i++) {
+			prev = host;
+			sof_mailbox_read(sdev, stream->posn_offset + offset,
+					 &host, sizeof(host));
+			if (host != prev)
+				continue;
+
+			if (host < snd_pcm_lib_buffer_bytes(substream))
+				return bytes_to_frames(substream->runtime,
+						       host);
+			break;
+		}
+	}
+
+	/* fall back to the position of the last IPC */
+	spcm = snd_sof_find_spcm_dai(sdev->component, rtd);
+	if (!spcm) {
+		dev_warn_ratelimited(sdev->dev, "warn: can't find PCM with DAI ID %d\n",
+				     rtd->dai_link->id);
+		return 0;
+	}
+
+	return bytes_to_frames(substream->runtime,
+			       spcm->stream[substream->stream].posn.host_posn);
+}
+EXPORT_SYMBOL(sof_stream_pcm_pointer);
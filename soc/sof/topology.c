@@ -2134,6 +2134,8 @@ static int sof_process_load(struct snd_soc_component *scomp, int index,
 
 	/* send control data with large message supported method */
 	for (i = 0; i < widget->num_kcontrols; i++) {
+		/* not part of the widget IPC, always restored on resume */
+		wdata[i].control->dirty = true;
 		wdata[i].control->readback_offset = 0;
 		ret = snd_sof_ipc_set_get_comp_data(wdata[i].control,
 						    wdata[i].ipc_cmd,
@@ -2358,12 +2360,14 @@ static int sof_widget_ready(struct snd_soc_component *scomp, int index,
 
 	w->dobj.private = swidget;
 	list_add(&swidget->list, &sdev->widget_list);
+	sof_replay_invalidate(sdev);
 	return ret;
 }
 
 static int sof_route_unload(struct snd_soc_component *scomp,
 			    struct snd_soc_dobj *dobj)
 {
+	struct snd_sof_dev *sdev = snd_soc_component_get_drvdata(scomp);
 	struct snd_sof_route *sroute;
 
 	sroute = dobj->private;
@@ -2374,6 +2378,7 @@ static int sof_route_unload(struct snd_soc_component *scomp,
 	kfree(sroute->private);
 	list_del(&sroute->list);
 	kfree(sroute);
+	sof_replay_invalidate(sdev);
 
 	return 0;
 }
@@ -2460,6 +2465,7 @@ out:
 	/* remove and free swidget object */
 	list_del(&swidget->list);
 	kfree(swidget);
+	sof_replay_invalidate(sdev);
 
 	return ret;
 }
@@ -3444,6 +3450,7 @@ static int sof_route_load(struct snd_soc_component *scomp, int index,
 
 		/* add route to route list */
 		list_add(&sroute->list, &sdev->route_list);
+		sof_replay_invalidate(sdev);
 
 		return ret;
 	}
@@ -3492,6 +3499,8 @@ static int snd_sof_cache_kcontrol_val(struct snd_soc_component *scomp)
 			dev_warn(scomp->dev,
 				 "error: kcontrol value get for widget: %d\n",
 				 scontrol->comp_id);
+			/* the DSP value is unknown, restore ours on resume */
+			scontrol->dirty = true;
 		}
 	}
 
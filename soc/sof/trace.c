@@ -9,10 +9,24 @@
 //
 
 #include <linux/debugfs.h>
+#include <linux/mm.h>
+#include <linux/poll.h>
 #include <linux/sched/signal.h>
 #include "sof-priv.h"
 #include "ops.h"
 
+static void sof_trace_set_host_offset(struct snd_sof_dev *sdev, u32 offset)
+{
+	struct snd_sof_dtrace_pos *pos = sdev->dtrace_pos;
+
+	sdev->host_offset = offset;
+
+	WRITE_ONCE(pos->host_offset, offset);
+	/* readers check updates after host_offset */
+	smp_wmb();
+	WRITE_ONCE(pos->updates, pos->updates + 1);
+}
+
 static size_t sof_trace_avail(struct snd_sof_dev *sdev,
 			      loff_t pos, size_t buffer_size)
 {
@@ -120,7 +134,81 @@ static int sof_dfsentry_trace_release(struct inode *inode, struct file *file)
 
 	/* avoid duplicate traces at next open */
 	if (!sdev->dtrace_is_enabled)
-		sdev->host_offset = 0;
+		sof_trace_set_host_offset(sdev, 0);
+
+	return 0;
+}
+
+/*
+ * Readers of the mapped buffer seek to the position they consumed, poll
+ * reports whether the DSP wrote past it.
+ */
+static __poll_t sof_dfsentry_trace_poll(struct file *file, poll_table *wait)
+{
+	struct snd_sof_dfsentry *dfse = file->private_data;
+	struct snd_sof_dev *sdev = dfse->sdev;
+	u64 lpos_64 = file->f_pos;
+	loff_t lpos;
+
+	poll_wait(file, &sdev->trace_sleep, wait);
+
+	if (sdev->dtrace_error)
+		return EPOLLERR;
+
+	lpos = do_div(lpos_64, dfse->size);
+	if (sof_trace_avail(sdev, lpos, dfse->size))
+		return EPOLLIN | EPOLLRDNORM;
+
+	return 0;
+}
+
+static vm_fault_t sof_dfsentry_trace_fault(struct vm_fault *vmf)
+{
+	struct snd_sof_dfsentry *dfse = vmf->vma->vm_private_data;
+	struct snd_sof_dev *sdev = dfse->sdev;
+	unsigned long offset = vmf->pgoff << PAGE_SHIFT;
+	struct page *page;
+	void *vaddr;
+
+	if (offset < PAGE_ALIGN(dfse->size)) {
+		vaddr = dfse->buf + offset;
+		if (is_vmalloc_addr(vaddr))
+			page = vmalloc_to_page(vaddr);
+		else
+			page = virt_to_page(vaddr);
+	} else if (offset == PAGE_ALIGN(dfse->size)) {
+		page = virt_to_page(sdev->dtrace_pos);
+	} else {
+		return VM_FAULT_SIGBUS;
+	}
+
+	get_page(page);
+	vmf->page = page;
+
+	return 0;
+}
+
+static const struct vm_operations_struct sof_dfs_trace_vm_ops = {
+	.fault = sof_dfsentry_trace_fault,
+};
+
+/* map the trace buffer followed by the position page, read-only */
+static int sof_dfsentry_trace_mmap(struct file *file,
+				   struct vm_area_struct *vma)
+{
+	struct snd_sof_dfsentry *dfse = file->private_data;
+	unsigned long pages = (PAGE_ALIGN(dfse->size) >> PAGE_SHIFT) + 1;
+
+	if (vma->vm_flags & VM_WRITE)
+		return -EPERM;
+
+	if (vma->vm_pgoff >= pages || vma_pages(vma) > pages - vma->vm_pgoff)
+		return -EINVAL;
+
+	vma->vm_flags &= ~VM_MAYWRITE;
+	vma->vm_flags |= VM_DONTEXPAND | VM_DONTDUMP;
+	vma->vm_ops = &sof_dfs_trace_vm_ops;
+	vma->vm_private_data = dfse;
 
 	return 0;
 }
@@ -128,6 +216,8 @@ static int sof_dfsentry_trace_release(struct inode *inode, struct file *file)
 static const struct file_operations sof_dfs_trace_fops = {
 	.open = simple_open,
 	.read = sof_dfsentry_trace_read,
+	.poll = sof_dfsentry_trace_poll,
+	.mmap = sof_dfsentry_trace_mmap,
 	.llseek = default_llseek,
 	.release = sof_dfsentry_trace_release,
 };
@@ -148,8 +238,12 @@ static int trace_debugfs_create(struct snd_sof_dev *sdev)
 	dfse->size = sdev->dmatb.bytes;
 	dfse->sdev = sdev;
 
-	debugfs_create_file("trace", 0444, sdev->debugfs_root, dfse,
-			    &sof_dfs_trace_fops);
+	/*
+	 * The debugfs proxy doesn't forward mmap, the file lives as long as
+	 * the device so it is safe to use the file operations directly.
+	 */
+	debugfs_create_file_unsafe("trace", 0444, sdev->debugfs_root, dfse,
+				   &sof_dfs_trace_fops);
 
 	return 0;
 }
@@ -184,7 +278,7 @@ int snd_sof_init_trace_ipc(struct snd_sof_dev *sdev)
 	params.buffer.pages = sdev->dma_trace_pages;
 	params.stream_tag = 0;
 
-	sdev->host_offset = 0;
+	sof_trace_set_host_offset(sdev, 0);
 	sdev->dtrace_draining = false;
 
 	ret = snd_sof_dma_trace_init(sdev, &params.stream_tag);
@@ -258,6 +352,14 @@ int snd_sof_init_trace(struct snd_sof_dev *sdev)
 	sdev->dma_trace_pages = ret;
 	dev_dbg(sdev->dev, "dma_trace_pages: %d\n", sdev->dma_trace_pages);
 
+	/* allocate the position page shared with the trace readers */
+	sdev->dtrace_pos = (void *)get_zeroed_page(GFP_KERNEL);
+	if (!sdev->dtrace_pos) {
+		ret = -ENOMEM;
+		goto table_err;
+	}
+	sdev->dtrace_pos->size = sdev->dmatb.bytes;
+
 	if (sdev->first_boot) {
 		ret = trace_debugfs_create(sdev);
 		if (ret < 0)
@@ -272,6 +374,8 @@ int snd_sof_init_trace(struct snd_sof_dev *sdev)
 
 	return 0;
 table_err:
+	free_page((unsigned long)sdev->dtrace_pos);
+	sdev->dtrace_pos = NULL;
 	sdev->dma_trace_pages = 0;
 	snd_dma_free_pages(&sdev->dmatb);
 page_err:
@@ -287,7 +391,7 @@ int snd_sof_trace_update_pos(struct snd_sof_dev *sdev,
 		return 0;
 
 	if (sdev->dtrace_is_enabled && sdev->host_offset != posn->host_offset) {
-		sdev->host_offset = posn->host_offset;
+		sof_trace_set_host_offset(sdev, posn->host_offset);
 		wake_up(&sdev->trace_sleep);
 	}
 
@@ -346,6 +450,8 @@ void snd_sof_free_trace(struct snd_sof_dev *sdev)
 	if (sdev->dma_trace_pages) {
 		snd_dma_free_pages(&sdev->dmatb);
 		snd_dma_free_pages(&sdev->dmatp);
+		free_page((unsigned long)sdev->dtrace_pos);
+		sdev->dtrace_pos = NULL;
 		sdev->dma_trace_pages = 0;
 	}
 }
@@ -22,22 +22,18 @@
 
 static struct tegra30_ahub *ahub;
 
-static inline void tegra30_apbif_write(u32 reg, u32 val)
-{
-	regmap_write(ahub->regmap_apbif, reg, val);
-}
-
-static inline u32 tegra30_apbif_read(u32 reg)
+/*
+ * The channel, CIF and routing registers are all cached, so updating them
+ * only costs a bus write when the value actually changes.
+ */
+static inline void tegra30_apbif_update_bits(u32 reg, u32 mask, u32 val)
 {
-	u32 val;
-
-	regmap_read(ahub->regmap_apbif, reg, &val);
-	return val;
+	regmap_update_bits(ahub->regmap_apbif, reg, mask, val);
 }
 
 static inline void tegra30_audio_write(u32 reg, u32 val)
 {
-	regmap_write(ahub->regmap_ahub, reg, val);
+	regmap_update_bits(ahub->regmap_ahub, reg, ~0, val);
 }
 
 static int tegra30_ahub_runtime_suspend(struct device *dev)
@@ -81,6 +77,12 @@ static int tegra30_ahub_runtime_resume(struct device *dev)
 	regcache_cache_only(ahub->regmap_apbif, false);
 	regcache_cache_only(ahub->regmap_ahub, false);
 
+	/* only does anything if registers were written while suspended */
+	ret = regcache_sync(ahub->regmap_ahub);
+	ret |= regcache_sync(ahub->regmap_apbif);
+	if (ret)
+		dev_err(dev, "failed to restore registers: %d\n", ret);
+
 	return 0;
 }
 
@@ -89,7 +91,7 @@ int tegra30_ahub_allocate_rx_fifo(enum tegra30_ahub_rxcif *rxcif,
 				  dma_addr_t *fiforeg)
 {
 	int channel;
-	u32 reg, val;
+	u32 reg, mask, val;
 	struct tegra30_ahub_cif_conf cif_conf;
 
 	channel = find_first_zero_bit(ahub->rx_usage,
@@ -108,13 +110,12 @@ int tegra30_ahub_allocate_rx_fifo(enum tegra30_ahub_rxcif *rxcif,
 
 	reg = TEGRA30_AHUB_CHANNEL_CTRL +
 	      (channel * TEGRA30_AHUB_CHANNEL_CTRL_STRIDE);
-	val = tegra30_apbif_read(reg);
-	val &= ~(TEGRA30_AHUB_CHANNEL_CTRL_RX_THRESHOLD_MASK |
-		 TEGRA30_AHUB_CHANNEL_CTRL_RX_PACK_MASK);
-	val |= (7 << TEGRA30_AHUB_CHANNEL_CTRL_RX_THRESHOLD_SHIFT) |
-	       TEGRA30_AHUB_CHANNEL_CTRL_RX_PACK_EN |
-	       TEGRA30_AHUB_CHANNEL_CTRL_RX_PACK_16;
-	tegra30_apbif_write(reg, val);
+	mask = TEGRA30_AHUB_CHANNEL_CTRL_RX_THRESHOLD_MASK |
+	       TEGRA30_AHUB_CHANNEL_CTRL_RX_PACK_MASK;
+	val = (7 << TEGRA30_AHUB_CHANNEL_CTRL_RX_THRESHOLD_SHIFT) |
+	      TEGRA30_AHUB_CHANNEL_CTRL_RX_PACK_EN |
+	      TEGRA30_AHUB_CHANNEL_CTRL_RX_PACK_16;
+	tegra30_apbif_update_bits(reg, mask, val);
 
 	cif_conf.threshold = 0;
 	cif_conf.audio_channels = 2;
@@ -141,15 +142,14 @@ EXPORT_SYMBOL_GPL(tegra30_ahub_allocate_rx_fifo);
 int tegra30_ahub_enable_rx_fifo(enum tegra30_ahub_rxcif rxcif)
 {
 	int channel = rxcif - TEGRA30_AHUB_RXCIF_APBIF_RX0;
-	int reg, val;
+	int reg;
 
 	pm_runtime_get_sync(ahub->dev);
 
 	reg = TEGRA30_AHUB_CHANNEL_CTRL +
 	      (channel * TEGRA30_AHUB_CHANNEL_CTRL_STRIDE);
-	val = tegra30_apbif_read(reg);
-	val |= TEGRA30_AHUB_CHANNEL_CTRL_RX_EN;
-	tegra30_apbif_write(reg, val);
+	tegra30_apbif_update_bits(reg, TEGRA30_AHUB_CHANNEL_CTRL_RX_EN,
+				  TEGRA30_AHUB_CHANNEL_CTRL_RX_EN);
 
 	pm_runtime_put(ahub->dev);
 
@@ -160,15 +160,13 @@ EXPORT_SYMBOL_GPL(tegra30_ahub_enable_rx_fifo);
 int tegra30_ahub_disable_rx_fifo(enum tegra30_ahub_rxcif rxcif)
 {
 	int channel = rxcif - TEGRA30_AHUB_RXCIF_APBIF_RX0;
-	int reg, val;
+	int reg;
 
 	pm_runtime_get_sync(ahub->dev);
 
 	reg = TEGRA30_AHUB_CHANNEL_CTRL +
 	      (channel * TEGRA30_AHUB_CHANNEL_CTRL_STRIDE);
-	val = tegra30_apbif_read(reg);
-	val &= ~TEGRA30_AHUB_CHANNEL_CTRL_RX_EN;
-	tegra30_apbif_write(reg, val);
+	tegra30_apbif_update_bits(reg, TEGRA30_AHUB_CHANNEL_CTRL_RX_EN, 0);
 
 	pm_runtime_put(ahub->dev);
 
@@ -191,7 +189,7 @@ int tegra30_ahub_allocate_tx_fifo(enum tegra30_ahub_txcif *txcif,
 				  dma_addr_t *fiforeg)
 {
 	int channel;
-	u32 reg, val;
+	u32 reg, mask, val;
 	struct tegra30_ahub_cif_conf cif_conf;
 
 	channel = find_first_zero_bit(ahub->tx_usage,
@@ -210,13 +208,12 @@ int tegra30_ahub_allocate_tx_fifo(enum tegra30_ahub_txcif *txcif,
 
 	reg = TEGRA30_AHUB_CHANNEL_CTRL +
 	      (channel * TEGRA30_AHUB_CHANNEL_CTRL_STRIDE);
-	val = tegra30_apbif_read(reg);
-	val &= ~(TEGRA30_AHUB_CHANNEL_CTRL_TX_THRESHOLD_MASK |
-		 TEGRA30_AHUB_CHANNEL_CTRL_TX_PACK_MASK);
-	val |= (7 << TEGRA30_AHUB_CHANNEL_CTRL_TX_THRESHOLD_SHIFT) |
-	       TEGRA30_AHUB_CHANNEL_CTRL_TX_PACK_EN |
-	       TEGRA30_AHUB_CHANNEL_CTRL_TX_PACK_16;
-	tegra30_apbif_write(reg, val);
+	mask = TEGRA30_AHUB_CHANNEL_CTRL_TX_THRESHOLD_MASK |
+	       TEGRA30_AHUB_CHANNEL_CTRL_TX_PACK_MASK;
+	val = (7 << TEGRA30_AHUB_CHANNEL_CTRL_TX_THRESHOLD_SHIFT) |
+	      TEGRA30_AHUB_CHANNEL_CTRL_TX_PACK_EN |
+	      TEGRA30_AHUB_CHANNEL_CTRL_TX_PACK_16;
+	tegra30_apbif_update_bits(reg, mask, val);
 
 	cif_conf.threshold = 0;
 	cif_conf.audio_channels = 2;
@@ -243,15 +240,14 @@ EXPORT_SYMBOL_GPL(tegra30_ahub_allocate_tx_fifo);
 int tegra30_ahub_enable_tx_fifo(enum tegra30_ahub_txcif txcif)
 {
 	int channel = txcif - TEGRA30_AHUB_TXCIF_APBIF_TX0;
-	int reg, val;
+	int reg;
 
 	pm_runtime_get_sync(ahub->dev);
 
 	reg = TEGRA30_AHUB_CHANNEL_CTRL +
 	      (channel * TEGRA30_AHUB_CHANNEL_CTRL_STRIDE);
-	val = tegra30_apbif_read(reg);
-	val |= TEGRA30_AHUB_CHANNEL_CTRL_TX_EN;
-	tegra30_apbif_write(reg, val);
+	tegra30_apbif_update_bits(reg, TEGRA30_AHUB_CHANNEL_CTRL_TX_EN,
+				  TEGRA30_AHUB_CHANNEL_CTRL_TX_EN);
 
 	pm_runtime_put(ahub->dev);
 
@@ -262,15 +258,13 @@ EXPORT_SYMBOL_GPL(tegra30_ahub_enable_tx_fifo);
 int tegra30_ahub_disable_tx_fifo(enum tegra30_ahub_txcif txcif)
 {
 	int channel = txcif - TEGRA30_AHUB_TXCIF_APBIF_TX0;
-	int reg, val;
+	int reg;
 
 	pm_runtime_get_sync(ahub->dev);
 
 	reg = TEGRA30_AHUB_CHANNEL_CTRL +
 	      (channel * TEGRA30_AHUB_CHANNEL_CTRL_STRIDE);
-	val = tegra30_apbif_read(reg);
-	val &= ~TEGRA30_AHUB_CHANNEL_CTRL_TX_EN;
-	tegra30_apbif_write(reg, val);
+	tegra30_apbif_update_bits(reg, TEGRA30_AHUB_CHANNEL_CTRL_TX_EN, 0);
 
 	pm_runtime_put(ahub->dev);
 
@@ -698,7 +692,7 @@ void tegra30_ahub_set_cif(struct regmap *regmap, unsigned int reg,
 		(conf->mono_conv <<
 			TEGRA30_AUDIOCIF_CTRL_MONO_CONV_SHIFT);
 
-	regmap_write(regmap, reg, value);
+	regmap_update_bits(regmap, reg, ~0, value);
 }
 EXPORT_SYMBOL_GPL(tegra30_ahub_set_cif);
 
@@ -730,7 +724,7 @@ void tegra124_ahub_set_cif(struct regmap *regmap, unsigned int reg,
 		(conf->mono_conv <<
 			TEGRA30_AUDIOCIF_CTRL_MONO_CONV_SHIFT);
 
-	regmap_write(regmap, reg, value);
+	regmap_update_bits(regmap, reg, ~0, value);
 }
 EXPORT_SYMBOL_GPL(tegra124_ahub_set_cif);
 
@@ -26,6 +26,8 @@
 #include <linux/platform_data/davinci_asp.h>
 #include <linux/math64.h>
 #include <linux/bitmap.h>
+#include <linux/gcd.h>
+#include <linux/lcm.h>
 #include <linux/gpio/driver.h>
 
 #include <sound/asoundef.h>
@@ -72,6 +74,7 @@ struct davinci_mcasp_context {
 struct davinci_mcasp_ruledata {
 	struct davinci_mcasp *mcasp;
 	int serializers;
+	int numevt;
 };
 
 struct davinci_mcasp {
@@ -831,6 +834,35 @@ static int davinci_config_channel_size(struct davinci_mcasp *mcasp,
 	return 0;
 }
 
+/*
+ * Pick the AFIFO threshold of a stream, in words: the largest multiple of
+ * the active serializers, up to the platform numevt, which divides the
+ * period. It is kept to half a period at most so that the FIFO is refilled
+ * at least twice per period, and a whole number of frames per DMA request
+ * is preferred, which keeps many slot TDM streams aligned.
+ */
+static int mcasp_calc_numevt(int numevt, int period_words, int channels,
+			     int active_serializers)
+{
+	int frame_step = lcm(channels, active_serializers);
+	int n;
+
+	if (period_words >= 2 * active_serializers)
+		numevt = min(numevt, period_words / 2);
+
+	numevt = rounddown(numevt, active_serializers);
+
+	for (n = rounddown(numevt, frame_step); n > 0; n -= frame_step)
+		if (!(period_words % n))
+			return n;
+
+	for (n = numevt; n > 0; n -= active_serializers)
+		if (!(period_words % n))
+			return n;
+
+	return active_serializers;
+}
+
 static int mcasp_common_hw_param(struct davinci_mcasp *mcasp, int stream,
 				 int period_words, int channels)
 {
@@ -929,17 +961,9 @@ static int mcasp_common_hw_param(struct davinci_mcasp *mcasp, int stream,
 		return -EINVAL;
 	}
 
-	/*
-	 * Calculate the optimal AFIFO depth for platform side:
-	 * The number of words for numevt need to be in steps of active
-	 * serializers.
-	 */
-	numevt = (numevt / active_serializers) * active_serializers;
-
-	while (period_words % numevt && numevt > 0)
-		numevt -= active_serializers;
-	if (numevt <= 0)
-		numevt = active_serializers;
+	/* Calculate the optimal AFIFO depth for platform side */
+	numevt = mcasp_calc_numevt(numevt, period_words, channels,
+				   active_serializers);
 
 	mcasp_mod_bits(mcasp, reg, active_serializers, NUMDMA_MASK);
 	mcasp_mod_bits(mcasp, reg, NUMEVT(numevt), NUMEVT_MASK);
@@ -1439,14 +1463,34 @@ static int davinci_mcasp_hw_rule_format(struct snd_pcm_hw_params *params,
 static int davinci_mcasp_hw_rule_min_periodsize(
 		struct snd_pcm_hw_params *params, struct snd_pcm_hw_rule *rule)
 {
+	struct davinci_mcasp_ruledata *rd = rule->private;
 	struct snd_interval *period_size = hw_param_interval(params,
 						SNDRV_PCM_HW_PARAM_PERIOD_SIZE);
+	struct snd_interval *channels = hw_param_interval(params,
+						SNDRV_PCM_HW_PARAM_CHANNELS);
 	struct snd_interval frames;
+	int ch, ser, step;
 
 	snd_interval_any(&frames);
 	frames.min = 64;
 	frames.integer = 1;
 
+	/*
+	 * With the AFIFO the period has to be a multiple of the active
+	 * serializers in words, constrain it once the channels are known.
+	 */
+	if (rd->numevt && snd_interval_single(channels)) {
+		ch = snd_interval_value(channels);
+		ser = DIV_ROUND_UP(ch, rd->mcasp->tdm_slots);
+		step = ser / gcd(ser, ch);
+
+		if (step > 1) {
+			frames.min = roundup(max(frames.min, period_size->min),
+					     step);
+			frames.max = rounddown(period_size->max, step);
+		}
+	}
+
 	return snd_interval_refine(period_size, &frames);
 }
 
@@ -1487,6 +1531,7 @@ static int davinci_mcasp_startup(struct snd_pcm_substream *substream,
 	}
 	ruledata->serializers = max_channels;
 	ruledata->mcasp = mcasp;
+	ruledata->numevt = dir == TX_MODE ? mcasp->txnumevt : mcasp->rxnumevt;
 	max_channels *= tdm_slots;
 	/*
 	 * If the already active stream has less channels than the calculated
@@ -1560,8 +1605,9 @@ static int davinci_mcasp_startup(struct snd_pcm_substream *substream,
 
 	snd_pcm_hw_rule_add(substream->runtime, 0,
 			    SNDRV_PCM_HW_PARAM_PERIOD_SIZE,
-			    davinci_mcasp_hw_rule_min_periodsize, NULL,
-			    SNDRV_PCM_HW_PARAM_PERIOD_SIZE, -1);
+			    davinci_mcasp_hw_rule_min_periodsize, ruledata,
+			    SNDRV_PCM_HW_PARAM_PERIOD_SIZE,
+			    SNDRV_PCM_HW_PARAM_CHANNELS, -1);
 
 	return 0;
 }
@@ -5,9 +5,115 @@
 #include <linux/delay.h>
 #include <linux/mod_devicetable.h>
 #include <linux/pm_runtime.h>
+#include <linux/slab.h>
+#include <linux/sort.h>
 #include <dkms/linux/soundwire/sdw_registers.h>
 #include <dkms/linux/soundwire/sdw.h>
 #include "bus.h"
+#include "trace.h"
+
+static void sdw_async_work(struct work_struct *work);
+
+static int sdw_cmp_clk_freq(const void *a, const void *b)
+{
+	unsigned int freq_a = *(const unsigned int *)a;
+	unsigned int freq_b = *(const unsigned int *)b;
+
+	return (freq_a > freq_b) - (freq_a < freq_b);
+}
+
+/*
+ * Add the frame shapes at a given clock frequency, either only the
+ * default frame shape of the Master or all the other ones.
+ */
+static void sdw_add_frame_shapes(struct sdw_bus *bus, unsigned int clk_freq,
+				 bool is_default)
+{
+	struct sdw_master_prop *prop = &bus->prop;
+	struct sdw_frame_shape *shape;
+	int r, c;
+
+	for (c = 0; c < SDW_FRAME_COLS; c++) {
+		for (r = 0; r < SDW_FRAME_ROWS; r++) {
+			/* skip the hole in the row table */
+			if (!sdw_rows[r])
+				continue;
+
+			if (is_default != (sdw_rows[r] == prop->default_row &&
+					   sdw_cols[c] == prop->default_col))
+				continue;
+
+			shape = &bus->frame_shapes[bus->num_frame_shapes++];
+			shape->clk_freq = clk_freq;
+			shape->row = sdw_rows[r];
+			shape->col = sdw_cols[c];
+			shape->bandwidth = clk_freq - (clk_freq /
+				(shape->row * shape->col)) * SDW_FRAME_CTRL_BITS;
+		}
+	}
+}
+
+/*
+ * Build the table of all the clock frequency and frame shape
+ * combinations supported by the Master, so that the bandwidth
+ * allocation only has to walk it in order and pick the first entry
+ * that fits.
+ */
+static int sdw_init_frame_shapes(struct sdw_bus *bus)
+{
+	struct sdw_master_prop *prop = &bus->prop;
+	unsigned int max_dr_freq, *clk_freqs;
+	int i, num_freqs;
+
+	max_dr_freq = prop->max_clk_freq * SDW_DOUBLE_RATE_FACTOR;
+
+	if (prop->num_clk_gears)
+		num_freqs = prop->num_clk_gears;
+	else if (prop->num_clk_freq)
+		num_freqs = prop->num_clk_freq;
+	else
+		num_freqs = 1;
+
+	clk_freqs = kcalloc(num_freqs, sizeof(*clk_freqs), GFP_KERNEL);
+	if (!clk_freqs)
+		return -ENOMEM;
+
+	for (i = 0; i < num_freqs; i++) {
+		if (prop->num_clk_gears)
+			clk_freqs[i] = max_dr_freq >> prop->clk_gears[i];
+		else if (prop->num_clk_freq)
+			clk_freqs[i] = prop->clk_freq[i] *
+				SDW_DOUBLE_RATE_FACTOR;
+		else
+			clk_freqs[i] = max_dr_freq;
+	}
+
+	sort(clk_freqs, num_freqs, sizeof(*clk_freqs), sdw_cmp_clk_freq, NULL);
+
+	bus->frame_shapes = devm_kcalloc(bus->dev,
+					 num_freqs * SDW_FRAME_ROW_COLS,
+					 sizeof(*bus->frame_shapes),
+					 GFP_KERNEL);
+	if (!bus->frame_shapes) {
+		kfree(clk_freqs);
+		return -ENOMEM;
+	}
+
+	bus->num_frame_shapes = 0;
+
+	for (i = 0; i < num_freqs; i++) {
+		if (!clk_freqs[i] || (i && clk_freqs[i] == clk_freqs[i - 1]))
+			continue;
+
+		/* the default frame shape goes first, then all the others */
+		sdw_add_frame_shapes(bus, clk_freqs[i], true);
+		sdw_add_frame_shapes(bus, clk_freqs[i], false);
+	}
+
+	kfree(clk_freqs);
+
+	return 0;
+}
 
 /**
  * sdw_add_bus_master() - add a bus Master instance
@@ -19,7 +125,7 @@
 int sdw_add_bus_master(struct sdw_bus *bus)
 {
 	struct sdw_master_prop *prop = NULL;
-	int ret;
+	int ret, i;
 
 	if (!bus->dev) {
 		pr_err("SoundWire bus has no device\n");
@@ -39,9 +145,25 @@ int sdw_add_bus_master(struct sdw_bus *bus)
 
 	mutex_init(&bus->msg_lock);
 	mutex_init(&bus->bus_lock);
+	mutex_init(&bus->slave_lock);
 	INIT_LIST_HEAD(&bus->slaves);
 	INIT_LIST_HEAD(&bus->m_rt_list);
 
+	for (i = 0; i <= SDW_MAX_DEVICES; i++)
+		bus->page_cache[i] = SDW_PAGE_INVALID;
+
+	INIT_LIST_HEAD(&bus->async_list);
+	spin_lock_init(&bus->async_lock);
+	INIT_WORK(&bus->async_work, sdw_async_work);
+
+	sdw_rt_pool_init(bus);
+
+	bus->bank_switch_msg = devm_kzalloc(bus->dev,
+					    sizeof(*bus->bank_switch_msg),
+					    GFP_KERNEL);
+	if (!bus->bank_switch_msg)
+		return -ENOMEM;
+
 	/*
 	 * Initialize multi_link flag
 	 * TODO: populate this flag by reading property from FW node
@@ -56,6 +178,13 @@ int sdw_add_bus_master(struct sdw_bus *bus)
 		}
 	}
 
+	ret = sdw_init_frame_shapes(bus);
+	if (ret < 0) {
+		dev_err(bus->dev, "Frame shape table init failed:%d\n", ret);
+		return ret;
+	}
+	bus->bw_cache.valid = false;
+
 	sdw_bus_debugfs_init(bus);
 
 	/*
@@ -84,7 +213,9 @@ int sdw_add_bus_master(struct sdw_bus *bus)
 	 * Create Slave devices based on Slaves described in
 	 * the respective firmware (ACPI/DT)
 	 */
-	if (IS_ENABLED(CONFIG_ACPI) && ACPI_HANDLE(bus->dev))
+	if (bus->no_fw_slaves)
+		ret = 0; /* Slaves are added by the Master driver */
+	else if (IS_ENABLED(CONFIG_ACPI) && ACPI_HANDLE(bus->dev))
 		ret = sdw_acpi_find_slaves(bus);
 	else if (IS_ENABLED(CONFIG_OF) && bus->dev->of_node)
 		ret = sdw_of_find_slaves(bus);
@@ -124,13 +255,13 @@ static int sdw_delete_slave(struct device *dev, void *data)
 
 	sdw_slave_debugfs_exit(slave);
 
-	mutex_lock(&bus->bus_lock);
+	mutex_lock(&bus->slave_lock);
 
 	if (slave->dev_num) /* clear dev_num if assigned */
 		clear_bit(slave->dev_num, bus->assigned);
 
 	list_del_init(&slave->node);
-	mutex_unlock(&bus->bus_lock);
+	mutex_unlock(&bus->slave_lock);
 
 	device_unregister(dev);
 	return 0;
@@ -144,8 +275,12 @@ static int sdw_delete_slave(struct device *dev, void *data)
  */
 void sdw_delete_bus_master(struct sdw_bus *bus)
 {
+	flush_work(&bus->async_work);
+
 	device_for_each_child(bus->dev, NULL, sdw_delete_slave);
 
+	sdw_rt_pool_release(bus);
+
 	sdw_bus_debugfs_exit(bus);
 }
 EXPORT_SYMBOL(sdw_delete_bus_master);
@@ -171,6 +306,37 @@ static inline int find_response_code(enum sdw_command_response resp)
 	}
 }
 
+/* account for the response to @num commands, called with msg_lock held */
+static void sdw_bus_stats_resp(struct sdw_bus *bus,
+			       enum sdw_command_response resp,
+			       int num, bool retry)
+{
+	struct sdw_bus_stats *stats = &bus->stats;
+
+	stats->cmds += num;
+	if (retry)
+		stats->retries += num;
+
+	if (resp == SDW_CMD_IGNORED)
+		stats->ignored++;
+	else if (resp != SDW_CMD_OK)
+		stats->failed++;
+}
+
+void sdw_bus_stats_bank_switch(struct sdw_bus *bus, u64 latency_us)
+{
+	struct sdw_bus_stats *stats = &bus->stats;
+	int i;
+
+	for (i = 0; i < SDW_BANK_SWITCH_HIST - 1; i++) {
+		if (latency_us < (100ULL << i))
+			break;
+	}
+
+	stats->bank_switches++;
+	stats->bank_switch_hist[i]++;
+}
+
 static inline int do_transfer(struct sdw_bus *bus, struct sdw_msg *msg)
 {
 	int retry = bus->prop.err_threshold;
@@ -179,6 +345,7 @@ static inline int do_transfer(struct sdw_bus *bus, struct sdw_msg *msg)
 
 	for (i = 0; i <= retry; i++) {
 		resp = bus->ops->xfer_msg(bus, msg);
+		sdw_bus_stats_resp(bus, resp, 1, i);
 		ret = find_response_code(resp);
 
 		/* if cmd is ok or ignored return */
@@ -203,6 +370,7 @@ static inline int do_transfer_defer(struct sdw_bus *bus,
 
 	for (i = 0; i <= retry; i++) {
 		resp = bus->ops->xfer_msg_defer(bus, msg, defer);
+		sdw_bus_stats_resp(bus, resp, 1, i);
 		ret = find_response_code(resp);
 		/* if cmd is ok or ignored return */
 		if (ret == 0 || ret == -ENODATA)
@@ -212,6 +380,37 @@ static inline int do_transfer_defer(struct sdw_bus *bus,
 	return ret;
 }
 
+/*
+ * SCP_AddrPage cache, protected by msg_lock. Paged addresses never use
+ * page 0, which is what the page registers hold after a reset.
+ */
+static inline int sdw_msg_page(struct sdw_msg *msg)
+{
+	return msg->addr_page2 << 8 | msg->addr_page1;
+}
+
+static inline int sdw_get_page_cache(struct sdw_bus *bus, u16 dev_num)
+{
+	if (dev_num > SDW_MAX_DEVICES)
+		return SDW_PAGE_INVALID;
+
+	return bus->page_cache[dev_num];
+}
+
+static inline void sdw_set_page_cache(struct sdw_bus *bus, u16 dev_num,
+				      int page)
+{
+	if (dev_num <= SDW_MAX_DEVICES)
+		bus->page_cache[dev_num] = page;
+}
+
+static void sdw_invalidate_page_cache(struct sdw_bus *bus, u16 dev_num)
+{
+	mutex_lock(&bus->msg_lock);
+	sdw_set_page_cache(bus, dev_num, SDW_PAGE_INVALID);
+	mutex_unlock(&bus->msg_lock);
+}
+
 static int sdw_reset_page(struct sdw_bus *bus, u16 dev_num)
 {
 	int retry = bus->prop.err_threshold;
@@ -220,12 +419,57 @@ static int sdw_reset_page(struct sdw_bus *bus, u16 dev_num)
 
 	for (i = 0; i <= retry; i++) {
 		resp = bus->ops->reset_page_addr(bus, dev_num);
+		sdw_bus_stats_resp(bus, resp, 1, i);
 		ret = find_response_code(resp);
 		/* if cmd is ok or ignored return */
 		if (ret == 0 || ret == -ENODATA)
-			return ret;
+			break;
 	}
 
+	bus->stats.page_resets++;
+	sdw_set_page_cache(bus, dev_num, ret ? SDW_PAGE_INVALID : 0);
+
+	return ret;
+}
+
+/*
+ * Restore SCP_AddrPage state after a paged message, called with
+ * msg_lock held. Sticky-page Slaves keep the page programmed so that
+ * further accesses to the same page don't need to program it again.
+ */
+static void sdw_page_done(struct sdw_bus *bus, struct sdw_msg *msg, int ret)
+{
+	if (!ret) {
+		sdw_set_page_cache(bus, msg->dev_num, sdw_msg_page(msg));
+		if (msg->sticky_page)
+			return;
+	}
+
+	sdw_reset_page(bus, msg->dev_num);
+}
+
+/* called with msg_lock held */
+static int _sdw_transfer(struct sdw_bus *bus, struct sdw_msg *msg)
+{
+	bool page = msg->page;
+	int ret;
+
+	/* skip SCP_AddrPage programming if the page is already set */
+	if (page && sdw_get_page_cache(bus, msg->dev_num) == sdw_msg_page(msg))
+		msg->page = false;
+
+	trace_sdw_transfer(bus, msg);
+	ret = do_transfer(bus, msg);
+	trace_sdw_transfer_done(bus, msg, ret);
+	if (ret != 0 && ret != -ENODATA)
+		dev_err(bus->dev, "trf on Slave %d failed:%d\n",
+			msg->dev_num, ret);
+
+	msg->page = page;
+
+	if (page)
+		sdw_page_done(bus, msg, ret);
+
 	return ret;
 }
 
@@ -240,14 +484,128 @@ int sdw_transfer(struct sdw_bus *bus, struct sdw_msg *msg)
 
 	mutex_lock(&bus->msg_lock);
 
-	ret = do_transfer(bus, msg);
-	if (ret != 0 && ret != -ENODATA)
-		dev_err(bus->dev, "trf on Slave %d failed:%d\n",
-			msg->dev_num, ret);
+	ret = _sdw_transfer(bus, msg);
 
-	if (msg->page)
-		sdw_reset_page(bus, msg->dev_num);
+	mutex_unlock(&bus->msg_lock);
+
+	return ret;
+}
+
+/*
+ * Clear the page flag of batched messages whose page is already
+ * programmed, either by the cache or by a previous message of the same
+ * batch. Paged messages never use page 0, so the flag can be restored
+ * from the page value. Returns the mask of devices with paged messages.
+ */
+static u32 sdw_batch_plan_pages(struct sdw_bus *bus, struct sdw_msg *msgs,
+				int num, int *page, bool use_cache)
+{
+	struct sdw_msg *msg;
+	u32 mask = 0;
+	int i, p;
+
+	for (i = 0; i <= SDW_MAX_DEVICES; i++)
+		page[i] = use_cache ? bus->page_cache[i] : SDW_PAGE_INVALID;
+
+	for (i = 0; i < num; i++) {
+		msg = &msgs[i];
+		p = sdw_msg_page(msg);
+		msg->page = p != 0;
 
+		if (!msg->page || msg->dev_num > SDW_MAX_DEVICES)
+			continue;
+
+		if (page[msg->dev_num] == p)
+			msg->page = false;
+
+		page[msg->dev_num] = p;
+		mask |= BIT(msg->dev_num);
+	}
+
+	return mask;
+}
+
+static int sdw_transfer_batch_paged(struct sdw_bus *bus,
+				    struct sdw_msg *msgs, int num)
+{
+	int retry = bus->prop.err_threshold;
+	int page[SDW_MAX_DEVICES + 1];
+	enum sdw_command_response resp;
+	u32 paged, reset = 0;
+	int ret = 0, i;
+
+	for (i = 0; i <= retry; i++) {
+		/* a failed attempt leaves the page registers unknown */
+		paged = sdw_batch_plan_pages(bus, msgs, num, page, !i);
+
+		resp = bus->ops->xfer_msg_batch(bus, msgs, num);
+		sdw_bus_stats_resp(bus, resp, num, i);
+		ret = find_response_code(resp);
+
+		/* if cmd is ok or ignored return */
+		if (ret == 0 || ret == -ENODATA)
+			break;
+	}
+
+	/* restore the page flags cleared by the planning */
+	for (i = 0; i < num; i++)
+		msgs[i].page = sdw_msg_page(&msgs[i]) != 0;
+
+	for (i = 0; i < num; i++) {
+		if (ret || (msgs[i].page && !msgs[i].sticky_page))
+			reset |= BIT(msgs[i].dev_num) & paged;
+	}
+
+	for (i = 0; i <= SDW_MAX_DEVICES; i++) {
+		if (!(paged & BIT(i)))
+			continue;
+
+		sdw_set_page_cache(bus, i, ret ? SDW_PAGE_INVALID : page[i]);
+
+		if (reset & BIT(i))
+			sdw_reset_page(bus, i);
+	}
+
+	return ret;
+}
+
+/**
+ * sdw_transfer_batch() - Synchronous transfer of an array of messages
+ * @bus: SDW bus
+ * @msgs: SDW messages to be xfered, possibly for different Slaves
+ * @num: number of messages
+ *
+ * Masters implementing xfer_msg_batch send all messages with a minimal
+ * number of completion waits, otherwise the messages are sent one by
+ * one. Returns -ENODATA if any message was ignored.
+ */
+int sdw_transfer_batch(struct sdw_bus *bus, struct sdw_msg *msgs, int num)
+{
+	bool ignored = false;
+	int ret = 0, i;
+
+	mutex_lock(&bus->msg_lock);
+
+	if (bus->ops->xfer_msg_batch) {
+		ret = sdw_transfer_batch_paged(bus, msgs, num);
+		if (ret != 0 && ret != -ENODATA)
+			dev_err(bus->dev, "batch trf of %d msgs failed:%d\n",
+				num, ret);
+		goto unlock;
+	}
+
+	for (i = 0; i < num; i++) {
+		ret = _sdw_transfer(bus, &msgs[i]);
+		if (ret == -ENODATA)
+			ignored = true;
+		else if (ret)
+			goto unlock;
+	}
+
+	if (ignored)
+		ret = -ENODATA;
+
+unlock:
 	mutex_unlock(&bus->msg_lock);
 
 	return ret;
@@ -269,7 +627,9 @@ int sdw_transfer_defer(struct sdw_bus *bus, struct sdw_msg *msg,
 	if (!bus->ops->xfer_msg_defer)
 		return -ENOTSUPP;
 
+	trace_sdw_transfer_defer(bus, msg);
 	ret = do_transfer_defer(bus, msg, defer);
+	trace_sdw_transfer_done(bus, msg, ret);
 	if (ret != 0 && ret != -ENODATA)
 		dev_err(bus->dev, "Defer trf on Slave %d failed:%d\n",
 			msg->dev_num, ret);
@@ -322,6 +682,7 @@ int sdw_fill_msg(struct sdw_msg *msg, struct sdw_slave *slave,
 	msg->addr_page2 = (addr >> SDW_REG_SHIFT(SDW_SCP_ADDRPAGE2_MASK));
 	msg->addr |= BIT(15);
 	msg->page = true;
+	msg->sticky_page = slave->prop.sticky_page;
 
 	return 0;
 }
@@ -412,6 +773,76 @@ sdw_read_no_pm(struct sdw_slave *slave, u32 addr)
 		return buf;
 }
 
+static bool sdw_bpt_possible(struct sdw_slave *slave, size_t count)
+{
+	struct sdw_bus *bus = slave->bus;
+
+	if (count < SDW_BPT_MIN_LEN || !bus->ops->bpt_xfer)
+		return false;
+
+	/* BRA packets are handled by the Slave Data Port 0 */
+	if (!slave->prop.dp0_prop || slave->status != SDW_SLAVE_ATTACHED)
+		return false;
+
+	/*
+	 * The BPT stream is prepared with bus_lock held, use the command
+	 * path rather than waiting in case the caller holds it already,
+	 * e.g. when called from a port_prep callback
+	 */
+	return !mutex_is_locked(&bus->bus_lock);
+}
+
+static int sdw_bpt_xfer_no_pm(struct sdw_slave *slave, u32 addr,
+			      size_t count, u8 *val, u8 flags)
+{
+	struct sdw_bpt_msg msg = {
+		.addr = addr,
+		.len = count,
+		.dev_num = slave->dev_num,
+		.flags = flags,
+		.buf = val,
+	};
+	int ret;
+
+	ret = slave->bus->ops->bpt_xfer(slave->bus, slave, &msg);
+	if (ret < 0 && ret != -EOPNOTSUPP)
+		dev_dbg(&slave->dev, "BPT transfer failed: %d\n", ret);
+
+	return ret;
+}
+
+/**
+ * sdw_bpt_xfer() - Transfer registers with Bulk Payload Transport
+ * @slave: SDW Slave
+ * @msg: BPT message, dev_num is set by the bus
+ *
+ * Return -EOPNOTSUPP if either the Master or the Slave can't handle
+ * BPT, callers may then use sdw_nread()/sdw_nwrite(). Those use BPT
+ * automatically for transfers of at least SDW_BPT_MIN_LEN registers.
+ */
+int sdw_bpt_xfer(struct sdw_slave *slave, struct sdw_bpt_msg *msg)
+{
+	int ret;
+
+	if (!slave->bus->ops->bpt_xfer || !slave->prop.dp0_prop)
+		return -EOPNOTSUPP;
+
+	ret = pm_runtime_get_sync(slave->bus->dev);
+	if (ret < 0 && ret != -EACCES) {
+		pm_runtime_put_noidle(slave->bus->dev);
+		return ret;
+	}
+
+	msg->dev_num = slave->dev_num;
+	ret = slave->bus->ops->bpt_xfer(slave->bus, slave, msg);
+
+	pm_runtime_mark_last_busy(slave->bus->dev);
+	pm_runtime_put(slave->bus->dev);
+
+	return ret;
+}
+EXPORT_SYMBOL(sdw_bpt_xfer);
+
 /**
  * sdw_nread() - Read "n" contiguous SDW Slave registers
  * @slave: SDW Slave
@@ -429,7 +860,14 @@ int sdw_nread(struct sdw_slave *slave, u32 addr, size_t count, u8 *val)
 		return ret;
 	}
 
-	ret = sdw_nread_no_pm(slave, addr, count, val);
+	ret = -EOPNOTSUPP;
+	if (sdw_bpt_possible(slave, count))
+		ret = sdw_bpt_xfer_no_pm(slave, addr, count, val,
+					 SDW_MSG_FLAG_READ);
+
+	/* the command path is always available */
+	if (ret < 0)
+		ret = sdw_nread_no_pm(slave, addr, count, val);
 
 	pm_runtime_mark_last_busy(slave->bus->dev);
 	pm_runtime_put(slave->bus->dev);
@@ -455,7 +893,14 @@ int sdw_nwrite(struct sdw_slave *slave, u32 addr, size_t count, u8 *val)
 		return ret;
 	}
 
-	ret = sdw_nwrite_no_pm(slave, addr, count, val);
+	ret = -EOPNOTSUPP;
+	if (sdw_bpt_possible(slave, count))
+		ret = sdw_bpt_xfer_no_pm(slave, addr, count, val,
+					 SDW_MSG_FLAG_WRITE);
+
+	/* the command path is always available */
+	if (ret < 0)
+		ret = sdw_nwrite_no_pm(slave, addr, count, val);
 
 	pm_runtime_mark_last_busy(slave->bus->dev);
 	pm_runtime_put(slave->bus->dev);
@@ -464,6 +909,363 @@ int sdw_nwrite(struct sdw_slave *slave, u32 addr, size_t count, u8 *val)
 }
 EXPORT_SYMBOL(sdw_nwrite);
 
+#define SDW_XFER_BATCH_ONSTACK	4
+
+static int sdw_xfer_batch_no_pm(struct sdw_slave *slave,
+				struct sdw_slave_xfer *xfers, int num)
+{
+	struct sdw_msg onstack[SDW_XFER_BATCH_ONSTACK];
+	struct sdw_msg *msgs = onstack;
+	int ret = 0, i;
+
+	if (num > ARRAY_SIZE(onstack)) {
+		msgs = kcalloc(num, sizeof(*msgs), GFP_KERNEL);
+		if (!msgs)
+			return -ENOMEM;
+	}
+
+	for (i = 0; i < num; i++) {
+		ret = sdw_fill_msg(&msgs[i], slave, xfers[i].addr,
+				   xfers[i].count, slave->dev_num,
+				   xfers[i].read ? SDW_MSG_FLAG_READ :
+				   SDW_MSG_FLAG_WRITE, xfers[i].buf);
+		if (ret < 0)
+			goto out;
+	}
+
+	ret = sdw_transfer_batch(slave->bus, msgs, num);
+
+out:
+	if (msgs != onstack)
+		kfree(msgs);
+
+	return ret;
+}
+
+/**
+ * sdw_xfer_batch() - Batched accesses to a SDW Slave
+ * @slave: SDW Slave
+ * @xfers: array of contiguous register accesses, performed in order
+ * @num: number of entries in @xfers
+ *
+ * The accesses are sent as a single batch, which Masters implementing
+ * xfer_msg_batch handle with a minimal number of command round-trips.
+ */
+int sdw_xfer_batch(struct sdw_slave *slave, struct sdw_slave_xfer *xfers,
+		   int num)
+{
+	int ret;
+
+	ret = pm_runtime_get_sync(slave->bus->dev);
+	if (ret < 0 && ret != -EACCES) {
+		pm_runtime_put_noidle(slave->bus->dev);
+		return ret;
+	}
+
+	ret = sdw_xfer_batch_no_pm(slave, xfers, num);
+
+	pm_runtime_mark_last_busy(slave->bus->dev);
+	pm_runtime_put(slave->bus->dev);
+
+	return ret;
+}
+EXPORT_SYMBOL(sdw_xfer_batch);
+
+/* true if the members of a group are all the Slaves attached to its bus */
+static bool sdw_group_is_bus(struct sdw_slave **slaves, int num)
+{
+	struct sdw_bus *bus = slaves[0]->bus;
+	struct sdw_slave *slave;
+	int attached = 0;
+
+	list_for_each_entry(slave, &bus->slaves, node) {
+		if (slave->dev_num && slave->status == SDW_SLAVE_ATTACHED)
+			attached++;
+	}
+
+	return attached == num;
+}
+
+/*
+ * Broadcast commands can't program the per-Slave paging registers, they
+ * can only reach the optional paging area if no Slave implements paging
+ */
+static bool sdw_group_needs_page(struct sdw_slave **slaves, int num,
+				 u32 addr)
+{
+	int i;
+
+	if (addr < SDW_REG_NO_PAGE)
+		return false;
+	if (addr >= SDW_REG_OPTIONAL_PAGE)
+		return true;
+
+	for (i = 0; i < num; i++) {
+		if (slaves[i]->prop.paging_support)
+			return true;
+	}
+
+	return false;
+}
+
+static int sdw_group_verify(struct sdw_slave **slaves, int num,
+			    struct sdw_slave_xfer *xfers, int num_xfers)
+{
+	struct sdw_slave_xfer *reads;
+	size_t len = 0;
+	u8 *buf;
+	int ret = 0, i, j;
+
+	for (j = 0; j < num_xfers; j++)
+		len += xfers[j].count;
+
+	reads = kcalloc(num_xfers, sizeof(*reads), GFP_KERNEL);
+	buf = kmalloc(len, GFP_KERNEL);
+	if (!reads || !buf) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	for (j = 0, len = 0; j < num_xfers; j++) {
+		reads[j].addr = xfers[j].addr;
+		reads[j].count = xfers[j].count;
+		reads[j].buf = buf + len;
+		reads[j].read = true;
+		len += xfers[j].count;
+	}
+
+	for (i = 0; i < num; i++) {
+		ret = sdw_xfer_batch_no_pm(slaves[i], reads, num_xfers);
+		if (ret < 0)
+			goto out;
+
+		for (j = 0; j < num_xfers; j++) {
+			if (memcmp(reads[j].buf, xfers[j].buf, xfers[j].count)) {
+				dev_err(&slaves[i]->dev,
+					"group write of %zu regs at %#x not applied\n",
+					xfers[j].count, xfers[j].addr);
+				ret = -EIO;
+				goto out;
+			}
+		}
+	}
+
+out:
+	kfree(buf);
+	kfree(reads);
+
+	return ret;
+}
+
+static int sdw_group_write_no_pm(struct sdw_slave **slaves, int num,
+				 struct sdw_slave_xfer *xfers, int num_xfers)
+{
+	struct sdw_bus *bus = slaves[0]->bus;
+	bool broadcast = sdw_group_is_bus(slaves, num);
+	struct sdw_msg *msgs;
+	int ret = 0, i, j, n = 0;
+
+	for (j = 0; broadcast && j < num_xfers; j++) {
+		if (sdw_group_needs_page(slaves, num, xfers[j].addr))
+			broadcast = false;
+	}
+
+	if (broadcast)
+		num = 1;
+
+	msgs = kcalloc(num * num_xfers, sizeof(*msgs), GFP_KERNEL);
+	if (!msgs)
+		return -ENOMEM;
+
+	/* a broadcast is sent once, otherwise each Slave is written in turn */
+	for (i = 0; i < num; i++) {
+		for (j = 0; j < num_xfers; j++) {
+			ret = sdw_fill_msg(&msgs[n++], slaves[i],
+					   xfers[j].addr, xfers[j].count,
+					   broadcast ? SDW_BROADCAST_DEV_NUM :
+					   slaves[i]->dev_num,
+					   SDW_MSG_FLAG_WRITE, xfers[j].buf);
+			if (ret < 0)
+				goto out;
+		}
+	}
+
+	ret = sdw_transfer_batch(bus, msgs, n);
+
+out:
+	kfree(msgs);
+
+	return ret;
+}
+
+/**
+ * sdw_group_write() - Write the same registers on a group of SDW Slaves
+ * @slaves: Slaves of the group, all on the same bus
+ * @num: number of entries in @slaves
+ * @xfers: array of contiguous register writes, performed in order
+ * @num_xfers: number of entries in @xfers
+ * @verify: read the registers back from each Slave of the group
+ *
+ * This is meant for identical devices, e.g. amplifiers, sharing the same
+ * initialization tables. When the group is made of all the Slaves
+ * attached to the bus and none of the registers needs paging, each write
+ * is sent once as a broadcast command. Otherwise the writes to all the
+ * Slaves are sent as a single batch.
+ *
+ * A broadcast command is acknowledged if any of the Slaves responds, use
+ * @verify to check that each of them applied the values. -EIO is then
+ * returned on mismatch.
+ */
+int sdw_group_write(struct sdw_slave **slaves, int num,
+		    struct sdw_slave_xfer *xfers, int num_xfers, bool verify)
+{
+	struct sdw_bus *bus;
+	int ret, i, j;
+
+	if (!num || !num_xfers)
+		return -EINVAL;
+
+	bus = slaves[0]->bus;
+
+	for (i = 0; i < num; i++) {
+		if (slaves[i]->bus != bus || !slaves[i]->dev_num ||
+		    slaves[i]->status != SDW_SLAVE_ATTACHED)
+			return -EINVAL;
+
+		for (j = 0; j < i; j++) {
+			if (slaves[j] == slaves[i])
+				return -EINVAL;
+		}
+	}
+
+	for (j = 0; j < num_xfers; j++) {
+		if (xfers[j].read)
+			return -EINVAL;
+	}
+
+	ret = pm_runtime_get_sync(bus->dev);
+	if (ret < 0 && ret != -EACCES) {
+		pm_runtime_put_noidle(bus->dev);
+		return ret;
+	}
+
+	ret = sdw_group_write_no_pm(slaves, num, xfers, num_xfers);
+	if (!ret && verify)
+		ret = sdw_group_verify(slaves, num, xfers, num_xfers);
+
+	pm_runtime_mark_last_busy(bus->dev);
+	pm_runtime_put(bus->dev);
+
+	return ret;
+}
+EXPORT_SYMBOL(sdw_group_write);
+
+/*
+ * Asynchronous transfers are queued on the bus and sent from a work
+ * item in batches of up to SDW_ASYNC_BATCH accesses, so that callers
+ * don't block on each command round-trip.
+ */
+#define SDW_ASYNC_BATCH		8
+
+static void sdw_async_work(struct work_struct *work)
+{
+	struct sdw_bus *bus = container_of(work, struct sdw_bus, async_work);
+	struct sdw_async_xfer *batch[SDW_ASYNC_BATCH];
+	struct sdw_msg msgs[SDW_ASYNC_BATCH];
+	struct sdw_async_xfer *async;
+	unsigned long flags;
+	int pm_ret, ret, num, i;
+
+	pm_ret = pm_runtime_get_sync(bus->dev);
+	if (pm_ret < 0 && pm_ret != -EACCES) {
+		pm_runtime_put_noidle(bus->dev);
+		dev_err(bus->dev, "async trf pm_runtime_get failed:%d\n",
+			pm_ret);
+	} else {
+		pm_ret = 0;
+	}
+
+	for (;;) {
+		num = 0;
+
+		spin_lock_irqsave(&bus->async_lock, flags);
+		while (num < SDW_ASYNC_BATCH && !list_empty(&bus->async_list)) {
+			async = list_first_entry(&bus->async_list,
+						 struct sdw_async_xfer, node);
+			list_del_init(&async->node);
+			batch[num++] = async;
+		}
+		spin_unlock_irqrestore(&bus->async_lock, flags);
+
+		if (!num)
+			break;
+
+		ret = pm_ret;
+		for (i = 0; !ret && i < num; i++) {
+			async = batch[i];
+			ret = sdw_fill_msg(&msgs[i], async->slave,
+					   async->xfer.addr, async->xfer.count,
+					   async->slave->dev_num,
+					   async->xfer.read ? SDW_MSG_FLAG_READ :
+					   SDW_MSG_FLAG_WRITE, async->xfer.buf);
+		}
+
+		if (!ret)
+			ret = sdw_transfer_batch(bus, msgs, num);
+
+		/* the batch status is reported to each of its accesses */
+		for (i = 0; i < num; i++)
+			batch[i]->complete(batch[i], ret);
+	}
+
+	if (pm_ret)
+		return;
+
+	pm_runtime_mark_last_busy(bus->dev);
+	pm_runtime_put(bus->dev);
+}
+
+/**
+ * sdw_xfer_async() - Queue an asynchronous access to a SDW Slave
+ * @slave: SDW Slave
+ * @async: access descriptor, owned by the bus until @async->complete
+ * is called
+ *
+ * Accesses are performed in submission order. This can be called from
+ * atomic context.
+ */
+int sdw_xfer_async(struct sdw_slave *slave, struct sdw_async_xfer *async)
+{
+	struct sdw_bus *bus = slave->bus;
+	unsigned long flags;
+
+	if (!async->complete || !async->xfer.count)
+		return -EINVAL;
+
+	async->slave = slave;
+
+	spin_lock_irqsave(&bus->async_lock, flags);
+	list_add_tail(&async->node, &bus->async_list);
+	spin_unlock_irqrestore(&bus->async_lock, flags);
+
+	schedule_work(&bus->async_work);
+
+	return 0;
+}
+EXPORT_SYMBOL(sdw_xfer_async);
+
+/**
+ * sdw_xfer_async_flush() - Wait for queued asynchronous accesses
+ * @slave: SDW Slave
+ *
+ * Waits until all accesses queued on the bus of @slave are completed.
+ */
+void sdw_xfer_async_flush(struct sdw_slave *slave)
+{
+	flush_work(&slave->bus->async_work);
+}
+EXPORT_SYMBOL(sdw_xfer_async_flush);
+
 /**
  * sdw_read() - Read a SDW Slave register
  * @slave: SDW Slave
@@ -498,7 +1300,7 @@ EXPORT_SYMBOL(sdw_write);
  * SDW alert handling
  */
 
-/* called with bus_lock held */
+/* called with slave_lock held */
 static struct sdw_slave *sdw_get_slave(struct sdw_bus *bus, int i)
 {
 	struct sdw_slave *slave = NULL;
@@ -523,7 +1325,7 @@ static int sdw_compare_devid(struct sdw_slave *slave, struct sdw_slave_id id)
 	return 0;
 }
 
-/* called with bus_lock held */
+/* called with slave_lock held */
 static int sdw_get_device_num(struct sdw_slave *slave)
 {
 	int bit;
@@ -552,9 +1354,9 @@ static int sdw_assign_device_num(struct sdw_slave *slave)
 	/* check first if device number is assigned, if so reuse that */
 	if (!slave->dev_num) {
 		if (!slave->dev_num_sticky) {
-			mutex_lock(&slave->bus->bus_lock);
+			mutex_lock(&slave->bus->slave_lock);
 			dev_num = sdw_get_device_num(slave);
-			mutex_unlock(&slave->bus->bus_lock);
+			mutex_unlock(&slave->bus->slave_lock);
 			if (dev_num < 0) {
 				dev_err(slave->bus->dev, "Get dev_num failed: %d\n",
 					dev_num);
@@ -577,6 +1379,9 @@ static int sdw_assign_device_num(struct sdw_slave *slave)
 	dev_num = slave->dev_num;
 	slave->dev_num = 0;
 
+	/* a newly enumerated Slave has its page registers reset */
+	sdw_invalidate_page_cache(slave->bus, dev_num);
+
 	ret = sdw_write_no_pm(slave, SDW_SCP_DEVNUMBER, dev_num);
 	if (ret < 0) {
 		dev_err(&slave->dev, "Program device_num %d failed: %d\n",
@@ -689,7 +1494,7 @@ static int sdw_program_device_num(struct sdw_bus *bus)
 static void sdw_modify_slave_status(struct sdw_slave *slave,
 				    enum sdw_slave_status status)
 {
-	mutex_lock(&slave->bus->bus_lock);
+	mutex_lock(&slave->bus->slave_lock);
 
 	dev_vdbg(&slave->dev,
 		 "%s: changing status slave %d status %d new status %d\n",
@@ -703,6 +1508,12 @@ static void sdw_modify_slave_status(struct sdw_slave *slave,
 		init_completion(&slave->enumeration_complete);
 		init_completion(&slave->initialization_complete);
 
+		sdw_invalidate_page_cache(slave->bus, slave->dev_num);
+
+		/* the Slave will be initialized again */
+		slave->bus->slave_ctx_retained = false;
+		sdw_bus_ctx_lost(slave->bus);
+
 	} else if ((status == SDW_SLAVE_ATTACHED) &&
 		   (slave->status == SDW_SLAVE_UNATTACHED)) {
 		dev_dbg(&slave->dev,
@@ -712,7 +1523,7 @@ static void sdw_modify_slave_status(struct sdw_slave *slave,
 		complete(&slave->enumeration_complete);
 	}
 	slave->status = status;
-	mutex_unlock(&slave->bus->bus_lock);
+	mutex_unlock(&slave->bus->slave_lock);
 }
 
 static enum sdw_clk_stop_mode sdw_get_clk_stop_mode(struct sdw_slave *slave)
@@ -810,6 +1621,95 @@ static int sdw_bus_wait_for_clk_prep_deprep(struct sdw_bus *bus, u16 dev_num)
 	return -ETIMEDOUT;
 }
 
+/*
+ * Registers a Slave doesn't retain in Clock Stop Mode 0 are saved before
+ * stopping the clock and restored on exit, in one batch each way
+ */
+static int sdw_slave_clk_stop_ctx(struct sdw_slave *slave, bool save)
+{
+	u32 num = slave->prop.num_clk_stop_lost_regs;
+	struct sdw_slave_xfer *xfers;
+	int ret, i;
+
+	if (!num)
+		return 0;
+
+	if (!slave->clk_stop_ctx) {
+		if (!save)
+			return 0;
+
+		slave->clk_stop_ctx = devm_kzalloc(&slave->dev, num,
+						   GFP_KERNEL);
+		if (!slave->clk_stop_ctx)
+			return -ENOMEM;
+	}
+
+	xfers = kcalloc(num, sizeof(*xfers), GFP_KERNEL);
+	if (!xfers)
+		return -ENOMEM;
+
+	for (i = 0; i < num; i++) {
+		xfers[i].addr = slave->prop.clk_stop_lost_regs[i];
+		xfers[i].count = 1;
+		xfers[i].buf = &slave->clk_stop_ctx[i];
+		xfers[i].read = save;
+	}
+
+	ret = sdw_xfer_batch_no_pm(slave, xfers, num);
+	if (ret < 0)
+		dev_err(&slave->dev, "Clock Stop context %s failed: %d\n",
+			save ? "save" : "restore", ret);
+
+	kfree(xfers);
+
+	return ret;
+}
+
+/**
+ * sdw_bus_clk_stop_retains_ctx: check if the Slaves keep their context
+ *
+ * @bus: SDW bus instance
+ *
+ * Return true if all the Slaves attached when the clock was stopped were
+ * prepared for Clock Stop Mode 0. They then keep their Device Number and
+ * Data Port banks, so the Master can restart the clock without a bus
+ * reset, even when it lost its own context.
+ */
+bool sdw_bus_clk_stop_retains_ctx(struct sdw_bus *bus)
+{
+	struct sdw_slave *slave;
+
+	list_for_each_entry(slave, &bus->slaves, node) {
+		if (!slave->dev_num)
+			continue;
+
+		if (slave->status != SDW_SLAVE_ATTACHED &&
+		    slave->status != SDW_SLAVE_ALERT)
+			continue;
+
+		if (slave->curr_clk_stop_mode != SDW_CLK_STOP_MODE0)
+			return false;
+	}
+
+	return true;
+}
+EXPORT_SYMBOL(sdw_bus_clk_stop_retains_ctx);
+
+/**
+ * sdw_bus_ctx_lost: record that the stream configuration may be lost
+ *
+ * @bus: SDW bus instance
+ *
+ * Called when the Master lost its context, e.g. when the IP was powered
+ * off or re-initialized, and when a Slave became unattached. The streams
+ * on the bus are then fully programmed again on their next prepare.
+ */
+void sdw_bus_ctx_lost(struct sdw_bus *bus)
+{
+	WRITE_ONCE(bus->ctx_gen, bus->ctx_gen + 1);
+}
+EXPORT_SYMBOL(sdw_bus_ctx_lost);
+
 /**
  * sdw_bus_prep_clk_stop: prepare Slave(s) for clock stop
  *
@@ -852,6 +1752,12 @@ int sdw_bus_prep_clk_stop(struct sdw_bus *bus)
 			return ret;
 		}
 
+		if (slave_mode == SDW_CLK_STOP_MODE0) {
+			ret = sdw_slave_clk_stop_ctx(slave, true);
+			if (ret < 0)
+				return ret;
+		}
+
 		ret = sdw_slave_clk_stop_prepare(slave,
 						 slave_mode, true);
 		if (ret < 0) {
@@ -986,11 +1892,17 @@ int sdw_bus_exit_clk_stop(struct sdw_bus *bus)
 		if (ret < 0)
 			dev_warn(&slave->dev,
 				 "clk stop deprep failed:%d", ret);
+
+		/* only the registers flagged as lost need restoring */
+		sdw_slave_clk_stop_ctx(slave, false);
 	}
 
 	if (is_slave && !simple_clk_stop)
 		sdw_bus_wait_for_clk_prep_deprep(bus, SDW_BROADCAST_DEV_NUM);
 
+	/* Slaves back from Clock Stop Mode 0 kept their Data Port banks */
+	bus->slave_ctx_retained = is_slave && simple_clk_stop;
+
 	/*
 	 * Don't need to call slave callback function if there is no slave
 	 * attached
@@ -1079,10 +1991,25 @@ static int sdw_initialize_slave(struct sdw_slave *slave)
 	return ret;
 }
 
+/*
+ * Ack interrupt status bits and read the status registers back in one
+ * batch, saving a command round-trip for each pass over the interrupts
+ */
+static int sdw_ack_and_read_intr(struct sdw_slave *slave, u32 addr,
+				 u8 *clear, size_t count, u8 *val)
+{
+	struct sdw_slave_xfer xfers[] = {
+		{ .addr = addr, .count = 1, .buf = clear, .read = false },
+		{ .addr = addr, .count = count, .buf = val, .read = true },
+	};
+
+	return sdw_xfer_batch(slave, xfers, ARRAY_SIZE(xfers));
+}
+
 static int sdw_handle_dp0_interrupt(struct sdw_slave *slave, u8 *slave_status)
 {
-	u8 clear = 0, impl_int_mask;
-	int status, status2, ret, count = 0;
+	u8 clear = 0, impl_int_mask, status2;
+	int status, ret, count = 0;
 
 	status = sdw_read(slave, SDW_DP0_INT);
 	if (status < 0) {
@@ -1120,21 +2047,14 @@ static int sdw_handle_dp0_interrupt(struct sdw_slave *slave, u8 *slave_status)
 			*slave_status = clear;
 		}
 
-		/* clear the interrupt */
-		ret = sdw_write(slave, SDW_DP0_INT, clear);
+		/* clear the interrupt and read DP0 interrupt again */
+		ret = sdw_ack_and_read_intr(slave, SDW_DP0_INT, &clear,
+					    1, &status2);
 		if (ret < 0) {
 			dev_err(slave->bus->dev,
-				"SDW_DP0_INT write failed:%d\n", ret);
+				"SDW_DP0_INT write/read failed:%d\n", ret);
 			return ret;
 		}
-
-		/* Read DP0 interrupt again */
-		status2 = sdw_read(slave, SDW_DP0_INT);
-		if (status2 < 0) {
-			dev_err(slave->bus->dev,
-				"SDW_DP0_INT read failed:%d\n", status2);
-			return status2;
-		}
 		status &= status2;
 
 		count++;
@@ -1151,8 +2071,8 @@ static int sdw_handle_dp0_interrupt(struct sdw_slave *slave, u8 *slave_status)
 static int sdw_handle_port_interrupt(struct sdw_slave *slave,
 				     int port, u8 *slave_status)
 {
-	u8 clear = 0, impl_int_mask;
-	int status, status2, ret, count = 0;
+	u8 clear = 0, impl_int_mask, status2;
+	int status, ret, count = 0;
 	u32 addr;
 
 	if (port == 0)
@@ -1190,21 +2110,13 @@ static int sdw_handle_port_interrupt(struct sdw_slave *slave,
 			*slave_status = clear;
 		}
 
-		/* clear the interrupt */
-		ret = sdw_write(slave, addr, clear);
+		/* clear the interrupt and read DPN interrupt again */
+		ret = sdw_ack_and_read_intr(slave, addr, &clear, 1, &status2);
 		if (ret < 0) {
 			dev_err(slave->bus->dev,
-				"SDW_DPN_INT write failed:%d\n", ret);
+				"SDW_DPN_INT write/read failed:%d\n", ret);
 			return ret;
 		}
-
-		/* Read DPN interrupt again */
-		status2 = sdw_read(slave, addr);
-		if (status2 < 0) {
-			dev_err(slave->bus->dev,
-				"SDW_DPN_INT read failed:%d\n", status2);
-			return status2;
-		}
 		status &= status2;
 
 		count++;
@@ -1218,6 +2130,15 @@ static int sdw_handle_port_interrupt(struct sdw_slave *slave,
 	return ret;
 }
 
+/*
+ * SCP_Int1, SCP_IntMask1, SCP_IntStat2 and SCP_IntStat3 are contiguous
+ * and read in one go
+ */
+#define SDW_SCP_INT_REGS	(SDW_SCP_INTSTAT3 - SDW_SCP_INT1 + 1)
+#define SCP_INT1		(SDW_SCP_INT1 - SDW_SCP_INT1)
+#define SCP_INTSTAT2		(SDW_SCP_INTSTAT2 - SDW_SCP_INT1)
+#define SCP_INTSTAT3		(SDW_SCP_INTSTAT3 - SDW_SCP_INT1)
+
 static int sdw_handle_slave_alerts(struct sdw_slave *slave)
 {
 	struct sdw_slave_intr_status slave_intr;
@@ -1225,7 +2146,7 @@ static int sdw_handle_slave_alerts(struct sdw_slave *slave)
 	int port_num, stat, ret, count = 0;
 	unsigned long port;
 	bool slave_notify = false;
-	u8 buf, buf2[2], _buf, _buf2[2];
+	u8 buf[SDW_SCP_INT_REGS], _buf[SDW_SCP_INT_REGS];
 
 	sdw_modify_slave_status(slave, SDW_SLAVE_ALERT);
 
@@ -1237,18 +2158,10 @@ static int sdw_handle_slave_alerts(struct sdw_slave *slave)
 	}
 
 	/* Read Instat 1, Instat 2 and Instat 3 registers */
-	ret = sdw_read(slave, SDW_SCP_INT1);
-	if (ret < 0) {
-		dev_err(slave->bus->dev,
-			"SDW_SCP_INT1 read failed:%d\n", ret);
-		goto io_err;
-	}
-	buf = ret;
-
-	ret = sdw_nread(slave, SDW_SCP_INTSTAT2, 2, buf2);
+	ret = sdw_nread(slave, SDW_SCP_INT1, sizeof(buf), buf);
 	if (ret < 0) {
 		dev_err(slave->bus->dev,
-			"SDW_SCP_INT2/3 read failed:%d\n", ret);
+			"SDW_SCP_INT1/2/3 read failed:%d\n", ret);
 		goto io_err;
 	}
 
@@ -1257,12 +2170,12 @@ static int sdw_handle_slave_alerts(struct sdw_slave *slave)
 		 * Check parity, bus clash and Slave (impl defined)
 		 * interrupt
 		 */
-		if (buf & SDW_SCP_INT1_PARITY) {
+		if (buf[SCP_INT1] & SDW_SCP_INT1_PARITY) {
 			dev_err(&slave->dev, "Parity error detected\n");
 			clear |= SDW_SCP_INT1_PARITY;
 		}
 
-		if (buf & SDW_SCP_INT1_BUS_CLASH) {
+		if (buf[SCP_INT1] & SDW_SCP_INT1_BUS_CLASH) {
 			dev_err(&slave->dev, "Bus clash error detected\n");
 			clear |= SDW_SCP_INT1_BUS_CLASH;
 		}
@@ -1274,14 +2187,14 @@ static int sdw_handle_slave_alerts(struct sdw_slave *slave)
 		 * via sysfs property with bus reset being the default.
 		 */
 
-		if (buf & SDW_SCP_INT1_IMPL_DEF) {
+		if (buf[SCP_INT1] & SDW_SCP_INT1_IMPL_DEF) {
 			dev_dbg(&slave->dev, "Slave impl defined interrupt\n");
 			clear |= SDW_SCP_INT1_IMPL_DEF;
 			slave_notify = true;
 		}
 
 		/* Check port 0 - 3 interrupts */
-		port = buf & SDW_SCP_INT1_PORT0_3;
+		port = buf[SCP_INT1] & SDW_SCP_INT1_PORT0_3;
 
 		/* To get port number corresponding to bits, shift it */
 		port = port >> SDW_REG_SHIFT(SDW_SCP_INT1_PORT0_3);
@@ -1291,8 +2204,8 @@ static int sdw_handle_slave_alerts(struct sdw_slave *slave)
 		}
 
 		/* Check if cascade 2 interrupt is present */
-		if (buf & SDW_SCP_INT1_SCP2_CASCADE) {
-			port = buf2[0] & SDW_SCP_INTSTAT2_PORT4_10;
+		if (buf[SCP_INT1] & SDW_SCP_INT1_SCP2_CASCADE) {
+			port = buf[SCP_INTSTAT2] & SDW_SCP_INTSTAT2_PORT4_10;
 			for_each_set_bit(bit, &port, 8) {
 				/* scp2 ports start from 4 */
 				port_num = bit + 3;
@@ -1303,8 +2216,8 @@ static int sdw_handle_slave_alerts(struct sdw_slave *slave)
 		}
 
 		/* now check last cascade */
-		if (buf2[0] & SDW_SCP_INTSTAT2_SCP3_CASCADE) {
-			port = buf2[1] & SDW_SCP_INTSTAT3_PORT11_14;
+		if (buf[SCP_INTSTAT2] & SDW_SCP_INTSTAT2_SCP3_CASCADE) {
+			port = buf[SCP_INTSTAT3] & SDW_SCP_INTSTAT3_PORT11_14;
 			for_each_set_bit(bit, &port, 8) {
 				/* scp3 ports start from 11 */
 				port_num = bit + 10;
@@ -1324,38 +2237,24 @@ static int sdw_handle_slave_alerts(struct sdw_slave *slave)
 			slave->ops->interrupt_callback(slave, &slave_intr);
 		}
 
-		/* Ack interrupt */
-		ret = sdw_write(slave, SDW_SCP_INT1, clear);
-		if (ret < 0) {
-			dev_err(slave->bus->dev,
-				"SDW_SCP_INT1 write failed:%d\n", ret);
-			goto io_err;
-		}
-
 		/*
-		 * Read status again to ensure no new interrupts arrived
-		 * while servicing interrupts.
+		 * Ack interrupt and read status again to ensure no new
+		 * interrupts arrived while servicing interrupts.
 		 */
-		ret = sdw_read(slave, SDW_SCP_INT1);
-		if (ret < 0) {
-			dev_err(slave->bus->dev,
-				"SDW_SCP_INT1 read failed:%d\n", ret);
-			goto io_err;
-		}
-		_buf = ret;
-
-		ret = sdw_nread(slave, SDW_SCP_INTSTAT2, 2, _buf2);
+		ret = sdw_ack_and_read_intr(slave, SDW_SCP_INT1, &clear,
+					    sizeof(_buf), _buf);
 		if (ret < 0) {
 			dev_err(slave->bus->dev,
-				"SDW_SCP_INT2/3 read failed:%d\n", ret);
+				"SDW_SCP_INT1/2/3 write/read failed:%d\n", ret);
 			goto io_err;
 		}
 
 		/* Make sure no interrupts are pending */
-		buf &= _buf;
-		buf2[0] &= _buf2[0];
-		buf2[1] &= _buf2[1];
-		stat = buf || buf2[0] || buf2[1];
+		buf[SCP_INT1] &= _buf[SCP_INT1];
+		buf[SCP_INTSTAT2] &= _buf[SCP_INTSTAT2];
+		buf[SCP_INTSTAT3] &= _buf[SCP_INTSTAT3];
+		stat = buf[SCP_INT1] || buf[SCP_INTSTAT2] ||
+		       buf[SCP_INTSTAT3];
 
 		/*
 		 * Exit loop if Slave is continuously in ALERT state even
@@ -1404,6 +2303,34 @@ static int sdw_update_slave_status(struct sdw_slave *slave,
 	return slave->ops->update_status(slave, status);
 }
 
+/**
+ * sdw_slave_attach_work() - initialize a newly attached Slave
+ * @work: attach work of the Slave
+ *
+ * Restores the interrupt masks and notifies the Slave driver. This runs
+ * from an unbound workqueue so that all the Slaves attaching at the same
+ * time are initialized in parallel.
+ */
+void sdw_slave_attach_work(struct work_struct *work)
+{
+	struct sdw_slave *slave =
+		container_of(work, struct sdw_slave, attach_work);
+	int ret;
+
+	ret = sdw_initialize_slave(slave);
+	if (ret)
+		dev_err(slave->bus->dev,
+			"Slave %d initialization failed: %d\n",
+			slave->dev_num, ret);
+
+	ret = sdw_update_slave_status(slave, SDW_SLAVE_ATTACHED);
+	if (ret)
+		dev_err(slave->bus->dev,
+			"Update Slave status failed:%d\n", ret);
+
+	complete(&slave->initialization_complete);
+}
+
 /**
  * sdw_handle_slave_status() - Handle Slave status
  * @bus: SDW bus instance
@@ -1412,21 +2339,23 @@ static int sdw_update_slave_status(struct sdw_slave *slave,
 int sdw_handle_slave_status(struct sdw_bus *bus,
 			    enum sdw_slave_status status[])
 {
+	struct sdw_slave *attaching[SDW_MAX_DEVICES];
 	enum sdw_slave_status prev_status;
 	struct sdw_slave *slave;
-	bool attached_initializing;
-	int i, ret = 0;
+	int i, num_attaching = 0, ret = 0;
+
+	trace_sdw_slave_status(bus, status);
 
 	/* first check if any Slaves fell off the bus */
 	for (i = 1; i <= SDW_MAX_DEVICES; i++) {
-		mutex_lock(&bus->bus_lock);
+		mutex_lock(&bus->slave_lock);
 		if (test_bit(i, bus->assigned) == false) {
-			mutex_unlock(&bus->bus_lock);
+			mutex_unlock(&bus->slave_lock);
 			continue;
 		}
-		mutex_unlock(&bus->bus_lock);
 
 		slave = sdw_get_slave(bus, i);
+		mutex_unlock(&bus->slave_lock);
 		if (!slave)
 			continue;
 
@@ -1449,19 +2378,17 @@ int sdw_handle_slave_status(struct sdw_bus *bus,
 
 	/* Continue to check other slave statuses */
 	for (i = 1; i <= SDW_MAX_DEVICES; i++) {
-		mutex_lock(&bus->bus_lock);
+		mutex_lock(&bus->slave_lock);
 		if (test_bit(i, bus->assigned) == false) {
-			mutex_unlock(&bus->bus_lock);
+			mutex_unlock(&bus->slave_lock);
 			continue;
 		}
-		mutex_unlock(&bus->bus_lock);
 
 		slave = sdw_get_slave(bus, i);
+		mutex_unlock(&bus->slave_lock);
 		if (!slave)
 			continue;
 
-		attached_initializing = false;
-
 		switch (status[i]) {
 		case SDW_SLAVE_UNATTACHED:
 			if (slave->status == SDW_SLAVE_UNATTACHED)
@@ -1488,15 +2415,13 @@ int sdw_handle_slave_status(struct sdw_bus *bus,
 			if (prev_status == SDW_SLAVE_ALERT)
 				break;
 
-			attached_initializing = true;
-
-			ret = sdw_initialize_slave(slave);
-			if (ret)
-				dev_err(bus->dev,
-					"Slave %d initialization failed: %d\n",
-					i, ret);
-
-			break;
+			/*
+			 * Newly attached Slaves are initialized concurrently,
+			 * the status update is done from the attach work
+			 */
+			queue_work(system_unbound_wq, &slave->attach_work);
+			attaching[num_attaching++] = slave;
+			continue;
 
 		default:
 			dev_err(bus->dev, "Invalid slave %d status:%d\n",
@@ -1508,10 +2433,11 @@ int sdw_handle_slave_status(struct sdw_bus *bus,
 		if (ret)
 			dev_err(slave->bus->dev,
 				"Update Slave status failed:%d\n", ret);
-		if (attached_initializing)
-			complete(&slave->initialization_complete);
 	}
 
+	for (i = 0; i < num_attaching; i++)
+		flush_work(&attaching[i]->attach_work);
+
 	return ret;
 }
 EXPORT_SYMBOL(sdw_handle_slave_status);
@@ -1523,14 +2449,14 @@ void sdw_clear_slave_status(struct sdw_bus *bus, u32 request)
 
 	/* Check all non-zero devices */
 	for (i = 1; i <= SDW_MAX_DEVICES; i++) {
-		mutex_lock(&bus->bus_lock);
+		mutex_lock(&bus->slave_lock);
 		if (test_bit(i, bus->assigned) == false) {
-			mutex_unlock(&bus->bus_lock);
+			mutex_unlock(&bus->slave_lock);
 			continue;
 		}
-		mutex_unlock(&bus->bus_lock);
 
 		slave = sdw_get_slave(bus, i);
+		mutex_unlock(&bus->slave_lock);
 		if (!slave)
 			continue;
 
@@ -52,6 +52,8 @@ enum {
  * @buf: message data buffer
  * @ssp_sync: Send message at SSP (Stream Synchronization Point)
  * @page: address requires paging
+ * @sticky_page: SCP_AddrPage registers don't need to be reset after
+ * the transfer
  */
 struct sdw_msg {
 	u16 addr;
@@ -63,8 +65,12 @@ struct sdw_msg {
 	u8 *buf;
 	bool ssp_sync;
 	bool page;
+	bool sticky_page;
 };
 
+/* page_cache value when the SCP_AddrPage registers state is unknown */
+#define SDW_PAGE_INVALID		-1
+
 #define SDW_DOUBLE_RATE_FACTOR		2
 #define SDW_STRM_RATE_GROUPING		1
 
@@ -74,6 +80,19 @@ extern int sdw_cols[SDW_FRAME_COLS];
 int sdw_find_row_index(int row);
 int sdw_find_col_index(int col);
 
+/**
+ * sdw_port_bank_params: Port parameters programmed in a register bank
+ *
+ * @valid: parameters below match the bank registers
+ * @transport_params: Transport parameters
+ * @port_params: Port parameters
+ */
+struct sdw_port_bank_params {
+	bool valid;
+	struct sdw_transport_params transport_params;
+	struct sdw_port_params port_params;
+};
+
 /**
  * sdw_port_runtime: Runtime port parameters for Master or Slave
  *
@@ -82,6 +101,8 @@ int sdw_find_col_index(int col);
  * @ch_mask: Channel mask
  * @transport_params: Transport parameters
  * @port_params: Port parameters
+ * @bank: Parameters last programmed in each register bank, used to skip
+ * reprogramming ports which are not affected by a bank switch
  * @port_node: List node for Master or Slave port_list
  *
  * SoundWire spec has no mention of ports for Master interface but the
@@ -92,6 +113,7 @@ struct sdw_port_runtime {
 	int ch_mask;
 	struct sdw_transport_params transport_params;
 	struct sdw_port_params port_params;
+	struct sdw_port_bank_params bank[SDW_BANK1 + 1];
 	struct list_head port_node;
 };
 
@@ -125,6 +147,8 @@ struct sdw_slave_runtime {
  * @port_list: List of Master Ports configured for this stream, can be zero.
  * @stream_node: sdw_stream_runtime master_list node
  * @bus_node: sdw_bus m_rt_list node
+ * @lane: Data lane all the ports of the stream use on this bus
+ * @ctx_gen: value of the bus ctx_gen when the stream was last programmed
  */
 struct sdw_master_runtime {
 	struct sdw_bus *bus;
@@ -135,18 +159,26 @@ struct sdw_master_runtime {
 	struct list_head port_list;
 	struct list_head stream_node;
 	struct list_head bus_node;
+	unsigned int lane;
+	unsigned int ctx_gen;
 };
 
 struct sdw_dpn_prop *sdw_get_slave_dpn_prop(struct sdw_slave *slave,
 					    enum sdw_data_direction direction,
 					    unsigned int port_num);
+void sdw_slave_map_dpn_prop(struct sdw_slave *slave);
 int sdw_configure_dpn_intr(struct sdw_slave *slave, int port,
 			   bool enable, int mask);
 
 int sdw_transfer(struct sdw_bus *bus, struct sdw_msg *msg);
+int sdw_transfer_batch(struct sdw_bus *bus, struct sdw_msg *msgs, int num);
 int sdw_transfer_defer(struct sdw_bus *bus, struct sdw_msg *msg,
 		       struct sdw_defer *defer);
 
+void sdw_rt_pool_init(struct sdw_bus *bus);
+void sdw_rt_pool_release(struct sdw_bus *bus);
+int sdw_rt_pool_reserve(struct sdw_slave *slave);
+
 #define SDW_READ_INTR_CLEAR_RETRY	10
 
 int sdw_fill_msg(struct sdw_msg *msg, struct sdw_slave *slave,
@@ -214,5 +246,7 @@ static inline int sdw_update(struct sdw_slave *slave, u32 addr, u8 mask, u8 val)
 #define SDW_UNATTACH_REQUEST_MASTER_RESET	BIT(0)
 
 void sdw_clear_slave_status(struct sdw_bus *bus, u32 request);
+void sdw_bus_stats_bank_switch(struct sdw_bus *bus, u64 latency_us);
+void sdw_slave_attach_work(struct work_struct *work);
 
 #endif /* __SDW_BUS_H */
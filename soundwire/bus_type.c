@@ -137,6 +137,12 @@ static int sdw_drv_probe(struct device *dev)
 	if (slave->ops && slave->ops->read_prop)
 		slave->ops->read_prop(slave);
 
+	sdw_slave_map_dpn_prop(slave);
+
+	ret = sdw_rt_pool_reserve(slave);
+	if (ret)
+		dev_warn(dev, "Stream runtime reservation failed: %d\n", ret);
+
 	/*
 	 * Check for valid clk_stop_timeout, use DisCo worst case value of
 	 * 300ms
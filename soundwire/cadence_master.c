@@ -6,6 +6,7 @@
  * Used by Master driver
  */
 
+#include <linux/crc8.h>
 #include <linux/delay.h>
 #include <linux/device.h>
 #include <linux/debugfs.h>
@@ -18,6 +19,7 @@
 #include <dkms/sound/pcm_params.h>
 #include <dkms/sound/soc.h>
 #include <linux/workqueue.h>
+#include <asm/unaligned.h>
 #include "bus.h"
 #include "cadence_master.h"
 
@@ -25,6 +27,14 @@ static int interrupt_mask;
 module_param_named(cnds_mcp_int_mask, interrupt_mask, int, 0444);
 MODULE_PARM_DESC(cdns_mcp_int_mask, "Cadence MCP IntMask");
 
+static unsigned int alert_coalesce_us = 200;
+module_param(alert_coalesce_us, uint, 0644);
+MODULE_PARM_DESC(alert_coalesce_us,
+		 "Window for handling Slave status changes together, in us");
+
+/* passes over the Slave status before the interrupt is unmasked again */
+#define CDNS_SLAVE_STATUS_PASSES		4
+
 #define CDNS_MCP_CONFIG				0x0
 
 #define CDNS_MCP_CONFIG_MCMD_RETRY		GENMASK(27, 24)
@@ -587,6 +597,198 @@ exit:
 }
 EXPORT_SYMBOL(cdns_xfer_msg);
 
+/*
+ * Batched transfers: commands for several messages, possibly for
+ * different Slaves and mixing reads and writes, are packed in the
+ * command FIFO and a single completion is waited for per FIFO fill.
+ */
+struct cdns_batch {
+	u32 cmd[CDNS_MCP_CMD_LEN];
+	u16 msg_idx[CDNS_MCP_CMD_LEN];
+	s16 offset[CDNS_MCP_CMD_LEN];
+	int count;
+	bool nack;
+	bool no_ack;
+};
+
+static u32 cdns_cmd_word(u8 dev_num, int cmd, u16 addr, u8 data, bool ssp)
+{
+	u32 word;
+
+	word = dev_num << SDW_REG_SHIFT(CDNS_MCP_CMD_DEV_ADDR);
+	word |= cmd << SDW_REG_SHIFT(CDNS_MCP_CMD_COMMAND);
+	word |= addr << SDW_REG_SHIFT(CDNS_MCP_CMD_REG_ADDR_L);
+	word |= data;
+	word |= ssp << SDW_REG_SHIFT(CDNS_MCP_CMD_SSP_TAG);
+
+	return word;
+}
+
+static enum sdw_command_response
+cdns_batch_flush(struct sdw_cdns *cdns, struct cdns_batch *batch,
+		 struct sdw_msg *msgs)
+{
+	struct sdw_msg *msg;
+	unsigned long time;
+	u32 base, resp;
+	int i;
+
+	if (!batch->count)
+		return SDW_CMD_OK;
+
+	/* Program the watermark level for RX FIFO */
+	if (cdns->msg_count != batch->count) {
+		cdns_writel(cdns, CDNS_MCP_FIFOLEVEL, batch->count);
+		cdns->msg_count = batch->count;
+	}
+
+	base = CDNS_MCP_CMD_BASE;
+	for (i = 0; i < batch->count; i++) {
+		cdns_writel(cdns, base, batch->cmd[i]);
+		base += CDNS_MCP_CMD_WORD_LEN;
+	}
+
+	time = wait_for_completion_timeout(&cdns->tx_complete,
+					   msecs_to_jiffies(CDNS_TX_TIMEOUT));
+	if (!time) {
+		dev_err(cdns->dev, "Batched IO transfer timed out, %d cmds\n",
+			batch->count);
+		batch->count = 0;
+		return SDW_CMD_TIMEOUT;
+	}
+
+	for (i = 0; i < batch->count; i++) {
+		resp = cdns->response_buf[i];
+		msg = &msgs[batch->msg_idx[i]];
+
+		if (!(resp & CDNS_MCP_RESP_ACK)) {
+			if (resp & CDNS_MCP_RESP_NACK) {
+				batch->nack = true;
+				dev_err_ratelimited(cdns->dev,
+						    "Msg NACKed for Slave %d\n",
+						    msg->dev_num);
+			} else {
+				batch->no_ack = true;
+				dev_dbg_ratelimited(cdns->dev,
+						    "Msg ignored for Slave %d\n",
+						    msg->dev_num);
+			}
+			continue;
+		}
+
+		/* negative offsets are used for SCP_AddrPage commands */
+		if (batch->offset[i] >= 0 && msg->flags == SDW_MSG_FLAG_READ)
+			msg->buf[batch->offset[i]] = resp >>
+				SDW_REG_SHIFT(CDNS_MCP_RESP_RDATA);
+	}
+
+	batch->count = 0;
+
+	return batch->nack ? SDW_CMD_FAIL : SDW_CMD_OK;
+}
+
+static enum sdw_command_response
+cdns_batch_add(struct sdw_cdns *cdns, struct cdns_batch *batch,
+	       struct sdw_msg *msgs, int idx, u32 word, int offset)
+{
+	batch->cmd[batch->count] = word;
+	batch->msg_idx[batch->count] = idx;
+	batch->offset[batch->count] = offset;
+	batch->count++;
+
+	if (batch->count < CDNS_MCP_CMD_LEN)
+		return SDW_CMD_OK;
+
+	return cdns_batch_flush(cdns, batch, msgs);
+}
+
+static enum sdw_command_response
+cdns_batch_add_scp_addr(struct sdw_cdns *cdns, struct cdns_batch *batch,
+			struct sdw_msg *msgs, int idx, u8 page1, u8 page2)
+{
+	u8 dev_num = msgs[idx].dev_num;
+	int ret;
+
+	ret = cdns_batch_add(cdns, batch, msgs, idx,
+			     cdns_cmd_word(dev_num, CDNS_MCP_CMD_WRITE,
+					   SDW_SCP_ADDRPAGE1, page1, false),
+			     -1);
+	if (ret)
+		return ret;
+
+	return cdns_batch_add(cdns, batch, msgs, idx,
+			      cdns_cmd_word(dev_num, CDNS_MCP_CMD_WRITE,
+					    SDW_SCP_ADDRPAGE2, page2, false),
+			      -1);
+}
+
+/**
+ * cdns_xfer_msg_batch() - transfer several messages with batched FIFO fills
+ * @bus: SoundWire bus
+ * @msgs: array of messages
+ * @num: number of messages in @msgs
+ *
+ * The SCP_AddrPage registers of paged messages are programmed as part of
+ * the batch, the bus resets them when needed once the batch is done.
+ */
+enum sdw_command_response
+cdns_xfer_msg_batch(struct sdw_bus *bus, struct sdw_msg *msgs, int num)
+{
+	struct sdw_cdns *cdns = bus_to_cdns(bus);
+	struct cdns_batch batch = {};
+	struct sdw_msg *msg;
+	int cmd, ret, i, j;
+	u8 data;
+
+	for (i = 0; i < num; i++) {
+		msg = &msgs[i];
+
+		switch (msg->flags) {
+		case SDW_MSG_FLAG_READ:
+			cmd = CDNS_MCP_CMD_READ;
+			break;
+
+		case SDW_MSG_FLAG_WRITE:
+			cmd = CDNS_MCP_CMD_WRITE;
+			break;
+
+		default:
+			dev_err(cdns->dev, "Invalid msg cmd: %d\n", msg->flags);
+			return SDW_CMD_FAIL_OTHER;
+		}
+
+		if (msg->page) {
+			ret = cdns_batch_add_scp_addr(cdns, &batch, msgs, i,
+						      msg->addr_page1,
+						      msg->addr_page2);
+			if (ret)
+				return ret;
+		}
+
+		for (j = 0; j < msg->len; j++) {
+			data = 0;
+			if (msg->flags == SDW_MSG_FLAG_WRITE)
+				data = msg->buf[j];
+
+			ret = cdns_batch_add(cdns, &batch, msgs, i,
+					     cdns_cmd_word(msg->dev_num, cmd,
+							   msg->addr + j, data,
+							   msg->ssp_sync),
+					     j);
+			if (ret)
+				return ret;
+		}
+
+	}
+
+	ret = cdns_batch_flush(cdns, &batch, msgs);
+	if (ret)
+		return ret;
+
+	return batch.no_ack ? SDW_CMD_IGNORED : SDW_CMD_OK;
+}
+EXPORT_SYMBOL(cdns_xfer_msg_batch);
+
 enum sdw_command_response
 cdns_xfer_msg_defer(struct sdw_bus *bus,
 		    struct sdw_msg *msg, struct sdw_defer *defer)
@@ -594,8 +796,8 @@ cdns_xfer_msg_defer(struct sdw_bus *bus,
 	struct sdw_cdns *cdns = bus_to_cdns(bus);
 	int cmd = 0, ret;
 
-	/* for defer only 1 message is supported */
-	if (msg->len > 1)
+	/* deferred messages need to fit in the command FIFO */
+	if (msg->len > CDNS_MCP_CMD_LEN)
 		return -ENOTSUPP;
 
 	ret = cdns_prep_msg(cdns, msg, &cmd);
@@ -787,7 +989,8 @@ irqreturn_t sdw_cdns_irq(int irq, void *dev_id)
 			     CDNS_MCP_INT_SLAVE_MASK, 0);
 
 		int_status &= ~CDNS_MCP_INT_SLAVE_MASK;
-		schedule_work(&cdns->work);
+		/* links handle their Slave status changes in parallel */
+		queue_work(system_unbound_wq, &cdns->work);
 	}
 
 	cdns_writel(cdns, CDNS_MCP_INTSTAT, int_status);
@@ -806,15 +1009,30 @@ static void cdns_update_slave_status_work(struct work_struct *work)
 	struct sdw_cdns *cdns =
 		container_of(work, struct sdw_cdns, work);
 	u32 slave0, slave1;
+	int pass = 0;
 
 	dev_dbg_ratelimited(cdns->dev, "Slave status change\n");
 
-	slave0 = cdns_readl(cdns, CDNS_MCP_SLAVE_INTSTAT0);
-	slave1 = cdns_readl(cdns, CDNS_MCP_SLAVE_INTSTAT1);
+	/*
+	 * The Slave interrupt is masked until we are done, so alerts
+	 * from several Slaves arriving close together are latched and
+	 * handled in a single pass
+	 */
+	if (alert_coalesce_us)
+		usleep_range(alert_coalesce_us, alert_coalesce_us + 50);
+
+	do {
+		slave0 = cdns_readl(cdns, CDNS_MCP_SLAVE_INTSTAT0);
+		slave1 = cdns_readl(cdns, CDNS_MCP_SLAVE_INTSTAT1);
+		if (!slave0 && !slave1)
+			break;
+
+		cdns_update_slave_status(cdns, slave0, slave1);
+		cdns_writel(cdns, CDNS_MCP_SLAVE_INTSTAT0, slave0);
+		cdns_writel(cdns, CDNS_MCP_SLAVE_INTSTAT1, slave1);
 
-	cdns_update_slave_status(cdns, slave0, slave1);
-	cdns_writel(cdns, CDNS_MCP_SLAVE_INTSTAT0, slave0);
-	cdns_writel(cdns, CDNS_MCP_SLAVE_INTSTAT1, slave1);
+		/* pick up changes latched while we were busy */
+	} while (++pass < CDNS_SLAVE_STATUS_PASSES);
 
 	/* clear and unmask Slave interrupt now */
 	cdns_writel(cdns, CDNS_MCP_INTSTAT, CDNS_MCP_INT_SLAVE_MASK);
@@ -1419,8 +1637,15 @@ EXPORT_SYMBOL(sdw_cdns_clock_restart);
  * sdw_cdns_probe() - Cadence probe routine
  * @cdns: Cadence instance
  */
+/* MIPI BRA CRC8 polynomial x^8 + x^6 + x^3 + x^2 + 1 */
+#define CDNS_BRA_CRC8_POLY			0x4d
+
+DECLARE_CRC8_TABLE(cdns_bra_crc8_table);
+
 int sdw_cdns_probe(struct sdw_cdns *cdns)
 {
+	crc8_populate_msb(cdns_bra_crc8_table, CDNS_BRA_CRC8_POLY);
+
 	init_completion(&cdns->tx_complete);
 	cdns->bus.port_ops = &cdns_port_ops;
 
@@ -1486,13 +1711,15 @@ EXPORT_SYMBOL(cdns_set_sdw_stream);
  * cdns_find_pdi() - Find a free PDI
  *
  * @cdns: Cadence instance
- * @offset: Starting offset
+ * @offset: Starting offset, PDIs below are reserved
  * @num: Number of PDIs
  * @pdi: PDI instances
  * @dai_id: DAI id
  *
  * Find a PDI for a given PDI array. The PDI num and dai_id are
- * expected to match, return NULL otherwise.
+ * expected to match, return NULL otherwise. The PDIs of an array are
+ * numbered contiguously by cdns_allocate_pdi(), so the PDI is found
+ * by index rather than by walking the array.
  */
 static struct sdw_cdns_pdi *cdns_find_pdi(struct sdw_cdns *cdns,
 					  unsigned int offset,
@@ -1502,11 +1729,14 @@ static struct sdw_cdns_pdi *cdns_find_pdi(struct sdw_cdns *cdns,
 {
 	int i;
 
-	for (i = offset; i < offset + num; i++)
-		if (pdi[i].num == dai_id)
-			return &pdi[i];
+	if (!num)
+		return NULL;
+
+	i = dai_id - pdi[0].num;
+	if (i < (int)offset || i >= num)
+		return NULL;
 
-	return NULL;
+	return &pdi[i];
 }
 
 /**
@@ -1573,5 +1803,191 @@ struct sdw_cdns_pdi *sdw_cdns_alloc_pdi(struct sdw_cdns *cdns,
 }
 EXPORT_SYMBOL(sdw_cdns_alloc_pdi);
 
+/**
+ * sdw_cdns_bpt_pdi() - Get the PDI reserved for Bulk transfers
+ *
+ * @cdns: Cadence instance
+ * @dir: Data direction
+ *
+ * PDI0 carries the data sent by the Master, PDI1 the data driven by the
+ * Slave in the same data port slots.
+ */
+struct sdw_cdns_pdi *sdw_cdns_bpt_pdi(struct sdw_cdns *cdns, u32 dir)
+{
+	struct sdw_cdns_pdi *pdi;
+
+	if (cdns->pcm.num_bd < 2)
+		return NULL;
+
+	pdi = &cdns->pcm.bd[dir == SDW_DATA_DIR_RX ? 1 : 0];
+	pdi->l_ch_num = 0;
+	pdi->h_ch_num = 0;
+	pdi->dir = dir;
+	pdi->ch_count = 1;
+
+	return pdi;
+}
+EXPORT_SYMBOL(sdw_cdns_bpt_pdi);
+
+/*
+ * Bulk Register Access packets
+ *
+ * A BPT message is split in packets of at most CDNS_BRA_MAX_DATA bytes.
+ * For each packet the Master sends a header, its CRC and, for writes,
+ * the data and their CRC. The Slave returns a header response, for reads
+ * the data and their CRC, and a footer response. Each packet is padded
+ * to a 32-bit word in both buffers to match the PDI DMA granularity.
+ */
+#define CDNS_BRA_HDR_LEN			6
+#define CDNS_BRA_CRC_LEN			1
+#define CDNS_BRA_RESP_LEN			1
+#define CDNS_BRA_MAX_DATA			128
+
+#define CDNS_BRA_HDR_ACTIVE			GENMASK(7, 6)
+#define CDNS_BRA_HDR_DEV_NUM			GENMASK(5, 2)
+#define CDNS_BRA_HDR_WRITE			BIT(1)
+
+#define CDNS_BRA_RESP				GENMASK(1, 0)
+#define CDNS_BRA_RESP_ACK			0x1
+
+static void cdns_bra_packet_len(bool read, size_t len,
+				size_t *tx_len, size_t *rx_len)
+{
+	*tx_len = CDNS_BRA_HDR_LEN + CDNS_BRA_CRC_LEN;
+	*rx_len = 2 * CDNS_BRA_RESP_LEN;
+
+	if (read)
+		*rx_len += len + CDNS_BRA_CRC_LEN;
+	else
+		*tx_len += len + CDNS_BRA_CRC_LEN;
+
+	*tx_len = ALIGN(*tx_len, sizeof(u32));
+	*rx_len = ALIGN(*rx_len, sizeof(u32));
+}
+
+/**
+ * sdw_cdns_bpt_size() - Size of the DMA buffers for a BPT message
+ *
+ * @msg: BPT message
+ * @tx_len: size of the buffer sent on PDI0
+ * @rx_len: size of the buffer received on PDI1
+ */
+void sdw_cdns_bpt_size(struct sdw_bpt_msg *msg,
+		       size_t *tx_len, size_t *rx_len)
+{
+	bool read = msg->flags == SDW_MSG_FLAG_READ;
+	size_t left, len, tx, rx;
+
+	*tx_len = 0;
+	*rx_len = 0;
+
+	for (left = msg->len; left; left -= len) {
+		len = min_t(size_t, left, CDNS_BRA_MAX_DATA);
+		cdns_bra_packet_len(read, len, &tx, &rx);
+		*tx_len += tx;
+		*rx_len += rx;
+	}
+}
+EXPORT_SYMBOL(sdw_cdns_bpt_size);
+
+/**
+ * sdw_cdns_bpt_format() - Build the BRA packets of a BPT message
+ *
+ * @msg: BPT message
+ * @tx: zeroed buffer of the size returned by sdw_cdns_bpt_size()
+ */
+void sdw_cdns_bpt_format(struct sdw_bpt_msg *msg, u8 *tx)
+{
+	bool read = msg->flags == SDW_MSG_FLAG_READ;
+	size_t left, len, tx_len, rx_len;
+	u32 addr = msg->addr;
+	u8 *buf = msg->buf;
+
+	for (left = msg->len; left; left -= len) {
+		len = min_t(size_t, left, CDNS_BRA_MAX_DATA);
+		cdns_bra_packet_len(read, len, &tx_len, &rx_len);
+
+		tx[0] = CDNS_BRA_HDR_ACTIVE;
+		tx[0] |= (msg->dev_num << SDW_REG_SHIFT(CDNS_BRA_HDR_DEV_NUM)) &
+			 CDNS_BRA_HDR_DEV_NUM;
+		if (!read)
+			tx[0] |= CDNS_BRA_HDR_WRITE;
+		tx[1] = len;
+		put_unaligned_be32(addr, &tx[2]);
+		tx[CDNS_BRA_HDR_LEN] = crc8(cdns_bra_crc8_table, tx,
+					    CDNS_BRA_HDR_LEN, CRC8_INIT_VALUE);
+
+		if (!read) {
+			u8 *data = tx + CDNS_BRA_HDR_LEN + CDNS_BRA_CRC_LEN;
+
+			memcpy(data, buf, len);
+			data[len] = crc8(cdns_bra_crc8_table, buf, len,
+					 CRC8_INIT_VALUE);
+		}
+
+		tx += tx_len;
+		buf += len;
+		addr += len;
+	}
+}
+EXPORT_SYMBOL(sdw_cdns_bpt_format);
+
+/**
+ * sdw_cdns_bpt_parse() - Check the Slave responses to a BPT message
+ *
+ * @cdns: Cadence instance
+ * @msg: BPT message, read data are copied to its buffer
+ * @rx: buffer received on PDI1
+ */
+int sdw_cdns_bpt_parse(struct sdw_cdns *cdns, struct sdw_bpt_msg *msg,
+		       const u8 *rx)
+{
+	bool read = msg->flags == SDW_MSG_FLAG_READ;
+	size_t left, len, tx_len, rx_len;
+	u32 addr = msg->addr;
+	u8 *buf = msg->buf;
+	const u8 *p;
+
+	for (left = msg->len; left; left -= len) {
+		len = min_t(size_t, left, CDNS_BRA_MAX_DATA);
+		cdns_bra_packet_len(read, len, &tx_len, &rx_len);
+
+		if ((rx[0] & CDNS_BRA_RESP) != CDNS_BRA_RESP_ACK) {
+			dev_err_ratelimited(cdns->dev,
+					    "BRA header not acked at %#x: %#x\n",
+					    addr, rx[0]);
+			return -EIO;
+		}
+
+		p = rx + CDNS_BRA_RESP_LEN;
+		if (read) {
+			if (crc8(cdns_bra_crc8_table, p, len,
+				 CRC8_INIT_VALUE) != p[len]) {
+				dev_err_ratelimited(cdns->dev,
+						    "BRA data CRC error at %#x\n",
+						    addr);
+				return -EIO;
+			}
+
+			memcpy(buf, p, len);
+			p += len + CDNS_BRA_CRC_LEN;
+		}
+
+		if ((*p & CDNS_BRA_RESP) != CDNS_BRA_RESP_ACK) {
+			dev_err_ratelimited(cdns->dev,
+					    "BRA footer not acked at %#x: %#x\n",
+					    addr, *p);
+			return -EIO;
+		}
+
+		rx += rx_len;
+		buf += len;
+		addr += len;
+	}
+
+	return 0;
+}
+EXPORT_SYMBOL(sdw_cdns_bpt_parse);
+
 MODULE_LICENSE("Dual BSD/GPL");
 MODULE_DESCRIPTION("Cadence Soundwire Library");
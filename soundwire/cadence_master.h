@@ -169,12 +169,22 @@ struct sdw_cdns_pdi *sdw_cdns_alloc_pdi(struct sdw_cdns *cdns,
 void sdw_cdns_config_stream(struct sdw_cdns *cdns,
 			    u32 ch, u32 dir, struct sdw_cdns_pdi *pdi);
 
+struct sdw_cdns_pdi *sdw_cdns_bpt_pdi(struct sdw_cdns *cdns, u32 dir);
+void sdw_cdns_bpt_size(struct sdw_bpt_msg *msg,
+		       size_t *tx_len, size_t *rx_len);
+void sdw_cdns_bpt_format(struct sdw_bpt_msg *msg, u8 *tx);
+int sdw_cdns_bpt_parse(struct sdw_cdns *cdns, struct sdw_bpt_msg *msg,
+		       const u8 *rx);
+
 enum sdw_command_response
 cdns_reset_page_addr(struct sdw_bus *bus, unsigned int dev_num);
 
 enum sdw_command_response
 cdns_xfer_msg(struct sdw_bus *bus, struct sdw_msg *msg);
 
+enum sdw_command_response
+cdns_xfer_msg_batch(struct sdw_bus *bus, struct sdw_msg *msgs, int num);
+
 enum sdw_command_response
 cdns_xfer_msg_defer(struct sdw_bus *bus,
 		    struct sdw_msg *msg, struct sdw_defer *defer);
@@ -11,6 +11,30 @@
 
 static struct dentry *sdw_debugfs_root;
 
+static int sdw_bus_stats_show(struct seq_file *s_file, void *data)
+{
+	struct sdw_bus *bus = s_file->private;
+	struct sdw_bus_stats *stats = &bus->stats;
+	int i;
+
+	seq_printf(s_file, "commands:\t%llu\n", stats->cmds);
+	seq_printf(s_file, "retries:\t%llu\n", stats->retries);
+	seq_printf(s_file, "ignored:\t%llu\n", stats->ignored);
+	seq_printf(s_file, "failed:\t\t%llu\n", stats->failed);
+	seq_printf(s_file, "page resets:\t%llu\n", stats->page_resets);
+	seq_printf(s_file, "bank switches:\t%llu\n", stats->bank_switches);
+
+	seq_puts(s_file, "\nbank switch latency\n");
+	for (i = 0; i < SDW_BANK_SWITCH_HIST - 1; i++)
+		seq_printf(s_file, "< %6uus:\t%llu\n", 100U << i,
+			   stats->bank_switch_hist[i]);
+	seq_printf(s_file, ">= %5uus:\t%llu\n", 100U << i,
+		   stats->bank_switch_hist[i]);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(sdw_bus_stats);
+
 void sdw_bus_debugfs_init(struct sdw_bus *bus)
 {
 	char name[16];
@@ -21,6 +45,9 @@ void sdw_bus_debugfs_init(struct sdw_bus *bus)
 	/* create the debugfs master-N */
 	snprintf(name, sizeof(name), "master-%d", bus->link_id);
 	bus->debugfs = debugfs_create_dir(name, sdw_debugfs_root);
+
+	debugfs_create_file("stats", 0400, bus->debugfs, bus,
+			    &sdw_bus_stats_fops);
 }
 
 void sdw_bus_debugfs_exit(struct sdw_bus *bus)
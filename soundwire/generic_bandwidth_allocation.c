@@ -35,6 +35,38 @@ struct sdw_transport_data {
 	int sub_block_offset;
 };
 
+static int sdw_bus_num_lanes(struct sdw_bus *bus)
+{
+	return clamp_t(int, bus->prop.num_lanes, 1, SDW_MAX_LANES);
+}
+
+/* Data lanes supported by the Master and all Slave ports of a stream */
+static unsigned long sdw_m_rt_lane_mask(struct sdw_master_runtime *m_rt)
+{
+	struct sdw_slave_runtime *s_rt;
+	struct sdw_port_runtime *p_rt;
+	struct sdw_dpn_prop *dpn_prop;
+	unsigned long mask;
+
+	mask = GENMASK(sdw_bus_num_lanes(m_rt->bus) - 1, 0);
+
+	list_for_each_entry(s_rt, &m_rt->slave_rt_list, m_rt_node) {
+		if (!s_rt->slave->prop.lane_control_support) {
+			mask &= BIT(0);
+			continue;
+		}
+
+		list_for_each_entry(p_rt, &s_rt->port_list, port_node) {
+			dpn_prop = sdw_get_slave_dpn_prop(s_rt->slave,
+							  s_rt->direction,
+							  p_rt->num);
+			mask &= BIT(0) | (dpn_prop ? dpn_prop->lanes : 0);
+		}
+	}
+
+	return mask;
+}
+
 static void sdw_compute_slave_ports(struct sdw_master_runtime *m_rt,
 				    struct sdw_transport_data *t_data)
 {
@@ -61,7 +93,8 @@ static void sdw_compute_slave_ports(struct sdw_master_runtime *m_rt,
 					      sample_int, port_bo, port_bo >> 8,
 					      t_data->hstart,
 					      t_data->hstop,
-					      (SDW_BLK_GRP_CNT_1 * ch), 0x0);
+					      (SDW_BLK_GRP_CNT_1 * ch),
+					      m_rt->lane);
 
 			sdw_fill_port_params(&p_rt->port_params,
 					     p_rt->num, bps,
@@ -113,7 +146,7 @@ static void sdw_compute_master_ports(struct sdw_master_runtime *m_rt,
 		sdw_fill_xport_params(&p_rt->transport_params, p_rt->num,
 				      false, SDW_BLK_GRP_CNT_1, sample_int,
 				      port_bo, port_bo >> 8, hstart, hstop,
-				      (SDW_BLK_GRP_CNT_1 * no_ch), 0x0);
+				      (SDW_BLK_GRP_CNT_1 * no_ch), m_rt->lane);
 
 		sdw_fill_port_params(&p_rt->port_params,
 				     p_rt->num, bps,
@@ -142,42 +175,51 @@ static void _sdw_compute_port_params(struct sdw_bus *bus,
 				     struct sdw_group_params *params, int count)
 {
 	struct sdw_master_runtime *m_rt = NULL;
-	int hstop = bus->params.col - 1;
-	int block_offset, port_bo, i;
+	int lanes = sdw_bus_num_lanes(bus);
+	struct sdw_group_params *lp;
+	int block_offset, port_bo, hstop, i, lane;
 
-	/* Run loop for all groups to compute transport parameters */
-	for (i = 0; i < count; i++) {
-		port_bo = 1;
-		block_offset = 1;
+	/* each lane has its own frame, run the groups of all lanes */
+	for (lane = 0; lane < lanes; lane++) {
+		lp = &params[lane * count];
+		hstop = bus->params.col - 1;
+
+		/* Run loop for all groups to compute transport parameters */
+		for (i = 0; i < count; i++) {
+			port_bo = 1;
+			block_offset = 1;
 
-		list_for_each_entry(m_rt, &bus->m_rt_list, bus_node) {
-			sdw_compute_master_ports(m_rt, &params[i],
-						 port_bo, hstop);
+			list_for_each_entry(m_rt, &bus->m_rt_list, bus_node) {
+				if (m_rt->lane != lane)
+					continue;
 
-			block_offset += m_rt->ch_count *
-					m_rt->stream->params.bps;
-			port_bo = block_offset;
-		}
+				sdw_compute_master_ports(m_rt, &lp[i],
+							 port_bo, hstop);
+
+				block_offset += m_rt->ch_count *
+						m_rt->stream->params.bps;
+				port_bo = block_offset;
+			}
 
-		hstop = hstop - params[i].hwidth;
+			hstop = hstop - lp[i].hwidth;
+		}
 	}
 }
 
-static int sdw_compute_group_params(struct sdw_bus *bus,
-				    struct sdw_group_params *params,
-				    int *rates, int count)
+static void sdw_compute_group_payload(struct sdw_bus *bus,
+				      struct sdw_group_params *params,
+				      unsigned int *rates, int count)
 {
 	struct sdw_master_runtime *m_rt = NULL;
-	int sel_col = bus->params.col;
 	unsigned int rate, bps, ch;
-	int i, column_needed = 0;
+	int i;
 
-	/* Calculate bandwidth per group */
 	for (i = 0; i < count; i++) {
 		params[i].rate = rates[i];
-		params[i].full_bw = bus->params.curr_dr_freq / params[i].rate;
+		params[i].payload_bw = 0;
 	}
 
+	/* Calculate payload per group */
 	list_for_each_entry(m_rt, &bus->m_rt_list, bus_node) {
 		rate = m_rt->stream->params.rate;
 		bps = m_rt->stream->params.bps;
@@ -188,8 +230,30 @@ static int sdw_compute_group_params(struct sdw_bus *bus,
 				params[i].payload_bw += bps * ch;
 		}
 	}
+}
+
+/*
+ * Compute the horizontal width of each rate group for the given clock
+ * frequency and number of columns, and check all groups fit in the
+ * frame next to the control column. The sample interval of each group
+ * must be exact, this matters for the PDM streams whose bit rate is
+ * close to the bus clock, so that they run at the lowest clock they
+ * divide rather than at a truncated interval.
+ */
+static int sdw_compute_group_params(struct sdw_group_params *params,
+				    int count, unsigned int clk_freq,
+				    int sel_col)
+{
+	int i, column_needed = 0;
 
 	for (i = 0; i < count; i++) {
+		if (clk_freq % params[i].rate)
+			return -EINVAL;
+
+		params[i].full_bw = clk_freq / params[i].rate;
+		if (!params[i].full_bw)
+			return -EINVAL;
+
 		params[i].hwidth = (sel_col *
 			params[i].payload_bw + params[i].full_bw - 1) /
 			params[i].full_bw;
@@ -203,6 +267,66 @@ static int sdw_compute_group_params(struct sdw_bus *bus,
 	return 0;
 }
 
+/*
+ * Place each stream on the first data lane, among the ones all its
+ * ports support, where the rate groups of that lane still fit in the
+ * frame. Streams only spill over to the other lanes once lane 0 is
+ * full, column 0 is left unused on all lanes.
+ */
+static int sdw_assign_lanes(struct sdw_bus *bus,
+			    struct sdw_group_params *params,
+			    struct sdw_group_params *lane_params, int count,
+			    unsigned int clk_freq, int sel_col)
+{
+	int lanes = sdw_bus_num_lanes(bus);
+	struct sdw_master_runtime *m_rt;
+	struct sdw_group_params *lp;
+	unsigned long mask;
+	unsigned int lane;
+	int payload, i;
+
+	for (i = 0; i < lanes * count; i++) {
+		lane_params[i].rate = params[i % count].rate;
+		lane_params[i].payload_bw = 0;
+	}
+
+	list_for_each_entry(m_rt, &bus->m_rt_list, bus_node) {
+		payload = m_rt->ch_count * m_rt->stream->params.bps;
+
+		for (i = 0; i < count; i++) {
+			if (params[i].rate == m_rt->stream->params.rate)
+				break;
+		}
+
+		if (i == count)
+			return -EINVAL;
+
+		mask = sdw_m_rt_lane_mask(m_rt);
+		for_each_set_bit(lane, &mask, lanes) {
+			lp = &lane_params[lane * count];
+
+			lp[i].payload_bw += payload;
+			if (!sdw_compute_group_params(lp, count, clk_freq,
+						      sel_col))
+				break;
+
+			lp[i].payload_bw -= payload;
+		}
+
+		if (lane >= lanes)
+			return -EINVAL;
+
+		m_rt->lane = lane;
+	}
+
+	/* failed attempts leave stale widths behind, compute them again */
+	for (lane = 0; lane < lanes; lane++)
+		sdw_compute_group_params(&lane_params[lane * count], count,
+					 clk_freq, sel_col);
+
+	return 0;
+}
+
 static int sdw_add_element_group_count(struct sdw_group *group,
 				       unsigned int rate)
 {
@@ -263,134 +387,111 @@ static int sdw_get_group_count(struct sdw_bus *bus,
 	return ret;
 }
 
-/**
- * sdw_compute_port_params: Compute transport and port parameters
- *
- * @bus: SDW Bus instance
- */
-static int sdw_compute_port_params(struct sdw_bus *bus)
+static bool sdw_bw_cache_match(struct sdw_bus *bus,
+			       struct sdw_group_params *params, int count)
 {
-	struct sdw_group_params *params = NULL;
-	struct sdw_group group;
-	int ret;
+	struct sdw_bw_cache *cache = &bus->bw_cache;
+	int i, j;
 
-	ret = sdw_get_group_count(bus, &group);
-	if (ret < 0)
-		return ret;
+	if (!cache->valid || cache->count != count ||
+	    cache->bandwidth != bus->params.bandwidth)
+		return false;
 
-	if (group.count == 0)
-		goto out;
+	/* the groups are not necessarily in the same order */
+	for (i = 0; i < count; i++) {
+		for (j = 0; j < count; j++) {
+			if (cache->rate[j] == params[i].rate &&
+			    cache->payload[j] == params[i].payload_bw)
+				break;
+		}
 
-	params = kcalloc(group.count, sizeof(*params), GFP_KERNEL);
-	if (!params) {
-		ret = -ENOMEM;
-		goto out;
+		if (j == count)
+			return false;
 	}
 
-	/* Compute transport parameters for grouped streams */
-	ret = sdw_compute_group_params(bus, params,
-				       &group.rates[0], group.count);
-	if (ret < 0)
-		goto free_params;
-
-	_sdw_compute_port_params(bus, params, group.count);
-
-free_params:
-	kfree(params);
-out:
-	kfree(group.rates);
-
-	return ret;
+	return true;
 }
 
-static int sdw_select_row_col(struct sdw_bus *bus, int clk_freq)
+static void sdw_bw_cache_store(struct sdw_bus *bus,
+			       struct sdw_group_params *params, int count)
 {
-	struct sdw_master_prop *prop = &bus->prop;
-	int frame_int, frame_freq;
-	int r, c;
-
-	for (c = 0; c < SDW_FRAME_COLS; c++) {
-		for (r = 0; r < SDW_FRAME_ROWS; r++) {
-			if (sdw_rows[r] != prop->default_row ||
-			    sdw_cols[c] != prop->default_col)
-				continue;
-
-			frame_int = sdw_rows[r] * sdw_cols[c];
-			frame_freq = clk_freq / frame_int;
-
-			if ((clk_freq - (frame_freq * SDW_FRAME_CTRL_BITS)) <
-			    bus->params.bandwidth)
-				continue;
-
-			bus->params.row = sdw_rows[r];
-			bus->params.col = sdw_cols[c];
-			return 0;
-		}
+	struct sdw_bw_cache *cache = &bus->bw_cache;
+	int i;
+
+	if (count > SDW_BW_CACHE_GROUPS) {
+		cache->valid = false;
+		return;
 	}
 
-	return -EINVAL;
+	for (i = 0; i < count; i++) {
+		cache->rate[i] = params[i].rate;
+		cache->payload[i] = params[i].payload_bw;
+	}
+
+	cache->count = count;
+	cache->bandwidth = bus->params.bandwidth;
+	cache->curr_dr_freq = bus->params.curr_dr_freq;
+	cache->row = bus->params.row;
+	cache->col = bus->params.col;
+	cache->valid = true;
 }
 
 /**
  * sdw_compute_bus_params: Compute bus parameters
  *
  * @bus: SDW Bus instance
+ * @params: rate group parameters
+ * @lane_params: rate group parameters of each data lane
+ * @count: number of rate groups
+ *
+ * Select the lowest clock frequency, and a frame shape at that
+ * frequency, which can carry all the rate groups over the data lanes.
+ * The new clock and frame shape are applied with the next bank switch.
  */
-static int sdw_compute_bus_params(struct sdw_bus *bus)
+static int sdw_compute_bus_params(struct sdw_bus *bus,
+				  struct sdw_group_params *params,
+				  struct sdw_group_params *lane_params,
+				  int count)
 {
-	unsigned int max_dr_freq, curr_dr_freq = 0;
-	struct sdw_master_prop *mstr_prop = NULL;
-	int i, clk_values, ret;
-	bool is_gear = false;
-	u32 *clk_buf;
-
-	mstr_prop = &bus->prop;
-	if (!mstr_prop)
-		return -EINVAL;
+	struct sdw_bw_cache *cache = &bus->bw_cache;
+	int lanes = sdw_bus_num_lanes(bus);
+	struct sdw_frame_shape *shape;
+	int i;
+
+	/* Same streams as the last time, e.g. re-prepare after an xrun */
+	if (sdw_bw_cache_match(bus, params, count) &&
+	    !sdw_assign_lanes(bus, params, lane_params, count,
+			      cache->curr_dr_freq, cache->col)) {
+		bus->params.curr_dr_freq = cache->curr_dr_freq;
+		bus->params.row = cache->row;
+		bus->params.col = cache->col;
 
-	if (mstr_prop->num_clk_gears) {
-		clk_values = mstr_prop->num_clk_gears;
-		clk_buf = mstr_prop->clk_gears;
-		is_gear = true;
-	} else if (mstr_prop->num_clk_freq) {
-		clk_values = mstr_prop->num_clk_freq;
-		clk_buf = mstr_prop->clk_freq;
-	} else {
-		clk_values = 1;
-		clk_buf = NULL;
+		return 0;
 	}
 
-	max_dr_freq = mstr_prop->max_clk_freq * SDW_DOUBLE_RATE_FACTOR;
+	/*
+	 * The frame shapes are sorted by increasing clock frequency with
+	 * the default frame shape first, so the first match is the best.
+	 */
+	for (i = 0; i < bus->num_frame_shapes; i++) {
+		shape = &bus->frame_shapes[i];
 
-	for (i = 0; i < clk_values; i++) {
-		if (!clk_buf)
-			curr_dr_freq = max_dr_freq;
-		else
-			curr_dr_freq = (is_gear) ?
-				(max_dr_freq >>  clk_buf[i]) :
-				clk_buf[i] * SDW_DOUBLE_RATE_FACTOR;
+		if ((u64)shape->bandwidth * lanes < bus->params.bandwidth)
+			continue;
 
-		if (curr_dr_freq <= bus->params.bandwidth)
+		if (sdw_assign_lanes(bus, params, lane_params, count,
+				     shape->clk_freq, shape->col) < 0)
 			continue;
 
-		break;
+		bus->params.curr_dr_freq = shape->clk_freq;
+		bus->params.row = shape->row;
+		bus->params.col = shape->col;
 
-		/*
-		 * TODO: Check all the Slave(s) port(s) audio modes and find
-		 * whether given clock rate is supported with glitchless
-		 * transition.
-		 */
+		sdw_bw_cache_store(bus, params, count);
+		return 0;
 	}
 
-	if (i == clk_values)
-		return -EINVAL;
-
-	ret = sdw_select_row_col(bus, curr_dr_freq);
-	if (ret < 0)
-		return -EINVAL;
-
-	bus->params.curr_dr_freq = curr_dr_freq;
-	return 0;
+	return -EINVAL;
 }
 
 /**
@@ -400,23 +501,44 @@ static int sdw_compute_bus_params(struct sdw_bus *bus)
  */
 int sdw_compute_params(struct sdw_bus *bus)
 {
+	struct sdw_group_params *lane_params = NULL;
+	struct sdw_group_params *params = NULL;
+	struct sdw_group group;
 	int ret;
 
+	ret = sdw_get_group_count(bus, &group);
+	if (ret < 0)
+		return ret;
+
+	if (group.count) {
+		params = kcalloc(group.count, sizeof(*params), GFP_KERNEL);
+		lane_params = kcalloc(group.count * sdw_bus_num_lanes(bus),
+				      sizeof(*lane_params), GFP_KERNEL);
+		if (!params || !lane_params) {
+			ret = -ENOMEM;
+			goto free_params;
+		}
+
+		sdw_compute_group_payload(bus, params, group.rates,
+					  group.count);
+	}
+
 	/* Computes clock frequency, frame shape and frame frequency */
-	ret = sdw_compute_bus_params(bus);
+	ret = sdw_compute_bus_params(bus, params, lane_params, group.count);
 	if (ret < 0) {
 		dev_err(bus->dev, "Compute bus params failed: %d", ret);
-		return ret;
+		goto free_params;
 	}
 
 	/* Compute transport and port params */
-	ret = sdw_compute_port_params(bus);
-	if (ret < 0) {
-		dev_err(bus->dev, "Compute transport params failed: %d", ret);
-		return ret;
-	}
+	_sdw_compute_port_params(bus, lane_params, group.count);
 
-	return 0;
+free_params:
+	kfree(lane_params);
+	kfree(params);
+	kfree(group.rates);
+
+	return ret;
 }
 EXPORT_SYMBOL(sdw_compute_params);
 
@@ -12,6 +12,7 @@
 #include <linux/interrupt.h>
 #include <linux/io.h>
 #include <linux/pm_runtime.h>
+#include <linux/slab.h>
 #include <dkms/sound/pcm_params.h>
 #include <dkms/sound/soc.h>
 #include <dkms/linux/soundwire/sdw_registers.h>
@@ -104,6 +105,13 @@ MODULE_PARM_DESC(sdw_md_flags, "SoundWire Intel Master device flags (0x0 all off
 #define SDW_SHIM_WAKEEN_ENABLE		BIT(0)
 #define SDW_SHIM_WAKESTS_STATUS		BIT(0)
 
+/*
+ * PDM oversampling ratios the DSP decimators support, preferred first.
+ * The PDM bit rate must divide the bus clock for the Data Port sample
+ * interval to be exact.
+ */
+static const unsigned int intel_pdm_ratios[] = { 50, 64, 48, 32 };
+
 /* Intel ALH Register definitions */
 #define SDW_ALH_STRMZCFG(x)		(0x000 + (0x4 * (x)))
 #define SDW_ALH_NUM_STREAMS		64
@@ -118,10 +126,14 @@ enum intel_pdi_type {
 	INTEL_PDI_BD = 2,
 };
 
+/* widest DP0 word used for Bulk transfers */
+#define INTEL_BPT_MAX_BPS		64
+
 struct sdw_intel {
 	struct sdw_cdns cdns;
 	int instance;
 	struct sdw_intel_link_res *link_res;
+	struct mutex bpt_lock; /* protect the Bulk PDIs */
 #ifdef CONFIG_DEBUG_FS
 	struct dentry *debugfs;
 #endif
@@ -807,6 +819,135 @@ static int intel_free_stream(struct sdw_intel *sdw,
 	return 0;
 }
 
+/*
+ * Bulk Payload Transport
+ *
+ * The BRA packets are carried by a stream between PDI0/PDI1 and the
+ * Slave Data Port 0, with the DMA handled by the audio driver.
+ */
+static int intel_bpt_stream_run(struct sdw_intel *sdw,
+				struct sdw_stream_runtime *stream,
+				struct sdw_intel_bpt_data *data)
+{
+	struct sdw_intel_link_res *res = sdw->link_res;
+	int ret, ret2;
+
+	ret = sdw_prepare_stream(stream);
+	if (ret < 0)
+		return ret;
+
+	ret = sdw_enable_stream(stream);
+	if (ret < 0)
+		goto deprepare;
+
+	ret = res->ops->bpt_xfer(res->dev, data);
+
+	ret2 = sdw_disable_stream(stream);
+	if (!ret)
+		ret = ret2;
+deprepare:
+	ret2 = sdw_deprepare_stream(stream);
+	if (!ret)
+		ret = ret2;
+
+	return ret;
+}
+
+static int intel_bpt_xfer(struct sdw_bus *bus, struct sdw_slave *slave,
+			  struct sdw_bpt_msg *msg)
+{
+	struct sdw_cdns *cdns = bus_to_cdns(bus);
+	struct sdw_intel *sdw = cdns_to_intel(cdns);
+	struct sdw_intel_link_res *res = sdw->link_res;
+	struct sdw_dp0_prop *dp0 = slave->prop.dp0_prop;
+	struct sdw_stream_config sconfig = {0};
+	struct sdw_port_config pconfig = {0};
+	struct sdw_cdns_pdi *tx_pdi, *rx_pdi;
+	struct sdw_stream_runtime *stream;
+	struct sdw_intel_bpt_data data;
+	u8 *tx, *rx;
+	int ret;
+
+	if (!res->ops || !res->ops->bpt_xfer || !res->dev)
+		return -EOPNOTSUPP;
+
+	sdw_cdns_bpt_size(msg, &data.tx_len, &data.rx_len);
+	tx = kzalloc(data.tx_len, GFP_KERNEL);
+	rx = kzalloc(data.rx_len, GFP_KERNEL);
+	if (!tx || !rx) {
+		ret = -ENOMEM;
+		goto free;
+	}
+
+	sdw_cdns_bpt_format(msg, tx);
+
+	stream = sdw_alloc_stream("BPT");
+	if (!stream) {
+		ret = -ENOMEM;
+		goto free;
+	}
+
+	mutex_lock(&sdw->bpt_lock);
+
+	tx_pdi = sdw_cdns_bpt_pdi(cdns, SDW_DATA_DIR_TX);
+	rx_pdi = sdw_cdns_bpt_pdi(cdns, SDW_DATA_DIR_RX);
+	if (!tx_pdi || !rx_pdi) {
+		ret = -EOPNOTSUPP;
+		goto unlock;
+	}
+
+	intel_pdi_shim_configure(sdw, tx_pdi);
+	intel_pdi_alh_configure(sdw, tx_pdi);
+	sdw_cdns_config_stream(cdns, 1, SDW_DATA_DIR_TX, tx_pdi);
+
+	intel_pdi_shim_configure(sdw, rx_pdi);
+	intel_pdi_alh_configure(sdw, rx_pdi);
+	sdw_cdns_config_stream(cdns, 1, SDW_DATA_DIR_RX, rx_pdi);
+
+	/* one DP0 word per frame, as wide as the Slave supports */
+	sconfig.frame_rate = bus->params.curr_dr_freq /
+			     (bus->params.row * bus->params.col);
+	sconfig.ch_count = 1;
+	sconfig.bps = INTEL_BPT_MAX_BPS;
+	if (dp0->max_word)
+		sconfig.bps = min_t(u32, dp0->max_word, INTEL_BPT_MAX_BPS);
+	sconfig.type = SDW_STREAM_BPT;
+	pconfig.ch_mask = 0x1;
+
+	sconfig.direction = SDW_DATA_DIR_TX;
+	pconfig.num = tx_pdi->num;
+	ret = sdw_stream_add_master(bus, &sconfig, &pconfig, 1, stream);
+	if (ret < 0)
+		goto unlock;
+
+	sconfig.direction = SDW_DATA_DIR_RX;
+	pconfig.num = 0;
+	ret = sdw_stream_add_slave(slave, &sconfig, &pconfig, 1, stream);
+	if (ret < 0)
+		goto remove_master;
+
+	data.link_id = sdw->instance;
+	data.tx_alh_id = tx_pdi->intel_alh_id;
+	data.rx_alh_id = rx_pdi->intel_alh_id;
+	data.tx = tx;
+	data.rx = rx;
+
+	ret = intel_bpt_stream_run(sdw, stream, &data);
+	if (!ret)
+		ret = sdw_cdns_bpt_parse(cdns, msg, rx);
+
+	sdw_stream_remove_slave(slave, stream);
+remove_master:
+	sdw_stream_remove_master(bus, stream);
+unlock:
+	mutex_unlock(&sdw->bpt_lock);
+	sdw_release_stream(stream);
+free:
+	kfree(rx);
+	kfree(tx);
+	return ret;
+}
+
 /*
  * bank switch routines
  */
@@ -885,6 +1026,21 @@ static int intel_startup(struct snd_pcm_substream *substream,
 	return 0;
 }
 
+static unsigned int intel_pdm_frame_rate(struct sdw_cdns *cdns,
+					 unsigned int rate)
+{
+	unsigned int max_freq = cdns->bus.prop.max_clk_freq;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(intel_pdm_ratios); i++) {
+		if (!(max_freq % (rate * intel_pdm_ratios[i])))
+			return rate * intel_pdm_ratios[i];
+	}
+
+	/* no exact match, sdw_prepare_stream() will reject it */
+	return rate * intel_pdm_ratios[0];
+}
+
 static int intel_hw_params(struct snd_pcm_substream *substream,
 			   struct snd_pcm_hw_params *params,
 			   struct snd_soc_dai *dai)
@@ -945,7 +1101,8 @@ static int intel_hw_params(struct snd_pcm_substream *substream,
 	sconfig.type = dma->stream_type;
 
 	if (dma->stream_type == SDW_STREAM_PDM) {
-		sconfig.frame_rate *= 50;
+		sconfig.frame_rate = intel_pdm_frame_rate(cdns,
+							  sconfig.frame_rate);
 		sconfig.bps = 1;
 	} else {
 		sconfig.bps = snd_pcm_format_width(params_format(params));
@@ -991,6 +1148,16 @@ static int intel_prepare(struct snd_pcm_substream *substream,
 
 		dma->suspended = false;
 
+		/*
+		 * the link stayed in clock stop without reset, the
+		 * SHIM/ALH/Cadence IP and the DSP kept the stream
+		 */
+		if (sdw_stream_ctx_retained(dma->stream)) {
+			dev_dbg(dai->dev, "%s: stream context retained\n",
+				dma->stream->name);
+			goto prepare;
+		}
+
 		/*
 		 * .prepare() is called after system resume, where we
 		 * need to reinitialize the SHIM/ALH/Cadence IP.
@@ -1019,6 +1186,7 @@ static int intel_prepare(struct snd_pcm_substream *substream,
 			goto err;
 	}
 
+prepare:
 	ret = sdw_prepare_stream(dma->stream);
 
 err:
@@ -1333,11 +1501,13 @@ static int intel_prop_read(struct sdw_bus *bus)
 static struct sdw_master_ops sdw_intel_ops = {
 	.read_prop = sdw_master_read_prop,
 	.xfer_msg = cdns_xfer_msg,
+	.xfer_msg_batch = cdns_xfer_msg_batch,
 	.xfer_msg_defer = cdns_xfer_msg_defer,
 	.reset_page_addr = cdns_reset_page_addr,
 	.set_bus_conf = cdns_bus_conf,
 	.pre_bank_switch = intel_pre_bank_switch,
 	.post_bank_switch = intel_post_bank_switch,
+	.bpt_xfer = intel_bpt_xfer,
 };
 
 static int intel_init(struct sdw_intel *sdw)
@@ -1375,6 +1545,7 @@ static int intel_master_probe(struct sdw_master_device *md, void *link_ctx)
 	sdw->cdns.bus.dev = &md->dev;
 	sdw->cdns.bus.link_id = md->link_id;
 	sdw->link_res->cdns = &sdw->cdns;
+	mutex_init(&sdw->bpt_lock);
 
 	sdw_cdns_probe(&sdw->cdns);
 
@@ -1793,6 +1964,8 @@ static int intel_resume(struct device *dev)
 		return ret;
 	}
 
+	sdw_bus_ctx_lost(&cdns->bus);
+
 	/*
 	 * make sure all Slaves are tagged as UNATTACHED and provide
 	 * reason for reinitialization
@@ -1854,6 +2027,7 @@ static int intel_resume_runtime(struct device *dev)
 	struct sdw_intel *sdw = cdns_to_intel(cdns);
 	u32 clock_stop_quirks;
 	bool clock_stop0;
+	bool bus_reset;
 	int link_flags;
 	bool multi_link;
 	int status;
@@ -1877,6 +2051,8 @@ static int intel_resume_runtime(struct device *dev)
 			return ret;
 		}
 
+		sdw_bus_ctx_lost(&cdns->bus);
+
 		/*
 		 * make sure all Slaves are tagged as UNATTACHED and
 		 * provide reason for reinitialization
@@ -1932,7 +2108,22 @@ static int intel_resume_runtime(struct device *dev)
 		 */
 		clock_stop0 = sdw_cdns_is_clock_stop(&sdw->cdns);
 
-		if (!clock_stop0) {
+		/*
+		 * Slaves in Clock Stop Mode 0 keep their context even if
+		 * the Master lost its own, in that case only the IP is
+		 * re-initialized and the bus is not reset.
+		 */
+		bus_reset = !clock_stop0;
+		if (bus_reset &&
+		    clock_stop_quirks & SDW_INTEL_CLK_STOP_FAST_EXIT &&
+		    sdw_bus_clk_stop_retains_ctx(&cdns->bus))
+			bus_reset = false;
+
+		/* the IP is re-initialized below */
+		if (!clock_stop0)
+			sdw_bus_ctx_lost(&cdns->bus);
+
+		if (bus_reset) {
 
 			/*
 			 * make sure all Slaves are tagged as UNATTACHED and
@@ -1966,15 +2157,20 @@ static int intel_resume_runtime(struct device *dev)
 				dev_err(dev, "cannot enable interrupts during resume\n");
 				return ret;
 			}
+
+			if (!clock_stop0) {
+				dev_dbg(dev, "Slaves kept context, skipping bus reset\n");
+				sdw_cdns_init(&sdw->cdns);
+			}
 		}
 
-		ret = sdw_cdns_clock_restart(cdns, !clock_stop0);
+		ret = sdw_cdns_clock_restart(cdns, bus_reset);
 		if (ret < 0) {
 			dev_err(dev, "unable to restart clock during resume\n");
 			return ret;
 		}
 
-		if (!clock_stop0) {
+		if (bus_reset) {
 			ret = sdw_cdns_exit_reset(cdns);
 			if (ret < 0) {
 				dev_err(dev, "unable to exit bus reset sequence during resume\n");
@@ -1992,10 +2188,12 @@ static int intel_resume_runtime(struct device *dev)
 	} else if (!clock_stop_quirks) {
 
 		clock_stop0 = sdw_cdns_is_clock_stop(&sdw->cdns);
-		if (!clock_stop0)
+		if (!clock_stop0) {
 			dev_err(dev,
 				"%s invalid configuration, clock was not stopped",
 				__func__);
+			sdw_bus_ctx_lost(&cdns->bus);
+		}
 
 		ret = intel_init(sdw);
 		if (ret) {
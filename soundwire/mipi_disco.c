@@ -136,7 +136,7 @@ static int sdw_slave_read_dp0(struct sdw_slave *slave,
 	if (nval > 0) {
 
 		dp0->num_words = nval;
-		dp0->words = devm_kcalloc(&slave->dev,
+		dp0->words = devm_kcalloc(slave->bus->dev,
 					  dp0->num_words, sizeof(*dp0->words),
 					  GFP_KERNEL);
 		if (!dp0->words)
@@ -193,7 +193,7 @@ static int sdw_slave_read_dpn(struct sdw_slave *slave,
 		nval = fwnode_property_count_u32(node, "mipi-sdw-port-wordlength-configs");
 		if (nval > 0) {
 			dpn[i].num_words = nval;
-			dpn[i].words = devm_kcalloc(&slave->dev,
+			dpn[i].words = devm_kcalloc(slave->bus->dev,
 						    dpn[i].num_words,
 						    sizeof(*dpn[i].words),
 						    GFP_KERNEL);
@@ -232,7 +232,7 @@ static int sdw_slave_read_dpn(struct sdw_slave *slave,
 		nval = fwnode_property_count_u32(node, "mipi-sdw-channel-number-list");
 		if (nval > 0) {
 			dpn[i].num_ch = nval;
-			dpn[i].ch = devm_kcalloc(&slave->dev, dpn[i].num_ch,
+			dpn[i].ch = devm_kcalloc(slave->bus->dev, dpn[i].num_ch,
 						 sizeof(*dpn[i].ch),
 						 GFP_KERNEL);
 			if (!dpn[i].ch)
@@ -246,7 +246,7 @@ static int sdw_slave_read_dpn(struct sdw_slave *slave,
 		nval = fwnode_property_count_u32(node, "mipi-sdw-channel-combination-list");
 		if (nval > 0) {
 			dpn[i].num_ch_combinations = nval;
-			dpn[i].ch_combinations = devm_kcalloc(&slave->dev,
+			dpn[i].ch_combinations = devm_kcalloc(slave->bus->dev,
 					dpn[i].num_ch_combinations,
 					sizeof(*dpn[i].ch_combinations),
 					GFP_KERNEL);
@@ -271,6 +271,21 @@ static int sdw_slave_read_dpn(struct sdw_slave *slave,
 		fwnode_property_read_u32(node, "mipi-sdw-port-encoding-type",
 					 &dpn[i].port_encoding);
 
+		nval = fwnode_property_count_u32(node, "mipi-sdw-lane-list");
+		if (nval > 0) {
+			u32 lanes[SDW_MAX_LANES];
+			int j;
+
+			nval = min(nval, SDW_MAX_LANES);
+			fwnode_property_read_u32_array(node,
+					"mipi-sdw-lane-list", lanes, nval);
+
+			for (j = 0; j < nval; j++) {
+				if (lanes[j] < SDW_MAX_LANES)
+					dpn[i].lanes |= BIT(lanes[j]);
+			}
+		}
+
 		/* TODO: Read audio mode */
 
 		i++;
@@ -282,13 +297,22 @@ static int sdw_slave_read_dpn(struct sdw_slave *slave,
 /**
  * sdw_slave_read_prop() - Read Slave properties
  * @slave: SDW Slave
+ *
+ * The firmware properties are only parsed the first time, and kept
+ * with the bus for the following probes of the Slave, e.g. after a
+ * driver rebind.
  */
 int sdw_slave_read_prop(struct sdw_slave *slave)
 {
 	struct sdw_slave_prop *prop = &slave->prop;
 	struct device *dev = &slave->dev;
 	struct fwnode_handle *port;
-	int num_of_ports, nval, i, dp0 = 0;
+	int num_of_ports, nval, i;
+
+	if (slave->disco_prop) {
+		*prop = *slave->disco_prop;
+		goto port_ready;
+	}
 
 	device_property_read_u32(dev, "mipi-sdw-sw-interface-revision",
 				 &prop->mipi_revision);
@@ -344,14 +368,13 @@ int sdw_slave_read_prop(struct sdw_slave *slave)
 	if (!port) {
 		dev_dbg(dev, "DP0 node not found!!\n");
 	} else {
-		prop->dp0_prop = devm_kzalloc(&slave->dev,
+		prop->dp0_prop = devm_kzalloc(slave->bus->dev,
 					      sizeof(*prop->dp0_prop),
 					      GFP_KERNEL);
 		if (!prop->dp0_prop)
 			return -ENOMEM;
 
 		sdw_slave_read_dp0(slave, port, prop->dp0_prop);
-		dp0 = 1;
 	}
 
 	/*
@@ -361,7 +384,7 @@ int sdw_slave_read_prop(struct sdw_slave *slave)
 
 	/* Allocate memory for set bits in port lists */
 	nval = hweight32(prop->source_ports);
-	prop->src_dpn_prop = devm_kcalloc(&slave->dev, nval,
+	prop->src_dpn_prop = devm_kcalloc(slave->bus->dev, nval,
 					  sizeof(*prop->src_dpn_prop),
 					  GFP_KERNEL);
 	if (!prop->src_dpn_prop)
@@ -372,7 +395,7 @@ int sdw_slave_read_prop(struct sdw_slave *slave)
 			   prop->source_ports, "source");
 
 	nval = hweight32(prop->sink_ports);
-	prop->sink_dpn_prop = devm_kcalloc(&slave->dev, nval,
+	prop->sink_dpn_prop = devm_kcalloc(slave->bus->dev, nval,
 					   sizeof(*prop->sink_dpn_prop),
 					   GFP_KERNEL);
 	if (!prop->sink_dpn_prop)
@@ -382,9 +405,15 @@ int sdw_slave_read_prop(struct sdw_slave *slave)
 	sdw_slave_read_dpn(slave, prop->sink_dpn_prop, nval,
 			   prop->sink_ports, "sink");
 
+	slave->disco_prop = devm_kmemdup(slave->bus->dev, prop, sizeof(*prop),
+					 GFP_KERNEL);
+	if (!slave->disco_prop)
+		return -ENOMEM;
+
+port_ready:
 	/* some ports are bidirectional so check total ports by ORing */
 	nval = prop->source_ports | prop->sink_ports;
-	num_of_ports = hweight32(nval) + dp0; /* add DP0 */
+	num_of_ports = hweight32(nval) + !!prop->dp0_prop; /* add DP0 */
 
 	/* Allocate port_ready based on num_of_ports */
 	slave->port_ready = devm_kcalloc(&slave->dev, num_of_ports,
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: GPL-2.0
 // Copyright (c) 2019, Linaro Limited
 
+#include <linux/bitfield.h>
 #include <linux/clk.h>
 #include <linux/completion.h>
 #include <linux/interrupt.h>
@@ -26,6 +27,8 @@
 #define SWRM_COMP_PARAMS					0x100
 #define SWRM_COMP_PARAMS_DOUT_PORTS_MASK			GENMASK(4, 0)
 #define SWRM_COMP_PARAMS_DIN_PORTS_MASK				GENMASK(9, 5)
+#define SWRM_COMP_PARAMS_WR_FIFO_DEPTH				GENMASK(14, 10)
+#define SWRM_COMP_PARAMS_RD_FIFO_DEPTH				GENMASK(19, 15)
 #define SWRM_INTERRUPT_STATUS					0x200
 #define SWRM_INTERRUPT_STATUS_RMSK				GENMASK(16, 0)
 #define SWRM_INTERRUPT_STATUS_NEW_SLAVE_ATTACHED		BIT(1)
@@ -37,10 +40,12 @@
 #define SWRM_CMD_FIFO_WR_CMD					0x300
 #define SWRM_CMD_FIFO_RD_CMD					0x304
 #define SWRM_CMD_FIFO_CMD					0x308
+#define SWRM_CMD_FIFO_FLUSH					0x1
 #define SWRM_CMD_FIFO_STATUS					0x30C
 #define SWRM_CMD_FIFO_CFG_ADDR					0x314
 #define SWRM_RD_WR_CMD_RETRIES					0x7
 #define SWRM_CMD_FIFO_RD_FIFO_ADDR				0x318
+#define SWRM_RD_FIFO_CMD_ID_MASK				GENMASK(11, 8)
 #define SWRM_ENUMERATOR_CFG_ADDR				0x500
 #define SWRM_MCP_FRAME_CTRL_BANK_ADDR(m)		(0x101C + 0x40 * (m))
 #define SWRM_MCP_FRAME_CTRL_BANK_ROW_CTRL_SHFT			3
@@ -64,8 +69,10 @@
 #define SWRM_AHB_BRIDGE_RD_ADDR_0				0xc8d
 #define SWRM_AHB_BRIDGE_RD_DATA_0				0xc91
 
+#define SWRM_CMD_ID_SHFT	16
 #define SWRM_REG_VAL_PACK(data, dev, id, reg)	\
-			((reg) | ((id) << 16) | ((dev) << 20) | ((data) << 24))
+			((reg) | ((id) << SWRM_CMD_ID_SHFT) | ((dev) << 20) | \
+			 ((data) << 24))
 
 #define SWRM_MAX_ROW_VAL	0 /* Rows = 48 */
 #define SWRM_DEFAULT_ROWS	48
@@ -79,6 +86,7 @@
 #define QCOM_SDW_MAX_PORTS	14
 #define DEFAULT_CLK_FREQ	9600000
 #define SWRM_MAX_DAIS		0xF
+#define SWRM_MAX_FIFO_DEPTH	32
 
 struct qcom_swrm_port_config {
 	u8 si;
@@ -86,6 +94,36 @@ struct qcom_swrm_port_config {
 	u8 off2;
 };
 
+/**
+ * struct qcom_swrm_cmd - command queued in a command FIFO
+ *
+ * @val: packed command, without the command ID
+ * @id: command ID, matched against the read FIFO responses
+ * @len: number of bytes read, 0 for writes
+ * @rval: buffer for the bytes read
+ */
+struct qcom_swrm_cmd {
+	u32 val;
+	u8 id;
+	u8 len;
+	u8 *rval;
+};
+
+/**
+ * struct qcom_swrm_batch - commands sent with a single completion wait
+ *
+ * @cmd: queued commands
+ * @count: number of queued commands
+ * @rd_len: number of bytes the queued read commands return
+ * @read: commands are queued in the read command FIFO
+ */
+struct qcom_swrm_batch {
+	struct qcom_swrm_cmd cmd[SWRM_MAX_FIFO_DEPTH];
+	int count;
+	int rd_len;
+	bool read;
+};
+
 struct qcom_swrm_ctrl {
 	struct sdw_bus bus;
 	struct device *dev;
@@ -99,6 +137,11 @@ struct qcom_swrm_ctrl {
 	struct clk *hclk;
 	u8 wr_cmd_id;
 	u8 rd_cmd_id;
+	int wr_fifo_depth;
+	int rd_fifo_depth;
+	bool cmd_err;
+	struct sdw_defer *defer;
+	struct qcom_swrm_batch defer_batch;
 	int irq;
 	unsigned int version;
 	int num_din_ports;
@@ -154,77 +197,239 @@ static int qcom_swrm_ahb_reg_write(struct qcom_swrm_ctrl *ctrl,
 	return SDW_CMD_OK;
 }
 
-static int qcom_swrm_cmd_fifo_wr_cmd(struct qcom_swrm_ctrl *ctrl, u8 cmd_data,
-				     u8 dev_addr, u16 reg_addr)
+static u8 qcom_swrm_next_cmd_id(u8 *cmd_id)
+{
+	u8 id = *cmd_id;
+
+	/* the special ID is reserved for the last command of a batch */
+	*cmd_id = (id + 1) % SWRM_SPECIAL_CMD_ID;
+
+	return id;
+}
+
+/*
+ * Queue the commands of a batch in the command FIFOs, only the last one
+ * uses the special ID which raises an interrupt once it is executed.
+ */
+static int qcom_swrm_batch_push(struct qcom_swrm_ctrl *ctrl,
+				struct qcom_swrm_batch *batch)
+{
+	struct qcom_swrm_cmd *cmd;
+	int reg, ret, i;
+
+	reg = batch->read ? SWRM_CMD_FIFO_RD_CMD : SWRM_CMD_FIFO_WR_CMD;
+
+	for (i = 0; i < batch->count; i++) {
+		cmd = &batch->cmd[i];
+
+		if (i == batch->count - 1)
+			cmd->id = SWRM_SPECIAL_CMD_ID;
+		else if (batch->read)
+			cmd->id = qcom_swrm_next_cmd_id(&ctrl->rd_cmd_id);
+		else
+			cmd->id = qcom_swrm_next_cmd_id(&ctrl->wr_cmd_id);
+
+		ret = ctrl->reg_write(ctrl, reg, cmd->val |
+				      cmd->id << SWRM_CMD_ID_SHFT);
+		if (ret)
+			return ret;
+	}
+
+	return SDW_CMD_OK;
+}
+
+/*
+ * Read the responses of the read commands of a batch, the read FIFO
+ * reports the ID of the command each byte was read by.
+ */
+static enum sdw_command_response
+qcom_swrm_batch_drain(struct qcom_swrm_ctrl *ctrl,
+		      struct qcom_swrm_batch *batch)
+{
+	struct qcom_swrm_cmd *cmd;
+	int i, j;
+	u32 val;
+	u8 id;
+
+	if (!batch->read)
+		return SDW_CMD_OK;
+
+	for (i = 0; i < batch->count; i++) {
+		cmd = &batch->cmd[i];
+
+		for (j = 0; j < cmd->len; j++) {
+			ctrl->reg_read(ctrl, SWRM_CMD_FIFO_RD_FIFO_ADDR, &val);
+
+			id = FIELD_GET(SWRM_RD_FIFO_CMD_ID_MASK, val);
+			if (id != cmd->id) {
+				dev_err_ratelimited(ctrl->dev,
+						    "read response id %u, expected %u\n",
+						    id, cmd->id);
+				ctrl->reg_write(ctrl, SWRM_CMD_FIFO_CMD,
+						SWRM_CMD_FIFO_FLUSH);
+				return SDW_CMD_FAIL_OTHER;
+			}
+
+			cmd->rval[j] = val & 0xFF;
+		}
+	}
+
+	return SDW_CMD_OK;
+}
+
+/* Push a batch and wait once for all its commands */
+static enum sdw_command_response
+qcom_swrm_batch_flush(struct qcom_swrm_ctrl *ctrl,
+		      struct qcom_swrm_batch *batch)
 {
 	DECLARE_COMPLETION_ONSTACK(comp);
 	unsigned long flags;
-	u32 val;
+	bool cmd_err;
 	int ret;
 
+	if (!batch->count)
+		return SDW_CMD_OK;
+
 	spin_lock_irqsave(&ctrl->comp_lock, flags);
 	ctrl->comp = &comp;
+	ctrl->cmd_err = false;
 	spin_unlock_irqrestore(&ctrl->comp_lock, flags);
-	val = SWRM_REG_VAL_PACK(cmd_data, dev_addr,
-				SWRM_SPECIAL_CMD_ID, reg_addr);
-	ret = ctrl->reg_write(ctrl, SWRM_CMD_FIFO_WR_CMD, val);
+
+	ret = qcom_swrm_batch_push(ctrl, batch);
 	if (ret)
 		goto err;
 
 	ret = wait_for_completion_timeout(ctrl->comp,
 					  msecs_to_jiffies(TIMEOUT_MS));
 
-	if (!ret)
+	spin_lock_irqsave(&ctrl->comp_lock, flags);
+	cmd_err = ctrl->cmd_err;
+	spin_unlock_irqrestore(&ctrl->comp_lock, flags);
+
+	if (!ret || cmd_err) {
+		/* drop whatever is left of the batch */
+		if (!ret)
+			ctrl->reg_write(ctrl, SWRM_CMD_FIFO_CMD,
+					SWRM_CMD_FIFO_FLUSH);
 		ret = SDW_CMD_IGNORED;
-	else
-		ret = SDW_CMD_OK;
+	} else {
+		ret = qcom_swrm_batch_drain(ctrl, batch);
+	}
+
 err:
 	spin_lock_irqsave(&ctrl->comp_lock, flags);
 	ctrl->comp = NULL;
 	spin_unlock_irqrestore(&ctrl->comp_lock, flags);
 
+	batch->count = 0;
+	batch->rd_len = 0;
+
 	return ret;
 }
 
-static int qcom_swrm_cmd_fifo_rd_cmd(struct qcom_swrm_ctrl *ctrl,
-				     u8 dev_addr, u16 reg_addr,
-				     u32 len, u8 *rval)
+/*
+ * Add a command to a batch, the batch is flushed first when the command
+ * goes to the other FIFO or would not fit in the hardware FIFOs.
+ */
+static enum sdw_command_response
+qcom_swrm_batch_add(struct qcom_swrm_ctrl *ctrl, struct qcom_swrm_batch *batch,
+		    bool read, u32 val, u8 len, u8 *rval)
+{
+	int depth = read ? ctrl->rd_fifo_depth : ctrl->wr_fifo_depth;
+	struct qcom_swrm_cmd *cmd;
+	int ret;
+
+	if (batch->count &&
+	    (batch->read != read || batch->count == depth ||
+	     batch->rd_len + len > ctrl->rd_fifo_depth)) {
+		ret = qcom_swrm_batch_flush(ctrl, batch);
+		if (ret)
+			return ret;
+	}
+
+	cmd = &batch->cmd[batch->count++];
+	cmd->val = val;
+	cmd->len = len;
+	cmd->rval = rval;
+
+	batch->read = read;
+	batch->rd_len += len;
+
+	return SDW_CMD_OK;
+}
+
+static enum sdw_command_response
+qcom_swrm_batch_add_msg(struct qcom_swrm_ctrl *ctrl,
+			struct qcom_swrm_batch *batch, struct sdw_msg *msg)
 {
-	int i, ret;
+	int ret, i, len, max_len;
 	u32 val;
-	DECLARE_COMPLETION_ONSTACK(comp);
-	unsigned long flags;
 
-	spin_lock_irqsave(&ctrl->comp_lock, flags);
-	ctrl->comp = &comp;
-	spin_unlock_irqrestore(&ctrl->comp_lock, flags);
+	if (msg->page) {
+		ret = qcom_swrm_batch_add(ctrl, batch, false,
+					  SWRM_REG_VAL_PACK(msg->addr_page1,
+							    msg->dev_num, 0,
+							    SDW_SCP_ADDRPAGE1),
+					  0, NULL);
+		if (ret)
+			return ret;
 
-	val = SWRM_REG_VAL_PACK(len, dev_addr, SWRM_SPECIAL_CMD_ID, reg_addr);
-	ret = ctrl->reg_write(ctrl, SWRM_CMD_FIFO_RD_CMD, val);
-	if (ret)
-		goto err;
+		ret = qcom_swrm_batch_add(ctrl, batch, false,
+					  SWRM_REG_VAL_PACK(msg->addr_page2,
+							    msg->dev_num, 0,
+							    SDW_SCP_ADDRPAGE2),
+					  0, NULL);
+		if (ret)
+			return ret;
+	}
 
-	ret = wait_for_completion_timeout(ctrl->comp,
-					  msecs_to_jiffies(TIMEOUT_MS));
+	if (msg->flags == SDW_MSG_FLAG_READ) {
+		max_len = min(QCOM_SWRM_MAX_RD_LEN, ctrl->rd_fifo_depth);
 
-	if (!ret) {
-		ret = SDW_CMD_IGNORED;
-		goto err;
+		for (i = 0; i < msg->len; i += len) {
+			len = min_t(int, msg->len - i, max_len);
+
+			val = SWRM_REG_VAL_PACK(len, msg->dev_num, 0,
+						msg->addr + i);
+			ret = qcom_swrm_batch_add(ctrl, batch, true, val, len,
+						  &msg->buf[i]);
+			if (ret)
+				return ret;
+		}
+	} else if (msg->flags == SDW_MSG_FLAG_WRITE) {
+		for (i = 0; i < msg->len; i++) {
+			val = SWRM_REG_VAL_PACK(msg->buf[i], msg->dev_num, 0,
+						msg->addr + i);
+			ret = qcom_swrm_batch_add(ctrl, batch, false, val, 0,
+						  NULL);
+			if (ret)
+				return ret;
+		}
 	} else {
-		ret = SDW_CMD_OK;
+		dev_err(ctrl->dev, "Invalid msg cmd: %d\n", msg->flags);
+		return SDW_CMD_FAIL_OTHER;
 	}
 
-	for (i = 0; i < len; i++) {
-		ctrl->reg_read(ctrl, SWRM_CMD_FIFO_RD_FIFO_ADDR, &val);
-		rval[i] = val & 0xFF;
-	}
+	return SDW_CMD_OK;
+}
 
-err:
-	spin_lock_irqsave(&ctrl->comp_lock, flags);
-	ctrl->comp = NULL;
-	spin_unlock_irqrestore(&ctrl->comp_lock, flags);
+/* Complete a deferred message once its batch is done, in the IRQ thread */
+static void qcom_swrm_defer_done(struct qcom_swrm_ctrl *ctrl,
+				 struct sdw_defer *defer, bool cmd_err)
+{
+	struct qcom_swrm_batch *batch = &ctrl->defer_batch;
 
-	return ret;
+	if (cmd_err)
+		dev_err_ratelimited(ctrl->dev,
+				    "Deferred msg to Slave %d failed\n",
+				    defer->msg->dev_num);
+	else
+		qcom_swrm_batch_drain(ctrl, batch);
+
+	batch->count = 0;
+	batch->rd_len = 0;
+
+	complete(&defer->complete);
 }
 
 static void qcom_swrm_get_device_status(struct qcom_swrm_ctrl *ctrl)
@@ -246,8 +451,10 @@ static void qcom_swrm_get_device_status(struct qcom_swrm_ctrl *ctrl)
 static irqreturn_t qcom_swrm_irq_handler(int irq, void *dev_id)
 {
 	struct qcom_swrm_ctrl *ctrl = dev_id;
+	struct sdw_defer *defer;
 	u32 sts, value;
 	unsigned long flags;
+	bool cmd_err;
 
 	ctrl->reg_read(ctrl, SWRM_INTERRUPT_STATUS, &sts);
 
@@ -256,7 +463,7 @@ static irqreturn_t qcom_swrm_irq_handler(int irq, void *dev_id)
 		dev_err_ratelimited(ctrl->dev,
 				    "CMD error, fifo status 0x%x\n",
 				     value);
-		ctrl->reg_write(ctrl, SWRM_CMD_FIFO_CMD, 0x1);
+		ctrl->reg_write(ctrl, SWRM_CMD_FIFO_CMD, SWRM_CMD_FIFO_FLUSH);
 	}
 
 	if ((sts & SWRM_INTERRUPT_STATUS_NEW_SLAVE_ATTACHED) ||
@@ -270,11 +477,22 @@ static irqreturn_t qcom_swrm_irq_handler(int irq, void *dev_id)
 	 */
 	ctrl->reg_write(ctrl, SWRM_INTERRUPT_CLEAR, sts);
 
-	if (sts & SWRM_INTERRUPT_STATUS_SPECIAL_CMD_ID_FINISHED) {
+	/* a command error flushes the FIFOs, the batch won't finish */
+	if (sts & (SWRM_INTERRUPT_STATUS_SPECIAL_CMD_ID_FINISHED |
+		   SWRM_INTERRUPT_STATUS_CMD_ERROR)) {
 		spin_lock_irqsave(&ctrl->comp_lock, flags);
+		if (sts & SWRM_INTERRUPT_STATUS_CMD_ERROR)
+			ctrl->cmd_err = true;
+		cmd_err = ctrl->cmd_err;
+		defer = ctrl->defer;
+		ctrl->defer = NULL;
 		if (ctrl->comp)
 			complete(ctrl->comp);
 		spin_unlock_irqrestore(&ctrl->comp_lock, flags);
+
+		/* register accesses may sleep, not done under the lock */
+		if (defer)
+			qcom_swrm_defer_done(ctrl, defer, cmd_err);
 	}
 
 	return IRQ_HANDLED;
@@ -317,34 +535,99 @@ static enum sdw_command_response qcom_swrm_xfer_msg(struct sdw_bus *bus,
 						    struct sdw_msg *msg)
 {
 	struct qcom_swrm_ctrl *ctrl = to_qcom_sdw(bus);
-	int ret, i, len;
+	struct qcom_swrm_batch batch = {};
+	int ret;
 
-	if (msg->flags == SDW_MSG_FLAG_READ) {
-		for (i = 0; i < msg->len;) {
-			if ((msg->len - i) < QCOM_SWRM_MAX_RD_LEN)
-				len = msg->len - i;
-			else
-				len = QCOM_SWRM_MAX_RD_LEN;
-
-			ret = qcom_swrm_cmd_fifo_rd_cmd(ctrl, msg->dev_num,
-							msg->addr + i, len,
-						       &msg->buf[i]);
-			if (ret)
-				return ret;
+	ret = qcom_swrm_batch_add_msg(ctrl, &batch, msg);
+	if (ret)
+		return ret;
 
-			i = i + len;
-		}
-	} else if (msg->flags == SDW_MSG_FLAG_WRITE) {
-		for (i = 0; i < msg->len; i++) {
-			ret = qcom_swrm_cmd_fifo_wr_cmd(ctrl, msg->buf[i],
-							msg->dev_num,
-						       msg->addr + i);
-			if (ret)
-				return SDW_CMD_IGNORED;
-		}
+	return qcom_swrm_batch_flush(ctrl, &batch);
+}
+
+/**
+ * qcom_swrm_xfer_msg_batch() - transfer several messages with batched
+ * FIFO fills
+ * @bus: SoundWire bus
+ * @msgs: array of messages
+ * @num: number of messages in @msgs
+ *
+ * Commands are queued up to the depth of the command FIFOs and a single
+ * completion is waited for per FIFO fill. The SCP_AddrPage registers of
+ * paged messages are programmed as part of the batch.
+ */
+static enum sdw_command_response
+qcom_swrm_xfer_msg_batch(struct sdw_bus *bus, struct sdw_msg *msgs, int num)
+{
+	struct qcom_swrm_ctrl *ctrl = to_qcom_sdw(bus);
+	struct qcom_swrm_batch batch = {};
+	int ret, i;
+
+	for (i = 0; i < num; i++) {
+		ret = qcom_swrm_batch_add_msg(ctrl, &batch, &msgs[i]);
+		if (ret)
+			return ret;
 	}
 
-	return SDW_CMD_OK;
+	return qcom_swrm_batch_flush(ctrl, &batch);
+}
+
+/* deferred messages need to be sent with a single FIFO fill */
+static bool qcom_swrm_msg_fits(struct qcom_swrm_ctrl *ctrl,
+			       struct sdw_msg *msg)
+{
+	if (msg->flags == SDW_MSG_FLAG_READ)
+		return !msg->page && msg->len <= ctrl->rd_fifo_depth;
+
+	return msg->len + (msg->page ? 2 : 0) <= ctrl->wr_fifo_depth;
+}
+
+static enum sdw_command_response
+qcom_swrm_xfer_msg_defer(struct sdw_bus *bus, struct sdw_msg *msg,
+			 struct sdw_defer *defer)
+{
+	struct qcom_swrm_ctrl *ctrl = to_qcom_sdw(bus);
+	struct qcom_swrm_batch *batch = &ctrl->defer_batch;
+	unsigned long flags;
+	int ret;
+
+	if (!qcom_swrm_msg_fits(ctrl, msg))
+		return -ENOTSUPP;
+
+	ret = qcom_swrm_batch_add_msg(ctrl, batch, msg);
+	if (ret)
+		return ret;
+
+	spin_lock_irqsave(&ctrl->comp_lock, flags);
+	ctrl->defer = defer;
+	ctrl->cmd_err = false;
+	spin_unlock_irqrestore(&ctrl->comp_lock, flags);
+
+	/* completed by the IRQ thread */
+	ret = qcom_swrm_batch_push(ctrl, batch);
+	if (ret) {
+		spin_lock_irqsave(&ctrl->comp_lock, flags);
+		ctrl->defer = NULL;
+		spin_unlock_irqrestore(&ctrl->comp_lock, flags);
+
+		batch->count = 0;
+		batch->rd_len = 0;
+	}
+
+	return ret;
+}
+
+static enum sdw_command_response
+qcom_swrm_reset_page_addr(struct sdw_bus *bus, unsigned int dev_num)
+{
+	struct sdw_msg msg = {
+		.dev_num = dev_num,
+		.flags = SDW_MSG_FLAG_WRITE,
+		.page = true,
+	};
+
+	/* a zero-length paged write only programs the page registers */
+	return qcom_swrm_xfer_msg(bus, &msg);
 }
 
 static int qcom_swrm_pre_bank_switch(struct sdw_bus *bus)
@@ -414,6 +697,9 @@ static struct sdw_master_port_ops qcom_swrm_port_ops = {
 
 static struct sdw_master_ops qcom_swrm_ops = {
 	.xfer_msg = qcom_swrm_xfer_msg,
+	.xfer_msg_batch = qcom_swrm_xfer_msg_batch,
+	.xfer_msg_defer = qcom_swrm_xfer_msg_defer,
+	.reset_page_addr = qcom_swrm_reset_page_addr,
 	.pre_bank_switch = qcom_swrm_pre_bank_switch,
 };
 
@@ -785,6 +1071,14 @@ static int qcom_swrm_probe(struct platform_device *pdev)
 	ctrl->bus.port_ops = &qcom_swrm_port_ops;
 	ctrl->bus.compute_params = &qcom_swrm_compute_params;
 
+	ctrl->reg_read(ctrl, SWRM_COMP_PARAMS, &val);
+	ctrl->wr_fifo_depth = clamp_t(int,
+				      FIELD_GET(SWRM_COMP_PARAMS_WR_FIFO_DEPTH,
+						val), 1, SWRM_MAX_FIFO_DEPTH);
+	ctrl->rd_fifo_depth = clamp_t(int,
+				      FIELD_GET(SWRM_COMP_PARAMS_RD_FIFO_DEPTH,
+						val), 1, SWRM_MAX_FIFO_DEPTH);
+
 	ret = qcom_swrm_get_port_config(ctrl);
 	if (ret)
 		return ret;
@@ -56,10 +56,11 @@ static int sdw_slave_add(struct sdw_bus *bus,
 	slave->dev_num = 0;
 	init_completion(&slave->probe_complete);
 	slave->probed = false;
+	INIT_WORK(&slave->attach_work, sdw_slave_attach_work);
 
-	mutex_lock(&bus->bus_lock);
+	mutex_lock(&bus->slave_lock);
 	list_add_tail(&slave->node, &bus->slaves);
-	mutex_unlock(&bus->bus_lock);
+	mutex_unlock(&bus->slave_lock);
 
 	ret = device_register(&slave->dev);
 	if (ret) {
@@ -69,9 +70,9 @@ static int sdw_slave_add(struct sdw_bus *bus,
 		 * On err, don't free but drop ref as this will be freed
 		 * when release method is invoked.
 		 */
-		mutex_lock(&bus->bus_lock);
+		mutex_lock(&bus->slave_lock);
 		list_del(&slave->node);
-		mutex_unlock(&bus->bus_lock);
+		mutex_unlock(&bus->slave_lock);
 		put_device(&slave->dev);
 	}
 	sdw_slave_debugfs_init(slave);
@@ -79,6 +80,20 @@ static int sdw_slave_add(struct sdw_bus *bus,
 	return ret;
 }
 
+/**
+ * sdw_bus_add_slave() - add a Slave which is not described in firmware
+ * @bus: SDW bus instance
+ * @id: Slave ID
+ *
+ * Only meaningful for buses with no_fw_slaves set, e.g. buses whose
+ * Slaves are simulated by the Master driver.
+ */
+int sdw_bus_add_slave(struct sdw_bus *bus, struct sdw_slave_id *id)
+{
+	return sdw_slave_add(bus, id, NULL);
+}
+EXPORT_SYMBOL(sdw_bus_add_slave);
+
 #if IS_ENABLED(CONFIG_ACPI)
 
 static bool find_slave(struct sdw_bus *bus,
@@ -8,6 +8,7 @@
 #include <linux/delay.h>
 #include <linux/device.h>
 #include <linux/init.h>
+#include <linux/ktime.h>
 #include <linux/module.h>
 #include <linux/mod_devicetable.h>
 #include <linux/slab.h>
@@ -17,6 +18,7 @@
 #include <dkms/sound/pcm.h>
 #include <dkms/sound/soc.h>
 #include "bus.h"
+#include "trace.h"
 
 /*
  * Array of supported rows and columns as per MIPI SoundWire Specification 1.1
@@ -60,68 +62,113 @@ int sdw_find_row_index(int row)
 }
 EXPORT_SYMBOL(sdw_find_row_index);
 
+/*
+ * The banked DPn registers, from DPN_BlockCtrl2 to DPN_LaneCtrl, are
+ * contiguous. They are assembled in a shadow copy and each contiguous
+ * run of registers to be written is sent with a single sdw_nwrite().
+ */
+#define SDW_DPN_BANK_BASE	SDW_DPN_BLOCKCTRL2_B0(0)
+#define SDW_DPN_BANK_REGS	(SDW_DPN_LANECTRL_B0(0) - SDW_DPN_BANK_BASE + 1)
+
+static void sdw_dpn_bank_set(u8 *val, unsigned long *mask, u32 reg, u8 value)
+{
+	int i = reg - SDW_DPN_BANK_BASE;
+
+	val[i] = value;
+	*mask |= BIT(i);
+}
+
+static int sdw_dpn_bank_flush(struct sdw_slave *slave, u32 addr, u8 *val,
+			      unsigned long mask)
+{
+	int start = 0, end, ret;
+
+	while (start < SDW_DPN_BANK_REGS) {
+		if (!(mask & BIT(start))) {
+			start++;
+			continue;
+		}
+
+		for (end = start; end < SDW_DPN_BANK_REGS; end++) {
+			if (!(mask & BIT(end)))
+				break;
+		}
+
+		ret = sdw_nwrite(slave, addr + start, end - start, &val[start]);
+		if (ret < 0)
+			return ret;
+
+		start = end;
+	}
+
+	return 0;
+}
+
 static int _sdw_program_slave_port_params(struct sdw_bus *bus,
 					  struct sdw_slave *slave,
 					  struct sdw_transport_params *t_params,
 					  enum sdw_dpn_type type)
 {
-	u32 addr1, addr2, addr3, addr4;
+	u8 val[SDW_DPN_BANK_REGS];
+	unsigned long mask = 0;
+	u32 addr;
+	u8 wbuf;
 	int ret;
-	u16 wbuf;
 
-	if (bus->params.next_bank) {
-		addr1 = SDW_DPN_OFFSETCTRL2_B1(t_params->port_num);
-		addr2 = SDW_DPN_BLOCKCTRL3_B1(t_params->port_num);
-		addr3 = SDW_DPN_SAMPLECTRL2_B1(t_params->port_num);
-		addr4 = SDW_DPN_HCTRL_B1(t_params->port_num);
-	} else {
-		addr1 = SDW_DPN_OFFSETCTRL2_B0(t_params->port_num);
-		addr2 = SDW_DPN_BLOCKCTRL3_B0(t_params->port_num);
-		addr3 = SDW_DPN_SAMPLECTRL2_B0(t_params->port_num);
-		addr4 = SDW_DPN_HCTRL_B0(t_params->port_num);
-	}
+	if (bus->params.next_bank)
+		addr = SDW_DPN_BLOCKCTRL2_B1(t_params->port_num);
+	else
+		addr = SDW_DPN_BLOCKCTRL2_B0(t_params->port_num);
 
-	/* Program DPN_OffsetCtrl2 registers */
-	ret = sdw_write(slave, addr1, t_params->offset2);
-	if (ret < 0) {
-		dev_err(bus->dev, "DPN_OffsetCtrl2 register write failed\n");
-		return ret;
-	}
+	/* DPN_BlockCtrl2 register */
+	if (t_params->blk_grp_ctrl_valid)
+		sdw_dpn_bank_set(val, &mask, SDW_DPN_BLOCKCTRL2_B0(0),
+				 t_params->blk_grp_ctrl);
 
-	/* Program DPN_BlockCtrl3 register */
-	ret = sdw_write(slave, addr2, t_params->blk_pkg_mode);
-	if (ret < 0) {
-		dev_err(bus->dev, "DPN_BlockCtrl3 register write failed\n");
-		return ret;
-	}
+	/* DPN_SampleCtrl1 register */
+	wbuf = (t_params->sample_interval - 1) & SDW_DPN_SAMPLECTRL_LOW;
+	sdw_dpn_bank_set(val, &mask, SDW_DPN_SAMPLECTRL1_B0(0), wbuf);
+
+	/* DPN_OffsetCtrl1 register */
+	sdw_dpn_bank_set(val, &mask, SDW_DPN_OFFSETCTRL1_B0(0),
+			 t_params->offset1);
+
+	/* DPN_LaneCtrl register */
+	if (slave->prop.lane_control_support)
+		sdw_dpn_bank_set(val, &mask, SDW_DPN_LANECTRL_B0(0),
+				 t_params->lane_ctrl);
 
 	/*
-	 * Data ports are FULL, SIMPLE and REDUCED. This function handles
-	 * FULL and REDUCED only and beyond this point only FULL is
-	 * handled, so bail out if we are not FULL data port type
+	 * Data ports are FULL, SIMPLE and REDUCED. OffsetCtrl2 and
+	 * BlockCtrl3 are only present for FULL and REDUCED, SampleCtrl2
+	 * and HCtrl for FULL only
 	 */
-	if (type != SDW_DPN_FULL)
-		return ret;
+	if (type != SDW_DPN_SIMPLE) {
+		sdw_dpn_bank_set(val, &mask, SDW_DPN_OFFSETCTRL2_B0(0),
+				 t_params->offset2);
+		/* DP0 has no BlockCtrl3 */
+		if (t_params->port_num)
+			sdw_dpn_bank_set(val, &mask, SDW_DPN_BLOCKCTRL3_B0(0),
+					 t_params->blk_pkg_mode);
+	}
 
-	/* Program DPN_SampleCtrl2 register */
-	wbuf = (t_params->sample_interval - 1);
-	wbuf &= SDW_DPN_SAMPLECTRL_HIGH;
-	wbuf >>= SDW_REG_SHIFT(SDW_DPN_SAMPLECTRL_HIGH);
+	if (type == SDW_DPN_FULL) {
+		wbuf = (t_params->sample_interval - 1);
+		wbuf &= SDW_DPN_SAMPLECTRL_HIGH;
+		wbuf >>= SDW_REG_SHIFT(SDW_DPN_SAMPLECTRL_HIGH);
+		sdw_dpn_bank_set(val, &mask, SDW_DPN_SAMPLECTRL2_B0(0), wbuf);
 
-	ret = sdw_write(slave, addr3, wbuf);
-	if (ret < 0) {
-		dev_err(bus->dev, "DPN_SampleCtrl2 register write failed\n");
-		return ret;
+		wbuf = t_params->hstart;
+		wbuf <<= SDW_REG_SHIFT(SDW_DPN_HCTRL_HSTART);
+		wbuf |= t_params->hstop;
+		sdw_dpn_bank_set(val, &mask, SDW_DPN_HCTRL_B0(0), wbuf);
 	}
 
-	/* Program DPN_HCtrl register */
-	wbuf = t_params->hstart;
-	wbuf <<= SDW_REG_SHIFT(SDW_DPN_HCTRL_HSTART);
-	wbuf |= t_params->hstop;
-
-	ret = sdw_write(slave, addr4, wbuf);
+	ret = sdw_dpn_bank_flush(slave, addr, val, mask);
 	if (ret < 0)
-		dev_err(bus->dev, "DPN_HCtrl register write failed\n");
+		dev_err(bus->dev,
+			"DPN bank registers write failed for port %d\n",
+			t_params->port_num);
 
 	return ret;
 }
@@ -132,9 +179,8 @@ static int sdw_program_slave_port_params(struct sdw_bus *bus,
 {
 	struct sdw_transport_params *t_params = &p_rt->transport_params;
 	struct sdw_port_params *p_params = &p_rt->port_params;
-	struct sdw_slave_prop *slave_prop = &s_rt->slave->prop;
-	u32 addr1, addr2, addr3, addr4, addr5, addr6;
 	struct sdw_dpn_prop *dpn_prop;
+	u32 addr1, addr2;
 	int ret;
 	u8 wbuf;
 
@@ -147,19 +193,6 @@ static int sdw_program_slave_port_params(struct sdw_bus *bus,
 	addr1 = SDW_DPN_PORTCTRL(t_params->port_num);
 	addr2 = SDW_DPN_BLOCKCTRL1(t_params->port_num);
 
-	if (bus->params.next_bank) {
-		addr3 = SDW_DPN_SAMPLECTRL1_B1(t_params->port_num);
-		addr4 = SDW_DPN_OFFSETCTRL1_B1(t_params->port_num);
-		addr5 = SDW_DPN_BLOCKCTRL2_B1(t_params->port_num);
-		addr6 = SDW_DPN_LANECTRL_B1(t_params->port_num);
-
-	} else {
-		addr3 = SDW_DPN_SAMPLECTRL1_B0(t_params->port_num);
-		addr4 = SDW_DPN_OFFSETCTRL1_B0(t_params->port_num);
-		addr5 = SDW_DPN_BLOCKCTRL2_B0(t_params->port_num);
-		addr6 = SDW_DPN_LANECTRL_B0(t_params->port_num);
-	}
-
 	/* Program DPN_PortCtrl register */
 	wbuf = p_params->data_mode << SDW_REG_SHIFT(SDW_DPN_PORTCTRL_DATAMODE);
 	wbuf |= p_params->flow_mode;
@@ -183,55 +216,13 @@ static int sdw_program_slave_port_params(struct sdw_bus *bus,
 		}
 	}
 
-	/* Program DPN_SampleCtrl1 register */
-	wbuf = (t_params->sample_interval - 1) & SDW_DPN_SAMPLECTRL_LOW;
-	ret = sdw_write(s_rt->slave, addr3, wbuf);
-	if (ret < 0) {
+	/* Program the banked transport registers */
+	ret = _sdw_program_slave_port_params(bus, s_rt->slave,
+					     t_params, dpn_prop->type);
+	if (ret < 0)
 		dev_err(&s_rt->slave->dev,
-			"DPN_SampleCtrl1 register write failed for port %d\n",
+			"Transport reg write failed for port: %d\n",
 			t_params->port_num);
-		return ret;
-	}
-
-	/* Program DPN_OffsetCtrl1 registers */
-	ret = sdw_write(s_rt->slave, addr4, t_params->offset1);
-	if (ret < 0) {
-		dev_err(&s_rt->slave->dev,
-			"DPN_OffsetCtrl1 register write failed for port %d\n",
-			t_params->port_num);
-		return ret;
-	}
-
-	/* Program DPN_BlockCtrl2 register*/
-	if (t_params->blk_grp_ctrl_valid) {
-		ret = sdw_write(s_rt->slave, addr5, t_params->blk_grp_ctrl);
-		if (ret < 0) {
-			dev_err(&s_rt->slave->dev,
-				"DPN_BlockCtrl2 reg write failed for port %d\n",
-				t_params->port_num);
-			return ret;
-		}
-	}
-
-	/* program DPN_LaneCtrl register */
-	if (slave_prop->lane_control_support) {
-		ret = sdw_write(s_rt->slave, addr6, t_params->lane_ctrl);
-		if (ret < 0) {
-			dev_err(&s_rt->slave->dev,
-				"DPN_LaneCtrl register write failed for port %d\n",
-				t_params->port_num);
-			return ret;
-		}
-	}
-
-	if (dpn_prop->type != SDW_DPN_SIMPLE) {
-		ret = _sdw_program_slave_port_params(bus, s_rt->slave,
-						     t_params, dpn_prop->type);
-		if (ret < 0)
-			dev_err(&s_rt->slave->dev,
-				"Transport reg write failed for port: %d\n",
-				t_params->port_num);
-	}
 
 	return ret;
 }
@@ -258,11 +249,73 @@ static int sdw_program_master_port_params(struct sdw_bus *bus,
 						  bus->params.next_bank);
 }
 
+/*
+ * Check if the parameters of a port are already programmed in the
+ * alternate bank, in which case the port registers don't need to be
+ * written again before the bank switch.
+ */
+static bool sdw_port_bank_is_current(struct sdw_bus *bus,
+				     struct sdw_port_runtime *p_rt)
+{
+	struct sdw_port_bank_params *bank = &p_rt->bank[bus->params.next_bank];
+
+	if (bank->valid &&
+	    !memcmp(&bank->transport_params, &p_rt->transport_params,
+		    sizeof(p_rt->transport_params)) &&
+	    !memcmp(&bank->port_params, &p_rt->port_params,
+		    sizeof(p_rt->port_params)))
+		return true;
+
+	/* the bank content is unknown until programming succeeds */
+	bank->valid = false;
+	return false;
+}
+
+static void sdw_port_bank_update(struct sdw_bus *bus,
+				 struct sdw_port_runtime *p_rt)
+{
+	struct sdw_port_bank_params *bank = &p_rt->bank[bus->params.next_bank];
+
+	memcpy(&bank->transport_params, &p_rt->transport_params,
+	       sizeof(p_rt->transport_params));
+	memcpy(&bank->port_params, &p_rt->port_params,
+	       sizeof(p_rt->port_params));
+	bank->valid = true;
+}
+
+/*
+ * Forget the bank parameters of the ports on the bus, e.g. when the
+ * registers may have been lost while suspended. Slave ports are kept
+ * when the Slaves retained their context across clock stop.
+ */
+static void sdw_invalidate_port_banks(struct sdw_bus *bus)
+{
+	struct sdw_slave_runtime *s_rt;
+	struct sdw_master_runtime *m_rt;
+	struct sdw_port_runtime *p_rt;
+
+	list_for_each_entry(m_rt, &bus->m_rt_list, bus_node) {
+		list_for_each_entry(p_rt, &m_rt->port_list, port_node)
+			memset(p_rt->bank, 0, sizeof(p_rt->bank));
+
+		if (bus->slave_ctx_retained)
+			continue;
+
+		list_for_each_entry(s_rt, &m_rt->slave_rt_list, m_rt_node) {
+			list_for_each_entry(p_rt, &s_rt->port_list, port_node)
+				memset(p_rt->bank, 0, sizeof(p_rt->bank));
+		}
+	}
+}
+
 /**
  * sdw_program_port_params() - Programs transport parameters of Master(s)
  * and Slave(s)
  *
  * @m_rt: Master stream runtime
+ *
+ * Ports whose parameters are unchanged in the alternate bank are skipped,
+ * so the number of writes scales with the change and not with the bus.
  */
 static int sdw_program_port_params(struct sdw_master_runtime *m_rt)
 {
@@ -274,17 +327,27 @@ static int sdw_program_port_params(struct sdw_master_runtime *m_rt)
 	/* Program transport & port parameters for Slave(s) */
 	list_for_each_entry(s_rt, &m_rt->slave_rt_list, m_rt_node) {
 		list_for_each_entry(p_rt, &s_rt->port_list, port_node) {
+			if (sdw_port_bank_is_current(bus, p_rt))
+				continue;
+
 			ret = sdw_program_slave_port_params(bus, s_rt, p_rt);
 			if (ret < 0)
 				return ret;
+
+			sdw_port_bank_update(bus, p_rt);
 		}
 	}
 
 	/* Program transport & port parameters for Master(s) */
 	list_for_each_entry(p_rt, &m_rt->port_list, port_node) {
+		if (sdw_port_bank_is_current(bus, p_rt))
+			continue;
+
 		ret = sdw_program_master_port_params(bus, p_rt);
 		if (ret < 0)
 			return ret;
+
+		sdw_port_bank_update(bus, p_rt);
 	}
 
 	return 0;
@@ -419,37 +482,50 @@ static int sdw_do_port_prep(struct sdw_slave_runtime *s_rt,
 	return 0;
 }
 
-static int sdw_prep_deprep_slave_ports(struct sdw_bus *bus,
-				       struct sdw_slave_runtime *s_rt,
-				       struct sdw_port_runtime *p_rt,
-				       bool prep)
+static struct sdw_dpn_prop *
+sdw_slave_port_prep_ch(struct sdw_bus *bus, struct sdw_slave_runtime *s_rt,
+		       struct sdw_port_runtime *p_rt, bool prep,
+		       struct sdw_prepare_ch *prep_ch, bool *intr)
 {
-	struct completion *port_ready;
 	struct sdw_dpn_prop *dpn_prop;
-	struct sdw_prepare_ch prep_ch;
-	unsigned int time_left;
-	bool intr = false;
-	int ret = 0, val;
-	u32 addr;
 
-	prep_ch.num = p_rt->num;
-	prep_ch.ch_mask = p_rt->ch_mask;
+	prep_ch->num = p_rt->num;
+	prep_ch->ch_mask = p_rt->ch_mask;
+	prep_ch->prepare = prep;
+	prep_ch->bank = bus->params.next_bank;
 
 	dpn_prop = sdw_get_slave_dpn_prop(s_rt->slave,
 					  s_rt->direction,
-					  prep_ch.num);
+					  prep_ch->num);
 	if (!dpn_prop) {
 		dev_err(bus->dev,
-			"Slave Port:%d properties not found\n", prep_ch.num);
-		return -EINVAL;
+			"Slave Port:%d properties not found\n", prep_ch->num);
+		return NULL;
 	}
 
-	prep_ch.prepare = prep;
+	/* DP0 interrupts are enabled when the Slave is initialized */
+	*intr = p_rt->num &&
+		(dpn_prop->imp_def_interrupts || !dpn_prop->simple_ch_prep_sm);
 
-	prep_ch.bank = bus->params.next_bank;
+	return dpn_prop;
+}
+
+/* first half of a Slave port prepare, up to the start of the CP_SM */
+static int sdw_slave_port_prep_start(struct sdw_bus *bus,
+				     struct sdw_slave_runtime *s_rt,
+				     struct sdw_port_runtime *p_rt,
+				     bool prep)
+{
+	struct sdw_dpn_prop *dpn_prop;
+	struct sdw_prepare_ch prep_ch;
+	bool intr;
+	int ret = 0;
+	u32 addr;
 
-	if (dpn_prop->imp_def_interrupts || !dpn_prop->simple_ch_prep_sm)
-		intr = true;
+	dpn_prop = sdw_slave_port_prep_ch(bus, s_rt, p_rt, prep, &prep_ch,
+					  &intr);
+	if (!dpn_prop)
+		return -EINVAL;
 
 	/*
 	 * Enable interrupt before Port prepare.
@@ -480,7 +556,30 @@ static int sdw_prep_deprep_slave_ports(struct sdw_bus *bus,
 				"Slave prep_ctrl reg write failed\n");
 			return ret;
 		}
+	}
+
+	return 0;
+}
+
+/* second half of a Slave port prepare, waits for the CP_SM to complete */
+static int sdw_slave_port_prep_finish(struct sdw_bus *bus,
+				      struct sdw_slave_runtime *s_rt,
+				      struct sdw_port_runtime *p_rt,
+				      bool prep)
+{
+	struct completion *port_ready;
+	struct sdw_dpn_prop *dpn_prop;
+	struct sdw_prepare_ch prep_ch;
+	unsigned int time_left;
+	bool intr;
+	int ret = 0, val;
+
+	dpn_prop = sdw_slave_port_prep_ch(bus, s_rt, p_rt, prep, &prep_ch,
+					  &intr);
+	if (!dpn_prop)
+		return -EINVAL;
 
+	if (!dpn_prop->simple_ch_prep_sm) {
 		/* Wait for completion on port ready */
 		port_ready = &s_rt->slave->port_ready[prep_ch.num];
 		time_left = wait_for_completion_timeout(port_ready,
@@ -536,32 +635,55 @@ static int sdw_prep_deprep_master_ports(struct sdw_master_runtime *m_rt,
 
 /**
  * sdw_prep_deprep_ports() - Prepare/De-prepare port(s) for Master(s) and
- * Slave(s)
+ * Slave(s) of a stream
  *
- * @m_rt: Master runtime handle
+ * @stream: Stream runtime handle
  * @prep: Prepare or De-prepare
+ *
+ * All the Slave ports of the stream, on all its Masters, are asked to
+ * prepare before waiting for any of them, so that the channel prepare
+ * state machines of aggregated Slaves run concurrently.
  */
-static int sdw_prep_deprep_ports(struct sdw_master_runtime *m_rt, bool prep)
+static int sdw_prep_deprep_ports(struct sdw_stream_runtime *stream,
+				 bool prep)
 {
+	struct sdw_master_runtime *m_rt;
 	struct sdw_slave_runtime *s_rt;
 	struct sdw_port_runtime *p_rt;
 	int ret = 0;
 
 	/* Prepare/De-prepare Slave port(s) */
-	list_for_each_entry(s_rt, &m_rt->slave_rt_list, m_rt_node) {
-		list_for_each_entry(p_rt, &s_rt->port_list, port_node) {
-			ret = sdw_prep_deprep_slave_ports(m_rt->bus, s_rt,
-							  p_rt, prep);
-			if (ret < 0)
-				return ret;
+	list_for_each_entry(m_rt, &stream->master_list, stream_node) {
+		list_for_each_entry(s_rt, &m_rt->slave_rt_list, m_rt_node) {
+			list_for_each_entry(p_rt, &s_rt->port_list, port_node) {
+				ret = sdw_slave_port_prep_start(m_rt->bus,
+								s_rt, p_rt,
+								prep);
+				if (ret < 0)
+					return ret;
+			}
+		}
+	}
+
+	list_for_each_entry(m_rt, &stream->master_list, stream_node) {
+		list_for_each_entry(s_rt, &m_rt->slave_rt_list, m_rt_node) {
+			list_for_each_entry(p_rt, &s_rt->port_list, port_node) {
+				ret = sdw_slave_port_prep_finish(m_rt->bus,
+								 s_rt, p_rt,
+								 prep);
+				if (ret < 0)
+					return ret;
+			}
 		}
 	}
 
 	/* Prepare/De-prepare Master port(s) */
-	list_for_each_entry(p_rt, &m_rt->port_list, port_node) {
-		ret = sdw_prep_deprep_master_ports(m_rt, p_rt, prep);
-		if (ret < 0)
-			return ret;
+	list_for_each_entry(m_rt, &stream->master_list, stream_node) {
+		list_for_each_entry(p_rt, &m_rt->port_list, port_node) {
+			ret = sdw_prep_deprep_master_ports(m_rt, p_rt, prep);
+			if (ret < 0)
+				return ret;
+		}
 	}
 
 	return ret;
@@ -656,31 +778,27 @@ static int sdw_program_params(struct sdw_bus *bus, bool prepare)
 	return ret;
 }
 
+/*
+ * Set the multi_link flag only when both the hardware supports
+ * and hardware-based sync is required
+ */
+static bool sdw_bus_ml_sync(struct sdw_bus *bus, int m_rt_count)
+{
+	return bus->multi_link && m_rt_count >= bus->hw_sync_min_links;
+}
+
 static int sdw_bank_switch(struct sdw_bus *bus, int m_rt_count)
 {
+	struct sdw_msg *wr_msg = bus->bank_switch_msg;
 	int col_index, row_index;
 	bool multi_link;
-	struct sdw_msg *wr_msg;
-	u8 *wbuf;
 	int ret;
 	u16 addr;
 
-	wr_msg = kzalloc(sizeof(*wr_msg), GFP_KERNEL);
-	if (!wr_msg)
-		return -ENOMEM;
-
-	bus->defer_msg.msg = wr_msg;
-
-	wbuf = kzalloc(sizeof(*wbuf), GFP_KERNEL);
-	if (!wbuf) {
-		ret = -ENOMEM;
-		goto error_1;
-	}
-
 	/* Get row and column index to program register */
 	col_index = sdw_find_col_index(bus->params.col);
 	row_index = sdw_find_row_index(bus->params.row);
-	wbuf[0] = col_index | (row_index << 3);
+	bus->bank_switch_buf = col_index | (row_index << 3);
 
 	if (bus->params.next_bank)
 		addr = SDW_SCP_FRAMECTRL_B1;
@@ -688,14 +806,10 @@ static int sdw_bank_switch(struct sdw_bus *bus, int m_rt_count)
 		addr = SDW_SCP_FRAMECTRL_B0;
 
 	sdw_fill_msg(wr_msg, NULL, addr, 1, SDW_BROADCAST_DEV_NUM,
-		     SDW_MSG_FLAG_WRITE, wbuf);
+		     SDW_MSG_FLAG_WRITE, &bus->bank_switch_buf);
 	wr_msg->ssp_sync = true;
 
-	/*
-	 * Set the multi_link flag only when both the hardware supports
-	 * and hardware-based sync is required
-	 */
-	multi_link = bus->multi_link && (m_rt_count >= bus->hw_sync_min_links);
+	multi_link = sdw_bus_ml_sync(bus, m_rt_count);
 
 	if (multi_link)
 		ret = sdw_transfer_defer(bus, wr_msg, &bus->defer_msg);
@@ -704,32 +818,21 @@ static int sdw_bank_switch(struct sdw_bus *bus, int m_rt_count)
 
 	if (ret < 0) {
 		dev_err(bus->dev, "Slave frame_ctrl reg write failed\n");
-		goto error;
+		return ret;
 	}
 
 	if (!multi_link) {
-		kfree(wr_msg);
-		kfree(wbuf);
-		bus->defer_msg.msg = NULL;
 		bus->params.curr_bank = !bus->params.curr_bank;
 		bus->params.next_bank = !bus->params.next_bank;
 	}
 
 	return 0;
-
-error:
-	kfree(wbuf);
-error_1:
-	kfree(wr_msg);
-	return ret;
 }
 
 /**
  * sdw_ml_sync_bank_switch: Multilink register bank switch
  *
  * @bus: SDW bus instance
- *
- * Caller function should free the buffers on error
  */
 static int sdw_ml_sync_bank_switch(struct sdw_bus *bus)
 {
@@ -750,20 +853,38 @@ static int sdw_ml_sync_bank_switch(struct sdw_bus *bus)
 	bus->params.curr_bank = !bus->params.curr_bank;
 	bus->params.next_bank = !bus->params.next_bank;
 
-	if (bus->defer_msg.msg) {
-		kfree(bus->defer_msg.msg->buf);
-		kfree(bus->defer_msg.msg);
-	}
-
 	return 0;
 }
 
-static int do_bank_switch(struct sdw_stream_runtime *stream)
+/* release the msg_lock taken on the Masters in [@from, @to) of the list */
+static void sdw_ml_msg_unlock(struct sdw_stream_runtime *stream,
+			      int from, int to)
+{
+	struct sdw_master_runtime *m_rt;
+	int i = 0;
+
+	list_for_each_entry(m_rt, &stream->master_list, stream_node) {
+		if (i >= from && i < to &&
+		    sdw_bus_ml_sync(m_rt->bus, stream->m_rt_count))
+			mutex_unlock(&m_rt->bus->msg_lock);
+		i++;
+	}
+}
+
+/*
+ * Only the multi-link bank switch holds msg_lock across several steps:
+ * no other command may be sent between the deferred FrameCtrl write and
+ * the synchronized switch. It is taken after the pre_bank_switch callback
+ * and released as soon as the switch of each bus completed, so that
+ * control traffic is held back for as short as possible.
+ */
+static int _do_bank_switch(struct sdw_stream_runtime *stream)
 {
 	struct sdw_master_runtime *m_rt;
 	const struct sdw_master_ops *ops;
 	struct sdw_bus *bus;
 	bool multi_link = false;
+	int locked = 0, unlocked = 0;
 	int m_rt_count;
 	int ret = 0;
 
@@ -773,21 +894,22 @@ static int do_bank_switch(struct sdw_stream_runtime *stream)
 		bus = m_rt->bus;
 		ops = bus->ops;
 
-		if (bus->multi_link && m_rt_count >= bus->hw_sync_min_links) {
-			multi_link = true;
-			mutex_lock(&bus->msg_lock);
-		}
-
 		/* Pre-bank switch */
 		if (ops->pre_bank_switch) {
 			ret = ops->pre_bank_switch(bus);
 			if (ret < 0) {
 				dev_err(bus->dev,
 					"Pre bank switch op failed: %d\n", ret);
-				goto msg_unlock;
+				goto error;
 			}
 		}
 
+		if (sdw_bus_ml_sync(bus, m_rt_count)) {
+			multi_link = true;
+			mutex_lock(&bus->msg_lock);
+		}
+		locked++;
+
 		/*
 		 * Perform Bank switch operation.
 		 * For multi link cases, the actual bank switch is
@@ -838,29 +960,39 @@ static int do_bank_switch(struct sdw_stream_runtime *stream)
 			goto error;
 		}
 
-		if (multi_link)
+		if (sdw_bus_ml_sync(bus, m_rt_count))
 			mutex_unlock(&bus->msg_lock);
+		unlocked++;
 	}
 
 	return ret;
 
 error:
-	list_for_each_entry(m_rt, &stream->master_list, stream_node) {
-		bus = m_rt->bus;
+	sdw_ml_msg_unlock(stream, unlocked, locked);
 
-		kfree(bus->defer_msg.msg->buf);
-		kfree(bus->defer_msg.msg);
-	}
+	return ret;
+}
 
-msg_unlock:
+static int do_bank_switch(struct sdw_stream_runtime *stream)
+{
+	struct sdw_master_runtime *m_rt;
+	ktime_t start;
+	u64 latency_us;
+	int ret;
 
-	if (multi_link) {
-		list_for_each_entry(m_rt, &stream->master_list, stream_node) {
-			bus = m_rt->bus;
-			if (mutex_is_locked(&bus->msg_lock))
-				mutex_unlock(&bus->msg_lock);
-		}
-	}
+	trace_sdw_bank_switch(stream);
+	start = ktime_get();
+
+	ret = _do_bank_switch(stream);
+
+	latency_us = ktime_us_delta(ktime_get(), start);
+	trace_sdw_bank_switch_done(stream, ret, latency_us);
+
+	if (ret < 0)
+		return ret;
+
+	list_for_each_entry(m_rt, &stream->master_list, stream_node)
+		sdw_bus_stats_bank_switch(m_rt->bus, latency_us);
 
 	return ret;
 }
@@ -904,6 +1036,120 @@ struct sdw_stream_runtime *sdw_alloc_stream(const char *stream_name)
 }
 EXPORT_SYMBOL(sdw_alloc_stream);
 
+/*
+ * Runtime pools
+ *
+ * Master, Slave and port runtimes are taken from per-bus free lists
+ * rather than allocated on each stream open and freed on close. The
+ * pools are filled when the Slaves are probed, with enough runtimes for
+ * all the ports of the Slave and their Master peers to be part of
+ * streams at the same time, and only freed with the bus. Runtimes are
+ * still allocated if a pool runs dry. The free lists use the list node
+ * of each runtime and are protected by bus_lock.
+ */
+static void *sdw_rt_pool_get(struct list_head *pool, size_t size,
+			     size_t node_offset)
+{
+	void *obj;
+
+	if (list_empty(pool))
+		return kzalloc(size, GFP_KERNEL);
+
+	obj = (void *)pool->next - node_offset;
+	list_del(pool->next);
+	memset(obj, 0, size);
+
+	return obj;
+}
+
+static int sdw_rt_pool_fill(struct list_head *pool, size_t size,
+			    size_t node_offset, int count)
+{
+	void *obj;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		obj = kzalloc(size, GFP_KERNEL);
+		if (!obj)
+			return -ENOMEM;
+
+		list_add(obj + node_offset, pool);
+	}
+
+	return 0;
+}
+
+static void sdw_rt_pool_drain(struct list_head *pool, size_t node_offset)
+{
+	struct list_head *node, *_node;
+
+	list_for_each_safe(node, _node, pool) {
+		list_del(node);
+		kfree((void *)node - node_offset);
+	}
+}
+
+#define SDW_M_RT_NODE	offsetof(struct sdw_master_runtime, bus_node)
+#define SDW_S_RT_NODE	offsetof(struct sdw_slave_runtime, m_rt_node)
+#define SDW_P_RT_NODE	offsetof(struct sdw_port_runtime, port_node)
+
+void sdw_rt_pool_init(struct sdw_bus *bus)
+{
+	INIT_LIST_HEAD(&bus->rt_pool.m_rt);
+	INIT_LIST_HEAD(&bus->rt_pool.s_rt);
+	INIT_LIST_HEAD(&bus->rt_pool.p_rt);
+}
+
+void sdw_rt_pool_release(struct sdw_bus *bus)
+{
+	mutex_lock(&bus->bus_lock);
+	sdw_rt_pool_drain(&bus->rt_pool.m_rt, SDW_M_RT_NODE);
+	sdw_rt_pool_drain(&bus->rt_pool.s_rt, SDW_S_RT_NODE);
+	sdw_rt_pool_drain(&bus->rt_pool.p_rt, SDW_P_RT_NODE);
+	mutex_unlock(&bus->bus_lock);
+}
+
+/**
+ * sdw_rt_pool_reserve() - Fill the runtime pools for a Slave
+ *
+ * @slave: SDW Slave, with its properties read
+ *
+ * Called once per Slave, a failure only means runtimes will be
+ * allocated when streams are opened.
+ */
+int sdw_rt_pool_reserve(struct sdw_slave *slave)
+{
+	struct sdw_rt_pool *pool = &slave->bus->rt_pool;
+	struct sdw_slave_prop *prop = &slave->prop;
+	int ports, ret;
+
+	if (slave->rt_reserved)
+		return 0;
+
+	/* Data Port 0 is used for Bulk transfers */
+	ports = hweight32(prop->source_ports) + hweight32(prop->sink_ports) +
+		!!prop->dp0_prop;
+
+	mutex_lock(&slave->bus->bus_lock);
+
+	ret = sdw_rt_pool_fill(&pool->m_rt, sizeof(struct sdw_master_runtime),
+			       SDW_M_RT_NODE, ports);
+	if (!ret)
+		ret = sdw_rt_pool_fill(&pool->s_rt,
+				       sizeof(struct sdw_slave_runtime),
+				       SDW_S_RT_NODE, ports);
+	if (!ret)
+		ret = sdw_rt_pool_fill(&pool->p_rt,
+				       sizeof(struct sdw_port_runtime),
+				       SDW_P_RT_NODE, 2 * ports);
+
+	mutex_unlock(&slave->bus->bus_lock);
+
+	slave->rt_reserved = true;
+
+	return ret;
+}
+
 static struct sdw_master_runtime
 *sdw_find_master_rt(struct sdw_bus *bus,
 		    struct sdw_stream_runtime *stream)
@@ -943,7 +1189,8 @@ static struct sdw_master_runtime
 	if (m_rt)
 		goto stream_config;
 
-	m_rt = kzalloc(sizeof(*m_rt), GFP_KERNEL);
+	m_rt = sdw_rt_pool_get(&bus->rt_pool.m_rt, sizeof(*m_rt),
+			       SDW_M_RT_NODE);
 	if (!m_rt)
 		return NULL;
 
@@ -979,7 +1226,8 @@ static struct sdw_slave_runtime
 {
 	struct sdw_slave_runtime *s_rt;
 
-	s_rt = kzalloc(sizeof(*s_rt), GFP_KERNEL);
+	s_rt = sdw_rt_pool_get(&slave->bus->rt_pool.s_rt, sizeof(*s_rt),
+			       SDW_S_RT_NODE);
 	if (!s_rt)
 		return NULL;
 
@@ -996,10 +1244,8 @@ static void sdw_master_port_release(struct sdw_bus *bus,
 {
 	struct sdw_port_runtime *p_rt, *_p_rt;
 
-	list_for_each_entry_safe(p_rt, _p_rt, &m_rt->port_list, port_node) {
-		list_del(&p_rt->port_node);
-		kfree(p_rt);
-	}
+	list_for_each_entry_safe(p_rt, _p_rt, &m_rt->port_list, port_node)
+		list_move(&p_rt->port_node, &bus->rt_pool.p_rt);
 }
 
 static void sdw_slave_port_release(struct sdw_bus *bus,
@@ -1016,10 +1262,9 @@ static void sdw_slave_port_release(struct sdw_bus *bus,
 				continue;
 
 			list_for_each_entry_safe(p_rt, _p_rt,
-						 &s_rt->port_list, port_node) {
-				list_del(&p_rt->port_node);
-				kfree(p_rt);
-			}
+						 &s_rt->port_list, port_node)
+				list_move(&p_rt->port_node,
+					  &bus->rt_pool.p_rt);
 		}
 	}
 }
@@ -1043,8 +1288,8 @@ static void sdw_release_slave_stream(struct sdw_slave *slave,
 		list_for_each_entry_safe(s_rt, _s_rt,
 					 &m_rt->slave_rt_list, m_rt_node) {
 			if (s_rt->slave == slave) {
-				list_del(&s_rt->m_rt_node);
-				kfree(s_rt);
+				list_move(&s_rt->m_rt_node,
+					  &slave->bus->rt_pool.s_rt);
 				return;
 			}
 		}
@@ -1073,8 +1318,7 @@ static void sdw_release_master_stream(struct sdw_master_runtime *m_rt,
 	}
 
 	list_del(&m_rt->stream_node);
-	list_del(&m_rt->bus_node);
-	kfree(m_rt);
+	list_move(&m_rt->bus_node, &m_rt->bus->rt_pool.m_rt);
 }
 
 /**
@@ -1192,13 +1436,14 @@ static int sdw_is_valid_port_range(struct device *dev,
 }
 
 static struct sdw_port_runtime
-*sdw_port_alloc(struct device *dev,
+*sdw_port_alloc(struct sdw_bus *bus,
 		struct sdw_port_config *port_config,
 		int port_index)
 {
 	struct sdw_port_runtime *p_rt;
 
-	p_rt = kzalloc(sizeof(*p_rt), GFP_KERNEL);
+	p_rt = sdw_rt_pool_get(&bus->rt_pool.p_rt, sizeof(*p_rt),
+			       SDW_P_RT_NODE);
 	if (!p_rt)
 		return NULL;
 
@@ -1218,7 +1463,7 @@ static int sdw_master_port_config(struct sdw_bus *bus,
 
 	/* Iterate for number of ports to perform initialization */
 	for (i = 0; i < num_ports; i++) {
-		p_rt = sdw_port_alloc(bus->dev, port_config, i);
+		p_rt = sdw_port_alloc(bus, port_config, i);
 		if (!p_rt)
 			return -ENOMEM;
 
@@ -1236,14 +1481,15 @@ static int sdw_master_port_config(struct sdw_bus *bus,
 static int sdw_slave_port_config(struct sdw_slave *slave,
 				 struct sdw_slave_runtime *s_rt,
 				 struct sdw_port_config *port_config,
-				 unsigned int num_config)
+				 unsigned int num_config,
+				 enum sdw_stream_type type)
 {
 	struct sdw_port_runtime *p_rt;
 	int i, ret;
 
 	/* Iterate for number of ports to perform initialization */
 	for (i = 0; i < num_config; i++) {
-		p_rt = sdw_port_alloc(&slave->dev, port_config, i);
+		p_rt = sdw_port_alloc(slave->bus, port_config, i);
 		if (!p_rt)
 			return -ENOMEM;
 
@@ -1251,9 +1497,13 @@ static int sdw_slave_port_config(struct sdw_slave *slave,
 		 * TODO: Check valid port range as defined by DisCo/
 		 * slave
 		 */
-		ret = sdw_is_valid_port_range(&slave->dev, p_rt);
+		if (type == SDW_STREAM_BPT && !p_rt->num &&
+		    slave->prop.dp0_prop)
+			ret = 0; /* BRA packets go to Data Port 0 */
+		else
+			ret = sdw_is_valid_port_range(&slave->dev, p_rt);
 		if (ret < 0) {
-			kfree(p_rt);
+			list_add(&p_rt->port_node, &slave->bus->rt_pool.p_rt);
 			return ret;
 		}
 
@@ -1382,7 +1632,8 @@ int sdw_stream_add_slave(struct sdw_slave *slave,
 
 	list_add_tail(&s_rt->m_rt_node, &m_rt->slave_rt_list);
 
-	ret = sdw_slave_port_config(slave, s_rt, port_config, num_ports);
+	ret = sdw_slave_port_config(slave, s_rt, port_config, num_ports,
+				    stream->type);
 	if (ret)
 		goto stream_error;
 
@@ -1418,24 +1669,65 @@ struct sdw_dpn_prop *sdw_get_slave_dpn_prop(struct sdw_slave *slave,
 					    enum sdw_data_direction direction,
 					    unsigned int port_num)
 {
-	struct sdw_dpn_prop *dpn_prop;
-	u8 num_ports;
+	if (port_num >= SDW_MAX_PORTS)
+		return NULL;
+
+	return slave->dpn_prop_map[direction][port_num];
+}
+
+static void sdw_map_dpn_prop(struct sdw_slave *slave,
+			     enum sdw_data_direction direction,
+			     struct sdw_dpn_prop *dpn_prop, u32 ports)
+{
 	int i;
 
-	if (direction == SDW_DATA_DIR_TX) {
-		num_ports = hweight32(slave->prop.source_ports);
-		dpn_prop = slave->prop.src_dpn_prop;
-	} else {
-		num_ports = hweight32(slave->prop.sink_ports);
-		dpn_prop = slave->prop.sink_dpn_prop;
+	for (i = 0; i < hweight32(ports); i++) {
+		if (dpn_prop[i].num < SDW_MAX_PORTS)
+			slave->dpn_prop_map[direction][dpn_prop[i].num] =
+				&dpn_prop[i];
 	}
+}
 
-	for (i = 0; i < num_ports; i++) {
-		if (dpn_prop[i].num == port_num)
-			return &dpn_prop[i];
-	}
+/**
+ * sdw_slave_map_dpn_prop() - Index the Slave port capabilities
+ *
+ * @slave: SDW Slave, with its properties read
+ *
+ * Build the table used by sdw_get_slave_dpn_prop(), so that stream
+ * configuration doesn't search the property arrays.
+ */
+void sdw_slave_map_dpn_prop(struct sdw_slave *slave)
+{
+	struct sdw_dp0_prop *dp0_prop = slave->prop.dp0_prop;
+	struct sdw_dpn_prop *dpn_prop;
 
-	return NULL;
+	memset(slave->dpn_prop_map, 0, sizeof(slave->dpn_prop_map));
+
+	if (slave->prop.src_dpn_prop)
+		sdw_map_dpn_prop(slave, SDW_DATA_DIR_TX,
+				 slave->prop.src_dpn_prop,
+				 slave->prop.source_ports);
+
+	if (slave->prop.sink_dpn_prop)
+		sdw_map_dpn_prop(slave, SDW_DATA_DIR_RX,
+				 slave->prop.sink_dpn_prop,
+				 slave->prop.sink_ports);
+
+	if (!dp0_prop)
+		return;
+
+	/* DP0 is a full Data Port without block packing */
+	dpn_prop = &slave->prop.dp0_dpn_prop;
+	dpn_prop->num = 0;
+	dpn_prop->type = SDW_DPN_FULL;
+	dpn_prop->max_word = dp0_prop->max_word;
+	dpn_prop->min_word = dp0_prop->min_word;
+	dpn_prop->simple_ch_prep_sm = dp0_prop->simple_ch_prep_sm;
+	dpn_prop->imp_def_interrupts = dp0_prop->imp_def_interrupts;
+	dpn_prop->ch_prep_timeout = slave->prop.ch_prep_timeout;
+
+	slave->dpn_prop_map[SDW_DATA_DIR_RX][0] = dpn_prop;
+	slave->dpn_prop_map[SDW_DATA_DIR_TX][0] = dpn_prop;
 }
 
 /**
@@ -1503,8 +1795,11 @@ static int _sdw_prepare_stream(struct sdw_stream_runtime *stream,
 			return -EINVAL;
 		}
 
-		if (!update_params)
+		if (!update_params) {
+			/* registers may have been lost, program all ports */
+			sdw_invalidate_port_banks(bus);
 			goto program_params;
+		}
 
 		/* Increment cumulative bus bandwidth */
 		/* TODO: Update this during Device-Device support */
@@ -1541,18 +1836,16 @@ program_params:
 		goto restore_params;
 	}
 
-	list_for_each_entry(m_rt, &stream->master_list, stream_node) {
-		bus = m_rt->bus;
-
-		/* Prepare port(s) on the new clock configuration */
-		ret = sdw_prep_deprep_ports(m_rt, true);
-		if (ret < 0) {
-			dev_err(bus->dev, "Prepare port(s) failed ret = %d\n",
-				ret);
-			return ret;
-		}
+	/* Prepare port(s) on the new clock configuration */
+	ret = sdw_prep_deprep_ports(stream, true);
+	if (ret < 0) {
+		dev_err(bus->dev, "Prepare port(s) failed ret = %d\n", ret);
+		return ret;
 	}
 
+	list_for_each_entry(m_rt, &stream->master_list, stream_node)
+		m_rt->ctx_gen = READ_ONCE(m_rt->bus->ctx_gen);
+
 	stream->state = SDW_STREAM_PREPARED;
 
 	return ret;
@@ -1562,6 +1855,72 @@ restore_params:
 	return ret;
 }
 
+/*
+ * A DISABLED stream keeps its ports programmed and prepared, unless the
+ * Master or the Slaves lost their context since it was prepared. The
+ * frame shape of the current bank is read back from each Slave as a
+ * cheap check that it was not reset behind our back.
+ */
+static bool _sdw_stream_ctx_retained(struct sdw_stream_runtime *stream)
+{
+	struct sdw_master_runtime *m_rt;
+	struct sdw_slave_runtime *s_rt;
+	struct sdw_bus *bus;
+	int frame_ctrl;
+	int val;
+	u32 addr;
+
+	if (stream->state != SDW_STREAM_DISABLED)
+		return false;
+
+	list_for_each_entry(m_rt, &stream->master_list, stream_node) {
+		bus = m_rt->bus;
+		if (m_rt->ctx_gen != READ_ONCE(bus->ctx_gen))
+			return false;
+
+		frame_ctrl = sdw_find_col_index(bus->params.col) |
+			(sdw_find_row_index(bus->params.row) << 3);
+
+		if (bus->params.curr_bank)
+			addr = SDW_SCP_FRAMECTRL_B1;
+		else
+			addr = SDW_SCP_FRAMECTRL_B0;
+
+		list_for_each_entry(s_rt, &m_rt->slave_rt_list, m_rt_node) {
+			val = sdw_read(s_rt->slave, addr);
+			if (val != frame_ctrl)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * sdw_stream_ctx_retained() - Check if a stream kept its configuration
+ *
+ * @stream: Soundwire stream
+ *
+ * Return true if @stream is DISABLED, e.g. on an underflow or across a
+ * suspend where the link stayed in Clock Stop Mode 0 without reset, and
+ * neither the Masters nor the Slaves lost its configuration. Master
+ * drivers may then skip reprogramming their side of the stream.
+ */
+bool sdw_stream_ctx_retained(struct sdw_stream_runtime *stream)
+{
+	bool retained;
+
+	if (!stream)
+		return false;
+
+	sdw_acquire_bus_lock(stream);
+	retained = _sdw_stream_ctx_retained(stream);
+	sdw_release_bus_lock(stream);
+
+	return retained;
+}
+EXPORT_SYMBOL(sdw_stream_ctx_retained);
+
 /**
  * sdw_prepare_stream() - Prepare SoundWire stream
  *
@@ -1572,6 +1931,7 @@ restore_params:
 int sdw_prepare_stream(struct sdw_stream_runtime *stream)
 {
 	bool update_params = true;
+	ktime_t start;
 	int ret;
 
 	if (!stream) {
@@ -1579,6 +1939,7 @@ int sdw_prepare_stream(struct sdw_stream_runtime *stream)
 		return -EINVAL;
 	}
 
+	start = ktime_get();
 	sdw_acquire_bus_lock(stream);
 
 	if (stream->state == SDW_STREAM_PREPARED) {
@@ -1605,10 +1966,19 @@ int sdw_prepare_stream(struct sdw_stream_runtime *stream)
 	if (stream->state == SDW_STREAM_DISABLED)
 		update_params = false;
 
+	/* the ports are still programmed and prepared */
+	if (_sdw_stream_ctx_retained(stream)) {
+		stream->state = SDW_STREAM_PREPARED;
+		ret = 0;
+		goto state_err;
+	}
+
 	ret = _sdw_prepare_stream(stream, update_params);
 
 state_err:
 	sdw_release_bus_lock(stream);
+	trace_sdw_prepare_stream_done(stream, ret,
+				      ktime_us_delta(ktime_get(), start));
 	return ret;
 }
 EXPORT_SYMBOL(sdw_prepare_stream);
@@ -1788,15 +2158,18 @@ static int _sdw_deprepare_stream(struct sdw_stream_runtime *stream)
 	struct sdw_bus *bus;
 	int ret = 0;
 
+	/* De-prepare port(s) */
+	ret = sdw_prep_deprep_ports(stream, false);
+	if (ret < 0) {
+		m_rt = list_first_entry(&stream->master_list,
+					struct sdw_master_runtime, stream_node);
+		dev_err(m_rt->bus->dev,
+			"De-prepare port(s) failed: %d\n", ret);
+		return ret;
+	}
+
 	list_for_each_entry(m_rt, &stream->master_list, stream_node) {
 		bus = m_rt->bus;
-		/* De-prepare port(s) */
-		ret = sdw_prep_deprep_ports(m_rt, false);
-		if (ret < 0) {
-			dev_err(bus->dev,
-				"De-prepare port(s) failed: %d\n", ret);
-			return ret;
-		}
 
 		/* TODO: Update this during Device-Device support */
 		bus->params.bandwidth -= m_rt->stream->params.rate *
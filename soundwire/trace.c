@@ -0,0 +1,7 @@
+// SPDX-License-Identifier: (GPL-2.0 OR BSD-3-Clause)
+/*
+ * tracepoint definitions for the SoundWire bus
+ */
+
+#define CREATE_TRACE_POINTS
+#include "trace.h"
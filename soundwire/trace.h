@@ -0,0 +1,175 @@
+/* SPDX-License-Identifier: (GPL-2.0 OR BSD-3-Clause) */
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM soundwire
+
+#if !defined(__SDW_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define __SDW_TRACE_H
+
+#include <linux/tracepoint.h>
+#include <dkms/linux/soundwire/sdw.h>
+#include "bus.h"
+
+DECLARE_EVENT_CLASS(sdw_msg,
+	TP_PROTO(struct sdw_bus *bus, struct sdw_msg *msg),
+
+	TP_ARGS(bus, msg),
+
+	TP_STRUCT__entry(
+		__field(unsigned int, link_id)
+		__field(u16, dev_num)
+		__field(u16, addr)
+		__field(u16, len)
+		__field(u8, flags)
+		__field(u8, addr_page1)
+		__field(u8, addr_page2)
+		__field(bool, page)
+	),
+
+	TP_fast_assign(
+		__entry->link_id = bus->link_id;
+		__entry->dev_num = msg->dev_num;
+		__entry->addr = msg->addr;
+		__entry->len = msg->len;
+		__entry->flags = msg->flags;
+		__entry->addr_page1 = msg->addr_page1;
+		__entry->addr_page2 = msg->addr_page2;
+		__entry->page = msg->page;
+	),
+
+	TP_printk("link %u dev %u %s addr=0x%04x len=%u page=%s%02x%02x",
+		  __entry->link_id, __entry->dev_num,
+		  __entry->flags == SDW_MSG_FLAG_READ ? "read" : "write",
+		  __entry->addr, __entry->len,
+		  __entry->page ? "" : "-", __entry->addr_page2,
+		  __entry->addr_page1)
+);
+
+DEFINE_EVENT(sdw_msg, sdw_transfer,
+	TP_PROTO(struct sdw_bus *bus, struct sdw_msg *msg),
+	TP_ARGS(bus, msg)
+);
+
+DEFINE_EVENT(sdw_msg, sdw_transfer_defer,
+	TP_PROTO(struct sdw_bus *bus, struct sdw_msg *msg),
+	TP_ARGS(bus, msg)
+);
+
+TRACE_EVENT(sdw_transfer_done,
+	TP_PROTO(struct sdw_bus *bus, struct sdw_msg *msg, int ret),
+
+	TP_ARGS(bus, msg, ret),
+
+	TP_STRUCT__entry(
+		__field(unsigned int, link_id)
+		__field(u16, dev_num)
+		__field(u16, addr)
+		__field(int, ret)
+	),
+
+	TP_fast_assign(
+		__entry->link_id = bus->link_id;
+		__entry->dev_num = msg->dev_num;
+		__entry->addr = msg->addr;
+		__entry->ret = ret;
+	),
+
+	TP_printk("link %u dev %u addr=0x%04x ret=%d",
+		  __entry->link_id, __entry->dev_num, __entry->addr,
+		  __entry->ret)
+);
+
+TRACE_EVENT(sdw_bank_switch,
+	TP_PROTO(struct sdw_stream_runtime *stream),
+
+	TP_ARGS(stream),
+
+	TP_STRUCT__entry(
+		__string(name, stream->name)
+		__field(int, m_rt_count)
+	),
+
+	TP_fast_assign(
+		__assign_str(name, stream->name);
+		__entry->m_rt_count = stream->m_rt_count;
+	),
+
+	TP_printk("stream %s links=%d", __get_str(name),
+		  __entry->m_rt_count)
+);
+
+TRACE_EVENT(sdw_bank_switch_done,
+	TP_PROTO(struct sdw_stream_runtime *stream, int ret, u64 latency_us),
+
+	TP_ARGS(stream, ret, latency_us),
+
+	TP_STRUCT__entry(
+		__string(name, stream->name)
+		__field(int, ret)
+		__field(u64, latency_us)
+	),
+
+	TP_fast_assign(
+		__assign_str(name, stream->name);
+		__entry->ret = ret;
+		__entry->latency_us = latency_us;
+	),
+
+	TP_printk("stream %s ret=%d latency=%lluus", __get_str(name),
+		  __entry->ret, __entry->latency_us)
+);
+
+TRACE_EVENT(sdw_prepare_stream_done,
+	TP_PROTO(struct sdw_stream_runtime *stream, int ret, u64 latency_us),
+
+	TP_ARGS(stream, ret, latency_us),
+
+	TP_STRUCT__entry(
+		__string(name, stream->name)
+		__field(int, ret)
+		__field(u64, latency_us)
+	),
+
+	TP_fast_assign(
+		__assign_str(name, stream->name);
+		__entry->ret = ret;
+		__entry->latency_us = latency_us;
+	),
+
+	TP_printk("stream %s ret=%d latency=%lluus", __get_str(name),
+		  __entry->ret, __entry->latency_us)
+);
+
+TRACE_EVENT(sdw_slave_status,
+	TP_PROTO(struct sdw_bus *bus, enum sdw_slave_status status[]),
+
+	TP_ARGS(bus, status),
+
+	TP_STRUCT__entry(
+		__field(unsigned int, link_id)
+		__field(u32, status)
+	),
+
+	TP_fast_assign(
+		int i;
+
+		__entry->link_id = bus->link_id;
+		__entry->status = 0;
+		for (i = 0; i <= SDW_MAX_DEVICES; i++)
+			__entry->status |= (status[i] & 0x3) << (i * 2);
+	),
+
+	/* two bits per device, device 0 in the least significant bits */
+	TP_printk("link %u status=0x%06x", __entry->link_id,
+		  __entry->status)
+);
+
+#endif /* __SDW_TRACE_H */
+
+/* This part must be outside protection */
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE trace
+
+#include <trace/define_trace.h>
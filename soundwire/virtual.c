@@ -0,0 +1,517 @@
+// SPDX-License-Identifier: (GPL-2.0 OR BSD-3-Clause)
+
+/*
+ * Virtual SoundWire Master
+ *
+ * Implements the Master ops on top of simulated Slaves backed by
+ * in-memory register files, with a configurable latency per command.
+ * This allows the bus core to be exercised and benchmarked without any
+ * hardware.
+ */
+
+#include <linux/delay.h>
+#include <linux/module.h>
+#include <linux/mod_devicetable.h>
+#include <linux/platform_device.h>
+#include <linux/slab.h>
+#include <linux/xarray.h>
+#include <dkms/linux/soundwire/sdw_registers.h>
+#include <dkms/linux/soundwire/sdw.h>
+#include "bus.h"
+#include "virtual.h"
+
+#define SDW_VIRTUAL_MAX_LINKS		4
+#define SDW_VIRTUAL_CLK_FREQ		9600000
+#define SDW_VIRTUAL_FRAME_RATE		48000
+#define SDW_VIRTUAL_ROWS		50
+#define SDW_VIRTUAL_COLS		8
+#define SDW_VIRTUAL_DEVNUMBER_MASK	GENMASK(3, 0)
+
+static int num_links = 1;
+module_param(num_links, int, 0444);
+MODULE_PARM_DESC(num_links, "Number of virtual links");
+
+static int num_slaves = 2;
+module_param(num_slaves, int, 0444);
+MODULE_PARM_DESC(num_slaves, "Number of simulated Slaves per link");
+
+static unsigned int cmd_latency_us;
+module_param(cmd_latency_us, uint, 0644);
+MODULE_PARM_DESC(cmd_latency_us, "Simulated latency per command, in us");
+
+/**
+ * struct sdw_virtual_slave - simulated Slave
+ *
+ * @id: Device ID reported during enumeration
+ * @dev_num: Device Number programmed by the bus, 0 until enumerated
+ * @page1: SCP_AddrPage1 register
+ * @page2: SCP_AddrPage2 register
+ * @regs: register file, indexed by the full 32-bit address
+ */
+struct sdw_virtual_slave {
+	struct sdw_slave_id id;
+	u16 dev_num;
+	u8 page1;
+	u8 page2;
+	struct xarray regs;
+};
+
+/**
+ * struct sdw_virtual - virtual Master instance
+ *
+ * @bus: bus instance
+ * @pdev: platform device of the link
+ * @slaves: simulated Slaves
+ * @num_slaves: number of simulated Slaves
+ * @enum_slave: Slave which answered the last Device0 DevID read
+ * @lock: protects the simulated Slaves
+ * @status_work: reports Slave status changes to the bus
+ */
+struct sdw_virtual {
+	struct sdw_bus bus;
+	struct platform_device *pdev;
+	struct sdw_virtual_slave *slaves;
+	int num_slaves;
+	struct sdw_virtual_slave *enum_slave;
+	struct mutex lock;
+	struct work_struct status_work;
+};
+
+#define bus_to_virtual(_bus) container_of(_bus, struct sdw_virtual, bus)
+
+static struct platform_device *sdw_virtual_pdev[SDW_VIRTUAL_MAX_LINKS];
+
+static void sdw_virtual_delay(unsigned int num_cmds)
+{
+	unsigned int us = num_cmds * READ_ONCE(cmd_latency_us);
+
+	if (!us)
+		return;
+
+	if (us < 10)
+		udelay(us);
+	else
+		usleep_range(us, us + us / 10 + 1);
+}
+
+/* called with vm->lock held */
+static struct sdw_virtual_slave *sdw_virtual_find(struct sdw_virtual *vm,
+						  u16 dev_num)
+{
+	int i;
+
+	for (i = 0; i < vm->num_slaves; i++) {
+		if (vm->slaves[i].dev_num == dev_num)
+			return &vm->slaves[i];
+	}
+
+	return NULL;
+}
+
+static u8 sdw_virtual_devid(struct sdw_virtual_slave *vs, u32 addr)
+{
+	struct sdw_slave_id *id = &vs->id;
+
+	switch (addr) {
+	case SDW_SCP_DEVID_0:
+		return id->sdw_version << 4 | id->unique_id;
+	case SDW_SCP_DEVID_0 + 1:
+		return id->mfg_id >> 8;
+	case SDW_SCP_DEVID_0 + 2:
+		return id->mfg_id & 0xff;
+	case SDW_SCP_DEVID_0 + 3:
+		return id->part_id >> 8;
+	case SDW_SCP_DEVID_0 + 4:
+		return id->part_id & 0xff;
+	default:
+		return id->class_id;
+	}
+}
+
+/* called with vm->lock held */
+static void sdw_virtual_access(struct sdw_virtual_slave *vs,
+			       struct sdw_msg *msg, int i)
+{
+	u32 addr = msg->addr + i;
+	void *entry;
+
+	/* paged access, SCP_AddrPage1/2 extend the address */
+	if (addr & SDW_REG_NO_PAGE)
+		addr = (vs->page1 << SDW_REG_SHIFT(SDW_SCP_ADDRPAGE1_MASK)) |
+			(vs->page2 << SDW_REG_SHIFT(SDW_SCP_ADDRPAGE2_MASK)) |
+			(addr & (SDW_REG_NO_PAGE - 1));
+
+	if (msg->flags == SDW_MSG_FLAG_READ) {
+		if (addr >= SDW_SCP_DEVID_0 && addr <= SDW_SCP_DEVID_5) {
+			msg->buf[i] = sdw_virtual_devid(vs, addr);
+			return;
+		}
+
+		entry = xa_load(&vs->regs, addr);
+		msg->buf[i] = entry ? xa_to_value(entry) : 0;
+		return;
+	}
+
+	switch (addr) {
+	case SDW_SCP_DEVNUMBER:
+		vs->dev_num = msg->buf[i] & SDW_VIRTUAL_DEVNUMBER_MASK;
+		break;
+	case SDW_SCP_ADDRPAGE1:
+		vs->page1 = msg->buf[i];
+		break;
+	case SDW_SCP_ADDRPAGE2:
+		vs->page2 = msg->buf[i];
+		break;
+	default:
+		break;
+	}
+
+	xa_store(&vs->regs, addr, xa_mk_value(msg->buf[i]), GFP_KERNEL);
+}
+
+static enum sdw_command_response
+_sdw_virtual_xfer_msg(struct sdw_virtual *vm, struct sdw_msg *msg)
+{
+	struct sdw_virtual_slave *vs;
+	int i, j;
+
+	sdw_virtual_delay(msg->len + (msg->page ? 2 : 0));
+
+	if (msg->dev_num == SDW_BROADCAST_DEV_NUM) {
+		if (msg->flags == SDW_MSG_FLAG_READ)
+			return SDW_CMD_FAIL;
+
+		for (j = 0; j < vm->num_slaves; j++) {
+			for (i = 0; i < msg->len; i++)
+				sdw_virtual_access(&vm->slaves[j], msg, i);
+		}
+
+		return vm->num_slaves ? SDW_CMD_OK : SDW_CMD_IGNORED;
+	}
+
+	/*
+	 * On Device0, DevID reads are answered by the first Slave still
+	 * to be enumerated, which then takes the next Device Number write.
+	 */
+	if (msg->dev_num == SDW_ENUM_DEV_NUM &&
+	    msg->flags == SDW_MSG_FLAG_READ)
+		vm->enum_slave = sdw_virtual_find(vm, SDW_ENUM_DEV_NUM);
+
+	if (msg->dev_num == SDW_ENUM_DEV_NUM)
+		vs = vm->enum_slave;
+	else
+		vs = sdw_virtual_find(vm, msg->dev_num);
+
+	if (!vs)
+		return SDW_CMD_IGNORED;
+
+	if (msg->page) {
+		vs->page1 = msg->addr_page1;
+		vs->page2 = msg->addr_page2;
+	}
+
+	for (i = 0; i < msg->len; i++)
+		sdw_virtual_access(vs, msg, i);
+
+	/* an enumerated Slave reports on its new Device Number */
+	if (msg->dev_num == SDW_ENUM_DEV_NUM && vs->dev_num) {
+		vm->enum_slave = NULL;
+		schedule_work(&vm->status_work);
+	}
+
+	return SDW_CMD_OK;
+}
+
+static enum sdw_command_response
+sdw_virtual_xfer_msg(struct sdw_bus *bus, struct sdw_msg *msg)
+{
+	struct sdw_virtual *vm = bus_to_virtual(bus);
+	enum sdw_command_response resp;
+
+	mutex_lock(&vm->lock);
+	resp = _sdw_virtual_xfer_msg(vm, msg);
+	mutex_unlock(&vm->lock);
+
+	return resp;
+}
+
+static enum sdw_command_response
+sdw_virtual_xfer_msg_batch(struct sdw_bus *bus, struct sdw_msg *msgs, int num)
+{
+	struct sdw_virtual *vm = bus_to_virtual(bus);
+	enum sdw_command_response resp = SDW_CMD_OK;
+	int i;
+
+	mutex_lock(&vm->lock);
+
+	for (i = 0; i < num; i++) {
+		resp = _sdw_virtual_xfer_msg(vm, &msgs[i]);
+		if (resp != SDW_CMD_OK)
+			break;
+	}
+
+	mutex_unlock(&vm->lock);
+
+	return resp;
+}
+
+static enum sdw_command_response
+sdw_virtual_xfer_msg_defer(struct sdw_bus *bus, struct sdw_msg *msg,
+			   struct sdw_defer *defer)
+{
+	enum sdw_command_response resp;
+
+	resp = sdw_virtual_xfer_msg(bus, msg);
+	complete(&defer->complete);
+
+	return resp;
+}
+
+static enum sdw_command_response
+sdw_virtual_reset_page_addr(struct sdw_bus *bus, unsigned int dev_num)
+{
+	struct sdw_virtual *vm = bus_to_virtual(bus);
+	struct sdw_virtual_slave *vs;
+
+	mutex_lock(&vm->lock);
+
+	sdw_virtual_delay(2);
+
+	vs = sdw_virtual_find(vm, dev_num);
+	if (vs) {
+		vs->page1 = 0;
+		vs->page2 = 0;
+	}
+
+	mutex_unlock(&vm->lock);
+
+	return vs ? SDW_CMD_OK : SDW_CMD_IGNORED;
+}
+
+static int sdw_virtual_set_bus_conf(struct sdw_bus *bus,
+				    struct sdw_bus_params *params)
+{
+	if (!params->curr_dr_freq)
+		return -EINVAL;
+
+	return 0;
+}
+
+static int sdw_virtual_bank_switch(struct sdw_bus *bus)
+{
+	return 0;
+}
+
+static int sdw_virtual_read_prop(struct sdw_bus *bus)
+{
+	struct sdw_master_prop *prop = &bus->prop;
+
+	prop->max_clk_freq = SDW_VIRTUAL_CLK_FREQ;
+	prop->mclk_freq = SDW_VIRTUAL_CLK_FREQ;
+	prop->default_frame_rate = SDW_VIRTUAL_FRAME_RATE;
+	prop->default_row = SDW_VIRTUAL_ROWS;
+	prop->default_col = SDW_VIRTUAL_COLS;
+	prop->num_lanes = SDW_VIRTUAL_LANES;
+
+	return 0;
+}
+
+static struct sdw_master_ops sdw_virtual_ops = {
+	.read_prop = sdw_virtual_read_prop,
+	.xfer_msg = sdw_virtual_xfer_msg,
+	.xfer_msg_batch = sdw_virtual_xfer_msg_batch,
+	.xfer_msg_defer = sdw_virtual_xfer_msg_defer,
+	.reset_page_addr = sdw_virtual_reset_page_addr,
+	.set_bus_conf = sdw_virtual_set_bus_conf,
+	.pre_bank_switch = sdw_virtual_bank_switch,
+	.post_bank_switch = sdw_virtual_bank_switch,
+};
+
+static int sdw_virtual_port_params(struct sdw_bus *bus,
+				   struct sdw_port_params *p_params,
+				   unsigned int bank)
+{
+	return 0;
+}
+
+static int sdw_virtual_transport_params(struct sdw_bus *bus,
+					struct sdw_transport_params *t_params,
+					enum sdw_reg_bank bank)
+{
+	return 0;
+}
+
+static int sdw_virtual_port_enable(struct sdw_bus *bus,
+				   struct sdw_enable_ch *enable_ch,
+				   unsigned int bank)
+{
+	return 0;
+}
+
+static struct sdw_master_port_ops sdw_virtual_port_ops = {
+	.dpn_set_port_params = sdw_virtual_port_params,
+	.dpn_set_port_transport_params = sdw_virtual_transport_params,
+	.dpn_port_enable_ch = sdw_virtual_port_enable,
+};
+
+/*
+ * Report the Slave status as a Master would on a status change
+ * interrupt: Device0 is attached while a Slave is waiting to be
+ * enumerated, enumerated Slaves are attached on their Device Number.
+ */
+static void sdw_virtual_status_work(struct work_struct *work)
+{
+	struct sdw_virtual *vm =
+		container_of(work, struct sdw_virtual, status_work);
+	enum sdw_slave_status status[SDW_MAX_DEVICES + 1] = { 0 };
+	u16 dev_num;
+	int i;
+
+	mutex_lock(&vm->lock);
+	for (i = 0; i < vm->num_slaves; i++) {
+		dev_num = vm->slaves[i].dev_num;
+		if (dev_num <= SDW_MAX_DEVICES)
+			status[dev_num] = SDW_SLAVE_ATTACHED;
+	}
+	mutex_unlock(&vm->lock);
+
+	sdw_handle_slave_status(&vm->bus, status);
+}
+
+static int sdw_virtual_probe(struct platform_device *pdev)
+{
+	struct sdw_virtual_slave *vs;
+	struct sdw_virtual *vm;
+	int ret, i;
+
+	vm = devm_kzalloc(&pdev->dev, sizeof(*vm), GFP_KERNEL);
+	if (!vm)
+		return -ENOMEM;
+
+	vm->num_slaves = clamp(num_slaves, 0, SDW_MAX_DEVICES);
+	vm->slaves = devm_kcalloc(&pdev->dev, vm->num_slaves,
+				  sizeof(*vm->slaves), GFP_KERNEL);
+	if (vm->num_slaves && !vm->slaves)
+		return -ENOMEM;
+
+	vm->pdev = pdev;
+	mutex_init(&vm->lock);
+	INIT_WORK(&vm->status_work, sdw_virtual_status_work);
+
+	for (i = 0; i < vm->num_slaves; i++) {
+		vs = &vm->slaves[i];
+		vs->id.mfg_id = SDW_VIRTUAL_MFG_ID;
+		vs->id.part_id = SDW_VIRTUAL_PART_ID;
+		vs->id.class_id = SDW_VIRTUAL_CLASS_ID;
+		vs->id.sdw_version = SDW_VIRTUAL_VERSION;
+		vs->id.unique_id = i;
+		xa_init(&vs->regs);
+	}
+
+	vm->bus.dev = &pdev->dev;
+	vm->bus.link_id = pdev->id;
+	vm->bus.ops = &sdw_virtual_ops;
+	vm->bus.port_ops = &sdw_virtual_port_ops;
+	vm->bus.compute_params = sdw_compute_params;
+	vm->bus.no_fw_slaves = true;
+
+	platform_set_drvdata(pdev, vm);
+
+	ret = sdw_add_bus_master(&vm->bus);
+	if (ret) {
+		dev_err(&pdev->dev, "sdw_add_bus_master fail: %d\n", ret);
+		goto err_free;
+	}
+
+	for (i = 0; i < vm->num_slaves; i++) {
+		ret = sdw_bus_add_slave(&vm->bus, &vm->slaves[i].id);
+		if (ret) {
+			dev_err(&pdev->dev, "Adding Slave %d failed: %d\n",
+				i, ret);
+			goto err_del;
+		}
+	}
+
+	/* all the Slaves attach on Device0 */
+	schedule_work(&vm->status_work);
+
+	return 0;
+
+err_del:
+	sdw_delete_bus_master(&vm->bus);
+err_free:
+	for (i = 0; i < vm->num_slaves; i++)
+		xa_destroy(&vm->slaves[i].regs);
+	return ret;
+}
+
+static int sdw_virtual_remove(struct platform_device *pdev)
+{
+	struct sdw_virtual *vm = platform_get_drvdata(pdev);
+	int i;
+
+	cancel_work_sync(&vm->status_work);
+	sdw_delete_bus_master(&vm->bus);
+
+	for (i = 0; i < vm->num_slaves; i++)
+		xa_destroy(&vm->slaves[i].regs);
+
+	return 0;
+}
+
+static struct platform_driver sdw_virtual_drv = {
+	.probe = sdw_virtual_probe,
+	.remove = sdw_virtual_remove,
+	.driver = {
+		.name = "sdw-virtual",
+	},
+};
+
+static void sdw_virtual_unregister_devices(void)
+{
+	int i;
+
+	for (i = 0; i < SDW_VIRTUAL_MAX_LINKS; i++) {
+		if (sdw_virtual_pdev[i])
+			platform_device_unregister(sdw_virtual_pdev[i]);
+		sdw_virtual_pdev[i] = NULL;
+	}
+}
+
+static int __init sdw_virtual_init(void)
+{
+	struct platform_device *pdev;
+	int ret, i;
+
+	ret = platform_driver_register(&sdw_virtual_drv);
+	if (ret)
+		return ret;
+
+	for (i = 0; i < clamp(num_links, 1, SDW_VIRTUAL_MAX_LINKS); i++) {
+		pdev = platform_device_register_simple("sdw-virtual", i,
+						       NULL, 0);
+		if (IS_ERR(pdev)) {
+			ret = PTR_ERR(pdev);
+			goto err;
+		}
+		sdw_virtual_pdev[i] = pdev;
+	}
+
+	return 0;
+
+err:
+	sdw_virtual_unregister_devices();
+	platform_driver_unregister(&sdw_virtual_drv);
+	return ret;
+}
+module_init(sdw_virtual_init);
+
+static void __exit sdw_virtual_exit(void)
+{
+	sdw_virtual_unregister_devices();
+	platform_driver_unregister(&sdw_virtual_drv);
+}
+module_exit(sdw_virtual_exit);
+
+MODULE_LICENSE("Dual BSD/GPL");
+MODULE_DESCRIPTION("Virtual SoundWire Master driver");
@@ -0,0 +1,23 @@
+/* SPDX-License-Identifier: (GPL-2.0 OR BSD-3-Clause) */
+
+#ifndef __SDW_VIRTUAL_H
+#define __SDW_VIRTUAL_H
+
+/*
+ * Device ID of the Slaves simulated by the virtual Master. The
+ * manufacturer ID is not assigned by MIPI, so it can't clash with real
+ * parts.
+ */
+#define SDW_VIRTUAL_MFG_ID		0x7fff
+#define SDW_VIRTUAL_PART_ID		0x0001
+#define SDW_VIRTUAL_CLASS_ID		0x00
+#define SDW_VIRTUAL_VERSION		0x2 /* SoundWire 1.1 */
+
+/* data ports implemented by the simulated Slaves */
+#define SDW_VIRTUAL_SOURCE_PORT		1
+#define SDW_VIRTUAL_SINK_PORT		2
+
+/* data lanes of the virtual Master, the Slave ports can use all of them */
+#define SDW_VIRTUAL_LANES		2
+
+#endif /* __SDW_VIRTUAL_H */
@@ -0,0 +1,350 @@
+// SPDX-License-Identifier: (GPL-2.0 OR BSD-3-Clause)
+
+/*
+ * Benchmark of the SoundWire bus core
+ *
+ * Binds to the Slaves simulated by the virtual Master and measures
+ * enumeration, register accesses and stream prepare/enable cycles.
+ * Reading the 'run' debugfs file of a Slave runs all the benchmarks.
+ */
+
+#include <linux/debugfs.h>
+#include <linux/ktime.h>
+#include <linux/module.h>
+#include <linux/mod_devicetable.h>
+#include <linux/seq_file.h>
+#include <linux/slab.h>
+#include <dkms/linux/soundwire/sdw_registers.h>
+#include <dkms/linux/soundwire/sdw.h>
+#include <dkms/linux/soundwire/sdw_type.h>
+#include "virtual.h"
+
+#define SDW_BENCH_REG			0x3000
+#define SDW_BENCH_PAGED_REG		0x00100000
+#define SDW_BENCH_BURST			32
+#define SDW_BENCH_BATCH			16
+#define SDW_BENCH_NUM_PORTS		(SDW_VIRTUAL_SINK_PORT + 1)
+
+static unsigned int iterations = 1000;
+module_param(iterations, uint, 0644);
+MODULE_PARM_DESC(iterations, "Number of iterations of each register test");
+
+static unsigned int stream_cycles = 20;
+module_param(stream_cycles, uint, 0644);
+MODULE_PARM_DESC(stream_cycles, "Number of stream prepare/enable cycles");
+
+/**
+ * struct sdw_bench - benchmark state of a simulated Slave
+ *
+ * @slave: SoundWire Slave
+ * @debugfs: debugfs directory of the Slave
+ * @probe_time: time of the driver probe
+ * @enum_us: time between probe and first attachment, in us
+ * @lock: serializes the benchmark runs
+ */
+struct sdw_bench {
+	struct sdw_slave *slave;
+	struct dentry *debugfs;
+	ktime_t probe_time;
+	s64 enum_us;
+	struct mutex lock;
+};
+
+static struct dentry *sdw_bench_root;
+
+static void sdw_bench_report(struct seq_file *s, const char *name,
+			     unsigned int ops, ktime_t start, int ret)
+{
+	s64 ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+	if (ret < 0) {
+		seq_printf(s, "%-24s failed: %d\n", name, ret);
+		return;
+	}
+
+	seq_printf(s, "%-24s %8u ops %10lld us %8lld ns/op\n", name, ops,
+		   div_s64(ns, NSEC_PER_USEC), ops ? div_s64(ns, ops) : 0);
+}
+
+static void sdw_bench_single(struct seq_file *s, struct sdw_slave *slave,
+			     const char *name, u32 addr)
+{
+	ktime_t start = ktime_get();
+	int ret = 0;
+	unsigned int i;
+
+	for (i = 0; i < iterations && ret >= 0; i++)
+		ret = sdw_write(slave, addr, i & 0xff);
+
+	sdw_bench_report(s, name, iterations, start, ret);
+}
+
+static void sdw_bench_burst(struct seq_file *s, struct sdw_slave *slave)
+{
+	u8 buf[SDW_BENCH_BURST];
+	unsigned int i, num;
+	ktime_t start;
+	int ret = 0;
+
+	num = iterations / SDW_BENCH_BURST;
+	memset(buf, 0x5a, sizeof(buf));
+
+	start = ktime_get();
+	for (i = 0; i < num && ret >= 0; i++)
+		ret = sdw_nwrite(slave, SDW_BENCH_REG, sizeof(buf), buf);
+	sdw_bench_report(s, "burst write", num * sizeof(buf), start, ret);
+
+	start = ktime_get();
+	for (i = 0; i < num && ret >= 0; i++)
+		ret = sdw_nread(slave, SDW_BENCH_REG, sizeof(buf), buf);
+	sdw_bench_report(s, "burst read", num * sizeof(buf), start, ret);
+}
+
+static void sdw_bench_batch(struct seq_file *s, struct sdw_slave *slave)
+{
+	struct sdw_slave_xfer xfers[SDW_BENCH_BATCH];
+	u8 buf[SDW_BENCH_BATCH];
+	unsigned int i, num;
+	ktime_t start;
+	int ret = 0;
+
+	for (i = 0; i < SDW_BENCH_BATCH; i++) {
+		buf[i] = i;
+		xfers[i].addr = SDW_BENCH_PAGED_REG + i;
+		xfers[i].count = 1;
+		xfers[i].buf = &buf[i];
+		xfers[i].read = false;
+	}
+
+	num = iterations / SDW_BENCH_BATCH;
+
+	start = ktime_get();
+	for (i = 0; i < num && ret >= 0; i++)
+		ret = sdw_xfer_batch(slave, xfers, SDW_BENCH_BATCH);
+	sdw_bench_report(s, "batched paged writes", num * SDW_BENCH_BATCH,
+			 start, ret);
+}
+
+static int sdw_bench_stream_cycle(struct sdw_stream_runtime *stream)
+{
+	int ret;
+
+	ret = sdw_prepare_stream(stream);
+	if (ret < 0)
+		return ret;
+
+	ret = sdw_enable_stream(stream);
+	if (ret < 0)
+		return ret;
+
+	ret = sdw_disable_stream(stream);
+	if (ret < 0)
+		return ret;
+
+	return sdw_deprepare_stream(stream);
+}
+
+static void sdw_bench_stream(struct seq_file *s, struct sdw_slave *slave)
+{
+	struct sdw_stream_config sconfig = {
+		.frame_rate = 48000,
+		.ch_count = 1,
+		.bps = 16,
+		.type = SDW_STREAM_PCM,
+	};
+	struct sdw_port_config pconfig = {
+		.ch_mask = 0x1,
+	};
+	struct sdw_stream_runtime *stream;
+	unsigned int i;
+	ktime_t start;
+	int ret;
+
+	stream = sdw_alloc_stream("sdw-bench");
+	if (!stream) {
+		seq_puts(s, "stream allocation failed\n");
+		return;
+	}
+
+	sconfig.direction = SDW_DATA_DIR_RX;
+	pconfig.num = SDW_VIRTUAL_SOURCE_PORT;
+	ret = sdw_stream_add_master(slave->bus, &sconfig, &pconfig, 1, stream);
+	if (ret < 0)
+		goto release;
+
+	sconfig.direction = SDW_DATA_DIR_TX;
+	ret = sdw_stream_add_slave(slave, &sconfig, &pconfig, 1, stream);
+	if (ret < 0)
+		goto remove_master;
+
+	start = ktime_get();
+	for (i = 0; i < stream_cycles && ret >= 0; i++)
+		ret = sdw_bench_stream_cycle(stream);
+	sdw_bench_report(s, "stream cycles", stream_cycles, start, ret);
+
+	sdw_stream_remove_slave(slave, stream);
+remove_master:
+	sdw_stream_remove_master(slave->bus, stream);
+release:
+	if (ret < 0)
+		seq_printf(s, "stream setup failed: %d\n", ret);
+	sdw_release_stream(stream);
+}
+
+static int sdw_bench_run_show(struct seq_file *s, void *data)
+{
+	struct sdw_bench *bench = s->private;
+	struct sdw_slave *slave = bench->slave;
+
+	mutex_lock(&bench->lock);
+
+	seq_printf(s, "%-24s %lld us\n", "enumeration", bench->enum_us);
+
+	sdw_bench_single(s, slave, "single writes", SDW_BENCH_REG);
+	sdw_bench_single(s, slave, "single paged writes",
+			 SDW_BENCH_PAGED_REG);
+	sdw_bench_burst(s, slave);
+	sdw_bench_batch(s, slave);
+	sdw_bench_stream(s, slave);
+
+	mutex_unlock(&bench->lock);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(sdw_bench_run);
+
+static int sdw_bench_read_prop(struct sdw_slave *slave)
+{
+	struct sdw_slave_prop *prop = &slave->prop;
+	struct sdw_dpn_prop *dpn;
+	int i;
+
+	prop->paging_support = true;
+	prop->lane_control_support = true;
+	prop->source_ports = BIT(SDW_VIRTUAL_SOURCE_PORT);
+	prop->sink_ports = BIT(SDW_VIRTUAL_SINK_PORT);
+
+	prop->src_dpn_prop = devm_kcalloc(&slave->dev, 1, sizeof(*dpn),
+					  GFP_KERNEL);
+	prop->sink_dpn_prop = devm_kcalloc(&slave->dev, 1, sizeof(*dpn),
+					   GFP_KERNEL);
+	if (!prop->src_dpn_prop || !prop->sink_dpn_prop)
+		return -ENOMEM;
+
+	dpn = prop->src_dpn_prop;
+	dpn->num = SDW_VIRTUAL_SOURCE_PORT;
+	dpn->type = SDW_DPN_FULL;
+	dpn->lanes = GENMASK(SDW_VIRTUAL_LANES - 1, 0);
+	dpn->simple_ch_prep_sm = true;
+	dpn->ch_prep_timeout = 10;
+
+	dpn = prop->sink_dpn_prop;
+	dpn->num = SDW_VIRTUAL_SINK_PORT;
+	dpn->type = SDW_DPN_FULL;
+	dpn->lanes = GENMASK(SDW_VIRTUAL_LANES - 1, 0);
+	dpn->simple_ch_prep_sm = true;
+	dpn->ch_prep_timeout = 10;
+
+	/* port_ready is indexed by port number */
+	slave->port_ready = devm_kcalloc(&slave->dev, SDW_BENCH_NUM_PORTS,
+					 sizeof(*slave->port_ready),
+					 GFP_KERNEL);
+	if (!slave->port_ready)
+		return -ENOMEM;
+
+	for (i = 0; i < SDW_BENCH_NUM_PORTS; i++)
+		init_completion(&slave->port_ready[i]);
+
+	prop->clk_stop_timeout = 20;
+
+	return 0;
+}
+
+static int sdw_bench_update_status(struct sdw_slave *slave,
+				   enum sdw_slave_status status)
+{
+	struct sdw_bench *bench = dev_get_drvdata(&slave->dev);
+
+	if (status == SDW_SLAVE_ATTACHED && !bench->enum_us)
+		bench->enum_us = ktime_us_delta(ktime_get(),
+						bench->probe_time);
+
+	return 0;
+}
+
+static const struct sdw_slave_ops sdw_bench_slave_ops = {
+	.read_prop = sdw_bench_read_prop,
+	.update_status = sdw_bench_update_status,
+};
+
+static int sdw_bench_probe(struct sdw_slave *slave,
+			   const struct sdw_device_id *id)
+{
+	struct sdw_bench *bench;
+
+	bench = devm_kzalloc(&slave->dev, sizeof(*bench), GFP_KERNEL);
+	if (!bench)
+		return -ENOMEM;
+
+	bench->slave = slave;
+	bench->probe_time = ktime_get();
+	mutex_init(&bench->lock);
+	dev_set_drvdata(&slave->dev, bench);
+
+	bench->debugfs = debugfs_create_dir(dev_name(&slave->dev),
+					    sdw_bench_root);
+	debugfs_create_file("run", 0400, bench->debugfs, bench,
+			    &sdw_bench_run_fops);
+
+	return 0;
+}
+
+static int sdw_bench_remove(struct sdw_slave *slave)
+{
+	struct sdw_bench *bench = dev_get_drvdata(&slave->dev);
+
+	debugfs_remove_recursive(bench->debugfs);
+
+	return 0;
+}
+
+static const struct sdw_device_id sdw_bench_id[] = {
+	SDW_SLAVE_ENTRY(SDW_VIRTUAL_MFG_ID, SDW_VIRTUAL_PART_ID, 0),
+	{},
+};
+MODULE_DEVICE_TABLE(sdw, sdw_bench_id);
+
+static struct sdw_driver sdw_bench_driver = {
+	.driver = {
+		.name = "sdw-virtual-bench",
+		.owner = THIS_MODULE,
+	},
+	.probe = sdw_bench_probe,
+	.remove = sdw_bench_remove,
+	.ops = &sdw_bench_slave_ops,
+	.id_table = sdw_bench_id,
+};
+
+static int __init sdw_bench_init(void)
+{
+	int ret;
+
+	sdw_bench_root = debugfs_create_dir("sdw-virtual-bench", NULL);
+
+	ret = sdw_register_driver(&sdw_bench_driver);
+	if (ret)
+		debugfs_remove_recursive(sdw_bench_root);
+
+	return ret;
+}
+module_init(sdw_bench_init);
+
+static void __exit sdw_bench_exit(void)
+{
+	sdw_unregister_driver(&sdw_bench_driver);
+	debugfs_remove_recursive(sdw_bench_root);
+}
+module_exit(sdw_bench_exit);
+
+MODULE_LICENSE("Dual BSD/GPL");
+MODULE_DESCRIPTION("SoundWire bus core benchmark");
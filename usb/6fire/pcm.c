@@ -203,6 +203,9 @@ static void usb6fire_pcm_capture(struct pcm_substream *sub, struct pcm_urb *urb)
 	u32 *dest_end = (u32 *) (alsa_rt->dma_area + alsa_rt->buffer_size
 			* (alsa_rt->frame_bits >> 3));
 	int bytes_per_frame = alsa_rt->channels << 2;
+	/* same layout on both sides, frames can be copied in runs */
+	bool packed = alsa_rt->channels == rt->in_n_analog;
+	int n;
 
 	for (i = 0; i < PCM_N_PACKETS_PER_URB; i++) {
 		/* at least 4 header bytes for valid packet.
@@ -221,12 +224,16 @@ static void usb6fire_pcm_capture(struct pcm_substream *sub, struct pcm_urb *urb)
 			return;
 		src++; /* skip leading 4 bytes of every packet */
 		total_length += urb->packets[i].length;
-		for (frame = 0; frame < frame_count; frame++) {
-			memcpy(dest, src, bytes_per_frame);
-			dest += alsa_rt->channels;
-			src += rt->in_n_analog;
-			sub->dma_off++;
-			sub->period_off++;
+		for (frame = 0; frame < frame_count; frame += n) {
+			n = 1;
+			if (packed)
+				n = min_t(int, frame_count - frame,
+					  (dest_end - dest) / alsa_rt->channels);
+			memcpy(dest, src, n * bytes_per_frame);
+			dest += n * alsa_rt->channels;
+			src += n * rt->in_n_analog;
+			sub->dma_off += n;
+			sub->period_off += n;
 			if (dest == dest_end) {
 				sub->dma_off = 0;
 				dest = (u32 *) alsa_rt->dma_area;
@@ -250,6 +257,9 @@ static void usb6fire_pcm_playback(struct pcm_substream *sub,
 			* (alsa_rt->frame_bits >> 3));
 	u32 *dest;
 	int bytes_per_frame = alsa_rt->channels << 2;
+	/* same layout on both sides, frames can be copied in runs */
+	bool packed = alsa_rt->channels == rt->out_n_analog;
+	int n;
 
 	if (alsa_rt->format == SNDRV_PCM_FORMAT_S32_LE)
 		dest = (u32 *) (urb->buffer - 1);
@@ -269,12 +279,16 @@ static void usb6fire_pcm_playback(struct pcm_substream *sub,
 		else
 			frame_count = 0;
 		dest++; /* skip leading 4 bytes of every frame */
-		for (frame = 0; frame < frame_count; frame++) {
-			memcpy(dest, src, bytes_per_frame);
-			src += alsa_rt->channels;
-			dest += rt->out_n_analog;
-			sub->dma_off++;
-			sub->period_off++;
+		for (frame = 0; frame < frame_count; frame += n) {
+			n = 1;
+			if (packed)
+				n = min_t(int, frame_count - frame,
+					  (src_end - src) / alsa_rt->channels);
+			memcpy(dest, src, n * bytes_per_frame);
+			src += n * alsa_rt->channels;
+			dest += n * rt->out_n_analog;
+			sub->dma_off += n;
+			sub->period_off += n;
 			if (src == src_end) {
 				src = (u32 *) alsa_rt->dma_area;
 				sub->dma_off = 0;
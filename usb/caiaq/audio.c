@@ -441,7 +441,7 @@ static void read_in_urb_mode3(struct snd_usb_caiaqdev *cdev,
 		for (stream = 0; stream < cdev->n_streams; stream++) {
 			struct snd_pcm_substream *sub = cdev->sub_capture[stream];
 			char *audio_buf = NULL;
-			int c, n, sz = 0;
+			int c, sz = 0;
 
 			if (sub && !cdev->input_panic) {
 				struct snd_pcm_runtime *rt = sub->runtime;
@@ -450,14 +450,17 @@ static void read_in_urb_mode3(struct snd_usb_caiaqdev *cdev,
 			}
 
 			for (c = 0; c < CHANNELS_PER_STREAM; c++) {
-				/* 3 audio data bytes, followed by 1 check byte */
+				/*
+				 * 3 audio data bytes, followed by 1 check byte.
+				 * The buffer holds whole frames, so a sample
+				 * never wraps around its end.
+				 */
 				if (audio_buf) {
-					for (n = 0; n < BYTES_PER_SAMPLE; n++) {
-						audio_buf[cdev->audio_in_buf_pos[stream]++] = usb_buf[i+n];
-
-						if (cdev->audio_in_buf_pos[stream] == sz)
-							cdev->audio_in_buf_pos[stream] = 0;
-					}
+					memcpy(audio_buf + cdev->audio_in_buf_pos[stream],
+					       usb_buf + i, BYTES_PER_SAMPLE);
+					cdev->audio_in_buf_pos[stream] += BYTES_PER_SAMPLE;
+					if (cdev->audio_in_buf_pos[stream] == sz)
+						cdev->audio_in_buf_pos[stream] = 0;
 
 					cdev->period_in_count[stream] += BYTES_PER_SAMPLE;
 				}
@@ -558,7 +561,7 @@ static void fill_out_urb_mode_3(struct snd_usb_caiaqdev *cdev,
 		for (stream = 0; stream < cdev->n_streams; stream++) {
 			struct snd_pcm_substream *sub = cdev->sub_playback[stream];
 			char *audio_buf = NULL;
-			int c, n, sz = 0;
+			int c, sz = 0;
 
 			if (sub) {
 				struct snd_pcm_runtime *rt = sub->runtime;
@@ -567,19 +570,19 @@ static void fill_out_urb_mode_3(struct snd_usb_caiaqdev *cdev,
 			}
 
 			for (c = 0; c < CHANNELS_PER_STREAM; c++) {
-				for (n = 0; n < BYTES_PER_SAMPLE; n++) {
-					if (audio_buf) {
-						usb_buf[i+n] = audio_buf[cdev->audio_out_buf_pos[stream]++];
-
-						if (cdev->audio_out_buf_pos[stream] == sz)
-							cdev->audio_out_buf_pos[stream] = 0;
-					} else {
-						usb_buf[i+n] = 0;
-					}
-				}
+				/* whole frames in the buffer, see read_in_urb_mode3() */
+				if (audio_buf) {
+					memcpy(usb_buf + i,
+					       audio_buf + cdev->audio_out_buf_pos[stream],
+					       BYTES_PER_SAMPLE);
+					cdev->audio_out_buf_pos[stream] += BYTES_PER_SAMPLE;
+					if (cdev->audio_out_buf_pos[stream] == sz)
+						cdev->audio_out_buf_pos[stream] = 0;
 
-				if (audio_buf)
 					cdev->period_out_count[stream] += BYTES_PER_SAMPLE;
+				} else {
+					memset(usb_buf + i, 0, BYTES_PER_SAMPLE);
+				}
 
 				i += BYTES_PER_SAMPLE;
 
@@ -75,6 +75,9 @@ static char *quirk_alias[SNDRV_CARDS];
 
 bool snd_usb_use_vmalloc = true;
 bool snd_usb_skip_validation;
+bool snd_usb_low_latency;
+bool snd_usb_batch_urbs;
+unsigned int snd_usb_clock_pll;
 
 module_param_array(index, int, NULL, 0444);
 MODULE_PARM_DESC(index, "Index value for the USB audio adapter.");
@@ -96,9 +99,15 @@ MODULE_PARM_DESC(autoclock, "Enable auto-clock selection for UAC2 devices (defau
 module_param_array(quirk_alias, charp, NULL, 0444);
 MODULE_PARM_DESC(quirk_alias, "Quirk aliases, e.g. 0123abcd:5678beef.");
 module_param_named(use_vmalloc, snd_usb_use_vmalloc, bool, 0444);
-MODULE_PARM_DESC(use_vmalloc, "Use vmalloc for PCM intermediate buffers (default: yes).");
+MODULE_PARM_DESC(use_vmalloc, "Use vmalloc for PCM intermediate buffers, no for playback without copy (default: yes).");
 module_param_named(skip_validation, snd_usb_skip_validation, bool, 0444);
 MODULE_PARM_DESC(skip_validation, "Skip unit descriptor validation (default: no).");
+module_param_named(low_latency, snd_usb_low_latency, bool, 0644);
+MODULE_PARM_DESC(low_latency, "Use one packet per URB and size the queue from the measured jitter (default: no).");
+module_param_named(batch_urbs, snd_usb_batch_urbs, bool, 0644);
+MODULE_PARM_DESC(batch_urbs, "Handle the URB completions of an endpoint in batches (default: no).");
+module_param_named(clock_pll, snd_usb_clock_pll, uint, 0644);
+MODULE_PARM_DESC(clock_pll, "Loop filter shift of the device clock recovery, 1 (fast) to 12 (slow), 0 = off (default: 0).");
 
 /*
  * we keep the snd_usb_audio_t instances by ourselves for merging
@@ -482,6 +491,7 @@ static int snd_usb_audio_create(struct usb_interface *intf,
 	atomic_set(&chip->shutdown, 0);
 
 	chip->usb_id = usb_id;
+	snd_usb_init_quirk_flags(chip);
 	INIT_LIST_HEAD(&chip->pcm_list);
 	INIT_LIST_HEAD(&chip->ep_list);
 	INIT_LIST_HEAD(&chip->midi_list);
@@ -5,7 +5,8 @@
 #define MAX_NR_RATES	1024
 #define MAX_PACKS	6		/* per URB */
 #define MAX_PACKS_HS	(MAX_PACKS * 8)	/* in high speed mode */
-#define MAX_URBS	12
+#define MAX_URBS	32	/* in low-latency mode */
+#define NR_URBS		12	/* otherwise */
 #define SYNC_URBS	4	/* always four urbs for sync */
 #define MAX_QUEUE	18	/* try not to exceed this queue length, in ms */
 
@@ -43,12 +44,16 @@ struct snd_usb_power_domain;
 struct snd_urb_ctx {
 	struct urb *urb;
 	unsigned int buffer_size;	/* size of data buffer, if data URB */
+	unsigned char *buffer;		/* data buffer, if data URB */
+	dma_addr_t buffer_dma;		/* DMA address of the data buffer */
 	struct snd_usb_substream *subs;
 	struct snd_usb_endpoint *ep;
 	int index;	/* index for urb array */
 	int packets;	/* number of packets per urb */
 	int packet_size[MAX_PACKS_HS]; /* size of packets for next submission */
 	struct list_head ready_list;
+	struct list_head completed_list;	/* in batch mode */
+	ktime_t completed;	/* completion time, in batch mode */
 };
 
 struct snd_usb_endpoint {
@@ -76,6 +81,8 @@ struct snd_usb_endpoint {
 	} next_packet[MAX_URBS];
 	int next_packet_read_pos, next_packet_write_pos;
 	struct list_head ready_playback_urbs;
+	struct list_head completed_urbs;	/* waiting for batch_tasklet */
+	struct tasklet_struct batch_tasklet;
 
 	unsigned int nurbs;		/* # urbs */
 	unsigned long active_mask;	/* bitmask of active urbs */
@@ -89,6 +96,11 @@ struct snd_usb_endpoint {
 	int	   freqshift;		/* how much to shift the feedback value to get Q16.16 */
 	unsigned int freqmax;		/* maximum sampling rate, used for buffer management */
 	unsigned int phase;		/* phase accumulator */
+	unsigned int pll_freq;		/* recovered device rate, same format as freqm */
+	s64 pll_err;			/* implicit feedback: frames received - sent, Q16.16 */
+	unsigned int pll_acc;		/* fractional accumulator of the recovered sizes */
+	u64 pll_frames;			/* frames transferred since the start */
+	ktime_t pll_stamp;		/* time of the last pll_frames update */
 	unsigned int maxpacksize;	/* max packet size in bytes */
 	unsigned int maxframesize;      /* max packet size in frames */
 	unsigned int max_urb_frames;	/* max URB size in frames */
@@ -97,7 +109,28 @@ struct snd_usb_endpoint {
 	unsigned int syncmaxsize;	/* sync endpoint packet size */
 	unsigned int fill_max:1;	/* fill max packet size always */
 	unsigned int tenor_fb_quirk:1;	/* corrupted feedback data */
+	unsigned int low_latency:1;	/* one packet per URB, queue sized from jitter */
+	unsigned int batch:1;		/* completions handled from batch_tasklet */
 	unsigned int datainterval;      /* log_2 of data packet interval */
+	unsigned int packet_ns;		/* duration of a data packet */
+	ktime_t last_complete;		/* time of the last URB completion */
+	unsigned int jitter_ns;		/* URB completion jitter, peak decaying */
+	unsigned int cost_ns;		/* average time to handle a completion */
+
+	/* timing statistics since the start, see proc.c */
+	struct snd_usb_ep_stats {
+#define SND_USB_EP_INTERVALS	7
+		/* completion intervals, in ranges of the nominal interval */
+		unsigned int interval[SND_USB_EP_INTERVALS];
+		unsigned int late_submits;	/* resubmitted after one URB time */
+		unsigned int dry;		/* completed with no other URB queued */
+		unsigned int packet_errors;	/* ISO packets not transferred */
+		unsigned int depth_min, depth_max; /* URBs queued */
+		unsigned int feedback;		/* sync feedback values applied */
+		unsigned int feedback_rejected;	/* ... and out of range */
+		unsigned int freq_min, freq_max; /* range of freqm */
+		unsigned int implicit_lag_max;	/* pending implicit fb packets */
+	} stats;
 	unsigned int syncinterval;	/* P for adaptive mode, 0 otherwise */
 	unsigned char silence_value;
 	unsigned int stride;
@@ -130,6 +163,7 @@ struct snd_usb_substream {
 	unsigned int altset_idx;     /* USB data format: index of alternate setting */
 	unsigned int txfr_quirk:1;	/* allow sub-frame alignment */
 	unsigned int tx_length_quirk:1;	/* add length specifier to transfers */
+	unsigned int zero_copy:1;	/* playback URBs may point into the PCM buffer */
 	unsigned int fmt_type;		/* USB audio format type (1-3) */
 	unsigned int pkt_offset_adj;	/* Bytes to drop from beginning of packets (for non-compliant devices) */
 
@@ -164,6 +198,7 @@ struct snd_usb_substream {
 	} dsd_dop;
 
 	bool trigger_tstamp_pending_update; /* trigger timestamp being updated from initial estimate */
+	atomic_t period_elapsed_pending;	/* reported by the endpoint, in batch mode */
 	struct media_ctl *media_ctl;
 };
 
@@ -75,8 +75,7 @@ static void release_urb_ctx(struct snd_urb_ctx *u)
 {
 	if (u->buffer_size)
 		usb_free_coherent(u->ep->chip->dev, u->buffer_size,
-				  u->urb->transfer_buffer,
-				  u->urb->transfer_dma);
+				  u->buffer, u->buffer_dma);
 	usb_free_urb(u->urb);
 	u->urb = NULL;
 }
@@ -146,9 +145,98 @@ int snd_usb_endpoint_next_packet_size(struct snd_usb_endpoint *ep)
 	return ret;
 }
 
+/*
+ * Device clock recovery
+ *
+ * When enabled with the clock_pll option, pll_freq follows the rate the
+ * device clock runs at, in the format of freqm.  With the loop filter
+ * shift k, a phase error (frames received but not sent yet, only known
+ * with implicit feedback) is corrected with a gain of 2^-k and integrated
+ * into the rate with a gain of 2^-2k, which makes a critically damped
+ * second order loop; the rates seen alone are low pass filtered with a
+ * gain of 2^-k.
+ */
+static unsigned int clock_pll_shift(void)
+{
+	return clamp_val(snd_usb_clock_pll, 1, 12);
+}
+
+static void clock_pll_set_freq(struct snd_usb_endpoint *ep, s64 freq)
+{
+	ep->pll_freq = clamp_t(s64, freq, ep->freqn - ep->freqn / 8,
+			       ep->freqmax);
+}
+
+/*
+ * count the frames transferred by a data urb over @packets valid packets;
+ * called with ep->lock held
+ */
+static void clock_pll_count(struct snd_usb_endpoint *ep,
+			    unsigned int frames, unsigned int packets)
+{
+	u32 freq;
+
+	ep->pll_frames += frames;
+	ep->pll_stamp = ktime_get();
+
+	/* capture only: the packet sizes follow the device clock */
+	if (!snd_usb_clock_pll || !frames || usb_pipeout(ep->pipe))
+		return;
+	freq = div_u64((u64)frames << 16, packets) >> ep->datainterval;
+	clock_pll_set_freq(ep, ep->pll_freq +
+			   (((s64)freq - ep->pll_freq) >> clock_pll_shift()));
+}
+
+/*
+ * implicit feedback: compute the sizes of the output packets from the
+ * recovered rate instead of copying the jittery input packet sizes,
+ * the phase error keeps the frames sent in step with the frames received
+ */
+static void clock_pll_fill(struct snd_usb_endpoint *ep,
+			   struct snd_usb_packet_info *packet,
+			   unsigned int frames)
+{
+	unsigned int shift = clock_pll_shift();
+	unsigned int i, size, n = packet->packets;
+	s64 rate, err, step;
+
+	rate = (s64)ep->pll_freq << ep->datainterval;
+	err = ep->pll_err + ((s64)frames << 16) - n * rate;
+	if (abs(err) > ((s64)n * ep->maxframesize << 16)) {
+		/* lost lock, e.g. after dropped packets: restart from here */
+		rate = div_u64((u64)frames << 16, n);
+		clock_pll_set_freq(ep, rate >> ep->datainterval);
+		rate = (s64)ep->pll_freq << ep->datainterval;
+		ep->pll_err = 0;
+		err = ((s64)frames << 16) - n * rate;
+	}
+
+	/* integral path: the rate follows the accumulated phase error */
+	clock_pll_set_freq(ep, ep->pll_freq +
+			   ((err >> (2 * shift)) >> ep->datainterval));
+	/* proportional path: spread the correction over the packets */
+	step = max_t(s64, rate + div_s64(err >> shift, n), 0);
+
+	ep->pll_err += (s64)frames << 16;
+	for (i = 0; i < n; i++) {
+		ep->pll_acc = (ep->pll_acc & 0xffff) + step;
+		size = min(ep->pll_acc >> 16, ep->maxframesize);
+		packet->packet_size[i] = size;
+		ep->pll_err -= (s64)size << 16;
+	}
+	ep->freqm = ep->pll_freq;
+}
+
 static void retire_outbound_urb(struct snd_usb_endpoint *ep,
 				struct snd_urb_ctx *urb_ctx)
 {
+	unsigned long flags;
+
+	spin_lock_irqsave(&ep->lock, flags);
+	clock_pll_count(ep, urb_ctx->urb->transfer_buffer_length / ep->stride,
+			urb_ctx->packets);
+	spin_unlock_irqrestore(&ep->lock, flags);
+
 	if (ep->retire_data_urb)
 		ep->retire_data_urb(ep->data_subs, urb_ctx->urb);
 }
@@ -157,12 +245,26 @@ static void retire_inbound_urb(struct snd_usb_endpoint *ep,
 			       struct snd_urb_ctx *urb_ctx)
 {
 	struct urb *urb = urb_ctx->urb;
+	unsigned int i, bytes = 0, packets = 0;
+	unsigned long flags;
 
 	if (unlikely(ep->skip_packets > 0)) {
 		ep->skip_packets--;
 		return;
 	}
 
+	if (ep->type == SND_USB_ENDPOINT_TYPE_DATA) {
+		for (i = 0; i < urb_ctx->packets; i++) {
+			if (urb->iso_frame_desc[i].status == 0) {
+				bytes += urb->iso_frame_desc[i].actual_length;
+				packets++;
+			}
+		}
+		spin_lock_irqsave(&ep->lock, flags);
+		clock_pll_count(ep, bytes / ep->stride, packets);
+		spin_unlock_irqrestore(&ep->lock, flags);
+	}
+
 	if (ep->sync_slave)
 		snd_usb_handle_sync_urb(ep->sync_slave, ep, urb);
 
@@ -224,6 +326,9 @@ static void prepare_outbound_urb(struct snd_usb_endpoint *ep,
 
 	switch (ep->type) {
 	case SND_USB_ENDPOINT_TYPE_DATA:
+		/* the last submission may have pointed into the PCM buffer */
+		urb->transfer_buffer = ctx->buffer;
+		urb->transfer_dma = ctx->buffer_dma;
 		if (ep->prepare_data_urb) {
 			ep->prepare_data_urb(ep->data_subs, urb);
 		} else {
@@ -349,16 +454,94 @@ static void queue_pending_output_urbs(struct snd_usb_endpoint *ep)
 	}
 }
 
+/* upper bounds of the interval statistics, in % of the nominal interval */
+static const unsigned int ep_stats_interval_pct[SND_USB_EP_INTERVALS - 1] = {
+	50, 90, 110, 150, 200, 400
+};
+
+static void update_ep_stats(struct snd_usb_endpoint *ep, struct urb *urb,
+			    s64 urb_ns, s64 delta, s64 submit_ns)
+{
+	struct snd_usb_ep_stats *stats = &ep->stats;
+	unsigned int i, depth, pct;
+
+	for (i = 0; i < urb->number_of_packets; i++)
+		if (urb->iso_frame_desc[i].status)
+			stats->packet_errors++;
+
+	/* including the urb just resubmitted */
+	depth = hweight_long(ep->active_mask);
+	if (depth <= 1)
+		stats->dry++;
+	if (!stats->depth_max || depth < stats->depth_min)
+		stats->depth_min = depth;
+	if (depth > stats->depth_max)
+		stats->depth_max = depth;
+
+	if (submit_ns > urb_ns)
+		stats->late_submits++;
+
+	if (delta < 0 || !urb_ns)
+		return;
+	pct = div64_s64(delta * 100, urb_ns);
+	for (i = 0; i < ARRAY_SIZE(ep_stats_interval_pct); i++)
+		if (pct < ep_stats_interval_pct[i])
+			break;
+	stats->interval[i]++;
+}
+
+static void update_freq_stats(struct snd_usb_endpoint *ep, unsigned int freq)
+{
+	struct snd_usb_ep_stats *stats = &ep->stats;
+
+	stats->feedback++;
+	if (!stats->freq_max || freq < stats->freq_min)
+		stats->freq_min = freq;
+	if (freq > stats->freq_max)
+		stats->freq_max = freq;
+}
+
 /*
- * complete callback for urbs
+ * track the URB completion jitter, used to size the queue in low-latency
+ * mode, the time spent handling a completion and the timing statistics
  */
-static void snd_complete_urb(struct urb *urb)
+static void update_urb_stats(struct snd_usb_endpoint *ep, struct urb *urb,
+			     ktime_t completed, ktime_t start)
 {
-	struct snd_urb_ctx *ctx = urb->context;
+	ktime_t now = ktime_get();
+	unsigned int cost = ktime_to_ns(ktime_sub(now, start));
+	s64 urb_ns = (s64)urb->number_of_packets * ep->packet_ns;
+	s64 delta = -1, dev;
+
+	ep->cost_ns += (cost >> 3) - (ep->cost_ns >> 3);
+
+	if (ep->last_complete) {
+		delta = ktime_to_ns(ktime_sub(completed, ep->last_complete));
+		dev = abs(delta - urb_ns);
+		/* a single stall shouldn't inflate the queue forever */
+		dev = min_t(s64, dev, MAX_QUEUE * NSEC_PER_MSEC);
+		if (dev > ep->jitter_ns)
+			ep->jitter_ns = dev;
+		else
+			ep->jitter_ns -= (ep->jitter_ns - dev) >> 4;
+	}
+	ep->last_complete = completed;
+
+	update_ep_stats(ep, urb, urb_ns, delta,
+			ktime_to_ns(ktime_sub(now, completed)));
+}
+
+/*
+ * retire a completed urb and prepare its next submission
+ *
+ * returns true if the urb has to be resubmitted; otherwise it is no
+ * longer active or it was handed to queue_pending_output_urbs()
+ */
+static bool process_urb(struct snd_urb_ctx *ctx)
+{
+	struct urb *urb = ctx->urb;
 	struct snd_usb_endpoint *ep = ctx->ep;
-	struct snd_pcm_substream *substream;
 	unsigned long flags;
-	int err;
 
 	if (unlikely(urb->status == -ENOENT ||		/* unlinked */
 		     urb->status == -ENODEV ||		/* device removed */
@@ -384,7 +567,7 @@ static void snd_complete_urb(struct urb *urb)
 			spin_unlock_irqrestore(&ep->lock, flags);
 			queue_pending_output_urbs(ep);
 
-			goto exit_clear;
+			return false;
 		}
 
 		prepare_outbound_urb(ep, ctx);
@@ -400,9 +583,27 @@ static void snd_complete_urb(struct urb *urb)
 		prepare_inbound_urb(ep, ctx);
 	}
 
+	return true;
+
+exit_clear:
+	clear_bit(ctx->index, &ep->active_mask);
+	return false;
+}
+
+static void resubmit_urb(struct snd_urb_ctx *ctx, ktime_t completed,
+			 ktime_t start)
+{
+	struct urb *urb = ctx->urb;
+	struct snd_usb_endpoint *ep = ctx->ep;
+	struct snd_pcm_substream *substream;
+	int err;
+
 	err = usb_submit_urb(urb, GFP_ATOMIC);
-	if (err == 0)
+	if (err == 0) {
+		if (ep->type == SND_USB_ENDPOINT_TYPE_DATA)
+			update_urb_stats(ep, urb, completed, start);
 		return;
+	}
 
 	usb_audio_err(ep->chip, "cannot submit urb (err = %d)\n", err);
 	if (ep->data_subs && ep->data_subs->pcm_substream) {
@@ -410,10 +611,73 @@ static void snd_complete_urb(struct urb *urb)
 		snd_pcm_stop_xrun(substream);
 	}
 
-exit_clear:
 	clear_bit(ctx->index, &ep->active_mask);
 }
 
+static void flush_period_elapsed(struct snd_usb_substream *subs)
+{
+	if (subs && subs->pcm_substream &&
+	    atomic_xchg(&subs->period_elapsed_pending, 0))
+		snd_pcm_period_elapsed(subs->pcm_substream);
+}
+
+/*
+ * batch mode: handle all the urbs the host controller completed since
+ * the last pass, retire and prepare them, then resubmit them together
+ * and report the elapsed periods once
+ */
+static void drain_completed_urbs(unsigned long data)
+{
+	struct snd_usb_endpoint *ep = (struct snd_usb_endpoint *)data;
+	struct snd_urb_ctx *ctx, *next;
+	ktime_t start = ktime_get();
+	unsigned long flags;
+	LIST_HEAD(done);
+	LIST_HEAD(submit);
+
+	spin_lock_irqsave(&ep->lock, flags);
+	list_splice_init(&ep->completed_urbs, &done);
+	spin_unlock_irqrestore(&ep->lock, flags);
+
+	list_for_each_entry_safe(ctx, next, &done, completed_list) {
+		list_del(&ctx->completed_list);
+		if (process_urb(ctx))
+			list_add_tail(&ctx->completed_list, &submit);
+	}
+
+	list_for_each_entry_safe(ctx, next, &submit, completed_list) {
+		list_del(&ctx->completed_list);
+		resubmit_urb(ctx, ctx->completed, start);
+	}
+
+	flush_period_elapsed(ep->data_subs);
+	if (ep->sync_slave)
+		flush_period_elapsed(ep->sync_slave->data_subs);
+}
+
+/*
+ * complete callback for urbs
+ */
+static void snd_complete_urb(struct urb *urb)
+{
+	struct snd_urb_ctx *ctx = urb->context;
+	struct snd_usb_endpoint *ep = ctx->ep;
+	ktime_t start = ktime_get();
+	unsigned long flags;
+
+	if (ep->batch) {
+		ctx->completed = start;
+		spin_lock_irqsave(&ep->lock, flags);
+		list_add_tail(&ctx->completed_list, &ep->completed_urbs);
+		spin_unlock_irqrestore(&ep->lock, flags);
+		tasklet_hi_schedule(&ep->batch_tasklet);
+		return;
+	}
+
+	if (process_urb(ctx))
+		resubmit_urb(ctx, start, start);
+}
+
 /**
  * snd_usb_add_endpoint: Add an endpoint to an USB audio chip
  *
@@ -472,6 +736,9 @@ struct snd_usb_endpoint *snd_usb_add_endpoint(struct snd_usb_audio *chip,
 	ep->iface = alts->desc.bInterfaceNumber;
 	ep->altsetting = alts->desc.bAlternateSetting;
 	INIT_LIST_HEAD(&ep->ready_playback_urbs);
+	INIT_LIST_HEAD(&ep->completed_urbs);
+	tasklet_init(&ep->batch_tasklet, drain_completed_urbs,
+		     (unsigned long)ep);
 	ep_num &= USB_ENDPOINT_NUMBER_MASK;
 
 	if (is_playback)
@@ -683,15 +950,23 @@ static int data_ep_set_params(struct snd_usb_endpoint *ep,
 	if (snd_usb_get_speed(ep->chip->dev) != USB_SPEED_FULL) {
 		packs_per_ms = 8 >> ep->datainterval;
 		max_packs_per_urb = MAX_PACKS_HS;
+		ep->packet_ns = (NSEC_PER_MSEC / 8) << ep->datainterval;
 	} else {
 		packs_per_ms = 1;
 		max_packs_per_urb = MAX_PACKS;
+		ep->packet_ns = NSEC_PER_MSEC << ep->datainterval;
 	}
 	if (sync_ep && !snd_usb_endpoint_implicit_feedback_sink(ep))
 		max_packs_per_urb = min(max_packs_per_urb,
 					1U << sync_ep->syncinterval);
 	max_packs_per_urb = max(1u, max_packs_per_urb >> ep->datainterval);
 
+	/* wireless devices need several packets per URB for bursting */
+	ep->low_latency = snd_usb_low_latency &&
+		snd_usb_get_speed(ep->chip->dev) != USB_SPEED_WIRELESS;
+	if (ep->low_latency)
+		max_packs_per_urb = 1;
+
 	/*
 	 * Capture endpoints need to use small URBs because there's no way
 	 * to tell in advance where the next period will end, and we don't
@@ -721,13 +996,16 @@ static int data_ep_set_params(struct snd_usb_endpoint *ep,
 		urb_packs = min(max_packs_per_urb, urb_packs);
 		while (urb_packs > 1 && urb_packs * maxsize >= period_bytes)
 			urb_packs >>= 1;
-		ep->nurbs = MAX_URBS;
+		ep->nurbs = NR_URBS;
 
 	/*
 	 * Playback endpoints without implicit sync are adjusted so that
 	 * a period fits as evenly as possible in the smallest number of
 	 * URBs.  The total number of URBs is adjusted to the size of the
-	 * ALSA buffer, subject to the MAX_URBS and MAX_QUEUE limits.
+	 * ALSA buffer, subject to the NR_URBS and MAX_QUEUE limits.
+	 *
+	 * In low-latency mode, the queue holds a period plus twice the
+	 * completion jitter measured on the previous runs, and no more.
 	 */
 	} else {
 		/* determine how small a packet can be */
@@ -751,10 +1029,19 @@ static int data_ep_set_params(struct snd_usb_endpoint *ep,
 		ep->max_urb_frames = DIV_ROUND_UP(frames_per_period,
 					urbs_per_period);
 
-		/* try to use enough URBs to contain an entire ALSA buffer */
-		max_urbs = min((unsigned) MAX_URBS,
-				MAX_QUEUE * packs_per_ms / urb_packs);
-		ep->nurbs = min(max_urbs, urbs_per_period * periods_per_buffer);
+		if (ep->low_latency) {
+			max_urbs = min((unsigned int)MAX_URBS,
+				       urbs_per_period * periods_per_buffer);
+			ep->nurbs = urbs_per_period + 1 +
+				DIV_ROUND_UP(2 * ep->jitter_ns, ep->packet_ns);
+			ep->nurbs = clamp(ep->nurbs, 2U, max_urbs);
+		} else {
+			/* try to use enough URBs to contain an entire ALSA buffer */
+			max_urbs = min((unsigned) NR_URBS,
+				       MAX_QUEUE * packs_per_ms / urb_packs);
+			ep->nurbs = min(max_urbs,
+					urbs_per_period * periods_per_buffer);
+		}
 	}
 
 	/* allocate and initialize data urbs */
@@ -771,11 +1058,12 @@ static int data_ep_set_params(struct snd_usb_endpoint *ep,
 		if (!u->urb)
 			goto out_of_memory;
 
-		u->urb->transfer_buffer =
-			usb_alloc_coherent(ep->chip->dev, u->buffer_size,
-					   GFP_KERNEL, &u->urb->transfer_dma);
-		if (!u->urb->transfer_buffer)
+		u->buffer = usb_alloc_coherent(ep->chip->dev, u->buffer_size,
+					       GFP_KERNEL, &u->buffer_dma);
+		if (!u->buffer)
 			goto out_of_memory;
+		u->urb->transfer_buffer = u->buffer;
+		u->urb->transfer_dma = u->buffer_dma;
 		u->urb->pipe = ep->pipe;
 		u->urb->transfer_flags = URB_NO_TRANSFER_DMA_MAP;
 		u->urb->interval = 1 << ep->datainterval;
@@ -881,6 +1169,7 @@ int snd_usb_endpoint_set_params(struct snd_usb_endpoint *ep,
 
 	/* calculate the frequency in 16.16 format */
 	ep->freqm = ep->freqn;
+	ep->pll_freq = ep->freqn;
 	ep->freqshift = INT_MIN;
 
 	ep->phase = 0;
@@ -936,6 +1225,13 @@ int snd_usb_endpoint_start(struct snd_usb_endpoint *ep)
 	ep->active_mask = 0;
 	ep->unlink_mask = 0;
 	ep->phase = 0;
+	ep->last_complete = 0;
+	ep->pll_err = 0;
+	ep->pll_acc = 0;
+	ep->pll_frames = 0;
+	ep->pll_stamp = 0;
+	memset(&ep->stats, 0, sizeof(ep->stats));
+	ep->batch = snd_usb_batch_urbs;
 
 	snd_usb_endpoint_start_quirk(ep);
 
@@ -1060,6 +1356,7 @@ void snd_usb_endpoint_release(struct snd_usb_endpoint *ep)
  */
 void snd_usb_endpoint_free(struct snd_usb_endpoint *ep)
 {
+	tasklet_kill(&ep->batch_tasklet);
 	kfree(ep);
 }
 
@@ -1093,16 +1390,19 @@ void snd_usb_handle_sync_urb(struct snd_usb_endpoint *ep,
 	    ep->use_count != 0) {
 
 		/* implicit feedback case */
-		int i, bytes = 0;
+		int i, bytes = 0, errors = 0;
 		struct snd_urb_ctx *in_ctx;
 		struct snd_usb_packet_info *out_packet;
 
 		in_ctx = urb->context;
 
 		/* Count overall packet size */
-		for (i = 0; i < in_ctx->packets; i++)
+		for (i = 0; i < in_ctx->packets; i++) {
 			if (urb->iso_frame_desc[i].status == 0)
 				bytes += urb->iso_frame_desc[i].actual_length;
+			else
+				errors++;
+		}
 
 		/*
 		 * skip empty packets. At least M-Audio's Fast Track Ultra stops
@@ -1125,16 +1425,27 @@ void snd_usb_handle_sync_urb(struct snd_usb_endpoint *ep,
 		 */
 
 		out_packet->packets = in_ctx->packets;
-		for (i = 0; i < in_ctx->packets; i++) {
-			if (urb->iso_frame_desc[i].status == 0)
-				out_packet->packet_size[i] =
-					urb->iso_frame_desc[i].actual_length / sender->stride;
-			else
-				out_packet->packet_size[i] = 0;
+		if (!errors)
+			update_freq_stats(ep, div_u64((u64)(bytes / sender->stride) << 16,
+						      in_ctx->packets) >> ep->datainterval);
+		if (snd_usb_clock_pll && !errors) {
+			clock_pll_fill(ep, out_packet, bytes / sender->stride);
+		} else {
+			for (i = 0; i < in_ctx->packets; i++) {
+				if (urb->iso_frame_desc[i].status == 0)
+					out_packet->packet_size[i] =
+						urb->iso_frame_desc[i].actual_length / sender->stride;
+				else
+					out_packet->packet_size[i] = 0;
+			}
 		}
 
 		ep->next_packet_write_pos++;
 		ep->next_packet_write_pos %= MAX_URBS;
+		i = (ep->next_packet_write_pos - ep->next_packet_read_pos +
+		     MAX_URBS) % MAX_URBS;
+		if (i > ep->stats.implicit_lag_max)
+			ep->stats.implicit_lag_max = i;
 		spin_unlock_irqrestore(&ep->lock, flags);
 		queue_pending_output_urbs(ep);
 
@@ -1207,7 +1518,14 @@ void snd_usb_handle_sync_urb(struct snd_usb_endpoint *ep,
 		 * This value is referred to in prepare_playback_urb().
 		 */
 		spin_lock_irqsave(&ep->lock, flags);
+		if (snd_usb_clock_pll) {
+			clock_pll_set_freq(ep, ep->pll_freq +
+					   (((s64)f - ep->pll_freq) >>
+					    clock_pll_shift()));
+			f = ep->pll_freq;
+		}
 		ep->freqm = f;
+		update_freq_stats(ep, f);
 		spin_unlock_irqrestore(&ep->lock, flags);
 	} else {
 		/*
@@ -1215,6 +1533,7 @@ void snd_usb_handle_sync_urb(struct snd_usb_endpoint *ep,
 		 * Reset it so that we autodetect again the next time.
 		 */
 		ep->freqshift = INT_MIN;
+		ep->stats.feedback_rejected++;
 	}
 }
 
@@ -89,40 +89,13 @@ void line6_capture_copy(struct snd_line6_pcm *line6pcm, char *fbuf, int fsize)
 	const int bytes_per_frame =
 		line6pcm->properties->bytes_per_channel *
 		line6pcm->properties->capture_hw.channels_max;
-	int frames = fsize / bytes_per_frame;
 
 	if (runtime == NULL)
 		return;
 
-	if (line6pcm->in.pos_done + frames > runtime->buffer_size) {
-		/*
-		   The transferred area goes over buffer boundary,
-		   copy two separate chunks.
-		 */
-		int len;
-
-		len = runtime->buffer_size - line6pcm->in.pos_done;
-
-		if (len > 0) {
-			memcpy(runtime->dma_area +
-			       line6pcm->in.pos_done * bytes_per_frame, fbuf,
-			       len * bytes_per_frame);
-			memcpy(runtime->dma_area, fbuf + len * bytes_per_frame,
-			       (frames - len) * bytes_per_frame);
-		} else {
-			/* this is somewhat paranoid */
-			dev_err(line6pcm->line6->ifcdev,
-				"driver bug: len = %d\n", len);
-		}
-	} else {
-		/* copy single chunk */
-		memcpy(runtime->dma_area +
-		       line6pcm->in.pos_done * bytes_per_frame, fbuf, fsize);
-	}
-
-	line6pcm->in.pos_done += frames;
-	if (line6pcm->in.pos_done >= runtime->buffer_size)
-		line6pcm->in.pos_done -= runtime->buffer_size;
+	line6pcm->in.pos_done = line6_pcm_copy(runtime, line6pcm->in.pos_done,
+					       fbuf, fsize / bytes_per_frame,
+					       bytes_per_frame, true);
 }
 
 void line6_capture_check_period(struct snd_line6_pcm *line6pcm, int length)
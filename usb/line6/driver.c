@@ -23,6 +23,11 @@
 #define DRIVER_AUTHOR  "Markus Grabner <grabner@icg.tugraz.at>"
 #define DRIVER_DESC    "Line 6 USB Driver"
 
+static unsigned int high_iso_buffers = USB_HIGH_ISO_BUFFERS;
+module_param(high_iso_buffers, uint, 0444);
+MODULE_PARM_DESC(high_iso_buffers,
+		 "Number of queued audio URBs on high speed devices, 2-16 (fewer is lower latency).");
+
 /*
 	This is Line 6's MIDI manufacturer ID.
 */
@@ -538,7 +543,8 @@ static void line6_get_usb_properties(struct usb_line6 *line6)
 		line6->iso_buffers = USB_LOW_ISO_BUFFERS;
 	} else {
 		line6->intervals_per_second = USB_HIGH_INTERVALS_PER_SECOND;
-		line6->iso_buffers = USB_HIGH_ISO_BUFFERS;
+		line6->iso_buffers = clamp_val(high_iso_buffers, 2,
+					       USB_HIGH_ISO_BUFFERS);
 	}
 }
 
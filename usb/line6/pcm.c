@@ -295,6 +295,37 @@ snd_pcm_uframes_t snd_line6_pointer(struct snd_pcm_substream *substream)
 	return pstr->pos_done;
 }
 
+/*
+	Copy frames between a linear buffer and the ALSA ring buffer, in at
+	most two chunks around the end of the ring buffer.
+	Returns the new ring buffer position.
+*/
+snd_pcm_uframes_t line6_pcm_copy(struct snd_pcm_runtime *runtime,
+				 snd_pcm_uframes_t pos, void *buf,
+				 unsigned int frames, int bytes_per_frame,
+				 bool to_ring)
+{
+	unsigned int len;
+
+	while (frames) {
+		len = min_t(snd_pcm_uframes_t, frames,
+			    runtime->buffer_size - pos);
+		if (to_ring)
+			memcpy(runtime->dma_area + pos * bytes_per_frame, buf,
+			       len * bytes_per_frame);
+		else
+			memcpy(buf, runtime->dma_area + pos * bytes_per_frame,
+			       len * bytes_per_frame);
+		buf += len * bytes_per_frame;
+		frames -= len;
+		pos += len;
+		if (pos >= runtime->buffer_size)
+			pos = 0;
+	}
+
+	return pos;
+}
+
 /* Acquire and optionally start duplex streams:
  * type is either LINE6_STREAM_IMPULSE or LINE6_STREAM_MONITOR
  */
@@ -187,6 +187,10 @@ extern int snd_line6_hw_params(struct snd_pcm_substream *substream,
 			       struct snd_pcm_hw_params *hw_params);
 extern int snd_line6_hw_free(struct snd_pcm_substream *substream);
 extern snd_pcm_uframes_t snd_line6_pointer(struct snd_pcm_substream *substream);
+extern snd_pcm_uframes_t line6_pcm_copy(struct snd_pcm_runtime *runtime,
+					snd_pcm_uframes_t pos, void *buf,
+					unsigned int frames,
+					int bytes_per_frame, bool to_ring);
 extern void line6_pcm_disconnect(struct snd_line6_pcm *line6pcm);
 extern int line6_pcm_acquire(struct snd_line6_pcm *line6pcm, int type,
 			       bool start);
@@ -6,6 +6,7 @@
  */
 
 #include <linux/slab.h>
+#include <asm/unaligned.h>
 #include <dkms/sound/core.h>
 #include <dkms/sound/pcm.h>
 #include <dkms/sound/pcm_params.h>
@@ -15,46 +16,50 @@
 #include "pcm.h"
 #include "playback.h"
 
+static inline int get_s24(const unsigned char *p)
+{
+	return p[0] + (p[1] << 8) + ((signed char)p[2] << 16);
+}
+
+static inline void put_s24(unsigned char *p, int val)
+{
+	p[0] = val;
+	p[1] = val >> 8;
+	p[2] = val >> 16;
+}
+
 /*
 	Software stereo volume control.
 */
 static void change_volume(struct urb *urb_out, int volume[],
 			  int bytes_per_frame)
 {
-	int chn = 0;
+	const int vol_l = volume[0], vol_r = volume[1];
+	int frames = urb_out->transfer_buffer_length / bytes_per_frame;
 
-	if (volume[0] == 256 && volume[1] == 256)
+	if (vol_l == 256 && vol_r == 256)
 		return;		/* maximum volume - no change */
 
+	/* whole stereo frames, with the volume of each channel hoisted */
 	if (bytes_per_frame == 4) {
-		__le16 *p, *buf_end;
+		__le16 *p = urb_out->transfer_buffer;
 
-		p = (__le16 *)urb_out->transfer_buffer;
-		buf_end = p + urb_out->transfer_buffer_length / sizeof(*p);
+		for (; frames > 0; --frames, p += 2) {
+			int l = ((s16)le16_to_cpu(p[0]) * vol_l) >> 8;
+			int r = ((s16)le16_to_cpu(p[1]) * vol_r) >> 8;
 
-		for (; p < buf_end; ++p) {
-			short pv = le16_to_cpu(*p);
-			int val = (pv * volume[chn & 1]) >> 8;
-			pv = clamp(val, -0x8000, 0x7fff);
-			*p = cpu_to_le16(pv);
-			++chn;
+			p[0] = cpu_to_le16(clamp(l, -0x8000, 0x7fff));
+			p[1] = cpu_to_le16(clamp(r, -0x8000, 0x7fff));
 		}
 	} else if (bytes_per_frame == 6) {
-		unsigned char *p, *buf_end;
-
-		p = (unsigned char *)urb_out->transfer_buffer;
-		buf_end = p + urb_out->transfer_buffer_length;
+		unsigned char *p = urb_out->transfer_buffer;
 
-		for (; p < buf_end; p += 3) {
-			int val;
+		for (; frames > 0; --frames, p += 6) {
+			int l = (get_s24(p) * vol_l) >> 8;
+			int r = (get_s24(p + 3) * vol_r) >> 8;
 
-			val = p[0] + (p[1] << 8) + ((signed char)p[2] << 16);
-			val = (val * volume[chn & 1]) >> 8;
-			val = clamp(val, -0x800000, 0x7fffff);
-			p[0] = val;
-			p[1] = val >> 8;
-			p[2] = val >> 16;
-			++chn;
+			put_s24(p, clamp(l, -0x800000, 0x7fffff));
+			put_s24(p + 3, clamp(r, -0x800000, 0x7fffff));
 		}
 	}
 }
@@ -67,29 +72,21 @@ static void create_impulse_test_signal(struct snd_line6_pcm *line6pcm,
 {
 	int frames = urb_out->transfer_buffer_length / bytes_per_frame;
 
+	/* keep the left (first) channel of each captured frame */
 	if (bytes_per_frame == 4) {
-		int i;
-		short *pi = (short *)line6pcm->prev_fbuf;
-		short *po = (short *)urb_out->transfer_buffer;
-
-		for (i = 0; i < frames; ++i) {
-			po[0] = pi[0];
-			po[1] = 0;
-			pi += 2;
-			po += 2;
-		}
+		const __le32 mask = cpu_to_le32(0xffff);
+		const u32 *pi = (const u32 *)line6pcm->prev_fbuf;
+		u32 *po = urb_out->transfer_buffer;
+
+		for (; frames > 0; --frames)
+			*po++ = get_unaligned(pi++) & (__force u32)mask;
 	} else if (bytes_per_frame == 6) {
-		int i, j;
 		unsigned char *pi = line6pcm->prev_fbuf;
 		unsigned char *po = urb_out->transfer_buffer;
 
-		for (i = 0; i < frames; ++i) {
-			for (j = 0; j < bytes_per_frame / 2; ++j)
-				po[j] = pi[j];
-
-			for (; j < bytes_per_frame; ++j)
-				po[j] = 0;
-
+		for (; frames > 0; --frames) {
+			memcpy(po, pi, 3);
+			memset(po + 3, 0, 3);
 			pi += bytes_per_frame;
 			po += bytes_per_frame;
 		}
@@ -112,18 +109,25 @@ static void add_monitor_signal(struct urb *urb_out, unsigned char *signal,
 		return;		/* zero volume - no change */
 
 	if (bytes_per_frame == 4) {
-		__le16 *pi, *po, *buf_end;
-
-		pi = (__le16 *)signal;
-		po = (__le16 *)urb_out->transfer_buffer;
-		buf_end = po + urb_out->transfer_buffer_length / sizeof(*po);
-
-		for (; po < buf_end; ++pi, ++po) {
-			short pov = le16_to_cpu(*po);
-			short piv = le16_to_cpu(*pi);
-			int val = pov + ((piv * volume) >> 8);
-			pov = clamp(val, -0x8000, 0x7fff);
-			*po = cpu_to_le16(pov);
+		const __le16 *pi = (const __le16 *)signal;
+		__le16 *po = urb_out->transfer_buffer;
+		int samples = urb_out->transfer_buffer_length / sizeof(*po);
+		int val;
+
+		/* both channels mix the same way, run over all samples */
+		if (volume == 256) {
+			for (; samples > 0; --samples, ++pi, ++po) {
+				val = (s16)le16_to_cpu(*po) +
+				      (s16)le16_to_cpu(*pi);
+				*po = cpu_to_le16(clamp(val, -0x8000, 0x7fff));
+			}
+			return;
+		}
+
+		for (; samples > 0; --samples, ++pi, ++po) {
+			val = (s16)le16_to_cpu(*po) +
+			      (((s16)le16_to_cpu(*pi) * volume) >> 8);
+			*po = cpu_to_le16(clamp(val, -0x8000, 0x7fff));
 		}
 	}
 
@@ -205,36 +209,10 @@ static int submit_audio_out_urb(struct snd_line6_pcm *line6pcm)
 		struct snd_pcm_runtime *runtime =
 		    get_substream(line6pcm, SNDRV_PCM_STREAM_PLAYBACK)->runtime;
 
-		if (line6pcm->out.pos + urb_frames > runtime->buffer_size) {
-			/*
-			   The transferred area goes over buffer boundary,
-			   copy the data to the temp buffer.
-			 */
-			int len;
-
-			len = runtime->buffer_size - line6pcm->out.pos;
-
-			if (len > 0) {
-				memcpy(urb_out->transfer_buffer,
-				       runtime->dma_area +
-				       line6pcm->out.pos * bytes_per_frame,
-				       len * bytes_per_frame);
-				memcpy(urb_out->transfer_buffer +
-				       len * bytes_per_frame, runtime->dma_area,
-				       (urb_frames - len) * bytes_per_frame);
-			} else
-				dev_err(line6pcm->line6->ifcdev, "driver bug: len = %d\n",
-					len);
-		} else {
-			memcpy(urb_out->transfer_buffer,
-			       runtime->dma_area +
-			       line6pcm->out.pos * bytes_per_frame,
-			       urb_out->transfer_buffer_length);
-		}
-
-		line6pcm->out.pos += urb_frames;
-		if (line6pcm->out.pos >= runtime->buffer_size)
-			line6pcm->out.pos -= runtime->buffer_size;
+		line6pcm->out.pos = line6_pcm_copy(runtime, line6pcm->out.pos,
+						   urb_out->transfer_buffer,
+						   urb_frames, bytes_per_frame,
+						   false);
 
 		change_volume(urb_out, line6pcm->volume_playback,
 			      bytes_per_frame);
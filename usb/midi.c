@@ -38,6 +38,7 @@
 #include <linux/kernel.h>
 #include <linux/types.h>
 #include <linux/bitops.h>
+#include <linux/hrtimer.h>
 #include <linux/interrupt.h>
 #include <linux/spinlock.h>
 #include <linux/string.h>
@@ -77,6 +78,10 @@ MODULE_AUTHOR("Clemens Ladisch <clemens@ladisch.de>");
 MODULE_DESCRIPTION("USB Audio/MIDI helper module");
 MODULE_LICENSE("Dual BSD/GPL");
 
+static unsigned int out_hold_us;
+module_param(out_hold_us, uint, 0644);
+MODULE_PARM_DESC(out_hold_us, "Maximum time in us a partially filled output URB waits for more data while other URBs are in flight (default: 0 = no wait).");
+
 
 struct usb_ms_header_descriptor {
 	__u8  bLength;
@@ -145,6 +150,10 @@ struct snd_usb_midi_out_endpoint {
 	struct tasklet_struct tasklet;
 	unsigned int next_urb;
 	spinlock_t buffer_lock;
+	/* next_urb is partially filled and waits for more data */
+	unsigned int urb_held:1;
+	ktime_t hold_deadline;
+	struct hrtimer hold_timer;
 
 	struct usbmidi_out_port {
 		struct snd_usb_midi_out_endpoint *ep;
@@ -303,6 +312,34 @@ static void snd_usbmidi_out_urb_complete(struct urb *urb)
 	snd_usbmidi_do_output(ep);
 }
 
+/*
+ * Checks whether a partially filled URB should wait for more data instead
+ * of being sent right away.  As long as other URBs are in flight, sending
+ * it would not get the data out any sooner than the next completion, so
+ * packets from all ports accumulate in it until then, or until it is full,
+ * or at most out_hold_us.  Only protocols building their data with
+ * output_packet can append to an URB.
+ */
+static bool snd_usbmidi_hold_urb(struct snd_usb_midi_out_endpoint *ep,
+				 struct urb *urb)
+{
+	unsigned int hold_us = READ_ONCE(out_hold_us);
+	ktime_t now;
+
+	if (!hold_us || !ep->active_urbs ||
+	    !ep->umidi->usb_protocol_ops->output_packet ||
+	    urb->transfer_buffer_length + 4 > ep->max_transfer)
+		return false;
+
+	now = ktime_get();
+	if (!ep->urb_held) {
+		ep->hold_deadline = ktime_add_us(now, hold_us);
+		hrtimer_start(&ep->hold_timer, ns_to_ktime(hold_us * NSEC_PER_USEC),
+			      HRTIMER_MODE_REL);
+	}
+	return ktime_before(now, ep->hold_deadline);
+}
+
 /*
  * This is called when some data should be transferred to the device
  * (from one or more substreams).
@@ -312,6 +349,7 @@ static void snd_usbmidi_do_output(struct snd_usb_midi_out_endpoint *ep)
 	unsigned int urb_index;
 	struct urb *urb;
 	unsigned long flags;
+	bool held;
 
 	spin_lock_irqsave(&ep->buffer_lock, flags);
 	if (ep->umidi->disconnected) {
@@ -323,11 +361,20 @@ static void snd_usbmidi_do_output(struct snd_usb_midi_out_endpoint *ep)
 	for (;;) {
 		if (!(ep->active_urbs & (1 << urb_index))) {
 			urb = ep->urbs[urb_index].urb;
-			urb->transfer_buffer_length = 0;
+			/* a held URB is always next_urb, keep appending to it */
+			held = ep->urb_held;
+			if (!held)
+				urb->transfer_buffer_length = 0;
 			ep->umidi->usb_protocol_ops->output(ep, urb);
 			if (urb->transfer_buffer_length == 0)
 				break;
 
+			ep->urb_held = snd_usbmidi_hold_urb(ep, urb);
+			if (ep->urb_held)
+				break;
+			if (held)
+				hrtimer_try_to_cancel(&ep->hold_timer);
+
 			dump_urb("sending", urb->transfer_buffer,
 				 urb->transfer_buffer_length);
 			urb->dev = ep->umidi->dev;
@@ -352,6 +399,17 @@ static void snd_usbmidi_out_tasklet(unsigned long data)
 	snd_usbmidi_do_output(ep);
 }
 
+/* the latency budget of a held URB is over, send it */
+static enum hrtimer_restart snd_usbmidi_out_hold_timer(struct hrtimer *timer)
+{
+	struct snd_usb_midi_out_endpoint *ep =
+		container_of(timer, struct snd_usb_midi_out_endpoint,
+			     hold_timer);
+
+	tasklet_schedule(&ep->tasklet);
+	return HRTIMER_NORESTART;
+}
+
 /* called after transfers had been interrupted due to some USB error */
 static void snd_usbmidi_error_timer(struct timer_list *t)
 {
@@ -654,22 +712,35 @@ static void snd_usbmidi_transmit_byte(struct usbmidi_out_port *port,
 static void snd_usbmidi_standard_output(struct snd_usb_midi_out_endpoint *ep,
 					struct urb *urb)
 {
+	unsigned int length;
+	bool progress;
 	int p;
 
-	/* FIXME: lower-numbered ports can starve higher-numbered ports */
-	for (p = 0; p < 0x10; ++p) {
-		struct usbmidi_out_port *port = &ep->ports[p];
-		if (!port->active)
-			continue;
-		while (urb->transfer_buffer_length + 3 < ep->max_transfer) {
-			uint8_t b;
-			if (snd_rawmidi_transmit(port->substream, &b, 1) != 1) {
-				port->active = 0;
-				break;
+	/*
+	 * Take one packet from each port in turn so that lower-numbered
+	 * ports cannot starve higher-numbered ports.
+	 */
+	do {
+		progress = false;
+		for (p = 0; p < 0x10; ++p) {
+			struct usbmidi_out_port *port = &ep->ports[p];
+			if (!port->active)
+				continue;
+			length = urb->transfer_buffer_length;
+			while (urb->transfer_buffer_length == length &&
+			       urb->transfer_buffer_length + 3 < ep->max_transfer) {
+				uint8_t b;
+				if (snd_rawmidi_transmit(port->substream, &b, 1) != 1) {
+					port->active = 0;
+					break;
+				}
+				snd_usbmidi_transmit_byte(port, b, urb);
 			}
-			snd_usbmidi_transmit_byte(port, b, urb);
+			if (urb->transfer_buffer_length != length)
+				progress = true;
 		}
-	}
+	} while (progress &&
+		 urb->transfer_buffer_length + 3 < ep->max_transfer);
 }
 
 static const struct usb_protocol_ops snd_usbmidi_standard_ops = {
@@ -1192,6 +1263,13 @@ static void snd_usbmidi_output_drain(struct snd_rawmidi_substream *substream)
 
 	if (ep->umidi->disconnected)
 		return;
+
+	/* don't let a held URB wait for more data */
+	spin_lock_irq(&ep->buffer_lock);
+	ep->hold_deadline = 0;
+	spin_unlock_irq(&ep->buffer_lock);
+	snd_usbmidi_do_output(ep);
+
 	/*
 	 * The substream buffer is empty, but some data might still be in the
 	 * currently active URBs, so we have to wait for those to complete.
@@ -1442,6 +1520,8 @@ static int snd_usbmidi_out_endpoint_create(struct snd_usb_midi *umidi,
 
 	spin_lock_init(&ep->buffer_lock);
 	tasklet_init(&ep->tasklet, snd_usbmidi_out_tasklet, (unsigned long)ep);
+	hrtimer_init(&ep->hold_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	ep->hold_timer.function = snd_usbmidi_out_hold_timer;
 	init_waitqueue_head(&ep->drain_wait);
 
 	for (i = 0; i < 0x10; ++i)
@@ -1501,14 +1581,17 @@ void snd_usbmidi_disconnect(struct list_head *p)
 
 	for (i = 0; i < MIDI_MAX_ENDPOINTS; ++i) {
 		struct snd_usb_midi_endpoint *ep = &umidi->endpoints[i];
-		if (ep->out)
+		if (ep->out) {
+			hrtimer_cancel(&ep->out->hold_timer);
 			tasklet_kill(&ep->out->tasklet);
+		}
 		if (ep->out) {
 			for (j = 0; j < OUTPUT_URBS; ++j)
 				usb_kill_urb(ep->out->urbs[j].urb);
 			if (umidi->usb_protocol_ops->finish_out_endpoint)
 				umidi->usb_protocol_ops->finish_out_endpoint(ep->out);
 			ep->out->active_urbs = 0;
+			ep->out->urb_held = 0;
 			if (ep->out->drain_urbs) {
 				ep->out->drain_urbs = 0;
 				wake_up(&ep->out->drain_wait);
@@ -49,6 +49,7 @@
 #include "helper.h"
 #include "mixer_quirks.h"
 #include "power.h"
+#include "quirks.h"
 
 #define MAX_ID_ELEMS	256
 
@@ -3433,6 +3434,163 @@ static int create_keep_iface_ctl(struct usb_mixer_interface *mixer)
 	return snd_ctl_add(mixer->chip->card, kctl);
 }
 
+/*
+ * prefetch the current values of all the standard controls into their
+ * cache, with up to MIXER_PREFETCH_URBS control requests in flight
+ * instead of one synchronous request per control and channel; the
+ * values failing here are read on demand as before
+ */
+#define MIXER_PREFETCH_URBS	16
+
+struct mixer_prefetch_req {
+	struct urb *urb;
+	struct usb_ctrlrequest setup;
+	struct usb_mixer_elem_info *cval;
+	int channel;
+	int index;
+	int len;
+	unsigned char *buf;
+};
+
+static void mixer_prefetch_complete(struct urb *urb)
+{
+	/* the results are picked up once the whole batch is done */
+}
+
+static int mixer_prefetch_submit(struct usb_mixer_interface *mixer,
+				 struct usb_anchor *anchor,
+				 struct mixer_prefetch_req *req)
+{
+	struct usb_mixer_elem_info *cval = req->cval;
+	struct usb_device *dev = mixer->chip->dev;
+	int validx = ((cval->control << 8) | req->channel) + cval->idx_off;
+
+	if (mixer->protocol == UAC_VERSION_1) {
+		req->setup.bRequest = UAC_GET_CUR;
+		req->len = cval->val_type >= USB_MIXER_S16 ? 2 : 1;
+	} else {
+		req->setup.bRequest = UAC2_CS_CUR;
+		req->len = uac2_ctl_value_size(cval->val_type);
+	}
+	req->setup.bRequestType = USB_RECIP_INTERFACE | USB_TYPE_CLASS |
+		USB_DIR_IN;
+	req->setup.wValue = cpu_to_le16(validx);
+	req->setup.wIndex = cpu_to_le16(mixer_ctrl_intf(mixer) |
+					(cval->head.id << 8));
+	req->setup.wLength = cpu_to_le16(req->len);
+
+	req->urb = usb_alloc_urb(0, GFP_KERNEL);
+	req->buf = kzalloc(sizeof(u32), GFP_KERNEL);
+	if (!req->urb || !req->buf)
+		return -ENOMEM;
+	usb_fill_control_urb(req->urb, dev, usb_rcvctrlpipe(dev, 0),
+			     (unsigned char *)&req->setup, req->buf, req->len,
+			     mixer_prefetch_complete, req);
+	usb_anchor_urb(req->urb, anchor);
+	return usb_submit_urb(req->urb, GFP_KERNEL);
+}
+
+static void mixer_prefetch_finish(struct mixer_prefetch_req *reqs, int count)
+{
+	struct mixer_prefetch_req *req;
+	int i;
+
+	for (i = 0, req = reqs; i < count; i++, req++) {
+		if (req->urb && !req->urb->status &&
+		    req->urb->actual_length >= req->len) {
+			req->cval->cache_val[req->index] =
+				convert_signed_value(req->cval,
+					snd_usb_combine_bytes(req->buf,
+							      req->len));
+			req->cval->cached |= 1 << req->channel;
+		}
+		usb_free_urb(req->urb);
+		kfree(req->buf);
+	}
+	memset(reqs, 0, count * sizeof(*reqs));
+}
+
+/* queue the requests for the uncached channels of a control */
+static int mixer_prefetch_cval(struct usb_mixer_interface *mixer,
+			       struct usb_anchor *anchor,
+			       struct mixer_prefetch_req *reqs, int *count,
+			       struct usb_mixer_elem_info *cval)
+{
+	struct mixer_prefetch_req *req;
+	int c, idx = 0, err;
+
+	/* channel 0 is the master, used without cmask */
+	for (c = 0; c <= MAX_CHANNELS; c++) {
+		if (cval->cmask) {
+			if (!c || !(cval->cmask & (1 << (c - 1))))
+				continue;
+		} else if (c) {
+			break;
+		}
+		if (cval->cached & (1 << c)) {
+			idx++;
+			continue;
+		}
+
+		req = &reqs[(*count)++];
+		req->cval = cval;
+		req->channel = c;
+		req->index = idx++;
+		err = mixer_prefetch_submit(mixer, anchor, req);
+		if (err < 0)
+			return err;
+
+		if (*count < MIXER_PREFETCH_URBS)
+			continue;
+		if (!usb_wait_anchor_empty_timeout(anchor,
+						   USB_CTRL_GET_TIMEOUT))
+			return -ETIMEDOUT;
+		mixer_prefetch_finish(reqs, *count);
+		*count = 0;
+	}
+
+	return 0;
+}
+
+static void snd_usb_mixer_prefetch(struct usb_mixer_interface *mixer)
+{
+	struct snd_usb_audio *chip = mixer->chip;
+	struct usb_mixer_elem_list *list;
+	struct mixer_prefetch_req *reqs;
+	struct usb_anchor anchor;
+	int id, count = 0;
+
+	/* devices needing a delay between the requests are read on demand */
+	if (snd_usb_ctl_msg_delay(chip))
+		return;
+
+	reqs = kcalloc(MIXER_PREFETCH_URBS, sizeof(*reqs), GFP_KERNEL);
+	if (!reqs)
+		return;
+	init_usb_anchor(&anchor);
+
+	if (snd_usb_lock_shutdown(chip))
+		goto free;
+
+	for (id = 0; id < MAX_ID_ELEMS; id++) {
+		for_each_mixer_elem(list, mixer, id) {
+			if (list->dump != snd_usb_mixer_dump_cval)
+				continue;
+			if (mixer_prefetch_cval(mixer, &anchor, reqs, &count,
+						mixer_elem_list_to_info(list)))
+				goto out;
+		}
+	}
+
+ out:
+	if (!usb_wait_anchor_empty_timeout(&anchor, USB_CTRL_GET_TIMEOUT))
+		usb_kill_anchored_urbs(&anchor);
+	mixer_prefetch_finish(reqs, count);
+	snd_usb_unlock_shutdown(chip);
+ free:
+	kfree(reqs);
+}
+
 int snd_usb_create_mixer(struct snd_usb_audio *chip, int ctrlif,
 			 int ignore_error)
 {
@@ -3481,6 +3639,8 @@ int snd_usb_create_mixer(struct snd_usb_audio *chip, int ctrlif,
 			goto _error;
 	}
 
+	snd_usb_mixer_prefetch(mixer);
+
 	err = snd_usb_mixer_status_create(mixer);
 	if (err < 0)
 		goto _error;
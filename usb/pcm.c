@@ -7,6 +7,8 @@
 #include <linux/bitrev.h>
 #include <linux/ratelimit.h>
 #include <linux/usb.h>
+#include <linux/usb/hcd.h>
+#include <asm/unaligned.h>
 #include <dkms/linux/usb/audio.h>
 #include <dkms/linux/usb/audio-v2.h>
 
@@ -78,6 +80,59 @@ static snd_pcm_uframes_t snd_usb_pcm_pointer(struct snd_pcm_substream *substream
 	return hwptr_done / (substream->runtime->frame_bits >> 3);
 }
 
+/*
+ * report the link time estimated from the frames the data endpoint
+ * transferred, interpolated since the last urb with the recovered rate
+ */
+static int snd_usb_pcm_get_time_info(struct snd_pcm_substream *substream,
+			struct timespec64 *system_ts, struct timespec64 *audio_ts,
+			struct snd_pcm_audio_tstamp_config *audio_tstamp_config,
+			struct snd_pcm_audio_tstamp_report *audio_tstamp_report)
+{
+	struct snd_pcm_runtime *runtime = substream->runtime;
+	struct snd_usb_substream *subs = runtime->private_data;
+	struct snd_usb_endpoint *ep = subs->data_endpoint;
+	unsigned int freq;
+	unsigned long flags;
+	ktime_t stamp;
+	u64 frames, nsec;
+
+	if (!ep || !ep->freqn ||
+	    !(runtime->hw.info & SNDRV_PCM_INFO_HAS_LINK_ESTIMATED_ATIME) ||
+	    audio_tstamp_config->type_requested !=
+	    SNDRV_PCM_AUDIO_TSTAMP_TYPE_LINK_ESTIMATED) {
+		audio_tstamp_report->actual_type =
+			SNDRV_PCM_AUDIO_TSTAMP_TYPE_DEFAULT;
+		return 0;
+	}
+
+	spin_lock_irqsave(&ep->lock, flags);
+	frames = ep->pll_frames;
+	stamp = ep->pll_stamp;
+	freq = ep->pll_freq;
+	spin_unlock_irqrestore(&ep->lock, flags);
+
+	snd_pcm_gettime(runtime, system_ts);
+
+	/*
+	 * the frames are counted at the link, so that the delay is already
+	 * accounted for and report_delay has nothing to add
+	 */
+	nsec = mul_u64_u32_div(frames, NSEC_PER_SEC, runtime->rate);
+	if (stamp)
+		nsec += mul_u64_u32_div(ktime_to_ns(ktime_sub(ktime_get(), stamp)),
+					freq, ep->freqn);
+	*audio_ts = ns_to_timespec64(nsec);
+
+	audio_tstamp_report->actual_type =
+		SNDRV_PCM_AUDIO_TSTAMP_TYPE_LINK_ESTIMATED;
+	audio_tstamp_report->accuracy_report = 1;
+	/* one packet of uncertainty on the count */
+	audio_tstamp_report->accuracy = ep->packet_ns;
+
+	return 0;
+}
+
 /*
  * find a matching audio format
  */
@@ -878,6 +933,23 @@ static int snd_usb_hw_free(struct snd_pcm_substream *substream)
 	return 0;
 }
 
+/*
+ * whether the playback URBs may point into the PCM buffer: it has to be
+ * DMA memory allocated for the device doing the transfers
+ */
+static bool can_map_buffer(struct snd_usb_substream *subs)
+{
+	struct snd_dma_buffer *dmab = snd_pcm_get_dma_buf(subs->pcm_substream);
+	struct usb_bus *bus = subs->dev->bus;
+
+	if (subs->direction != SNDRV_PCM_STREAM_PLAYBACK || !dmab)
+		return false;
+	if (!hcd_uses_dma(bus_to_hcd(bus)) || bus->sysdev != bus->controller)
+		return false;
+	return dmab->dev.type == SNDRV_DMA_TYPE_DEV ||
+		dmab->dev.type == SNDRV_DMA_TYPE_DEV_SG;
+}
+
 /*
  * prepare callback
  *
@@ -936,6 +1008,8 @@ static int snd_usb_pcm_prepare(struct snd_pcm_substream *substream)
 	subs->data_endpoint->curframesize =
 		bytes_to_frames(runtime, subs->data_endpoint->curpacksize);
 
+	subs->zero_copy = can_map_buffer(subs);
+
 	/* reset the pointer */
 	subs->hwptr_done = 0;
 	subs->transfer_done = 0;
@@ -1336,6 +1410,8 @@ static int snd_usb_pcm_open(struct snd_pcm_substream *substream)
 	subs->interface = -1;
 	subs->altset_idx = 0;
 	runtime->hw = snd_usb_hardware;
+	if (snd_usb_clock_pll)
+		runtime->hw.info |= SNDRV_PCM_INFO_HAS_LINK_ESTIMATED_ATIME;
 	runtime->private_data = subs;
 	subs->pcm_substream = substream;
 	/* runtime PM is also done there */
@@ -1380,6 +1456,15 @@ static int snd_usb_pcm_close(struct snd_pcm_substream *substream)
 	return 0;
 }
 
+/* in batch mode, the endpoint reports the elapsed periods once per pass */
+static void snd_usb_period_elapsed(struct snd_usb_substream *subs)
+{
+	if (subs->data_endpoint->batch)
+		atomic_set(&subs->period_elapsed_pending, 1);
+	else
+		snd_pcm_period_elapsed(subs->pcm_substream);
+}
+
 /* Since a URB can handle only a single linear buffer, we must use double
  * buffering when the data to be transferred overflows the buffer boundary.
  * To avoid inconsistencies when updating hwptr_done, we use double buffering
@@ -1452,7 +1537,7 @@ static void retire_capture_urb(struct snd_usb_substream *subs,
 	}
 
 	if (period_elapsed)
-		snd_pcm_period_elapsed(subs->pcm_substream);
+		snd_usb_period_elapsed(subs);
 }
 
 static inline void fill_playback_urb_dsd_dop(struct snd_usb_substream *subs,
@@ -1463,9 +1548,12 @@ static inline void fill_playback_urb_dsd_dop(struct snd_usb_substream *subs,
 	unsigned int dst_idx = 0;
 	unsigned int src_idx = subs->hwptr_done;
 	unsigned int wrap = runtime->buffer_size * stride;
+	unsigned int frame_bytes = runtime->channels * 3;
+	unsigned int pos, ch;
 	u8 *dst = urb->transfer_buffer;
 	u8 *src = runtime->dma_area;
 	u8 marker[] = { 0x05, 0xfa };
+	bool bitrev = subs->cur_audiofmt->dsd_bitrev;
 
 	/*
 	 * The DSP DOP format defines a way to transport DSD samples over
@@ -1481,9 +1569,31 @@ static inline void fill_playback_urb_dsd_dop(struct snd_usb_substream *subs,
 	 *   L5 L6 0x05   R5 R6 0x05   L7 L8 0xfa  R7 R8 0xfa
 	 *   .....
 	 *
+	 * Whole sample frames are stuffed at once when they don't cross the
+	 * buffer boundary, the marker being the same for all the channels;
+	 * the remaining bytes go through the per-byte state machine.
 	 */
 
-	while (bytes--) {
+	while (bytes) {
+		pos = src_idx % wrap;
+		if (!subs->dsd_dop.byte_idx && !subs->dsd_dop.channel &&
+		    bytes >= frame_bytes && pos + runtime->channels * 2 <= wrap) {
+			const u8 *s = src + pos;
+			u8 m = marker[subs->dsd_dop.marker];
+
+			for (ch = 0; ch < runtime->channels; ch++, s += 2) {
+				dst[dst_idx++] = bitrev ? bitrev8(s[0]) : s[0];
+				dst[dst_idx++] = bitrev ? bitrev8(s[1]) : s[1];
+				dst[dst_idx++] = m;
+			}
+			src_idx += runtime->channels * 2;
+			subs->hwptr_done += runtime->channels * 2;
+			subs->dsd_dop.marker ^= 1;
+			bytes -= frame_bytes;
+			continue;
+		}
+
+		bytes--;
 		if (++subs->dsd_dop.byte_idx == 3) {
 			/* frame boundary? */
 			dst[dst_idx++] = marker[subs->dsd_dop.marker];
@@ -1500,7 +1610,7 @@ static inline void fill_playback_urb_dsd_dop(struct snd_usb_substream *subs,
 			/* stuff the DSD payload */
 			int idx = (src_idx + subs->dsd_dop.byte_idx - 1) % wrap;
 
-			if (subs->cur_audiofmt->dsd_bitrev)
+			if (bitrev)
 				dst[dst_idx++] = bitrev8(src[idx]);
 			else
 				dst[dst_idx++] = src[idx];
@@ -1512,6 +1622,62 @@ static inline void fill_playback_urb_dsd_dop(struct snd_usb_substream *subs,
 		subs->hwptr_done -= runtime->buffer_size * stride;
 }
 
+/*
+ * point the URB at the PCM buffer instead of copying the data, when the
+ * transfer is contiguous in both the buffer and the DMA address space;
+ * the transfers across the buffer boundary are still copied
+ */
+static bool map_to_urb(struct snd_usb_substream *subs, struct urb *urb,
+		       int stride, unsigned int bytes)
+{
+	struct snd_pcm_substream *substream = subs->pcm_substream;
+	struct snd_pcm_runtime *runtime = substream->runtime;
+	unsigned int buffer_bytes = runtime->buffer_size * stride;
+
+	if (!subs->zero_copy || !bytes)
+		return false;
+	if (subs->hwptr_done + bytes > buffer_bytes)
+		return false;
+	if (snd_pcm_sgbuf_get_chunk_size(substream, subs->hwptr_done,
+					 bytes) < bytes)
+		return false;
+
+	urb->transfer_buffer = runtime->dma_area + subs->hwptr_done;
+	urb->transfer_dma = snd_pcm_sgbuf_get_addr(substream,
+						   subs->hwptr_done);
+	subs->hwptr_done += bytes;
+	if (subs->hwptr_done >= buffer_bytes)
+		subs->hwptr_done -= buffer_bytes;
+	return true;
+}
+
+/* bit-reverse each byte, a word at a time */
+static void bitrev_copy(u8 *dst, const u8 *src, unsigned int bytes)
+{
+	for (; bytes >= 4; bytes -= 4, src += 4, dst += 4)
+		put_unaligned(swab32(bitrev32(get_unaligned((u32 *)src))),
+			      (u32 *)dst);
+	while (bytes--)
+		*dst++ = bitrev8(*src++);
+}
+
+static void copy_to_urb_bitrev(struct snd_usb_substream *subs,
+			       struct urb *urb, int stride, unsigned int bytes)
+{
+	struct snd_pcm_runtime *runtime = subs->pcm_substream->runtime;
+	unsigned int wrap = runtime->buffer_size * stride;
+	unsigned int bytes1 = min(bytes, wrap - subs->hwptr_done);
+
+	bitrev_copy(urb->transfer_buffer, runtime->dma_area + subs->hwptr_done,
+		    bytes1);
+	if (bytes > bytes1)
+		bitrev_copy(urb->transfer_buffer + bytes1, runtime->dma_area,
+			    bytes - bytes1);
+	subs->hwptr_done += bytes;
+	if (subs->hwptr_done >= wrap)
+		subs->hwptr_done -= wrap;
+}
+
 static void copy_to_urb(struct snd_usb_substream *subs, struct urb *urb,
 			int offset, int stride, unsigned int bytes)
 {
@@ -1627,23 +1793,16 @@ static void prepare_playback_urb(struct snd_usb_substream *subs,
 	} else if (unlikely(subs->pcm_format == SNDRV_PCM_FORMAT_DSD_U8 &&
 			   subs->cur_audiofmt->dsd_bitrev)) {
 		/* bit-reverse the bytes */
-		u8 *buf = urb->transfer_buffer;
-		for (i = 0; i < bytes; i++) {
-			int idx = (subs->hwptr_done + i)
-				% (runtime->buffer_size * stride);
-			buf[i] = bitrev8(runtime->dma_area[idx]);
-		}
-
-		subs->hwptr_done += bytes;
-		if (subs->hwptr_done >= runtime->buffer_size * stride)
-			subs->hwptr_done -= runtime->buffer_size * stride;
+		copy_to_urb_bitrev(subs, urb, stride, bytes);
 	} else {
 		/* usual PCM */
-		if (!subs->tx_length_quirk)
-			copy_to_urb(subs, urb, 0, stride, bytes);
-		else
+		if (!subs->tx_length_quirk) {
+			if (!map_to_urb(subs, urb, stride, bytes))
+				copy_to_urb(subs, urb, 0, stride, bytes);
+		} else {
 			bytes = copy_to_urb_quirk(subs, urb, stride, bytes);
 			/* bytes is now amount of outgoing data */
+		}
 	}
 
 	/* update delay with exact number of samples queued */
@@ -1666,7 +1825,7 @@ static void prepare_playback_urb(struct snd_usb_substream *subs,
 	spin_unlock_irqrestore(&subs->lock, flags);
 	urb->transfer_buffer_length = bytes;
 	if (period_elapsed)
-		snd_pcm_period_elapsed(subs->pcm_substream);
+		snd_usb_period_elapsed(subs);
 }
 
 /*
@@ -1806,6 +1965,7 @@ static const struct snd_pcm_ops snd_usb_playback_ops = {
 	.trigger =	snd_usb_substream_playback_trigger,
 	.sync_stop =	snd_usb_pcm_sync_stop,
 	.pointer =	snd_usb_pcm_pointer,
+	.get_time_info = snd_usb_pcm_get_time_info,
 };
 
 static const struct snd_pcm_ops snd_usb_capture_ops = {
@@ -1817,6 +1977,7 @@ static const struct snd_pcm_ops snd_usb_capture_ops = {
 	.trigger =	snd_usb_substream_capture_trigger,
 	.sync_stop =	snd_usb_pcm_sync_stop,
 	.pointer =	snd_usb_pcm_pointer,
+	.get_time_info = snd_usb_pcm_get_time_info,
 };
 
 void snd_usb_set_pcm_ops(struct snd_pcm *pcm, int stream)
@@ -102,6 +102,55 @@ static void proc_dump_substream_formats(struct snd_usb_substream *subs, struct s
 	}
 }
 
+static void proc_dump_urb_status(struct snd_usb_endpoint *ep,
+				 struct snd_info_buffer *buffer)
+{
+	unsigned int urb_ns, rate, load;
+
+	if (!ep->nurbs || !ep->packet_ns)
+		return;
+	snd_iprintf(buffer, "    URBs = %u x %d packets%s\n",
+		    ep->nurbs, ep->urb[0].packets,
+		    ep->low_latency ? " (low latency)" : "");
+	snd_iprintf(buffer, "    Completion jitter = %u us\n",
+		    ep->jitter_ns / NSEC_PER_USEC);
+	/* CPU load estimate in units of 0.01% */
+	urb_ns = ep->urb[0].packets * ep->packet_ns;
+	rate = NSEC_PER_SEC / urb_ns;
+	load = div_u64((u64)ep->cost_ns * rate, NSEC_PER_SEC / 10000);
+	snd_iprintf(buffer, "    Completion cost = %u ns x %u/s (%u.%02u%% CPU)\n",
+		    ep->cost_ns, rate, load / 100, load % 100);
+}
+
+static void proc_dump_ep_stats(struct snd_usb_endpoint *ep,
+			       struct snd_info_buffer *buffer)
+{
+	static const char * const ranges[SND_USB_EP_INTERVALS] = {
+		"<50%", "50-90%", "90-110%", "110-150%", "150-200%",
+		"200-400%", ">400%"
+	};
+	const struct snd_usb_ep_stats *stats = &ep->stats;
+	int i;
+
+	if (!ep->nurbs)
+		return;
+	snd_iprintf(buffer, "    Completion intervals:");
+	for (i = 0; i < SND_USB_EP_INTERVALS; i++)
+		snd_iprintf(buffer, " %s: %u", ranges[i], stats->interval[i]);
+	snd_iprintf(buffer, "\n");
+	snd_iprintf(buffer, "    Queue depth = %u-%u, dry = %u, late submits = %u, packet errors = %u\n",
+		    stats->depth_min, stats->depth_max, stats->dry,
+		    stats->late_submits, stats->packet_errors);
+	if (stats->feedback || stats->feedback_rejected)
+		snd_iprintf(buffer, "    Feedback = %u (%u rejected), freq = %#x.%04x-%#x.%04x\n",
+			    stats->feedback, stats->feedback_rejected,
+			    stats->freq_min >> 16, stats->freq_min & 0xffff,
+			    stats->freq_max >> 16, stats->freq_max & 0xffff);
+	if (stats->implicit_lag_max)
+		snd_iprintf(buffer, "    Implicit feedback lag = %u URBs max\n",
+			    stats->implicit_lag_max);
+}
+
 static void proc_dump_ep_status(struct snd_usb_substream *subs,
 				struct snd_usb_endpoint *data_ep,
 				struct snd_usb_endpoint *sync_ep,
@@ -115,11 +164,19 @@ static void proc_dump_ep_status(struct snd_usb_substream *subs,
 		    ? get_full_speed_hz(data_ep->freqm)
 		    : get_high_speed_hz(data_ep->freqm),
 		    data_ep->freqm >> 16, data_ep->freqm & 0xffff);
+	if (snd_usb_clock_pll)
+		snd_iprintf(buffer, "    Recovered freq = %u Hz (%#x.%04x)\n",
+			    subs->speed == USB_SPEED_FULL
+			    ? get_full_speed_hz(data_ep->pll_freq)
+			    : get_high_speed_hz(data_ep->pll_freq),
+			    data_ep->pll_freq >> 16, data_ep->pll_freq & 0xffff);
 	if (sync_ep && data_ep->freqshift != INT_MIN) {
 		int res = 16 - data_ep->freqshift;
 		snd_iprintf(buffer, "    Feedback Format = %d.%d\n",
 			    (sync_ep->syncmaxsize > 3 ? 32 : 24) - res, res);
 	}
+	proc_dump_urb_status(data_ep, buffer);
+	proc_dump_ep_stats(data_ep, buffer);
 }
 
 static void proc_dump_substream_status(struct snd_usb_substream *subs, struct snd_info_buffer *buffer)
@@ -1288,6 +1288,9 @@ int snd_usb_apply_interface_quirk(struct snd_usb_audio *chip,
 				  int iface,
 				  int altno)
 {
+	if (!(chip->quirk_flags & QUIRK_FLAG_SKIP_ALTSET))
+		return 0;
+
 	/* audiophile usb: skip altsets incompatible with device_setup */
 	if (chip->usb_id == USB_ID(0x0763, 0x2003))
 		return audiophile_skip_setting_quirk(chip, iface, altno);
@@ -1523,7 +1526,7 @@ int snd_usb_select_mode_quirk(struct snd_usb_substream *subs,
 	struct usb_device *dev = subs->dev;
 	int err;
 
-	if (is_itf_usb_dsd_dac(subs->stream->chip->usb_id)) {
+	if (subs->stream->chip->quirk_flags & QUIRK_FLAG_ITF_USB_DSD) {
 		/* First switch to alt set 0, otherwise the mode switch cmd
 		 * will not be accepted by the DAC
 		 */
@@ -1610,41 +1613,68 @@ void snd_usb_ctl_msg_quirk(struct usb_device *dev, unsigned int pipe,
 			   __u16 index, void *data, __u16 size)
 {
 	struct snd_usb_audio *chip = dev_get_drvdata(&dev->dev);
+	unsigned int delay;
 
-	if (!chip)
+	if (!chip || (requesttype & USB_TYPE_MASK) != USB_TYPE_CLASS)
 		return;
-	/*
-	 * "Playback Design" products need a 20ms delay after each
-	 * class compliant request
-	 */
-	if (USB_ID_VENDOR(chip->usb_id) == 0x23ba &&
-	    (requesttype & USB_TYPE_MASK) == USB_TYPE_CLASS)
-		msleep(20);
+
+	delay = snd_usb_ctl_msg_delay(chip);
+	if (delay >= 20000)
+		msleep(delay / 1000);
+	else if (delay)
+		usleep_range(delay, delay * 2);
+}
+
+/* delay needed after each class compliant request, in usecs */
+unsigned int snd_usb_ctl_msg_delay(struct snd_usb_audio *chip)
+{
+	if (chip->quirk_flags & QUIRK_FLAG_CTL_MSG_DELAY)
+		return 20000;
+	if (chip->quirk_flags & QUIRK_FLAG_CTL_MSG_DELAY_1M)
+		return 1000;
+	return 0;
+}
+
+/*
+ * look up the quirks checked in the frequent paths once at probe, so
+ * that they are only bit tests afterwards
+ */
+void snd_usb_init_quirk_flags(struct snd_usb_audio *chip)
+{
+	u32 id = chip->usb_id;
 
 	/*
-	 * "TEAC Corp." products need a 20ms delay after each
-	 * class compliant request
+	 * "Playback Design" and "TEAC Corp." products need a 20ms delay
+	 * after each class compliant request
 	 */
-	if (USB_ID_VENDOR(chip->usb_id) == 0x0644 &&
-	    (requesttype & USB_TYPE_MASK) == USB_TYPE_CLASS)
-		msleep(20);
+	if (USB_ID_VENDOR(id) == 0x23ba || USB_ID_VENDOR(id) == 0x0644)
+		chip->quirk_flags |= QUIRK_FLAG_CTL_MSG_DELAY;
 
 	/* ITF-USB DSD based DACs functionality need a delay
 	 * after each class compliant request
 	 */
-	if (is_itf_usb_dsd_dac(chip->usb_id)
-	    && (requesttype & USB_TYPE_MASK) == USB_TYPE_CLASS)
-		msleep(20);
+	if (is_itf_usb_dsd_dac(id))
+		chip->quirk_flags |= QUIRK_FLAG_ITF_USB_DSD |
+			QUIRK_FLAG_CTL_MSG_DELAY;
 
 	/* Zoom R16/24, Logitech H650e, Jabra 550a needs a tiny delay here,
 	 * otherwise requests like get/set frequency return as failed despite
 	 * actually succeeding.
 	 */
-	if ((chip->usb_id == USB_ID(0x1686, 0x00dd) ||
-	     chip->usb_id == USB_ID(0x046d, 0x0a46) ||
-	     chip->usb_id == USB_ID(0x0b0e, 0x0349)) &&
-	    (requesttype & USB_TYPE_MASK) == USB_TYPE_CLASS)
-		usleep_range(1000, 2000);
+	if (id == USB_ID(0x1686, 0x00dd) ||
+	    id == USB_ID(0x046d, 0x0a46) ||
+	    id == USB_ID(0x0b0e, 0x0349))
+		chip->quirk_flags |= QUIRK_FLAG_CTL_MSG_DELAY_1M;
+
+	/* altsets filtered by snd_usb_apply_interface_quirk() */
+	switch (id) {
+	case USB_ID(0x0763, 0x2003): /* audiophile usb */
+	case USB_ID(0x0763, 0x2001): /* quattro usb */
+	case USB_ID(0x0763, 0x2012): /* fasttrackpro usb */
+	case USB_ID(0x0194f, 0x010c): /* presonus studio 1810c */
+		chip->quirk_flags |= QUIRK_FLAG_SKIP_ALTSET;
+		break;
+	}
 }
 
 /*
@@ -1730,7 +1760,7 @@ u64 snd_usb_interface_dsd_format_quirks(struct snd_usb_audio *chip,
 	}
 
 	/* ITF-USB DSD based DACs */
-	if (is_itf_usb_dsd_dac(chip->usb_id)) {
+	if (chip->quirk_flags & QUIRK_FLAG_ITF_USB_DSD) {
 		iface = usb_ifnum_to_if(chip->dev, fp->iface);
 
 		/* Altsetting 2 support native DSD if the num of altsets is
@@ -39,6 +39,8 @@ void snd_usb_set_interface_quirk(struct usb_device *dev);
 void snd_usb_ctl_msg_quirk(struct usb_device *dev, unsigned int pipe,
 			   __u8 request, __u8 requesttype, __u16 value,
 			   __u16 index, void *data, __u16 size);
+unsigned int snd_usb_ctl_msg_delay(struct snd_usb_audio *chip);
+void snd_usb_init_quirk_flags(struct snd_usb_audio *chip);
 
 int snd_usb_select_mode_quirk(struct snd_usb_substream *subs,
 			      struct audioformat *fmt);
@@ -25,6 +25,7 @@ struct snd_usb_audio {
 	struct snd_card *card;
 	struct usb_interface *pm_intf;
 	u32 usb_id;
+	unsigned int quirk_flags;	/* QUIRK_FLAG_*, set up at probe */
 	struct mutex mutex;
 	unsigned int autosuspended:1;	
 	atomic_t active;
@@ -60,6 +61,12 @@ struct snd_usb_audio {
 	struct media_intf_devnode *ctl_intf_media_devnode;
 };
 
+/* quirk flags, see snd_usb_init_quirk_flags() */
+#define QUIRK_FLAG_CTL_MSG_DELAY	(1U << 0) /* 20ms after each class request */
+#define QUIRK_FLAG_CTL_MSG_DELAY_1M	(1U << 1) /* 1ms after each class request */
+#define QUIRK_FLAG_ITF_USB_DSD		(1U << 2) /* ITF-USB DSD mode switch */
+#define QUIRK_FLAG_SKIP_ALTSET		(1U << 3) /* altsets filtered by setup */
+
 #define usb_audio_err(chip, fmt, args...) \
 	dev_err(&(chip)->dev->dev, fmt, ##args)
 #define usb_audio_warn(chip, fmt, args...) \
@@ -123,5 +130,8 @@ void snd_usb_unlock_shutdown(struct snd_usb_audio *chip);
 
 extern bool snd_usb_use_vmalloc;
 extern bool snd_usb_skip_validation;
+extern bool snd_usb_low_latency;
+extern bool snd_usb_batch_urbs;
+extern unsigned int snd_usb_clock_pll;
 
 #endif /* __USBAUDIO_H */